@@ -0,0 +1,29 @@
+#!/bin/sh
+# Builds the size program once without features, then once per module, and prints the wasm bytes each module adds to the baseline.
+# The output is a table, then the same numbers as JSON on the last line.
+# Extra arguments are passed to cargo, e.g. `--features emscripten-functions/perf`.
+set -e
+
+cd "$(dirname "$0")/../.."
+TARGET=wasm32-unknown-emscripten
+OUT="target/$TARGET/size"
+MODULES="console emscripten html5 webgl fetch idb worker script"
+
+build() {
+    cargo build -q --profile size --target "$TARGET" -p emscripten-functions-size "$@"
+    wc -c < "$OUT/emscripten_functions_size.wasm" | tr -d ' '
+}
+
+BASELINE=$(build "$@")
+printf '%-12s %10s %10s\n' module bytes added
+printf '%-12s %10s %10s\n' baseline "$BASELINE" 0
+
+JSON="{\"baseline\":$BASELINE,\"modules\":{"
+SEPARATOR=""
+for MODULE in $MODULES; do
+    BYTES=$(build --features "$MODULE" "$@")
+    printf '%-12s %10s %10s\n' "$MODULE" "$BYTES" $((BYTES - BASELINE))
+    JSON="$JSON$SEPARATOR\"$MODULE\":$((BYTES - BASELINE))"
+    SEPARATOR=","
+done
+echo "$JSON}}"
@@ -0,0 +1,96 @@
+//! A minimal program using the modules of emscripten-functions enabled by its features, one per module,
+//! so that `report.sh` can compare the size of each build to the baseline one, with no feature enabled.
+//!
+//! The inputs go through `black_box`, so that the calls can't be evaluated at compile time and optimized out.
+
+#[cfg(target_os = "emscripten")]
+fn main() {
+    #[allow(unused_imports)]
+    use std::hint::black_box;
+
+    #[cfg(feature = "console")]
+    {
+        use emscripten_functions::console;
+
+        console::log(black_box("size"));
+        console::warn(black_box("size"));
+        console::error(black_box("size"));
+    }
+
+    #[cfg(feature = "emscripten")]
+    {
+        use emscripten_functions::emscripten;
+
+        emscripten::run_script(black_box("0"));
+        black_box(emscripten::get_now());
+        emscripten::set_main_loop(emscripten::cancel_main_loop, 0, false);
+    }
+
+    #[cfg(feature = "html5")]
+    {
+        use emscripten_functions::html5::{self, Target};
+
+        let _ = black_box(html5::get_canvas_element_size(Target::selector(black_box(
+            "#canvas",
+        ))));
+        html5::request_animation_frame(|time| {
+            black_box(time);
+        });
+    }
+
+    #[cfg(feature = "webgl")]
+    {
+        use emscripten_functions::webgl::Context;
+
+        let _ = black_box(
+            Context::builder()
+                .version(2, 0)
+                .create(black_box("#canvas")),
+        );
+    }
+
+    #[cfg(feature = "fetch")]
+    {
+        use emscripten_functions::fetch::FetchRequest;
+
+        let _ = FetchRequest::new(black_box("size.bin"))
+            .load_to_memory(true)
+            .on_success(|response| {
+                black_box(response.status());
+            })
+            .send();
+    }
+
+    #[cfg(feature = "idb")]
+    {
+        use emscripten_functions::idb::Store;
+
+        let store = Store::new(black_box("size"));
+        store.store("key", vec![0u8; 4], |result| {
+            black_box(result.is_ok());
+        });
+        store.flush();
+    }
+
+    #[cfg(feature = "worker")]
+    {
+        use emscripten_functions::worker::WorkerPool;
+
+        let pool = WorkerPool::new(black_box("worker.js"), 1);
+        pool.call("size", black_box(&[0u8; 4]), |result| {
+            black_box(result.len());
+        });
+    }
+
+    #[cfg(feature = "script")]
+    {
+        use emscripten_functions::script::Script;
+
+        if let Ok(script) = Script::compile(black_box("return $0 + 1;")) {
+            black_box(script.call_double(&[1.0]));
+        }
+    }
+}
+
+#[cfg(not(target_os = "emscripten"))]
+fn main() {}
@@ -0,0 +1,290 @@
+//! A minimal benchmark harness timing operations with `performance.now()`, whose results are printed as JSON.
+
+use std::{fmt::Write, hint::black_box};
+
+use emscripten_functions::emscripten::get_now;
+
+// The time a batch of iterations should take, in milliseconds: well above the timer's resolution,
+// which browsers coarsen to 0.1ms or more.
+const BATCH_MILLIS: f64 = 10.0;
+
+// The number of batches timed for each benchmark, after a warm-up one.
+const BATCHES: usize = 10;
+
+// The number of calls timed one by one by `Harness::bench_spaced`.
+const SPACED_CALLS: usize = 200;
+
+/// The result of one benchmark.
+#[derive(Debug, Clone)]
+pub struct BenchResult {
+    pub name: String,
+    /// The median time per operation over the batches, in nanoseconds.
+    pub ns_per_op: f64,
+    /// The time per operation of the fastest batch, in nanoseconds.
+    pub min_ns_per_op: f64,
+    /// The number of operations of a batch.
+    pub iterations: u64,
+}
+
+/// The distribution of a measure over many samples, e.g. the frame times of a main loop.
+#[derive(Debug, Clone)]
+pub struct Distribution {
+    pub name: String,
+    pub count: usize,
+    pub p50: f64,
+    pub p95: f64,
+    pub p99: f64,
+    pub max: f64,
+}
+
+/// Runs the benchmarks and collects their results.
+#[derive(Debug, Default)]
+pub struct Harness {
+    results: Vec<BenchResult>,
+    skipped: Vec<(String, &'static str)>,
+    // The event counts measured along the results, e.g. the dropped events.
+    counts: Vec<(String, u64)>,
+    distributions: Vec<Distribution>,
+    // The bytes moved by a benchmark, and the time it took, in milliseconds.
+    throughputs: Vec<(String, u64, f64)>,
+    // The points of the speedup curves: the number of cores, and the speedup over the serial run.
+    speedups: Vec<(String, usize, f64)>,
+    // Only the benchmarks whose names contain it run, if set.
+    filter: Option<String>,
+}
+
+// Times `iterations` calls of the operation, in milliseconds.
+fn time_batch<F: FnMut()>(op: &mut F, iterations: u64) -> f64 {
+    let start = get_now();
+    for _ in 0..iterations {
+        op();
+    }
+    get_now() - start
+}
+
+impl Harness {
+    /// Creates a harness running the benchmarks whose names contain the filter, or all of them.
+    pub fn new(filter: Option<String>) -> Self {
+        Self {
+            filter,
+            ..Self::default()
+        }
+    }
+
+    /// Returns `true` if the benchmark of the given name is run, as its name contains the filter.
+    pub fn selected(&self, name: &str) -> bool {
+        self.filter
+            .as_ref()
+            .map_or(true, |filter| name.contains(filter.as_str()))
+    }
+
+    /// Times the operation, calibrating the number of iterations of a batch from a growing first run.
+    /// The operation's result is passed through `black_box`, so that it isn't optimized out.
+    pub fn bench<R, F: FnMut() -> R>(&mut self, name: &str, mut op: F) {
+        if !self.selected(name) {
+            return;
+        }
+        let mut op = || {
+            black_box(op());
+        };
+
+        let mut iterations = 1;
+        loop {
+            let millis = time_batch(&mut op, iterations);
+            if millis >= BATCH_MILLIS || iterations >= 1 << 30 {
+                break;
+            }
+            // Aims a bit past the batch time, from the last measure when it's meaningful.
+            iterations = if millis > 0.5 {
+                ((iterations as f64 * BATCH_MILLIS * 1.2 / millis) as u64).max(iterations + 1)
+            } else {
+                iterations * 10
+            };
+        }
+
+        let mut per_op: Vec<f64> = (0..BATCHES)
+            .map(|_| time_batch(&mut op, iterations) * 1e6 / iterations as f64)
+            .collect();
+        per_op.sort_unstable_by(f64::total_cmp);
+        self.record(BenchResult {
+            name: name.to_string(),
+            ns_per_op: per_op[BATCHES / 2],
+            min_ns_per_op: per_op[0],
+            iterations,
+        });
+    }
+
+    /// Times single calls of the operation, each after an idle wait of the given milliseconds,
+    /// for the cost of an occasional call, whose code and caches went cold, rather than a tight loop of them.
+    ///
+    /// Each call is timed on its own, so the results are rounded to the timer's resolution: exact in node,
+    /// but coarsened to 5 microseconds or more in browsers.
+    pub fn bench_spaced<R, F: FnMut() -> R>(&mut self, name: &str, gap_millis: f64, mut op: F) {
+        if !self.selected(name) {
+            return;
+        }
+
+        let mut per_op: Vec<f64> = (0..SPACED_CALLS)
+            .map(|_| {
+                let idle_until = get_now() + gap_millis;
+                while get_now() < idle_until {}
+                let start = get_now();
+                black_box(op());
+                (get_now() - start) * 1e6
+            })
+            .collect();
+        per_op.sort_unstable_by(f64::total_cmp);
+        self.record(BenchResult {
+            name: name.to_string(),
+            ns_per_op: per_op[SPACED_CALLS / 2],
+            min_ns_per_op: per_op[0],
+            iterations: 1,
+        });
+    }
+
+    /// Adds the results of another harness, e.g. one run on a pthread.
+    pub fn merge(&mut self, other: Harness) {
+        self.results.extend(other.results);
+        self.skipped.extend(other.skipped);
+        self.counts.extend(other.counts);
+        self.distributions.extend(other.distributions);
+        self.throughputs.extend(other.throughputs);
+        self.speedups.extend(other.speedups);
+    }
+
+    /// Returns the filter the harness was created with.
+    pub fn filter(&self) -> Option<&str> {
+        self.filter.as_deref()
+    }
+
+    /// Records a result measured outside of [`Harness::bench`], e.g. over the ticks of a main loop.
+    pub fn record(&mut self, result: BenchResult) {
+        if self.selected(&result.name) {
+            self.results.push(result);
+        }
+    }
+
+    /// Records a count measured along a result, e.g. the events a benchmark dropped.
+    pub fn count(&mut self, name: &str, value: u64) {
+        if self.selected(name) {
+            self.counts.push((name.to_string(), value));
+        }
+    }
+
+    /// Records the distribution of the samples of a measure, which are sorted. Nothing is recorded without samples.
+    pub fn distribution(&mut self, name: &str, samples: &mut [f64]) {
+        if !self.selected(name) || samples.is_empty() {
+            return;
+        }
+        samples.sort_unstable_by(f64::total_cmp);
+        let percentile = |p: usize| samples[(samples.len() - 1) * p / 100];
+        self.distributions.push(Distribution {
+            name: name.to_string(),
+            count: samples.len(),
+            p50: percentile(50),
+            p95: percentile(95),
+            p99: percentile(99),
+            max: samples[samples.len() - 1],
+        });
+    }
+
+    /// Records the throughput of a benchmark that moved `bytes` bytes in `millis` milliseconds.
+    pub fn throughput(&mut self, name: &str, bytes: u64, millis: f64) {
+        if self.selected(name) {
+            self.throughputs.push((name.to_string(), bytes, millis));
+        }
+    }
+
+    /// Records a point of the speedup curve of a parallel benchmark, that took `millis` milliseconds on `cores` cores,
+    /// and `serial_millis` on a single thread without the parallel backend.
+    pub fn speedup(&mut self, name: &str, cores: usize, millis: f64, serial_millis: f64) {
+        if self.selected(name) {
+            self.speedups
+                .push((name.to_string(), cores, serial_millis / millis.max(1e-3)));
+        }
+    }
+
+    /// Records that a benchmark couldn't run in this environment.
+    pub fn skip(&mut self, name: &str, reason: &'static str) {
+        if self.selected(name) {
+            self.skipped.push((name.to_string(), reason));
+        }
+    }
+
+    /// Serializes the results, as `{"environment":...,"results":[{"name":...,"ns_per_op":...,...}],"counts":[...],"distributions":[...],"throughputs":[...],"speedups":[...],"skipped":[...]}`.
+    /// A speedup's efficiency is its speedup per core.
+    /// The distributions are in the unit of their samples.
+    pub fn to_json(&self, environment: &str) -> String {
+        let mut json = String::new();
+        let _ = write!(json, "{{\"environment\":\"{}\",\"results\":[", environment);
+        for (i, result) in self.results.iter().enumerate() {
+            if i > 0 {
+                json.push(',');
+            }
+            let _ = write!(
+                json,
+                "{{\"name\":\"{}\",\"ns_per_op\":{:.2},\"min_ns_per_op\":{:.2},\"iterations\":{}}}",
+                result.name, result.ns_per_op, result.min_ns_per_op, result.iterations
+            );
+        }
+        json.push_str("],\"counts\":[");
+        for (i, (name, value)) in self.counts.iter().enumerate() {
+            if i > 0 {
+                json.push(',');
+            }
+            let _ = write!(json, "{{\"name\":\"{}\",\"value\":{}}}", name, value);
+        }
+        json.push_str("],\"distributions\":[");
+        for (i, distribution) in self.distributions.iter().enumerate() {
+            if i > 0 {
+                json.push(',');
+            }
+            let _ = write!(
+                json,
+                "{{\"name\":\"{}\",\"count\":{},\"p50\":{:.3},\"p95\":{:.3},\"p99\":{:.3},\"max\":{:.3}}}",
+                distribution.name,
+                distribution.count,
+                distribution.p50,
+                distribution.p95,
+                distribution.p99,
+                distribution.max
+            );
+        }
+        json.push_str("],\"throughputs\":[");
+        for (i, (name, bytes, millis)) in self.throughputs.iter().enumerate() {
+            if i > 0 {
+                json.push(',');
+            }
+            let _ = write!(
+                json,
+                "{{\"name\":\"{}\",\"bytes\":{},\"mb_per_s\":{:.2}}}",
+                name,
+                bytes,
+                *bytes as f64 / 1e3 / millis.max(1e-3)
+            );
+        }
+        json.push_str("],\"speedups\":[");
+        for (i, (name, cores, speedup)) in self.speedups.iter().enumerate() {
+            if i > 0 {
+                json.push(',');
+            }
+            let _ = write!(
+                json,
+                "{{\"name\":\"{}\",\"cores\":{},\"speedup\":{:.3},\"efficiency\":{:.3}}}",
+                name,
+                cores,
+                speedup,
+                speedup / *cores as f64
+            );
+        }
+        json.push_str("],\"skipped\":[");
+        for (i, (name, reason)) in self.skipped.iter().enumerate() {
+            if i > 0 {
+                json.push(',');
+            }
+            let _ = write!(json, "{{\"name\":\"{}\",\"reason\":\"{}\"}}", name, reason);
+        }
+        json.push_str("]}");
+        json
+    }
+}
@@ -0,0 +1,326 @@
+//! The cost of dispatching floods of input events to rust, at the rates of high polling rate mice (1 to 8 kHz),
+//! through the raw html5 `*_callback_on_thread` functions, the closure wrappers of `html5::events`, and the coalescing
+//! `input_queue::InputCollector`; and for `pointermove`, which html5.h has no callbacks for, through `pointer::listen_pointer`.
+//!
+//! Each second of a stream is synthesized as 60 bursts of `dispatchEvent` calls on the `#canvas` element, one per 60 Hz frame,
+//! the way a browser delivering every event would queue them between frames; the queue is drained after each burst.
+//! The results are named `input/<event>/<path>/<rate>`, e.g. `input/mousemove/InputCollector/8kHz`, with the time per event
+//! of the rust side: the time of a burst, less that of the same burst without a rust listener, plus the drain.
+//! The events lost on the way are counted as `input/<event>/<path>/<rate>/dropped`.
+//!
+//! Trusted events are coalesced by the browsers to about one per frame, so these are the streams of `getCoalescedEvents()`
+//! forwarded one by one, or of a browser that stops coalescing them. Run in headless Chrome with e.g.
+//! `chrome --headless=new --enable-logging=stderr index.html`, which prints the results to stderr.
+
+use std::{
+    cell::Cell,
+    hint::black_box,
+    os::raw::{c_int, c_void},
+    rc::Rc,
+};
+
+use emscripten_functions::{
+    emscripten::get_now,
+    html5::events::{on_mousemove, on_touchmove, on_wheel, EventListener, EventTarget},
+    input_queue::InputCollector,
+    pointer::{listen_pointer, PointerListener},
+    script::Script,
+};
+use emscripten_functions_sys::html5;
+
+use crate::harness::{BenchResult, Harness};
+
+// The synthesized streams, in the order of the `kind` argument of the flood script.
+const STREAMS: [&str; 4] = ["mousemove", "wheel", "touchmove", "pointermove"];
+
+// The rates of the streams, in events per second.
+const RATES: [(&str, u32); 4] = [
+    ("1kHz", 1000),
+    ("2kHz", 2000),
+    ("4kHz", 4000),
+    ("8kHz", 8000),
+];
+
+// The number of bursts of a stream: a second of 60 Hz frames.
+const FRAMES: u32 = 60;
+
+// The records of the `InputCollector`, one frame of a queue drained every frame would need far fewer.
+const QUEUE_CAPACITY: usize = 256;
+
+const CANVAS: &str = "#canvas";
+
+// Dispatches `$1` events of the stream `$0` on the canvas, and returns the time it took, in milliseconds,
+// or -1 if the browser can't synthesize them. The same event is dispatched again, so that its creation isn't timed.
+const FLOOD: &str = r##"
+    var canvas = document.querySelector("#canvas");
+    var init = { bubbles: true, cancelable: true, clientX: 10, clientY: 10 };
+    var event;
+    if ($0 == 0) {
+        init.movementX = 1;
+        init.movementY = 1;
+        event = new MouseEvent("mousemove", init);
+    } else if ($0 == 1) {
+        init.deltaY = 1;
+        event = new WheelEvent("wheel", init);
+    } else if ($0 == 2) {
+        if (typeof Touch != "function") {
+            return -1;
+        }
+        var touch = new Touch({ identifier: 0, target: canvas, clientX: 10, clientY: 10 });
+        event = new TouchEvent("touchmove", { bubbles: true, cancelable: true, touches: [touch], targetTouches: [touch], changedTouches: [touch] });
+    } else {
+        if (typeof PointerEvent != "function") {
+            return -1;
+        }
+        init.pointerId = 1;
+        init.pointerType = "mouse";
+        event = new PointerEvent("pointermove", init);
+    }
+    var start = performance.now();
+    for (var i = 0; i < $1; i++) {
+        canvas.dispatchEvent(event);
+    }
+    return performance.now() - start;
+"##;
+
+// The raw callbacks count their events in the `u64` given as user data.
+unsafe extern "C" fn raw_mouse(
+    _: c_int,
+    event: *const html5::EmscriptenMouseEvent,
+    data: *mut c_void,
+) -> c_int {
+    black_box((*event).movementX);
+    *(data as *mut u64) += 1;
+    0
+}
+
+unsafe extern "C" fn raw_wheel(
+    _: c_int,
+    event: *const html5::EmscriptenWheelEvent,
+    data: *mut c_void,
+) -> c_int {
+    black_box((*event).deltaY);
+    *(data as *mut u64) += 1;
+    0
+}
+
+unsafe extern "C" fn raw_touch(
+    _: c_int,
+    event: *const html5::EmscriptenTouchEvent,
+    data: *mut c_void,
+) -> c_int {
+    black_box((*event).numTouches);
+    *(data as *mut u64) += 1;
+    0
+}
+
+// `EM_CALLBACK_THREAD_CONTEXT_CALLING_THREAD`, a pointer-valued macro bindgen doesn't generate.
+const CALLING_THREAD: html5::pthread_t = 0x2 as html5::pthread_t;
+
+// Registers the raw callback of the stream with the given user data, or unregisters it with `None`.
+fn set_raw(stream: usize, data: Option<*mut u64>) {
+    let target = c"#canvas".as_ptr();
+    let user_data = data.unwrap_or(std::ptr::null_mut()) as *mut c_void;
+    let registered = data.is_some();
+    unsafe {
+        match stream {
+            0 => html5::emscripten_set_mousemove_callback_on_thread(
+                target,
+                user_data,
+                0,
+                registered.then_some(raw_mouse as _),
+                CALLING_THREAD,
+            ),
+            1 => html5::emscripten_set_wheel_callback_on_thread(
+                target,
+                user_data,
+                0,
+                registered.then_some(raw_wheel as _),
+                CALLING_THREAD,
+            ),
+            _ => html5::emscripten_set_touchmove_callback_on_thread(
+                target,
+                user_data,
+                0,
+                registered.then_some(raw_touch as _),
+                CALLING_THREAD,
+            ),
+        };
+    }
+}
+
+// A listener of one of the dispatch paths, which counts the events it got.
+enum Path {
+    Raw(usize, Box<u64>),
+    Closure {
+        count: Rc<Cell<u64>>,
+        _listener: EventListener,
+    },
+    Queue(InputCollector),
+    Pointer {
+        count: Rc<Cell<u64>>,
+        _listener: PointerListener,
+    },
+}
+
+impl Path {
+    const NAMES: [&'static str; 4] = [
+        "callback_on_thread",
+        "html5::events",
+        "InputCollector",
+        "pointer::listen_pointer",
+    ];
+
+    fn new(stream: usize, path: usize) -> Option<Path> {
+        let target = EventTarget::Selector(CANVAS);
+        let closure = || {
+            let count = Rc::new(Cell::new(0));
+            let counter = count.clone();
+            (count, move || counter.set(counter.get() + 1))
+        };
+        Some(match (stream, path) {
+            (0..=2, 0) => {
+                let mut count = Box::new(0);
+                set_raw(stream, Some(&mut *count));
+                Path::Raw(stream, count)
+            }
+            (0, 1) => {
+                let (count, increment) = closure();
+                let listener = on_mousemove(target, false, move |event| {
+                    black_box(event.movementX);
+                    increment();
+                    false
+                })
+                .ok()?;
+                Path::Closure {
+                    count,
+                    _listener: listener,
+                }
+            }
+            (1, 1) => {
+                let (count, increment) = closure();
+                let listener = on_wheel(target, false, move |event| {
+                    black_box(event.deltaY);
+                    increment();
+                    false
+                })
+                .ok()?;
+                Path::Closure {
+                    count,
+                    _listener: listener,
+                }
+            }
+            (2, 1) => {
+                let (count, increment) = closure();
+                let listener = on_touchmove(target, false, move |event| {
+                    black_box(event.numTouches);
+                    increment();
+                    false
+                })
+                .ok()?;
+                Path::Closure {
+                    count,
+                    _listener: listener,
+                }
+            }
+            (0..=2, 2) => Path::Queue(InputCollector::new(target, QUEUE_CAPACITY).ok()?),
+            (3, 3) => {
+                let count = Rc::new(Cell::new(0));
+                let counter = count.clone();
+                let listener = listen_pointer(CANVAS, move |batch| {
+                    // A synthesized event has no coalesced samples: its batch is the event itself.
+                    counter.set(counter.get() + batch.samples().len().max(1) as u64);
+                })?;
+                Path::Pointer {
+                    count,
+                    _listener: listener,
+                }
+            }
+            _ => return None,
+        })
+    }
+
+    // Runs the once-per-frame work of the path, and returns the number of the frame's `sent` events it lost.
+    fn end_frame(&mut self, sent: u64) -> u64 {
+        match self {
+            Path::Raw(_, count) => sent.saturating_sub(std::mem::take(&mut **count)),
+            Path::Closure { count, .. } | Path::Pointer { count, .. } => {
+                sent.saturating_sub(count.replace(0))
+            }
+            Path::Queue(queue) => {
+                queue.drain(|record| {
+                    black_box(record);
+                });
+                black_box(queue.take_mouse_delta());
+                queue.take_dropped() as u64
+            }
+        }
+    }
+}
+
+impl Drop for Path {
+    fn drop(&mut self) {
+        if let Path::Raw(stream, _) = self {
+            set_raw(*stream, None);
+        }
+    }
+}
+
+/// Runs the floods, if there's a document to dispatch the events in.
+pub fn run(harness: &mut Harness, has_document: bool) {
+    if !has_document {
+        harness.skip("input", "needs a document");
+        return;
+    }
+    let flood = Script::compile(FLOOD).expect("the flood script compiles");
+
+    for (stream, stream_name) in STREAMS.iter().enumerate() {
+        for (rate_name, rate) in RATES {
+            let burst = rate / FRAMES;
+            let dispatch = || flood.call_double(&[stream as f64, burst as f64]);
+
+            // The time of a burst dispatched to no rust listener, the browser's own part of the cost.
+            let mut baseline: Vec<f64> = (0..FRAMES).map(|_| dispatch()).collect();
+            if baseline[0] < 0.0 {
+                harness.skip(
+                    &format!("input/{}", stream_name),
+                    "the browser can't synthesize the events",
+                );
+                break;
+            }
+            baseline.sort_unstable_by(f64::total_cmp);
+            let baseline = baseline[baseline.len() / 2];
+
+            for (path, path_name) in Path::NAMES.iter().enumerate() {
+                let name = format!("input/{}/{}/{}", stream_name, path_name, rate_name);
+                let Some(mut listener) = Path::new(stream, path) else {
+                    if (stream < 3) != (path == 3) {
+                        harness.skip(&name, "the listener couldn't be registered");
+                    }
+                    continue;
+                };
+
+                let mut per_event: Vec<f64> = Vec::with_capacity(FRAMES as usize);
+                let mut dropped = 0;
+                for _ in 0..FRAMES {
+                    let dispatched = dispatch();
+                    let start = get_now();
+                    dropped += listener.end_frame(burst as u64);
+                    let drained = get_now() - start;
+                    per_event
+                        .push(((dispatched - baseline).max(0.0) + drained) * 1e6 / burst as f64);
+                }
+                drop(listener);
+
+                per_event.sort_unstable_by(f64::total_cmp);
+                harness.record(BenchResult {
+                    name: name.clone(),
+                    ns_per_op: per_event[per_event.len() / 2],
+                    min_ns_per_op: per_event[0],
+                    iterations: burst as u64,
+                });
+                harness.count(&format!("{}/dropped", name), dropped);
+            }
+        }
+    }
+}
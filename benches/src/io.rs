@@ -0,0 +1,417 @@
+//! The throughput and latency of the storage and network wrappers, across payload sizes from 1 KiB to 256 MiB:
+//! the IndexedDB `Store`, as arrays stored one transaction at a time or batched, and as blobs; OPFS files through WasmFS;
+//! and the `wget` and `fetch` downloads, into memory, streamed or by range.
+//!
+//! The results are named `io/<path>/<operation>/<size>`, e.g. `io/idb/array/batched/1MiB`, each with a throughput and a
+//! distribution of the latencies of its operations, in milliseconds. The downloads are of `blob:` URLs, so they time the
+//! runtime's side of a download without the network; served files would add it.
+//!
+//! These run from an async task once the other benchmarks are done:
+//! * The IndexedDB and download ones need a browser.
+//! * The blob ones need a build linked with `-sASYNCIFY`.
+//! * The OPFS ones need the `wasmfs` feature of this crate, and a build linked with `-sWASMFS -pthread`: they run on a pthread,
+//!   as the OPFS backend blocks on its worker.
+
+use std::{cell::RefCell, rc::Rc};
+
+use emscripten_functions::{
+    emscripten::{get_now, has_asyncify, run_script, run_script_string},
+    executor::{callback_future, idb_load, idb_store, spawn_local, wget, CallbackFuture},
+    fetch::{fetch_range, FetchRequest},
+    idb::Store,
+    memory,
+};
+
+use crate::harness::Harness;
+
+// The payload sizes, from small records to whole asset packs.
+const SIZES: [(&str, usize); 5] = [
+    ("1KiB", 1 << 10),
+    ("64KiB", 64 << 10),
+    ("1MiB", 1 << 20),
+    ("16MiB", 16 << 20),
+    ("256MiB", 256 << 20),
+];
+
+// The number of bytes moved per benchmark, split into payloads, within `MIN_OPS` and `MAX_OPS` operations.
+const BYTES_PER_BENCH: usize = 64 << 20;
+const MIN_OPS: usize = 2;
+const MAX_OPS: usize = 100;
+
+// The database of the IndexedDB benchmarks, cleared when they're done.
+const DB_NAME: &str = "emscripten-functions-benches";
+
+fn ops(size: usize) -> usize {
+    (BYTES_PER_BENCH / size).clamp(MIN_OPS, MAX_OPS)
+}
+
+// The latencies of the operations of a benchmark, from which its throughput and latency distribution are recorded.
+struct Timed {
+    name: String,
+    size: usize,
+    start: f64,
+    latencies: Vec<f64>,
+}
+
+impl Timed {
+    fn new(name: String, size: usize) -> Self {
+        Self {
+            name,
+            size,
+            start: get_now(),
+            latencies: Vec::new(),
+        }
+    }
+
+    fn record(mut self, harness: &mut Harness) {
+        let millis = get_now() - self.start;
+        let bytes = (self.size * self.latencies.len()) as u64;
+        harness.throughput(&self.name, bytes, millis);
+        harness.distribution(&self.name, &mut self.latencies);
+    }
+}
+
+// Awaits the operation, adding its latency to `timed`, or records the benchmark as skipped if it failed.
+macro_rules! timed {
+    ($harness:expr, $timed:expr, $op:expr) => {{
+        let start = get_now();
+        match $op.await {
+            Ok(value) => {
+                $timed.latencies.push(get_now() - start);
+                Some(value)
+            }
+            Err(_) => {
+                $harness.skip(&$timed.name, "the operation failed");
+                None
+            }
+        }
+    }};
+}
+
+async fn idb(harness: &mut Harness, sizes: &[(&str, usize)]) {
+    let store = Store::new(DB_NAME);
+    for &(size_name, size) in sizes {
+        let payload = vec![0x5a; size];
+        let ops = ops(size);
+        let name = |operation: &str| format!("io/idb/{}/{}", operation, size_name);
+
+        // Each store awaited before the next, so that each is its own transaction.
+        if harness.selected(&name("array/single")) {
+            let mut timed = Timed::new(name("array/single"), size);
+            for i in 0..ops {
+                let data = payload.clone();
+                if timed!(
+                    harness,
+                    timed,
+                    idb_store(&store, format!("single-{i}"), data)
+                )
+                .is_none()
+                {
+                    break;
+                }
+            }
+            if timed.latencies.len() == ops {
+                timed.record(harness);
+            }
+        }
+
+        // All the stores queued in one batch, written in a single transaction.
+        if harness.selected(&name("array/batched")) {
+            let data: Vec<Vec<u8>> = (0..ops).map(|_| payload.clone()).collect();
+            let mut timed = Timed::new(name("array/batched"), size);
+            let pending: Vec<_> = data
+                .into_iter()
+                .enumerate()
+                .map(|(i, data)| idb_store(&store, format!("batched-{i}"), data))
+                .collect();
+            for future in pending {
+                if timed!(harness, timed, future).is_none() {
+                    break;
+                }
+            }
+            // The latencies are those of the whole batch, from its start.
+            let latency = get_now() - timed.start;
+            timed
+                .latencies
+                .iter_mut()
+                .for_each(|value| *value = latency);
+            if timed.latencies.len() == ops {
+                timed.record(harness);
+            }
+        }
+
+        if harness.selected(&name("array/load")) {
+            let mut timed = Timed::new(name("array/load"), size);
+            for i in 0..ops {
+                if timed!(harness, timed, idb_load(&store, &format!("single-{i}"))).is_none() {
+                    break;
+                }
+            }
+            if timed.latencies.len() == ops {
+                timed.record(harness);
+            }
+        }
+
+        // The blobs block until they're stored or loaded, which asyncify unwinds the task for.
+        // Reading their data synchronously is only supported in workers, so only their handles are loaded.
+        if !has_asyncify() {
+            harness.skip(&name("blob"), "needs a build with -sASYNCIFY");
+            continue;
+        }
+        if harness.selected(&name("blob/store")) {
+            let mut timed = Timed::new(name("blob/store"), size);
+            for i in 0..ops {
+                let blob = async { store.store_blob(&format!("blob-{i}"), &payload) };
+                if timed!(harness, timed, blob).is_none() {
+                    break;
+                }
+            }
+            if timed.latencies.len() == ops {
+                timed.record(harness);
+            }
+        }
+        if harness.selected(&name("blob/load_handle")) {
+            let mut timed = Timed::new(name("blob/load_handle"), size);
+            for i in 0..ops {
+                let blob = async { store.load_blob(&format!("blob-{i}")) };
+                if timed!(harness, timed, blob).is_none() {
+                    break;
+                }
+            }
+            if timed.latencies.len() == ops {
+                timed.record(harness);
+            }
+        }
+    }
+    let _ = callback_future(|callback| store.clear(callback)).await;
+}
+
+type Done = Rc<RefCell<Option<Box<dyn FnOnce(Result<usize, ()>)>>>>;
+
+fn complete(done: &Done, result: Result<usize, ()>) {
+    if let Some(callback) = done.borrow_mut().take() {
+        callback(result);
+    }
+}
+
+// Sends the request returned by `build`, which completes `done` with the number of bytes received on success.
+fn fetch<B>(build: B) -> CallbackFuture<Result<usize, ()>>
+where
+    B: FnOnce(Done) -> FetchRequest,
+{
+    callback_future(|callback| {
+        let done: Done = Rc::new(RefCell::new(Some(callback)));
+        let onerror = done.clone();
+        let request = build(done.clone()).on_error(move |_| complete(&onerror, Err(())));
+        if request.send().is_none() {
+            complete(&done, Err(()));
+        }
+    })
+}
+
+async fn downloads(harness: &mut Harness, sizes: &[(&str, usize)]) {
+    for &(size_name, size) in sizes {
+        let Some(url) = run_script_string(format!(
+            "URL.createObjectURL(new Blob([new Uint8Array({})]))",
+            size
+        )) else {
+            harness.skip(
+                &format!("io/download/{}", size_name),
+                "couldn't create the blob",
+            );
+            continue;
+        };
+        let ops = ops(size);
+        let name = |operation: &str| format!("io/{}/{}", operation, size_name);
+
+        if harness.selected(&name("wget/get")) {
+            let mut timed = Timed::new(name("wget/get"), size);
+            for _ in 0..ops {
+                if timed!(harness, timed, wget(url.as_str())).is_none() {
+                    break;
+                }
+            }
+            if timed.latencies.len() == ops {
+                timed.record(harness);
+            }
+        }
+
+        if harness.selected(&name("fetch/memory")) {
+            let mut timed = Timed::new(name("fetch/memory"), size);
+            for _ in 0..ops {
+                let request = fetch(|done| {
+                    FetchRequest::new(url.as_str())
+                        .on_success(move |response| complete(&done, Ok(response.data().len())))
+                });
+                if timed!(harness, timed, request).is_none() {
+                    break;
+                }
+            }
+            if timed.latencies.len() == ops {
+                timed.record(harness);
+            }
+        }
+
+        if harness.selected(&name("fetch/stream")) {
+            let mut timed = Timed::new(name("fetch/stream"), size);
+            for _ in 0..ops {
+                let request = fetch(|done| {
+                    FetchRequest::new(url.as_str())
+                        .stream_into(Vec::with_capacity(size), move |data, _| {
+                            complete(&done, Ok(data.len()))
+                        })
+                });
+                if timed!(harness, timed, request).is_none() {
+                    break;
+                }
+            }
+            if timed.latencies.len() == ops {
+                timed.record(harness);
+            }
+        }
+
+        // The middle half of the payload.
+        if harness.selected(&name("fetch/range")) {
+            let mut timed = Timed::new(name("fetch/range"), size / 2);
+            for _ in 0..ops {
+                let request = fetch(|done| {
+                    fetch_range(url.as_str(), (size / 4) as u64, (size / 2) as u64)
+                        .on_success(move |response| complete(&done, Ok(response.data().len())))
+                });
+                if timed!(harness, timed, request).is_none() {
+                    break;
+                }
+            }
+            if timed.latencies.len() == ops {
+                timed.record(harness);
+            }
+        }
+
+        run_script(format!("URL.revokeObjectURL({:?})", url));
+    }
+}
+
+// Writes and reads back files of each size in the OPFS, on the calling thread, which mustn't be the main browser thread.
+#[cfg(feature = "wasmfs")]
+fn opfs(filter: Option<String>, sizes: Vec<(&'static str, usize)>) -> Harness {
+    use emscripten_functions::wasmfs::{mount, Backend};
+
+    let mut harness = Harness::new(filter);
+    if mount("/opfs", Backend::opfs()).is_err() {
+        harness.skip("io/opfs", "couldn't mount the OPFS");
+        return harness;
+    }
+    for (size_name, size) in sizes {
+        let payload = vec![0x5a; size];
+        let ops = ops(size);
+        let path = |i: usize| format!("/opfs/bench-{}-{}.bin", size_name, i);
+        let name = |operation: &str| format!("io/opfs/{}/{}", operation, size_name);
+
+        let mut timed = Timed::new(name("write"), size);
+        for i in 0..ops {
+            let start = get_now();
+            if std::fs::write(path(i), &payload).is_err() {
+                harness.skip(&timed.name, "the operation failed");
+                break;
+            }
+            timed.latencies.push(get_now() - start);
+        }
+        if timed.latencies.len() != ops {
+            continue;
+        }
+        timed.record(&mut harness);
+
+        let mut timed = Timed::new(name("read"), size);
+        for i in 0..ops {
+            let start = get_now();
+            if std::fs::read(path(i)).is_err() {
+                harness.skip(&timed.name, "the operation failed");
+                break;
+            }
+            timed.latencies.push(get_now() - start);
+        }
+        if timed.latencies.len() == ops {
+            timed.record(&mut harness);
+        }
+        for i in 0..ops {
+            let _ = std::fs::remove_file(path(i));
+        }
+    }
+    harness
+}
+
+async fn run(harness: &mut Harness, has_document: bool) {
+    // The payloads, and a few copies of them, must fit in the heap.
+    let stats = memory::stats();
+    let available = stats.heap_max.saturating_sub(stats.sbrk_top);
+    let mut sizes = Vec::new();
+    for (size_name, size) in SIZES {
+        if size * (MIN_OPS + 2) <= available {
+            sizes.push((size_name, size));
+        } else {
+            harness.skip(
+                &format!("io/{}", size_name),
+                "needs a bigger heap, with -sALLOW_MEMORY_GROWTH and -sMAXIMUM_MEMORY",
+            );
+        }
+    }
+
+    if has_document {
+        idb(harness, &sizes).await;
+        downloads(harness, &sizes).await;
+    } else {
+        harness.skip("io/idb", "needs a browser");
+        harness.skip("io/download", "needs a browser");
+    }
+
+    #[cfg(feature = "wasmfs")]
+    if emscripten_functions::threading::has_threading_support() {
+        let (sender, receiver) = std::sync::mpsc::channel();
+        let filter = harness.filter().map(str::to_string);
+        std::thread::spawn(move || {
+            let _ = sender.send(opfs(filter, sizes));
+        });
+        loop {
+            match receiver.try_recv() {
+                Ok(opfs_harness) => break harness.merge(opfs_harness),
+                Err(std::sync::mpsc::TryRecvError::Empty) => {
+                    emscripten_functions::executor::sleep(10.0).await
+                }
+                Err(std::sync::mpsc::TryRecvError::Disconnected) => {
+                    break harness.skip("io/opfs", "the pthread panicked")
+                }
+            }
+        }
+    } else {
+        harness.skip("io/opfs", "needs a build with pthreads");
+    }
+    #[cfg(not(feature = "wasmfs"))]
+    harness.skip(
+        "io/opfs",
+        "needs the wasmfs feature, and a build with -sWASMFS",
+    );
+}
+
+/// The results of the suite, once its task is done.
+pub struct IoSuite {
+    results: Rc<RefCell<Option<Harness>>>,
+}
+
+impl IoSuite {
+    /// Starts the suite in an async task, with its own harness.
+    pub fn start(filter: Option<String>, has_document: bool) -> Self {
+        let results = Rc::new(RefCell::new(None));
+        let task_results = results.clone();
+        spawn_local(async move {
+            let mut harness = Harness::new(filter);
+            run(&mut harness, has_document).await;
+            *task_results.borrow_mut() = Some(harness);
+        });
+        Self { results }
+    }
+
+    /// Returns the results of the suite if it's done.
+    pub fn take(&self) -> Option<Harness> {
+        self.results.borrow_mut().take()
+    }
+}
@@ -0,0 +1,202 @@
+//! Benchmarks of the overhead of the emscripten-functions wrappers, run in node or a browser.
+//!
+//! Build with `cargo build --release --target wasm32-unknown-emscripten -p emscripten-functions-benches`,
+//! then run the resulting JS file with node, or open it in a browser with a `#canvas` element.
+//! An optional argument runs only the benchmarks whose names contain it.
+//! The results are printed as JSON on the last line of the output.
+
+#[cfg(target_os = "emscripten")]
+mod harness;
+#[cfg(target_os = "emscripten")]
+mod input;
+#[cfg(target_os = "emscripten")]
+mod io;
+#[cfg(target_os = "emscripten")]
+mod main_loop;
+#[cfg(target_os = "emscripten")]
+mod scripts;
+#[cfg(target_os = "emscripten")]
+mod threads;
+#[cfg(target_os = "emscripten")]
+mod wrappers;
+
+// The number of main loop ticks timed, after a warm-up one.
+#[cfg(target_os = "emscripten")]
+const TICKS: u64 = 1000;
+
+#[cfg(target_os = "emscripten")]
+fn main() {
+    use emscripten_functions::emscripten::{
+        cancel_main_loop, get_now, run_script_int, set_main_loop_timing,
+        set_main_loop_with_arg_direct, MainLoopTiming,
+    };
+    use harness::{BenchResult, Harness};
+
+    let filter = std::env::args().nth(1);
+    let has_document = run_script_int("typeof document != 'undefined'") != 0;
+    let environment = if has_document { "browser" } else { "node" };
+
+    let mut harness = Harness::new(filter);
+    wrappers::run(&mut harness);
+    wrappers::run_browser(&mut harness, has_document);
+    scripts::run(&mut harness, "main");
+    input::run(&mut harness, has_document);
+    let stress = main_loop::StressSuite::new(&mut harness);
+
+    // The dispatch of a main loop tick of `set_main_loop_with_arg_direct`, without the thread-local `RefCell` trampoline
+    // and the per-tick hooks of `set_main_loop`, whose tick is timed next.
+    let mut state = Some((harness, stress));
+    let mut ticks = 0;
+    let mut start = 0.0;
+    set_main_loop_with_arg_direct(
+        move |_| {
+            if ticks == 0 {
+                set_main_loop_timing(&MainLoopTiming::SetImmediate);
+                start = get_now();
+            }
+            ticks += 1;
+            if ticks <= TICKS {
+                return;
+            }
+            let Some((mut harness, stress)) = state.take() else {
+                return;
+            };
+
+            let ns_per_op = (get_now() - start) * 1e6 / TICKS as f64;
+            harness.record(BenchResult {
+                name: "emscripten::set_main_loop_with_arg_direct tick".to_string(),
+                ns_per_op,
+                min_ns_per_op: ns_per_op,
+                iterations: TICKS,
+            });
+            cancel_main_loop();
+            run_main_loop(harness, stress, environment);
+        },
+        (),
+        0,
+        true,
+    );
+}
+
+// The suites the main loop runs one after the other, once the pthread benchmarks have finished.
+#[cfg(target_os = "emscripten")]
+enum Stage {
+    Stress,
+    Io(io::IoSuite),
+    Threads(threads::ThreadsSuite),
+}
+
+// Sets the main loop that times its own ticks, then runs the pthread benchmarks, the main loop stress suite,
+// and the I/O and threads suites.
+#[cfg(target_os = "emscripten")]
+fn run_main_loop(
+    mut harness: harness::Harness,
+    mut stress: main_loop::StressSuite,
+    environment: &'static str,
+) {
+    use std::sync::mpsc;
+
+    use emscripten_functions::{
+        emscripten::{
+            cancel_main_loop, get_now, set_main_loop, set_main_loop_timing, MainLoopTiming,
+        },
+        threading::has_threading_support,
+    };
+    use harness::{BenchResult, Harness};
+
+    // The dispatch of a main loop tick, from the JS scheduler to the rust closure, with `setImmediate`-like timing
+    // so that the display refresh rate doesn't bound it.
+    // Then the pthread benchmarks run, while the main loop keeps the main thread free to answer their proxied calls.
+    let mut pthread_results: Option<mpsc::Receiver<Harness>> = None;
+    let mut stage = Stage::Stress;
+    let has_document = environment == "browser";
+    let mut ticks = 0;
+    let mut start = 0.0;
+    set_main_loop(
+        move || {
+            if ticks == 0 {
+                set_main_loop_timing(&MainLoopTiming::SetImmediate);
+                start = get_now();
+            }
+            ticks += 1;
+            if ticks <= TICKS {
+                return;
+            }
+
+            if ticks == TICKS + 1 {
+                let ns_per_op = (get_now() - start) * 1e6 / TICKS as f64;
+                harness.record(BenchResult {
+                    name: "emscripten::set_main_loop tick".to_string(),
+                    ns_per_op,
+                    min_ns_per_op: ns_per_op,
+                    iterations: TICKS,
+                });
+
+                if has_threading_support() {
+                    let filter = harness.filter().map(str::to_string);
+                    let (sender, receiver) = mpsc::channel();
+                    std::thread::spawn(move || {
+                        let mut harness = Harness::new(filter);
+                        scripts::run(&mut harness, "pthread");
+                        let _ = sender.send(harness);
+                    });
+                    pthread_results = Some(receiver);
+                } else {
+                    harness.skip("pthread/scripts", "needs a build with pthreads");
+                }
+            }
+
+            if let Some(receiver) = &pthread_results {
+                match receiver.try_recv() {
+                    Ok(pthread_harness) => harness.merge(pthread_harness),
+                    Err(mpsc::TryRecvError::Empty) => return,
+                    Err(mpsc::TryRecvError::Disconnected) => {
+                        harness.skip("pthread/scripts", "the pthread panicked")
+                    }
+                }
+                pthread_results = None;
+            }
+            // The I/O and threads suites run from their async tasks, each starting once the previous one's results are merged,
+            // while the main loop waits for them, ticking slowly so as not to compete with their callbacks.
+            match &stage {
+                // The stress suite sets its own timings, from the next tick on.
+                Stage::Stress => {
+                    if !stress.tick(&mut harness) {
+                        return;
+                    }
+                    set_main_loop_timing(&MainLoopTiming::SetTimeout(100));
+                    stage = Stage::Io(io::IoSuite::start(
+                        harness.filter().map(str::to_string),
+                        has_document,
+                    ));
+                }
+                Stage::Io(suite) => {
+                    let Some(io_harness) = suite.take() else {
+                        return;
+                    };
+                    harness.merge(io_harness);
+                    stage = Stage::Threads(threads::ThreadsSuite::start(
+                        harness.filter().map(str::to_string),
+                        has_document,
+                    ));
+                }
+                Stage::Threads(suite) => {
+                    let Some(threads_harness) = suite.take() else {
+                        return;
+                    };
+                    harness.merge(threads_harness);
+                    cancel_main_loop();
+                    println!("{}", harness.to_json(environment));
+                }
+            }
+        },
+        0,
+        false,
+    );
+}
+
+#[cfg(not(target_os = "emscripten"))]
+fn main() {
+    eprintln!("the benchmarks run on the wasm32-unknown-emscripten target only");
+    std::process::exit(1);
+}
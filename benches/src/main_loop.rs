@@ -0,0 +1,233 @@
+//! The main loop of `set_main_loop_with_arg` under synthetic load, in each `MainLoopTiming` mode: no load, a variable amount
+//! of work per tick, JS garbage collection pressure, and background threads contending for the cores.
+//!
+//! Each scenario runs for [`TICKS`] ticks, and records three distributions, in milliseconds:
+//! * `main_loop/<timing>/<load>/frame_time` - The intervals between the starts of the ticks.
+//! * `main_loop/<timing>/<load>/timing_error` - How far the intervals are from the median interval of the unloaded scenario
+//!   of the same timing: the pacing accuracy under load.
+//! * `main_loop/<timing>/<load>/input_latency` - A proxy of the input-to-photon latency: the time from an input, timestamped
+//!   by a timer firing between the ticks like an event listener would, to the end of the tick that handled it.
+
+use std::{
+    hint::black_box,
+    sync::{
+        atomic::{AtomicBool, Ordering},
+        Arc,
+    },
+};
+
+use emscripten_functions::{
+    emscripten::{get_now, set_main_loop_timing, MainLoopTiming},
+    rng,
+    script::Script,
+    threading::has_threading_support,
+};
+
+use crate::harness::Harness;
+
+/// The number of ticks timed per scenario, after the one switching to it.
+pub const TICKS: usize = 120;
+
+// The timing modes: every vsync, a 16ms `setTimeout` pacing, and back to back ticks.
+const TIMINGS: [(&str, MainLoopTiming); 3] = [
+    ("raf1", MainLoopTiming::RequestAnimationFrame(1)),
+    ("timeout16", MainLoopTiming::SetTimeout(16)),
+    ("immediate", MainLoopTiming::SetImmediate),
+];
+
+// The most work of a tick of the variable load, in milliseconds: half a 60 Hz frame.
+const VARIABLE_MAX_MILLIS: f64 = 8.0;
+
+// The number of background threads of the contention load.
+const WORKERS: usize = 2;
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+enum Load {
+    Idle,
+    Variable,
+    Garbage,
+    Workers,
+}
+
+impl Load {
+    // The unloaded scenario comes first, as the reference of the timing errors of the others.
+    const ALL: [Load; 4] = [Load::Idle, Load::Variable, Load::Garbage, Load::Workers];
+
+    fn name(self) -> &'static str {
+        match self {
+            Load::Idle => "idle",
+            Load::Variable => "variable",
+            Load::Garbage => "gc",
+            Load::Workers => "workers",
+        }
+    }
+}
+
+// Short-lived JS objects, about a megabyte of them per call, for the garbage collector to run during the ticks.
+const GARBAGE: &str = r#"
+    var objects = [];
+    for (var i = 0; i < 20000; i++) {
+        objects.push({ index: i, values: [i, i + 1] });
+    }
+    return objects.length;
+"#;
+
+// Timestamps an input from a timer firing after `$0` milliseconds, between the ticks.
+const ARM_INPUT: &str = r#"
+    globalThis.emscriptenFunctionsBenchInput = -1;
+    setTimeout(function () {
+        globalThis.emscriptenFunctionsBenchInput = performance.now();
+    }, $0);
+"#;
+
+// Returns the time of the pending input, or -1 if there's none, and consumes it.
+const TAKE_INPUT: &str = r#"
+    var time = globalThis.emscriptenFunctionsBenchInput;
+    if (time >= 0) {
+        globalThis.emscriptenFunctionsBenchInput = -1;
+    }
+    return time;
+"#;
+
+/// The scenarios of the suite, run one after the other by the ticks of the main loop.
+pub struct StressSuite {
+    scenarios: Vec<(usize, Load)>,
+    current: usize,
+    ticks: usize,
+    last_start: f64,
+    frame_times: Vec<f64>,
+    latencies: Vec<f64>,
+    // The timing and median interval of the last unloaded scenario.
+    reference: Option<(usize, f64)>,
+    workers_stop: Option<Arc<AtomicBool>>,
+    garbage: Script,
+    arm_input: Script,
+    take_input: Script,
+}
+
+impl StressSuite {
+    /// Creates the suite, skipping the scenarios that can't run in this environment.
+    pub fn new(harness: &mut Harness) -> Self {
+        let mut scenarios = Vec::new();
+        for (timing, (timing_name, _)) in TIMINGS.iter().enumerate() {
+            for load in Load::ALL {
+                let name = format!("main_loop/{}/{}", timing_name, load.name());
+                if load == Load::Workers && !has_threading_support() {
+                    harness.skip(&name, "needs a build with pthreads");
+                } else if harness.selected(&name) {
+                    scenarios.push((timing, load));
+                }
+            }
+        }
+        let compile = |source| Script::compile(source).expect("the benchmark script compiles");
+        Self {
+            scenarios,
+            current: 0,
+            ticks: 0,
+            last_start: 0.0,
+            frame_times: Vec::with_capacity(TICKS),
+            latencies: Vec::with_capacity(TICKS),
+            reference: None,
+            workers_stop: None,
+            garbage: compile(GARBAGE),
+            arm_input: compile(ARM_INPUT),
+            take_input: compile(TAKE_INPUT),
+        }
+    }
+
+    fn arm(&self) {
+        // Anywhere within about a frame, so that the inputs fall at any point between two ticks.
+        self.arm_input.call(&[(rng::random_f32() * 16.0) as f64]);
+    }
+
+    /// Runs a tick of the current scenario, and returns `true` once all of them ran.
+    pub fn tick(&mut self, harness: &mut Harness) -> bool {
+        let Some(&(timing, load)) = self.scenarios.get(self.current) else {
+            return true;
+        };
+        let start = get_now();
+
+        // The tick switching to the scenario isn't timed, as its interval is paced by the previous one.
+        if self.ticks == 0 {
+            set_main_loop_timing(&TIMINGS[timing].1);
+            if load == Load::Workers {
+                let stop = Arc::new(AtomicBool::new(false));
+                for _ in 0..WORKERS {
+                    let stop = stop.clone();
+                    std::thread::spawn(move || {
+                        let mut x = 1u64;
+                        while !stop.load(Ordering::Relaxed) {
+                            for _ in 0..1000 {
+                                x = black_box(x.wrapping_mul(6364136223846793005).wrapping_add(1));
+                            }
+                        }
+                    });
+                }
+                self.workers_stop = Some(stop);
+            }
+            self.arm();
+            self.ticks = 1;
+            self.last_start = start;
+            return false;
+        }
+        self.frame_times.push(start - self.last_start);
+        self.last_start = start;
+
+        let input = self.take_input.call_double(&[]);
+        match load {
+            Load::Idle | Load::Workers => {}
+            Load::Variable => {
+                let until = start + rng::random_f32() as f64 * VARIABLE_MAX_MILLIS;
+                while get_now() < until {}
+            }
+            Load::Garbage => {
+                self.garbage.call_int(&[]);
+            }
+        }
+        if input >= 0.0 {
+            self.latencies.push(get_now() - input);
+            self.arm();
+        }
+
+        self.ticks += 1;
+        if self.ticks <= TICKS {
+            return false;
+        }
+        self.finish(harness, timing, load);
+        self.current += 1;
+        self.current == self.scenarios.len()
+    }
+
+    fn finish(&mut self, harness: &mut Harness, timing: usize, load: Load) {
+        if let Some(stop) = self.workers_stop.take() {
+            stop.store(true, Ordering::Relaxed);
+        }
+        let name = format!("main_loop/{}/{}", TIMINGS[timing].0, load.name());
+
+        let mut frame_times = std::mem::take(&mut self.frame_times);
+        frame_times.sort_unstable_by(f64::total_cmp);
+        if load == Load::Idle {
+            self.reference = Some((timing, frame_times[frame_times.len() / 2]));
+        }
+        harness.distribution(&format!("{}/frame_time", name), &mut frame_times);
+        match self.reference {
+            Some((reference_timing, reference)) if reference_timing == timing => {
+                let mut errors: Vec<f64> = frame_times
+                    .iter()
+                    .map(|interval| (interval - reference).abs())
+                    .collect();
+                harness.distribution(&format!("{}/timing_error", name), &mut errors);
+            }
+            _ => harness.skip(
+                &format!("{}/timing_error", name),
+                "the unloaded scenario of this timing didn't run",
+            ),
+        }
+        harness.distribution(&format!("{}/input_latency", name), &mut self.latencies);
+
+        self.frame_times = frame_times;
+        self.frame_times.clear();
+        self.latencies.clear();
+        self.ticks = 0;
+    }
+}
@@ -0,0 +1,74 @@
+//! The matrix of the ways to run JS code: evaluated with `run_script` and `run_script_main_thread`,
+//! compiled once into a `Script`, or imported with `em_js!`, across script sizes and call rates, from the thread it runs on.
+//!
+//! The results are named `<thread>/scripts/<path>/<size>/<rate>`, e.g. `pthread/scripts/run_script_main_thread/1KiB/back-to-back`.
+//! From a pthread, `run_script_main_thread` is a synchronous `MAIN_THREAD_EM_ASM` call proxied to the main thread and back;
+//! from the main thread, it runs directly.
+
+use emscripten_functions::{
+    em_js,
+    emscripten::{run_script, run_script_main_thread},
+    script::Script,
+};
+
+use crate::harness::Harness;
+
+// The sizes of the scripts, in bytes of source: a trivial expression, then some amount of code to parse and run.
+const SIZES: [(&str, usize); 3] = [("tiny", 0), ("1KiB", 1024), ("16KiB", 16 * 1024)];
+
+// The idle time before each call of the spaced rate, in milliseconds.
+const SPACED_GAP_MILLIS: f64 = 1.0;
+
+em_js! {
+    fn bench_em_js_add(x: f64) -> f64 {
+        "return x + 1;"
+    }
+}
+
+// Returns the statements of a script of about the given size, computing `x`.
+fn statements(size: usize) -> String {
+    let mut code = String::from("var x = 1;");
+    let mut i = 0;
+    while code.len() < size {
+        code.push_str(&format!(" x = (x * 31 + {}) % 65521;", i));
+        i += 1;
+    }
+    code
+}
+
+/// Runs the matrix on the calling thread, under the given thread name: `main` or `pthread`.
+pub fn run(harness: &mut Harness, thread: &str) {
+    for (size_name, size) in SIZES {
+        let code = statements(size);
+        // `eval()` returns the value of the last statement.
+        let eval_source = format!("{} x", code);
+        let script =
+            Script::compile(format!("{} return x;", code)).expect("the benchmark script compiles");
+
+        for rate in ["back-to-back", "spaced"] {
+            let name = |path: &str| format!("{}/scripts/{}/{}/{}", thread, path, size_name, rate);
+            let bench = |harness: &mut Harness, path: &str, op: &mut dyn FnMut()| {
+                if rate == "spaced" {
+                    harness.bench_spaced(&name(path), SPACED_GAP_MILLIS, op);
+                } else {
+                    harness.bench(&name(path), op);
+                }
+            };
+
+            bench(harness, "run_script", &mut || run_script(&eval_source));
+            bench(harness, "run_script_main_thread", &mut || {
+                run_script_main_thread(&eval_source)
+            });
+            bench(harness, "Script", &mut || {
+                script.call_double(&[]);
+            });
+            if size == 0 {
+                bench(harness, "em_js", &mut || unsafe {
+                    bench_em_js_add(1.0);
+                });
+            } else {
+                harness.skip(&name("em_js"), "the em_js! code is fixed at compile time");
+            }
+        }
+    }
+}
@@ -0,0 +1,478 @@
+//! The scalability of the threading backends, on the same workloads at 1 to N cores: emscripten pthreads, fed by channels,
+//! the `WasmWorkerPool` and the work-stealing `ParallelPool` on Wasm Workers, and the `WorkerPool` of separate worker programs.
+//!
+//! The workloads are runs of a fixed compute kernel, whose results are handed back to the main thread:
+//! * `threads/<backend>/parallel` - An embarrassingly parallel one, split in a task per core.
+//! * `threads/<backend>/fork_join` - A fine-grained one, forking [`FINE_TASKS`] tasks of a few microseconds, and joining them.
+//!
+//! Each records its speedup curve, over the same work run serially on the main thread, and the fork-join one also records
+//! its per-task overhead at each core count, as `threads/<backend>/fork_join/<cores>/task_overhead`: the core time
+//! of the run past that of the serial work, per task. `threads/<backend>/spawn_latency` is the distribution of the times
+//! from the creation of a thread or worker to its first message received on the main thread, in milliseconds.
+//!
+//! These run from an async task once the other benchmarks are done:
+//! * The pthread ones need a build with `-pthread`. The threads come from a pool prewarmed beforehand, as they would in a program.
+//! * The Wasm Worker ones need the `wasm_workers` feature of this crate, and a build linked with `-sWASM_WORKERS`.
+//! * The `WorkerPool` ones need a browser, and the `benches/worker` program next to the JS file of the benchmarks.
+
+use std::{
+    cell::{Cell, RefCell},
+    hint::black_box,
+    rc::Rc,
+    sync::mpsc,
+    thread::JoinHandle,
+};
+
+use emscripten_functions::{
+    emscripten::get_now,
+    executor::{callback_future, sleep, spawn_local, timeout},
+    proxying::run_on_main_thread_async,
+    threading::{has_threading_support, num_logical_cores, prewarm_async},
+    worker::WorkerPool,
+};
+#[cfg(feature = "wasm_workers")]
+use emscripten_functions::{
+    parallel::{self, ParallelPool},
+    wasm_worker::{self, post_to_parent},
+    wasm_worker_pool::{self, WasmWorkerPool},
+};
+
+use crate::harness::{BenchResult, Harness};
+
+// The iterations of one unit of work, a couple of microseconds. `benches/worker` has the same kernel.
+const UNIT_ITERATIONS: u64 = 1000;
+
+// The units of the embarrassingly parallel workload, about a hundred milliseconds serially.
+const COARSE_UNITS: u64 = 50_000;
+
+/// The number of tasks of the fork-join workload.
+pub const FINE_TASKS: usize = 2048;
+
+// The units of each task of the fork-join workload.
+const FINE_UNITS: u64 = 4;
+
+// The number of runs of each workload per core count, of which the median is recorded.
+const REPEATS: usize = 5;
+
+// The number of threads or workers created per backend for the spawn latency.
+const SPAWNS: usize = 20;
+
+// The most cores the workloads are run at.
+const MAX_CORES: usize = 16;
+
+// The time given to new workers to start before they're timed, in milliseconds.
+const SETTLE_MILLIS: f64 = 100.0;
+
+// The worker program of the `WorkerPool` backend, built from `benches/worker`, and how long it's given to load.
+const WORKER_URL: &str = "emscripten_functions_bench_worker.js";
+const WORKER_TIMEOUT_MILLIS: f64 = 10_000.0;
+
+fn work(units: u64) -> u64 {
+    let mut x = units;
+    for _ in 0..units * UNIT_ITERATIONS {
+        x = black_box(
+            x.wrapping_mul(6364136223846793005)
+                .wrapping_add(1442695040888963407),
+        );
+    }
+    x
+}
+
+// Called with the time the last task of a run was received on the main thread.
+type Done = Box<dyn FnOnce(f64)>;
+
+// Counts the tasks of a run down.
+struct Join {
+    remaining: Cell<usize>,
+    done: Cell<Option<Done>>,
+}
+
+impl Join {
+    fn complete(&self) {
+        self.remaining.set(self.remaining.get() - 1);
+        if self.remaining.get() == 0 {
+            if let Some(done) = self.done.take() {
+                done(get_now());
+            }
+        }
+    }
+}
+
+thread_local! {
+    // The join of the tasks completed by closures sent from other threads, which can't hold its `Rc`.
+    static MAIN_JOIN: RefCell<Option<Rc<Join>>> = const { RefCell::new(None) };
+}
+
+fn complete_main_join() {
+    // Cloned out, as completing the join can start the next run.
+    if let Some(join) = MAIN_JOIN.with(|join| join.borrow().clone()) {
+        join.complete();
+    }
+}
+
+// Returns the time the given tasks took, from their dispatch to their join on the main thread, in milliseconds,
+// dispatching each with its index and units.
+async fn join_tasks<F>(tasks: &[u64], mut dispatch: F) -> f64
+where
+    F: FnMut(usize, u64, &Rc<Join>),
+{
+    let start = get_now();
+    let end = callback_future(|done| {
+        let join = Rc::new(Join {
+            remaining: Cell::new(tasks.len()),
+            done: Cell::new(Some(done)),
+        });
+        MAIN_JOIN.with(|main_join| *main_join.borrow_mut() = Some(join.clone()));
+        for (index, &units) in tasks.iter().enumerate() {
+            dispatch(index, units, &join);
+        }
+    })
+    .await;
+    MAIN_JOIN.with(|main_join| *main_join.borrow_mut() = None);
+    end - start
+}
+
+// Pthreads waiting on their channels for tasks, dispatched round robin, each proxying its completion to the main thread.
+struct PthreadPool {
+    senders: Vec<mpsc::Sender<u64>>,
+    threads: Vec<JoinHandle<()>>,
+}
+
+impl PthreadPool {
+    fn new(count: usize) -> Self {
+        let (senders, threads) = (0..count)
+            .map(|_| {
+                let (sender, receiver) = mpsc::channel::<u64>();
+                let thread = std::thread::spawn(move || {
+                    while let Ok(units) = receiver.recv() {
+                        black_box(work(units));
+                        run_on_main_thread_async(complete_main_join);
+                    }
+                });
+                (sender, thread)
+            })
+            .unzip();
+        Self { senders, threads }
+    }
+}
+
+impl Drop for PthreadPool {
+    fn drop(&mut self) {
+        // The threads exit once their channels are closed.
+        self.senders.clear();
+        for thread in self.threads.drain(..) {
+            let _ = thread.join();
+        }
+    }
+}
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+enum Kind {
+    Pthread,
+    WasmWorkerPool,
+    ParallelPool,
+    WorkerPool,
+}
+
+impl Kind {
+    const ALL: [Kind; 4] = [
+        Kind::Pthread,
+        Kind::WasmWorkerPool,
+        Kind::ParallelPool,
+        Kind::WorkerPool,
+    ];
+
+    fn name(self) -> &'static str {
+        match self {
+            Kind::Pthread => "pthread",
+            Kind::WasmWorkerPool => "wasm_worker_pool",
+            Kind::ParallelPool => "parallel_pool",
+            Kind::WorkerPool => "worker_pool",
+        }
+    }
+}
+
+// A backend running the tasks on a given number of cores.
+enum Backend {
+    Pthread(PthreadPool),
+    #[cfg(feature = "wasm_workers")]
+    WasmWorkerPool(WasmWorkerPool),
+    // The calling thread is one of its cores.
+    #[cfg(feature = "wasm_workers")]
+    ParallelPool(ParallelPool),
+    WorkerPool(WorkerPool),
+}
+
+impl Backend {
+    // Creates the backend and waits for its workers to run a first task each, or returns why it can't run.
+    async fn new(kind: Kind, cores: usize) -> Result<Backend, &'static str> {
+        let backend = match kind {
+            Kind::Pthread => Backend::Pthread(PthreadPool::new(cores)),
+            #[cfg(feature = "wasm_workers")]
+            Kind::WasmWorkerPool => Backend::WasmWorkerPool(
+                WasmWorkerPool::new(cores).map_err(|_| "the Wasm Workers couldn't be created")?,
+            ),
+            #[cfg(feature = "wasm_workers")]
+            Kind::ParallelPool => Backend::ParallelPool(
+                ParallelPool::new(cores - 1, parallel::DEFAULT_STACK_SIZE)
+                    .map_err(|_| "the Wasm Workers couldn't be created")?,
+            ),
+            Kind::WorkerPool => Backend::WorkerPool(WorkerPool::new(WORKER_URL, cores)),
+            #[cfg(not(feature = "wasm_workers"))]
+            _ => unreachable!(
+                "the Wasm Worker backends are skipped without the wasm_workers feature"
+            ),
+        };
+        sleep(SETTLE_MILLIS).await;
+        let warm_up = vec![0; cores];
+        if timeout(backend.run(&warm_up), WORKER_TIMEOUT_MILLIS)
+            .await
+            .is_err()
+        {
+            return Err("the workers didn't start, e.g. the worker program is missing");
+        }
+        Ok(backend)
+    }
+
+    // Runs the tasks, and returns the time they took, in milliseconds.
+    async fn run(&self, tasks: &[u64]) -> f64 {
+        match self {
+            Backend::Pthread(pool) => {
+                join_tasks(tasks, |index, units, _| {
+                    let sender = &pool.senders[index % pool.senders.len()];
+                    sender.send(units).expect("the pthread is running");
+                })
+                .await
+            }
+            #[cfg(feature = "wasm_workers")]
+            Backend::WasmWorkerPool(pool) => {
+                join_tasks(tasks, |_, units, join| {
+                    let join = join.clone();
+                    pool.call(units, work, move |result| {
+                        black_box(result);
+                        join.complete();
+                    });
+                })
+                .await
+            }
+            // A synchronous fork-join, that the calling thread works on until all the tasks are done.
+            #[cfg(feature = "wasm_workers")]
+            Backend::ParallelPool(pool) => {
+                let start = get_now();
+                pool.parallel_for(0..tasks.len(), 1, |index| {
+                    black_box(work(tasks[index]));
+                });
+                get_now() - start
+            }
+            Backend::WorkerPool(pool) => {
+                join_tasks(tasks, |_, units, join| {
+                    let join = join.clone();
+                    pool.call("bench_task", &units.to_le_bytes(), move |result| {
+                        black_box(result);
+                        join.complete();
+                    });
+                })
+                .await
+            }
+        }
+    }
+}
+
+impl Drop for Backend {
+    fn drop(&mut self) {
+        // The pool's workers keep running once it's dropped, and all its tasks are done.
+        #[cfg(feature = "wasm_workers")]
+        if let Backend::WasmWorkerPool(pool) = self {
+            for worker in pool.workers() {
+                worker.terminate();
+            }
+        }
+    }
+}
+
+// Returns the times from the creation of a thread or worker to its first message on the main thread, in milliseconds.
+async fn spawn_latencies(kind: Kind) -> Result<Vec<f64>, &'static str> {
+    let mut latencies = Vec::with_capacity(SPAWNS);
+    for _ in 0..SPAWNS {
+        let latency = match kind {
+            Kind::Pthread => {
+                join_tasks(&[0], |_, _, _| {
+                    std::thread::spawn(|| run_on_main_thread_async(complete_main_join));
+                })
+                .await
+            }
+            #[cfg(feature = "wasm_workers")]
+            Kind::WasmWorkerPool => {
+                let mut worker = None;
+                let latency = join_tasks(&[0], |_, _, join| {
+                    match wasm_worker::spawn(wasm_worker_pool::DEFAULT_STACK_SIZE, || {
+                        post_to_parent(complete_main_join)
+                    }) {
+                        Ok(spawned) => worker = Some(spawned),
+                        Err(_) => join.complete(),
+                    }
+                })
+                .await;
+                let Some(worker) = worker else {
+                    return Err("the Wasm Workers couldn't be created");
+                };
+                worker.terminate();
+                latency
+            }
+            Kind::WorkerPool => {
+                let pool = WorkerPool::new(WORKER_URL, 1);
+                let first_reply = join_tasks(&[0], |_, units, join| {
+                    let join = join.clone();
+                    pool.call("bench_task", &units.to_le_bytes(), move |_| join.complete());
+                });
+                timeout(first_reply, WORKER_TIMEOUT_MILLIS)
+                    .await
+                    .map_err(|_| "the worker program didn't load")?
+            }
+            _ => break,
+        };
+        latencies.push(latency);
+    }
+    Ok(latencies)
+}
+
+// Returns the median and the minimum of the samples.
+fn median(mut samples: Vec<f64>) -> (f64, f64) {
+    samples.sort_unstable_by(f64::total_cmp);
+    (samples[samples.len() / 2], samples[0])
+}
+
+// Returns the median and the minimum of the serial runs of the tasks on the main thread, in milliseconds.
+fn serial(tasks: &[u64]) -> (f64, f64) {
+    median(
+        (0..REPEATS)
+            .map(|_| {
+                let start = get_now();
+                for &units in tasks {
+                    black_box(work(units));
+                }
+                get_now() - start
+            })
+            .collect(),
+    )
+}
+
+async fn run(harness: &mut Harness, has_document: bool) {
+    // 1, 2, 4... cores, up to the logical ones.
+    let max_cores = (num_logical_cores().max(1) as usize).min(MAX_CORES);
+    let mut core_counts: Vec<usize> = (0..)
+        .map(|power| 1 << power)
+        .take_while(|&cores| cores < max_cores)
+        .collect();
+    core_counts.push(max_cores);
+
+    let coarse_tasks = |cores: usize| -> Vec<u64> {
+        (0..cores as u64)
+            .map(|index| {
+                COARSE_UNITS * (index + 1) / cores as u64 - COARSE_UNITS * index / cores as u64
+            })
+            .collect()
+    };
+    let fine_tasks = vec![FINE_UNITS; FINE_TASKS];
+    let (coarse_serial, _) = serial(&coarse_tasks(1));
+    let (fine_serial, _) = serial(&fine_tasks);
+
+    for kind in Kind::ALL {
+        let name = format!("threads/{}", kind.name());
+        if !harness.selected(&name) {
+            continue;
+        }
+        match kind {
+            Kind::Pthread if !has_threading_support() => {
+                harness.skip(&name, "needs a build with pthreads");
+                continue;
+            }
+            // The threads of all the core counts, and those of the spawn latency, start without waiting for a worker to load.
+            Kind::Pthread => {
+                if prewarm_async(Some(max_cores + 1)).await.is_err() {
+                    harness.skip(&name, "the pthread pool couldn't be prewarmed");
+                    continue;
+                }
+            }
+            #[cfg(not(feature = "wasm_workers"))]
+            Kind::WasmWorkerPool | Kind::ParallelPool => {
+                harness.skip(
+                    &name,
+                    "needs the wasm_workers feature, and a build with -sWASM_WORKERS",
+                );
+                continue;
+            }
+            Kind::WorkerPool if !has_document => {
+                harness.skip(&name, "needs a browser");
+                continue;
+            }
+            _ => {}
+        }
+
+        // The pool's workers are created like those of the `WasmWorkerPool`.
+        if kind != Kind::ParallelPool {
+            let latency_name = format!("{}/spawn_latency", name);
+            match spawn_latencies(kind).await {
+                Ok(mut latencies) => harness.distribution(&latency_name, &mut latencies),
+                Err(reason) => harness.skip(&latency_name, reason),
+            }
+        }
+
+        for &cores in &core_counts {
+            let backend = match Backend::new(kind, cores).await {
+                Ok(backend) => backend,
+                Err(reason) => {
+                    harness.skip(&format!("{}/{}", name, cores), reason);
+                    break;
+                }
+            };
+
+            let tasks = coarse_tasks(cores);
+            let mut times = Vec::with_capacity(REPEATS);
+            for _ in 0..REPEATS {
+                times.push(backend.run(&tasks).await);
+            }
+            let (time, _) = median(times);
+            harness.speedup(&format!("{}/parallel", name), cores, time, coarse_serial);
+
+            let mut times = Vec::with_capacity(REPEATS);
+            for _ in 0..REPEATS {
+                times.push(backend.run(&fine_tasks).await);
+            }
+            let (time, min_time) = median(times);
+            harness.speedup(&format!("{}/fork_join", name), cores, time, fine_serial);
+            let overhead =
+                |time: f64| (time * cores as f64 - fine_serial).max(0.0) * 1e6 / FINE_TASKS as f64;
+            harness.record(BenchResult {
+                name: format!("{}/fork_join/{}/task_overhead", name, cores),
+                ns_per_op: overhead(time),
+                min_ns_per_op: overhead(min_time),
+                iterations: FINE_TASKS as u64,
+            });
+        }
+    }
+}
+
+/// The results of the suite, once its task is done.
+pub struct ThreadsSuite {
+    results: Rc<RefCell<Option<Harness>>>,
+}
+
+impl ThreadsSuite {
+    /// Starts the suite in an async task, with its own harness.
+    pub fn start(filter: Option<String>, has_document: bool) -> Self {
+        let results = Rc::new(RefCell::new(None));
+        let task_results = results.clone();
+        spawn_local(async move {
+            let mut harness = Harness::new(filter);
+            run(&mut harness, has_document).await;
+            *task_results.borrow_mut() = Some(harness);
+        });
+        Self { results }
+    }
+
+    /// Returns the results of the suite if it's done.
+    pub fn take(&self) -> Option<Harness> {
+        self.results.borrow_mut().take()
+    }
+}
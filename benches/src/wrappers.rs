@@ -0,0 +1,76 @@
+//! The cost of each wrapper call, mostly the crossing of the JS boundary.
+
+use emscripten_functions::{
+    clock, console, em_asm_int,
+    emscripten::{
+        get_now, get_window_title, random, run_script, run_script_int, run_script_main_thread,
+        run_script_string, set_window_title,
+    },
+    html5::{self, Target},
+    rng,
+    script::{Script, ScriptArg},
+    timers,
+};
+
+use crate::harness::Harness;
+
+/// Runs the benchmarks of the calls that work in node as in the browser.
+pub fn run(harness: &mut Harness) {
+    harness.bench("console::log", || console::log("bench"));
+    harness.bench("console::log_str", || console::log_str("bench"));
+    harness.bench("console::log!", || {
+        emscripten_functions::log!("bench {}", 1)
+    });
+
+    harness.bench("emscripten::get_now", get_now);
+    harness.bench("clock::frame_time", clock::frame_time);
+    harness.bench("emscripten::random", random);
+    harness.bench("rng::random_f32", rng::random_f32);
+
+    harness.bench("emscripten::run_script", || run_script("0"));
+    harness.bench("emscripten::run_script_int", || run_script_int("1"));
+    harness.bench("emscripten::run_script_string", || run_script_string("'a'"));
+    harness.bench("emscripten::run_script_main_thread", || {
+        run_script_main_thread("0")
+    });
+
+    let script = Script::compile("return $0 + 1;").expect("the benchmark script compiles");
+    harness.bench("script::Script::call_double", || script.call_double(&[1.0]));
+    let values = [0.0f32; 64];
+    harness.bench("script::Script::call_with_double", || {
+        script.call_with_double(&[ScriptArg::from(&values[..])])
+    });
+    harness.bench("em_asm::em_asm_int!", || unsafe {
+        em_asm_int!("return $0 + 1;", 1i32)
+    });
+
+    harness.bench("timers::set_timeout+cancel", || {
+        timers::set_timeout(|| {}, 1000.0).cancel()
+    });
+}
+
+/// Runs the benchmarks of the calls that need a document.
+pub fn run_browser(harness: &mut Harness, has_document: bool) {
+    const BROWSER_ONLY: [&str; 4] = [
+        "emscripten::set_window_title",
+        "emscripten::get_window_title",
+        "html5::get_canvas_element_size",
+        "html5::get_element_css_size",
+    ];
+    if !has_document {
+        for name in BROWSER_ONLY {
+            harness.skip(name, "needs a document");
+        }
+        return;
+    }
+
+    harness.bench("emscripten::set_window_title", || set_window_title("bench"));
+    harness.bench("emscripten::get_window_title", get_window_title);
+    let canvas = Target::selector("#canvas");
+    harness.bench("html5::get_canvas_element_size", || {
+        html5::get_canvas_element_size(canvas)
+    });
+    harness.bench("html5::get_element_css_size", || {
+        html5::get_element_css_size(canvas)
+    });
+}
@@ -0,0 +1,7 @@
+// Links the program as an emscripten worker, loaded with `emscripten_create_worker`, exporting the function the benchmarks call.
+fn main() {
+    if std::env::var("CARGO_CFG_TARGET_OS").as_deref() == Ok("emscripten") {
+        println!("cargo:rustc-link-arg=-sBUILD_AS_WORKER");
+        println!("cargo:rustc-link-arg=-sEXPORTED_FUNCTIONS=_bench_task");
+    }
+}
@@ -0,0 +1,40 @@
+//! The worker program of the `WorkerPool` backend of the threads benchmarks, whose `bench_task` runs their tasks.
+//!
+//! Build it on its own, without the `-pthread` flags of the benchmarks, which a worker program can't use:
+//! `cargo build --release --target wasm32-unknown-emscripten -p emscripten-functions-bench-worker`,
+//! then copy `emscripten_functions_bench_worker.js` and its wasm file next to the JS file of the benchmarks.
+
+#[cfg(target_os = "emscripten")]
+use std::hint::black_box;
+
+// The iterations of one unit of work. It's the kernel of `benches/src/threads.rs`, which must be kept the same.
+#[cfg(target_os = "emscripten")]
+const UNIT_ITERATIONS: u64 = 1000;
+
+#[cfg(target_os = "emscripten")]
+fn work(units: u64) -> u64 {
+    let mut x = units;
+    for _ in 0..units * UNIT_ITERATIONS {
+        x = black_box(
+            x.wrapping_mul(6364136223846793005)
+                .wrapping_add(1442695040888963407),
+        );
+    }
+    x
+}
+
+/// Runs a task of the number of units given as a little-endian `u64`, and responds with its result.
+#[cfg(target_os = "emscripten")]
+#[no_mangle]
+pub extern "C" fn bench_task(data: *mut std::os::raw::c_char, size: std::os::raw::c_int) {
+    let mut units = [0; 8];
+    if size as usize == units.len() {
+        let data = unsafe { std::slice::from_raw_parts(data as *const u8, units.len()) };
+        units.copy_from_slice(data);
+    }
+    let result = work(u64::from_le_bytes(units));
+    emscripten_functions::worker::respond(&result.to_le_bytes());
+}
+
+// The worker only runs the calls it gets.
+fn main() {}
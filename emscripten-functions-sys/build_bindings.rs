@@ -7,17 +7,36 @@
 use regex::escape;
 use std::path::PathBuf;
 
+// The headers whose functions take a `pthread_t`, which they re-export from the `pthread` module instead of declaring their own.
+const PTHREAD_HEADERS: &[&str] = &["html5", "proxying", "threading", "websocket"];
+
 fn build_binding(header_name: &str) {
+    build_binding_with_args(header_name, &[]);
+}
+
+// Some headers only declare their functions when a define is set, e.g. `trace.h` with `__EMSCRIPTEN_TRACING__`.
+fn build_binding_with_args(header_name: &str, clang_args: &[&str]) {
     let emscripten_headers_path = PathBuf::from("emscripten/cache/sysroot/include");
     let out_path = PathBuf::from("src");
 
-    bindgen::Builder::default()
+    let mut builder = bindgen::Builder::default();
+    if PTHREAD_HEADERS.contains(&header_name) {
+        builder = builder
+            .blocklist_type("__pthread")
+            .blocklist_type("pthread_t")
+            .raw_line("pub use crate::pthread::{__pthread, pthread_t};");
+    }
+
+    builder
         .header(
             emscripten_headers_path
                 .join(format!("emscripten/{}.h", header_name))
                 .to_string_lossy(),
         )
         .clang_arg(format!("-I{}", emscripten_headers_path.to_string_lossy()))
+        .clang_args(clang_args)
+        // The crate is `no_std`.
+        .use_core()
         // We're interested only in the functions & types defined in `emscripten` headers,
         // not in the ones from e.g. `stdlib.h`
         .allowlist_file(format!(
@@ -39,4 +58,20 @@ fn main() {
     build_binding("emscripten");
     build_binding("html5");
     build_binding("console");
+    build_binding("fetch");
+    build_binding("proxying");
+    build_binding("threading");
+    build_binding("html5_webgpu");
+    build_binding("webaudio");
+    build_binding("wasm_worker");
+    build_binding("websocket");
+    build_binding("posix_socket");
+    build_binding("wasmfs");
+    build_binding("heap");
+    build_binding("emmalloc");
+    build_binding_with_args("trace", &["-D__EMSCRIPTEN_TRACING__"]);
+    build_binding("stack");
+    build_binding("fiber");
+    build_binding("dom_pk_codes");
+    build_binding("em_math");
 }
@@ -0,0 +1,163 @@
+pub const DOM_PK_UNKNOWN: u32 = 0;
+pub const DOM_PK_ESCAPE: u32 = 1;
+pub const DOM_PK_0: u32 = 2;
+pub const DOM_PK_1: u32 = 3;
+pub const DOM_PK_2: u32 = 4;
+pub const DOM_PK_3: u32 = 5;
+pub const DOM_PK_4: u32 = 6;
+pub const DOM_PK_5: u32 = 7;
+pub const DOM_PK_6: u32 = 8;
+pub const DOM_PK_7: u32 = 9;
+pub const DOM_PK_8: u32 = 10;
+pub const DOM_PK_9: u32 = 11;
+pub const DOM_PK_MINUS: u32 = 12;
+pub const DOM_PK_EQUAL: u32 = 13;
+pub const DOM_PK_BACKSPACE: u32 = 14;
+pub const DOM_PK_TAB: u32 = 15;
+pub const DOM_PK_Q: u32 = 16;
+pub const DOM_PK_W: u32 = 17;
+pub const DOM_PK_E: u32 = 18;
+pub const DOM_PK_R: u32 = 19;
+pub const DOM_PK_T: u32 = 20;
+pub const DOM_PK_Y: u32 = 21;
+pub const DOM_PK_U: u32 = 22;
+pub const DOM_PK_I: u32 = 23;
+pub const DOM_PK_O: u32 = 24;
+pub const DOM_PK_P: u32 = 25;
+pub const DOM_PK_BRACKET_LEFT: u32 = 26;
+pub const DOM_PK_BRACKET_RIGHT: u32 = 27;
+pub const DOM_PK_ENTER: u32 = 28;
+pub const DOM_PK_CONTROL_LEFT: u32 = 29;
+pub const DOM_PK_A: u32 = 30;
+pub const DOM_PK_S: u32 = 31;
+pub const DOM_PK_D: u32 = 32;
+pub const DOM_PK_F: u32 = 33;
+pub const DOM_PK_G: u32 = 34;
+pub const DOM_PK_H: u32 = 35;
+pub const DOM_PK_J: u32 = 36;
+pub const DOM_PK_K: u32 = 37;
+pub const DOM_PK_L: u32 = 38;
+pub const DOM_PK_SEMICOLON: u32 = 39;
+pub const DOM_PK_QUOTE: u32 = 40;
+pub const DOM_PK_BACKQUOTE: u32 = 41;
+pub const DOM_PK_SHIFT_LEFT: u32 = 42;
+pub const DOM_PK_BACKSLASH: u32 = 43;
+pub const DOM_PK_Z: u32 = 44;
+pub const DOM_PK_X: u32 = 45;
+pub const DOM_PK_C: u32 = 46;
+pub const DOM_PK_V: u32 = 47;
+pub const DOM_PK_B: u32 = 48;
+pub const DOM_PK_N: u32 = 49;
+pub const DOM_PK_M: u32 = 50;
+pub const DOM_PK_COMMA: u32 = 51;
+pub const DOM_PK_PERIOD: u32 = 52;
+pub const DOM_PK_SLASH: u32 = 53;
+pub const DOM_PK_SHIFT_RIGHT: u32 = 54;
+pub const DOM_PK_NUMPAD_MULTIPLY: u32 = 55;
+pub const DOM_PK_ALT_LEFT: u32 = 56;
+pub const DOM_PK_SPACE: u32 = 57;
+pub const DOM_PK_CAPS_LOCK: u32 = 58;
+pub const DOM_PK_F1: u32 = 59;
+pub const DOM_PK_F2: u32 = 60;
+pub const DOM_PK_F3: u32 = 61;
+pub const DOM_PK_F4: u32 = 62;
+pub const DOM_PK_F5: u32 = 63;
+pub const DOM_PK_F6: u32 = 64;
+pub const DOM_PK_F7: u32 = 65;
+pub const DOM_PK_F8: u32 = 66;
+pub const DOM_PK_F9: u32 = 67;
+pub const DOM_PK_F10: u32 = 68;
+pub const DOM_PK_PAUSE: u32 = 69;
+pub const DOM_PK_SCROLL_LOCK: u32 = 70;
+pub const DOM_PK_NUMPAD_7: u32 = 71;
+pub const DOM_PK_NUMPAD_8: u32 = 72;
+pub const DOM_PK_NUMPAD_9: u32 = 73;
+pub const DOM_PK_NUMPAD_SUBTRACT: u32 = 74;
+pub const DOM_PK_NUMPAD_4: u32 = 75;
+pub const DOM_PK_NUMPAD_5: u32 = 76;
+pub const DOM_PK_NUMPAD_6: u32 = 77;
+pub const DOM_PK_NUMPAD_ADD: u32 = 78;
+pub const DOM_PK_NUMPAD_1: u32 = 79;
+pub const DOM_PK_NUMPAD_2: u32 = 80;
+pub const DOM_PK_NUMPAD_3: u32 = 81;
+pub const DOM_PK_NUMPAD_0: u32 = 82;
+pub const DOM_PK_NUMPAD_DECIMAL: u32 = 83;
+pub const DOM_PK_PRINT_SCREEN: u32 = 84;
+pub const DOM_PK_INTL_BACKSLASH: u32 = 86;
+pub const DOM_PK_F11: u32 = 87;
+pub const DOM_PK_F12: u32 = 88;
+pub const DOM_PK_NUMPAD_EQUAL: u32 = 89;
+pub const DOM_PK_F13: u32 = 100;
+pub const DOM_PK_F14: u32 = 101;
+pub const DOM_PK_F15: u32 = 102;
+pub const DOM_PK_F16: u32 = 103;
+pub const DOM_PK_F17: u32 = 104;
+pub const DOM_PK_F18: u32 = 105;
+pub const DOM_PK_F19: u32 = 106;
+pub const DOM_PK_F20: u32 = 107;
+pub const DOM_PK_F21: u32 = 108;
+pub const DOM_PK_F22: u32 = 109;
+pub const DOM_PK_F23: u32 = 110;
+pub const DOM_PK_KANA_MODE: u32 = 112;
+pub const DOM_PK_LANG_2: u32 = 113;
+pub const DOM_PK_LANG_1: u32 = 114;
+pub const DOM_PK_INTL_RO: u32 = 115;
+pub const DOM_PK_F24: u32 = 118;
+pub const DOM_PK_CONVERT: u32 = 121;
+pub const DOM_PK_NON_CONVERT: u32 = 123;
+pub const DOM_PK_INTL_YEN: u32 = 125;
+pub const DOM_PK_NUMPAD_COMMA: u32 = 126;
+pub const DOM_PK_PASTE: u32 = 57354;
+pub const DOM_PK_MEDIA_TRACK_PREVIOUS: u32 = 57360;
+pub const DOM_PK_CUT: u32 = 57367;
+pub const DOM_PK_COPY: u32 = 57368;
+pub const DOM_PK_MEDIA_TRACK_NEXT: u32 = 57369;
+pub const DOM_PK_NUMPAD_ENTER: u32 = 57372;
+pub const DOM_PK_CONTROL_RIGHT: u32 = 57373;
+pub const DOM_PK_AUDIO_VOLUME_MUTE: u32 = 57376;
+pub const DOM_PK_LAUNCH_APP_2: u32 = 57377;
+pub const DOM_PK_MEDIA_PLAY_PAUSE: u32 = 57378;
+pub const DOM_PK_MEDIA_STOP: u32 = 57380;
+pub const DOM_PK_EJECT: u32 = 57388;
+pub const DOM_PK_AUDIO_VOLUME_DOWN: u32 = 57390;
+pub const DOM_PK_AUDIO_VOLUME_UP: u32 = 57392;
+pub const DOM_PK_BROWSER_HOME: u32 = 57394;
+pub const DOM_PK_NUMPAD_DIVIDE: u32 = 57397;
+pub const DOM_PK_ALT_RIGHT: u32 = 57400;
+pub const DOM_PK_HELP: u32 = 57403;
+pub const DOM_PK_NUM_LOCK: u32 = 57413;
+pub const DOM_PK_HOME: u32 = 57415;
+pub const DOM_PK_ARROW_UP: u32 = 57416;
+pub const DOM_PK_PAGE_UP: u32 = 57417;
+pub const DOM_PK_ARROW_LEFT: u32 = 57419;
+pub const DOM_PK_ARROW_RIGHT: u32 = 57421;
+pub const DOM_PK_END: u32 = 57423;
+pub const DOM_PK_ARROW_DOWN: u32 = 57424;
+pub const DOM_PK_PAGE_DOWN: u32 = 57425;
+pub const DOM_PK_INSERT: u32 = 57426;
+pub const DOM_PK_DELETE: u32 = 57427;
+pub const DOM_PK_META_LEFT: u32 = 57435;
+pub const DOM_PK_OS_LEFT: u32 = 57435;
+pub const DOM_PK_META_RIGHT: u32 = 57436;
+pub const DOM_PK_OS_RIGHT: u32 = 57436;
+pub const DOM_PK_CONTEXT_MENU: u32 = 57437;
+pub const DOM_PK_POWER: u32 = 57438;
+pub const DOM_PK_BROWSER_SEARCH: u32 = 57445;
+pub const DOM_PK_BROWSER_FAVORITES: u32 = 57446;
+pub const DOM_PK_BROWSER_REFRESH: u32 = 57447;
+pub const DOM_PK_BROWSER_STOP: u32 = 57448;
+pub const DOM_PK_BROWSER_FORWARD: u32 = 57449;
+pub const DOM_PK_BROWSER_BACK: u32 = 57450;
+pub const DOM_PK_LAUNCH_APP_1: u32 = 57451;
+pub const DOM_PK_LAUNCH_MAIL: u32 = 57452;
+pub const DOM_PK_LAUNCH_MEDIA_PLAYER: u32 = 57453;
+pub const DOM_PK_MEDIA_SELECT: u32 = 57453;
+extern "C" {
+    pub fn emscripten_compute_dom_pk_code(
+        keyCodeString: *const ::core::ffi::c_char,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_dom_pk_code_to_string(code: ::core::ffi::c_int)
+        -> *const ::core::ffi::c_char;
+}
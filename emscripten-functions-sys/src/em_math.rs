@@ -0,0 +1,89 @@
+pub const EM_MATH_E: f64 = 2.718281828459045;
+pub const EM_MATH_LN2: f64 = 0.6931471805599453;
+pub const EM_MATH_LN10: f64 = 2.302585092994046;
+pub const EM_MATH_LOG2E: f64 = 1.4426950408889634;
+pub const EM_MATH_LOG10E: f64 = 0.4342944819032518;
+pub const EM_MATH_PI: f64 = 3.141592653589793;
+pub const EM_MATH_SQRT1_2: f64 = 0.7071067811865476;
+pub const EM_MATH_SQRT2: f64 = 1.4142135623730951;
+extern "C" {
+    pub fn emscripten_math_acos(x: f64) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_acosh(x: f64) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_asin(x: f64) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_asinh(x: f64) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_atan(x: f64) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_atan2(y: f64, x: f64) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_atanh(x: f64) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_cbrt(x: f64) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_cos(x: f64) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_cosh(x: f64) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_exp(x: f64) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_expm1(x: f64) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_fmod(x: f64, y: f64) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_hypot(count: ::core::ffi::c_int, ...) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_log(x: f64) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_log1p(x: f64) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_log10(x: f64) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_log2(x: f64) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_pow(x: f64, y: f64) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_random() -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_round(x: f64) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_sign(x: f64) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_sin(x: f64) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_sinh(x: f64) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_sqrt(x: f64) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_tan(x: f64) -> f64;
+}
+extern "C" {
+    pub fn emscripten_math_tanh(x: f64) -> f64;
+}
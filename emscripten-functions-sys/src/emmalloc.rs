@@ -0,0 +1,80 @@
+extern "C" {
+    pub fn emmalloc_dump_memory_regions();
+}
+extern "C" {
+    pub fn emmalloc_memalign(alignment: usize, size: usize) -> *mut ::core::ffi::c_void;
+}
+extern "C" {
+    pub fn emmalloc_malloc(size: usize) -> *mut ::core::ffi::c_void;
+}
+extern "C" {
+    pub fn emmalloc_usable_size(ptr: *mut ::core::ffi::c_void) -> usize;
+}
+extern "C" {
+    pub fn emmalloc_free(ptr: *mut ::core::ffi::c_void);
+}
+extern "C" {
+    pub fn emmalloc_realloc(
+        ptr: *mut ::core::ffi::c_void,
+        size: usize,
+    ) -> *mut ::core::ffi::c_void;
+}
+extern "C" {
+    pub fn emmalloc_realloc_try(
+        ptr: *mut ::core::ffi::c_void,
+        size: usize,
+    ) -> *mut ::core::ffi::c_void;
+}
+extern "C" {
+    pub fn emmalloc_realloc_uninitialized(
+        ptr: *mut ::core::ffi::c_void,
+        size: usize,
+    ) -> *mut ::core::ffi::c_void;
+}
+extern "C" {
+    pub fn emmalloc_aligned_realloc(
+        ptr: *mut ::core::ffi::c_void,
+        alignment: usize,
+        size: usize,
+    ) -> *mut ::core::ffi::c_void;
+}
+extern "C" {
+    pub fn emmalloc_aligned_realloc_uninitialized(
+        ptr: *mut ::core::ffi::c_void,
+        alignment: usize,
+        size: usize,
+    ) -> *mut ::core::ffi::c_void;
+}
+extern "C" {
+    pub fn emmalloc_posix_memalign(
+        memptr: *mut *mut ::core::ffi::c_void,
+        alignment: usize,
+        size: usize,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emmalloc_calloc(num: usize, size: usize) -> *mut ::core::ffi::c_void;
+}
+extern "C" {
+    pub fn emmalloc_trim(pad: usize) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emmalloc_validate_memory_regions() -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emmalloc_dynamic_heap_size() -> usize;
+}
+extern "C" {
+    pub fn emmalloc_free_dynamic_memory() -> usize;
+}
+extern "C" {
+    pub fn emmalloc_unclaimed_heap_memory() -> usize;
+}
+extern "C" {
+    pub fn emmalloc_compute_free_dynamic_memory_fragmentation_map(
+        freeMemorySizeMap: *mut usize,
+    ) -> usize;
+}
+extern "C" {
+    pub fn emmalloc_dump_free_dynamic_memory_fragmentation_map();
+}
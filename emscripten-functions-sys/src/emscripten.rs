@@ -21,62 +21,62 @@ pub const EM_LOG_DEBUG: u32 = 256;
 pub const EM_LOG_INFO: u32 = 512;
 extern "C" {
     pub fn emscripten_asm_const_int(
-        code: *const ::std::os::raw::c_char,
-        arg_sigs: *const ::std::os::raw::c_char,
+        code: *const ::core::ffi::c_char,
+        arg_sigs: *const ::core::ffi::c_char,
         ...
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_asm_const_ptr(
-        code: *const ::std::os::raw::c_char,
-        arg_sigs: *const ::std::os::raw::c_char,
+        code: *const ::core::ffi::c_char,
+        arg_sigs: *const ::core::ffi::c_char,
         ...
-    ) -> *mut ::std::os::raw::c_void;
+    ) -> *mut ::core::ffi::c_void;
 }
 extern "C" {
     pub fn emscripten_asm_const_double(
-        code: *const ::std::os::raw::c_char,
-        arg_sigs: *const ::std::os::raw::c_char,
+        code: *const ::core::ffi::c_char,
+        arg_sigs: *const ::core::ffi::c_char,
         ...
     ) -> f64;
 }
 extern "C" {
     pub fn emscripten_asm_const_int_sync_on_main_thread(
-        code: *const ::std::os::raw::c_char,
-        arg_sigs: *const ::std::os::raw::c_char,
+        code: *const ::core::ffi::c_char,
+        arg_sigs: *const ::core::ffi::c_char,
         ...
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_asm_const_double_sync_on_main_thread(
-        code: *const ::std::os::raw::c_char,
-        arg_sigs: *const ::std::os::raw::c_char,
+        code: *const ::core::ffi::c_char,
+        arg_sigs: *const ::core::ffi::c_char,
         ...
     ) -> f64;
 }
 extern "C" {
     pub fn emscripten_asm_const_async_on_main_thread(
-        code: *const ::std::os::raw::c_char,
-        arg_sigs: *const ::std::os::raw::c_char,
+        code: *const ::core::ffi::c_char,
+        arg_sigs: *const ::core::ffi::c_char,
         ...
     );
 }
-pub type emscripten_align1_short = ::std::os::raw::c_short;
-pub type emscripten_align4_int64 = ::std::os::raw::c_longlong;
-pub type emscripten_align2_int64 = ::std::os::raw::c_longlong;
-pub type emscripten_align1_int64 = ::std::os::raw::c_longlong;
-pub type emscripten_align2_int = ::std::os::raw::c_int;
-pub type emscripten_align1_int = ::std::os::raw::c_int;
+pub type emscripten_align1_short = ::core::ffi::c_short;
+pub type emscripten_align4_int64 = ::core::ffi::c_longlong;
+pub type emscripten_align2_int64 = ::core::ffi::c_longlong;
+pub type emscripten_align1_int64 = ::core::ffi::c_longlong;
+pub type emscripten_align2_int = ::core::ffi::c_int;
+pub type emscripten_align1_int = ::core::ffi::c_int;
 pub type emscripten_align2_float = f32;
 pub type emscripten_align1_float = f32;
 pub type emscripten_align4_double = f64;
 pub type emscripten_align2_double = f64;
 pub type emscripten_align1_double = f64;
-pub type em_callback_func = ::std::option::Option<unsafe extern "C" fn()>;
+pub type em_callback_func = ::core::option::Option<unsafe extern "C" fn()>;
 pub type em_arg_callback_func =
-    ::std::option::Option<unsafe extern "C" fn(arg1: *mut ::std::os::raw::c_void)>;
+    ::core::option::Option<unsafe extern "C" fn(arg1: *mut ::core::ffi::c_void)>;
 pub type em_str_callback_func =
-    ::std::option::Option<unsafe extern "C" fn(arg1: *const ::std::os::raw::c_char)>;
+    ::core::option::Option<unsafe extern "C" fn(arg1: *const ::core::ffi::c_char)>;
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
 pub struct _em_promise {
@@ -87,12 +87,12 @@ pub const em_promise_result_t_EM_PROMISE_FULFILL: em_promise_result_t = 0;
 pub const em_promise_result_t_EM_PROMISE_MATCH: em_promise_result_t = 1;
 pub const em_promise_result_t_EM_PROMISE_MATCH_RELEASE: em_promise_result_t = 2;
 pub const em_promise_result_t_EM_PROMISE_REJECT: em_promise_result_t = 3;
-pub type em_promise_result_t = ::std::os::raw::c_uint;
-pub type em_promise_callback_t = ::std::option::Option<
+pub type em_promise_result_t = ::core::ffi::c_uint;
+pub type em_promise_callback_t = ::core::option::Option<
     unsafe extern "C" fn(
-        result: *mut *mut ::std::os::raw::c_void,
-        data: *mut ::std::os::raw::c_void,
-        value: *mut ::std::os::raw::c_void,
+        result: *mut *mut ::core::ffi::c_void,
+        data: *mut ::core::ffi::c_void,
+        value: *mut ::core::ffi::c_void,
     ) -> em_promise_result_t,
 >;
 extern "C" {
@@ -105,7 +105,7 @@ extern "C" {
     pub fn emscripten_promise_resolve(
         promise: em_promise_t,
         result: em_promise_result_t,
-        value: *mut ::std::os::raw::c_void,
+        value: *mut ::core::ffi::c_void,
     );
 }
 extern "C" {
@@ -113,13 +113,13 @@ extern "C" {
         promise: em_promise_t,
         on_fulfilled: em_promise_callback_t,
         on_rejected: em_promise_callback_t,
-        data: *mut ::std::os::raw::c_void,
+        data: *mut ::core::ffi::c_void,
     ) -> em_promise_t;
 }
 extern "C" {
     pub fn emscripten_promise_all(
         promises: *mut em_promise_t,
-        results: *mut *mut ::std::os::raw::c_void,
+        results: *mut *mut ::core::ffi::c_void,
         num_promises: usize,
     ) -> em_promise_t;
 }
@@ -127,24 +127,24 @@ extern "C" {
 #[derive(Debug, Copy, Clone)]
 pub struct em_settled_result_t {
     pub result: em_promise_result_t,
-    pub value: *mut ::std::os::raw::c_void,
+    pub value: *mut ::core::ffi::c_void,
 }
 #[test]
 fn bindgen_test_layout_em_settled_result_t() {
-    const UNINIT: ::std::mem::MaybeUninit<em_settled_result_t> = ::std::mem::MaybeUninit::uninit();
+    const UNINIT: ::core::mem::MaybeUninit<em_settled_result_t> = ::core::mem::MaybeUninit::uninit();
     let ptr = UNINIT.as_ptr();
     assert_eq!(
-        ::std::mem::size_of::<em_settled_result_t>(),
+        ::core::mem::size_of::<em_settled_result_t>(),
         16usize,
         concat!("Size of: ", stringify!(em_settled_result_t))
     );
     assert_eq!(
-        ::std::mem::align_of::<em_settled_result_t>(),
+        ::core::mem::align_of::<em_settled_result_t>(),
         8usize,
         concat!("Alignment of ", stringify!(em_settled_result_t))
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).result) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).result) as usize - ptr as usize },
         0usize,
         concat!(
             "Offset of field: ",
@@ -154,7 +154,7 @@ fn bindgen_test_layout_em_settled_result_t() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).value) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).value) as usize - ptr as usize },
         8usize,
         concat!(
             "Offset of field: ",
@@ -174,7 +174,7 @@ extern "C" {
 extern "C" {
     pub fn emscripten_promise_any(
         promises: *mut em_promise_t,
-        errors: *mut *mut ::std::os::raw::c_void,
+        errors: *mut *mut ::core::ffi::c_void,
         num_promises: usize,
     ) -> em_promise_t;
 }
@@ -189,128 +189,128 @@ extern "C" {
 }
 extern "C" {
     pub fn emscripten_async_wget(
-        url: *const ::std::os::raw::c_char,
-        file: *const ::std::os::raw::c_char,
+        url: *const ::core::ffi::c_char,
+        file: *const ::core::ffi::c_char,
         onload: em_str_callback_func,
         onerror: em_str_callback_func,
     );
 }
-pub type em_async_wget_onload_func = ::std::option::Option<
+pub type em_async_wget_onload_func = ::core::option::Option<
     unsafe extern "C" fn(
-        arg1: *mut ::std::os::raw::c_void,
-        arg2: *mut ::std::os::raw::c_void,
-        arg3: ::std::os::raw::c_int,
+        arg1: *mut ::core::ffi::c_void,
+        arg2: *mut ::core::ffi::c_void,
+        arg3: ::core::ffi::c_int,
     ),
 >;
 extern "C" {
     pub fn emscripten_async_wget_data(
-        url: *const ::std::os::raw::c_char,
-        arg: *mut ::std::os::raw::c_void,
+        url: *const ::core::ffi::c_char,
+        arg: *mut ::core::ffi::c_void,
         onload: em_async_wget_onload_func,
         onerror: em_arg_callback_func,
     );
 }
-pub type em_async_wget2_onload_func = ::std::option::Option<
+pub type em_async_wget2_onload_func = ::core::option::Option<
     unsafe extern "C" fn(
-        arg1: ::std::os::raw::c_uint,
-        arg2: *mut ::std::os::raw::c_void,
-        arg3: *const ::std::os::raw::c_char,
+        arg1: ::core::ffi::c_uint,
+        arg2: *mut ::core::ffi::c_void,
+        arg3: *const ::core::ffi::c_char,
     ),
 >;
-pub type em_async_wget2_onstatus_func = ::std::option::Option<
+pub type em_async_wget2_onstatus_func = ::core::option::Option<
     unsafe extern "C" fn(
-        arg1: ::std::os::raw::c_uint,
-        arg2: *mut ::std::os::raw::c_void,
-        arg3: ::std::os::raw::c_int,
+        arg1: ::core::ffi::c_uint,
+        arg2: *mut ::core::ffi::c_void,
+        arg3: ::core::ffi::c_int,
     ),
 >;
 extern "C" {
     pub fn emscripten_async_wget2(
-        url: *const ::std::os::raw::c_char,
-        file: *const ::std::os::raw::c_char,
-        requesttype: *const ::std::os::raw::c_char,
-        param: *const ::std::os::raw::c_char,
-        arg: *mut ::std::os::raw::c_void,
+        url: *const ::core::ffi::c_char,
+        file: *const ::core::ffi::c_char,
+        requesttype: *const ::core::ffi::c_char,
+        param: *const ::core::ffi::c_char,
+        arg: *mut ::core::ffi::c_void,
         onload: em_async_wget2_onload_func,
         onerror: em_async_wget2_onstatus_func,
         onprogress: em_async_wget2_onstatus_func,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
-pub type em_async_wget2_data_onload_func = ::std::option::Option<
+pub type em_async_wget2_data_onload_func = ::core::option::Option<
     unsafe extern "C" fn(
-        arg1: ::std::os::raw::c_uint,
-        arg2: *mut ::std::os::raw::c_void,
-        arg3: *mut ::std::os::raw::c_void,
-        arg4: ::std::os::raw::c_uint,
+        arg1: ::core::ffi::c_uint,
+        arg2: *mut ::core::ffi::c_void,
+        arg3: *mut ::core::ffi::c_void,
+        arg4: ::core::ffi::c_uint,
     ),
 >;
-pub type em_async_wget2_data_onerror_func = ::std::option::Option<
+pub type em_async_wget2_data_onerror_func = ::core::option::Option<
     unsafe extern "C" fn(
-        arg1: ::std::os::raw::c_uint,
-        arg2: *mut ::std::os::raw::c_void,
-        arg3: ::std::os::raw::c_int,
-        arg4: *const ::std::os::raw::c_char,
+        arg1: ::core::ffi::c_uint,
+        arg2: *mut ::core::ffi::c_void,
+        arg3: ::core::ffi::c_int,
+        arg4: *const ::core::ffi::c_char,
     ),
 >;
-pub type em_async_wget2_data_onprogress_func = ::std::option::Option<
+pub type em_async_wget2_data_onprogress_func = ::core::option::Option<
     unsafe extern "C" fn(
-        arg1: ::std::os::raw::c_uint,
-        arg2: *mut ::std::os::raw::c_void,
-        arg3: ::std::os::raw::c_int,
-        arg4: ::std::os::raw::c_int,
+        arg1: ::core::ffi::c_uint,
+        arg2: *mut ::core::ffi::c_void,
+        arg3: ::core::ffi::c_int,
+        arg4: ::core::ffi::c_int,
     ),
 >;
 extern "C" {
     pub fn emscripten_async_wget2_data(
-        url: *const ::std::os::raw::c_char,
-        requesttype: *const ::std::os::raw::c_char,
-        param: *const ::std::os::raw::c_char,
-        arg: *mut ::std::os::raw::c_void,
-        free: ::std::os::raw::c_int,
+        url: *const ::core::ffi::c_char,
+        requesttype: *const ::core::ffi::c_char,
+        param: *const ::core::ffi::c_char,
+        arg: *mut ::core::ffi::c_void,
+        free: ::core::ffi::c_int,
         onload: em_async_wget2_data_onload_func,
         onerror: em_async_wget2_data_onerror_func,
         onprogress: em_async_wget2_data_onprogress_func,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
-    pub fn emscripten_async_wget2_abort(handle: ::std::os::raw::c_int);
+    pub fn emscripten_async_wget2_abort(handle: ::core::ffi::c_int);
 }
 extern "C" {
     pub fn emscripten_wget(
-        url: *const ::std::os::raw::c_char,
-        file: *const ::std::os::raw::c_char,
-    ) -> ::std::os::raw::c_int;
+        url: *const ::core::ffi::c_char,
+        file: *const ::core::ffi::c_char,
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_wget_data(
-        url: *const ::std::os::raw::c_char,
-        pbuffer: *mut *mut ::std::os::raw::c_void,
-        pnum: *mut ::std::os::raw::c_int,
-        perror: *mut ::std::os::raw::c_int,
+        url: *const ::core::ffi::c_char,
+        pbuffer: *mut *mut ::core::ffi::c_void,
+        pnum: *mut ::core::ffi::c_int,
+        perror: *mut ::core::ffi::c_int,
     );
 }
 extern "C" {
-    pub fn emscripten_run_script(script: *const ::std::os::raw::c_char);
+    pub fn emscripten_run_script(script: *const ::core::ffi::c_char);
 }
 extern "C" {
     pub fn emscripten_run_script_int(
-        script: *const ::std::os::raw::c_char,
-    ) -> ::std::os::raw::c_int;
+        script: *const ::core::ffi::c_char,
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_run_script_string(
-        script: *const ::std::os::raw::c_char,
-    ) -> *mut ::std::os::raw::c_char;
+        script: *const ::core::ffi::c_char,
+    ) -> *mut ::core::ffi::c_char;
 }
 extern "C" {
     pub fn emscripten_async_run_script(
-        script: *const ::std::os::raw::c_char,
-        millis: ::std::os::raw::c_int,
+        script: *const ::core::ffi::c_char,
+        millis: ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_async_load_script(
-        script: *const ::std::os::raw::c_char,
+        script: *const ::core::ffi::c_char,
         onload: em_callback_func,
         onerror: em_callback_func,
     );
@@ -318,28 +318,28 @@ extern "C" {
 extern "C" {
     pub fn emscripten_set_main_loop(
         func: em_callback_func,
-        fps: ::std::os::raw::c_int,
-        simulate_infinite_loop: ::std::os::raw::c_int,
+        fps: ::core::ffi::c_int,
+        simulate_infinite_loop: ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_set_main_loop_timing(
-        mode: ::std::os::raw::c_int,
-        value: ::std::os::raw::c_int,
-    ) -> ::std::os::raw::c_int;
+        mode: ::core::ffi::c_int,
+        value: ::core::ffi::c_int,
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_get_main_loop_timing(
-        mode: *mut ::std::os::raw::c_int,
-        value: *mut ::std::os::raw::c_int,
+        mode: *mut ::core::ffi::c_int,
+        value: *mut ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_set_main_loop_arg(
         func: em_arg_callback_func,
-        arg: *mut ::std::os::raw::c_void,
-        fps: ::std::os::raw::c_int,
-        simulate_infinite_loop: ::std::os::raw::c_int,
+        arg: *mut ::core::ffi::c_void,
+        fps: ::core::ffi::c_int,
+        simulate_infinite_loop: ::core::ffi::c_int,
     );
 }
 extern "C" {
@@ -351,109 +351,109 @@ extern "C" {
 extern "C" {
     pub fn emscripten_cancel_main_loop();
 }
-pub type em_socket_callback = ::std::option::Option<
-    unsafe extern "C" fn(fd: ::std::os::raw::c_int, userData: *mut ::std::os::raw::c_void),
+pub type em_socket_callback = ::core::option::Option<
+    unsafe extern "C" fn(fd: ::core::ffi::c_int, userData: *mut ::core::ffi::c_void),
 >;
-pub type em_socket_error_callback = ::std::option::Option<
+pub type em_socket_error_callback = ::core::option::Option<
     unsafe extern "C" fn(
-        fd: ::std::os::raw::c_int,
-        err: ::std::os::raw::c_int,
-        msg: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
+        fd: ::core::ffi::c_int,
+        err: ::core::ffi::c_int,
+        msg: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
     ),
 >;
 extern "C" {
     pub fn emscripten_set_socket_error_callback(
-        userData: *mut ::std::os::raw::c_void,
+        userData: *mut ::core::ffi::c_void,
         callback: em_socket_error_callback,
     );
 }
 extern "C" {
     pub fn emscripten_set_socket_open_callback(
-        userData: *mut ::std::os::raw::c_void,
+        userData: *mut ::core::ffi::c_void,
         callback: em_socket_callback,
     );
 }
 extern "C" {
     pub fn emscripten_set_socket_listen_callback(
-        userData: *mut ::std::os::raw::c_void,
+        userData: *mut ::core::ffi::c_void,
         callback: em_socket_callback,
     );
 }
 extern "C" {
     pub fn emscripten_set_socket_connection_callback(
-        userData: *mut ::std::os::raw::c_void,
+        userData: *mut ::core::ffi::c_void,
         callback: em_socket_callback,
     );
 }
 extern "C" {
     pub fn emscripten_set_socket_message_callback(
-        userData: *mut ::std::os::raw::c_void,
+        userData: *mut ::core::ffi::c_void,
         callback: em_socket_callback,
     );
 }
 extern "C" {
     pub fn emscripten_set_socket_close_callback(
-        userData: *mut ::std::os::raw::c_void,
+        userData: *mut ::core::ffi::c_void,
         callback: em_socket_callback,
     );
 }
 extern "C" {
     pub fn _emscripten_push_main_loop_blocker(
         func: em_arg_callback_func,
-        arg: *mut ::std::os::raw::c_void,
-        name: *const ::std::os::raw::c_char,
+        arg: *mut ::core::ffi::c_void,
+        name: *const ::core::ffi::c_char,
     );
 }
 extern "C" {
     pub fn _emscripten_push_uncounted_main_loop_blocker(
         func: em_arg_callback_func,
-        arg: *mut ::std::os::raw::c_void,
-        name: *const ::std::os::raw::c_char,
+        arg: *mut ::core::ffi::c_void,
+        name: *const ::core::ffi::c_char,
     );
 }
 extern "C" {
-    pub fn emscripten_set_main_loop_expected_blockers(num: ::std::os::raw::c_int);
+    pub fn emscripten_set_main_loop_expected_blockers(num: ::core::ffi::c_int);
 }
 extern "C" {
     pub fn emscripten_async_call(
         func: em_arg_callback_func,
-        arg: *mut ::std::os::raw::c_void,
-        millis: ::std::os::raw::c_int,
+        arg: *mut ::core::ffi::c_void,
+        millis: ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_exit_with_live_runtime() -> !;
 }
 extern "C" {
-    pub fn emscripten_force_exit(status: ::std::os::raw::c_int) -> !;
+    pub fn emscripten_force_exit(status: ::core::ffi::c_int) -> !;
 }
 extern "C" {
     pub fn emscripten_get_device_pixel_ratio() -> f64;
 }
 extern "C" {
-    pub fn emscripten_get_window_title() -> *mut ::std::os::raw::c_char;
+    pub fn emscripten_get_window_title() -> *mut ::core::ffi::c_char;
 }
 extern "C" {
-    pub fn emscripten_set_window_title(arg1: *const ::std::os::raw::c_char);
+    pub fn emscripten_set_window_title(arg1: *const ::core::ffi::c_char);
 }
 extern "C" {
     pub fn emscripten_get_screen_size(
-        width: *mut ::std::os::raw::c_int,
-        height: *mut ::std::os::raw::c_int,
+        width: *mut ::core::ffi::c_int,
+        height: *mut ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_hide_mouse();
 }
 extern "C" {
-    pub fn emscripten_set_canvas_size(width: ::std::os::raw::c_int, height: ::std::os::raw::c_int);
+    pub fn emscripten_set_canvas_size(width: ::core::ffi::c_int, height: ::core::ffi::c_int);
 }
 extern "C" {
     pub fn emscripten_get_canvas_size(
-        width: *mut ::std::os::raw::c_int,
-        height: *mut ::std::os::raw::c_int,
-        isFullscreen: *mut ::std::os::raw::c_int,
+        width: *mut ::core::ffi::c_int,
+        height: *mut ::core::ffi::c_int,
+        isFullscreen: *mut ::core::ffi::c_int,
     );
 }
 extern "C" {
@@ -462,145 +462,145 @@ extern "C" {
 extern "C" {
     pub fn emscripten_random() -> f32;
 }
-pub type em_idb_onload_func = ::std::option::Option<
+pub type em_idb_onload_func = ::core::option::Option<
     unsafe extern "C" fn(
-        arg1: *mut ::std::os::raw::c_void,
-        arg2: *mut ::std::os::raw::c_void,
-        arg3: ::std::os::raw::c_int,
+        arg1: *mut ::core::ffi::c_void,
+        arg2: *mut ::core::ffi::c_void,
+        arg3: ::core::ffi::c_int,
     ),
 >;
 extern "C" {
     pub fn emscripten_idb_async_load(
-        db_name: *const ::std::os::raw::c_char,
-        file_id: *const ::std::os::raw::c_char,
-        arg: *mut ::std::os::raw::c_void,
+        db_name: *const ::core::ffi::c_char,
+        file_id: *const ::core::ffi::c_char,
+        arg: *mut ::core::ffi::c_void,
         onload: em_idb_onload_func,
         onerror: em_arg_callback_func,
     );
 }
 extern "C" {
     pub fn emscripten_idb_async_store(
-        db_name: *const ::std::os::raw::c_char,
-        file_id: *const ::std::os::raw::c_char,
-        ptr: *mut ::std::os::raw::c_void,
-        num: ::std::os::raw::c_int,
-        arg: *mut ::std::os::raw::c_void,
+        db_name: *const ::core::ffi::c_char,
+        file_id: *const ::core::ffi::c_char,
+        ptr: *mut ::core::ffi::c_void,
+        num: ::core::ffi::c_int,
+        arg: *mut ::core::ffi::c_void,
         onstore: em_arg_callback_func,
         onerror: em_arg_callback_func,
     );
 }
 extern "C" {
     pub fn emscripten_idb_async_delete(
-        db_name: *const ::std::os::raw::c_char,
-        file_id: *const ::std::os::raw::c_char,
-        arg: *mut ::std::os::raw::c_void,
+        db_name: *const ::core::ffi::c_char,
+        file_id: *const ::core::ffi::c_char,
+        arg: *mut ::core::ffi::c_void,
         ondelete: em_arg_callback_func,
         onerror: em_arg_callback_func,
     );
 }
-pub type em_idb_exists_func = ::std::option::Option<
-    unsafe extern "C" fn(arg1: *mut ::std::os::raw::c_void, arg2: ::std::os::raw::c_int),
+pub type em_idb_exists_func = ::core::option::Option<
+    unsafe extern "C" fn(arg1: *mut ::core::ffi::c_void, arg2: ::core::ffi::c_int),
 >;
 extern "C" {
     pub fn emscripten_idb_async_exists(
-        db_name: *const ::std::os::raw::c_char,
-        file_id: *const ::std::os::raw::c_char,
-        arg: *mut ::std::os::raw::c_void,
+        db_name: *const ::core::ffi::c_char,
+        file_id: *const ::core::ffi::c_char,
+        arg: *mut ::core::ffi::c_void,
         oncheck: em_idb_exists_func,
         onerror: em_arg_callback_func,
     );
 }
 extern "C" {
     pub fn emscripten_idb_async_clear(
-        db_name: *const ::std::os::raw::c_char,
-        arg: *mut ::std::os::raw::c_void,
+        db_name: *const ::core::ffi::c_char,
+        arg: *mut ::core::ffi::c_void,
         onclear: em_arg_callback_func,
         onerror: em_arg_callback_func,
     );
 }
 extern "C" {
     pub fn emscripten_idb_load(
-        db_name: *const ::std::os::raw::c_char,
-        file_id: *const ::std::os::raw::c_char,
-        pbuffer: *mut *mut ::std::os::raw::c_void,
-        pnum: *mut ::std::os::raw::c_int,
-        perror: *mut ::std::os::raw::c_int,
+        db_name: *const ::core::ffi::c_char,
+        file_id: *const ::core::ffi::c_char,
+        pbuffer: *mut *mut ::core::ffi::c_void,
+        pnum: *mut ::core::ffi::c_int,
+        perror: *mut ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_idb_store(
-        db_name: *const ::std::os::raw::c_char,
-        file_id: *const ::std::os::raw::c_char,
-        buffer: *mut ::std::os::raw::c_void,
-        num: ::std::os::raw::c_int,
-        perror: *mut ::std::os::raw::c_int,
+        db_name: *const ::core::ffi::c_char,
+        file_id: *const ::core::ffi::c_char,
+        buffer: *mut ::core::ffi::c_void,
+        num: ::core::ffi::c_int,
+        perror: *mut ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_idb_delete(
-        db_name: *const ::std::os::raw::c_char,
-        file_id: *const ::std::os::raw::c_char,
-        perror: *mut ::std::os::raw::c_int,
+        db_name: *const ::core::ffi::c_char,
+        file_id: *const ::core::ffi::c_char,
+        perror: *mut ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_idb_exists(
-        db_name: *const ::std::os::raw::c_char,
-        file_id: *const ::std::os::raw::c_char,
-        pexists: *mut ::std::os::raw::c_int,
-        perror: *mut ::std::os::raw::c_int,
+        db_name: *const ::core::ffi::c_char,
+        file_id: *const ::core::ffi::c_char,
+        pexists: *mut ::core::ffi::c_int,
+        perror: *mut ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_idb_clear(
-        db_name: *const ::std::os::raw::c_char,
-        perror: *mut ::std::os::raw::c_int,
+        db_name: *const ::core::ffi::c_char,
+        perror: *mut ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_idb_load_blob(
-        db_name: *const ::std::os::raw::c_char,
-        file_id: *const ::std::os::raw::c_char,
-        pblob: *mut ::std::os::raw::c_int,
-        perror: *mut ::std::os::raw::c_int,
+        db_name: *const ::core::ffi::c_char,
+        file_id: *const ::core::ffi::c_char,
+        pblob: *mut ::core::ffi::c_int,
+        perror: *mut ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_idb_store_blob(
-        db_name: *const ::std::os::raw::c_char,
-        file_id: *const ::std::os::raw::c_char,
-        buffer: *mut ::std::os::raw::c_void,
-        num: ::std::os::raw::c_int,
-        perror: *mut ::std::os::raw::c_int,
+        db_name: *const ::core::ffi::c_char,
+        file_id: *const ::core::ffi::c_char,
+        buffer: *mut ::core::ffi::c_void,
+        num: ::core::ffi::c_int,
+        perror: *mut ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_idb_read_from_blob(
-        blob: ::std::os::raw::c_int,
-        start: ::std::os::raw::c_int,
-        num: ::std::os::raw::c_int,
-        buffer: *mut ::std::os::raw::c_void,
+        blob: ::core::ffi::c_int,
+        start: ::core::ffi::c_int,
+        num: ::core::ffi::c_int,
+        buffer: *mut ::core::ffi::c_void,
     );
 }
 extern "C" {
-    pub fn emscripten_idb_free_blob(blob: ::std::os::raw::c_int);
+    pub fn emscripten_idb_free_blob(blob: ::core::ffi::c_int);
 }
 extern "C" {
     pub fn emscripten_run_preload_plugins(
-        file: *const ::std::os::raw::c_char,
+        file: *const ::core::ffi::c_char,
         onload: em_str_callback_func,
         onerror: em_str_callback_func,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
-pub type em_run_preload_plugins_data_onload_func = ::std::option::Option<
-    unsafe extern "C" fn(arg1: *mut ::std::os::raw::c_void, arg2: *const ::std::os::raw::c_char),
+pub type em_run_preload_plugins_data_onload_func = ::core::option::Option<
+    unsafe extern "C" fn(arg1: *mut ::core::ffi::c_void, arg2: *const ::core::ffi::c_char),
 >;
 extern "C" {
     pub fn emscripten_run_preload_plugins_data(
-        data: *mut ::std::os::raw::c_char,
-        size: ::std::os::raw::c_int,
-        suffix: *const ::std::os::raw::c_char,
-        arg: *mut ::std::os::raw::c_void,
+        data: *mut ::core::ffi::c_char,
+        size: ::core::ffi::c_int,
+        suffix: *const ::core::ffi::c_char,
+        arg: *mut ::core::ffi::c_void,
         onload: em_run_preload_plugins_data_onload_func,
         onerror: em_arg_callback_func,
     );
@@ -608,52 +608,52 @@ extern "C" {
 extern "C" {
     pub fn emscripten_lazy_load_code();
 }
-pub type worker_handle = ::std::os::raw::c_int;
+pub type worker_handle = ::core::ffi::c_int;
 extern "C" {
-    pub fn emscripten_create_worker(url: *const ::std::os::raw::c_char) -> worker_handle;
+    pub fn emscripten_create_worker(url: *const ::core::ffi::c_char) -> worker_handle;
 }
 extern "C" {
     pub fn emscripten_destroy_worker(worker: worker_handle);
 }
-pub type em_worker_callback_func = ::std::option::Option<
+pub type em_worker_callback_func = ::core::option::Option<
     unsafe extern "C" fn(
-        arg1: *mut ::std::os::raw::c_char,
-        arg2: ::std::os::raw::c_int,
-        arg3: *mut ::std::os::raw::c_void,
+        arg1: *mut ::core::ffi::c_char,
+        arg2: ::core::ffi::c_int,
+        arg3: *mut ::core::ffi::c_void,
     ),
 >;
 extern "C" {
     pub fn emscripten_call_worker(
         worker: worker_handle,
-        funcname: *const ::std::os::raw::c_char,
-        data: *mut ::std::os::raw::c_char,
-        size: ::std::os::raw::c_int,
+        funcname: *const ::core::ffi::c_char,
+        data: *mut ::core::ffi::c_char,
+        size: ::core::ffi::c_int,
         callback: em_worker_callback_func,
-        arg: *mut ::std::os::raw::c_void,
+        arg: *mut ::core::ffi::c_void,
     );
 }
 extern "C" {
     pub fn emscripten_worker_respond(
-        data: *mut ::std::os::raw::c_char,
-        size: ::std::os::raw::c_int,
+        data: *mut ::core::ffi::c_char,
+        size: ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_worker_respond_provisionally(
-        data: *mut ::std::os::raw::c_char,
-        size: ::std::os::raw::c_int,
+        data: *mut ::core::ffi::c_char,
+        size: ::core::ffi::c_int,
     );
 }
 extern "C" {
-    pub fn emscripten_get_worker_queue_size(worker: worker_handle) -> ::std::os::raw::c_int;
+    pub fn emscripten_get_worker_queue_size(worker: worker_handle) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_get_compiler_setting(
-        name: *const ::std::os::raw::c_char,
-    ) -> ::std::os::raw::c_long;
+        name: *const ::core::ffi::c_char,
+    ) -> ::core::ffi::c_long;
 }
 extern "C" {
-    pub fn emscripten_has_asyncify() -> ::std::os::raw::c_int;
+    pub fn emscripten_has_asyncify() -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_debugger();
@@ -666,37 +666,37 @@ pub struct _IO_FILE {
 pub type FILE = _IO_FILE;
 extern "C" {
     pub fn emscripten_get_preloaded_image_data(
-        path: *const ::std::os::raw::c_char,
-        w: *mut ::std::os::raw::c_int,
-        h: *mut ::std::os::raw::c_int,
-    ) -> *mut ::std::os::raw::c_char;
+        path: *const ::core::ffi::c_char,
+        w: *mut ::core::ffi::c_int,
+        h: *mut ::core::ffi::c_int,
+    ) -> *mut ::core::ffi::c_char;
 }
 extern "C" {
     pub fn emscripten_get_preloaded_image_data_from_FILE(
         file: *mut FILE,
-        w: *mut ::std::os::raw::c_int,
-        h: *mut ::std::os::raw::c_int,
-    ) -> *mut ::std::os::raw::c_char;
+        w: *mut ::core::ffi::c_int,
+        h: *mut ::core::ffi::c_int,
+    ) -> *mut ::core::ffi::c_char;
 }
 extern "C" {
-    pub fn emscripten_log(flags: ::std::os::raw::c_int, format: *const ::std::os::raw::c_char, ...);
+    pub fn emscripten_log(flags: ::core::ffi::c_int, format: *const ::core::ffi::c_char, ...);
 }
 extern "C" {
     pub fn emscripten_get_callstack(
-        flags: ::std::os::raw::c_int,
-        out: *mut ::std::os::raw::c_char,
-        maxbytes: ::std::os::raw::c_int,
-    ) -> ::std::os::raw::c_int;
+        flags: ::core::ffi::c_int,
+        out: *mut ::core::ffi::c_char,
+        maxbytes: ::core::ffi::c_int,
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_print_double(
         x: f64,
-        to: *mut ::std::os::raw::c_char,
-        max: ::std::os::raw::c_int,
-    ) -> ::std::os::raw::c_int;
+        to: *mut ::core::ffi::c_char,
+        max: ::core::ffi::c_int,
+    ) -> ::core::ffi::c_int;
 }
-pub type em_scan_func = ::std::option::Option<
-    unsafe extern "C" fn(arg1: *mut ::std::os::raw::c_void, arg2: *mut ::std::os::raw::c_void),
+pub type em_scan_func = ::core::option::Option<
+    unsafe extern "C" fn(arg1: *mut ::core::ffi::c_void, arg2: *mut ::core::ffi::c_void),
 >;
 extern "C" {
     pub fn emscripten_scan_registers(func: em_scan_func);
@@ -704,33 +704,33 @@ extern "C" {
 extern "C" {
     pub fn emscripten_scan_stack(func: em_scan_func);
 }
-pub type em_dlopen_callback = ::std::option::Option<
+pub type em_dlopen_callback = ::core::option::Option<
     unsafe extern "C" fn(
-        handle: *mut ::std::os::raw::c_void,
-        user_data: *mut ::std::os::raw::c_void,
+        handle: *mut ::core::ffi::c_void,
+        user_data: *mut ::core::ffi::c_void,
     ),
 >;
 extern "C" {
     pub fn emscripten_dlopen(
-        filename: *const ::std::os::raw::c_char,
-        flags: ::std::os::raw::c_int,
-        user_data: *mut ::std::os::raw::c_void,
+        filename: *const ::core::ffi::c_char,
+        flags: ::core::ffi::c_int,
+        user_data: *mut ::core::ffi::c_void,
         onsuccess: em_dlopen_callback,
         onerror: em_arg_callback_func,
     );
 }
 extern "C" {
     pub fn emscripten_dlopen_promise(
-        filename: *const ::std::os::raw::c_char,
-        flags: ::std::os::raw::c_int,
+        filename: *const ::core::ffi::c_char,
+        flags: ::core::ffi::c_int,
     ) -> em_promise_t;
 }
 extern "C" {
     pub fn emscripten_throw_number(number: f64);
 }
 extern "C" {
-    pub fn emscripten_throw_string(utf8String: *const ::std::os::raw::c_char);
+    pub fn emscripten_throw_string(utf8String: *const ::core::ffi::c_char);
 }
 extern "C" {
-    pub fn emscripten_sleep(ms: ::std::os::raw::c_uint);
+    pub fn emscripten_sleep(ms: ::core::ffi::c_uint);
 }
@@ -0,0 +1,83 @@
+pub const EMSCRIPTEN_FETCH_LOAD_TO_MEMORY: u32 = 1;
+pub const EMSCRIPTEN_FETCH_STREAM_DATA: u32 = 2;
+pub const EMSCRIPTEN_FETCH_PERSIST_FILE: u32 = 4;
+pub const EMSCRIPTEN_FETCH_APPEND: u32 = 8;
+pub const EMSCRIPTEN_FETCH_REPLACE: u32 = 16;
+pub const EMSCRIPTEN_FETCH_NO_DOWNLOAD: u32 = 32;
+pub const EMSCRIPTEN_FETCH_SYNCHRONOUS: u32 = 64;
+pub const EMSCRIPTEN_FETCH_WAITABLE: u32 = 128;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct emscripten_fetch_attr_t {
+    pub requestMethod: [::core::ffi::c_char; 32usize],
+    pub userData: *mut ::core::ffi::c_void,
+    pub onsuccess: ::core::option::Option<unsafe extern "C" fn(fetch: *mut emscripten_fetch_t)>,
+    pub onerror: ::core::option::Option<unsafe extern "C" fn(fetch: *mut emscripten_fetch_t)>,
+    pub onprogress: ::core::option::Option<unsafe extern "C" fn(fetch: *mut emscripten_fetch_t)>,
+    pub onreadystatechange:
+        ::core::option::Option<unsafe extern "C" fn(fetch: *mut emscripten_fetch_t)>,
+    pub attributes: u32,
+    pub timeoutMSecs: u32,
+    pub withCredentials: ::core::ffi::c_int,
+    pub destinationPath: *const ::core::ffi::c_char,
+    pub userName: *const ::core::ffi::c_char,
+    pub password: *const ::core::ffi::c_char,
+    pub requestHeaders: *const *const ::core::ffi::c_char,
+    pub overriddenMimeType: *const ::core::ffi::c_char,
+    pub requestData: *const ::core::ffi::c_char,
+    pub requestDataSize: usize,
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct emscripten_fetch_t {
+    pub id: u32,
+    pub userData: *mut ::core::ffi::c_void,
+    pub url: *const ::core::ffi::c_char,
+    pub data: *const ::core::ffi::c_char,
+    pub numBytes: u64,
+    pub dataOffset: u64,
+    pub totalBytes: u64,
+    pub readyState: ::core::ffi::c_ushort,
+    pub status: ::core::ffi::c_ushort,
+    pub statusText: [::core::ffi::c_char; 64usize],
+    pub __proxyState: u32,
+    pub __attributes: emscripten_fetch_attr_t,
+}
+extern "C" {
+    pub fn emscripten_fetch_attr_init(fetch_attr: *mut emscripten_fetch_attr_t);
+}
+extern "C" {
+    pub fn emscripten_fetch(
+        fetch_attr: *mut emscripten_fetch_attr_t,
+        url: *const ::core::ffi::c_char,
+    ) -> *mut emscripten_fetch_t;
+}
+extern "C" {
+    pub fn emscripten_fetch_wait(
+        fetch: *mut emscripten_fetch_t,
+        timeoutMSecs: f64,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_fetch_close(fetch: *mut emscripten_fetch_t) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_fetch_get_response_headers_length(fetch: *mut emscripten_fetch_t) -> usize;
+}
+extern "C" {
+    pub fn emscripten_fetch_get_response_headers(
+        fetch: *mut emscripten_fetch_t,
+        dst: *mut ::core::ffi::c_char,
+        dstSizeBytes: usize,
+    ) -> usize;
+}
+extern "C" {
+    pub fn emscripten_fetch_unpack_response_headers(
+        headersString: *const ::core::ffi::c_char,
+    ) -> *mut *mut ::core::ffi::c_char;
+}
+extern "C" {
+    pub fn emscripten_fetch_free_unpacked_response_headers(
+        unpackedHeaders: *mut *mut ::core::ffi::c_char,
+    );
+}
@@ -0,0 +1,53 @@
+pub type em_arg_callback_func =
+    ::core::option::Option<unsafe extern "C" fn(arg1: *mut ::core::ffi::c_void)>;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct asyncify_data_s {
+    #[doc = " Current position in the Asyncify stack (*not* the C stack)"]
+    pub stack_ptr: *mut ::core::ffi::c_void,
+    #[doc = " Where the Asyncify stack ends."]
+    pub stack_limit: *mut ::core::ffi::c_void,
+    #[doc = " Interned ID of the rewind entry point; opaque to application."]
+    pub rewind_id: ::core::ffi::c_int,
+}
+pub type asyncify_data_t = asyncify_data_s;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct emscripten_fiber_s {
+    #[doc = " Where the C stack starts (NOTE: grows down)."]
+    pub stack_base: *mut ::core::ffi::c_void,
+    #[doc = " Where the C stack ends."]
+    pub stack_limit: *mut ::core::ffi::c_void,
+    #[doc = " Current position in the C stack."]
+    pub stack_ptr: *mut ::core::ffi::c_void,
+    #[doc = " Function to call when resuming this context. If NULL, asyncify_data is used to rewind the call stack."]
+    pub entry: em_arg_callback_func,
+    #[doc = " Opaque pointer, passed as-is to the entry function."]
+    pub user_data: *mut ::core::ffi::c_void,
+    pub asyncify_data: asyncify_data_t,
+}
+pub type emscripten_fiber_t = emscripten_fiber_s;
+extern "C" {
+    pub fn emscripten_fiber_init(
+        fiber: *mut emscripten_fiber_t,
+        entry_func: em_arg_callback_func,
+        entry_func_arg: *mut ::core::ffi::c_void,
+        c_stack: *mut ::core::ffi::c_void,
+        c_stack_size: usize,
+        asyncify_stack: *mut ::core::ffi::c_void,
+        asyncify_stack_size: usize,
+    );
+}
+extern "C" {
+    pub fn emscripten_fiber_init_from_current_context(
+        fiber: *mut emscripten_fiber_t,
+        asyncify_stack: *mut ::core::ffi::c_void,
+        asyncify_stack_size: usize,
+    );
+}
+extern "C" {
+    pub fn emscripten_fiber_swap(
+        old_fiber: *mut emscripten_fiber_t,
+        new_fiber: *mut emscripten_fiber_t,
+    );
+}
@@ -0,0 +1,23 @@
+pub const WASM_PAGE_SIZE: u32 = 65536;
+pub const EMSCRIPTEN_PAGE_SIZE: u32 = 65536;
+extern "C" {
+    pub fn emscripten_get_sbrk_ptr() -> *mut usize;
+}
+extern "C" {
+    pub fn emscripten_resize_heap(requested_size: usize) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_get_heap_size() -> usize;
+}
+extern "C" {
+    pub fn emscripten_get_heap_max() -> usize;
+}
+extern "C" {
+    pub fn emscripten_builtin_memalign(alignment: usize, size: usize) -> *mut ::core::ffi::c_void;
+}
+extern "C" {
+    pub fn emscripten_builtin_malloc(size: usize) -> *mut ::core::ffi::c_void;
+}
+extern "C" {
+    pub fn emscripten_builtin_free(ptr: *mut ::core::ffi::c_void);
+}
@@ -1,5 +1,6 @@
 /* automatically generated by rust-bindgen 0.66.1 */
 
+pub use crate::pthread::{__pthread, pthread_t};
 pub const EM_TRUE: u32 = 1;
 pub const EM_FALSE: u32 = 0;
 pub const LONG_CODE: u8 = 105u8;
@@ -107,67 +108,61 @@ pub const EM_WEBGL_POWER_PREFERENCE_LOW_POWER: u32 = 1;
 pub const EM_WEBGL_POWER_PREFERENCE_HIGH_PERFORMANCE: u32 = 2;
 pub const EMSCRIPTEN_WEBGL_PARAM_TYPE_INT: u32 = 0;
 pub const EMSCRIPTEN_WEBGL_PARAM_TYPE_FLOAT: u32 = 1;
-#[repr(C)]
-#[derive(Debug, Copy, Clone)]
-pub struct __pthread {
-    _unused: [u8; 0],
-}
-pub type pthread_t = *mut __pthread;
-pub type emscripten_align1_short = ::std::os::raw::c_short;
-pub type emscripten_align4_int64 = ::std::os::raw::c_longlong;
-pub type emscripten_align2_int64 = ::std::os::raw::c_longlong;
-pub type emscripten_align1_int64 = ::std::os::raw::c_longlong;
-pub type emscripten_align2_int = ::std::os::raw::c_int;
-pub type emscripten_align1_int = ::std::os::raw::c_int;
+pub type emscripten_align1_short = ::core::ffi::c_short;
+pub type emscripten_align4_int64 = ::core::ffi::c_longlong;
+pub type emscripten_align2_int64 = ::core::ffi::c_longlong;
+pub type emscripten_align1_int64 = ::core::ffi::c_longlong;
+pub type emscripten_align2_int = ::core::ffi::c_int;
+pub type emscripten_align1_int = ::core::ffi::c_int;
 pub type emscripten_align2_float = f32;
 pub type emscripten_align1_float = f32;
 pub type emscripten_align4_double = f64;
 pub type emscripten_align2_double = f64;
 pub type emscripten_align1_double = f64;
-pub type em_callback_func = ::std::option::Option<unsafe extern "C" fn()>;
+pub type em_callback_func = ::core::option::Option<unsafe extern "C" fn()>;
 pub type em_arg_callback_func =
-    ::std::option::Option<unsafe extern "C" fn(arg1: *mut ::std::os::raw::c_void)>;
+    ::core::option::Option<unsafe extern "C" fn(arg1: *mut ::core::ffi::c_void)>;
 pub type em_str_callback_func =
-    ::std::option::Option<unsafe extern "C" fn(arg1: *const ::std::os::raw::c_char)>;
+    ::core::option::Option<unsafe extern "C" fn(arg1: *const ::core::ffi::c_char)>;
 extern "C" {
     pub fn emscripten_asm_const_int(
-        code: *const ::std::os::raw::c_char,
-        arg_sigs: *const ::std::os::raw::c_char,
+        code: *const ::core::ffi::c_char,
+        arg_sigs: *const ::core::ffi::c_char,
         ...
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_asm_const_ptr(
-        code: *const ::std::os::raw::c_char,
-        arg_sigs: *const ::std::os::raw::c_char,
+        code: *const ::core::ffi::c_char,
+        arg_sigs: *const ::core::ffi::c_char,
         ...
-    ) -> *mut ::std::os::raw::c_void;
+    ) -> *mut ::core::ffi::c_void;
 }
 extern "C" {
     pub fn emscripten_asm_const_double(
-        code: *const ::std::os::raw::c_char,
-        arg_sigs: *const ::std::os::raw::c_char,
+        code: *const ::core::ffi::c_char,
+        arg_sigs: *const ::core::ffi::c_char,
         ...
     ) -> f64;
 }
 extern "C" {
     pub fn emscripten_asm_const_int_sync_on_main_thread(
-        code: *const ::std::os::raw::c_char,
-        arg_sigs: *const ::std::os::raw::c_char,
+        code: *const ::core::ffi::c_char,
+        arg_sigs: *const ::core::ffi::c_char,
         ...
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_asm_const_double_sync_on_main_thread(
-        code: *const ::std::os::raw::c_char,
-        arg_sigs: *const ::std::os::raw::c_char,
+        code: *const ::core::ffi::c_char,
+        arg_sigs: *const ::core::ffi::c_char,
         ...
     ) -> f64;
 }
 extern "C" {
     pub fn emscripten_asm_const_async_on_main_thread(
-        code: *const ::std::os::raw::c_char,
-        arg_sigs: *const ::std::os::raw::c_char,
+        code: *const ::core::ffi::c_char,
+        arg_sigs: *const ::core::ffi::c_char,
         ...
     );
 }
@@ -181,12 +176,12 @@ pub const em_promise_result_t_EM_PROMISE_FULFILL: em_promise_result_t = 0;
 pub const em_promise_result_t_EM_PROMISE_MATCH: em_promise_result_t = 1;
 pub const em_promise_result_t_EM_PROMISE_MATCH_RELEASE: em_promise_result_t = 2;
 pub const em_promise_result_t_EM_PROMISE_REJECT: em_promise_result_t = 3;
-pub type em_promise_result_t = ::std::os::raw::c_uint;
-pub type em_promise_callback_t = ::std::option::Option<
+pub type em_promise_result_t = ::core::ffi::c_uint;
+pub type em_promise_callback_t = ::core::option::Option<
     unsafe extern "C" fn(
-        result: *mut *mut ::std::os::raw::c_void,
-        data: *mut ::std::os::raw::c_void,
-        value: *mut ::std::os::raw::c_void,
+        result: *mut *mut ::core::ffi::c_void,
+        data: *mut ::core::ffi::c_void,
+        value: *mut ::core::ffi::c_void,
     ) -> em_promise_result_t,
 >;
 extern "C" {
@@ -199,7 +194,7 @@ extern "C" {
     pub fn emscripten_promise_resolve(
         promise: em_promise_t,
         result: em_promise_result_t,
-        value: *mut ::std::os::raw::c_void,
+        value: *mut ::core::ffi::c_void,
     );
 }
 extern "C" {
@@ -207,13 +202,13 @@ extern "C" {
         promise: em_promise_t,
         on_fulfilled: em_promise_callback_t,
         on_rejected: em_promise_callback_t,
-        data: *mut ::std::os::raw::c_void,
+        data: *mut ::core::ffi::c_void,
     ) -> em_promise_t;
 }
 extern "C" {
     pub fn emscripten_promise_all(
         promises: *mut em_promise_t,
-        results: *mut *mut ::std::os::raw::c_void,
+        results: *mut *mut ::core::ffi::c_void,
         num_promises: usize,
     ) -> em_promise_t;
 }
@@ -221,24 +216,24 @@ extern "C" {
 #[derive(Debug, Copy, Clone)]
 pub struct em_settled_result_t {
     pub result: em_promise_result_t,
-    pub value: *mut ::std::os::raw::c_void,
+    pub value: *mut ::core::ffi::c_void,
 }
 #[test]
 fn bindgen_test_layout_em_settled_result_t() {
-    const UNINIT: ::std::mem::MaybeUninit<em_settled_result_t> = ::std::mem::MaybeUninit::uninit();
+    const UNINIT: ::core::mem::MaybeUninit<em_settled_result_t> = ::core::mem::MaybeUninit::uninit();
     let ptr = UNINIT.as_ptr();
     assert_eq!(
-        ::std::mem::size_of::<em_settled_result_t>(),
+        ::core::mem::size_of::<em_settled_result_t>(),
         16usize,
         concat!("Size of: ", stringify!(em_settled_result_t))
     );
     assert_eq!(
-        ::std::mem::align_of::<em_settled_result_t>(),
+        ::core::mem::align_of::<em_settled_result_t>(),
         8usize,
         concat!("Alignment of ", stringify!(em_settled_result_t))
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).result) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).result) as usize - ptr as usize },
         0usize,
         concat!(
             "Offset of field: ",
@@ -248,7 +243,7 @@ fn bindgen_test_layout_em_settled_result_t() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).value) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).value) as usize - ptr as usize },
         8usize,
         concat!(
             "Offset of field: ",
@@ -268,7 +263,7 @@ extern "C" {
 extern "C" {
     pub fn emscripten_promise_any(
         promises: *mut em_promise_t,
-        errors: *mut *mut ::std::os::raw::c_void,
+        errors: *mut *mut ::core::ffi::c_void,
         num_promises: usize,
     ) -> em_promise_t;
 }
@@ -283,128 +278,128 @@ extern "C" {
 }
 extern "C" {
     pub fn emscripten_async_wget(
-        url: *const ::std::os::raw::c_char,
-        file: *const ::std::os::raw::c_char,
+        url: *const ::core::ffi::c_char,
+        file: *const ::core::ffi::c_char,
         onload: em_str_callback_func,
         onerror: em_str_callback_func,
     );
 }
-pub type em_async_wget_onload_func = ::std::option::Option<
+pub type em_async_wget_onload_func = ::core::option::Option<
     unsafe extern "C" fn(
-        arg1: *mut ::std::os::raw::c_void,
-        arg2: *mut ::std::os::raw::c_void,
-        arg3: ::std::os::raw::c_int,
+        arg1: *mut ::core::ffi::c_void,
+        arg2: *mut ::core::ffi::c_void,
+        arg3: ::core::ffi::c_int,
     ),
 >;
 extern "C" {
     pub fn emscripten_async_wget_data(
-        url: *const ::std::os::raw::c_char,
-        arg: *mut ::std::os::raw::c_void,
+        url: *const ::core::ffi::c_char,
+        arg: *mut ::core::ffi::c_void,
         onload: em_async_wget_onload_func,
         onerror: em_arg_callback_func,
     );
 }
-pub type em_async_wget2_onload_func = ::std::option::Option<
+pub type em_async_wget2_onload_func = ::core::option::Option<
     unsafe extern "C" fn(
-        arg1: ::std::os::raw::c_uint,
-        arg2: *mut ::std::os::raw::c_void,
-        arg3: *const ::std::os::raw::c_char,
+        arg1: ::core::ffi::c_uint,
+        arg2: *mut ::core::ffi::c_void,
+        arg3: *const ::core::ffi::c_char,
     ),
 >;
-pub type em_async_wget2_onstatus_func = ::std::option::Option<
+pub type em_async_wget2_onstatus_func = ::core::option::Option<
     unsafe extern "C" fn(
-        arg1: ::std::os::raw::c_uint,
-        arg2: *mut ::std::os::raw::c_void,
-        arg3: ::std::os::raw::c_int,
+        arg1: ::core::ffi::c_uint,
+        arg2: *mut ::core::ffi::c_void,
+        arg3: ::core::ffi::c_int,
     ),
 >;
 extern "C" {
     pub fn emscripten_async_wget2(
-        url: *const ::std::os::raw::c_char,
-        file: *const ::std::os::raw::c_char,
-        requesttype: *const ::std::os::raw::c_char,
-        param: *const ::std::os::raw::c_char,
-        arg: *mut ::std::os::raw::c_void,
+        url: *const ::core::ffi::c_char,
+        file: *const ::core::ffi::c_char,
+        requesttype: *const ::core::ffi::c_char,
+        param: *const ::core::ffi::c_char,
+        arg: *mut ::core::ffi::c_void,
         onload: em_async_wget2_onload_func,
         onerror: em_async_wget2_onstatus_func,
         onprogress: em_async_wget2_onstatus_func,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
-pub type em_async_wget2_data_onload_func = ::std::option::Option<
+pub type em_async_wget2_data_onload_func = ::core::option::Option<
     unsafe extern "C" fn(
-        arg1: ::std::os::raw::c_uint,
-        arg2: *mut ::std::os::raw::c_void,
-        arg3: *mut ::std::os::raw::c_void,
-        arg4: ::std::os::raw::c_uint,
+        arg1: ::core::ffi::c_uint,
+        arg2: *mut ::core::ffi::c_void,
+        arg3: *mut ::core::ffi::c_void,
+        arg4: ::core::ffi::c_uint,
     ),
 >;
-pub type em_async_wget2_data_onerror_func = ::std::option::Option<
+pub type em_async_wget2_data_onerror_func = ::core::option::Option<
     unsafe extern "C" fn(
-        arg1: ::std::os::raw::c_uint,
-        arg2: *mut ::std::os::raw::c_void,
-        arg3: ::std::os::raw::c_int,
-        arg4: *const ::std::os::raw::c_char,
+        arg1: ::core::ffi::c_uint,
+        arg2: *mut ::core::ffi::c_void,
+        arg3: ::core::ffi::c_int,
+        arg4: *const ::core::ffi::c_char,
     ),
 >;
-pub type em_async_wget2_data_onprogress_func = ::std::option::Option<
+pub type em_async_wget2_data_onprogress_func = ::core::option::Option<
     unsafe extern "C" fn(
-        arg1: ::std::os::raw::c_uint,
-        arg2: *mut ::std::os::raw::c_void,
-        arg3: ::std::os::raw::c_int,
-        arg4: ::std::os::raw::c_int,
+        arg1: ::core::ffi::c_uint,
+        arg2: *mut ::core::ffi::c_void,
+        arg3: ::core::ffi::c_int,
+        arg4: ::core::ffi::c_int,
     ),
 >;
 extern "C" {
     pub fn emscripten_async_wget2_data(
-        url: *const ::std::os::raw::c_char,
-        requesttype: *const ::std::os::raw::c_char,
-        param: *const ::std::os::raw::c_char,
-        arg: *mut ::std::os::raw::c_void,
-        free: ::std::os::raw::c_int,
+        url: *const ::core::ffi::c_char,
+        requesttype: *const ::core::ffi::c_char,
+        param: *const ::core::ffi::c_char,
+        arg: *mut ::core::ffi::c_void,
+        free: ::core::ffi::c_int,
         onload: em_async_wget2_data_onload_func,
         onerror: em_async_wget2_data_onerror_func,
         onprogress: em_async_wget2_data_onprogress_func,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
-    pub fn emscripten_async_wget2_abort(handle: ::std::os::raw::c_int);
+    pub fn emscripten_async_wget2_abort(handle: ::core::ffi::c_int);
 }
 extern "C" {
     pub fn emscripten_wget(
-        url: *const ::std::os::raw::c_char,
-        file: *const ::std::os::raw::c_char,
-    ) -> ::std::os::raw::c_int;
+        url: *const ::core::ffi::c_char,
+        file: *const ::core::ffi::c_char,
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_wget_data(
-        url: *const ::std::os::raw::c_char,
-        pbuffer: *mut *mut ::std::os::raw::c_void,
-        pnum: *mut ::std::os::raw::c_int,
-        perror: *mut ::std::os::raw::c_int,
+        url: *const ::core::ffi::c_char,
+        pbuffer: *mut *mut ::core::ffi::c_void,
+        pnum: *mut ::core::ffi::c_int,
+        perror: *mut ::core::ffi::c_int,
     );
 }
 extern "C" {
-    pub fn emscripten_run_script(script: *const ::std::os::raw::c_char);
+    pub fn emscripten_run_script(script: *const ::core::ffi::c_char);
 }
 extern "C" {
     pub fn emscripten_run_script_int(
-        script: *const ::std::os::raw::c_char,
-    ) -> ::std::os::raw::c_int;
+        script: *const ::core::ffi::c_char,
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_run_script_string(
-        script: *const ::std::os::raw::c_char,
-    ) -> *mut ::std::os::raw::c_char;
+        script: *const ::core::ffi::c_char,
+    ) -> *mut ::core::ffi::c_char;
 }
 extern "C" {
     pub fn emscripten_async_run_script(
-        script: *const ::std::os::raw::c_char,
-        millis: ::std::os::raw::c_int,
+        script: *const ::core::ffi::c_char,
+        millis: ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_async_load_script(
-        script: *const ::std::os::raw::c_char,
+        script: *const ::core::ffi::c_char,
         onload: em_callback_func,
         onerror: em_callback_func,
     );
@@ -412,28 +407,28 @@ extern "C" {
 extern "C" {
     pub fn emscripten_set_main_loop(
         func: em_callback_func,
-        fps: ::std::os::raw::c_int,
-        simulate_infinite_loop: ::std::os::raw::c_int,
+        fps: ::core::ffi::c_int,
+        simulate_infinite_loop: ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_set_main_loop_timing(
-        mode: ::std::os::raw::c_int,
-        value: ::std::os::raw::c_int,
-    ) -> ::std::os::raw::c_int;
+        mode: ::core::ffi::c_int,
+        value: ::core::ffi::c_int,
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_get_main_loop_timing(
-        mode: *mut ::std::os::raw::c_int,
-        value: *mut ::std::os::raw::c_int,
+        mode: *mut ::core::ffi::c_int,
+        value: *mut ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_set_main_loop_arg(
         func: em_arg_callback_func,
-        arg: *mut ::std::os::raw::c_void,
-        fps: ::std::os::raw::c_int,
-        simulate_infinite_loop: ::std::os::raw::c_int,
+        arg: *mut ::core::ffi::c_void,
+        fps: ::core::ffi::c_int,
+        simulate_infinite_loop: ::core::ffi::c_int,
     );
 }
 extern "C" {
@@ -445,109 +440,109 @@ extern "C" {
 extern "C" {
     pub fn emscripten_cancel_main_loop();
 }
-pub type em_socket_callback = ::std::option::Option<
-    unsafe extern "C" fn(fd: ::std::os::raw::c_int, userData: *mut ::std::os::raw::c_void),
+pub type em_socket_callback = ::core::option::Option<
+    unsafe extern "C" fn(fd: ::core::ffi::c_int, userData: *mut ::core::ffi::c_void),
 >;
-pub type em_socket_error_callback = ::std::option::Option<
+pub type em_socket_error_callback = ::core::option::Option<
     unsafe extern "C" fn(
-        fd: ::std::os::raw::c_int,
-        err: ::std::os::raw::c_int,
-        msg: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
+        fd: ::core::ffi::c_int,
+        err: ::core::ffi::c_int,
+        msg: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
     ),
 >;
 extern "C" {
     pub fn emscripten_set_socket_error_callback(
-        userData: *mut ::std::os::raw::c_void,
+        userData: *mut ::core::ffi::c_void,
         callback: em_socket_error_callback,
     );
 }
 extern "C" {
     pub fn emscripten_set_socket_open_callback(
-        userData: *mut ::std::os::raw::c_void,
+        userData: *mut ::core::ffi::c_void,
         callback: em_socket_callback,
     );
 }
 extern "C" {
     pub fn emscripten_set_socket_listen_callback(
-        userData: *mut ::std::os::raw::c_void,
+        userData: *mut ::core::ffi::c_void,
         callback: em_socket_callback,
     );
 }
 extern "C" {
     pub fn emscripten_set_socket_connection_callback(
-        userData: *mut ::std::os::raw::c_void,
+        userData: *mut ::core::ffi::c_void,
         callback: em_socket_callback,
     );
 }
 extern "C" {
     pub fn emscripten_set_socket_message_callback(
-        userData: *mut ::std::os::raw::c_void,
+        userData: *mut ::core::ffi::c_void,
         callback: em_socket_callback,
     );
 }
 extern "C" {
     pub fn emscripten_set_socket_close_callback(
-        userData: *mut ::std::os::raw::c_void,
+        userData: *mut ::core::ffi::c_void,
         callback: em_socket_callback,
     );
 }
 extern "C" {
     pub fn _emscripten_push_main_loop_blocker(
         func: em_arg_callback_func,
-        arg: *mut ::std::os::raw::c_void,
-        name: *const ::std::os::raw::c_char,
+        arg: *mut ::core::ffi::c_void,
+        name: *const ::core::ffi::c_char,
     );
 }
 extern "C" {
     pub fn _emscripten_push_uncounted_main_loop_blocker(
         func: em_arg_callback_func,
-        arg: *mut ::std::os::raw::c_void,
-        name: *const ::std::os::raw::c_char,
+        arg: *mut ::core::ffi::c_void,
+        name: *const ::core::ffi::c_char,
     );
 }
 extern "C" {
-    pub fn emscripten_set_main_loop_expected_blockers(num: ::std::os::raw::c_int);
+    pub fn emscripten_set_main_loop_expected_blockers(num: ::core::ffi::c_int);
 }
 extern "C" {
     pub fn emscripten_async_call(
         func: em_arg_callback_func,
-        arg: *mut ::std::os::raw::c_void,
-        millis: ::std::os::raw::c_int,
+        arg: *mut ::core::ffi::c_void,
+        millis: ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_exit_with_live_runtime() -> !;
 }
 extern "C" {
-    pub fn emscripten_force_exit(status: ::std::os::raw::c_int) -> !;
+    pub fn emscripten_force_exit(status: ::core::ffi::c_int) -> !;
 }
 extern "C" {
     pub fn emscripten_get_device_pixel_ratio() -> f64;
 }
 extern "C" {
-    pub fn emscripten_get_window_title() -> *mut ::std::os::raw::c_char;
+    pub fn emscripten_get_window_title() -> *mut ::core::ffi::c_char;
 }
 extern "C" {
-    pub fn emscripten_set_window_title(arg1: *const ::std::os::raw::c_char);
+    pub fn emscripten_set_window_title(arg1: *const ::core::ffi::c_char);
 }
 extern "C" {
     pub fn emscripten_get_screen_size(
-        width: *mut ::std::os::raw::c_int,
-        height: *mut ::std::os::raw::c_int,
+        width: *mut ::core::ffi::c_int,
+        height: *mut ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_hide_mouse();
 }
 extern "C" {
-    pub fn emscripten_set_canvas_size(width: ::std::os::raw::c_int, height: ::std::os::raw::c_int);
+    pub fn emscripten_set_canvas_size(width: ::core::ffi::c_int, height: ::core::ffi::c_int);
 }
 extern "C" {
     pub fn emscripten_get_canvas_size(
-        width: *mut ::std::os::raw::c_int,
-        height: *mut ::std::os::raw::c_int,
-        isFullscreen: *mut ::std::os::raw::c_int,
+        width: *mut ::core::ffi::c_int,
+        height: *mut ::core::ffi::c_int,
+        isFullscreen: *mut ::core::ffi::c_int,
     );
 }
 extern "C" {
@@ -556,145 +551,145 @@ extern "C" {
 extern "C" {
     pub fn emscripten_random() -> f32;
 }
-pub type em_idb_onload_func = ::std::option::Option<
+pub type em_idb_onload_func = ::core::option::Option<
     unsafe extern "C" fn(
-        arg1: *mut ::std::os::raw::c_void,
-        arg2: *mut ::std::os::raw::c_void,
-        arg3: ::std::os::raw::c_int,
+        arg1: *mut ::core::ffi::c_void,
+        arg2: *mut ::core::ffi::c_void,
+        arg3: ::core::ffi::c_int,
     ),
 >;
 extern "C" {
     pub fn emscripten_idb_async_load(
-        db_name: *const ::std::os::raw::c_char,
-        file_id: *const ::std::os::raw::c_char,
-        arg: *mut ::std::os::raw::c_void,
+        db_name: *const ::core::ffi::c_char,
+        file_id: *const ::core::ffi::c_char,
+        arg: *mut ::core::ffi::c_void,
         onload: em_idb_onload_func,
         onerror: em_arg_callback_func,
     );
 }
 extern "C" {
     pub fn emscripten_idb_async_store(
-        db_name: *const ::std::os::raw::c_char,
-        file_id: *const ::std::os::raw::c_char,
-        ptr: *mut ::std::os::raw::c_void,
-        num: ::std::os::raw::c_int,
-        arg: *mut ::std::os::raw::c_void,
+        db_name: *const ::core::ffi::c_char,
+        file_id: *const ::core::ffi::c_char,
+        ptr: *mut ::core::ffi::c_void,
+        num: ::core::ffi::c_int,
+        arg: *mut ::core::ffi::c_void,
         onstore: em_arg_callback_func,
         onerror: em_arg_callback_func,
     );
 }
 extern "C" {
     pub fn emscripten_idb_async_delete(
-        db_name: *const ::std::os::raw::c_char,
-        file_id: *const ::std::os::raw::c_char,
-        arg: *mut ::std::os::raw::c_void,
+        db_name: *const ::core::ffi::c_char,
+        file_id: *const ::core::ffi::c_char,
+        arg: *mut ::core::ffi::c_void,
         ondelete: em_arg_callback_func,
         onerror: em_arg_callback_func,
     );
 }
-pub type em_idb_exists_func = ::std::option::Option<
-    unsafe extern "C" fn(arg1: *mut ::std::os::raw::c_void, arg2: ::std::os::raw::c_int),
+pub type em_idb_exists_func = ::core::option::Option<
+    unsafe extern "C" fn(arg1: *mut ::core::ffi::c_void, arg2: ::core::ffi::c_int),
 >;
 extern "C" {
     pub fn emscripten_idb_async_exists(
-        db_name: *const ::std::os::raw::c_char,
-        file_id: *const ::std::os::raw::c_char,
-        arg: *mut ::std::os::raw::c_void,
+        db_name: *const ::core::ffi::c_char,
+        file_id: *const ::core::ffi::c_char,
+        arg: *mut ::core::ffi::c_void,
         oncheck: em_idb_exists_func,
         onerror: em_arg_callback_func,
     );
 }
 extern "C" {
     pub fn emscripten_idb_async_clear(
-        db_name: *const ::std::os::raw::c_char,
-        arg: *mut ::std::os::raw::c_void,
+        db_name: *const ::core::ffi::c_char,
+        arg: *mut ::core::ffi::c_void,
         onclear: em_arg_callback_func,
         onerror: em_arg_callback_func,
     );
 }
 extern "C" {
     pub fn emscripten_idb_load(
-        db_name: *const ::std::os::raw::c_char,
-        file_id: *const ::std::os::raw::c_char,
-        pbuffer: *mut *mut ::std::os::raw::c_void,
-        pnum: *mut ::std::os::raw::c_int,
-        perror: *mut ::std::os::raw::c_int,
+        db_name: *const ::core::ffi::c_char,
+        file_id: *const ::core::ffi::c_char,
+        pbuffer: *mut *mut ::core::ffi::c_void,
+        pnum: *mut ::core::ffi::c_int,
+        perror: *mut ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_idb_store(
-        db_name: *const ::std::os::raw::c_char,
-        file_id: *const ::std::os::raw::c_char,
-        buffer: *mut ::std::os::raw::c_void,
-        num: ::std::os::raw::c_int,
-        perror: *mut ::std::os::raw::c_int,
+        db_name: *const ::core::ffi::c_char,
+        file_id: *const ::core::ffi::c_char,
+        buffer: *mut ::core::ffi::c_void,
+        num: ::core::ffi::c_int,
+        perror: *mut ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_idb_delete(
-        db_name: *const ::std::os::raw::c_char,
-        file_id: *const ::std::os::raw::c_char,
-        perror: *mut ::std::os::raw::c_int,
+        db_name: *const ::core::ffi::c_char,
+        file_id: *const ::core::ffi::c_char,
+        perror: *mut ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_idb_exists(
-        db_name: *const ::std::os::raw::c_char,
-        file_id: *const ::std::os::raw::c_char,
-        pexists: *mut ::std::os::raw::c_int,
-        perror: *mut ::std::os::raw::c_int,
+        db_name: *const ::core::ffi::c_char,
+        file_id: *const ::core::ffi::c_char,
+        pexists: *mut ::core::ffi::c_int,
+        perror: *mut ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_idb_clear(
-        db_name: *const ::std::os::raw::c_char,
-        perror: *mut ::std::os::raw::c_int,
+        db_name: *const ::core::ffi::c_char,
+        perror: *mut ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_idb_load_blob(
-        db_name: *const ::std::os::raw::c_char,
-        file_id: *const ::std::os::raw::c_char,
-        pblob: *mut ::std::os::raw::c_int,
-        perror: *mut ::std::os::raw::c_int,
+        db_name: *const ::core::ffi::c_char,
+        file_id: *const ::core::ffi::c_char,
+        pblob: *mut ::core::ffi::c_int,
+        perror: *mut ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_idb_store_blob(
-        db_name: *const ::std::os::raw::c_char,
-        file_id: *const ::std::os::raw::c_char,
-        buffer: *mut ::std::os::raw::c_void,
-        num: ::std::os::raw::c_int,
-        perror: *mut ::std::os::raw::c_int,
+        db_name: *const ::core::ffi::c_char,
+        file_id: *const ::core::ffi::c_char,
+        buffer: *mut ::core::ffi::c_void,
+        num: ::core::ffi::c_int,
+        perror: *mut ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_idb_read_from_blob(
-        blob: ::std::os::raw::c_int,
-        start: ::std::os::raw::c_int,
-        num: ::std::os::raw::c_int,
-        buffer: *mut ::std::os::raw::c_void,
+        blob: ::core::ffi::c_int,
+        start: ::core::ffi::c_int,
+        num: ::core::ffi::c_int,
+        buffer: *mut ::core::ffi::c_void,
     );
 }
 extern "C" {
-    pub fn emscripten_idb_free_blob(blob: ::std::os::raw::c_int);
+    pub fn emscripten_idb_free_blob(blob: ::core::ffi::c_int);
 }
 extern "C" {
     pub fn emscripten_run_preload_plugins(
-        file: *const ::std::os::raw::c_char,
+        file: *const ::core::ffi::c_char,
         onload: em_str_callback_func,
         onerror: em_str_callback_func,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
-pub type em_run_preload_plugins_data_onload_func = ::std::option::Option<
-    unsafe extern "C" fn(arg1: *mut ::std::os::raw::c_void, arg2: *const ::std::os::raw::c_char),
+pub type em_run_preload_plugins_data_onload_func = ::core::option::Option<
+    unsafe extern "C" fn(arg1: *mut ::core::ffi::c_void, arg2: *const ::core::ffi::c_char),
 >;
 extern "C" {
     pub fn emscripten_run_preload_plugins_data(
-        data: *mut ::std::os::raw::c_char,
-        size: ::std::os::raw::c_int,
-        suffix: *const ::std::os::raw::c_char,
-        arg: *mut ::std::os::raw::c_void,
+        data: *mut ::core::ffi::c_char,
+        size: ::core::ffi::c_int,
+        suffix: *const ::core::ffi::c_char,
+        arg: *mut ::core::ffi::c_void,
         onload: em_run_preload_plugins_data_onload_func,
         onerror: em_arg_callback_func,
     );
@@ -702,52 +697,52 @@ extern "C" {
 extern "C" {
     pub fn emscripten_lazy_load_code();
 }
-pub type worker_handle = ::std::os::raw::c_int;
+pub type worker_handle = ::core::ffi::c_int;
 extern "C" {
-    pub fn emscripten_create_worker(url: *const ::std::os::raw::c_char) -> worker_handle;
+    pub fn emscripten_create_worker(url: *const ::core::ffi::c_char) -> worker_handle;
 }
 extern "C" {
     pub fn emscripten_destroy_worker(worker: worker_handle);
 }
-pub type em_worker_callback_func = ::std::option::Option<
+pub type em_worker_callback_func = ::core::option::Option<
     unsafe extern "C" fn(
-        arg1: *mut ::std::os::raw::c_char,
-        arg2: ::std::os::raw::c_int,
-        arg3: *mut ::std::os::raw::c_void,
+        arg1: *mut ::core::ffi::c_char,
+        arg2: ::core::ffi::c_int,
+        arg3: *mut ::core::ffi::c_void,
     ),
 >;
 extern "C" {
     pub fn emscripten_call_worker(
         worker: worker_handle,
-        funcname: *const ::std::os::raw::c_char,
-        data: *mut ::std::os::raw::c_char,
-        size: ::std::os::raw::c_int,
+        funcname: *const ::core::ffi::c_char,
+        data: *mut ::core::ffi::c_char,
+        size: ::core::ffi::c_int,
         callback: em_worker_callback_func,
-        arg: *mut ::std::os::raw::c_void,
+        arg: *mut ::core::ffi::c_void,
     );
 }
 extern "C" {
     pub fn emscripten_worker_respond(
-        data: *mut ::std::os::raw::c_char,
-        size: ::std::os::raw::c_int,
+        data: *mut ::core::ffi::c_char,
+        size: ::core::ffi::c_int,
     );
 }
 extern "C" {
     pub fn emscripten_worker_respond_provisionally(
-        data: *mut ::std::os::raw::c_char,
-        size: ::std::os::raw::c_int,
+        data: *mut ::core::ffi::c_char,
+        size: ::core::ffi::c_int,
     );
 }
 extern "C" {
-    pub fn emscripten_get_worker_queue_size(worker: worker_handle) -> ::std::os::raw::c_int;
+    pub fn emscripten_get_worker_queue_size(worker: worker_handle) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_get_compiler_setting(
-        name: *const ::std::os::raw::c_char,
-    ) -> ::std::os::raw::c_long;
+        name: *const ::core::ffi::c_char,
+    ) -> ::core::ffi::c_long;
 }
 extern "C" {
-    pub fn emscripten_has_asyncify() -> ::std::os::raw::c_int;
+    pub fn emscripten_has_asyncify() -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_debugger();
@@ -760,37 +755,37 @@ pub struct _IO_FILE {
 pub type FILE = _IO_FILE;
 extern "C" {
     pub fn emscripten_get_preloaded_image_data(
-        path: *const ::std::os::raw::c_char,
-        w: *mut ::std::os::raw::c_int,
-        h: *mut ::std::os::raw::c_int,
-    ) -> *mut ::std::os::raw::c_char;
+        path: *const ::core::ffi::c_char,
+        w: *mut ::core::ffi::c_int,
+        h: *mut ::core::ffi::c_int,
+    ) -> *mut ::core::ffi::c_char;
 }
 extern "C" {
     pub fn emscripten_get_preloaded_image_data_from_FILE(
         file: *mut FILE,
-        w: *mut ::std::os::raw::c_int,
-        h: *mut ::std::os::raw::c_int,
-    ) -> *mut ::std::os::raw::c_char;
+        w: *mut ::core::ffi::c_int,
+        h: *mut ::core::ffi::c_int,
+    ) -> *mut ::core::ffi::c_char;
 }
 extern "C" {
-    pub fn emscripten_log(flags: ::std::os::raw::c_int, format: *const ::std::os::raw::c_char, ...);
+    pub fn emscripten_log(flags: ::core::ffi::c_int, format: *const ::core::ffi::c_char, ...);
 }
 extern "C" {
     pub fn emscripten_get_callstack(
-        flags: ::std::os::raw::c_int,
-        out: *mut ::std::os::raw::c_char,
-        maxbytes: ::std::os::raw::c_int,
-    ) -> ::std::os::raw::c_int;
+        flags: ::core::ffi::c_int,
+        out: *mut ::core::ffi::c_char,
+        maxbytes: ::core::ffi::c_int,
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_print_double(
         x: f64,
-        to: *mut ::std::os::raw::c_char,
-        max: ::std::os::raw::c_int,
-    ) -> ::std::os::raw::c_int;
+        to: *mut ::core::ffi::c_char,
+        max: ::core::ffi::c_int,
+    ) -> ::core::ffi::c_int;
 }
-pub type em_scan_func = ::std::option::Option<
-    unsafe extern "C" fn(arg1: *mut ::std::os::raw::c_void, arg2: *mut ::std::os::raw::c_void),
+pub type em_scan_func = ::core::option::Option<
+    unsafe extern "C" fn(arg1: *mut ::core::ffi::c_void, arg2: *mut ::core::ffi::c_void),
 >;
 extern "C" {
     pub fn emscripten_scan_registers(func: em_scan_func);
@@ -798,87 +793,87 @@ extern "C" {
 extern "C" {
     pub fn emscripten_scan_stack(func: em_scan_func);
 }
-pub type em_dlopen_callback = ::std::option::Option<
+pub type em_dlopen_callback = ::core::option::Option<
     unsafe extern "C" fn(
-        handle: *mut ::std::os::raw::c_void,
-        user_data: *mut ::std::os::raw::c_void,
+        handle: *mut ::core::ffi::c_void,
+        user_data: *mut ::core::ffi::c_void,
     ),
 >;
 extern "C" {
     pub fn emscripten_dlopen(
-        filename: *const ::std::os::raw::c_char,
-        flags: ::std::os::raw::c_int,
-        user_data: *mut ::std::os::raw::c_void,
+        filename: *const ::core::ffi::c_char,
+        flags: ::core::ffi::c_int,
+        user_data: *mut ::core::ffi::c_void,
         onsuccess: em_dlopen_callback,
         onerror: em_arg_callback_func,
     );
 }
 extern "C" {
     pub fn emscripten_dlopen_promise(
-        filename: *const ::std::os::raw::c_char,
-        flags: ::std::os::raw::c_int,
+        filename: *const ::core::ffi::c_char,
+        flags: ::core::ffi::c_int,
     ) -> em_promise_t;
 }
 extern "C" {
     pub fn emscripten_throw_number(number: f64);
 }
 extern "C" {
-    pub fn emscripten_throw_string(utf8String: *const ::std::os::raw::c_char);
+    pub fn emscripten_throw_string(utf8String: *const ::core::ffi::c_char);
 }
 extern "C" {
-    pub fn emscripten_sleep(ms: ::std::os::raw::c_uint);
+    pub fn emscripten_sleep(ms: ::core::ffi::c_uint);
 }
 extern "C" {
     pub fn emscripten_unwind_to_js_event_loop() -> !;
 }
 extern "C" {
     pub fn emscripten_set_timeout(
-        cb: ::std::option::Option<unsafe extern "C" fn(user_data: *mut ::std::os::raw::c_void)>,
+        cb: ::core::option::Option<unsafe extern "C" fn(user_data: *mut ::core::ffi::c_void)>,
         msecs: f64,
-        user_data: *mut ::std::os::raw::c_void,
-    ) -> ::std::os::raw::c_int;
+        user_data: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
-    pub fn emscripten_clear_timeout(id: ::std::os::raw::c_int);
+    pub fn emscripten_clear_timeout(id: ::core::ffi::c_int);
 }
 extern "C" {
     pub fn emscripten_set_timeout_loop(
-        cb: ::std::option::Option<
+        cb: ::core::option::Option<
             unsafe extern "C" fn(
                 time: f64,
-                user_data: *mut ::std::os::raw::c_void,
-            ) -> ::std::os::raw::c_int,
+                user_data: *mut ::core::ffi::c_void,
+            ) -> ::core::ffi::c_int,
         >,
         interval_ms: f64,
-        user_data: *mut ::std::os::raw::c_void,
+        user_data: *mut ::core::ffi::c_void,
     );
 }
 extern "C" {
     pub fn emscripten_set_immediate(
-        cb: ::std::option::Option<unsafe extern "C" fn(user_data: *mut ::std::os::raw::c_void)>,
-        user_data: *mut ::std::os::raw::c_void,
-    ) -> ::std::os::raw::c_int;
+        cb: ::core::option::Option<unsafe extern "C" fn(user_data: *mut ::core::ffi::c_void)>,
+        user_data: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
-    pub fn emscripten_clear_immediate(id: ::std::os::raw::c_int);
+    pub fn emscripten_clear_immediate(id: ::core::ffi::c_int);
 }
 extern "C" {
     pub fn emscripten_set_immediate_loop(
-        cb: ::std::option::Option<
-            unsafe extern "C" fn(user_data: *mut ::std::os::raw::c_void) -> ::std::os::raw::c_int,
+        cb: ::core::option::Option<
+            unsafe extern "C" fn(user_data: *mut ::core::ffi::c_void) -> ::core::ffi::c_int,
         >,
-        user_data: *mut ::std::os::raw::c_void,
+        user_data: *mut ::core::ffi::c_void,
     );
 }
 extern "C" {
     pub fn emscripten_set_interval(
-        cb: ::std::option::Option<unsafe extern "C" fn(user_data: *mut ::std::os::raw::c_void)>,
+        cb: ::core::option::Option<unsafe extern "C" fn(user_data: *mut ::core::ffi::c_void)>,
         interval_ms: f64,
-        user_data: *mut ::std::os::raw::c_void,
-    ) -> ::std::os::raw::c_int;
+        user_data: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
-    pub fn emscripten_clear_interval(id: ::std::os::raw::c_int);
+    pub fn emscripten_clear_interval(id: ::core::ffi::c_int);
 }
 extern "C" {
     pub fn emscripten_runtime_keepalive_push();
@@ -887,88 +882,88 @@ extern "C" {
     pub fn emscripten_runtime_keepalive_pop();
 }
 extern "C" {
-    pub fn emscripten_runtime_keepalive_check() -> ::std::os::raw::c_int;
+    pub fn emscripten_runtime_keepalive_check() -> ::core::ffi::c_int;
 }
 extern "C" {
-    pub fn emscripten_console_log(utf8String: *const ::std::os::raw::c_char);
+    pub fn emscripten_console_log(utf8String: *const ::core::ffi::c_char);
 }
 extern "C" {
-    pub fn emscripten_console_warn(utf8String: *const ::std::os::raw::c_char);
+    pub fn emscripten_console_warn(utf8String: *const ::core::ffi::c_char);
 }
 extern "C" {
-    pub fn emscripten_console_error(utf8String: *const ::std::os::raw::c_char);
+    pub fn emscripten_console_error(utf8String: *const ::core::ffi::c_char);
 }
 extern "C" {
-    pub fn emscripten_out(utf8String: *const ::std::os::raw::c_char);
+    pub fn emscripten_out(utf8String: *const ::core::ffi::c_char);
 }
 extern "C" {
-    pub fn emscripten_err(utf8String: *const ::std::os::raw::c_char);
+    pub fn emscripten_err(utf8String: *const ::core::ffi::c_char);
 }
 extern "C" {
-    pub fn emscripten_dbg(utf8String: *const ::std::os::raw::c_char);
+    pub fn emscripten_dbg(utf8String: *const ::core::ffi::c_char);
 }
 extern "C" {
-    pub fn emscripten_outn(utf8String: *const ::std::os::raw::c_char, len: usize);
+    pub fn emscripten_outn(utf8String: *const ::core::ffi::c_char, len: usize);
 }
 extern "C" {
-    pub fn emscripten_errn(utf8String: *const ::std::os::raw::c_char, len: usize);
+    pub fn emscripten_errn(utf8String: *const ::core::ffi::c_char, len: usize);
 }
 extern "C" {
-    pub fn emscripten_dbgn(utf8String: *const ::std::os::raw::c_char, len: usize);
+    pub fn emscripten_dbgn(utf8String: *const ::core::ffi::c_char, len: usize);
 }
 extern "C" {
-    pub fn emscripten_console_logf(format: *const ::std::os::raw::c_char, ...);
+    pub fn emscripten_console_logf(format: *const ::core::ffi::c_char, ...);
 }
 extern "C" {
-    pub fn emscripten_console_warnf(format: *const ::std::os::raw::c_char, ...);
+    pub fn emscripten_console_warnf(format: *const ::core::ffi::c_char, ...);
 }
 extern "C" {
-    pub fn emscripten_console_errorf(format: *const ::std::os::raw::c_char, ...);
+    pub fn emscripten_console_errorf(format: *const ::core::ffi::c_char, ...);
 }
 extern "C" {
-    pub fn emscripten_outf(format: *const ::std::os::raw::c_char, ...);
+    pub fn emscripten_outf(format: *const ::core::ffi::c_char, ...);
 }
 extern "C" {
-    pub fn emscripten_errf(format: *const ::std::os::raw::c_char, ...);
+    pub fn emscripten_errf(format: *const ::core::ffi::c_char, ...);
 }
 extern "C" {
-    pub fn emscripten_dbgf(format: *const ::std::os::raw::c_char, ...);
+    pub fn emscripten_dbgf(format: *const ::core::ffi::c_char, ...);
 }
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
 pub struct EmscriptenKeyboardEvent {
     pub timestamp: f64,
-    pub location: ::std::os::raw::c_ulong,
-    pub ctrlKey: ::std::os::raw::c_int,
-    pub shiftKey: ::std::os::raw::c_int,
-    pub altKey: ::std::os::raw::c_int,
-    pub metaKey: ::std::os::raw::c_int,
-    pub repeat: ::std::os::raw::c_int,
-    pub charCode: ::std::os::raw::c_ulong,
-    pub keyCode: ::std::os::raw::c_ulong,
-    pub which: ::std::os::raw::c_ulong,
-    pub key: [::std::os::raw::c_char; 32usize],
-    pub code: [::std::os::raw::c_char; 32usize],
-    pub charValue: [::std::os::raw::c_char; 32usize],
-    pub locale: [::std::os::raw::c_char; 32usize],
+    pub location: ::core::ffi::c_ulong,
+    pub ctrlKey: ::core::ffi::c_int,
+    pub shiftKey: ::core::ffi::c_int,
+    pub altKey: ::core::ffi::c_int,
+    pub metaKey: ::core::ffi::c_int,
+    pub repeat: ::core::ffi::c_int,
+    pub charCode: ::core::ffi::c_ulong,
+    pub keyCode: ::core::ffi::c_ulong,
+    pub which: ::core::ffi::c_ulong,
+    pub key: [::core::ffi::c_char; 32usize],
+    pub code: [::core::ffi::c_char; 32usize],
+    pub charValue: [::core::ffi::c_char; 32usize],
+    pub locale: [::core::ffi::c_char; 32usize],
 }
 #[test]
 fn bindgen_test_layout_EmscriptenKeyboardEvent() {
-    const UNINIT: ::std::mem::MaybeUninit<EmscriptenKeyboardEvent> =
-        ::std::mem::MaybeUninit::uninit();
+    const UNINIT: ::core::mem::MaybeUninit<EmscriptenKeyboardEvent> =
+        ::core::mem::MaybeUninit::uninit();
     let ptr = UNINIT.as_ptr();
     assert_eq!(
-        ::std::mem::size_of::<EmscriptenKeyboardEvent>(),
+        ::core::mem::size_of::<EmscriptenKeyboardEvent>(),
         192usize,
         concat!("Size of: ", stringify!(EmscriptenKeyboardEvent))
     );
     assert_eq!(
-        ::std::mem::align_of::<EmscriptenKeyboardEvent>(),
+        ::core::mem::align_of::<EmscriptenKeyboardEvent>(),
         8usize,
         concat!("Alignment of ", stringify!(EmscriptenKeyboardEvent))
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).timestamp) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).timestamp) as usize - ptr as usize },
         0usize,
         concat!(
             "Offset of field: ",
@@ -978,7 +973,7 @@ fn bindgen_test_layout_EmscriptenKeyboardEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).location) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).location) as usize - ptr as usize },
         8usize,
         concat!(
             "Offset of field: ",
@@ -988,7 +983,7 @@ fn bindgen_test_layout_EmscriptenKeyboardEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).ctrlKey) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).ctrlKey) as usize - ptr as usize },
         16usize,
         concat!(
             "Offset of field: ",
@@ -998,7 +993,7 @@ fn bindgen_test_layout_EmscriptenKeyboardEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).shiftKey) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).shiftKey) as usize - ptr as usize },
         20usize,
         concat!(
             "Offset of field: ",
@@ -1008,7 +1003,7 @@ fn bindgen_test_layout_EmscriptenKeyboardEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).altKey) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).altKey) as usize - ptr as usize },
         24usize,
         concat!(
             "Offset of field: ",
@@ -1018,7 +1013,7 @@ fn bindgen_test_layout_EmscriptenKeyboardEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).metaKey) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).metaKey) as usize - ptr as usize },
         28usize,
         concat!(
             "Offset of field: ",
@@ -1028,7 +1023,7 @@ fn bindgen_test_layout_EmscriptenKeyboardEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).repeat) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).repeat) as usize - ptr as usize },
         32usize,
         concat!(
             "Offset of field: ",
@@ -1038,7 +1033,7 @@ fn bindgen_test_layout_EmscriptenKeyboardEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).charCode) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).charCode) as usize - ptr as usize },
         40usize,
         concat!(
             "Offset of field: ",
@@ -1048,7 +1043,7 @@ fn bindgen_test_layout_EmscriptenKeyboardEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).keyCode) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).keyCode) as usize - ptr as usize },
         48usize,
         concat!(
             "Offset of field: ",
@@ -1058,7 +1053,7 @@ fn bindgen_test_layout_EmscriptenKeyboardEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).which) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).which) as usize - ptr as usize },
         56usize,
         concat!(
             "Offset of field: ",
@@ -1068,7 +1063,7 @@ fn bindgen_test_layout_EmscriptenKeyboardEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).key) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).key) as usize - ptr as usize },
         64usize,
         concat!(
             "Offset of field: ",
@@ -1078,7 +1073,7 @@ fn bindgen_test_layout_EmscriptenKeyboardEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).code) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).code) as usize - ptr as usize },
         96usize,
         concat!(
             "Offset of field: ",
@@ -1088,7 +1083,7 @@ fn bindgen_test_layout_EmscriptenKeyboardEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).charValue) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).charValue) as usize - ptr as usize },
         128usize,
         concat!(
             "Offset of field: ",
@@ -1098,7 +1093,7 @@ fn bindgen_test_layout_EmscriptenKeyboardEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).locale) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).locale) as usize - ptr as usize },
         160usize,
         concat!(
             "Offset of field: ",
@@ -1108,78 +1103,78 @@ fn bindgen_test_layout_EmscriptenKeyboardEvent() {
         )
     );
 }
-pub type em_key_callback_func = ::std::option::Option<
+pub type em_key_callback_func = ::core::option::Option<
     unsafe extern "C" fn(
-        eventType: ::std::os::raw::c_int,
+        eventType: ::core::ffi::c_int,
         keyEvent: *const EmscriptenKeyboardEvent,
-        userData: *mut ::std::os::raw::c_void,
-    ) -> ::std::os::raw::c_int,
+        userData: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int,
 >;
 extern "C" {
     pub fn emscripten_set_keypress_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_key_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_set_keydown_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_key_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_set_keyup_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_key_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
 pub struct EmscriptenMouseEvent {
     pub timestamp: f64,
-    pub screenX: ::std::os::raw::c_long,
-    pub screenY: ::std::os::raw::c_long,
-    pub clientX: ::std::os::raw::c_long,
-    pub clientY: ::std::os::raw::c_long,
-    pub ctrlKey: ::std::os::raw::c_int,
-    pub shiftKey: ::std::os::raw::c_int,
-    pub altKey: ::std::os::raw::c_int,
-    pub metaKey: ::std::os::raw::c_int,
-    pub button: ::std::os::raw::c_ushort,
-    pub buttons: ::std::os::raw::c_ushort,
-    pub movementX: ::std::os::raw::c_long,
-    pub movementY: ::std::os::raw::c_long,
-    pub targetX: ::std::os::raw::c_long,
-    pub targetY: ::std::os::raw::c_long,
-    pub canvasX: ::std::os::raw::c_long,
-    pub canvasY: ::std::os::raw::c_long,
-    pub padding: ::std::os::raw::c_long,
+    pub screenX: ::core::ffi::c_long,
+    pub screenY: ::core::ffi::c_long,
+    pub clientX: ::core::ffi::c_long,
+    pub clientY: ::core::ffi::c_long,
+    pub ctrlKey: ::core::ffi::c_int,
+    pub shiftKey: ::core::ffi::c_int,
+    pub altKey: ::core::ffi::c_int,
+    pub metaKey: ::core::ffi::c_int,
+    pub button: ::core::ffi::c_ushort,
+    pub buttons: ::core::ffi::c_ushort,
+    pub movementX: ::core::ffi::c_long,
+    pub movementY: ::core::ffi::c_long,
+    pub targetX: ::core::ffi::c_long,
+    pub targetY: ::core::ffi::c_long,
+    pub canvasX: ::core::ffi::c_long,
+    pub canvasY: ::core::ffi::c_long,
+    pub padding: ::core::ffi::c_long,
 }
 #[test]
 fn bindgen_test_layout_EmscriptenMouseEvent() {
-    const UNINIT: ::std::mem::MaybeUninit<EmscriptenMouseEvent> = ::std::mem::MaybeUninit::uninit();
+    const UNINIT: ::core::mem::MaybeUninit<EmscriptenMouseEvent> = ::core::mem::MaybeUninit::uninit();
     let ptr = UNINIT.as_ptr();
     assert_eq!(
-        ::std::mem::size_of::<EmscriptenMouseEvent>(),
+        ::core::mem::size_of::<EmscriptenMouseEvent>(),
         120usize,
         concat!("Size of: ", stringify!(EmscriptenMouseEvent))
     );
     assert_eq!(
-        ::std::mem::align_of::<EmscriptenMouseEvent>(),
+        ::core::mem::align_of::<EmscriptenMouseEvent>(),
         8usize,
         concat!("Alignment of ", stringify!(EmscriptenMouseEvent))
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).timestamp) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).timestamp) as usize - ptr as usize },
         0usize,
         concat!(
             "Offset of field: ",
@@ -1189,7 +1184,7 @@ fn bindgen_test_layout_EmscriptenMouseEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).screenX) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).screenX) as usize - ptr as usize },
         8usize,
         concat!(
             "Offset of field: ",
@@ -1199,7 +1194,7 @@ fn bindgen_test_layout_EmscriptenMouseEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).screenY) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).screenY) as usize - ptr as usize },
         16usize,
         concat!(
             "Offset of field: ",
@@ -1209,7 +1204,7 @@ fn bindgen_test_layout_EmscriptenMouseEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).clientX) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).clientX) as usize - ptr as usize },
         24usize,
         concat!(
             "Offset of field: ",
@@ -1219,7 +1214,7 @@ fn bindgen_test_layout_EmscriptenMouseEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).clientY) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).clientY) as usize - ptr as usize },
         32usize,
         concat!(
             "Offset of field: ",
@@ -1229,7 +1224,7 @@ fn bindgen_test_layout_EmscriptenMouseEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).ctrlKey) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).ctrlKey) as usize - ptr as usize },
         40usize,
         concat!(
             "Offset of field: ",
@@ -1239,7 +1234,7 @@ fn bindgen_test_layout_EmscriptenMouseEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).shiftKey) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).shiftKey) as usize - ptr as usize },
         44usize,
         concat!(
             "Offset of field: ",
@@ -1249,7 +1244,7 @@ fn bindgen_test_layout_EmscriptenMouseEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).altKey) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).altKey) as usize - ptr as usize },
         48usize,
         concat!(
             "Offset of field: ",
@@ -1259,7 +1254,7 @@ fn bindgen_test_layout_EmscriptenMouseEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).metaKey) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).metaKey) as usize - ptr as usize },
         52usize,
         concat!(
             "Offset of field: ",
@@ -1269,7 +1264,7 @@ fn bindgen_test_layout_EmscriptenMouseEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).button) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).button) as usize - ptr as usize },
         56usize,
         concat!(
             "Offset of field: ",
@@ -1279,7 +1274,7 @@ fn bindgen_test_layout_EmscriptenMouseEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).buttons) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).buttons) as usize - ptr as usize },
         58usize,
         concat!(
             "Offset of field: ",
@@ -1289,7 +1284,7 @@ fn bindgen_test_layout_EmscriptenMouseEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).movementX) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).movementX) as usize - ptr as usize },
         64usize,
         concat!(
             "Offset of field: ",
@@ -1299,7 +1294,7 @@ fn bindgen_test_layout_EmscriptenMouseEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).movementY) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).movementY) as usize - ptr as usize },
         72usize,
         concat!(
             "Offset of field: ",
@@ -1309,7 +1304,7 @@ fn bindgen_test_layout_EmscriptenMouseEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).targetX) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).targetX) as usize - ptr as usize },
         80usize,
         concat!(
             "Offset of field: ",
@@ -1319,7 +1314,7 @@ fn bindgen_test_layout_EmscriptenMouseEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).targetY) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).targetY) as usize - ptr as usize },
         88usize,
         concat!(
             "Offset of field: ",
@@ -1329,7 +1324,7 @@ fn bindgen_test_layout_EmscriptenMouseEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).canvasX) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).canvasX) as usize - ptr as usize },
         96usize,
         concat!(
             "Offset of field: ",
@@ -1339,7 +1334,7 @@ fn bindgen_test_layout_EmscriptenMouseEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).canvasY) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).canvasY) as usize - ptr as usize },
         104usize,
         concat!(
             "Offset of field: ",
@@ -1349,7 +1344,7 @@ fn bindgen_test_layout_EmscriptenMouseEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).padding) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).padding) as usize - ptr as usize },
         112usize,
         concat!(
             "Offset of field: ",
@@ -1359,98 +1354,98 @@ fn bindgen_test_layout_EmscriptenMouseEvent() {
         )
     );
 }
-pub type em_mouse_callback_func = ::std::option::Option<
+pub type em_mouse_callback_func = ::core::option::Option<
     unsafe extern "C" fn(
-        eventType: ::std::os::raw::c_int,
+        eventType: ::core::ffi::c_int,
         mouseEvent: *const EmscriptenMouseEvent,
-        userData: *mut ::std::os::raw::c_void,
-    ) -> ::std::os::raw::c_int,
+        userData: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int,
 >;
 extern "C" {
     pub fn emscripten_set_click_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_mouse_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_set_mousedown_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_mouse_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_set_mouseup_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_mouse_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_set_dblclick_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_mouse_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_set_mousemove_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_mouse_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_set_mouseenter_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_mouse_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_set_mouseleave_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_mouse_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_set_mouseover_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_mouse_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_set_mouseout_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_mouse_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_get_mouse_status(
         mouseState: *mut EmscriptenMouseEvent,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
@@ -1459,24 +1454,24 @@ pub struct EmscriptenWheelEvent {
     pub deltaX: f64,
     pub deltaY: f64,
     pub deltaZ: f64,
-    pub deltaMode: ::std::os::raw::c_ulong,
+    pub deltaMode: ::core::ffi::c_ulong,
 }
 #[test]
 fn bindgen_test_layout_EmscriptenWheelEvent() {
-    const UNINIT: ::std::mem::MaybeUninit<EmscriptenWheelEvent> = ::std::mem::MaybeUninit::uninit();
+    const UNINIT: ::core::mem::MaybeUninit<EmscriptenWheelEvent> = ::core::mem::MaybeUninit::uninit();
     let ptr = UNINIT.as_ptr();
     assert_eq!(
-        ::std::mem::size_of::<EmscriptenWheelEvent>(),
+        ::core::mem::size_of::<EmscriptenWheelEvent>(),
         152usize,
         concat!("Size of: ", stringify!(EmscriptenWheelEvent))
     );
     assert_eq!(
-        ::std::mem::align_of::<EmscriptenWheelEvent>(),
+        ::core::mem::align_of::<EmscriptenWheelEvent>(),
         8usize,
         concat!("Alignment of ", stringify!(EmscriptenWheelEvent))
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).mouse) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).mouse) as usize - ptr as usize },
         0usize,
         concat!(
             "Offset of field: ",
@@ -1486,7 +1481,7 @@ fn bindgen_test_layout_EmscriptenWheelEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).deltaX) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).deltaX) as usize - ptr as usize },
         120usize,
         concat!(
             "Offset of field: ",
@@ -1496,7 +1491,7 @@ fn bindgen_test_layout_EmscriptenWheelEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).deltaY) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).deltaY) as usize - ptr as usize },
         128usize,
         concat!(
             "Offset of field: ",
@@ -1506,7 +1501,7 @@ fn bindgen_test_layout_EmscriptenWheelEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).deltaZ) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).deltaZ) as usize - ptr as usize },
         136usize,
         concat!(
             "Offset of field: ",
@@ -1516,7 +1511,7 @@ fn bindgen_test_layout_EmscriptenWheelEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).deltaMode) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).deltaMode) as usize - ptr as usize },
         144usize,
         concat!(
             "Offset of field: ",
@@ -1526,51 +1521,51 @@ fn bindgen_test_layout_EmscriptenWheelEvent() {
         )
     );
 }
-pub type em_wheel_callback_func = ::std::option::Option<
+pub type em_wheel_callback_func = ::core::option::Option<
     unsafe extern "C" fn(
-        eventType: ::std::os::raw::c_int,
+        eventType: ::core::ffi::c_int,
         wheelEvent: *const EmscriptenWheelEvent,
-        userData: *mut ::std::os::raw::c_void,
-    ) -> ::std::os::raw::c_int,
+        userData: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int,
 >;
 extern "C" {
     pub fn emscripten_set_wheel_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_wheel_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
 pub struct EmscriptenUiEvent {
-    pub detail: ::std::os::raw::c_long,
-    pub documentBodyClientWidth: ::std::os::raw::c_int,
-    pub documentBodyClientHeight: ::std::os::raw::c_int,
-    pub windowInnerWidth: ::std::os::raw::c_int,
-    pub windowInnerHeight: ::std::os::raw::c_int,
-    pub windowOuterWidth: ::std::os::raw::c_int,
-    pub windowOuterHeight: ::std::os::raw::c_int,
-    pub scrollTop: ::std::os::raw::c_int,
-    pub scrollLeft: ::std::os::raw::c_int,
+    pub detail: ::core::ffi::c_long,
+    pub documentBodyClientWidth: ::core::ffi::c_int,
+    pub documentBodyClientHeight: ::core::ffi::c_int,
+    pub windowInnerWidth: ::core::ffi::c_int,
+    pub windowInnerHeight: ::core::ffi::c_int,
+    pub windowOuterWidth: ::core::ffi::c_int,
+    pub windowOuterHeight: ::core::ffi::c_int,
+    pub scrollTop: ::core::ffi::c_int,
+    pub scrollLeft: ::core::ffi::c_int,
 }
 #[test]
 fn bindgen_test_layout_EmscriptenUiEvent() {
-    const UNINIT: ::std::mem::MaybeUninit<EmscriptenUiEvent> = ::std::mem::MaybeUninit::uninit();
+    const UNINIT: ::core::mem::MaybeUninit<EmscriptenUiEvent> = ::core::mem::MaybeUninit::uninit();
     let ptr = UNINIT.as_ptr();
     assert_eq!(
-        ::std::mem::size_of::<EmscriptenUiEvent>(),
+        ::core::mem::size_of::<EmscriptenUiEvent>(),
         40usize,
         concat!("Size of: ", stringify!(EmscriptenUiEvent))
     );
     assert_eq!(
-        ::std::mem::align_of::<EmscriptenUiEvent>(),
+        ::core::mem::align_of::<EmscriptenUiEvent>(),
         8usize,
         concat!("Alignment of ", stringify!(EmscriptenUiEvent))
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).detail) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).detail) as usize - ptr as usize },
         0usize,
         concat!(
             "Offset of field: ",
@@ -1580,7 +1575,7 @@ fn bindgen_test_layout_EmscriptenUiEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).documentBodyClientWidth) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).documentBodyClientWidth) as usize - ptr as usize },
         8usize,
         concat!(
             "Offset of field: ",
@@ -1590,7 +1585,7 @@ fn bindgen_test_layout_EmscriptenUiEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).documentBodyClientHeight) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).documentBodyClientHeight) as usize - ptr as usize },
         12usize,
         concat!(
             "Offset of field: ",
@@ -1600,7 +1595,7 @@ fn bindgen_test_layout_EmscriptenUiEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).windowInnerWidth) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).windowInnerWidth) as usize - ptr as usize },
         16usize,
         concat!(
             "Offset of field: ",
@@ -1610,7 +1605,7 @@ fn bindgen_test_layout_EmscriptenUiEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).windowInnerHeight) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).windowInnerHeight) as usize - ptr as usize },
         20usize,
         concat!(
             "Offset of field: ",
@@ -1620,7 +1615,7 @@ fn bindgen_test_layout_EmscriptenUiEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).windowOuterWidth) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).windowOuterWidth) as usize - ptr as usize },
         24usize,
         concat!(
             "Offset of field: ",
@@ -1630,7 +1625,7 @@ fn bindgen_test_layout_EmscriptenUiEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).windowOuterHeight) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).windowOuterHeight) as usize - ptr as usize },
         28usize,
         concat!(
             "Offset of field: ",
@@ -1640,7 +1635,7 @@ fn bindgen_test_layout_EmscriptenUiEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).scrollTop) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).scrollTop) as usize - ptr as usize },
         32usize,
         concat!(
             "Offset of field: ",
@@ -1650,7 +1645,7 @@ fn bindgen_test_layout_EmscriptenUiEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).scrollLeft) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).scrollLeft) as usize - ptr as usize },
         36usize,
         concat!(
             "Offset of field: ",
@@ -1660,53 +1655,53 @@ fn bindgen_test_layout_EmscriptenUiEvent() {
         )
     );
 }
-pub type em_ui_callback_func = ::std::option::Option<
+pub type em_ui_callback_func = ::core::option::Option<
     unsafe extern "C" fn(
-        eventType: ::std::os::raw::c_int,
+        eventType: ::core::ffi::c_int,
         uiEvent: *const EmscriptenUiEvent,
-        userData: *mut ::std::os::raw::c_void,
-    ) -> ::std::os::raw::c_int,
+        userData: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int,
 >;
 extern "C" {
     pub fn emscripten_set_resize_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_ui_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_set_scroll_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_ui_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
 pub struct EmscriptenFocusEvent {
-    pub nodeName: [::std::os::raw::c_char; 128usize],
-    pub id: [::std::os::raw::c_char; 128usize],
+    pub nodeName: [::core::ffi::c_char; 128usize],
+    pub id: [::core::ffi::c_char; 128usize],
 }
 #[test]
 fn bindgen_test_layout_EmscriptenFocusEvent() {
-    const UNINIT: ::std::mem::MaybeUninit<EmscriptenFocusEvent> = ::std::mem::MaybeUninit::uninit();
+    const UNINIT: ::core::mem::MaybeUninit<EmscriptenFocusEvent> = ::core::mem::MaybeUninit::uninit();
     let ptr = UNINIT.as_ptr();
     assert_eq!(
-        ::std::mem::size_of::<EmscriptenFocusEvent>(),
+        ::core::mem::size_of::<EmscriptenFocusEvent>(),
         256usize,
         concat!("Size of: ", stringify!(EmscriptenFocusEvent))
     );
     assert_eq!(
-        ::std::mem::align_of::<EmscriptenFocusEvent>(),
+        ::core::mem::align_of::<EmscriptenFocusEvent>(),
         1usize,
         concat!("Alignment of ", stringify!(EmscriptenFocusEvent))
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).nodeName) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).nodeName) as usize - ptr as usize },
         0usize,
         concat!(
             "Offset of field: ",
@@ -1716,7 +1711,7 @@ fn bindgen_test_layout_EmscriptenFocusEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).id) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).id) as usize - ptr as usize },
         128usize,
         concat!(
             "Offset of field: ",
@@ -1726,48 +1721,48 @@ fn bindgen_test_layout_EmscriptenFocusEvent() {
         )
     );
 }
-pub type em_focus_callback_func = ::std::option::Option<
+pub type em_focus_callback_func = ::core::option::Option<
     unsafe extern "C" fn(
-        eventType: ::std::os::raw::c_int,
+        eventType: ::core::ffi::c_int,
         focusEvent: *const EmscriptenFocusEvent,
-        userData: *mut ::std::os::raw::c_void,
-    ) -> ::std::os::raw::c_int,
+        userData: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int,
 >;
 extern "C" {
     pub fn emscripten_set_blur_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_focus_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_set_focus_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_focus_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_set_focusin_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_focus_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_set_focusout_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_focus_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
@@ -1775,20 +1770,20 @@ pub struct EmscriptenDeviceOrientationEvent {
     pub alpha: f64,
     pub beta: f64,
     pub gamma: f64,
-    pub absolute: ::std::os::raw::c_int,
+    pub absolute: ::core::ffi::c_int,
 }
 #[test]
 fn bindgen_test_layout_EmscriptenDeviceOrientationEvent() {
-    const UNINIT: ::std::mem::MaybeUninit<EmscriptenDeviceOrientationEvent> =
-        ::std::mem::MaybeUninit::uninit();
+    const UNINIT: ::core::mem::MaybeUninit<EmscriptenDeviceOrientationEvent> =
+        ::core::mem::MaybeUninit::uninit();
     let ptr = UNINIT.as_ptr();
     assert_eq!(
-        ::std::mem::size_of::<EmscriptenDeviceOrientationEvent>(),
+        ::core::mem::size_of::<EmscriptenDeviceOrientationEvent>(),
         32usize,
         concat!("Size of: ", stringify!(EmscriptenDeviceOrientationEvent))
     );
     assert_eq!(
-        ::std::mem::align_of::<EmscriptenDeviceOrientationEvent>(),
+        ::core::mem::align_of::<EmscriptenDeviceOrientationEvent>(),
         8usize,
         concat!(
             "Alignment of ",
@@ -1796,7 +1791,7 @@ fn bindgen_test_layout_EmscriptenDeviceOrientationEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).alpha) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).alpha) as usize - ptr as usize },
         0usize,
         concat!(
             "Offset of field: ",
@@ -1806,7 +1801,7 @@ fn bindgen_test_layout_EmscriptenDeviceOrientationEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).beta) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).beta) as usize - ptr as usize },
         8usize,
         concat!(
             "Offset of field: ",
@@ -1816,7 +1811,7 @@ fn bindgen_test_layout_EmscriptenDeviceOrientationEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).gamma) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).gamma) as usize - ptr as usize },
         16usize,
         concat!(
             "Offset of field: ",
@@ -1826,7 +1821,7 @@ fn bindgen_test_layout_EmscriptenDeviceOrientationEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).absolute) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).absolute) as usize - ptr as usize },
         24usize,
         concat!(
             "Offset of field: ",
@@ -1836,25 +1831,25 @@ fn bindgen_test_layout_EmscriptenDeviceOrientationEvent() {
         )
     );
 }
-pub type em_deviceorientation_callback_func = ::std::option::Option<
+pub type em_deviceorientation_callback_func = ::core::option::Option<
     unsafe extern "C" fn(
-        eventType: ::std::os::raw::c_int,
+        eventType: ::core::ffi::c_int,
         deviceOrientationEvent: *const EmscriptenDeviceOrientationEvent,
-        userData: *mut ::std::os::raw::c_void,
-    ) -> ::std::os::raw::c_int,
+        userData: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int,
 >;
 extern "C" {
     pub fn emscripten_set_deviceorientation_callback_on_thread(
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_deviceorientation_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_get_deviceorientation_status(
         orientationState: *mut EmscriptenDeviceOrientationEvent,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
@@ -1868,25 +1863,25 @@ pub struct EmscriptenDeviceMotionEvent {
     pub rotationRateAlpha: f64,
     pub rotationRateBeta: f64,
     pub rotationRateGamma: f64,
-    pub supportedFields: ::std::os::raw::c_int,
+    pub supportedFields: ::core::ffi::c_int,
 }
 #[test]
 fn bindgen_test_layout_EmscriptenDeviceMotionEvent() {
-    const UNINIT: ::std::mem::MaybeUninit<EmscriptenDeviceMotionEvent> =
-        ::std::mem::MaybeUninit::uninit();
+    const UNINIT: ::core::mem::MaybeUninit<EmscriptenDeviceMotionEvent> =
+        ::core::mem::MaybeUninit::uninit();
     let ptr = UNINIT.as_ptr();
     assert_eq!(
-        ::std::mem::size_of::<EmscriptenDeviceMotionEvent>(),
+        ::core::mem::size_of::<EmscriptenDeviceMotionEvent>(),
         80usize,
         concat!("Size of: ", stringify!(EmscriptenDeviceMotionEvent))
     );
     assert_eq!(
-        ::std::mem::align_of::<EmscriptenDeviceMotionEvent>(),
+        ::core::mem::align_of::<EmscriptenDeviceMotionEvent>(),
         8usize,
         concat!("Alignment of ", stringify!(EmscriptenDeviceMotionEvent))
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).accelerationX) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).accelerationX) as usize - ptr as usize },
         0usize,
         concat!(
             "Offset of field: ",
@@ -1896,7 +1891,7 @@ fn bindgen_test_layout_EmscriptenDeviceMotionEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).accelerationY) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).accelerationY) as usize - ptr as usize },
         8usize,
         concat!(
             "Offset of field: ",
@@ -1906,7 +1901,7 @@ fn bindgen_test_layout_EmscriptenDeviceMotionEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).accelerationZ) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).accelerationZ) as usize - ptr as usize },
         16usize,
         concat!(
             "Offset of field: ",
@@ -1917,7 +1912,7 @@ fn bindgen_test_layout_EmscriptenDeviceMotionEvent() {
     );
     assert_eq!(
         unsafe {
-            ::std::ptr::addr_of!((*ptr).accelerationIncludingGravityX) as usize - ptr as usize
+            ::core::ptr::addr_of!((*ptr).accelerationIncludingGravityX) as usize - ptr as usize
         },
         24usize,
         concat!(
@@ -1929,7 +1924,7 @@ fn bindgen_test_layout_EmscriptenDeviceMotionEvent() {
     );
     assert_eq!(
         unsafe {
-            ::std::ptr::addr_of!((*ptr).accelerationIncludingGravityY) as usize - ptr as usize
+            ::core::ptr::addr_of!((*ptr).accelerationIncludingGravityY) as usize - ptr as usize
         },
         32usize,
         concat!(
@@ -1941,7 +1936,7 @@ fn bindgen_test_layout_EmscriptenDeviceMotionEvent() {
     );
     assert_eq!(
         unsafe {
-            ::std::ptr::addr_of!((*ptr).accelerationIncludingGravityZ) as usize - ptr as usize
+            ::core::ptr::addr_of!((*ptr).accelerationIncludingGravityZ) as usize - ptr as usize
         },
         40usize,
         concat!(
@@ -1952,7 +1947,7 @@ fn bindgen_test_layout_EmscriptenDeviceMotionEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).rotationRateAlpha) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).rotationRateAlpha) as usize - ptr as usize },
         48usize,
         concat!(
             "Offset of field: ",
@@ -1962,7 +1957,7 @@ fn bindgen_test_layout_EmscriptenDeviceMotionEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).rotationRateBeta) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).rotationRateBeta) as usize - ptr as usize },
         56usize,
         concat!(
             "Offset of field: ",
@@ -1972,7 +1967,7 @@ fn bindgen_test_layout_EmscriptenDeviceMotionEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).rotationRateGamma) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).rotationRateGamma) as usize - ptr as usize },
         64usize,
         concat!(
             "Offset of field: ",
@@ -1982,7 +1977,7 @@ fn bindgen_test_layout_EmscriptenDeviceMotionEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).supportedFields) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).supportedFields) as usize - ptr as usize },
         72usize,
         concat!(
             "Offset of field: ",
@@ -1992,44 +1987,44 @@ fn bindgen_test_layout_EmscriptenDeviceMotionEvent() {
         )
     );
 }
-pub type em_devicemotion_callback_func = ::std::option::Option<
+pub type em_devicemotion_callback_func = ::core::option::Option<
     unsafe extern "C" fn(
-        eventType: ::std::os::raw::c_int,
+        eventType: ::core::ffi::c_int,
         deviceMotionEvent: *const EmscriptenDeviceMotionEvent,
-        userData: *mut ::std::os::raw::c_void,
-    ) -> ::std::os::raw::c_int,
+        userData: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int,
 >;
 extern "C" {
     pub fn emscripten_set_devicemotion_callback_on_thread(
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_devicemotion_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_get_devicemotion_status(
         motionState: *mut EmscriptenDeviceMotionEvent,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
 pub struct EmscriptenOrientationChangeEvent {
-    pub orientationIndex: ::std::os::raw::c_int,
-    pub orientationAngle: ::std::os::raw::c_int,
+    pub orientationIndex: ::core::ffi::c_int,
+    pub orientationAngle: ::core::ffi::c_int,
 }
 #[test]
 fn bindgen_test_layout_EmscriptenOrientationChangeEvent() {
-    const UNINIT: ::std::mem::MaybeUninit<EmscriptenOrientationChangeEvent> =
-        ::std::mem::MaybeUninit::uninit();
+    const UNINIT: ::core::mem::MaybeUninit<EmscriptenOrientationChangeEvent> =
+        ::core::mem::MaybeUninit::uninit();
     let ptr = UNINIT.as_ptr();
     assert_eq!(
-        ::std::mem::size_of::<EmscriptenOrientationChangeEvent>(),
+        ::core::mem::size_of::<EmscriptenOrientationChangeEvent>(),
         8usize,
         concat!("Size of: ", stringify!(EmscriptenOrientationChangeEvent))
     );
     assert_eq!(
-        ::std::mem::align_of::<EmscriptenOrientationChangeEvent>(),
+        ::core::mem::align_of::<EmscriptenOrientationChangeEvent>(),
         4usize,
         concat!(
             "Alignment of ",
@@ -2037,7 +2032,7 @@ fn bindgen_test_layout_EmscriptenOrientationChangeEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).orientationIndex) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).orientationIndex) as usize - ptr as usize },
         0usize,
         concat!(
             "Offset of field: ",
@@ -2047,7 +2042,7 @@ fn bindgen_test_layout_EmscriptenOrientationChangeEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).orientationAngle) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).orientationAngle) as usize - ptr as usize },
         4usize,
         concat!(
             "Offset of field: ",
@@ -2057,63 +2052,63 @@ fn bindgen_test_layout_EmscriptenOrientationChangeEvent() {
         )
     );
 }
-pub type em_orientationchange_callback_func = ::std::option::Option<
+pub type em_orientationchange_callback_func = ::core::option::Option<
     unsafe extern "C" fn(
-        eventType: ::std::os::raw::c_int,
+        eventType: ::core::ffi::c_int,
         orientationChangeEvent: *const EmscriptenOrientationChangeEvent,
-        userData: *mut ::std::os::raw::c_void,
-    ) -> ::std::os::raw::c_int,
+        userData: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int,
 >;
 extern "C" {
     pub fn emscripten_set_orientationchange_callback_on_thread(
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_orientationchange_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_get_orientation_status(
         orientationStatus: *mut EmscriptenOrientationChangeEvent,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_lock_orientation(
-        allowedOrientations: ::std::os::raw::c_int,
-    ) -> ::std::os::raw::c_int;
+        allowedOrientations: ::core::ffi::c_int,
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
-    pub fn emscripten_unlock_orientation() -> ::std::os::raw::c_int;
+    pub fn emscripten_unlock_orientation() -> ::core::ffi::c_int;
 }
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
 pub struct EmscriptenFullscreenChangeEvent {
-    pub isFullscreen: ::std::os::raw::c_int,
-    pub fullscreenEnabled: ::std::os::raw::c_int,
-    pub nodeName: [::std::os::raw::c_char; 128usize],
-    pub id: [::std::os::raw::c_char; 128usize],
-    pub elementWidth: ::std::os::raw::c_int,
-    pub elementHeight: ::std::os::raw::c_int,
-    pub screenWidth: ::std::os::raw::c_int,
-    pub screenHeight: ::std::os::raw::c_int,
+    pub isFullscreen: ::core::ffi::c_int,
+    pub fullscreenEnabled: ::core::ffi::c_int,
+    pub nodeName: [::core::ffi::c_char; 128usize],
+    pub id: [::core::ffi::c_char; 128usize],
+    pub elementWidth: ::core::ffi::c_int,
+    pub elementHeight: ::core::ffi::c_int,
+    pub screenWidth: ::core::ffi::c_int,
+    pub screenHeight: ::core::ffi::c_int,
 }
 #[test]
 fn bindgen_test_layout_EmscriptenFullscreenChangeEvent() {
-    const UNINIT: ::std::mem::MaybeUninit<EmscriptenFullscreenChangeEvent> =
-        ::std::mem::MaybeUninit::uninit();
+    const UNINIT: ::core::mem::MaybeUninit<EmscriptenFullscreenChangeEvent> =
+        ::core::mem::MaybeUninit::uninit();
     let ptr = UNINIT.as_ptr();
     assert_eq!(
-        ::std::mem::size_of::<EmscriptenFullscreenChangeEvent>(),
+        ::core::mem::size_of::<EmscriptenFullscreenChangeEvent>(),
         280usize,
         concat!("Size of: ", stringify!(EmscriptenFullscreenChangeEvent))
     );
     assert_eq!(
-        ::std::mem::align_of::<EmscriptenFullscreenChangeEvent>(),
+        ::core::mem::align_of::<EmscriptenFullscreenChangeEvent>(),
         4usize,
         concat!("Alignment of ", stringify!(EmscriptenFullscreenChangeEvent))
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).isFullscreen) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).isFullscreen) as usize - ptr as usize },
         0usize,
         concat!(
             "Offset of field: ",
@@ -2123,7 +2118,7 @@ fn bindgen_test_layout_EmscriptenFullscreenChangeEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).fullscreenEnabled) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).fullscreenEnabled) as usize - ptr as usize },
         4usize,
         concat!(
             "Offset of field: ",
@@ -2133,7 +2128,7 @@ fn bindgen_test_layout_EmscriptenFullscreenChangeEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).nodeName) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).nodeName) as usize - ptr as usize },
         8usize,
         concat!(
             "Offset of field: ",
@@ -2143,7 +2138,7 @@ fn bindgen_test_layout_EmscriptenFullscreenChangeEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).id) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).id) as usize - ptr as usize },
         136usize,
         concat!(
             "Offset of field: ",
@@ -2153,7 +2148,7 @@ fn bindgen_test_layout_EmscriptenFullscreenChangeEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).elementWidth) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).elementWidth) as usize - ptr as usize },
         264usize,
         concat!(
             "Offset of field: ",
@@ -2163,7 +2158,7 @@ fn bindgen_test_layout_EmscriptenFullscreenChangeEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).elementHeight) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).elementHeight) as usize - ptr as usize },
         268usize,
         concat!(
             "Offset of field: ",
@@ -2173,7 +2168,7 @@ fn bindgen_test_layout_EmscriptenFullscreenChangeEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).screenWidth) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).screenWidth) as usize - ptr as usize },
         272usize,
         concat!(
             "Offset of field: ",
@@ -2183,7 +2178,7 @@ fn bindgen_test_layout_EmscriptenFullscreenChangeEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).screenHeight) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).screenHeight) as usize - ptr as usize },
         276usize,
         concat!(
             "Offset of field: ",
@@ -2193,61 +2188,61 @@ fn bindgen_test_layout_EmscriptenFullscreenChangeEvent() {
         )
     );
 }
-pub type em_fullscreenchange_callback_func = ::std::option::Option<
+pub type em_fullscreenchange_callback_func = ::core::option::Option<
     unsafe extern "C" fn(
-        eventType: ::std::os::raw::c_int,
+        eventType: ::core::ffi::c_int,
         fullscreenChangeEvent: *const EmscriptenFullscreenChangeEvent,
-        userData: *mut ::std::os::raw::c_void,
-    ) -> ::std::os::raw::c_int,
+        userData: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int,
 >;
 extern "C" {
     pub fn emscripten_set_fullscreenchange_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_fullscreenchange_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_get_fullscreen_status(
         fullscreenStatus: *mut EmscriptenFullscreenChangeEvent,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
-pub type em_canvasresized_callback_func = ::std::option::Option<
+pub type em_canvasresized_callback_func = ::core::option::Option<
     unsafe extern "C" fn(
-        eventType: ::std::os::raw::c_int,
-        reserved: *const ::std::os::raw::c_void,
-        userData: *mut ::std::os::raw::c_void,
-    ) -> ::std::os::raw::c_int,
+        eventType: ::core::ffi::c_int,
+        reserved: *const ::core::ffi::c_void,
+        userData: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int,
 >;
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
 pub struct EmscriptenFullscreenStrategy {
-    pub scaleMode: ::std::os::raw::c_int,
-    pub canvasResolutionScaleMode: ::std::os::raw::c_int,
-    pub filteringMode: ::std::os::raw::c_int,
+    pub scaleMode: ::core::ffi::c_int,
+    pub canvasResolutionScaleMode: ::core::ffi::c_int,
+    pub filteringMode: ::core::ffi::c_int,
     pub canvasResizedCallback: em_canvasresized_callback_func,
-    pub canvasResizedCallbackUserData: *mut ::std::os::raw::c_void,
+    pub canvasResizedCallbackUserData: *mut ::core::ffi::c_void,
     pub canvasResizedCallbackTargetThread: pthread_t,
 }
 #[test]
 fn bindgen_test_layout_EmscriptenFullscreenStrategy() {
-    const UNINIT: ::std::mem::MaybeUninit<EmscriptenFullscreenStrategy> =
-        ::std::mem::MaybeUninit::uninit();
+    const UNINIT: ::core::mem::MaybeUninit<EmscriptenFullscreenStrategy> =
+        ::core::mem::MaybeUninit::uninit();
     let ptr = UNINIT.as_ptr();
     assert_eq!(
-        ::std::mem::size_of::<EmscriptenFullscreenStrategy>(),
+        ::core::mem::size_of::<EmscriptenFullscreenStrategy>(),
         40usize,
         concat!("Size of: ", stringify!(EmscriptenFullscreenStrategy))
     );
     assert_eq!(
-        ::std::mem::align_of::<EmscriptenFullscreenStrategy>(),
+        ::core::mem::align_of::<EmscriptenFullscreenStrategy>(),
         8usize,
         concat!("Alignment of ", stringify!(EmscriptenFullscreenStrategy))
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).scaleMode) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).scaleMode) as usize - ptr as usize },
         0usize,
         concat!(
             "Offset of field: ",
@@ -2257,7 +2252,7 @@ fn bindgen_test_layout_EmscriptenFullscreenStrategy() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).canvasResolutionScaleMode) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).canvasResolutionScaleMode) as usize - ptr as usize },
         4usize,
         concat!(
             "Offset of field: ",
@@ -2267,7 +2262,7 @@ fn bindgen_test_layout_EmscriptenFullscreenStrategy() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).filteringMode) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).filteringMode) as usize - ptr as usize },
         8usize,
         concat!(
             "Offset of field: ",
@@ -2277,7 +2272,7 @@ fn bindgen_test_layout_EmscriptenFullscreenStrategy() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).canvasResizedCallback) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).canvasResizedCallback) as usize - ptr as usize },
         16usize,
         concat!(
             "Offset of field: ",
@@ -2288,7 +2283,7 @@ fn bindgen_test_layout_EmscriptenFullscreenStrategy() {
     );
     assert_eq!(
         unsafe {
-            ::std::ptr::addr_of!((*ptr).canvasResizedCallbackUserData) as usize - ptr as usize
+            ::core::ptr::addr_of!((*ptr).canvasResizedCallbackUserData) as usize - ptr as usize
         },
         24usize,
         concat!(
@@ -2300,7 +2295,7 @@ fn bindgen_test_layout_EmscriptenFullscreenStrategy() {
     );
     assert_eq!(
         unsafe {
-            ::std::ptr::addr_of!((*ptr).canvasResizedCallbackTargetThread) as usize - ptr as usize
+            ::core::ptr::addr_of!((*ptr).canvasResizedCallbackTargetThread) as usize - ptr as usize
         },
         32usize,
         concat!(
@@ -2313,48 +2308,48 @@ fn bindgen_test_layout_EmscriptenFullscreenStrategy() {
 }
 extern "C" {
     pub fn emscripten_request_fullscreen(
-        target: *const ::std::os::raw::c_char,
-        deferUntilInEventHandler: ::std::os::raw::c_int,
-    ) -> ::std::os::raw::c_int;
+        target: *const ::core::ffi::c_char,
+        deferUntilInEventHandler: ::core::ffi::c_int,
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_request_fullscreen_strategy(
-        target: *const ::std::os::raw::c_char,
-        deferUntilInEventHandler: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        deferUntilInEventHandler: ::core::ffi::c_int,
         fullscreenStrategy: *const EmscriptenFullscreenStrategy,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
-    pub fn emscripten_exit_fullscreen() -> ::std::os::raw::c_int;
+    pub fn emscripten_exit_fullscreen() -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_enter_soft_fullscreen(
-        target: *const ::std::os::raw::c_char,
+        target: *const ::core::ffi::c_char,
         fullscreenStrategy: *const EmscriptenFullscreenStrategy,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
-    pub fn emscripten_exit_soft_fullscreen() -> ::std::os::raw::c_int;
+    pub fn emscripten_exit_soft_fullscreen() -> ::core::ffi::c_int;
 }
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
 pub struct EmscriptenPointerlockChangeEvent {
-    pub isActive: ::std::os::raw::c_int,
-    pub nodeName: [::std::os::raw::c_char; 128usize],
-    pub id: [::std::os::raw::c_char; 128usize],
+    pub isActive: ::core::ffi::c_int,
+    pub nodeName: [::core::ffi::c_char; 128usize],
+    pub id: [::core::ffi::c_char; 128usize],
 }
 #[test]
 fn bindgen_test_layout_EmscriptenPointerlockChangeEvent() {
-    const UNINIT: ::std::mem::MaybeUninit<EmscriptenPointerlockChangeEvent> =
-        ::std::mem::MaybeUninit::uninit();
+    const UNINIT: ::core::mem::MaybeUninit<EmscriptenPointerlockChangeEvent> =
+        ::core::mem::MaybeUninit::uninit();
     let ptr = UNINIT.as_ptr();
     assert_eq!(
-        ::std::mem::size_of::<EmscriptenPointerlockChangeEvent>(),
+        ::core::mem::size_of::<EmscriptenPointerlockChangeEvent>(),
         260usize,
         concat!("Size of: ", stringify!(EmscriptenPointerlockChangeEvent))
     );
     assert_eq!(
-        ::std::mem::align_of::<EmscriptenPointerlockChangeEvent>(),
+        ::core::mem::align_of::<EmscriptenPointerlockChangeEvent>(),
         4usize,
         concat!(
             "Alignment of ",
@@ -2362,7 +2357,7 @@ fn bindgen_test_layout_EmscriptenPointerlockChangeEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).isActive) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).isActive) as usize - ptr as usize },
         0usize,
         concat!(
             "Offset of field: ",
@@ -2372,7 +2367,7 @@ fn bindgen_test_layout_EmscriptenPointerlockChangeEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).nodeName) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).nodeName) as usize - ptr as usize },
         4usize,
         concat!(
             "Offset of field: ",
@@ -2382,7 +2377,7 @@ fn bindgen_test_layout_EmscriptenPointerlockChangeEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).id) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).id) as usize - ptr as usize },
         132usize,
         concat!(
             "Offset of field: ",
@@ -2392,75 +2387,75 @@ fn bindgen_test_layout_EmscriptenPointerlockChangeEvent() {
         )
     );
 }
-pub type em_pointerlockchange_callback_func = ::std::option::Option<
+pub type em_pointerlockchange_callback_func = ::core::option::Option<
     unsafe extern "C" fn(
-        eventType: ::std::os::raw::c_int,
+        eventType: ::core::ffi::c_int,
         pointerlockChangeEvent: *const EmscriptenPointerlockChangeEvent,
-        userData: *mut ::std::os::raw::c_void,
-    ) -> ::std::os::raw::c_int,
+        userData: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int,
 >;
 extern "C" {
     pub fn emscripten_set_pointerlockchange_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_pointerlockchange_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
-pub type em_pointerlockerror_callback_func = ::std::option::Option<
+pub type em_pointerlockerror_callback_func = ::core::option::Option<
     unsafe extern "C" fn(
-        eventType: ::std::os::raw::c_int,
-        reserved: *const ::std::os::raw::c_void,
-        userData: *mut ::std::os::raw::c_void,
-    ) -> ::std::os::raw::c_int,
+        eventType: ::core::ffi::c_int,
+        reserved: *const ::core::ffi::c_void,
+        userData: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int,
 >;
 extern "C" {
     pub fn emscripten_set_pointerlockerror_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_pointerlockerror_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_get_pointerlock_status(
         pointerlockStatus: *mut EmscriptenPointerlockChangeEvent,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_request_pointerlock(
-        target: *const ::std::os::raw::c_char,
-        deferUntilInEventHandler: ::std::os::raw::c_int,
-    ) -> ::std::os::raw::c_int;
+        target: *const ::core::ffi::c_char,
+        deferUntilInEventHandler: ::core::ffi::c_int,
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
-    pub fn emscripten_exit_pointerlock() -> ::std::os::raw::c_int;
+    pub fn emscripten_exit_pointerlock() -> ::core::ffi::c_int;
 }
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
 pub struct EmscriptenVisibilityChangeEvent {
-    pub hidden: ::std::os::raw::c_int,
-    pub visibilityState: ::std::os::raw::c_int,
+    pub hidden: ::core::ffi::c_int,
+    pub visibilityState: ::core::ffi::c_int,
 }
 #[test]
 fn bindgen_test_layout_EmscriptenVisibilityChangeEvent() {
-    const UNINIT: ::std::mem::MaybeUninit<EmscriptenVisibilityChangeEvent> =
-        ::std::mem::MaybeUninit::uninit();
+    const UNINIT: ::core::mem::MaybeUninit<EmscriptenVisibilityChangeEvent> =
+        ::core::mem::MaybeUninit::uninit();
     let ptr = UNINIT.as_ptr();
     assert_eq!(
-        ::std::mem::size_of::<EmscriptenVisibilityChangeEvent>(),
+        ::core::mem::size_of::<EmscriptenVisibilityChangeEvent>(),
         8usize,
         concat!("Size of: ", stringify!(EmscriptenVisibilityChangeEvent))
     );
     assert_eq!(
-        ::std::mem::align_of::<EmscriptenVisibilityChangeEvent>(),
+        ::core::mem::align_of::<EmscriptenVisibilityChangeEvent>(),
         4usize,
         concat!("Alignment of ", stringify!(EmscriptenVisibilityChangeEvent))
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).hidden) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).hidden) as usize - ptr as usize },
         0usize,
         concat!(
             "Offset of field: ",
@@ -2470,7 +2465,7 @@ fn bindgen_test_layout_EmscriptenVisibilityChangeEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).visibilityState) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).visibilityState) as usize - ptr as usize },
         4usize,
         concat!(
             "Offset of field: ",
@@ -2480,59 +2475,59 @@ fn bindgen_test_layout_EmscriptenVisibilityChangeEvent() {
         )
     );
 }
-pub type em_visibilitychange_callback_func = ::std::option::Option<
+pub type em_visibilitychange_callback_func = ::core::option::Option<
     unsafe extern "C" fn(
-        eventType: ::std::os::raw::c_int,
+        eventType: ::core::ffi::c_int,
         visibilityChangeEvent: *const EmscriptenVisibilityChangeEvent,
-        userData: *mut ::std::os::raw::c_void,
-    ) -> ::std::os::raw::c_int,
+        userData: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int,
 >;
 extern "C" {
     pub fn emscripten_set_visibilitychange_callback_on_thread(
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_visibilitychange_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_get_visibility_status(
         visibilityStatus: *mut EmscriptenVisibilityChangeEvent,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
 pub struct EmscriptenTouchPoint {
-    pub identifier: ::std::os::raw::c_long,
-    pub screenX: ::std::os::raw::c_long,
-    pub screenY: ::std::os::raw::c_long,
-    pub clientX: ::std::os::raw::c_long,
-    pub clientY: ::std::os::raw::c_long,
-    pub pageX: ::std::os::raw::c_long,
-    pub pageY: ::std::os::raw::c_long,
-    pub isChanged: ::std::os::raw::c_int,
-    pub onTarget: ::std::os::raw::c_int,
-    pub targetX: ::std::os::raw::c_long,
-    pub targetY: ::std::os::raw::c_long,
-    pub canvasX: ::std::os::raw::c_long,
-    pub canvasY: ::std::os::raw::c_long,
+    pub identifier: ::core::ffi::c_long,
+    pub screenX: ::core::ffi::c_long,
+    pub screenY: ::core::ffi::c_long,
+    pub clientX: ::core::ffi::c_long,
+    pub clientY: ::core::ffi::c_long,
+    pub pageX: ::core::ffi::c_long,
+    pub pageY: ::core::ffi::c_long,
+    pub isChanged: ::core::ffi::c_int,
+    pub onTarget: ::core::ffi::c_int,
+    pub targetX: ::core::ffi::c_long,
+    pub targetY: ::core::ffi::c_long,
+    pub canvasX: ::core::ffi::c_long,
+    pub canvasY: ::core::ffi::c_long,
 }
 #[test]
 fn bindgen_test_layout_EmscriptenTouchPoint() {
-    const UNINIT: ::std::mem::MaybeUninit<EmscriptenTouchPoint> = ::std::mem::MaybeUninit::uninit();
+    const UNINIT: ::core::mem::MaybeUninit<EmscriptenTouchPoint> = ::core::mem::MaybeUninit::uninit();
     let ptr = UNINIT.as_ptr();
     assert_eq!(
-        ::std::mem::size_of::<EmscriptenTouchPoint>(),
+        ::core::mem::size_of::<EmscriptenTouchPoint>(),
         96usize,
         concat!("Size of: ", stringify!(EmscriptenTouchPoint))
     );
     assert_eq!(
-        ::std::mem::align_of::<EmscriptenTouchPoint>(),
+        ::core::mem::align_of::<EmscriptenTouchPoint>(),
         8usize,
         concat!("Alignment of ", stringify!(EmscriptenTouchPoint))
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).identifier) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).identifier) as usize - ptr as usize },
         0usize,
         concat!(
             "Offset of field: ",
@@ -2542,7 +2537,7 @@ fn bindgen_test_layout_EmscriptenTouchPoint() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).screenX) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).screenX) as usize - ptr as usize },
         8usize,
         concat!(
             "Offset of field: ",
@@ -2552,7 +2547,7 @@ fn bindgen_test_layout_EmscriptenTouchPoint() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).screenY) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).screenY) as usize - ptr as usize },
         16usize,
         concat!(
             "Offset of field: ",
@@ -2562,7 +2557,7 @@ fn bindgen_test_layout_EmscriptenTouchPoint() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).clientX) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).clientX) as usize - ptr as usize },
         24usize,
         concat!(
             "Offset of field: ",
@@ -2572,7 +2567,7 @@ fn bindgen_test_layout_EmscriptenTouchPoint() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).clientY) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).clientY) as usize - ptr as usize },
         32usize,
         concat!(
             "Offset of field: ",
@@ -2582,7 +2577,7 @@ fn bindgen_test_layout_EmscriptenTouchPoint() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).pageX) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).pageX) as usize - ptr as usize },
         40usize,
         concat!(
             "Offset of field: ",
@@ -2592,7 +2587,7 @@ fn bindgen_test_layout_EmscriptenTouchPoint() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).pageY) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).pageY) as usize - ptr as usize },
         48usize,
         concat!(
             "Offset of field: ",
@@ -2602,7 +2597,7 @@ fn bindgen_test_layout_EmscriptenTouchPoint() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).isChanged) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).isChanged) as usize - ptr as usize },
         56usize,
         concat!(
             "Offset of field: ",
@@ -2612,7 +2607,7 @@ fn bindgen_test_layout_EmscriptenTouchPoint() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).onTarget) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).onTarget) as usize - ptr as usize },
         60usize,
         concat!(
             "Offset of field: ",
@@ -2622,7 +2617,7 @@ fn bindgen_test_layout_EmscriptenTouchPoint() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).targetX) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).targetX) as usize - ptr as usize },
         64usize,
         concat!(
             "Offset of field: ",
@@ -2632,7 +2627,7 @@ fn bindgen_test_layout_EmscriptenTouchPoint() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).targetY) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).targetY) as usize - ptr as usize },
         72usize,
         concat!(
             "Offset of field: ",
@@ -2642,7 +2637,7 @@ fn bindgen_test_layout_EmscriptenTouchPoint() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).canvasX) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).canvasX) as usize - ptr as usize },
         80usize,
         concat!(
             "Offset of field: ",
@@ -2652,7 +2647,7 @@ fn bindgen_test_layout_EmscriptenTouchPoint() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).canvasY) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).canvasY) as usize - ptr as usize },
         88usize,
         concat!(
             "Offset of field: ",
@@ -2666,29 +2661,29 @@ fn bindgen_test_layout_EmscriptenTouchPoint() {
 #[derive(Debug, Copy, Clone)]
 pub struct EmscriptenTouchEvent {
     pub timestamp: f64,
-    pub numTouches: ::std::os::raw::c_int,
-    pub ctrlKey: ::std::os::raw::c_int,
-    pub shiftKey: ::std::os::raw::c_int,
-    pub altKey: ::std::os::raw::c_int,
-    pub metaKey: ::std::os::raw::c_int,
+    pub numTouches: ::core::ffi::c_int,
+    pub ctrlKey: ::core::ffi::c_int,
+    pub shiftKey: ::core::ffi::c_int,
+    pub altKey: ::core::ffi::c_int,
+    pub metaKey: ::core::ffi::c_int,
     pub touches: [EmscriptenTouchPoint; 32usize],
 }
 #[test]
 fn bindgen_test_layout_EmscriptenTouchEvent() {
-    const UNINIT: ::std::mem::MaybeUninit<EmscriptenTouchEvent> = ::std::mem::MaybeUninit::uninit();
+    const UNINIT: ::core::mem::MaybeUninit<EmscriptenTouchEvent> = ::core::mem::MaybeUninit::uninit();
     let ptr = UNINIT.as_ptr();
     assert_eq!(
-        ::std::mem::size_of::<EmscriptenTouchEvent>(),
+        ::core::mem::size_of::<EmscriptenTouchEvent>(),
         3104usize,
         concat!("Size of: ", stringify!(EmscriptenTouchEvent))
     );
     assert_eq!(
-        ::std::mem::align_of::<EmscriptenTouchEvent>(),
+        ::core::mem::align_of::<EmscriptenTouchEvent>(),
         8usize,
         concat!("Alignment of ", stringify!(EmscriptenTouchEvent))
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).timestamp) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).timestamp) as usize - ptr as usize },
         0usize,
         concat!(
             "Offset of field: ",
@@ -2698,7 +2693,7 @@ fn bindgen_test_layout_EmscriptenTouchEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).numTouches) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).numTouches) as usize - ptr as usize },
         8usize,
         concat!(
             "Offset of field: ",
@@ -2708,7 +2703,7 @@ fn bindgen_test_layout_EmscriptenTouchEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).ctrlKey) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).ctrlKey) as usize - ptr as usize },
         12usize,
         concat!(
             "Offset of field: ",
@@ -2718,7 +2713,7 @@ fn bindgen_test_layout_EmscriptenTouchEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).shiftKey) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).shiftKey) as usize - ptr as usize },
         16usize,
         concat!(
             "Offset of field: ",
@@ -2728,7 +2723,7 @@ fn bindgen_test_layout_EmscriptenTouchEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).altKey) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).altKey) as usize - ptr as usize },
         20usize,
         concat!(
             "Offset of field: ",
@@ -2738,7 +2733,7 @@ fn bindgen_test_layout_EmscriptenTouchEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).metaKey) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).metaKey) as usize - ptr as usize },
         24usize,
         concat!(
             "Offset of field: ",
@@ -2748,7 +2743,7 @@ fn bindgen_test_layout_EmscriptenTouchEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).touches) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).touches) as usize - ptr as usize },
         32usize,
         concat!(
             "Offset of field: ",
@@ -2758,80 +2753,80 @@ fn bindgen_test_layout_EmscriptenTouchEvent() {
         )
     );
 }
-pub type em_touch_callback_func = ::std::option::Option<
+pub type em_touch_callback_func = ::core::option::Option<
     unsafe extern "C" fn(
-        eventType: ::std::os::raw::c_int,
+        eventType: ::core::ffi::c_int,
         touchEvent: *const EmscriptenTouchEvent,
-        userData: *mut ::std::os::raw::c_void,
-    ) -> ::std::os::raw::c_int,
+        userData: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int,
 >;
 extern "C" {
     pub fn emscripten_set_touchstart_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_touch_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_set_touchend_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_touch_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_set_touchmove_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_touch_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_set_touchcancel_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_touch_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
 pub struct EmscriptenGamepadEvent {
     pub timestamp: f64,
-    pub numAxes: ::std::os::raw::c_int,
-    pub numButtons: ::std::os::raw::c_int,
+    pub numAxes: ::core::ffi::c_int,
+    pub numButtons: ::core::ffi::c_int,
     pub axis: [f64; 64usize],
     pub analogButton: [f64; 64usize],
-    pub digitalButton: [::std::os::raw::c_int; 64usize],
-    pub connected: ::std::os::raw::c_int,
-    pub index: ::std::os::raw::c_long,
-    pub id: [::std::os::raw::c_char; 64usize],
-    pub mapping: [::std::os::raw::c_char; 64usize],
+    pub digitalButton: [::core::ffi::c_int; 64usize],
+    pub connected: ::core::ffi::c_int,
+    pub index: ::core::ffi::c_long,
+    pub id: [::core::ffi::c_char; 64usize],
+    pub mapping: [::core::ffi::c_char; 64usize],
 }
 #[test]
 fn bindgen_test_layout_EmscriptenGamepadEvent() {
-    const UNINIT: ::std::mem::MaybeUninit<EmscriptenGamepadEvent> =
-        ::std::mem::MaybeUninit::uninit();
+    const UNINIT: ::core::mem::MaybeUninit<EmscriptenGamepadEvent> =
+        ::core::mem::MaybeUninit::uninit();
     let ptr = UNINIT.as_ptr();
     assert_eq!(
-        ::std::mem::size_of::<EmscriptenGamepadEvent>(),
+        ::core::mem::size_of::<EmscriptenGamepadEvent>(),
         1440usize,
         concat!("Size of: ", stringify!(EmscriptenGamepadEvent))
     );
     assert_eq!(
-        ::std::mem::align_of::<EmscriptenGamepadEvent>(),
+        ::core::mem::align_of::<EmscriptenGamepadEvent>(),
         8usize,
         concat!("Alignment of ", stringify!(EmscriptenGamepadEvent))
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).timestamp) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).timestamp) as usize - ptr as usize },
         0usize,
         concat!(
             "Offset of field: ",
@@ -2841,7 +2836,7 @@ fn bindgen_test_layout_EmscriptenGamepadEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).numAxes) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).numAxes) as usize - ptr as usize },
         8usize,
         concat!(
             "Offset of field: ",
@@ -2851,7 +2846,7 @@ fn bindgen_test_layout_EmscriptenGamepadEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).numButtons) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).numButtons) as usize - ptr as usize },
         12usize,
         concat!(
             "Offset of field: ",
@@ -2861,7 +2856,7 @@ fn bindgen_test_layout_EmscriptenGamepadEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).axis) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).axis) as usize - ptr as usize },
         16usize,
         concat!(
             "Offset of field: ",
@@ -2871,7 +2866,7 @@ fn bindgen_test_layout_EmscriptenGamepadEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).analogButton) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).analogButton) as usize - ptr as usize },
         528usize,
         concat!(
             "Offset of field: ",
@@ -2881,7 +2876,7 @@ fn bindgen_test_layout_EmscriptenGamepadEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).digitalButton) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).digitalButton) as usize - ptr as usize },
         1040usize,
         concat!(
             "Offset of field: ",
@@ -2891,7 +2886,7 @@ fn bindgen_test_layout_EmscriptenGamepadEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).connected) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).connected) as usize - ptr as usize },
         1296usize,
         concat!(
             "Offset of field: ",
@@ -2901,7 +2896,7 @@ fn bindgen_test_layout_EmscriptenGamepadEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).index) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).index) as usize - ptr as usize },
         1304usize,
         concat!(
             "Offset of field: ",
@@ -2911,7 +2906,7 @@ fn bindgen_test_layout_EmscriptenGamepadEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).id) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).id) as usize - ptr as usize },
         1312usize,
         concat!(
             "Offset of field: ",
@@ -2921,7 +2916,7 @@ fn bindgen_test_layout_EmscriptenGamepadEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).mapping) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).mapping) as usize - ptr as usize },
         1376usize,
         concat!(
             "Offset of field: ",
@@ -2931,40 +2926,40 @@ fn bindgen_test_layout_EmscriptenGamepadEvent() {
         )
     );
 }
-pub type em_gamepad_callback_func = ::std::option::Option<
+pub type em_gamepad_callback_func = ::core::option::Option<
     unsafe extern "C" fn(
-        eventType: ::std::os::raw::c_int,
+        eventType: ::core::ffi::c_int,
         gamepadEvent: *const EmscriptenGamepadEvent,
-        userData: *mut ::std::os::raw::c_void,
-    ) -> ::std::os::raw::c_int,
+        userData: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int,
 >;
 extern "C" {
     pub fn emscripten_set_gamepadconnected_callback_on_thread(
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_gamepad_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_set_gamepaddisconnected_callback_on_thread(
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_gamepad_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
-    pub fn emscripten_sample_gamepad_data() -> ::std::os::raw::c_int;
+    pub fn emscripten_sample_gamepad_data() -> ::core::ffi::c_int;
 }
 extern "C" {
-    pub fn emscripten_get_num_gamepads() -> ::std::os::raw::c_int;
+    pub fn emscripten_get_num_gamepads() -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_get_gamepad_status(
-        index: ::std::os::raw::c_int,
+        index: ::core::ffi::c_int,
         gamepadState: *mut EmscriptenGamepadEvent,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
@@ -2972,25 +2967,25 @@ pub struct EmscriptenBatteryEvent {
     pub chargingTime: f64,
     pub dischargingTime: f64,
     pub level: f64,
-    pub charging: ::std::os::raw::c_int,
+    pub charging: ::core::ffi::c_int,
 }
 #[test]
 fn bindgen_test_layout_EmscriptenBatteryEvent() {
-    const UNINIT: ::std::mem::MaybeUninit<EmscriptenBatteryEvent> =
-        ::std::mem::MaybeUninit::uninit();
+    const UNINIT: ::core::mem::MaybeUninit<EmscriptenBatteryEvent> =
+        ::core::mem::MaybeUninit::uninit();
     let ptr = UNINIT.as_ptr();
     assert_eq!(
-        ::std::mem::size_of::<EmscriptenBatteryEvent>(),
+        ::core::mem::size_of::<EmscriptenBatteryEvent>(),
         32usize,
         concat!("Size of: ", stringify!(EmscriptenBatteryEvent))
     );
     assert_eq!(
-        ::std::mem::align_of::<EmscriptenBatteryEvent>(),
+        ::core::mem::align_of::<EmscriptenBatteryEvent>(),
         8usize,
         concat!("Alignment of ", stringify!(EmscriptenBatteryEvent))
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).chargingTime) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).chargingTime) as usize - ptr as usize },
         0usize,
         concat!(
             "Offset of field: ",
@@ -3000,7 +2995,7 @@ fn bindgen_test_layout_EmscriptenBatteryEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).dischargingTime) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).dischargingTime) as usize - ptr as usize },
         8usize,
         concat!(
             "Offset of field: ",
@@ -3010,7 +3005,7 @@ fn bindgen_test_layout_EmscriptenBatteryEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).level) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).level) as usize - ptr as usize },
         16usize,
         concat!(
             "Offset of field: ",
@@ -3020,7 +3015,7 @@ fn bindgen_test_layout_EmscriptenBatteryEvent() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).charging) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).charging) as usize - ptr as usize },
         24usize,
         concat!(
             "Offset of field: ",
@@ -3030,109 +3025,109 @@ fn bindgen_test_layout_EmscriptenBatteryEvent() {
         )
     );
 }
-pub type em_battery_callback_func = ::std::option::Option<
+pub type em_battery_callback_func = ::core::option::Option<
     unsafe extern "C" fn(
-        eventType: ::std::os::raw::c_int,
+        eventType: ::core::ffi::c_int,
         batteryEvent: *const EmscriptenBatteryEvent,
-        userData: *mut ::std::os::raw::c_void,
-    ) -> ::std::os::raw::c_int,
+        userData: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int,
 >;
 extern "C" {
     pub fn emscripten_set_batterychargingchange_callback_on_thread(
-        userData: *mut ::std::os::raw::c_void,
+        userData: *mut ::core::ffi::c_void,
         callback: em_battery_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_set_batterylevelchange_callback_on_thread(
-        userData: *mut ::std::os::raw::c_void,
+        userData: *mut ::core::ffi::c_void,
         callback: em_battery_callback_func,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_get_battery_status(
         batteryState: *mut EmscriptenBatteryEvent,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
-    pub fn emscripten_vibrate(msecs: ::std::os::raw::c_int) -> ::std::os::raw::c_int;
+    pub fn emscripten_vibrate(msecs: ::core::ffi::c_int) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_vibrate_pattern(
-        msecsArray: *mut ::std::os::raw::c_int,
-        numEntries: ::std::os::raw::c_int,
-    ) -> ::std::os::raw::c_int;
+        msecsArray: *mut ::core::ffi::c_int,
+        numEntries: ::core::ffi::c_int,
+    ) -> ::core::ffi::c_int;
 }
-pub type em_beforeunload_callback = ::std::option::Option<
+pub type em_beforeunload_callback = ::core::option::Option<
     unsafe extern "C" fn(
-        eventType: ::std::os::raw::c_int,
-        reserved: *const ::std::os::raw::c_void,
-        userData: *mut ::std::os::raw::c_void,
-    ) -> *const ::std::os::raw::c_char,
+        eventType: ::core::ffi::c_int,
+        reserved: *const ::core::ffi::c_void,
+        userData: *mut ::core::ffi::c_void,
+    ) -> *const ::core::ffi::c_char,
 >;
 extern "C" {
     pub fn emscripten_set_beforeunload_callback_on_thread(
-        userData: *mut ::std::os::raw::c_void,
+        userData: *mut ::core::ffi::c_void,
         callback: em_beforeunload_callback,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_set_canvas_element_size(
-        target: *const ::std::os::raw::c_char,
-        width: ::std::os::raw::c_int,
-        height: ::std::os::raw::c_int,
-    ) -> ::std::os::raw::c_int;
+        target: *const ::core::ffi::c_char,
+        width: ::core::ffi::c_int,
+        height: ::core::ffi::c_int,
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_get_canvas_element_size(
-        target: *const ::std::os::raw::c_char,
-        width: *mut ::std::os::raw::c_int,
-        height: *mut ::std::os::raw::c_int,
-    ) -> ::std::os::raw::c_int;
+        target: *const ::core::ffi::c_char,
+        width: *mut ::core::ffi::c_int,
+        height: *mut ::core::ffi::c_int,
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_set_element_css_size(
-        target: *const ::std::os::raw::c_char,
+        target: *const ::core::ffi::c_char,
         width: f64,
         height: f64,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_get_element_css_size(
-        target: *const ::std::os::raw::c_char,
+        target: *const ::core::ffi::c_char,
         width: *mut f64,
         height: *mut f64,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_html5_remove_all_event_listeners();
 }
 extern "C" {
     pub fn emscripten_request_animation_frame(
-        cb: ::std::option::Option<
+        cb: ::core::option::Option<
             unsafe extern "C" fn(
                 time: f64,
-                userData: *mut ::std::os::raw::c_void,
-            ) -> ::std::os::raw::c_int,
+                userData: *mut ::core::ffi::c_void,
+            ) -> ::core::ffi::c_int,
         >,
-        userData: *mut ::std::os::raw::c_void,
-    ) -> ::std::os::raw::c_int;
+        userData: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
-    pub fn emscripten_cancel_animation_frame(requestAnimationFrameId: ::std::os::raw::c_int);
+    pub fn emscripten_cancel_animation_frame(requestAnimationFrameId: ::core::ffi::c_int);
 }
 extern "C" {
     pub fn emscripten_request_animation_frame_loop(
-        cb: ::std::option::Option<
+        cb: ::core::option::Option<
             unsafe extern "C" fn(
                 time: f64,
-                userData: *mut ::std::os::raw::c_void,
-            ) -> ::std::os::raw::c_int,
+                userData: *mut ::core::ffi::c_void,
+            ) -> ::core::ffi::c_int,
         >,
-        userData: *mut ::std::os::raw::c_void,
+        userData: *mut ::core::ffi::c_void,
     );
 }
 extern "C" {
@@ -3141,39 +3136,39 @@ extern "C" {
 extern "C" {
     pub fn emscripten_performance_now() -> f64;
 }
-pub type EMSCRIPTEN_WEBGL_CONTEXT_HANDLE = ::std::os::raw::c_int;
-pub type EMSCRIPTEN_WEBGL_CONTEXT_PROXY_MODE = ::std::os::raw::c_int;
-pub type EM_WEBGL_POWER_PREFERENCE = ::std::os::raw::c_int;
+pub type EMSCRIPTEN_WEBGL_CONTEXT_HANDLE = ::core::ffi::c_int;
+pub type EMSCRIPTEN_WEBGL_CONTEXT_PROXY_MODE = ::core::ffi::c_int;
+pub type EM_WEBGL_POWER_PREFERENCE = ::core::ffi::c_int;
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
 pub struct EmscriptenWebGLContextAttributes {
-    pub alpha: ::std::os::raw::c_int,
-    pub depth: ::std::os::raw::c_int,
-    pub stencil: ::std::os::raw::c_int,
-    pub antialias: ::std::os::raw::c_int,
-    pub premultipliedAlpha: ::std::os::raw::c_int,
-    pub preserveDrawingBuffer: ::std::os::raw::c_int,
+    pub alpha: ::core::ffi::c_int,
+    pub depth: ::core::ffi::c_int,
+    pub stencil: ::core::ffi::c_int,
+    pub antialias: ::core::ffi::c_int,
+    pub premultipliedAlpha: ::core::ffi::c_int,
+    pub preserveDrawingBuffer: ::core::ffi::c_int,
     pub powerPreference: EM_WEBGL_POWER_PREFERENCE,
-    pub failIfMajorPerformanceCaveat: ::std::os::raw::c_int,
-    pub majorVersion: ::std::os::raw::c_int,
-    pub minorVersion: ::std::os::raw::c_int,
-    pub enableExtensionsByDefault: ::std::os::raw::c_int,
-    pub explicitSwapControl: ::std::os::raw::c_int,
+    pub failIfMajorPerformanceCaveat: ::core::ffi::c_int,
+    pub majorVersion: ::core::ffi::c_int,
+    pub minorVersion: ::core::ffi::c_int,
+    pub enableExtensionsByDefault: ::core::ffi::c_int,
+    pub explicitSwapControl: ::core::ffi::c_int,
     pub proxyContextToMainThread: EMSCRIPTEN_WEBGL_CONTEXT_PROXY_MODE,
-    pub renderViaOffscreenBackBuffer: ::std::os::raw::c_int,
+    pub renderViaOffscreenBackBuffer: ::core::ffi::c_int,
 }
 #[test]
 fn bindgen_test_layout_EmscriptenWebGLContextAttributes() {
-    const UNINIT: ::std::mem::MaybeUninit<EmscriptenWebGLContextAttributes> =
-        ::std::mem::MaybeUninit::uninit();
+    const UNINIT: ::core::mem::MaybeUninit<EmscriptenWebGLContextAttributes> =
+        ::core::mem::MaybeUninit::uninit();
     let ptr = UNINIT.as_ptr();
     assert_eq!(
-        ::std::mem::size_of::<EmscriptenWebGLContextAttributes>(),
+        ::core::mem::size_of::<EmscriptenWebGLContextAttributes>(),
         56usize,
         concat!("Size of: ", stringify!(EmscriptenWebGLContextAttributes))
     );
     assert_eq!(
-        ::std::mem::align_of::<EmscriptenWebGLContextAttributes>(),
+        ::core::mem::align_of::<EmscriptenWebGLContextAttributes>(),
         4usize,
         concat!(
             "Alignment of ",
@@ -3181,7 +3176,7 @@ fn bindgen_test_layout_EmscriptenWebGLContextAttributes() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).alpha) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).alpha) as usize - ptr as usize },
         0usize,
         concat!(
             "Offset of field: ",
@@ -3191,7 +3186,7 @@ fn bindgen_test_layout_EmscriptenWebGLContextAttributes() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).depth) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).depth) as usize - ptr as usize },
         4usize,
         concat!(
             "Offset of field: ",
@@ -3201,7 +3196,7 @@ fn bindgen_test_layout_EmscriptenWebGLContextAttributes() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).stencil) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).stencil) as usize - ptr as usize },
         8usize,
         concat!(
             "Offset of field: ",
@@ -3211,7 +3206,7 @@ fn bindgen_test_layout_EmscriptenWebGLContextAttributes() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).antialias) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).antialias) as usize - ptr as usize },
         12usize,
         concat!(
             "Offset of field: ",
@@ -3221,7 +3216,7 @@ fn bindgen_test_layout_EmscriptenWebGLContextAttributes() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).premultipliedAlpha) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).premultipliedAlpha) as usize - ptr as usize },
         16usize,
         concat!(
             "Offset of field: ",
@@ -3231,7 +3226,7 @@ fn bindgen_test_layout_EmscriptenWebGLContextAttributes() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).preserveDrawingBuffer) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).preserveDrawingBuffer) as usize - ptr as usize },
         20usize,
         concat!(
             "Offset of field: ",
@@ -3241,7 +3236,7 @@ fn bindgen_test_layout_EmscriptenWebGLContextAttributes() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).powerPreference) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).powerPreference) as usize - ptr as usize },
         24usize,
         concat!(
             "Offset of field: ",
@@ -3252,7 +3247,7 @@ fn bindgen_test_layout_EmscriptenWebGLContextAttributes() {
     );
     assert_eq!(
         unsafe {
-            ::std::ptr::addr_of!((*ptr).failIfMajorPerformanceCaveat) as usize - ptr as usize
+            ::core::ptr::addr_of!((*ptr).failIfMajorPerformanceCaveat) as usize - ptr as usize
         },
         28usize,
         concat!(
@@ -3263,7 +3258,7 @@ fn bindgen_test_layout_EmscriptenWebGLContextAttributes() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).majorVersion) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).majorVersion) as usize - ptr as usize },
         32usize,
         concat!(
             "Offset of field: ",
@@ -3273,7 +3268,7 @@ fn bindgen_test_layout_EmscriptenWebGLContextAttributes() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).minorVersion) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).minorVersion) as usize - ptr as usize },
         36usize,
         concat!(
             "Offset of field: ",
@@ -3283,7 +3278,7 @@ fn bindgen_test_layout_EmscriptenWebGLContextAttributes() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).enableExtensionsByDefault) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).enableExtensionsByDefault) as usize - ptr as usize },
         40usize,
         concat!(
             "Offset of field: ",
@@ -3293,7 +3288,7 @@ fn bindgen_test_layout_EmscriptenWebGLContextAttributes() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).explicitSwapControl) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).explicitSwapControl) as usize - ptr as usize },
         44usize,
         concat!(
             "Offset of field: ",
@@ -3303,7 +3298,7 @@ fn bindgen_test_layout_EmscriptenWebGLContextAttributes() {
         )
     );
     assert_eq!(
-        unsafe { ::std::ptr::addr_of!((*ptr).proxyContextToMainThread) as usize - ptr as usize },
+        unsafe { ::core::ptr::addr_of!((*ptr).proxyContextToMainThread) as usize - ptr as usize },
         48usize,
         concat!(
             "Offset of field: ",
@@ -3314,7 +3309,7 @@ fn bindgen_test_layout_EmscriptenWebGLContextAttributes() {
     );
     assert_eq!(
         unsafe {
-            ::std::ptr::addr_of!((*ptr).renderViaOffscreenBackBuffer) as usize - ptr as usize
+            ::core::ptr::addr_of!((*ptr).renderViaOffscreenBackBuffer) as usize - ptr as usize
         },
         52usize,
         concat!(
@@ -3332,14 +3327,14 @@ extern "C" {
 }
 extern "C" {
     pub fn emscripten_webgl_create_context(
-        target: *const ::std::os::raw::c_char,
+        target: *const ::core::ffi::c_char,
         attributes: *const EmscriptenWebGLContextAttributes,
     ) -> EMSCRIPTEN_WEBGL_CONTEXT_HANDLE;
 }
 extern "C" {
     pub fn emscripten_webgl_make_context_current(
         context: EMSCRIPTEN_WEBGL_CONTEXT_HANDLE,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_webgl_get_current_context() -> EMSCRIPTEN_WEBGL_CONTEXT_HANDLE;
@@ -3347,196 +3342,196 @@ extern "C" {
 extern "C" {
     pub fn emscripten_webgl_get_drawing_buffer_size(
         context: EMSCRIPTEN_WEBGL_CONTEXT_HANDLE,
-        width: *mut ::std::os::raw::c_int,
-        height: *mut ::std::os::raw::c_int,
-    ) -> ::std::os::raw::c_int;
+        width: *mut ::core::ffi::c_int,
+        height: *mut ::core::ffi::c_int,
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_webgl_get_context_attributes(
         context: EMSCRIPTEN_WEBGL_CONTEXT_HANDLE,
         outAttributes: *mut EmscriptenWebGLContextAttributes,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_webgl_destroy_context(
         context: EMSCRIPTEN_WEBGL_CONTEXT_HANDLE,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_webgl_enable_extension(
         context: EMSCRIPTEN_WEBGL_CONTEXT_HANDLE,
-        extension: *const ::std::os::raw::c_char,
-    ) -> ::std::os::raw::c_int;
+        extension: *const ::core::ffi::c_char,
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_webgl_enable_ANGLE_instanced_arrays(
         context: EMSCRIPTEN_WEBGL_CONTEXT_HANDLE,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_webgl_enable_OES_vertex_array_object(
         context: EMSCRIPTEN_WEBGL_CONTEXT_HANDLE,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_webgl_enable_WEBGL_draw_buffers(
         context: EMSCRIPTEN_WEBGL_CONTEXT_HANDLE,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_webgl_enable_WEBGL_draw_instanced_base_vertex_base_instance(
         context: EMSCRIPTEN_WEBGL_CONTEXT_HANDLE,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_webgl_enable_WEBGL_multi_draw(
         context: EMSCRIPTEN_WEBGL_CONTEXT_HANDLE,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_webgl_enable_WEBGL_multi_draw_instanced_base_vertex_base_instance(
         context: EMSCRIPTEN_WEBGL_CONTEXT_HANDLE,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
-pub type em_webgl_context_callback = ::std::option::Option<
+pub type em_webgl_context_callback = ::core::option::Option<
     unsafe extern "C" fn(
-        eventType: ::std::os::raw::c_int,
-        reserved: *const ::std::os::raw::c_void,
-        userData: *mut ::std::os::raw::c_void,
-    ) -> ::std::os::raw::c_int,
+        eventType: ::core::ffi::c_int,
+        reserved: *const ::core::ffi::c_void,
+        userData: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int,
 >;
 extern "C" {
     pub fn emscripten_set_webglcontextlost_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_webgl_context_callback,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_set_webglcontextrestored_callback_on_thread(
-        target: *const ::std::os::raw::c_char,
-        userData: *mut ::std::os::raw::c_void,
-        useCapture: ::std::os::raw::c_int,
+        target: *const ::core::ffi::c_char,
+        userData: *mut ::core::ffi::c_void,
+        useCapture: ::core::ffi::c_int,
         callback: em_webgl_context_callback,
         targetThread: pthread_t,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_is_webgl_context_lost(
         context: EMSCRIPTEN_WEBGL_CONTEXT_HANDLE,
-    ) -> ::std::os::raw::c_int;
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
-    pub fn emscripten_webgl_commit_frame() -> ::std::os::raw::c_int;
+    pub fn emscripten_webgl_commit_frame() -> ::core::ffi::c_int;
 }
 extern "C" {
-    pub fn emscripten_supports_offscreencanvas() -> ::std::os::raw::c_int;
+    pub fn emscripten_supports_offscreencanvas() -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_webgl1_get_proc_address(
-        name: *const ::std::os::raw::c_char,
-    ) -> *mut ::std::os::raw::c_void;
+        name: *const ::core::ffi::c_char,
+    ) -> *mut ::core::ffi::c_void;
 }
 extern "C" {
     pub fn emscripten_webgl2_get_proc_address(
-        name: *const ::std::os::raw::c_char,
-    ) -> *mut ::std::os::raw::c_void;
+        name: *const ::core::ffi::c_char,
+    ) -> *mut ::core::ffi::c_void;
 }
 extern "C" {
     pub fn emscripten_webgl_get_proc_address(
-        name: *const ::std::os::raw::c_char,
-    ) -> *mut ::std::os::raw::c_void;
+        name: *const ::core::ffi::c_char,
+    ) -> *mut ::core::ffi::c_void;
 }
 extern "C" {
-    pub fn emscripten_webgl_get_supported_extensions() -> *mut ::std::os::raw::c_char;
+    pub fn emscripten_webgl_get_supported_extensions() -> *mut ::core::ffi::c_char;
 }
 extern "C" {
     pub fn emscripten_webgl_get_shader_parameter_d(
-        shader: ::std::os::raw::c_int,
-        param: ::std::os::raw::c_int,
+        shader: ::core::ffi::c_int,
+        param: ::core::ffi::c_int,
     ) -> f64;
 }
 extern "C" {
     pub fn emscripten_webgl_get_shader_info_log_utf8(
-        shader: ::std::os::raw::c_int,
-    ) -> *mut ::std::os::raw::c_char;
+        shader: ::core::ffi::c_int,
+    ) -> *mut ::core::ffi::c_char;
 }
 extern "C" {
     pub fn emscripten_webgl_get_shader_source_utf8(
-        shader: ::std::os::raw::c_int,
-    ) -> *mut ::std::os::raw::c_char;
+        shader: ::core::ffi::c_int,
+    ) -> *mut ::core::ffi::c_char;
 }
 extern "C" {
     pub fn emscripten_webgl_get_program_parameter_d(
-        program: ::std::os::raw::c_int,
-        param: ::std::os::raw::c_int,
+        program: ::core::ffi::c_int,
+        param: ::core::ffi::c_int,
     ) -> f64;
 }
 extern "C" {
     pub fn emscripten_webgl_get_program_info_log_utf8(
-        program: ::std::os::raw::c_int,
-    ) -> *mut ::std::os::raw::c_char;
+        program: ::core::ffi::c_int,
+    ) -> *mut ::core::ffi::c_char;
 }
 extern "C" {
     pub fn emscripten_webgl_get_vertex_attrib_d(
-        index: ::std::os::raw::c_int,
-        param: ::std::os::raw::c_int,
+        index: ::core::ffi::c_int,
+        param: ::core::ffi::c_int,
     ) -> f64;
 }
 extern "C" {
     pub fn emscripten_webgl_get_vertex_attrib_o(
-        index: ::std::os::raw::c_int,
-        param: ::std::os::raw::c_int,
-    ) -> ::std::os::raw::c_int;
+        index: ::core::ffi::c_int,
+        param: ::core::ffi::c_int,
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_webgl_get_vertex_attrib_v(
-        index: ::std::os::raw::c_int,
-        param: ::std::os::raw::c_int,
-        dst: *mut ::std::os::raw::c_void,
-        dstLength: ::std::os::raw::c_int,
-        dstType: ::std::os::raw::c_int,
-    ) -> ::std::os::raw::c_int;
+        index: ::core::ffi::c_int,
+        param: ::core::ffi::c_int,
+        dst: *mut ::core::ffi::c_void,
+        dstLength: ::core::ffi::c_int,
+        dstType: ::core::ffi::c_int,
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_webgl_get_uniform_d(
-        program: ::std::os::raw::c_int,
-        location: ::std::os::raw::c_int,
+        program: ::core::ffi::c_int,
+        location: ::core::ffi::c_int,
     ) -> f64;
 }
 extern "C" {
     pub fn emscripten_webgl_get_uniform_v(
-        program: ::std::os::raw::c_int,
-        location: ::std::os::raw::c_int,
-        dst: *mut ::std::os::raw::c_void,
-        dstLength: ::std::os::raw::c_int,
-        dstType: ::std::os::raw::c_int,
-    ) -> ::std::os::raw::c_int;
+        program: ::core::ffi::c_int,
+        location: ::core::ffi::c_int,
+        dst: *mut ::core::ffi::c_void,
+        dstLength: ::core::ffi::c_int,
+        dstType: ::core::ffi::c_int,
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_webgl_get_parameter_v(
-        param: ::std::os::raw::c_int,
-        dst: *mut ::std::os::raw::c_void,
-        dstLength: ::std::os::raw::c_int,
-        dstType: ::std::os::raw::c_int,
-    ) -> ::std::os::raw::c_int;
+        param: ::core::ffi::c_int,
+        dst: *mut ::core::ffi::c_void,
+        dstLength: ::core::ffi::c_int,
+        dstType: ::core::ffi::c_int,
+    ) -> ::core::ffi::c_int;
 }
 extern "C" {
-    pub fn emscripten_webgl_get_parameter_d(param: ::std::os::raw::c_int) -> f64;
+    pub fn emscripten_webgl_get_parameter_d(param: ::core::ffi::c_int) -> f64;
 }
 extern "C" {
-    pub fn emscripten_webgl_get_parameter_o(param: ::std::os::raw::c_int) -> ::std::os::raw::c_int;
+    pub fn emscripten_webgl_get_parameter_o(param: ::core::ffi::c_int) -> ::core::ffi::c_int;
 }
 extern "C" {
     pub fn emscripten_webgl_get_parameter_utf8(
-        param: ::std::os::raw::c_int,
-    ) -> *mut ::std::os::raw::c_char;
+        param: ::core::ffi::c_int,
+    ) -> *mut ::core::ffi::c_char;
 }
 extern "C" {
     pub fn emscripten_webgl_get_parameter_i64v(
-        param: ::std::os::raw::c_int,
-        dst: *mut ::std::os::raw::c_longlong,
+        param: ::core::ffi::c_int,
+        dst: *mut ::core::ffi::c_longlong,
     );
 }
@@ -0,0 +1,294 @@
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WGPUBindGroupImpl {
+    _unused: [u8; 0],
+}
+pub type WGPUBindGroup = *mut WGPUBindGroupImpl;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WGPUBindGroupLayoutImpl {
+    _unused: [u8; 0],
+}
+pub type WGPUBindGroupLayout = *mut WGPUBindGroupLayoutImpl;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WGPUBufferImpl {
+    _unused: [u8; 0],
+}
+pub type WGPUBuffer = *mut WGPUBufferImpl;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WGPUCommandBufferImpl {
+    _unused: [u8; 0],
+}
+pub type WGPUCommandBuffer = *mut WGPUCommandBufferImpl;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WGPUCommandEncoderImpl {
+    _unused: [u8; 0],
+}
+pub type WGPUCommandEncoder = *mut WGPUCommandEncoderImpl;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WGPUComputePassEncoderImpl {
+    _unused: [u8; 0],
+}
+pub type WGPUComputePassEncoder = *mut WGPUComputePassEncoderImpl;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WGPUComputePipelineImpl {
+    _unused: [u8; 0],
+}
+pub type WGPUComputePipeline = *mut WGPUComputePipelineImpl;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WGPUDeviceImpl {
+    _unused: [u8; 0],
+}
+pub type WGPUDevice = *mut WGPUDeviceImpl;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WGPUPipelineLayoutImpl {
+    _unused: [u8; 0],
+}
+pub type WGPUPipelineLayout = *mut WGPUPipelineLayoutImpl;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WGPUQuerySetImpl {
+    _unused: [u8; 0],
+}
+pub type WGPUQuerySet = *mut WGPUQuerySetImpl;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WGPUQueueImpl {
+    _unused: [u8; 0],
+}
+pub type WGPUQueue = *mut WGPUQueueImpl;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WGPURenderBundleImpl {
+    _unused: [u8; 0],
+}
+pub type WGPURenderBundle = *mut WGPURenderBundleImpl;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WGPURenderBundleEncoderImpl {
+    _unused: [u8; 0],
+}
+pub type WGPURenderBundleEncoder = *mut WGPURenderBundleEncoderImpl;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WGPURenderPassEncoderImpl {
+    _unused: [u8; 0],
+}
+pub type WGPURenderPassEncoder = *mut WGPURenderPassEncoderImpl;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WGPURenderPipelineImpl {
+    _unused: [u8; 0],
+}
+pub type WGPURenderPipeline = *mut WGPURenderPipelineImpl;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WGPUSamplerImpl {
+    _unused: [u8; 0],
+}
+pub type WGPUSampler = *mut WGPUSamplerImpl;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WGPUShaderModuleImpl {
+    _unused: [u8; 0],
+}
+pub type WGPUShaderModule = *mut WGPUShaderModuleImpl;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WGPUSurfaceImpl {
+    _unused: [u8; 0],
+}
+pub type WGPUSurface = *mut WGPUSurfaceImpl;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WGPUSwapChainImpl {
+    _unused: [u8; 0],
+}
+pub type WGPUSwapChain = *mut WGPUSwapChainImpl;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WGPUTextureImpl {
+    _unused: [u8; 0],
+}
+pub type WGPUTexture = *mut WGPUTextureImpl;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WGPUTextureViewImpl {
+    _unused: [u8; 0],
+}
+pub type WGPUTextureView = *mut WGPUTextureViewImpl;
+extern "C" {
+    pub fn emscripten_webgpu_get_device() -> WGPUDevice;
+}
+extern "C" {
+    pub fn emscripten_webgpu_release_js_handle(js_handle: ::core::ffi::c_int);
+}
+extern "C" {
+    pub fn emscripten_webgpu_import_surface(arg1: ::core::ffi::c_int) -> WGPUSurface;
+}
+extern "C" {
+    pub fn emscripten_webgpu_export_surface(arg1: WGPUSurface) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_webgpu_import_swap_chain(arg1: ::core::ffi::c_int) -> WGPUSwapChain;
+}
+extern "C" {
+    pub fn emscripten_webgpu_export_swap_chain(arg1: WGPUSwapChain) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_webgpu_import_device(arg1: ::core::ffi::c_int) -> WGPUDevice;
+}
+extern "C" {
+    pub fn emscripten_webgpu_export_device(arg1: WGPUDevice) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_webgpu_import_queue(arg1: ::core::ffi::c_int) -> WGPUQueue;
+}
+extern "C" {
+    pub fn emscripten_webgpu_export_queue(arg1: WGPUQueue) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_webgpu_import_command_buffer(
+        arg1: ::core::ffi::c_int,
+    ) -> WGPUCommandBuffer;
+}
+extern "C" {
+    pub fn emscripten_webgpu_export_command_buffer(
+        arg1: WGPUCommandBuffer,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_webgpu_import_command_encoder(
+        arg1: ::core::ffi::c_int,
+    ) -> WGPUCommandEncoder;
+}
+extern "C" {
+    pub fn emscripten_webgpu_export_command_encoder(
+        arg1: WGPUCommandEncoder,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_webgpu_import_render_pass_encoder(
+        arg1: ::core::ffi::c_int,
+    ) -> WGPURenderPassEncoder;
+}
+extern "C" {
+    pub fn emscripten_webgpu_export_render_pass_encoder(
+        arg1: WGPURenderPassEncoder,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_webgpu_import_compute_pass_encoder(
+        arg1: ::core::ffi::c_int,
+    ) -> WGPUComputePassEncoder;
+}
+extern "C" {
+    pub fn emscripten_webgpu_export_compute_pass_encoder(
+        arg1: WGPUComputePassEncoder,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_webgpu_import_bind_group(arg1: ::core::ffi::c_int) -> WGPUBindGroup;
+}
+extern "C" {
+    pub fn emscripten_webgpu_export_bind_group(arg1: WGPUBindGroup) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_webgpu_import_buffer(arg1: ::core::ffi::c_int) -> WGPUBuffer;
+}
+extern "C" {
+    pub fn emscripten_webgpu_export_buffer(arg1: WGPUBuffer) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_webgpu_import_sampler(arg1: ::core::ffi::c_int) -> WGPUSampler;
+}
+extern "C" {
+    pub fn emscripten_webgpu_export_sampler(arg1: WGPUSampler) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_webgpu_import_texture(arg1: ::core::ffi::c_int) -> WGPUTexture;
+}
+extern "C" {
+    pub fn emscripten_webgpu_export_texture(arg1: WGPUTexture) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_webgpu_import_texture_view(arg1: ::core::ffi::c_int) -> WGPUTextureView;
+}
+extern "C" {
+    pub fn emscripten_webgpu_export_texture_view(arg1: WGPUTextureView) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_webgpu_import_query_set(arg1: ::core::ffi::c_int) -> WGPUQuerySet;
+}
+extern "C" {
+    pub fn emscripten_webgpu_export_query_set(arg1: WGPUQuerySet) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_webgpu_import_bind_group_layout(
+        arg1: ::core::ffi::c_int,
+    ) -> WGPUBindGroupLayout;
+}
+extern "C" {
+    pub fn emscripten_webgpu_export_bind_group_layout(
+        arg1: WGPUBindGroupLayout,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_webgpu_import_pipeline_layout(
+        arg1: ::core::ffi::c_int,
+    ) -> WGPUPipelineLayout;
+}
+extern "C" {
+    pub fn emscripten_webgpu_export_pipeline_layout(
+        arg1: WGPUPipelineLayout,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_webgpu_import_render_pipeline(
+        arg1: ::core::ffi::c_int,
+    ) -> WGPURenderPipeline;
+}
+extern "C" {
+    pub fn emscripten_webgpu_export_render_pipeline(
+        arg1: WGPURenderPipeline,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_webgpu_import_compute_pipeline(
+        arg1: ::core::ffi::c_int,
+    ) -> WGPUComputePipeline;
+}
+extern "C" {
+    pub fn emscripten_webgpu_export_compute_pipeline(
+        arg1: WGPUComputePipeline,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_webgpu_import_shader_module(arg1: ::core::ffi::c_int) -> WGPUShaderModule;
+}
+extern "C" {
+    pub fn emscripten_webgpu_export_shader_module(arg1: WGPUShaderModule) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_webgpu_import_render_bundle_encoder(
+        arg1: ::core::ffi::c_int,
+    ) -> WGPURenderBundleEncoder;
+}
+extern "C" {
+    pub fn emscripten_webgpu_export_render_bundle_encoder(
+        arg1: WGPURenderBundleEncoder,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_webgpu_import_render_bundle(arg1: ::core::ffi::c_int) -> WGPURenderBundle;
+}
+extern "C" {
+    pub fn emscripten_webgpu_export_render_bundle(arg1: WGPURenderBundle) -> ::core::ffi::c_int;
+}
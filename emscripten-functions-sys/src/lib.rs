@@ -1,11 +1,32 @@
-//! Raw bindgen-generated rust bindings to emscripten's system functions.
+//! Raw rust bindings to emscripten's system functions, in the shape bindgen generates them (see `build_bindings.rs`).
 //! They are grouped by their header file.
+//! The bindings only use `core`, so the crate is `no_std`.
 
 #![cfg(target_os = "emscripten")]
+#![no_std]
 #![allow(non_upper_case_globals)]
 #![allow(non_camel_case_types)]
 #![allow(non_snake_case)]
+// The constants of `em_math.h` approximate those of `core::f64::consts`.
+#![allow(clippy::approx_constant)]
 
 pub mod console;
+pub mod dom_pk_codes;
+pub mod em_math;
+pub mod emmalloc;
 pub mod emscripten;
+pub mod fetch;
+pub mod fiber;
+pub mod heap;
 pub mod html5;
+pub mod html5_webgpu;
+pub mod posix_socket;
+pub mod proxying;
+pub mod pthread;
+pub mod stack;
+pub mod threading;
+pub mod trace;
+pub mod wasm_worker;
+pub mod wasmfs;
+pub mod webaudio;
+pub mod websocket;
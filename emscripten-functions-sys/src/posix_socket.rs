@@ -0,0 +1,6 @@
+pub type EMSCRIPTEN_RESULT = ::core::ffi::c_int;
+extern "C" {
+    pub fn emscripten_init_websocket_to_posix_socket_bridge(
+        bridgeUrl: *const ::core::ffi::c_char,
+    ) -> EMSCRIPTEN_RESULT;
+}
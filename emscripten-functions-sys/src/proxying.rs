@@ -0,0 +1,74 @@
+pub use crate::pthread::{__pthread, pthread_t};
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct em_proxying_queue {
+    _unused: [u8; 0],
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct em_proxying_ctx {
+    _unused: [u8; 0],
+}
+extern "C" {
+    pub fn em_proxying_queue_create() -> *mut em_proxying_queue;
+}
+extern "C" {
+    pub fn em_proxying_queue_destroy(q: *mut em_proxying_queue);
+}
+extern "C" {
+    pub fn emscripten_proxy_get_system_queue() -> *mut em_proxying_queue;
+}
+extern "C" {
+    pub fn emscripten_proxy_execute_queue(q: *mut em_proxying_queue);
+}
+extern "C" {
+    pub fn emscripten_proxy_finish(ctx: *mut em_proxying_ctx);
+}
+extern "C" {
+    pub fn emscripten_proxy_async(
+        q: *mut em_proxying_queue,
+        target_thread: pthread_t,
+        func: ::core::option::Option<unsafe extern "C" fn(arg1: *mut ::core::ffi::c_void)>,
+        arg: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_proxy_sync(
+        q: *mut em_proxying_queue,
+        target_thread: pthread_t,
+        func: ::core::option::Option<unsafe extern "C" fn(arg1: *mut ::core::ffi::c_void)>,
+        arg: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_proxy_sync_with_ctx(
+        q: *mut em_proxying_queue,
+        target_thread: pthread_t,
+        func: ::core::option::Option<
+            unsafe extern "C" fn(arg1: *mut em_proxying_ctx, arg2: *mut ::core::ffi::c_void),
+        >,
+        arg: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_proxy_callback(
+        q: *mut em_proxying_queue,
+        target_thread: pthread_t,
+        func: ::core::option::Option<unsafe extern "C" fn(arg1: *mut ::core::ffi::c_void)>,
+        callback: ::core::option::Option<unsafe extern "C" fn(arg1: *mut ::core::ffi::c_void)>,
+        cancel: ::core::option::Option<unsafe extern "C" fn(arg1: *mut ::core::ffi::c_void)>,
+        arg: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_proxy_callback_with_ctx(
+        q: *mut em_proxying_queue,
+        target_thread: pthread_t,
+        func: ::core::option::Option<
+            unsafe extern "C" fn(arg1: *mut em_proxying_ctx, arg2: *mut ::core::ffi::c_void),
+        >,
+        callback: ::core::option::Option<unsafe extern "C" fn(arg1: *mut ::core::ffi::c_void)>,
+        cancel: ::core::option::Option<unsafe extern "C" fn(arg1: *mut ::core::ffi::c_void)>,
+        arg: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int;
+}
@@ -0,0 +1,9 @@
+//! The opaque `pthread_t` of musl, which several headers use to name a target thread.
+//! It's declared once here, and re-exported by the bindings that use it, so that their thread handles are the same type.
+
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct __pthread {
+    _unused: [u8; 0],
+}
+pub type pthread_t = *mut __pthread;
@@ -0,0 +1,21 @@
+extern "C" {
+    pub fn emscripten_stack_get_base() -> usize;
+}
+extern "C" {
+    pub fn emscripten_stack_get_end() -> usize;
+}
+extern "C" {
+    pub fn emscripten_stack_init();
+}
+extern "C" {
+    pub fn emscripten_stack_set_limits(
+        base: *mut ::core::ffi::c_void,
+        end: *mut ::core::ffi::c_void,
+    );
+}
+extern "C" {
+    pub fn emscripten_stack_get_current() -> usize;
+}
+extern "C" {
+    pub fn emscripten_stack_get_free() -> usize;
+}
@@ -0,0 +1,47 @@
+pub use crate::pthread::{__pthread, pthread_t};
+extern "C" {
+    pub fn emscripten_num_logical_cores() -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_has_threading_support() -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_force_num_logical_cores(cores: ::core::ffi::c_int);
+}
+extern "C" {
+    pub fn emscripten_futex_wait(
+        addr: *mut ::core::ffi::c_void,
+        val: u32,
+        maxWaitMilliseconds: f64,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_futex_wake(
+        addr: *mut ::core::ffi::c_void,
+        count: ::core::ffi::c_int,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_is_main_runtime_thread() -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_is_main_browser_thread() -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_main_runtime_thread_id() -> pthread_t;
+}
+extern "C" {
+    pub fn emscripten_main_thread_process_queued_calls();
+}
+extern "C" {
+    pub fn emscripten_current_thread_process_queued_calls();
+}
+extern "C" {
+    pub fn emscripten_thread_sleep(msecs: f64);
+}
+extern "C" {
+    pub fn emscripten_set_thread_name(threadId: pthread_t, name: *const ::core::ffi::c_char);
+}
+extern "C" {
+    pub fn emscripten_check_blocking_allowed();
+}
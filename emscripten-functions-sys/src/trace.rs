@@ -0,0 +1,100 @@
+extern "C" {
+    pub fn emscripten_trace_configure(
+        collector_url: *const ::core::ffi::c_char,
+        application: *const ::core::ffi::c_char,
+    );
+}
+extern "C" {
+    pub fn emscripten_trace_configure_for_google_wtf();
+}
+extern "C" {
+    pub fn emscripten_trace_configure_for_test();
+}
+extern "C" {
+    pub fn emscripten_trace_set_enabled(enabled: bool);
+}
+extern "C" {
+    pub fn emscripten_trace_set_session_username(username: *const ::core::ffi::c_char);
+}
+extern "C" {
+    pub fn emscripten_trace_record_frame_start();
+}
+extern "C" {
+    pub fn emscripten_trace_record_frame_end();
+}
+extern "C" {
+    pub fn emscripten_trace_mark(message: *const ::core::ffi::c_char);
+}
+extern "C" {
+    pub fn emscripten_trace_log_message(
+        channel: *const ::core::ffi::c_char,
+        message: *const ::core::ffi::c_char,
+    );
+}
+extern "C" {
+    pub fn emscripten_trace_report_error(error: *const ::core::ffi::c_char);
+}
+extern "C" {
+    pub fn emscripten_trace_record_allocation(address: *const ::core::ffi::c_void, size: i32);
+}
+extern "C" {
+    pub fn emscripten_trace_record_reallocation(
+        old_address: *const ::core::ffi::c_void,
+        new_address: *const ::core::ffi::c_void,
+        size: i32,
+    );
+}
+extern "C" {
+    pub fn emscripten_trace_record_free(address: *const ::core::ffi::c_void);
+}
+extern "C" {
+    pub fn emscripten_trace_annotate_address_type(
+        address: *const ::core::ffi::c_void,
+        type_: *const ::core::ffi::c_char,
+    );
+}
+extern "C" {
+    pub fn emscripten_trace_associate_storage_size(
+        address: *const ::core::ffi::c_void,
+        size: i32,
+    );
+}
+extern "C" {
+    pub fn emscripten_trace_report_memory_layout();
+}
+extern "C" {
+    pub fn emscripten_trace_report_off_heap_data();
+}
+extern "C" {
+    pub fn emscripten_trace_enter_context(name: *const ::core::ffi::c_char);
+}
+extern "C" {
+    pub fn emscripten_trace_exit_context();
+}
+extern "C" {
+    pub fn emscripten_trace_task_start(
+        task_id: ::core::ffi::c_int,
+        name: *const ::core::ffi::c_char,
+    );
+}
+extern "C" {
+    pub fn emscripten_trace_task_associate_data(
+        key: *const ::core::ffi::c_char,
+        value: *const ::core::ffi::c_char,
+    );
+}
+extern "C" {
+    pub fn emscripten_trace_task_suspend(explanation: *const ::core::ffi::c_char);
+}
+extern "C" {
+    pub fn emscripten_trace_task_resume(
+        task_id: ::core::ffi::c_int,
+        explanation: *const ::core::ffi::c_char,
+    );
+}
+extern "C" {
+    pub fn emscripten_trace_task_end();
+}
+extern "C" {
+    pub fn emscripten_trace_close();
+}
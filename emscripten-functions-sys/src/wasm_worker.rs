@@ -0,0 +1,252 @@
+pub const EMSCRIPTEN_WASM_WORKER_ID_PARENT: u32 = 0;
+pub const ATOMICS_WAIT_OK: u32 = 0;
+pub const ATOMICS_WAIT_NOT_EQUAL: u32 = 1;
+pub const ATOMICS_WAIT_TIMED_OUT: u32 = 2;
+pub const ATOMICS_WAIT_DURATION_INFINITE: i32 = -1;
+pub const EMSCRIPTEN_NOTIFY_ALL_WAITERS: i32 = -1;
+pub const EMSCRIPTEN_LOCK_T_STATIC_INITIALIZER: u32 = 0;
+pub const EMSCRIPTEN_CONDVAR_T_STATIC_INITIALIZER: u32 = 0;
+extern "C" {
+    pub fn emscripten_malloc_wasm_worker(stackSize: usize) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_create_wasm_worker(
+        stackPlusTLSAddress: *mut ::core::ffi::c_void,
+        stackPlusTLSSize: usize,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_terminate_wasm_worker(id: ::core::ffi::c_int);
+}
+extern "C" {
+    pub fn emscripten_terminate_all_wasm_workers();
+}
+extern "C" {
+    pub fn emscripten_current_thread_is_wasm_worker() -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_wasm_worker_self_id() -> u32;
+}
+extern "C" {
+    pub fn emscripten_wasm_worker_post_function_v(
+        id: ::core::ffi::c_int,
+        funcPtr: ::core::option::Option<unsafe extern "C" fn()>,
+    );
+}
+extern "C" {
+    pub fn emscripten_wasm_worker_post_function_vi(
+        id: ::core::ffi::c_int,
+        funcPtr: ::core::option::Option<unsafe extern "C" fn(arg1: ::core::ffi::c_int)>,
+        arg0: ::core::ffi::c_int,
+    );
+}
+extern "C" {
+    pub fn emscripten_wasm_worker_post_function_vii(
+        id: ::core::ffi::c_int,
+        funcPtr: ::core::option::Option<
+            unsafe extern "C" fn(arg1: ::core::ffi::c_int, arg2: ::core::ffi::c_int),
+        >,
+        arg0: ::core::ffi::c_int,
+        arg1: ::core::ffi::c_int,
+    );
+}
+extern "C" {
+    pub fn emscripten_wasm_worker_post_function_viii(
+        id: ::core::ffi::c_int,
+        funcPtr: ::core::option::Option<
+            unsafe extern "C" fn(
+                arg1: ::core::ffi::c_int,
+                arg2: ::core::ffi::c_int,
+                arg3: ::core::ffi::c_int,
+            ),
+        >,
+        arg0: ::core::ffi::c_int,
+        arg1: ::core::ffi::c_int,
+        arg2: ::core::ffi::c_int,
+    );
+}
+extern "C" {
+    pub fn emscripten_wasm_worker_post_function_vd(
+        id: ::core::ffi::c_int,
+        funcPtr: ::core::option::Option<unsafe extern "C" fn(arg1: f64)>,
+        arg0: f64,
+    );
+}
+extern "C" {
+    pub fn emscripten_wasm_worker_post_function_vdd(
+        id: ::core::ffi::c_int,
+        funcPtr: ::core::option::Option<unsafe extern "C" fn(arg1: f64, arg2: f64)>,
+        arg0: f64,
+        arg1: f64,
+    );
+}
+extern "C" {
+    pub fn emscripten_wasm_worker_post_function_vddd(
+        id: ::core::ffi::c_int,
+        funcPtr: ::core::option::Option<unsafe extern "C" fn(arg1: f64, arg2: f64, arg3: f64)>,
+        arg0: f64,
+        arg1: f64,
+        arg2: f64,
+    );
+}
+extern "C" {
+    pub fn emscripten_wasm_worker_post_function_sig(
+        id: ::core::ffi::c_int,
+        funcPtr: *mut ::core::ffi::c_void,
+        sig: *const ::core::ffi::c_char,
+        ...
+    );
+}
+extern "C" {
+    pub fn emscripten_atomic_wait_async(
+        address: *mut i32,
+        value: u32,
+        asyncWaitFinished: ::core::option::Option<
+            unsafe extern "C" fn(
+                address: *mut i32,
+                value: u32,
+                waitResult: ::core::ffi::c_int,
+                userData: *mut ::core::ffi::c_void,
+            ),
+        >,
+        userData: *mut ::core::ffi::c_void,
+        maxWaitMilliseconds: f64,
+    ) -> i32;
+}
+extern "C" {
+    pub fn emscripten_atomic_cancel_wait_async(waitToken: i32) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_atomic_cancel_all_wait_asyncs() -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_atomic_cancel_all_wait_asyncs_at_address(
+        address: *mut i32,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_wasm_worker_sleep(nanoseconds: i64);
+}
+extern "C" {
+    pub fn emscripten_navigator_hardware_concurrency() -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_atomics_is_lock_free(
+        byteWidth: ::core::ffi::c_int,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_lock_init(lock: *mut u32);
+}
+extern "C" {
+    pub fn emscripten_lock_wait_acquire(
+        lock: *mut u32,
+        maxWaitNanoseconds: i64,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_lock_waitinf_acquire(lock: *mut u32);
+}
+extern "C" {
+    pub fn emscripten_lock_busyspin_wait_acquire(
+        lock: *mut u32,
+        maxWaitMilliseconds: f64,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_lock_busyspin_waitinf_acquire(lock: *mut u32);
+}
+extern "C" {
+    pub fn emscripten_lock_async_acquire(
+        lock: *mut u32,
+        asyncWaitFinished: ::core::option::Option<
+            unsafe extern "C" fn(
+                address: *mut ::core::ffi::c_void,
+                value: u32,
+                waitResult: ::core::ffi::c_int,
+                userData: *mut ::core::ffi::c_void,
+            ),
+        >,
+        userData: *mut ::core::ffi::c_void,
+        maxWaitMilliseconds: f64,
+    );
+}
+extern "C" {
+    pub fn emscripten_lock_try_acquire(lock: *mut u32) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_lock_release(lock: *mut u32);
+}
+extern "C" {
+    pub fn emscripten_semaphore_init(sem: *mut u32, num: ::core::ffi::c_int);
+}
+extern "C" {
+    pub fn emscripten_semaphore_try_acquire(
+        sem: *mut u32,
+        num: ::core::ffi::c_int,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_semaphore_async_acquire(
+        sem: *mut u32,
+        num: ::core::ffi::c_int,
+        asyncWaitFinished: ::core::option::Option<
+            unsafe extern "C" fn(
+                address: *mut ::core::ffi::c_void,
+                idx: u32,
+                result: ::core::ffi::c_int,
+                userData: *mut ::core::ffi::c_void,
+            ),
+        >,
+        userData: *mut ::core::ffi::c_void,
+        maxWaitMilliseconds: f64,
+    );
+}
+extern "C" {
+    pub fn emscripten_semaphore_wait_acquire(
+        sem: *mut u32,
+        num: ::core::ffi::c_int,
+        maxWaitNanoseconds: i64,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_semaphore_waitinf_acquire(
+        sem: *mut u32,
+        num: ::core::ffi::c_int,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_semaphore_release(sem: *mut u32, num: ::core::ffi::c_int) -> u32;
+}
+extern "C" {
+    pub fn emscripten_condvar_init(condvar: *mut u32);
+}
+extern "C" {
+    pub fn emscripten_condvar_waitinf(condvar: *mut u32, lock: *mut u32);
+}
+extern "C" {
+    pub fn emscripten_condvar_wait(
+        condvar: *mut u32,
+        lock: *mut u32,
+        maxWaitNanoseconds: i64,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_condvar_wait_async(
+        condvar: *mut u32,
+        lock: *mut u32,
+        asyncWaitFinished: ::core::option::Option<
+            unsafe extern "C" fn(
+                address: *mut i32,
+                value: u32,
+                waitResult: ::core::ffi::c_int,
+                userData: *mut ::core::ffi::c_void,
+            ),
+        >,
+        userData: *mut ::core::ffi::c_void,
+        maxWaitMilliseconds: f64,
+    ) -> i32;
+}
+extern "C" {
+    pub fn emscripten_condvar_signal(condvar: *mut u32, numWaitersToSignal: i64);
+}
@@ -0,0 +1,62 @@
+pub type mode_t = ::core::ffi::c_uint;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct Backend {
+    _unused: [u8; 0],
+}
+pub type backend_t = *mut Backend;
+extern "C" {
+    pub fn wasmfs_get_backend_by_path(path: *mut ::core::ffi::c_char) -> backend_t;
+}
+extern "C" {
+    pub fn wasmfs_get_backend_by_fd(fd: ::core::ffi::c_int) -> backend_t;
+}
+extern "C" {
+    pub fn wasmfs_create_file(
+        pathname: *const ::core::ffi::c_char,
+        mode: mode_t,
+        backend: backend_t,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn wasmfs_create_directory(
+        path: *const ::core::ffi::c_char,
+        mode: mode_t,
+        backend: backend_t,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn wasmfs_unmount(path: isize) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn wasmfs_create_js_file_backend() -> backend_t;
+}
+pub type backend_constructor_t =
+    ::core::option::Option<unsafe extern "C" fn(arg1: *mut ::core::ffi::c_void) -> backend_t>;
+extern "C" {
+    pub fn wasmfs_create_memory_backend() -> backend_t;
+}
+extern "C" {
+    pub fn wasmfs_create_fetch_backend(base_url: *const ::core::ffi::c_char) -> backend_t;
+}
+extern "C" {
+    pub fn wasmfs_create_node_backend(root: *const ::core::ffi::c_char) -> backend_t;
+}
+extern "C" {
+    pub fn wasmfs_create_opfs_backend() -> backend_t;
+}
+extern "C" {
+    pub fn wasmfs_create_jsimpl_backend() -> backend_t;
+}
+extern "C" {
+    pub fn wasmfs_create_icase_backend(backend: backend_t) -> backend_t;
+}
+extern "C" {
+    pub fn wasmfs_flush();
+}
+extern "C" {
+    pub fn wasmfs_create_root_dir() -> backend_t;
+}
+extern "C" {
+    pub fn wasmfs_before_preload();
+}
@@ -0,0 +1,208 @@
+pub const AUDIO_CONTEXT_STATE_SUSPENDED: u32 = 0;
+pub const AUDIO_CONTEXT_STATE_RUNNING: u32 = 1;
+pub const AUDIO_CONTEXT_STATE_CLOSED: u32 = 2;
+pub const AUDIO_CONTEXT_STATE_INTERRUPTED: u32 = 3;
+pub const WEBAUDIO_PARAM_A_RATE: u32 = 0;
+pub const WEBAUDIO_PARAM_K_RATE: u32 = 1;
+pub const EMSCRIPTEN_AUDIO_MAIN_THREAD: u32 = 0;
+pub type EMSCRIPTEN_WEBAUDIO_T = ::core::ffi::c_int;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct EmscriptenWebAudioCreateAttributes {
+    pub latencyHint: *const ::core::ffi::c_char,
+    pub sampleRate: u32,
+}
+extern "C" {
+    pub fn emscripten_create_audio_context(
+        options: *const EmscriptenWebAudioCreateAttributes,
+    ) -> EMSCRIPTEN_WEBAUDIO_T;
+}
+pub type AUDIO_CONTEXT_STATE = ::core::ffi::c_int;
+pub type EmscriptenResumeAudioContextCallback = ::core::option::Option<
+    unsafe extern "C" fn(
+        audioContext: EMSCRIPTEN_WEBAUDIO_T,
+        state: AUDIO_CONTEXT_STATE,
+        userData1: *mut ::core::ffi::c_void,
+    ),
+>;
+extern "C" {
+    pub fn emscripten_resume_audio_context_async(
+        audioContext: EMSCRIPTEN_WEBAUDIO_T,
+        callback: EmscriptenResumeAudioContextCallback,
+        userData1: *mut ::core::ffi::c_void,
+    );
+}
+extern "C" {
+    pub fn emscripten_resume_audio_context_sync(audioContext: EMSCRIPTEN_WEBAUDIO_T);
+}
+extern "C" {
+    pub fn emscripten_audio_context_state(
+        audioContext: EMSCRIPTEN_WEBAUDIO_T,
+    ) -> AUDIO_CONTEXT_STATE;
+}
+pub type EmscriptenStartWebAudioWorkletCallback = ::core::option::Option<
+    unsafe extern "C" fn(
+        audioContext: EMSCRIPTEN_WEBAUDIO_T,
+        success: ::core::ffi::c_int,
+        userData2: *mut ::core::ffi::c_void,
+    ),
+>;
+extern "C" {
+    pub fn emscripten_destroy_audio_context(audioContext: EMSCRIPTEN_WEBAUDIO_T);
+}
+extern "C" {
+    pub fn emscripten_destroy_web_audio_node(objectHandle: EMSCRIPTEN_WEBAUDIO_T);
+}
+extern "C" {
+    pub fn emscripten_start_wasm_audio_worklet_thread_async(
+        audioContext: EMSCRIPTEN_WEBAUDIO_T,
+        stackLowestAddress: *mut ::core::ffi::c_void,
+        stackSize: u32,
+        callback: EmscriptenStartWebAudioWorkletCallback,
+        userData2: *mut ::core::ffi::c_void,
+    );
+}
+pub type WEBAUDIO_PARAM_AUTOMATION_RATE = ::core::ffi::c_int;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WebAudioParamDescriptor {
+    pub defaultValue: f32,
+    pub minValue: f32,
+    pub maxValue: f32,
+    pub automationRate: WEBAUDIO_PARAM_AUTOMATION_RATE,
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WebAudioWorkletProcessorCreateOptions {
+    pub name: *const ::core::ffi::c_char,
+    pub numAudioParams: ::core::ffi::c_int,
+    pub audioParamDescriptors: *const WebAudioParamDescriptor,
+}
+pub type EmscriptenWorkletProcessorCreatedCallback = ::core::option::Option<
+    unsafe extern "C" fn(
+        audioContext: EMSCRIPTEN_WEBAUDIO_T,
+        success: ::core::ffi::c_int,
+        userData3: *mut ::core::ffi::c_void,
+    ),
+>;
+extern "C" {
+    pub fn emscripten_create_wasm_audio_worklet_processor_async(
+        audioContext: EMSCRIPTEN_WEBAUDIO_T,
+        options: *const WebAudioWorkletProcessorCreateOptions,
+        callback: EmscriptenWorkletProcessorCreatedCallback,
+        userData3: *mut ::core::ffi::c_void,
+    );
+}
+pub type EMSCRIPTEN_AUDIO_WORKLET_NODE_T = ::core::ffi::c_int;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct AudioSampleFrame {
+    pub numberOfChannels: ::core::ffi::c_int,
+    pub data: *mut f32,
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct AudioParamFrame {
+    pub length: ::core::ffi::c_int,
+    pub data: *mut f32,
+}
+pub type EmscriptenWorkletNodeProcessCallback = ::core::option::Option<
+    unsafe extern "C" fn(
+        numInputs: ::core::ffi::c_int,
+        inputs: *const AudioSampleFrame,
+        numOutputs: ::core::ffi::c_int,
+        outputs: *mut AudioSampleFrame,
+        numParams: ::core::ffi::c_int,
+        params: *const AudioParamFrame,
+        userData4: *mut ::core::ffi::c_void,
+    ) -> ::core::ffi::c_int,
+>;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct EmscriptenAudioWorkletNodeCreateOptions {
+    pub numberOfInputs: ::core::ffi::c_int,
+    pub numberOfOutputs: ::core::ffi::c_int,
+    pub outputChannelCounts: *mut ::core::ffi::c_int,
+}
+extern "C" {
+    pub fn emscripten_create_wasm_audio_worklet_node(
+        audioContext: EMSCRIPTEN_WEBAUDIO_T,
+        name: *const ::core::ffi::c_char,
+        options: *const EmscriptenAudioWorkletNodeCreateOptions,
+        processCallback: EmscriptenWorkletNodeProcessCallback,
+        userData4: *mut ::core::ffi::c_void,
+    ) -> EMSCRIPTEN_AUDIO_WORKLET_NODE_T;
+}
+extern "C" {
+    pub fn emscripten_current_thread_is_audio_worklet() -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_audio_worklet_post_function_v(
+        id: EMSCRIPTEN_WEBAUDIO_T,
+        funcPtr: ::core::option::Option<unsafe extern "C" fn()>,
+    );
+}
+extern "C" {
+    pub fn emscripten_audio_worklet_post_function_vi(
+        id: EMSCRIPTEN_WEBAUDIO_T,
+        funcPtr: ::core::option::Option<unsafe extern "C" fn(arg1: ::core::ffi::c_int)>,
+        arg0: ::core::ffi::c_int,
+    );
+}
+extern "C" {
+    pub fn emscripten_audio_worklet_post_function_vii(
+        id: EMSCRIPTEN_WEBAUDIO_T,
+        funcPtr: ::core::option::Option<
+            unsafe extern "C" fn(arg1: ::core::ffi::c_int, arg2: ::core::ffi::c_int),
+        >,
+        arg0: ::core::ffi::c_int,
+        arg1: ::core::ffi::c_int,
+    );
+}
+extern "C" {
+    pub fn emscripten_audio_worklet_post_function_viii(
+        id: EMSCRIPTEN_WEBAUDIO_T,
+        funcPtr: ::core::option::Option<
+            unsafe extern "C" fn(
+                arg1: ::core::ffi::c_int,
+                arg2: ::core::ffi::c_int,
+                arg3: ::core::ffi::c_int,
+            ),
+        >,
+        arg0: ::core::ffi::c_int,
+        arg1: ::core::ffi::c_int,
+        arg2: ::core::ffi::c_int,
+    );
+}
+extern "C" {
+    pub fn emscripten_audio_worklet_post_function_vd(
+        id: EMSCRIPTEN_WEBAUDIO_T,
+        funcPtr: ::core::option::Option<unsafe extern "C" fn(arg1: f64)>,
+        arg0: f64,
+    );
+}
+extern "C" {
+    pub fn emscripten_audio_worklet_post_function_vdd(
+        id: EMSCRIPTEN_WEBAUDIO_T,
+        funcPtr: ::core::option::Option<unsafe extern "C" fn(arg1: f64, arg2: f64)>,
+        arg0: f64,
+        arg1: f64,
+    );
+}
+extern "C" {
+    pub fn emscripten_audio_worklet_post_function_vddd(
+        id: EMSCRIPTEN_WEBAUDIO_T,
+        funcPtr: ::core::option::Option<unsafe extern "C" fn(arg1: f64, arg2: f64, arg3: f64)>,
+        arg0: f64,
+        arg1: f64,
+        arg2: f64,
+    );
+}
+extern "C" {
+    pub fn emscripten_audio_worklet_post_function_sig(
+        id: EMSCRIPTEN_WEBAUDIO_T,
+        funcPtr: *mut ::core::ffi::c_void,
+        sig: *const ::core::ffi::c_char,
+        ...
+    );
+}
@@ -0,0 +1,182 @@
+pub use crate::pthread::{__pthread, pthread_t};
+pub type EMSCRIPTEN_RESULT = ::core::ffi::c_int;
+pub type EM_BOOL = ::core::ffi::c_int;
+pub type EMSCRIPTEN_WEBSOCKET_T = ::core::ffi::c_int;
+extern "C" {
+    pub fn emscripten_websocket_get_ready_state(
+        socket: ::core::ffi::c_int,
+        readyState: *mut ::core::ffi::c_ushort,
+    ) -> EMSCRIPTEN_RESULT;
+}
+extern "C" {
+    pub fn emscripten_websocket_get_buffered_amount(
+        socket: ::core::ffi::c_int,
+        bufferedAmount: *mut usize,
+    ) -> EMSCRIPTEN_RESULT;
+}
+extern "C" {
+    pub fn emscripten_websocket_get_url(
+        socket: ::core::ffi::c_int,
+        url: *mut ::core::ffi::c_char,
+        urlLength: ::core::ffi::c_int,
+    ) -> EMSCRIPTEN_RESULT;
+}
+extern "C" {
+    pub fn emscripten_websocket_get_url_length(
+        socket: ::core::ffi::c_int,
+        urlLength: *mut ::core::ffi::c_int,
+    ) -> EMSCRIPTEN_RESULT;
+}
+extern "C" {
+    pub fn emscripten_websocket_get_extensions(
+        socket: ::core::ffi::c_int,
+        extensions: *mut ::core::ffi::c_char,
+        extensionsLength: ::core::ffi::c_int,
+    ) -> EMSCRIPTEN_RESULT;
+}
+extern "C" {
+    pub fn emscripten_websocket_get_extensions_length(
+        socket: ::core::ffi::c_int,
+        extensionsLength: *mut ::core::ffi::c_int,
+    ) -> EMSCRIPTEN_RESULT;
+}
+extern "C" {
+    pub fn emscripten_websocket_get_protocol(
+        socket: ::core::ffi::c_int,
+        protocol: *mut ::core::ffi::c_char,
+        protocolLength: ::core::ffi::c_int,
+    ) -> EMSCRIPTEN_RESULT;
+}
+extern "C" {
+    pub fn emscripten_websocket_get_protocol_length(
+        socket: ::core::ffi::c_int,
+        protocolLength: *mut ::core::ffi::c_int,
+    ) -> EMSCRIPTEN_RESULT;
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct EmscriptenWebSocketOpenEvent {
+    pub socket: ::core::ffi::c_int,
+}
+pub type em_websocket_open_callback_func = ::core::option::Option<
+    unsafe extern "C" fn(
+        eventType: ::core::ffi::c_int,
+        websocketEvent: *const EmscriptenWebSocketOpenEvent,
+        userData: *mut ::core::ffi::c_void,
+    ) -> EM_BOOL,
+>;
+extern "C" {
+    pub fn emscripten_websocket_set_onopen_callback_on_thread(
+        socket: ::core::ffi::c_int,
+        userData: *mut ::core::ffi::c_void,
+        callback: em_websocket_open_callback_func,
+        targetThread: pthread_t,
+    ) -> EMSCRIPTEN_RESULT;
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct EmscriptenWebSocketMessageEvent {
+    pub socket: ::core::ffi::c_int,
+    pub data: *mut u8,
+    pub numBytes: u32,
+    pub isText: EM_BOOL,
+}
+pub type em_websocket_message_callback_func = ::core::option::Option<
+    unsafe extern "C" fn(
+        eventType: ::core::ffi::c_int,
+        websocketEvent: *const EmscriptenWebSocketMessageEvent,
+        userData: *mut ::core::ffi::c_void,
+    ) -> EM_BOOL,
+>;
+extern "C" {
+    pub fn emscripten_websocket_set_onmessage_callback_on_thread(
+        socket: ::core::ffi::c_int,
+        userData: *mut ::core::ffi::c_void,
+        callback: em_websocket_message_callback_func,
+        targetThread: pthread_t,
+    ) -> EMSCRIPTEN_RESULT;
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct EmscriptenWebSocketErrorEvent {
+    pub socket: ::core::ffi::c_int,
+}
+pub type em_websocket_error_callback_func = ::core::option::Option<
+    unsafe extern "C" fn(
+        eventType: ::core::ffi::c_int,
+        websocketEvent: *const EmscriptenWebSocketErrorEvent,
+        userData: *mut ::core::ffi::c_void,
+    ) -> EM_BOOL,
+>;
+extern "C" {
+    pub fn emscripten_websocket_set_onerror_callback_on_thread(
+        socket: ::core::ffi::c_int,
+        userData: *mut ::core::ffi::c_void,
+        callback: em_websocket_error_callback_func,
+        targetThread: pthread_t,
+    ) -> EMSCRIPTEN_RESULT;
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct EmscriptenWebSocketCloseEvent {
+    pub socket: ::core::ffi::c_int,
+    pub wasClean: EM_BOOL,
+    pub code: ::core::ffi::c_ushort,
+    pub reason: [::core::ffi::c_char; 512usize],
+}
+pub type em_websocket_close_callback_func = ::core::option::Option<
+    unsafe extern "C" fn(
+        eventType: ::core::ffi::c_int,
+        websocketEvent: *const EmscriptenWebSocketCloseEvent,
+        userData: *mut ::core::ffi::c_void,
+    ) -> EM_BOOL,
+>;
+extern "C" {
+    pub fn emscripten_websocket_set_onclose_callback_on_thread(
+        socket: ::core::ffi::c_int,
+        userData: *mut ::core::ffi::c_void,
+        callback: em_websocket_close_callback_func,
+        targetThread: pthread_t,
+    ) -> EMSCRIPTEN_RESULT;
+}
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct EmscriptenWebSocketCreateAttributes {
+    pub url: *const ::core::ffi::c_char,
+    pub protocols: *const ::core::ffi::c_char,
+    pub createOnMainThread: EM_BOOL,
+}
+extern "C" {
+    pub fn emscripten_websocket_is_supported() -> EM_BOOL;
+}
+extern "C" {
+    pub fn emscripten_websocket_new(
+        createAttributes: *mut EmscriptenWebSocketCreateAttributes,
+    ) -> ::core::ffi::c_int;
+}
+extern "C" {
+    pub fn emscripten_websocket_send_utf8_text(
+        socket: ::core::ffi::c_int,
+        textData: *const ::core::ffi::c_char,
+    ) -> EMSCRIPTEN_RESULT;
+}
+extern "C" {
+    pub fn emscripten_websocket_send_binary(
+        socket: ::core::ffi::c_int,
+        binaryData: *mut ::core::ffi::c_void,
+        dataLength: u32,
+    ) -> EMSCRIPTEN_RESULT;
+}
+extern "C" {
+    pub fn emscripten_websocket_close(
+        socket: ::core::ffi::c_int,
+        code: ::core::ffi::c_ushort,
+        reason: *const ::core::ffi::c_char,
+    ) -> EMSCRIPTEN_RESULT;
+}
+extern "C" {
+    pub fn emscripten_websocket_delete(socket: ::core::ffi::c_int) -> EMSCRIPTEN_RESULT;
+}
+extern "C" {
+    pub fn emscripten_websocket_deinitialize();
+}
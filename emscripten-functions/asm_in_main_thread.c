@@ -1,4 +1,9 @@
 #include <emscripten.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __EMSCRIPTEN_PTHREADS__
+#include <emscripten/threading.h>
+#endif
 
 void asm_in_main_thread(char *script) {
     MAIN_THREAD_EM_ASM("eval(UTF8ToString($0))", script);
@@ -11,3 +16,56 @@ int asm_in_main_thread_int(char *script) {
 double asm_in_main_thread_double(char *script) {
     return MAIN_THREAD_EM_ASM_DOUBLE("eval(UTF8ToString($0))", script);
 }
+
+// The snippets run with arguments are compiled once, on the main thread, into a JS function whose parameters are named `$0` to `$15`.
+// They are cached in a map keyed by the address of their source, which must be static.
+
+int asm_in_main_thread_args_int(const char *script, const double *args, int count) {
+    return MAIN_THREAD_EM_ASM_INT("\
+        var cache = Module['emscriptenFunctionsSnippets'] || (Module['emscriptenFunctionsSnippets'] = new Map()); \
+        var func = cache.get($0); \
+        if (!func) { \
+            func = new Function('$0', '$1', '$2', '$3', '$4', '$5', '$6', '$7', \
+                '$8', '$9', '$10', '$11', '$12', '$13', '$14', '$15', UTF8ToString($0)); \
+            cache.set($0, func); \
+        } \
+        return func.apply(null, HEAPF64.subarray($1 >>> 3, ($1 >>> 3) + $2)) | 0;", script, args, count);
+}
+
+double asm_in_main_thread_args_double(const char *script, const double *args, int count) {
+    return MAIN_THREAD_EM_ASM_DOUBLE("\
+        var cache = Module['emscriptenFunctionsSnippets'] || (Module['emscriptenFunctionsSnippets'] = new Map()); \
+        var func = cache.get($0); \
+        if (!func) { \
+            func = new Function('$0', '$1', '$2', '$3', '$4', '$5', '$6', '$7', \
+                '$8', '$9', '$10', '$11', '$12', '$13', '$14', '$15', UTF8ToString($0)); \
+            cache.set($0, func); \
+        } \
+        return +func.apply(null, HEAPF64.subarray($1 >>> 3, ($1 >>> 3) + $2));", script, args, count);
+}
+
+// Runs on the main thread; the script was allocated by the caller, and its ownership was passed to us.
+static void eval_and_free(char *script) {
+    EM_ASM("eval(UTF8ToString($0))", script);
+    free(script);
+}
+
+// Returns -1 if the copy of the script couldn't be allocated, in which case it isn't run, and 0 otherwise.
+int asm_in_main_thread_async(const char *script_str, size_t len) {
+    // The script is copied as it must outlive this call, which can return before the main thread runs it.
+    char *script = malloc(len + 1);
+    if (!script) {
+        return -1;
+    }
+    memcpy(script, script_str, len);
+    script[len] = 0;
+
+#ifdef __EMSCRIPTEN_PTHREADS__
+    if (!emscripten_is_main_runtime_thread()) {
+        emscripten_async_run_in_main_runtime_thread(EM_FUNC_SIG_VI, eval_and_free, script);
+        return 0;
+    }
+#endif
+    eval_and_free(script);
+    return 0;
+}
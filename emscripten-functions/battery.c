@@ -0,0 +1,55 @@
+#include <emscripten.h>
+
+// Listens to the battery's state with the Battery Status API's `navigator.getBattery()`. Emscripten's own battery functions use the
+// `navigator.battery` object of its first draft, which the browsers dropped. The callback gets 1 or 0 for charging, and the level
+// from 0 to 1: once with the initial state, then on each `chargingchange` and `levelchange` event.
+// Returns a listener identifier, or 0 where the API is missing (Firefox, Safari).
+
+typedef void (*battery_callback)(void *arg, int charging, double level);
+
+EM_JS(int, battery_listen_js, (battery_callback callback, void *arg), {
+    if (typeof navigator == "undefined" || !navigator.getBattery) {
+        return 0;
+    }
+    var listeners = Module["emscriptenFunctionsBattery"] = Module["emscriptenFunctionsBattery"] || { next: 1, active: {} };
+    var id = listeners.next++;
+    var listener = { battery: null, handler: null };
+    listeners.active[id] = listener;
+
+    navigator.getBattery().then(function (battery) {
+        if (!listeners.active[id]) {
+            return;
+        }
+        listener.battery = battery;
+        listener.handler = function () {
+            _battery_done(callback, arg, battery.charging ? 1 : 0, battery.level);
+        };
+        battery.addEventListener("chargingchange", listener.handler);
+        battery.addEventListener("levelchange", listener.handler);
+        listener.handler();
+    }, function () {
+        delete listeners.active[id];
+    });
+    return id;
+});
+
+EMSCRIPTEN_KEEPALIVE void battery_done(battery_callback callback, void *arg, int charging, double level) {
+    callback(arg, charging, level);
+}
+
+EM_JS(void, battery_unlisten, (int id), {
+    var listeners = Module["emscriptenFunctionsBattery"];
+    var listener = listeners && listeners.active[id];
+    if (!listener) {
+        return;
+    }
+    delete listeners.active[id];
+    if (listener.battery) {
+        listener.battery.removeEventListener("chargingchange", listener.handler);
+        listener.battery.removeEventListener("levelchange", listener.handler);
+    }
+});
+
+int battery_listen(battery_callback callback, void *arg) {
+    return battery_listen_js(callback, arg);
+}
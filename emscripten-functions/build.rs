@@ -1,7 +1,137 @@
+// Compiles the C shim of the given name. With the `cross_language_lto` feature, it's compiled to LLVM bitcode
+// that the linker optimizes with the rust code, which must then be built with `-C linker-plugin-lto`.
+fn build_shim(name: &str) {
+    let mut build = cc::Build::new();
+    build.file(format!("{}.c", name));
+    if std::env::var("CARGO_FEATURE_CROSS_LANGUAGE_LTO").is_ok() {
+        build.flag("-flto");
+    }
+    build.compile(name);
+}
+
+// The emscripten settings exported to the crate when they're known at compile time, parsed from the `-s` link arguments
+// given in the rust flags (e.g. `-C link-arg=-sASYNCIFY`) or in `EMCC_CFLAGS`, each with its cfg flag if it's enabled.
+const SETTINGS: &[(&str, Option<&str>)] = &[
+    (
+        "ALLOW_MEMORY_GROWTH",
+        Some("emscripten_allow_memory_growth"),
+    ),
+    ("ASYNCIFY", Some("emscripten_asyncify")),
+    ("INITIAL_MEMORY", None),
+    ("MAXIMUM_MEMORY", None),
+    ("PTHREAD_POOL_SIZE", None),
+    ("STACK_SIZE", None),
+];
+
+// Returns the `NAME=value` of each `-s` argument, `-sNAME` standing for `NAME=1`.
+fn link_settings() -> Vec<(String, String)> {
+    let mut args = Vec::new();
+    let rustflags = std::env::var("CARGO_ENCODED_RUSTFLAGS").unwrap_or_default();
+    let mut flags = rustflags.split('\x1f').filter(|flag| !flag.is_empty());
+    while let Some(flag) = flags.next() {
+        let flag = match flag {
+            "-C" => flags.next().unwrap_or_default(),
+            _ => flag.strip_prefix("-C").unwrap_or(""),
+        };
+        if let Some(arg) = flag.strip_prefix("link-arg=") {
+            args.push(arg.to_string());
+        } else if let Some(list) = flag.strip_prefix("link-args=") {
+            args.extend(list.split_whitespace().map(String::from));
+        }
+    }
+    let emcc_cflags = std::env::var("EMCC_CFLAGS").unwrap_or_default();
+    args.extend(emcc_cflags.split_whitespace().map(String::from));
+
+    let mut settings = Vec::new();
+    let mut args = args.into_iter();
+    while let Some(arg) = args.next() {
+        let setting = match arg.as_str() {
+            "-s" => args.next().unwrap_or_default(),
+            _ => match arg.strip_prefix("-s") {
+                Some(setting) => setting.to_string(),
+                None => continue,
+            },
+        };
+        let (name, value) = setting.split_once('=').unwrap_or((&setting, "1"));
+        settings.push((name.to_string(), value.to_string()));
+    }
+    settings
+}
+
+// The later arguments override the earlier ones, as with emcc.
+fn export_settings() {
+    println!("cargo:rerun-if-env-changed=EMCC_CFLAGS");
+    let settings = link_settings();
+    for (name, cfg) in SETTINGS {
+        if let Some(cfg) = cfg {
+            println!("cargo:rustc-check-cfg=cfg({})", cfg);
+        }
+        let Some((_, value)) = settings.iter().rev().find(|(setting, _)| setting == name) else {
+            continue;
+        };
+        println!(
+            "cargo:rustc-env=EMSCRIPTEN_FUNCTIONS_SETTING_{}={}",
+            name, value
+        );
+        if let Some(cfg) = cfg {
+            if value != "0" {
+                println!("cargo:rustc-cfg={}", cfg);
+            }
+        }
+    }
+}
+
 fn main() {
-    if !std::env::var("DOCS_RS").is_ok() {
-        cc::Build::new()
-            .file("asm_in_main_thread.c")
-            .compile("asm_in_main_thread");
+    export_settings();
+
+    // The C shims are only used by the modules that need std.
+    if !std::env::var("DOCS_RS").is_ok() && std::env::var("CARGO_FEATURE_STD").is_ok() {
+        if std::env::var("CARGO_FEATURE_MAIN_THREAD_SCRIPT").is_ok() {
+            build_shim("asm_in_main_thread");
+        }
+        build_shim("battery");
+        build_shim("capabilities");
+        if std::env::var("CARGO_FEATURE_CONSOLE").is_ok() {
+            build_shim("console_n");
+        }
+        build_shim("decompress");
+        build_shim("display");
+        build_shim("dom_batch");
+        build_shim("gamepad");
+        if std::env::var("CARGO_FEATURE_IDB").is_ok() {
+            build_shim("idb");
+        }
+        build_shim("idle");
+        build_shim("image");
+        build_shim("long_tasks");
+        build_shim("memory");
+        build_shim("metrics");
+        if std::env::var("CARGO_FEATURE_IDB").is_ok() {
+            build_shim("modules");
+        }
+        if std::env::var("CARGO_FEATURE_WEBGL").is_ok() {
+            build_shim("offscreen");
+        }
+        build_shim("page_lifecycle");
+        build_shim("passive_events");
+        if std::env::var("CARGO_FEATURE_PERF").is_ok() {
+            build_shim("perf");
+        }
+        build_shim("pointer");
+        build_shim("pointer_lock");
+        build_shim("post_task");
+        build_shim("preload_hints");
+        build_shim("script");
+        build_shim("sensors");
+        build_shim("startup");
+        build_shim("storage");
+        build_shim("tabs");
+        build_shim("threading");
+        build_shim("webaudio");
+        build_shim("webgpu_staging");
+        if std::env::var("CARGO_FEATURE_WEBGL").is_ok() {
+            build_shim("webgl");
+        }
+        build_shim("wget");
     }
 }
@@ -0,0 +1,27 @@
+#include <emscripten.h>
+
+// Detects the browser features the program can use at runtime, as a bitmask of:
+// 1: `SharedArrayBuffer`, 2: cross-origin isolation, 4: wasm SIMD, 8: WebGPU (`navigator.gpu`).
+
+EM_JS(int, capabilities_detect_js, (void), {
+    var flags = 0;
+    if (typeof SharedArrayBuffer != "undefined") {
+        flags |= 1;
+    }
+    if (typeof crossOriginIsolated != "undefined" && crossOriginIsolated) {
+        flags |= 2;
+    }
+    // The smallest module using a SIMD instruction (`i8x16.splat`), which only validates if the engine supports SIMD.
+    var simd = new Uint8Array([0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0, 10, 10, 1, 8, 0, 65, 0, 253, 15, 253, 98, 11]);
+    if (typeof WebAssembly == "object" && WebAssembly.validate(simd)) {
+        flags |= 4;
+    }
+    if (typeof navigator != "undefined" && navigator.gpu) {
+        flags |= 8;
+    }
+    return flags;
+});
+
+int capabilities_detect(void) {
+    return capabilities_detect_js();
+}
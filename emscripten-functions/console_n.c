@@ -0,0 +1,34 @@
+#include <emscripten.h>
+#include <stddef.h>
+
+// Length-delimited counterparts of `emscripten_console_log/warn/error`, like `emscripten_outn` and friends.
+// The string doesn't need to be NUL-terminated, as `UTF8ToString` stops after `len` bytes.
+
+void console_log_n(const char *string, size_t len) {
+    EM_ASM("console.log(UTF8ToString($0, $1))", string, len);
+}
+
+void console_warn_n(const char *string, size_t len) {
+    EM_ASM("console.warn(UTF8ToString($0, $1))", string, len);
+}
+
+void console_error_n(const char *string, size_t len) {
+    EM_ASM("console.error(UTF8ToString($0, $1))", string, len);
+}
+
+// The `console.time` and `console.count` families, with labels identified by number.
+// Each thread's JS keeps the labels it decoded by id, so a label's string is only read from the wasm memory on its first use there.
+// The methods are, in order: `time`, `timeEnd`, `timeLog`, `count` and `countReset`.
+
+EM_JS(void, console_label_call_js, (int method, int id, const char *label, size_t len), {
+    var labels = Module["emscriptenFunctionsConsoleLabels"] || (Module["emscriptenFunctionsConsoleLabels"] = []);
+    var name = labels[id];
+    if (name === undefined) {
+        name = labels[id] = UTF8ToString(label, len);
+    }
+    console[["time", "timeEnd", "timeLog", "count", "countReset"][method]](name);
+});
+
+void console_label_call(int method, int id, const char *label, size_t len) {
+    console_label_call_js(method, id, label, len);
+}
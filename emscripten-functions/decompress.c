@@ -0,0 +1,100 @@
+#include <stdlib.h>
+#include <emscripten.h>
+
+// Decompresses with the browser's native `DecompressionStream`, which runs outside of the wasm threads.
+// The streams are kept in a JS table, keyed by the id returned by `decompress_create_js`. Each decompressed chunk is copied
+// into a buffer of the wasm heap and given to `output`; `done` is called once, with 1 when the stream ended,
+// 0 when the data was invalid, and 2 when it was aborted, after which nothing else is called.
+// The format is 0 for `gzip`, 1 for `deflate` and 2 for `deflate-raw`.
+
+typedef void (*decompress_output_callback)(void *arg, const void *data, int size);
+typedef void (*decompress_done_callback)(void *arg, int result);
+
+EM_JS(int, decompress_create_js, (int format, decompress_output_callback output, decompress_done_callback done, void *arg), {
+    if (typeof DecompressionStream == "undefined") {
+        return 0;
+    }
+    var streams = Module["emscriptenFunctionsDecompressors"] || (Module["emscriptenFunctionsDecompressors"] = { next: 1, entries: {} });
+    var id = streams.next++;
+    var stream = new DecompressionStream(["gzip", "deflate", "deflate-raw"][format]);
+    var entry = { writer: stream.writable.getWriter(), aborted: false };
+    streams.entries[id] = entry;
+
+    var reader = stream.readable.getReader();
+    var finish = function (result) {
+        delete streams.entries[id];
+        _decompress_done(done, arg, result);
+    };
+    var pump = function () {
+        reader.read().then(function (chunk) {
+            if (entry.aborted) {
+                finish(2);
+            } else if (chunk.done) {
+                finish(1);
+            } else {
+                var ptr = _decompress_alloc(chunk.value.length) >>> 0;
+                HEAPU8.set(chunk.value, ptr);
+                _decompress_output(output, arg, ptr, chunk.value.length);
+                pump();
+            }
+        }, function () {
+            finish(entry.aborted ? 2 : 0);
+        });
+    };
+    pump();
+    return id;
+});
+
+// The errors are reported by the reader, so the writer's rejected promises are ignored.
+EM_JS(void, decompress_write_js, (int id, const void *data, int size), {
+    var entry = Module["emscriptenFunctionsDecompressors"].entries[id];
+    // The stream keeps the chunk until it's decompressed, so it's copied out of the heap.
+    // The entry is gone if the stream already failed.
+    if (entry) {
+        entry.writer.write(HEAPU8.slice(data >>> 0, (data >>> 0) + size)).catch(function () {});
+    }
+});
+
+EM_JS(void, decompress_close_js, (int id), {
+    var entry = Module["emscriptenFunctionsDecompressors"].entries[id];
+    if (entry) {
+        entry.writer.close().catch(function () {});
+    }
+});
+
+EM_JS(void, decompress_abort_js, (int id), {
+    var entry = Module["emscriptenFunctionsDecompressors"].entries[id];
+    if (entry) {
+        entry.aborted = true;
+        entry.writer.abort().catch(function () {});
+    }
+});
+
+EMSCRIPTEN_KEEPALIVE void *decompress_alloc(int size) {
+    return malloc(size);
+}
+
+EMSCRIPTEN_KEEPALIVE void decompress_output(decompress_output_callback output, void *arg, void *data, int size) {
+    output(arg, data, size);
+    free(data);
+}
+
+EMSCRIPTEN_KEEPALIVE void decompress_done(decompress_done_callback done, void *arg, int result) {
+    done(arg, result);
+}
+
+int decompress_create(int format, decompress_output_callback output, decompress_done_callback done, void *arg) {
+    return decompress_create_js(format, output, done, arg);
+}
+
+void decompress_write(int id, const void *data, int size) {
+    decompress_write_js(id, data, size);
+}
+
+void decompress_close(int id) {
+    decompress_close_js(id);
+}
+
+void decompress_abort(int id) {
+    decompress_abort_js(id);
+}
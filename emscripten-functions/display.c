@@ -0,0 +1,49 @@
+#include <emscripten.h>
+
+// Watches the device pixel ratio, with a `matchMedia("(resolution: Xdppx)")` query re-armed with the new ratio on each change,
+// and the screen size, on the window's `resize` events. The callback gets the ratio and the screen's width and height, as given
+// by `emscripten_get_screen_size`: once at the start, then each time one of them changed. It's only called on the main browser thread.
+
+typedef void (*display_callback)(double ratio, int width, int height);
+
+EM_JS(void, display_listen_js, (display_callback callback), {
+    if (typeof window == "undefined") {
+        return;
+    }
+    var last = null;
+    var report = function () {
+        var current = [window.devicePixelRatio || 1, screen.width | 0, screen.height | 0];
+        if (!last || current.some(function (value, index) { return value !== last[index]; })) {
+            last = current;
+            _display_done(callback, current[0], current[1], current[2]);
+        }
+    };
+
+    var query = null;
+    var onchange = function () {
+        watch();
+        report();
+    };
+    var watch = function () {
+        if (!window.matchMedia) {
+            return;
+        }
+        if (query) {
+            query.removeEventListener ? query.removeEventListener("change", onchange) : query.removeListener(onchange);
+        }
+        query = window.matchMedia("(resolution: " + (window.devicePixelRatio || 1) + "dppx)");
+        query.addEventListener ? query.addEventListener("change", onchange) : query.addListener(onchange);
+    };
+
+    window.addEventListener("resize", report);
+    watch();
+    report();
+});
+
+EMSCRIPTEN_KEEPALIVE void display_done(display_callback callback, double ratio, int width, int height) {
+    callback(ratio, width, height);
+}
+
+void display_listen(display_callback callback) {
+    display_listen_js(callback);
+}
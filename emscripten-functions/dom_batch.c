@@ -0,0 +1,57 @@
+#include <emscripten.h>
+
+// Applies the DOM commands recorded by a rust `DomBatch`, in one call.
+// The commands are 32-bit words: an opcode, the handle of the target node, then its operands.
+// Strings are an offset into the batch's string buffer and a length, in bytes.
+// The nodes are looked up in the handle table of the script module; the commands of released handles are skipped.
+
+EM_JS(void, dom_batch_apply_js, (const unsigned int *commands, int count, const char *strings), {
+    var handles = Module["emscriptenFunctionsHandles"].table;
+    // The memory can have been grown by another thread since the last batch, leaving `HEAPU32` stale.
+    Module["emscriptenFunctionsHeap"].refresh();
+    var string = function (at) {
+        return UTF8ToString((strings >>> 0) + HEAPU32[at], HEAPU32[at + 1]);
+    };
+    // The number of words of each command.
+    var sizes = [4, 6, 4, 6, 5, 3, 2];
+
+    var i = commands >>> 2;
+    var end = i + count;
+    while (i < end) {
+        var op = HEAPU32[i];
+        var node = handles[HEAPU32[i + 1]];
+        if (node) {
+            switch (op) {
+                case 0:
+                    node.textContent = string(i + 2);
+                    break;
+                case 1:
+                    node.setAttribute(string(i + 2), string(i + 4));
+                    break;
+                case 2:
+                    node.removeAttribute(string(i + 2));
+                    break;
+                case 3:
+                    node.style.setProperty(string(i + 2), string(i + 4));
+                    break;
+                case 4:
+                    node.classList.toggle(string(i + 2), HEAPU32[i + 4] != 0);
+                    break;
+                case 5:
+                    var child = handles[HEAPU32[i + 2]];
+                    if (child) {
+                        node.appendChild(child);
+                    }
+                    break;
+                case 6:
+                    node.remove();
+                    break;
+            }
+        }
+        i += sizes[op];
+    }
+});
+
+void dom_batch_apply(const unsigned int *commands, int count, const char *strings) {
+    dom_batch_apply_js(commands, count, strings);
+}
@@ -0,0 +1,51 @@
+//! Checks that emcc extracts the code of the `em_js!` and `em_asm!` macros from the link sections rustc emits.
+//!
+//! Build and run it with `cargo run --example em_asm_link --features em_asm`, with node as the runner.
+//! A missing `em_js` function fails the link with an undefined symbol, and a missing `em_asm` snippet aborts at run time;
+//! otherwise, it checks the results of the snippets, and prints a line saying they passed.
+
+#[cfg(target_os = "emscripten")]
+emscripten_functions::em_js! {
+    fn em_asm_link_add(a: i32, b: i32) -> i32 {
+        "return a + b;"
+    }
+}
+
+#[cfg(target_os = "emscripten")]
+fn main() {
+    use emscripten_functions::{
+        em_asm, em_asm_double, em_asm_int, main_thread_em_asm_double, main_thread_em_asm_int,
+    };
+
+    unsafe {
+        assert_eq!(em_asm_link_add(2, 3), 5, "em_js!");
+        em_asm!("globalThis.emAsmLinkValue = $0;", 7i32);
+        assert_eq!(
+            em_asm_int!("return globalThis.emAsmLinkValue * $0;", 6i32),
+            42,
+            "em_asm_int!"
+        );
+        assert_eq!(
+            em_asm_double!("return $0 / 2;", 3.0f64),
+            1.5,
+            "em_asm_double!"
+        );
+        assert_eq!(
+            main_thread_em_asm_int!("return $0 + 1;", 41i32),
+            42,
+            "main_thread_em_asm_int!"
+        );
+        assert_eq!(
+            main_thread_em_asm_double!("return $0 * 2;", 0.25f64),
+            0.5,
+            "main_thread_em_asm_double!"
+        );
+    }
+    println!("em_asm link check passed");
+}
+
+#[cfg(not(target_os = "emscripten"))]
+fn main() {
+    eprintln!("the check runs on the wasm32-unknown-emscripten target only");
+    std::process::exit(1);
+}
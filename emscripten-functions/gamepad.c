@@ -0,0 +1,44 @@
+#include <emscripten.h>
+
+// Samples all the gamepads with a single `navigator.getGamepads()` call, writing their state straight into rust-side
+// `GamepadState` structs (`src/gamepads.rs`), instead of one `emscripten_get_gamepad_status` call and event struct copy per pad.
+// A state is `#[repr(C)]`, 216 bytes: timestamp (f64, offset 0), connected (i32, 8), num_axes (i32, 12), num_buttons (i32, 16),
+// pressed (u32 bitmask, 20), axes ([f32; 16], 24), buttons ([f32; 32], 88).
+
+EM_JS(int, gamepads_sample_js, (void *states, int max_pads), {
+    var pads = navigator.getGamepads ? navigator.getGamepads() : [];
+    for (var i = 0; i < max_pads; i++) {
+        var base = (states >>> 0) + i * 216;
+        var pad = i < pads.length ? pads[i] : null;
+        if (!pad || !pad.connected) {
+            HEAP32[(base + 8) >>> 2] = 0;
+            continue;
+        }
+
+        var numAxes = Math.min(pad.axes.length, 16);
+        var numButtons = Math.min(pad.buttons.length, 32);
+        HEAPF64[base >>> 3] = pad.timestamp;
+        HEAP32[(base + 8) >>> 2] = 1;
+        HEAP32[(base + 12) >>> 2] = numAxes;
+        HEAP32[(base + 16) >>> 2] = numButtons;
+        for (var a = 0; a < numAxes; a++) {
+            HEAPF32[((base + 24) >>> 2) + a] = pad.axes[a];
+        }
+        var pressed = 0;
+        for (var b = 0; b < numButtons; b++) {
+            var button = pad.buttons[b];
+            // Old browsers give numbers instead of `GamepadButton` objects.
+            var value = typeof button === "object" ? button.value : button;
+            HEAPF32[((base + 88) >>> 2) + b] = value;
+            if (typeof button === "object" ? button.pressed : value >= 0.5) {
+                pressed |= 1 << b;
+            }
+        }
+        HEAPU32[(base + 20) >>> 2] = pressed;
+    }
+    return pads.length;
+});
+
+int gamepads_sample(void *states, int max_pads) {
+    return gamepads_sample_js(states, max_pads);
+}
@@ -0,0 +1,186 @@
+#include <stdlib.h>
+#include <emscripten.h>
+
+// Stores or loads many keys in a single IndexedDB transaction, which emscripten's `emscripten_idb_async_store`
+// and `emscripten_idb_async_load` can't do: they open a transaction per key.
+// The database layout (version 22, one "FILE_DATA" object store) is the one emscripten's IDB functions use,
+// so that they can read the stored keys back.
+// The opened databases are cached by name.
+
+typedef void (*idb_batch_callback)(void *arg, int ok);
+
+EM_JS(void, idb_store_batch_js, (const char *db_name, const char *const *keys, const unsigned char *const *data, const int *sizes, int count, idb_batch_callback callback, void *arg), {
+    var name = UTF8ToString(db_name);
+    var entries = [];
+    for (var i = 0; i < count; i++) {
+        var ptr = HEAPU32[(data >>> 2) + i];
+        // The data is copied now, as rust frees it as soon as this function returns.
+        entries.push([UTF8ToString(HEAPU32[(keys >>> 2) + i]), HEAPU8.slice(ptr, ptr + HEAP32[(sizes >>> 2) + i])]);
+    }
+
+    var done = function (ok) {
+        _idb_store_batch_done(callback, arg, ok);
+    };
+    var store = function (db) {
+        var transaction;
+        try {
+            transaction = db.transaction(["FILE_DATA"], "readwrite");
+        } catch (e) {
+            done(0);
+            return;
+        }
+        var files = transaction.objectStore("FILE_DATA");
+        entries.forEach(function (entry) {
+            files.put(entry[1], entry[0]);
+        });
+        transaction.oncomplete = function () {
+            done(1);
+        };
+        transaction.onabort = function () {
+            done(0);
+        };
+    };
+
+    var dbs = Module["emscriptenFunctionsIdb"];
+    if (!dbs) {
+        dbs = Module["emscriptenFunctionsIdb"] = {};
+    }
+    if (dbs[name]) {
+        store(dbs[name]);
+        return;
+    }
+
+    var request;
+    try {
+        request = indexedDB.open(name, 22);
+    } catch (e) {
+        done(0);
+        return;
+    }
+    request.onupgradeneeded = function (e) {
+        var db = e.target.result;
+        if (!db.objectStoreNames.contains("FILE_DATA")) {
+            db.createObjectStore("FILE_DATA");
+        }
+    };
+    request.onsuccess = function () {
+        var db = request.result;
+        db.onversionchange = function () {
+            db.close();
+            delete dbs[name];
+        };
+        dbs[name] = db;
+        store(db);
+    };
+    request.onerror = function (e) {
+        e.preventDefault();
+        done(0);
+    };
+});
+
+EMSCRIPTEN_KEEPALIVE void idb_store_batch_done(idb_batch_callback callback, void *arg, int ok) {
+    callback(arg, ok);
+}
+
+void idb_store_batch(const char *db_name, const char *const *keys, const unsigned char *const *data, const int *sizes, int count, idb_batch_callback callback, void *arg) {
+    idb_store_batch_js(db_name, keys, data, sizes, count, callback, arg);
+}
+
+typedef void (*idb_item_callback)(void *arg, int index, const void *data, int size, int found);
+
+// Each key's data is given to `item` as soon as its request succeeds, in a buffer freed once `item` returns;
+// `found` is 0 for the missing keys. `callback` is called once the transaction ended.
+EM_JS(void, idb_load_batch_js, (const char *db_name, const char *const *keys, int count, idb_item_callback item, idb_batch_callback callback, void *arg), {
+    var name = UTF8ToString(db_name);
+    var names = [];
+    for (var i = 0; i < count; i++) {
+        names.push(UTF8ToString(HEAPU32[(keys >>> 2) + i]));
+    }
+
+    var done = function (ok) {
+        _idb_load_batch_done(callback, arg, ok);
+    };
+    var load = function (db) {
+        var transaction;
+        try {
+            transaction = db.transaction(["FILE_DATA"], "readonly");
+        } catch (e) {
+            done(0);
+            return;
+        }
+        var files = transaction.objectStore("FILE_DATA");
+        names.forEach(function (key, index) {
+            var request = files.get(key);
+            request.onsuccess = function () {
+                var value = request.result;
+                if (value === undefined) {
+                    _idb_load_batch_item(item, arg, index, 0, 0, 0);
+                    return;
+                }
+                var bytes = value instanceof ArrayBuffer ? new Uint8Array(value) : new Uint8Array(value.buffer, value.byteOffset, value.byteLength);
+                var ptr = _idb_load_batch_alloc(bytes.length) >>> 0;
+                HEAPU8.set(bytes, ptr);
+                _idb_load_batch_item(item, arg, index, ptr, bytes.length, 1);
+            };
+        });
+        transaction.oncomplete = function () {
+            done(1);
+        };
+        transaction.onabort = function () {
+            done(0);
+        };
+    };
+
+    var dbs = Module["emscriptenFunctionsIdb"];
+    if (!dbs) {
+        dbs = Module["emscriptenFunctionsIdb"] = {};
+    }
+    if (dbs[name]) {
+        load(dbs[name]);
+        return;
+    }
+
+    var request;
+    try {
+        request = indexedDB.open(name, 22);
+    } catch (e) {
+        done(0);
+        return;
+    }
+    request.onupgradeneeded = function (e) {
+        var db = e.target.result;
+        if (!db.objectStoreNames.contains("FILE_DATA")) {
+            db.createObjectStore("FILE_DATA");
+        }
+    };
+    request.onsuccess = function () {
+        var db = request.result;
+        db.onversionchange = function () {
+            db.close();
+            delete dbs[name];
+        };
+        dbs[name] = db;
+        load(db);
+    };
+    request.onerror = function (e) {
+        e.preventDefault();
+        done(0);
+    };
+});
+
+EMSCRIPTEN_KEEPALIVE void *idb_load_batch_alloc(int size) {
+    return malloc(size);
+}
+
+EMSCRIPTEN_KEEPALIVE void idb_load_batch_item(idb_item_callback item, void *arg, int index, void *data, int size, int found) {
+    item(arg, index, data, size, found);
+    free(data);
+}
+
+EMSCRIPTEN_KEEPALIVE void idb_load_batch_done(idb_batch_callback callback, void *arg, int ok) {
+    callback(arg, ok);
+}
+
+void idb_load_batch(const char *db_name, const char *const *keys, int count, idb_item_callback item, idb_batch_callback callback, void *arg) {
+    idb_load_batch_js(db_name, keys, count, item, callback, arg);
+}
@@ -0,0 +1,39 @@
+#include <emscripten.h>
+
+// Requests a `requestIdleCallback` call of the callback, with the given timeout in milliseconds (none if <= 0).
+// While the callback runs, its `IdleDeadline` is kept in `Module["emscriptenFunctionsIdleDeadline"]`, for `idle_time_remaining`.
+// Returns 0 if the browser doesn't have `requestIdleCallback` (e.g. Safari, or node), in which case nothing is requested.
+
+typedef void (*idle_callback)(void *arg, int did_timeout);
+
+EM_JS(int, idle_request_js, (idle_callback callback, void *arg, double timeout), {
+    if (typeof requestIdleCallback != "function") {
+        return 0;
+    }
+    requestIdleCallback(function (deadline) {
+        Module["emscriptenFunctionsIdleDeadline"] = deadline;
+        try {
+            _idle_done(callback, arg, deadline.didTimeout ? 1 : 0);
+        } finally {
+            Module["emscriptenFunctionsIdleDeadline"] = null;
+        }
+    }, timeout > 0 ? { timeout: timeout } : undefined);
+    return 1;
+});
+
+EM_JS(double, idle_time_remaining_js, (void), {
+    var deadline = Module["emscriptenFunctionsIdleDeadline"];
+    return deadline ? deadline.timeRemaining() : 0;
+});
+
+EMSCRIPTEN_KEEPALIVE void idle_done(idle_callback callback, void *arg, int did_timeout) {
+    callback(arg, did_timeout);
+}
+
+int idle_request(idle_callback callback, void *arg, double timeout) {
+    return idle_request_js(callback, arg, timeout);
+}
+
+double idle_time_remaining(void) {
+    return idle_time_remaining_js();
+}
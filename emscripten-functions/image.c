@@ -0,0 +1,14 @@
+#include <emscripten.h>
+
+// Forgets an image decoded by emscripten's preload plugins, whose canvas it otherwise keeps for the life of the program.
+// The table is missing only if the plugins never decoded anything, in which case there's nothing to forget:
+// the failed lookup of `emscripten_get_preloaded_image_data` already reported the error.
+EM_JS(void, image_release_preloaded_js, (const char *name), {
+    if (typeof preloadedImages != "undefined") {
+        delete preloadedImages[UTF8ToString(name)];
+    }
+});
+
+void image_release_preloaded(const char *name) {
+    image_release_preloaded_js(name);
+}
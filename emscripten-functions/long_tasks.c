@@ -0,0 +1,76 @@
+#include <emscripten.h>
+
+// Subscribes a `PerformanceObserver` to the `longtask` and `long-animation-frame` entries, the ones the browser supports,
+// and reports each entry by writing it into the rust-side `#[repr(C)]` record (`src/long_tasks.rs`) and calling the callback.
+// The record is 9 doubles: kind (0 for `longtask`, 1 for `long-animation-frame`), startTime, duration, blockingDuration, renderStart,
+// styleAndLayoutStart, the total duration of the frame's scripts, the total of their forced style and layout, and the part of it
+// spent in the scripts of the program's own JS file (the emscripten glue, which the wasm code runs under).
+// The observers are kept in `Module["emscriptenFunctionsLongTasks"]` by record address.
+// Returns a bitmask of the observed types: 1 for `longtask` and 2 for `long-animation-frame`.
+
+typedef void (*long_tasks_callback)(void *arg);
+
+EM_JS(int, long_tasks_observe_js, (double *record, long_tasks_callback callback, void *arg), {
+    if (typeof PerformanceObserver == "undefined") {
+        return 0;
+    }
+    var supported = PerformanceObserver.supportedEntryTypes || [];
+    var types = 0;
+    if (supported.indexOf("longtask") >= 0) types |= 1;
+    if (supported.indexOf("long-animation-frame") >= 0) types |= 2;
+    if (!types) {
+        return 0;
+    }
+
+    // The URL of this JS file, from the stack of the current call.
+    var ownScript = (/((?:https?|file|blob):[^\s()]+?\.js)/.exec(new Error().stack || "") || [])[1] || "";
+
+    var observer = new PerformanceObserver(function (list) {
+        list.getEntries().forEach(function (entry) {
+            var base = record >>> 3;
+            var scripts = entry.scripts || [];
+            var script = 0, forced = 0, own = 0;
+            scripts.forEach(function (s) {
+                script += s.duration;
+                forced += s.forcedStyleAndLayoutDuration || 0;
+                if (ownScript && s.sourceURL == ownScript) own += s.duration;
+            });
+            HEAPF64[base] = entry.entryType == "longtask" ? 0 : 1;
+            HEAPF64[base + 1] = entry.startTime;
+            HEAPF64[base + 2] = entry.duration;
+            HEAPF64[base + 3] = entry.blockingDuration || 0;
+            HEAPF64[base + 4] = entry.renderStart || 0;
+            HEAPF64[base + 5] = entry.styleAndLayoutStart || 0;
+            HEAPF64[base + 6] = script;
+            HEAPF64[base + 7] = forced;
+            HEAPF64[base + 8] = own;
+            _long_tasks_report(callback, arg);
+        });
+    });
+    if (types & 1) observer.observe({ type: "longtask", buffered: true });
+    if (types & 2) observer.observe({ type: "long-animation-frame", buffered: true });
+
+    var observers = Module["emscriptenFunctionsLongTasks"] || (Module["emscriptenFunctionsLongTasks"] = {});
+    observers[record] = observer;
+    return types;
+});
+
+EM_JS(void, long_tasks_disconnect_js, (double *record), {
+    var observers = Module["emscriptenFunctionsLongTasks"] || {};
+    if (observers[record]) {
+        observers[record].disconnect();
+        delete observers[record];
+    }
+});
+
+EMSCRIPTEN_KEEPALIVE void long_tasks_report(long_tasks_callback callback, void *arg) {
+    callback(arg);
+}
+
+int long_tasks_observe(double *record, long_tasks_callback callback, void *arg) {
+    return long_tasks_observe_js(record, callback, arg);
+}
+
+void long_tasks_disconnect(double *record) {
+    long_tasks_disconnect_js(record);
+}
@@ -0,0 +1,142 @@
+#include <emscripten.h>
+#include <stddef.h>
+
+typedef void (*memory_growth_callback)(size_t old_size, size_t new_size);
+
+// Wraps the `grow` method of the calling thread's `wasmMemory`, through which emscripten grows the heap.
+// The growths are reported from a timeout, as they happen inside `sbrk`, where the allocator can't be used.
+// The JS stack of each growth is kept until its report returns, for `memory_growth_stack_js`.
+EM_JS(void, memory_watch_growth_js, (memory_growth_callback callback), {
+    var watch = Module["emscriptenFunctionsGrowthWatch"];
+    if (watch) {
+        watch.callback = callback;
+        return;
+    }
+
+    watch = Module["emscriptenFunctionsGrowthWatch"] = { callback: callback, pending: [], stack: "" };
+    var grow = wasmMemory.grow;
+    wasmMemory.grow = function(pages) {
+        var oldSize = wasmMemory.buffer.byteLength;
+        var result = grow.call(wasmMemory, pages);
+        watch.pending.push([oldSize, wasmMemory.buffer.byteLength, new Error().stack || ""]);
+        if (watch.pending.length == 1) {
+            setTimeout(function() {
+                var pending = watch.pending;
+                watch.pending = [];
+                for (var i = 0; i < pending.length; i++) {
+                    watch.stack = pending[i][2];
+                    _memory_growth_notify(watch.callback, pending[i][0], pending[i][1]);
+                }
+                watch.stack = "";
+            });
+        }
+        return result;
+    };
+});
+
+EM_JS(size_t, memory_growth_stack_js, (char *buffer, size_t size), {
+    var stack = Module["emscriptenFunctionsGrowthWatch"].stack;
+    if (size > 0) {
+        stringToUTF8(stack, buffer, size);
+    }
+    return lengthBytesUTF8(stack);
+});
+
+// Installs the calling thread's cache of views of the wasm memory, `Module["emscriptenFunctionsHeap"]`, whose `HEAP8` ... `HEAPF64`
+// properties are views of the current buffer, created again on the first access after a growth.
+// Its `refresh` method checks the buffer, as emscripten's `GROWABLE_HEAP_*` accessors do: that also catches the growths by other
+// threads, after which emscripten's `HEAP*` views of this thread are stale until `updateMemoryViews` is called, which it does too.
+// The functions given to its `onChange` method are called when the views are created again, to replace those they keep.
+EM_JS(void, memory_views_install_js, (void), {
+    if (Module["emscriptenFunctionsHeap"]) {
+        return;
+    }
+    var names = ["HEAP8", "HEAPU8", "HEAP16", "HEAPU16", "HEAP32", "HEAPU32", "HEAPF32", "HEAPF64"];
+    var types = [Int8Array, Uint8Array, Int16Array, Uint16Array, Int32Array, Uint32Array, Float32Array, Float64Array];
+    var heap = Module["emscriptenFunctionsHeap"] = {
+        buffer: null,
+        views: [],
+        generation: 0,
+        listeners: [],
+        onChange: function (listener) {
+            heap.listeners.push(listener);
+        },
+        refresh: function () {
+            var buffer = wasmMemory.buffer;
+            if (buffer === heap.buffer) {
+                return false;
+            }
+            if (HEAP8.buffer !== buffer && typeof updateMemoryViews == "function") {
+                updateMemoryViews();
+            }
+            heap.buffer = buffer;
+            heap.views = types.map(function (type) {
+                return new type(buffer);
+            });
+            heap.generation++;
+            // The first views aren't a change.
+            if (heap.generation > 1) {
+                heap.listeners.forEach(function (listener) {
+                    listener(heap);
+                });
+            }
+            return true;
+        },
+    };
+    names.forEach(function (name, kind) {
+        Object.defineProperty(heap, name, {
+            get: function () {
+                heap.refresh();
+                return heap.views[kind];
+            },
+        });
+    });
+    heap.refresh();
+});
+
+typedef void (*memory_measure_callback)(void *arg, int ok, double total, double javascript, double dom, double shared, double other);
+
+// Measures the memory of the page's agent cluster with `performance.measureUserAgentSpecificMemory`, summed by the first type
+// of each breakdown entry: `JavaScript` (which includes the wasm memories), `DOM`, `Shared`, and the others.
+// The browser can take seconds to answer, as it waits for the next garbage collection.
+// Returns 0 if the measurement isn't available: it needs a cross-origin isolated page, in a Chromium browser.
+EM_JS(int, memory_measure_js, (memory_measure_callback callback, void *arg), {
+    if (typeof performance == "undefined" || !performance.measureUserAgentSpecificMemory || typeof crossOriginIsolated == "undefined" || !crossOriginIsolated) {
+        return 0;
+    }
+    performance.measureUserAgentSpecificMemory().then(function (result) {
+        var totals = { JavaScript: 0, DOM: 0, Shared: 0, other: 0 };
+        (result.breakdown || []).forEach(function (entry) {
+            var type = entry.types && entry.types[0];
+            totals[type in totals ? type : "other"] += entry.bytes;
+        });
+        _memory_measure_done(callback, arg, 1, result.bytes, totals.JavaScript, totals.DOM, totals.Shared, totals.other);
+    }, function () {
+        _memory_measure_done(callback, arg, 0, 0, 0, 0, 0, 0);
+    });
+    return 1;
+});
+
+EMSCRIPTEN_KEEPALIVE void memory_measure_done(memory_measure_callback callback, void *arg, int ok, double total, double javascript, double dom, double shared, double other) {
+    callback(arg, ok, total, javascript, dom, shared, other);
+}
+
+EMSCRIPTEN_KEEPALIVE void memory_growth_notify(memory_growth_callback callback, size_t old_size, size_t new_size) {
+    callback(old_size, new_size);
+}
+
+void memory_watch_growth(memory_growth_callback callback) {
+    memory_watch_growth_js(callback);
+}
+
+size_t memory_growth_stack(char *buffer, size_t size) {
+    return memory_growth_stack_js(buffer, size);
+}
+
+void memory_views_install(void) {
+    memory_views_install_js();
+}
+
+int memory_measure(memory_measure_callback callback, void *arg) {
+    return memory_measure_js(callback, arg);
+}
@@ -0,0 +1,18 @@
+#include <emscripten.h>
+#include <stddef.h>
+
+// Queues a POST of the given JSON bytes to the URL with `navigator.sendBeacon`, which the browser delivers even while the page unloads.
+// Returns 1 if the browser queued it, 0 otherwise (e.g. outside of a window, or above the browser's beacon quota).
+
+EM_JS(int, metrics_send_beacon_js, (const char *url, const char *data, size_t len), {
+    if (typeof navigator == "undefined" || !navigator.sendBeacon) {
+        return 0;
+    }
+    // The bytes are copied out of the wasm memory, which the Blob can't view when it's shared.
+    var blob = new Blob([HEAPU8.slice(data >>> 0, (data >>> 0) + len)], { type: "application/json" });
+    return navigator.sendBeacon(UTF8ToString(url), blob) ? 1 : 0;
+});
+
+int metrics_send_beacon(const char *url, const char *data, size_t len) {
+    return metrics_send_beacon_js(url, data, len);
+}
@@ -0,0 +1,128 @@
+#include <emscripten.h>
+
+// Compiles the side module at `path`, reusing the `WebAssembly.Module` stored in an IndexedDB database by a previous session,
+// and hands it to emscripten's dynamic linker, which then instantiates it on `dlopen` without compiling it again.
+// The modules are keyed by the SHA-256 of their bytes, so an updated module is compiled again.
+// The database layout is the one of the idb module, whose opened databases are shared.
+// The callback gets 0 on failure, 1 when the module was compiled, 2 when it came from the cache,
+// and 3 when the dynamic linker has no `preloadedWasm` table to hand it to, e.g. in a program that isn't a main module.
+
+typedef void (*modules_precompile_callback)(void *arg, int result);
+
+EM_JS(void, modules_precompile_cached_js, (const char *path_ptr, const char *db_name, modules_precompile_callback callback, void *arg), {
+    var path = UTF8ToString(path_ptr);
+    var name = UTF8ToString(db_name);
+    var done = function (result) {
+        _modules_precompile_done(callback, arg, result);
+    };
+    // Browsers that can't structured-clone modules into IndexedDB throw here; the module is then only compiled.
+    var cache = function (db, key, module) {
+        try {
+            db.transaction(["FILE_DATA"], "readwrite").objectStore("FILE_DATA").put(module, key);
+        } catch (e) {
+        }
+    };
+    var link = function (module, result) {
+        if (typeof preloadedWasm == "undefined") {
+            done(3);
+            return;
+        }
+        preloadedWasm[path] = module;
+        done(result);
+    };
+    var withDb = function (use) {
+        var dbs = Module["emscriptenFunctionsIdb"];
+        if (!dbs) {
+            dbs = Module["emscriptenFunctionsIdb"] = {};
+        }
+        if (dbs[name]) {
+            use(dbs[name]);
+            return;
+        }
+
+        var request;
+        try {
+            request = indexedDB.open(name, 22);
+        } catch (e) {
+            use(null);
+            return;
+        }
+        request.onupgradeneeded = function (e) {
+            var db = e.target.result;
+            if (!db.objectStoreNames.contains("FILE_DATA")) {
+                db.createObjectStore("FILE_DATA");
+            }
+        };
+        request.onsuccess = function () {
+            var db = request.result;
+            db.onversionchange = function () {
+                db.close();
+                delete dbs[name];
+            };
+            dbs[name] = db;
+            use(db);
+        };
+        request.onerror = function (e) {
+            e.preventDefault();
+            use(null);
+        };
+    };
+
+    fetch(path).then(function (response) {
+        if (!response.ok) {
+            throw new Error(response.statusText);
+        }
+        return response.arrayBuffer();
+    }).then(function (bytes) {
+        return crypto.subtle.digest("SHA-256", bytes).then(function (digest) {
+            var key = "wasm-module:" + Array.from(new Uint8Array(digest), function (byte) {
+                return byte.toString(16).padStart(2, "0");
+            }).join("");
+            var compile = function (db) {
+                WebAssembly.compile(bytes).then(function (module) {
+                    if (db) {
+                        cache(db, key, module);
+                    }
+                    link(module, 1);
+                }, function () {
+                    done(0);
+                });
+            };
+
+            withDb(function (db) {
+                if (!db) {
+                    compile(null);
+                    return;
+                }
+                var request;
+                try {
+                    request = db.transaction(["FILE_DATA"], "readonly").objectStore("FILE_DATA").get(key);
+                } catch (e) {
+                    compile(db);
+                    return;
+                }
+                request.onsuccess = function () {
+                    if (request.result instanceof WebAssembly.Module) {
+                        link(request.result, 2);
+                    } else {
+                        compile(db);
+                    }
+                };
+                request.onerror = function (e) {
+                    e.preventDefault();
+                    compile(db);
+                };
+            });
+        });
+    }).catch(function () {
+        done(0);
+    });
+});
+
+EMSCRIPTEN_KEEPALIVE void modules_precompile_done(modules_precompile_callback callback, void *arg, int result) {
+    callback(arg, result);
+}
+
+void modules_precompile_cached(const char *path, const char *db_name, modules_precompile_callback callback, void *arg) {
+    modules_precompile_cached_js(path, db_name, callback, arg);
+}
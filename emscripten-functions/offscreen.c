@@ -0,0 +1,17 @@
+#include <pthread.h>
+#include <emscripten/threading.h>
+
+// Rust's `std::thread` doesn't expose the pthread attributes, which are the only way to transfer canvases to a new thread.
+// Creates a detached thread running `func(arg)`, that gets the (comma-separated) canvases in `canvases` as `OffscreenCanvas`es.
+int offscreen_thread_create(const char *canvases, void *(*func)(void *), void *arg) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    // The string is read by `pthread_create`, so it needs to live only until then.
+    emscripten_pthread_attr_settransferredcanvases(&attr, canvases);
+
+    pthread_t thread;
+    int result = pthread_create(&thread, &attr, func, arg);
+    pthread_attr_destroy(&attr);
+    return result;
+}
@@ -0,0 +1,52 @@
+#include <emscripten.h>
+
+// Listens to the page lifecycle events: `pagehide` and `pageshow` on the window, with their `persisted` flag telling
+// whether the page goes into (or comes back from) the back/forward cache, and `freeze` and `resume` on the document.
+// The listeners are kept in a JS table, by id. No `unload` or `beforeunload` listener is registered, as those make
+// the page ineligible for the back/forward cache.
+// Returns 0 if there's no window, e.g. in node or a worker, in which case nothing is listened to.
+
+typedef void (*page_lifecycle_callback)(void *arg, int event, int persisted);
+
+EM_JS(int, page_lifecycle_listen_js, (page_lifecycle_callback callback, void *arg), {
+    if (typeof window == "undefined" || typeof document == "undefined") {
+        return 0;
+    }
+    var lifecycle = Module["emscriptenFunctionsPageLifecycle"] || (Module["emscriptenFunctionsPageLifecycle"] = { next: 1, listeners: {} });
+    var events = { pagehide: 0, pageshow: 1, freeze: 2, resume: 3 };
+    var listener = function (event) {
+        _page_lifecycle_event(callback, arg, events[event.type], event.persisted ? 1 : 0);
+    };
+    window.addEventListener("pagehide", listener);
+    window.addEventListener("pageshow", listener);
+    document.addEventListener("freeze", listener);
+    document.addEventListener("resume", listener);
+    var id = lifecycle.next++;
+    lifecycle.listeners[id] = listener;
+    return id;
+});
+
+EM_JS(void, page_lifecycle_unlisten_js, (int id), {
+    var lifecycle = Module["emscriptenFunctionsPageLifecycle"];
+    var listener = lifecycle && lifecycle.listeners[id];
+    if (!listener) {
+        return;
+    }
+    delete lifecycle.listeners[id];
+    window.removeEventListener("pagehide", listener);
+    window.removeEventListener("pageshow", listener);
+    document.removeEventListener("freeze", listener);
+    document.removeEventListener("resume", listener);
+});
+
+EMSCRIPTEN_KEEPALIVE void page_lifecycle_event(page_lifecycle_callback callback, void *arg, int event, int persisted) {
+    callback(arg, event, persisted);
+}
+
+int page_lifecycle_listen(page_lifecycle_callback callback, void *arg) {
+    return page_lifecycle_listen_js(callback, arg);
+}
+
+void page_lifecycle_unlisten(int id) {
+    page_lifecycle_unlisten_js(id);
+}
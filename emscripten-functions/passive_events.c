@@ -0,0 +1,28 @@
+#include <emscripten.h>
+
+// Makes the listeners registered by emscripten's html5 functions passive, by wrapping `EventTarget.prototype.addEventListener`
+// from `passive_events_begin` to `passive_events_end`: emscripten passes its `useCapture` flag, which is turned into the options
+// `{ capture: useCapture, passive: true }`. The registrations run on the main browser thread, so the calls must be made there.
+// Removing the listeners doesn't need the wrapper, as `removeEventListener` only matches the capture flag.
+
+EM_JS(void, passive_events_begin, (void), {
+    if (typeof EventTarget == "undefined" || Module["emscriptenFunctionsPassiveEvents"]) {
+        return;
+    }
+    var original = EventTarget.prototype.addEventListener;
+    EventTarget.prototype.addEventListener = function (type, listener, options) {
+        if (typeof options != "object" || options === null) {
+            options = { capture: !!options };
+        }
+        return original.call(this, type, listener, Object.assign({}, options, { passive: true }));
+    };
+    Module["emscriptenFunctionsPassiveEvents"] = original;
+});
+
+EM_JS(void, passive_events_end, (void), {
+    var original = Module["emscriptenFunctionsPassiveEvents"];
+    if (original) {
+        EventTarget.prototype.addEventListener = original;
+        Module["emscriptenFunctionsPassiveEvents"] = null;
+    }
+});
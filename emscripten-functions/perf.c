@@ -0,0 +1,51 @@
+#include <emscripten.h>
+
+// The names of the User Timing entries live in a JS-side table of the calling thread, indexed by the ids handed out to rust,
+// so that emitting an entry doesn't decode a string.
+
+EM_JS(int, perf_register_name_js, (const char *name), {
+    var names = Module["emscriptenFunctionsPerfNames"];
+    if (!names) {
+        names = Module["emscriptenFunctionsPerfNames"] = [];
+    }
+
+    names.push(UTF8ToString(name));
+    return names.length - 1;
+});
+
+EM_JS(void, perf_mark_js, (int id), {
+    performance.mark(Module["emscriptenFunctionsPerfNames"][id]);
+});
+
+EM_JS(void, perf_measure_js, (int id, double start), {
+    performance.measure(Module["emscriptenFunctionsPerfNames"][id], { start: start, end: performance.now() });
+});
+
+EM_JS(void, perf_measure_marks_js, (int id, int start_mark, int end_mark), {
+    var names = Module["emscriptenFunctionsPerfNames"];
+    performance.measure(names[id], names[start_mark], names[end_mark]);
+});
+
+EM_JS(double, perf_now_js, (void), {
+    return performance.now();
+});
+
+int perf_register_name(const char *name) {
+    return perf_register_name_js(name);
+}
+
+void perf_mark(int id) {
+    perf_mark_js(id);
+}
+
+void perf_measure(int id, double start) {
+    perf_measure_js(id, start);
+}
+
+void perf_measure_marks(int id, int start_mark, int end_mark) {
+    perf_measure_marks_js(id, start_mark, end_mark);
+}
+
+double perf_now(void) {
+    return perf_now_js();
+}
@@ -0,0 +1,87 @@
+#include <emscripten.h>
+
+// Listens to the pointer events of a target (a CSS selector, or "window" or "document"), writing each event's samples
+// into the rust-side records (`src/pointer.rs`): first the coalesced samples of the event, from `getCoalescedEvents()` (the newest ones,
+// if there are more than the records), then its predicted ones, from `getPredictedEvents()`, in at most a quarter of the records.
+// The callback then gets both counts, once per event. A record is 12 doubles: kind (0 to 3 for down, move, up and cancel), pointerId,
+// pointerType (0 for mouse, 1 for pen, 2 for touch), isPrimary, timeStamp, x and y relative to the target, pressure, tiltX, tiltY, twist and buttons.
+// The listeners are kept in `Module["emscriptenFunctionsPointer"]` by records address.
+// Returns 0 if there's no such target.
+
+typedef void (*pointer_callback)(void *arg, int count, int predicted);
+
+EM_JS(int, pointer_listen_js, (const char *selector, double *records, int capacity, pointer_callback callback, void *arg), {
+    var name = UTF8ToString(selector);
+    var target = name == "window" ? window : name == "document" ? document : document.querySelector(name);
+    if (!target) {
+        return 0;
+    }
+
+    var kinds = { pointerdown: 0, pointermove: 1, pointerup: 2, pointercancel: 3 };
+    var pointerTypes = { mouse: 0, pen: 1, touch: 2 };
+    var handler = function (event) {
+        var kind = kinds[event.type];
+        var rect = target.getBoundingClientRect ? target.getBoundingClientRect() : { left: 0, top: 0 };
+        var write = function (sample, index) {
+            var base = (records >>> 3) + index * 12;
+            HEAPF64[base] = kind;
+            HEAPF64[base + 1] = sample.pointerId;
+            HEAPF64[base + 2] = pointerTypes[sample.pointerType] || 0;
+            HEAPF64[base + 3] = sample.isPrimary ? 1 : 0;
+            HEAPF64[base + 4] = sample.timeStamp;
+            HEAPF64[base + 5] = sample.clientX - rect.left;
+            HEAPF64[base + 6] = sample.clientY - rect.top;
+            HEAPF64[base + 7] = sample.pressure;
+            HEAPF64[base + 8] = sample.tiltX || 0;
+            HEAPF64[base + 9] = sample.tiltY || 0;
+            HEAPF64[base + 10] = sample.twist || 0;
+            HEAPF64[base + 11] = sample.buttons;
+        };
+
+        var coalesced = event.getCoalescedEvents ? event.getCoalescedEvents() : [];
+        if (!coalesced.length) {
+            coalesced = [event];
+        }
+        var predicted = event.getPredictedEvents ? event.getPredictedEvents() : [];
+        var predictedCount = Math.min(predicted.length, capacity >> 2);
+        var count = Math.min(coalesced.length, capacity - predictedCount);
+        var skip = coalesced.length - count;
+        for (var i = 0; i < count; i++) {
+            write(coalesced[skip + i], i);
+        }
+        for (var j = 0; j < predictedCount; j++) {
+            write(predicted[j], count + j);
+        }
+        _pointer_dispatch(callback, arg, count, predictedCount);
+    };
+    for (var type in kinds) {
+        target.addEventListener(type, handler);
+    }
+
+    var listeners = Module["emscriptenFunctionsPointer"] || (Module["emscriptenFunctionsPointer"] = {});
+    listeners[records] = { target: target, handler: handler, types: Object.keys(kinds) };
+    return 1;
+});
+
+EM_JS(void, pointer_unlisten_js, (double *records), {
+    var listeners = Module["emscriptenFunctionsPointer"] || {};
+    var listener = listeners[records];
+    if (listener) {
+        listener.types.forEach(function (type) {
+            listener.target.removeEventListener(type, listener.handler);
+        });
+        delete listeners[records];
+    }
+});
+
+EMSCRIPTEN_KEEPALIVE void pointer_dispatch(pointer_callback callback, void *arg, int count, int predicted) {
+    callback(arg, count, predicted);
+}
+
+int pointer_listen(const char *selector, double *records, int capacity, pointer_callback callback, void *arg) {
+    return pointer_listen_js(selector, records, capacity, callback, arg);
+}
+
+void pointer_unlisten(double *records) {
+    pointer_unlisten_js(records);
+}
@@ -0,0 +1,77 @@
+#include <emscripten.h>
+
+// Requests the pointer lock of the target (a CSS selector, or "#canvas" for `Module.canvas`), with `unadjustedMovement`
+// when asked for and supported, so that the movements are the raw ones of the mouse, without the OS acceleration.
+// Browsers whose `requestPointerLock` doesn't return a promise ignore its options; the result then comes from the document's events.
+// The callback gets 0 when the lock failed (e.g. outside of a user gesture), 1 once locked with adjusted movements, and 2 with unadjusted ones.
+
+typedef void (*pointer_lock_callback)(void *arg, int result);
+
+EM_JS(void, pointer_lock_request_js, (const char *selector, int unadjusted, pointer_lock_callback callback, void *arg), {
+    var name = UTF8ToString(selector);
+    var element = (name == "#canvas" && Module["canvas"]) || document.querySelector(name);
+    var called = false;
+    var done = function (result) {
+        if (!called) {
+            called = true;
+            _pointer_lock_done(callback, arg, result);
+        }
+    };
+    if (!element || !element.requestPointerLock) {
+        done(0);
+        return;
+    }
+
+    // The result of the browsers without the promise.
+    var onchange = function () {
+        cleanup();
+        done(document.pointerLockElement === element ? 1 : 0);
+    };
+    var onerror = function () {
+        cleanup();
+        done(0);
+    };
+    var cleanup = function () {
+        document.removeEventListener("pointerlockchange", onchange);
+        document.removeEventListener("pointerlockerror", onerror);
+    };
+
+    var request = function (options) {
+        var promise;
+        try {
+            promise = options ? element.requestPointerLock(options) : element.requestPointerLock();
+        } catch (e) {
+            return Promise.reject(e);
+        }
+        return promise;
+    };
+
+    var promise = request(unadjusted ? { unadjustedMovement: true } : undefined);
+    if (!promise || !promise.then) {
+        document.addEventListener("pointerlockchange", onchange);
+        document.addEventListener("pointerlockerror", onerror);
+        return;
+    }
+    promise.then(function () {
+        done(unadjusted ? 2 : 1);
+    }, function (error) {
+        // Without support for unadjusted movements, the lock is requested again without them.
+        if (!unadjusted || !error || error.name != "NotSupportedError") {
+            done(0);
+            return;
+        }
+        request(undefined).then(function () {
+            done(1);
+        }, function () {
+            done(0);
+        });
+    });
+});
+
+EMSCRIPTEN_KEEPALIVE void pointer_lock_done(pointer_lock_callback callback, void *arg, int result) {
+    callback(arg, result);
+}
+
+void pointer_lock_request(const char *selector, int unadjusted, pointer_lock_callback callback, void *arg) {
+    pointer_lock_request_js(selector, unadjusted, callback, arg);
+}
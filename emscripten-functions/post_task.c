@@ -0,0 +1,103 @@
+#include <emscripten.h>
+
+// Posts the callback with `scheduler.postTask()`, at the given priority (0 for "user-blocking", 1 for "user-visible", 2 for "background")
+// after the given delay in milliseconds, or with `setTimeout()` where the scheduler API is missing.
+// `_post_task_done` is called exactly once for each task: with 1 when it runs, or 0 when it's cancelled, so that its data is freed either way.
+// The tasks are kept in `Module["emscriptenFunctionsPostTask"]` by id, which is returned, with their `TaskController` or timer.
+
+typedef void (*post_task_callback)(void *arg, int ran);
+
+EM_JS(int, post_task_js, (int priority, double delay, post_task_callback callback, void *arg), {
+    var state = Module["emscriptenFunctionsPostTask"] || (Module["emscriptenFunctionsPostTask"] = { next: 1, tasks: {} });
+    var id = state.next++;
+    var task = {
+        done: function (ran) {
+            if (state.tasks[id]) {
+                delete state.tasks[id];
+                _post_task_done(callback, arg, ran);
+            }
+        }
+    };
+    state.tasks[id] = task;
+
+    if (typeof scheduler != "undefined" && scheduler.postTask) {
+        var name = ["user-blocking", "user-visible", "background"][priority];
+        var options = { delay: delay };
+        if (typeof TaskController == "function") {
+            task.controller = new TaskController({ priority: name });
+            options.signal = task.controller.signal;
+        } else {
+            options.priority = name;
+        }
+        scheduler.postTask(function () { task.done(1); }, options).catch(function () { task.done(0); });
+    } else {
+        task.timer = setTimeout(function () { task.done(1); }, delay);
+    }
+    return id;
+});
+
+EM_JS(void, post_task_cancel_js, (int id), {
+    var state = Module["emscriptenFunctionsPostTask"];
+    var task = state && state.tasks[id];
+    if (!task) {
+        return;
+    }
+    if (task.controller) {
+        task.controller.abort();
+    } else if (task.timer !== undefined) {
+        clearTimeout(task.timer);
+    }
+    task.done(0);
+});
+
+// Returns 0 if the task already ran or was cancelled, or if its priority can't be changed (without `TaskController`).
+EM_JS(int, post_task_set_priority_js, (int id, int priority), {
+    var state = Module["emscriptenFunctionsPostTask"];
+    var task = state && state.tasks[id];
+    if (!task || !task.controller) {
+        return 0;
+    }
+    task.controller.setPriority(["user-blocking", "user-visible", "background"][priority]);
+    return 1;
+});
+
+// Calls the callback once the calling task yielded to the browser, with `scheduler.yield()`, which continues at the priority of the task;
+// or else with a "user-visible" `scheduler.postTask()`, or `setTimeout()`.
+EM_JS(void, post_task_yield_js, (post_task_callback callback, void *arg), {
+    var done = function () { _post_task_done(callback, arg, 1); };
+    if (typeof scheduler != "undefined" && scheduler.yield) {
+        scheduler.yield().then(done);
+    } else if (typeof scheduler != "undefined" && scheduler.postTask) {
+        scheduler.postTask(done, { priority: "user-visible" });
+    } else {
+        setTimeout(done, 0);
+    }
+});
+
+EM_JS(int, post_task_supported_js, (void), {
+    return typeof scheduler != "undefined" && !!scheduler.postTask;
+});
+
+EMSCRIPTEN_KEEPALIVE void post_task_done(post_task_callback callback, void *arg, int ran) {
+    callback(arg, ran);
+}
+
+int post_task_post(int priority, double delay, post_task_callback callback, void *arg) {
+    return post_task_js(priority, delay, callback, arg);
+}
+
+void post_task_cancel(int id) {
+    post_task_cancel_js(id);
+}
+
+int post_task_set_priority(int id, int priority) {
+    return post_task_set_priority_js(id, priority);
+}
+
+void post_task_yield(post_task_callback callback, void *arg) {
+    post_task_yield_js(callback, arg);
+}
+
+int post_task_supported(void) {
+    return post_task_supported_js();
+}
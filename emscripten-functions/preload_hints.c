@@ -0,0 +1,48 @@
+#include <emscripten.h>
+
+// Hints the browser to start downloading a URL right away: `kind` 0 to 5 inject a `<link rel=preload>` with `as` set to
+// `fetch`, `image`, `font`, `style`, `script` or, for 5, a `<link rel=modulepreload>`; 6 starts a `fetch()` whose response
+// is only read into the HTTP cache. `priority` is the `fetchpriority` hint: 0 for `auto`, 1 for `high` and 2 for `low`.
+// The `fetch` and `font` preloads are made in CORS mode, as the requests they're to be matched with are.
+// The hinted URLs are remembered, so that each one is hinted once.
+// Returns 0 if nothing was hinted: the URL was already, or there's no document (a worker or node) for the links.
+
+EM_JS(int, preload_hint_js, (const char *url, int kind, int priority), {
+    var hinted = Module["emscriptenFunctionsPreloadHints"] || (Module["emscriptenFunctionsPreloadHints"] = {});
+    var href = UTF8ToString(url);
+    var fetchPriority = ["auto", "high", "low"][priority];
+    if (hinted[href]) {
+        return 0;
+    }
+    if (kind == 6) {
+        if (typeof fetch != "function") {
+            return 0;
+        }
+        fetch(href, { priority: fetchPriority }).then(function (response) {
+            return response.arrayBuffer();
+        }).catch(function () {});
+    } else {
+        if (typeof document == "undefined") {
+            return 0;
+        }
+        var link = document.createElement("link");
+        if (kind == 5) {
+            link.rel = "modulepreload";
+        } else {
+            link.rel = "preload";
+            link.as = ["fetch", "image", "font", "style", "script"][kind];
+            if (kind == 0 || kind == 2) {
+                link.crossOrigin = "anonymous";
+            }
+        }
+        link.fetchPriority = fetchPriority;
+        link.href = href;
+        document.head.appendChild(link);
+    }
+    hinted[href] = true;
+    return 1;
+});
+
+int preload_hint(const char *url, int kind, int priority) {
+    return preload_hint_js(url, kind, priority);
+}
@@ -0,0 +1,251 @@
+#include <emscripten.h>
+
+// The compiled scripts live in a JS-side table of the calling thread, indexed by the ids handed out to rust.
+// The ids of released scripts are reused.
+// The JS objects held by rust handles live in another such table, which the scripts look handles up in with `$h(handle)`.
+
+EM_JS(int, script_compile_js, (const char *source), {
+    var scripts = Module["emscriptenFunctionsScripts"];
+    if (!scripts) {
+        scripts = Module["emscriptenFunctionsScripts"] = { table: [], free: [] };
+    }
+    var handles = Module["emscriptenFunctionsHandles"] || (Module["emscriptenFunctionsHandles"] = { table: [], free: [] });
+
+    // The heap views installed by `memory_views_install_js`, refreshed once per call rather than created for each slice.
+    var heap = Module["emscriptenFunctionsHeap"];
+
+    // Decodes the typed arguments: each one is a kind, a value or pointer, and a length, as `ScriptArg::encode` writes them.
+    // The slices become views of the wasm memory, which are only valid during the call.
+    if (!scripts.args) {
+        scripts.args = function (args, count) {
+            heap.refresh();
+            var values = [];
+            for (var i = 0; i < count; i++) {
+                var arg = (args >>> 3) + i * 3;
+                var kind = heap.views[7][arg];
+                var value = heap.views[7][arg + 1];
+                if (kind == 0) {
+                    values.push(value);
+                } else if (kind == 1) {
+                    values.push(handles.table[value]);
+                } else {
+                    var view = heap.views[kind - 2];
+                    var start = value / view.BYTES_PER_ELEMENT;
+                    values.push(view.subarray(start, start + heap.views[7][arg + 2]));
+                }
+            }
+            return values;
+        };
+    }
+
+    // The body is wrapped in a closure, so that `$h` and `$heap` are in its scope whatever the scope of `Module` is.
+    var func;
+    try {
+        func = new Function("$h", "$heap", "return function ($0, $1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, $12, $13, $14, $15) {\n"
+            + UTF8ToString(source) + "\n};")(function (handle) {
+            return handles.table[handle];
+        }, heap);
+    } catch (e) {
+        return -1;
+    }
+
+    var id = scripts.free.length ? scripts.free.pop() : scripts.table.length;
+    scripts.table[id] = func;
+    return id;
+});
+
+EM_JS(void, script_release_js, (int id), {
+    var scripts = Module["emscriptenFunctionsScripts"];
+    scripts.table[id] = null;
+    scripts.free.push(id);
+});
+
+EM_JS(int, script_call_int_js, (int id, const double *args, int count), {
+    var argsStart = args >>> 3;
+    var result = Module["emscriptenFunctionsScripts"].table[id].apply(null, Module["emscriptenFunctionsHeap"].HEAPF64.subarray(argsStart, argsStart + count));
+    return result | 0;
+});
+
+EM_JS(double, script_call_double_js, (int id, const double *args, int count), {
+    var argsStart = args >>> 3;
+    var result = Module["emscriptenFunctionsScripts"].table[id].apply(null, Module["emscriptenFunctionsHeap"].HEAPF64.subarray(argsStart, argsStart + count));
+    return +result;
+});
+
+EM_JS(int, script_call_typed_int_js, (int id, const double *args, int count), {
+    var scripts = Module["emscriptenFunctionsScripts"];
+    var result = scripts.table[id].apply(null, scripts.args(args, count));
+    return result | 0;
+});
+
+EM_JS(double, script_call_typed_double_js, (int id, const double *args, int count), {
+    var scripts = Module["emscriptenFunctionsScripts"];
+    var result = scripts.table[id].apply(null, scripts.args(args, count));
+    return +result;
+});
+
+EM_JS(int, script_call_handle_js, (int id, const double *args, int count), {
+    var argsStart = args >>> 3;
+    var result = Module["emscriptenFunctionsScripts"].table[id].apply(null, Module["emscriptenFunctionsHeap"].HEAPF64.subarray(argsStart, argsStart + count));
+    if (result === null || result === undefined) {
+        return -1;
+    }
+    var handles = Module["emscriptenFunctionsHandles"];
+    var handle = handles.free.length ? handles.free.pop() : handles.table.length;
+    handles.table[handle] = result;
+    return handle;
+});
+
+EM_JS(int, script_handle_query_selector_js, (const char *selector), {
+    var handles = Module["emscriptenFunctionsHandles"] || (Module["emscriptenFunctionsHandles"] = { table: [], free: [] });
+    var element = document.querySelector(UTF8ToString(selector));
+    if (!element) {
+        return -1;
+    }
+    var handle = handles.free.length ? handles.free.pop() : handles.table.length;
+    handles.table[handle] = element;
+    return handle;
+});
+
+EM_JS(int, script_handle_property_js, (int object, const char *name), {
+    var handles = Module["emscriptenFunctionsHandles"];
+    var value = handles.table[object][UTF8ToString(name)];
+    if (value === null || value === undefined) {
+        return -1;
+    }
+    var handle = handles.free.length ? handles.free.pop() : handles.table.length;
+    handles.table[handle] = value;
+    return handle;
+});
+
+EM_JS(int, script_handle_clone_js, (int object), {
+    var handles = Module["emscriptenFunctionsHandles"];
+    var handle = handles.free.length ? handles.free.pop() : handles.table.length;
+    handles.table[handle] = handles.table[object];
+    return handle;
+});
+
+EM_JS(void, script_handle_release_js, (int handle), {
+    var handles = Module["emscriptenFunctionsHandles"];
+    handles.table[handle] = null;
+    handles.free.push(handle);
+});
+
+// Runs the compiled script of the given id with typed arguments, or evaluates `source` if the id is negative, and copies its result,
+// an `ArrayBuffer` or a view of one like a typed array, into the caller's buffer of `capacity` bytes, returning its length.
+// A result that doesn't fit is kept for `script_take_result_js`, and `-2 - length` is returned; any other result returns -1.
+EM_JS(int, script_call_bytes_js, (int id, const char *source, const double *args, int count, void *buffer, int capacity), {
+    var result;
+    if (id >= 0) {
+        var scripts = Module["emscriptenFunctionsScripts"];
+        result = scripts.table[id].apply(null, scripts.args(args, count));
+    } else {
+        result = eval(UTF8ToString(source));
+    }
+
+    var bytes;
+    if (result instanceof ArrayBuffer || (typeof SharedArrayBuffer != "undefined" && result instanceof SharedArrayBuffer)) {
+        bytes = new Uint8Array(result);
+    } else if (ArrayBuffer.isView(result)) {
+        bytes = new Uint8Array(result.buffer, result.byteOffset, result.byteLength);
+    } else {
+        return -1;
+    }
+    if (bytes.length <= capacity) {
+        HEAPU8.set(bytes, buffer >>> 0);
+        return bytes.length;
+    }
+    // A view of the wasm memory is copied, as growing the caller's buffer can replace the memory's buffer.
+    Module["emscriptenFunctionsScriptResult"] = bytes.buffer === HEAPU8.buffer ? bytes.slice() : bytes;
+    return -2 - bytes.length;
+});
+
+EM_JS(void, script_take_result_js, (void *buffer), {
+    HEAPU8.set(Module["emscriptenFunctionsScriptResult"], buffer >>> 0);
+    Module["emscriptenFunctionsScriptResult"] = null;
+});
+
+// Loads a script file by inserting a script element. The elements load in parallel;
+// with `in_order`, they run in insertion order instead of as soon as each is loaded.
+typedef void (*script_load_callback)(void *arg, int ok);
+
+EM_JS(void, script_load_js, (const char *url, int in_order, script_load_callback callback, void *arg), {
+    var script = document.createElement("script");
+    script.src = UTF8ToString(url);
+    script.async = !in_order;
+    script.onload = function () {
+        _script_load_done(callback, arg, 1);
+    };
+    script.onerror = function () {
+        _script_load_done(callback, arg, 0);
+    };
+    document.head.appendChild(script);
+});
+
+EMSCRIPTEN_KEEPALIVE void script_load_done(script_load_callback callback, void *arg, int ok) {
+    callback(arg, ok);
+}
+
+int script_compile(const char *source) {
+    return script_compile_js(source);
+}
+
+void script_release(int id) {
+    script_release_js(id);
+}
+
+void script_call(int id, const double *args, int count) {
+    script_call_int_js(id, args, count);
+}
+
+int script_call_int(int id, const double *args, int count) {
+    return script_call_int_js(id, args, count);
+}
+
+double script_call_double(int id, const double *args, int count) {
+    return script_call_double_js(id, args, count);
+}
+
+void script_call_typed(int id, const double *args, int count) {
+    script_call_typed_int_js(id, args, count);
+}
+
+int script_call_typed_int(int id, const double *args, int count) {
+    return script_call_typed_int_js(id, args, count);
+}
+
+double script_call_typed_double(int id, const double *args, int count) {
+    return script_call_typed_double_js(id, args, count);
+}
+
+int script_call_handle(int id, const double *args, int count) {
+    return script_call_handle_js(id, args, count);
+}
+
+int script_call_bytes(int id, const char *source, const double *args, int count, void *buffer, int capacity) {
+    return script_call_bytes_js(id, source, args, count, buffer, capacity);
+}
+
+void script_take_result(void *buffer) {
+    script_take_result_js(buffer);
+}
+
+int script_handle_query_selector(const char *selector) {
+    return script_handle_query_selector_js(selector);
+}
+
+int script_handle_property(int object, const char *name) {
+    return script_handle_property_js(object, name);
+}
+
+int script_handle_clone(int object) {
+    return script_handle_clone_js(object);
+}
+
+void script_handle_release(int handle) {
+    script_handle_release_js(handle);
+}
+
+void script_load(const char *url, int in_order, script_load_callback callback, void *arg) {
+    script_load_js(url, in_order, callback, arg);
+}
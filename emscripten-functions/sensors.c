@@ -0,0 +1,74 @@
+#include <emscripten.h>
+
+// Listens to the `devicemotion` (kind 0) or `deviceorientation` (kind 1) events of the window, writing the latest sample into
+// the rust-side slot (`src/sensors.rs`) without calling into wasm: a sequence number, incremented by each event, then the sample.
+// A motion sample is 11 doubles: timeStamp, acceleration x, y and z, accelerationIncludingGravity x, y and z, rotationRate alpha,
+// beta and gamma, and interval. An orientation sample is 5 doubles: timeStamp, alpha, beta, gamma and absolute. Missing values are NaN.
+// When a callback is given, it's called with the slot's sequence number at most once per `min_interval` milliseconds.
+// The listeners are kept in `Module["emscriptenFunctionsSensors"]` by slot address.
+
+typedef void (*sensors_callback)(void *arg, double sequence);
+
+EM_JS(void, sensors_listen_js, (int kind, double *slot, double min_interval, sensors_callback callback, void *arg), {
+    var value = function (number) {
+        return typeof number == "number" ? number : NaN;
+    };
+    var vector = function (vector, names) {
+        return names.map(function (name) {
+            return value(vector && vector[name]);
+        });
+    };
+    var lastCall = -Infinity;
+    var handler = function (event) {
+        var sample = kind == 0
+            ? [event.timeStamp].concat(
+                vector(event.acceleration, ["x", "y", "z"]),
+                vector(event.accelerationIncludingGravity, ["x", "y", "z"]),
+                vector(event.rotationRate, ["alpha", "beta", "gamma"]),
+                [value(event.interval)])
+            : [event.timeStamp, value(event.alpha), value(event.beta), value(event.gamma), event.absolute ? 1 : 0];
+        var base = slot >>> 3;
+        HEAPF64[base] += 1;
+        HEAPF64.set(sample, base + 1);
+
+        if (callback && event.timeStamp - lastCall >= min_interval) {
+            lastCall = event.timeStamp;
+            _sensors_dispatch(callback, arg, HEAPF64[base]);
+        }
+    };
+    var type = kind == 0 ? "devicemotion" : "deviceorientation";
+    window.addEventListener(type, handler);
+
+    var listeners = Module["emscriptenFunctionsSensors"] || (Module["emscriptenFunctionsSensors"] = {});
+    listeners[slot] = { type: type, handler: handler };
+});
+
+EM_JS(void, sensors_unlisten_js, (double *slot), {
+    var listeners = Module["emscriptenFunctionsSensors"] || {};
+    var listener = listeners[slot];
+    if (listener) {
+        window.removeEventListener(listener.type, listener.handler);
+        delete listeners[slot];
+    }
+});
+
+// Returns 1 where the window has the events' interface.
+EM_JS(int, sensors_is_supported_js, (int kind), {
+    return typeof window != "undefined" && (kind == 0 ? "DeviceMotionEvent" : "DeviceOrientationEvent") in window ? 1 : 0;
+});
+
+EMSCRIPTEN_KEEPALIVE void sensors_dispatch(sensors_callback callback, void *arg, double sequence) {
+    callback(arg, sequence);
+}
+
+void sensors_listen(int kind, double *slot, double min_interval, sensors_callback callback, void *arg) {
+    sensors_listen_js(kind, slot, min_interval, callback, arg);
+}
+
+void sensors_unlisten(double *slot) {
+    sensors_unlisten_js(slot);
+}
+
+int sensors_is_supported(int kind) {
+    return sensors_is_supported_js(kind);
+}
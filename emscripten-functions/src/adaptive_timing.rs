@@ -0,0 +1,207 @@
+//! An adaptive controller of the main loop's timing mode.
+//!
+//! [`set_main_loop_timing`] only sets a static mode. The [`AdaptiveTimingController`] instead watches the measured cost of each main loop tick,
+//! and walks a ladder of timing modes: `requestAnimationFrame` with a swap interval of 1, 2, ... and finally `setTimeout` pacing.
+//! When the ticks consistently overrun the current frame budget it steps down to a slower mode, and when there is enough headroom it steps back up.
+//!
+//! It can be installed into the main loop set with [`set_main_loop_with_arg`] or [`set_main_loop`] using [`enable_adaptive_main_loop_timing`],
+//! or fed manually with [`AdaptiveTimingController::observe`].
+//!
+//! [`set_main_loop_timing`]: crate::emscripten::set_main_loop_timing
+//! [`set_main_loop_with_arg`]: crate::emscripten::set_main_loop_with_arg
+//! [`set_main_loop`]: crate::emscripten::set_main_loop
+
+use std::{cell::RefCell, os::raw::c_int};
+
+use crate::emscripten::{set_main_loop_timing, MainLoopTiming};
+
+/// The parameters of an [`AdaptiveTimingController`].
+#[derive(Debug, Clone, PartialEq)]
+pub struct AdaptiveTimingConfig {
+    /// The duration of a display frame, in milliseconds; `1000.0 / 60.0` for a 60Hz display.
+    pub display_frame: f64,
+    /// The highest `requestAnimationFrame` swap interval to step down to; 3 means the slowest rAF mode runs every third vsync.
+    pub max_swap_interval: c_int,
+    /// The `setTimeout` interval, in milliseconds, to step down to after the slowest rAF mode, if any.
+    pub fallback_timeout: Option<c_int>,
+    /// A tick overruns when its cost is above this fraction of the current mode's frame budget.
+    pub overrun_ratio: f64,
+    /// There is headroom when a tick's cost is below this fraction of the next faster mode's frame budget.
+    pub headroom_ratio: f64,
+    /// The number of consecutive overrunning ticks after which the controller steps down.
+    pub step_down_after: u32,
+    /// The number of consecutive ticks with headroom after which the controller steps up.
+    /// Keep it larger than `step_down_after` so that the controller doesn't oscillate.
+    pub step_up_after: u32,
+}
+
+impl Default for AdaptiveTimingConfig {
+    fn default() -> Self {
+        Self {
+            display_frame: 1000.0 / 60.0,
+            max_swap_interval: 3,
+            fallback_timeout: Some(100),
+            overrun_ratio: 0.9,
+            headroom_ratio: 0.6,
+            step_down_after: 30,
+            step_up_after: 180,
+        }
+    }
+}
+
+/// Switches the main loop's timing mode depending on the measured tick cost.
+///
+/// # Examples
+/// ```rust
+/// let mut controller = AdaptiveTimingController::new(AdaptiveTimingConfig::default());
+///
+/// set_main_loop(move || {
+///     let start = get_now();
+///     // ... the frame's work ...
+///     controller.observe(get_now() - start);
+/// }, 0, true);
+/// ```
+#[derive(Debug, Clone)]
+pub struct AdaptiveTimingController {
+    config: AdaptiveTimingConfig,
+    // The index of the current mode in the ladder: 0 to `max_swap_interval - 1` are the rAF modes, `max_swap_interval` is the `setTimeout` one.
+    level: usize,
+    overruns: u32,
+    headroom: u32,
+}
+
+impl AdaptiveTimingController {
+    /// Creates a controller that starts at the fastest mode: `requestAnimationFrame` with a swap interval of 1.
+    ///
+    /// The main loop's timing isn't changed until the controller decides to step down.
+    pub fn new(config: AdaptiveTimingConfig) -> Self {
+        assert!(
+            config.max_swap_interval >= 1,
+            "the maximum swap interval must be at least 1"
+        );
+
+        Self {
+            config,
+            level: 0,
+            overruns: 0,
+            headroom: 0,
+        }
+    }
+
+    /// Returns the current timing mode.
+    pub fn timing(&self) -> MainLoopTiming {
+        self.timing_at(self.level)
+    }
+
+    /// Records the cost of a main loop tick, and applies a new timing mode to the main loop if the controller decides to switch.
+    ///
+    /// It returns the newly applied timing mode, if it changed.
+    ///
+    /// # Arguments
+    /// * `tick_cost` - The time spent in the tick, in milliseconds.
+    pub fn observe(&mut self, tick_cost: f64) -> Option<MainLoopTiming> {
+        if tick_cost > self.budget_at(self.level) * self.config.overrun_ratio {
+            self.overruns += 1;
+            self.headroom = 0;
+        } else if self.level > 0
+            && tick_cost < self.budget_at(self.level - 1) * self.config.headroom_ratio
+        {
+            self.headroom += 1;
+            self.overruns = 0;
+        } else {
+            self.overruns = 0;
+            self.headroom = 0;
+        }
+
+        let new_level =
+            if self.overruns >= self.config.step_down_after && self.level < self.slowest_level() {
+                self.level + 1
+            } else if self.level > 0 && self.headroom >= self.config.step_up_after {
+                self.level - 1
+            } else {
+                return None;
+            };
+
+        self.level = new_level;
+        self.overruns = 0;
+        self.headroom = 0;
+
+        let timing = self.timing();
+        set_main_loop_timing(&timing);
+        Some(timing)
+    }
+
+    fn slowest_level(&self) -> usize {
+        let rafs = self.config.max_swap_interval as usize;
+        if self.config.fallback_timeout.is_some() {
+            rafs
+        } else {
+            rafs - 1
+        }
+    }
+
+    fn timing_at(&self, level: usize) -> MainLoopTiming {
+        if level < self.config.max_swap_interval as usize {
+            MainLoopTiming::RequestAnimationFrame(level as c_int + 1)
+        } else {
+            MainLoopTiming::SetTimeout(self.config.fallback_timeout.unwrap_or(0))
+        }
+    }
+
+    fn budget_at(&self, level: usize) -> f64 {
+        match self.timing_at(level) {
+            MainLoopTiming::RequestAnimationFrame(n) => self.config.display_frame * n as f64,
+            MainLoopTiming::SetTimeout(ms) => ms as f64,
+            MainLoopTiming::SetImmediate => 0.0,
+        }
+    }
+}
+
+thread_local! {
+    static ADAPTIVE_TIMING: RefCell<Option<AdaptiveTimingController>> = RefCell::new(None);
+}
+
+/// Installs an [`AdaptiveTimingController`] into the calling thread's main loop, replacing the previous one, if any.
+///
+/// The cost of each tick of the main loop set with [`set_main_loop_with_arg`] or [`set_main_loop`] is then fed to the controller.
+///
+/// [`set_main_loop_with_arg`]: crate::emscripten::set_main_loop_with_arg
+/// [`set_main_loop`]: crate::emscripten::set_main_loop
+///
+/// # Arguments
+/// * `config` - The parameters of the controller.
+///
+/// # Examples
+/// ```rust
+/// enable_adaptive_main_loop_timing(AdaptiveTimingConfig {
+///     max_swap_interval: 2,
+///     fallback_timeout: None,
+///     ..Default::default()
+/// });
+/// set_main_loop(|| {
+///     // ...
+/// }, 0, true);
+/// ```
+pub fn enable_adaptive_main_loop_timing(config: AdaptiveTimingConfig) {
+    ADAPTIVE_TIMING
+        .with(|controller| *controller.borrow_mut() = Some(AdaptiveTimingController::new(config)));
+}
+
+/// Removes the calling thread's adaptive timing controller. The current timing mode is kept.
+pub fn disable_adaptive_main_loop_timing() {
+    ADAPTIVE_TIMING.with(|controller| *controller.borrow_mut() = None);
+}
+
+// Whether the main loop wrapper needs to measure the ticks for the controller.
+pub(crate) fn is_enabled() -> bool {
+    ADAPTIVE_TIMING.with(|controller| controller.borrow().is_some())
+}
+
+// Used by the main loop wrapper after each measured tick.
+pub(crate) fn observe_tick(tick_cost: f64) {
+    ADAPTIVE_TIMING.with(|controller| {
+        if let Some(controller) = &mut *controller.borrow_mut() {
+            controller.observe(tick_cost);
+        }
+    });
+}
@@ -0,0 +1,660 @@
+//! A persistent cache of downloaded assets, built on the [`fetch`](crate::fetch) module and an IndexedDB [`Store`].
+//!
+//! The assets are stored by content hash, so that identical files downloaded from different URLs are stored once,
+//! and an index maps each URL to its content hash, `ETag` and size.
+//! On later visits, cached assets with an `ETag` are revalidated with a conditional request, and served from IndexedDB if they didn't change.
+//! When the cached assets exceed the byte budget, the least recently used ones are evicted.
+//! With [`AssetCache::set_compression`], the assets that compress well are stored [`lz4`]-compressed.
+//! With [`AssetCache::set_tab_sharing`], the tabs of the origin sharing the cache download each missing asset once.
+
+use std::{
+    cell::RefCell,
+    collections::HashMap,
+    fmt::Display,
+    rc::{Rc, Weak},
+};
+
+use crate::{
+    fetch::{FetchRequest, FetchResponse},
+    idb::Store,
+    lz4, storage,
+    tabs::{request_lock, BroadcastChannel, TabLock},
+};
+
+// The key of the index in the store; the assets themselves are stored under `asset:<hash>` keys.
+const INDEX_KEY: &str = "index";
+
+/// The error given to the callback of [`AssetCache::get`].
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub enum AssetCacheError {
+    /// The asset isn't cached, or its revalidation failed with a status other than "not modified", and its download failed with the given HTTP status.
+    Download(u16),
+    /// The asset's data couldn't be read from IndexedDB, and its download failed with the given HTTP status.
+    Storage(u16),
+}
+impl Display for AssetCacheError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        match self {
+            AssetCacheError::Download(status) => {
+                write!(f, "Asset download failed with status {}", status)
+            }
+            AssetCacheError::Storage(status) => write!(
+                f,
+                "Cached asset unreadable, and download failed with status {}",
+                status
+            ),
+        }
+    }
+}
+
+type Callback = Box<dyn FnOnce(Result<Vec<u8>, AssetCacheError>)>;
+type Waiter = Box<dyn FnOnce(&AssetCache)>;
+
+#[derive(Debug, Clone)]
+struct CacheEntry {
+    etag: Option<String>,
+    hash: u64,
+    size: u64,
+    // The size of the stored asset, less than its size if it's LZ4-compressed.
+    stored_size: u64,
+    // The value of the cache's use counter when the entry was last used.
+    last_used: u64,
+}
+
+impl CacheEntry {
+    // Returns the asset's data from the stored one, or `None` if it can't be decompressed.
+    fn unpack(&self, stored: Vec<u8>) -> Option<Vec<u8>> {
+        if self.stored_size < self.size {
+            lz4::decompress(&stored, self.size as usize).ok()
+        } else {
+            Some(stored)
+        }
+    }
+}
+
+#[derive(Default)]
+struct Index {
+    entries: HashMap<String, CacheEntry>,
+    clock: u64,
+}
+
+// An entry of the index, as a line: `url \t etag \t hash \t size \t last_used \t stored_size`.
+// Indexes written before compression lack the stored size, which is then the size.
+fn format_entry(url: &str, entry: &CacheEntry) -> String {
+    format!(
+        "{}\t{}\t{:016x}\t{}\t{}\t{}\n",
+        url,
+        entry.etag.as_deref().unwrap_or(""),
+        entry.hash,
+        entry.size,
+        entry.last_used,
+        entry.stored_size
+    )
+}
+
+fn parse_entry(line: &str) -> Option<(String, CacheEntry)> {
+    let mut fields = line.trim_end_matches('\n').split('\t');
+    let url = fields.next()?.to_string();
+    let etag = fields.next()?;
+    let hash = u64::from_str_radix(fields.next()?, 16).ok()?;
+    let size = fields.next()?.parse().ok()?;
+    let last_used = fields.next()?.parse().ok()?;
+    let stored_size = fields
+        .next()
+        .and_then(|field| field.parse().ok())
+        .unwrap_or(size);
+    Some((
+        url,
+        CacheEntry {
+            etag: (!etag.is_empty()).then(|| etag.to_string()),
+            hash,
+            size,
+            stored_size,
+            last_used,
+        },
+    ))
+}
+
+impl Index {
+    // One line per entry, after a first line with the clock.
+    fn serialize(&self) -> String {
+        let mut out = format!("{}\n", self.clock);
+        for (url, entry) in &self.entries {
+            out.push_str(&format_entry(url, entry));
+        }
+        out
+    }
+
+    fn deserialize(data: &[u8]) -> Self {
+        let text = String::from_utf8_lossy(data);
+        let mut lines = text.lines();
+        let clock = lines.next().and_then(|line| line.parse().ok()).unwrap_or(0);
+
+        let entries = lines.filter_map(parse_entry).collect();
+
+        Self { entries, clock }
+    }
+
+    // The bytes taken by the stored assets; assets shared by several URLs count once.
+    fn stored_bytes(&self) -> u64 {
+        let mut sizes = HashMap::new();
+        for entry in self.entries.values() {
+            sizes.insert(entry.hash, entry.stored_size);
+        }
+        sizes.values().sum()
+    }
+}
+
+struct CacheState {
+    store: Store,
+    db_name: String,
+    byte_budget: u64,
+    compression: bool,
+    // The channel to the other tabs, if sharing is enabled.
+    channel: Option<BroadcastChannel>,
+    // `None` until the index is loaded from the store.
+    index: Option<Index>,
+    waiting: Vec<Waiter>,
+}
+
+// The 64-bit FNV-1a hash of the data.
+fn content_hash(data: &[u8]) -> u64 {
+    data.iter().fold(0xcbf29ce484222325, |hash, byte| {
+        (hash ^ *byte as u64).wrapping_mul(0x100000001b3)
+    })
+}
+
+fn asset_key(hash: u64) -> String {
+    format!("asset:{:016x}", hash)
+}
+
+/// A persistent cache of downloaded assets, stored in an IndexedDB database.
+///
+/// Cloning an `AssetCache` gives another handle to the same cache.
+///
+/// # Examples
+/// ```rust
+/// let cache = AssetCache::new("asset-cache", 256 << 20);
+///
+/// cache.get("textures/atlas.png", |result| match result {
+///     Ok(data) => println!("Atlas: {} bytes", data.len()),
+///     Err(err) => println!("{}", err),
+/// });
+/// ```
+#[derive(Clone)]
+pub struct AssetCache {
+    state: Rc<RefCell<CacheState>>,
+}
+
+impl AssetCache {
+    /// Opens the cache stored in the IndexedDB database with the given name.
+    ///
+    /// # Arguments
+    /// * `db_name` - The name of the IndexedDB database.
+    /// * `byte_budget` - The maximum number of bytes of cached assets; the least recently used ones are evicted beyond it.
+    pub fn new<T>(db_name: T, byte_budget: u64) -> Self
+    where
+        T: Into<String>,
+    {
+        let db_name = db_name.into();
+        let cache = Self {
+            state: Rc::new(RefCell::new(CacheState {
+                store: Store::new(db_name.clone()),
+                db_name,
+                byte_budget,
+                compression: false,
+                channel: None,
+                index: None,
+                waiting: Vec::new(),
+            })),
+        };
+
+        let loading_cache = cache.clone();
+        cache.store().load(INDEX_KEY, move |result| {
+            let index = result
+                .map(|data| Index::deserialize(&data))
+                .unwrap_or_default();
+
+            let waiting = {
+                let mut state = loading_cache.state.borrow_mut();
+                state.index = Some(index);
+                std::mem::take(&mut state.waiting)
+            };
+            for waiter in waiting {
+                waiter(&loading_cache);
+            }
+        });
+
+        cache
+    }
+
+    /// Opens the cache like [`AssetCache::new`], with a byte budget of the given fraction of the origin's storage quota,
+    /// once [`storage::estimate`] gives it; `fallback_budget` is used meanwhile, and if the quota is unknown.
+    ///
+    /// The quota is shared with the origin's other storage. Browsers evict a "best-effort" origin's data all at once
+    /// under storage pressure, which [`storage::persist`] asks them not to do.
+    ///
+    /// # Examples
+    /// ```rust
+    /// // Up to half of the quota, or 256 MiB where it's unknown.
+    /// let cache = AssetCache::with_quota("asset-cache", 0.5, 256 << 20);
+    /// ```
+    pub fn with_quota<T>(db_name: T, fraction: f64, fallback_budget: u64) -> Self
+    where
+        T: Into<String>,
+    {
+        let cache = Self::new(db_name, fallback_budget);
+        let sized_cache = cache.clone();
+        storage::estimate(move |estimate| {
+            if let Ok(estimate) = estimate {
+                if estimate.quota > 0 {
+                    sized_cache.set_byte_budget(estimate.fraction_of_quota(fraction));
+                }
+            }
+        });
+        cache
+    }
+
+    /// Sets the maximum number of bytes of cached assets, evicting the least recently used ones beyond it.
+    pub fn set_byte_budget(&self, byte_budget: u64) {
+        self.state.borrow_mut().byte_budget = byte_budget;
+        self.with_index(|cache| {
+            let before = cache.state.borrow().index.as_ref().unwrap().entries.len();
+            cache.evict();
+            if cache.state.borrow().index.as_ref().unwrap().entries.len() != before {
+                cache.save_index();
+            }
+        });
+    }
+
+    /// Returns the maximum number of bytes of cached assets.
+    pub fn byte_budget(&self) -> u64 {
+        self.state.borrow().byte_budget
+    }
+
+    /// Sets whether the assets downloaded from now on are stored [`lz4`]-compressed, if [`lz4::is_compressible`] finds they compress well,
+    /// e.g. JSON levels and meshes, but not already compressed images and audio. It's disabled by default.
+    ///
+    /// The compressed assets take less of the byte budget and of the storage quota, and are read faster from IndexedDB;
+    /// they're compressed when downloaded, and decompressed when served, in wasm.
+    pub fn set_compression(&self, enabled: bool) {
+        self.state.borrow_mut().compression = enabled;
+    }
+
+    /// Sets whether the tabs of the origin that enable it coordinate their downloads, so that a missing asset is downloaded by one of them.
+    /// It's disabled by default.
+    ///
+    /// The tab that misses an asset takes the asset's Web Lock: the other tabs missing it wait for the lock, and then find it
+    /// in the stored index. The entries a tab adds are sent to the others with a `BroadcastChannel`, so that their own
+    /// indexes keep them. Where Web Locks or `BroadcastChannel` are missing, each tab downloads its assets.
+    pub fn set_tab_sharing(&self, enabled: bool) {
+        if !enabled {
+            self.state.borrow_mut().channel = None;
+            return;
+        }
+        if self.state.borrow().channel.is_some() {
+            return;
+        }
+
+        // The channel is owned by the cache's state, so it only refers to it weakly.
+        let state = Rc::downgrade(&self.state);
+        let name = format!(
+            "emscripten-functions-assets:{}",
+            self.state.borrow().db_name
+        );
+        let channel = BroadcastChannel::open(&name, move |message| {
+            if let Some(state) = Weak::upgrade(&state) {
+                AssetCache { state }.merge_entry(message);
+            }
+        });
+        self.state.borrow_mut().channel = channel;
+    }
+
+    fn store(&self) -> Store {
+        self.state.borrow().store.clone()
+    }
+
+    // Runs `f` once the index is loaded.
+    fn with_index<F>(&self, f: F)
+    where
+        F: 'static + FnOnce(&AssetCache),
+    {
+        let ready = self.state.borrow().index.is_some();
+        if ready {
+            f(self);
+        } else {
+            self.state.borrow_mut().waiting.push(Box::new(f));
+        }
+    }
+
+    /// Gets the asset at the given URL, from the cache or by downloading it.
+    ///
+    /// A cached asset with an `ETag` is revalidated with the server first; if it's not modified, or the server is unreachable,
+    /// the cached asset is served. If the server no longer has it (404 or 410), it's evicted and the callback gets the download error.
+    /// A cached asset without an `ETag` is served without revalidation.
+    pub fn get<T, F>(&self, url: T, callback: F)
+    where
+        T: Into<String>,
+        F: 'static + FnOnce(Result<Vec<u8>, AssetCacheError>),
+    {
+        let url = url.into();
+        let callback: Callback = Box::new(callback);
+
+        self.with_index(move |cache| {
+            let entry = cache
+                .state
+                .borrow()
+                .index
+                .as_ref()
+                .unwrap()
+                .entries
+                .get(&url)
+                .cloned();
+
+            match entry {
+                Some(entry) if entry.etag.is_none() => cache.serve_cached(url, entry, 0, callback),
+                Some(entry) => cache.revalidate(url, entry, callback),
+                None if cache.state.borrow().channel.is_some() => {
+                    cache.download_shared(url, callback)
+                }
+                None => cache.download(url, None, callback, None),
+            }
+        });
+    }
+
+    /// Removes the asset at the given URL from the cache.
+    pub fn remove<T>(&self, url: T)
+    where
+        T: Into<String>,
+    {
+        let url = url.into();
+        self.with_index(move |cache| {
+            let removed = cache
+                .state
+                .borrow_mut()
+                .index
+                .as_mut()
+                .unwrap()
+                .entries
+                .remove(&url);
+            if let Some(entry) = removed {
+                cache.release_asset(entry.hash);
+                cache.save_index();
+            }
+        });
+    }
+
+    fn revalidate(&self, url: String, entry: CacheEntry, callback: Callback) {
+        let conditional = FetchRequest::new(url.clone())
+            .header("If-None-Match", entry.etag.clone().unwrap_or_default());
+        self.download(url, Some((conditional, entry)), callback, None);
+    }
+
+    // Downloads a missing asset while holding its Web Lock, unless another tab stored it meanwhile.
+    fn download_shared(&self, url: String, callback: Callback) {
+        let cache = self.clone();
+        let name = format!(
+            "emscripten-functions-asset:{}:{}",
+            self.state.borrow().db_name,
+            url
+        );
+        request_lock(&name, move |lock| {
+            let store = cache.store();
+            store.load(INDEX_KEY, move |result| {
+                let stored = result
+                    .ok()
+                    .and_then(|data| Index::deserialize(&data).entries.remove(&url));
+                match stored {
+                    Some(entry) => {
+                        drop(lock);
+                        cache
+                            .state
+                            .borrow_mut()
+                            .index
+                            .as_mut()
+                            .unwrap()
+                            .entries
+                            .insert(url.clone(), entry.clone());
+                        cache.serve_cached(url, entry, 0, callback);
+                    }
+                    None => cache.download(url, None, callback, Some(lock)),
+                }
+            });
+        });
+    }
+
+    // Adds an entry sent by another tab to the index.
+    fn merge_entry(&self, message: &[u8]) {
+        let Some((url, mut entry)) = parse_entry(&String::from_utf8_lossy(message)) else {
+            return;
+        };
+        let mut state = self.state.borrow_mut();
+        let Some(index) = state.index.as_mut() else {
+            // The index isn't loaded yet, and will have it.
+            return;
+        };
+        // The clocks of the tabs differ: the entry counts as just used.
+        index.clock += 1;
+        entry.last_used = index.clock;
+        index.entries.insert(url, entry);
+    }
+
+    // Downloads the asset, with the given conditional request and cached entry if revalidating,
+    // holding the asset's Web Lock until it's stored if given.
+    fn download(
+        &self,
+        url: String,
+        revalidation: Option<(FetchRequest, CacheEntry)>,
+        callback: Callback,
+        lock: Option<TabLock>,
+    ) {
+        let (request, cached_entry) = match revalidation {
+            Some((request, entry)) => (request, Some(entry)),
+            None => (FetchRequest::new(url.clone()), None),
+        };
+
+        // Only one of the handlers gets called, so they share the callback.
+        let callback = Rc::new(RefCell::new(Some(callback)));
+        let success_callback = callback.clone();
+        let error_callback = callback.clone();
+        let success_cache = self.clone();
+        let error_cache = self.clone();
+        let success_url = url.clone();
+        // Released with the handlers if the download fails.
+        let lock = Rc::new(RefCell::new(lock));
+
+        let handle = request
+            .on_success(move |response| {
+                if let Some(callback) = success_callback.take() {
+                    success_cache.insert(success_url, &response, callback, lock.take());
+                }
+            })
+            .on_error(move |response| {
+                let Some(callback) = error_callback.take() else {
+                    return;
+                };
+                let status = response.status();
+                match cached_entry {
+                    // Not modified, or unreachable server: the cached asset is served.
+                    Some(entry) if status == 304 || status == 0 => {
+                        error_cache.serve_cached(url, entry, status, callback)
+                    }
+                    // Gone from the server: so is the cached copy.
+                    Some(_) if status == 404 || status == 410 => {
+                        error_cache.remove(url);
+                        callback(Err(AssetCacheError::Download(status)));
+                    }
+                    _ => callback(Err(AssetCacheError::Download(status))),
+                }
+            })
+            .send();
+
+        if handle.is_none() {
+            if let Some(callback) = callback.take() {
+                callback(Err(AssetCacheError::Download(0)));
+            }
+        }
+    }
+
+    fn serve_cached(&self, url: String, entry: CacheEntry, status: u16, callback: Callback) {
+        let cache = self.clone();
+        self.store().load(&asset_key(entry.hash), move |result| {
+            match result.ok().and_then(|stored| entry.unpack(stored)) {
+                Some(data) => {
+                    cache.touch(&url);
+                    callback(Ok(data));
+                }
+                None => {
+                    // The index is out of sync with the stored assets: forget the entry.
+                    cache
+                        .state
+                        .borrow_mut()
+                        .index
+                        .as_mut()
+                        .unwrap()
+                        .entries
+                        .remove(&url);
+                    cache.save_index();
+                    callback(Err(AssetCacheError::Storage(status)));
+                }
+            }
+        });
+    }
+
+    fn insert(
+        &self,
+        url: String,
+        response: &FetchResponse,
+        callback: Callback,
+        lock: Option<TabLock>,
+    ) {
+        let data = response.data().to_vec();
+        let hash = content_hash(&data);
+        let etag = response
+            .headers()
+            .into_iter()
+            .find(|(name, _)| name.eq_ignore_ascii_case("etag"))
+            .map(|(_, value)| value);
+
+        // The data is compressed only if no other URL already stored it.
+        let (stored_size, compression) = {
+            let state = self.state.borrow();
+            let stored_size = state
+                .index
+                .as_ref()
+                .unwrap()
+                .entries
+                .values()
+                .find(|entry| entry.hash == hash)
+                .map(|entry| entry.stored_size);
+            (stored_size, state.compression)
+        };
+        let already_stored = stored_size.is_some();
+        let compressed = (!already_stored && compression && lz4::is_compressible(&data))
+            .then(|| lz4::compress(&data))
+            .filter(|compressed| compressed.len() < data.len());
+        let stored_size = stored_size.unwrap_or_else(|| {
+            compressed
+                .as_ref()
+                .map_or(data.len(), |compressed| compressed.len()) as u64
+        });
+
+        let replaced = {
+            let mut state = self.state.borrow_mut();
+            let state = &mut *state;
+            let index = state.index.as_mut().unwrap();
+            index.clock += 1;
+            let entry = CacheEntry {
+                etag,
+                hash,
+                size: data.len() as u64,
+                stored_size,
+                last_used: index.clock,
+            };
+            if let Some(channel) = &state.channel {
+                channel.post(format_entry(&url, &entry).as_bytes());
+            }
+            index.entries.insert(url, entry)
+        };
+        if let Some(replaced) = replaced {
+            if replaced.hash != hash {
+                self.release_asset(replaced.hash);
+            }
+        }
+
+        if !already_stored {
+            let stored = compressed.unwrap_or_else(|| data.clone());
+            self.store().store(asset_key(hash), stored, |_| {});
+        }
+        self.evict();
+        // The other tabs waiting for the lock find the entry once the index is stored.
+        self.save_index_then(move || drop(lock));
+
+        callback(Ok(data));
+    }
+
+    fn touch(&self, url: &str) {
+        {
+            let mut state = self.state.borrow_mut();
+            let index = state.index.as_mut().unwrap();
+            index.clock += 1;
+            let clock = index.clock;
+            if let Some(entry) = index.entries.get_mut(url) {
+                entry.last_used = clock;
+            }
+        }
+        self.save_index();
+    }
+
+    // Deletes the stored asset with the given hash, if no URL of the index refers to it anymore.
+    fn release_asset(&self, hash: u64) {
+        let referenced = self
+            .state
+            .borrow()
+            .index
+            .as_ref()
+            .unwrap()
+            .entries
+            .values()
+            .any(|entry| entry.hash == hash);
+        if !referenced {
+            self.store().delete(&asset_key(hash), |_| {});
+        }
+    }
+
+    // Evicts the least recently used entries until the stored assets fit in the byte budget.
+    fn evict(&self) {
+        loop {
+            let evicted = {
+                let mut state = self.state.borrow_mut();
+                let byte_budget = state.byte_budget;
+                let index = state.index.as_mut().unwrap();
+                if index.stored_bytes() <= byte_budget || index.entries.len() <= 1 {
+                    return;
+                }
+
+                let oldest = index
+                    .entries
+                    .iter()
+                    .min_by_key(|(_, entry)| entry.last_used)
+                    .map(|(url, _)| url.clone())
+                    .unwrap();
+                index.entries.remove(&oldest).unwrap()
+            };
+            self.release_asset(evicted.hash);
+        }
+    }
+
+    fn save_index(&self) {
+        self.save_index_then(|| {});
+    }
+
+    fn save_index_then<F>(&self, callback: F)
+    where
+        F: 'static + FnOnce(),
+    {
+        let index = self.state.borrow().index.as_ref().unwrap().serialize();
+        // The index is stored in the same batch as the assets changed in this tick.
+        self.store().store(INDEX_KEY, index, move |_| callback());
+    }
+}
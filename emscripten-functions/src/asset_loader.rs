@@ -0,0 +1,421 @@
+//! A download scheduler built on the [`wget`](crate::wget) module, that keeps a bounded number of downloads in flight and starts them by priority.
+//!
+//! Browsers throttle the number of parallel connections, so queueing every asset at once makes small critical files wait behind large ones.
+//! The [`AssetLoader`] instead only starts up to a fixed number of downloads at a time, picking the highest priority queued asset whenever one finishes,
+//! and reports the aggregate progress of all its assets.
+//!
+//! Speculative downloads, e.g. of the next areas of the map, are queued with [`AssetLoader::prefetch`]: they're started after
+//! every other asset, with a low [`FetchPriority`] hint, and [`AssetLoader::cancel_prefetches`] aborts them once they're obsolete.
+
+use std::{
+    cell::RefCell,
+    cmp::Ordering,
+    collections::{BinaryHeap, HashMap},
+    os::raw::c_int,
+    rc::Rc,
+};
+
+use crate::{
+    emscripten::{hold_main_loop_until, push_main_loop_blocker, set_main_loop_expected_blockers},
+    malloc_buffer::MallocBuffer,
+    wget::{FetchPriority, WgetError, WgetHandle, WgetRequest},
+};
+
+// The priority of the prefetched assets, below that of any asset added with `AssetLoader::add`.
+const PREFETCH_PRIORITY: i32 = i32::MIN;
+
+/// The aggregate progress of an [`AssetLoader`], given to its progress handler.
+#[derive(Debug, Clone, Default, PartialEq, Eq)]
+pub struct AssetLoaderProgress {
+    /// The number of assets waiting to be started.
+    pub queued: usize,
+    /// The number of assets being downloaded.
+    pub in_flight: usize,
+    /// The number of successfully downloaded assets.
+    pub completed: usize,
+    /// The number of assets whose download failed.
+    pub failed: usize,
+    /// The number of bytes downloaded, over all the started assets.
+    pub loaded_bytes: u64,
+    /// The total number of bytes of the started assets, as far as the server reported them.
+    /// Queued assets aren't counted, as their size isn't known yet.
+    pub total_bytes: u64,
+}
+
+impl AssetLoaderProgress {
+    /// Returns `true` if there are no assets queued or in flight.
+    pub fn is_done(&self) -> bool {
+        self.queued == 0 && self.in_flight == 0
+    }
+}
+
+type OnProgress = Box<dyn FnMut(&AssetLoaderProgress)>;
+
+struct QueuedAsset {
+    priority: i32,
+    // The insertion order, to start assets of the same priority first come, first served.
+    sequence: u64,
+    url: String,
+    speculative: bool,
+    onload: Box<dyn FnOnce(MallocBuffer)>,
+    onerror: Box<dyn FnOnce(WgetError)>,
+}
+
+impl PartialEq for QueuedAsset {
+    fn eq(&self, other: &Self) -> bool {
+        self.cmp(other) == Ordering::Equal
+    }
+}
+impl Eq for QueuedAsset {}
+impl PartialOrd for QueuedAsset {
+    fn partial_cmp(&self, other: &Self) -> Option<Ordering> {
+        Some(self.cmp(other))
+    }
+}
+impl Ord for QueuedAsset {
+    // The greatest asset is started first: the highest priority, then the lowest sequence number.
+    fn cmp(&self, other: &Self) -> Ordering {
+        self.priority
+            .cmp(&other.priority)
+            .then_with(|| other.sequence.cmp(&self.sequence))
+    }
+}
+
+struct LoaderState {
+    max_in_flight: usize,
+    next_sequence: u64,
+    queue: BinaryHeap<QueuedAsset>,
+    // The (loaded, total) byte counts of the in-flight assets, by sequence number.
+    in_flight: HashMap<u64, (u64, u64)>,
+    // The handles of the in-flight prefetches, by sequence number.
+    prefetches: HashMap<u64, WgetHandle>,
+    completed: usize,
+    failed: usize,
+    // The byte counts of the finished assets.
+    finished_loaded_bytes: u64,
+    finished_total_bytes: u64,
+    onprogress: Option<OnProgress>,
+    // Whether each finished asset pushes a counted main loop blocker, set by `hold_main_loop`.
+    holding: bool,
+}
+
+impl LoaderState {
+    fn progress(&self) -> AssetLoaderProgress {
+        let (loaded, total) = self
+            .in_flight
+            .values()
+            .fold((0, 0), |(loaded, total), (l, t)| (loaded + l, total + t));
+
+        AssetLoaderProgress {
+            queued: self.queue.len(),
+            in_flight: self.in_flight.len(),
+            completed: self.completed,
+            failed: self.failed,
+            loaded_bytes: self.finished_loaded_bytes + loaded,
+            total_bytes: self.finished_total_bytes + total,
+        }
+    }
+}
+
+/// Downloads any number of assets, with at most a fixed number of downloads in flight, starting the highest priority ones first.
+///
+/// Cloning an `AssetLoader` gives another handle to the same loader.
+/// The loader stays alive until its last handle is dropped and its downloads are done.
+///
+/// # Examples
+/// ```rust
+/// let loader = AssetLoader::new(4);
+/// loader.on_progress(|progress| {
+///     println!("{}/{} bytes", progress.loaded_bytes, progress.total_bytes);
+///     if progress.is_done() {
+///         println!("All assets loaded");
+///     }
+/// });
+///
+/// loader.add("textures/huge.png", 0, |data| println!("Texture: {} bytes", data.len()), |err| println!("{}", err));
+/// // Started before the texture, once a download slot is free.
+/// loader.add("shaders/main.wgsl", 10, |data| println!("Shader: {} bytes", data.len()), |err| println!("{}", err));
+/// ```
+#[derive(Clone)]
+pub struct AssetLoader {
+    state: Rc<RefCell<LoaderState>>,
+}
+
+impl AssetLoader {
+    /// Creates a loader that keeps at most `max_in_flight` downloads running at the same time.
+    pub fn new(max_in_flight: usize) -> Self {
+        assert!(
+            max_in_flight > 0,
+            "at least 1 download must be allowed in flight"
+        );
+
+        Self {
+            state: Rc::new(RefCell::new(LoaderState {
+                max_in_flight,
+                next_sequence: 0,
+                queue: BinaryHeap::new(),
+                in_flight: HashMap::new(),
+                prefetches: HashMap::new(),
+                completed: 0,
+                failed: 0,
+                finished_loaded_bytes: 0,
+                finished_total_bytes: 0,
+                onprogress: None,
+                holding: false,
+            })),
+        }
+    }
+
+    /// Sets the function called with the aggregate progress whenever a download progresses, finishes or fails.
+    pub fn on_progress<F>(&self, onprogress: F)
+    where
+        F: 'static + FnMut(&AssetLoaderProgress),
+    {
+        self.state.borrow_mut().onprogress = Some(Box::new(onprogress));
+    }
+
+    /// Queues the download of an asset, starting it right away if a download slot is free.
+    ///
+    /// # Arguments
+    /// * `url` - The URL to download.
+    /// * `priority` - Queued assets with a higher priority are started first; those of the same priority are started in the order they were added.
+    /// * `onload` - The function called with the downloaded data.
+    /// * `onerror` - The function called if the download fails.
+    pub fn add<T, L, E>(&self, url: T, priority: i32, onload: L, onerror: E)
+    where
+        T: Into<String>,
+        L: 'static + FnOnce(MallocBuffer),
+        E: 'static + FnOnce(WgetError),
+    {
+        self.queue(
+            url.into(),
+            priority,
+            false,
+            Box::new(onload),
+            Box::new(onerror),
+        );
+    }
+
+    /// Queues the speculative download of an asset that may be needed soon, e.g. from the areas the player is heading to.
+    ///
+    /// It's started once no asset added with [`add`](Self::add) is queued, and downloaded with the [`FetchPriority::Low`] hint,
+    /// so that the browser gives the bandwidth to the other downloads first.
+    ///
+    /// # Examples
+    /// ```rust
+    /// // The player turned around: the chunks ahead changed.
+    /// loader.cancel_prefetches();
+    /// for chunk in chunks_ahead(&player) {
+    ///     loader.prefetch(chunk.url(), move |data| cache_chunk(chunk, data), |_| {});
+    /// }
+    /// ```
+    pub fn prefetch<T, L, E>(&self, url: T, onload: L, onerror: E)
+    where
+        T: Into<String>,
+        L: 'static + FnOnce(MallocBuffer),
+        E: 'static + FnOnce(WgetError),
+    {
+        self.queue(
+            url.into(),
+            PREFETCH_PRIORITY,
+            true,
+            Box::new(onload),
+            Box::new(onerror),
+        );
+    }
+
+    /// Drops the queued prefetches and aborts those in flight, freeing their download slots. None of their handlers are called.
+    pub fn cancel_prefetches(&self) {
+        let aborted: Vec<WgetHandle> = {
+            let mut state = self.state.borrow_mut();
+            state.queue.retain(|asset| !asset.speculative);
+            let prefetches: Vec<_> = state.prefetches.drain().collect();
+            prefetches
+                .into_iter()
+                .map(|(sequence, handle)| {
+                    state.in_flight.remove(&sequence);
+                    handle
+                })
+                .collect()
+        };
+        for handle in aborted {
+            handle.abort();
+        }
+
+        self.report_progress();
+        self.pump();
+    }
+
+    /// Returns the current aggregate progress.
+    pub fn progress(&self) -> AssetLoaderProgress {
+        self.state.borrow().progress()
+    }
+
+    /// Holds the main loop's function until all the assets queued or in flight are done, as main loop blockers.
+    ///
+    /// The progress given to `Module.setStatus` counts the assets done out of those, one counted blocker being pushed as each asset finishes.
+    /// Assets added afterwards are waited for too, but aren't counted in the progress.
+    ///
+    /// # Examples
+    /// ```rust
+    /// loader.add("level1.bin", 0, load_level, |err| println!("{}", err));
+    /// loader.hold_main_loop();
+    /// // The first frame is drawn once `level1.bin` is loaded.
+    /// set_main_loop(draw_frame, 0, false);
+    /// ```
+    pub fn hold_main_loop(&self) {
+        let outstanding = {
+            let mut state = self.state.borrow_mut();
+            state.holding = true;
+            state.queue.len() + state.in_flight.len()
+        };
+        set_main_loop_expected_blockers(outstanding as c_int);
+
+        let loader = self.clone();
+        hold_main_loop_until("asset loader", move || {
+            let done = loader.progress().is_done();
+            if done {
+                loader.state.borrow_mut().holding = false;
+            }
+            done
+        });
+    }
+
+    /// Drops all the queued assets that haven't been started yet. The downloads in flight go on.
+    pub fn clear_queue(&self) {
+        self.state.borrow_mut().queue.clear();
+        self.report_progress();
+    }
+
+    fn queue(
+        &self,
+        url: String,
+        priority: i32,
+        speculative: bool,
+        onload: Box<dyn FnOnce(MallocBuffer)>,
+        onerror: Box<dyn FnOnce(WgetError)>,
+    ) {
+        {
+            let mut state = self.state.borrow_mut();
+            let sequence = state.next_sequence;
+            state.next_sequence += 1;
+            state.queue.push(QueuedAsset {
+                priority,
+                sequence,
+                url,
+                speculative,
+                onload,
+                onerror,
+            });
+        }
+
+        self.pump();
+    }
+
+    // Starts queued assets while there are free download slots.
+    fn pump(&self) {
+        loop {
+            let asset = {
+                let mut state = self.state.borrow_mut();
+                if state.in_flight.len() >= state.max_in_flight {
+                    break;
+                }
+                match state.queue.pop() {
+                    Some(asset) => {
+                        state.in_flight.insert(asset.sequence, (0, 0));
+                        asset
+                    }
+                    None => break,
+                }
+            };
+
+            self.start(asset);
+        }
+    }
+
+    fn start(&self, asset: QueuedAsset) {
+        let sequence = asset.sequence;
+        let onload = asset.onload;
+        let onerror = asset.onerror;
+
+        let progress_loader = self.clone();
+        let load_loader = self.clone();
+        let error_loader = self.clone();
+        let priority = if asset.speculative {
+            FetchPriority::Low
+        } else {
+            FetchPriority::Auto
+        };
+
+        let handle = WgetRequest::new(asset.url)
+            .priority(priority)
+            .on_progress(move |loaded: c_int, total: c_int| {
+                if let Some(bytes) = progress_loader
+                    .state
+                    .borrow_mut()
+                    .in_flight
+                    .get_mut(&sequence)
+                {
+                    *bytes = (loaded.max(0) as u64, total.max(0) as u64);
+                }
+                progress_loader.report_progress();
+            })
+            .on_load(move |data| {
+                load_loader.finish(sequence, Some(data.len() as u64));
+                onload(data);
+                load_loader.report_progress();
+                load_loader.pump();
+            })
+            .on_error(move |err| {
+                error_loader.finish(sequence, None);
+                onerror(err);
+                error_loader.report_progress();
+                error_loader.pump();
+            })
+            .send();
+        if asset.speculative {
+            self.state.borrow_mut().prefetches.insert(sequence, handle);
+        }
+    }
+
+    // Moves an in-flight asset to the finished ones; `size` is `None` if it failed.
+    fn finish(&self, sequence: u64, size: Option<u64>) {
+        let mut state = self.state.borrow_mut();
+        let (loaded, total) = state.in_flight.remove(&sequence).unwrap_or((0, 0));
+        state.prefetches.remove(&sequence);
+
+        match size {
+            Some(size) => {
+                state.completed += 1;
+                state.finished_loaded_bytes += size;
+                state.finished_total_bytes += size;
+            }
+            None => {
+                state.failed += 1;
+                state.finished_loaded_bytes += loaded;
+                state.finished_total_bytes += total;
+            }
+        }
+
+        if state.holding {
+            push_main_loop_blocker("asset loaded", || {});
+        }
+    }
+
+    fn report_progress(&self) {
+        // The handler is taken out during the call, so that it can use the loader.
+        let (onprogress, progress) = {
+            let mut state = self.state.borrow_mut();
+            (state.onprogress.take(), state.progress())
+        };
+
+        if let Some(mut onprogress) = onprogress {
+            onprogress(&progress);
+
+            let mut state = self.state.borrow_mut();
+            if state.onprogress.is_none() {
+                state.onprogress = Some(onprogress);
+            }
+        }
+    }
+}
@@ -0,0 +1,480 @@
+//! A voice mixer for the audio worklet's `process` function, which never allocates nor blocks on the audio rendering thread.
+//!
+//! [`mixer`] creates a pair: the [`MixerControl`] plays and changes the voices from the game's thread, and the [`Mixer`], moved
+//! into the `process` function of [`AudioContext::create_node`], renders them into the [`QUANTUM_SIZE`] frames of each call,
+//! in place. They talk through lock-free [`spsc`] rings: the commands go to the mixer, and the clips of the finished voices
+//! come back to the control, which drops them, so that the audio thread never frees memory either.
+//!
+//! Each voice plays a mono clip with its gain, constant-power pan and playback rate, resampled with linear interpolation.
+//! The gain changes are ramped over a quantum, so that they don't click. Built with `-C target-feature=+simd128`,
+//! each voice is mixed 4 frames at a time with SIMD instructions.
+//!
+//! [`AudioContext::create_node`]: crate::webaudio::AudioContext::create_node
+
+use std::{fmt::Display, sync::Arc};
+
+use crate::{
+    spsc::{self, Consumer, Producer},
+    webaudio::QUANTUM_SIZE,
+};
+
+/// The samples of a mono clip, shared by the voices playing it.
+pub type Clip = Arc<[f32]>;
+
+/// The parameters of a voice, given to [`MixerControl::play`].
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct VoiceParams {
+    /// The linear gain, 1 for the clip's level.
+    pub gain: f32,
+    /// The position in the stereo field, from -1 (left) to 1 (right).
+    pub pan: f32,
+    /// The number of clip frames per output frame: the clip's sample rate over the context's, times the pitch.
+    pub rate: f32,
+    /// Whether the clip starts again once it ended, until the voice is stopped.
+    pub looping: bool,
+}
+
+impl Default for VoiceParams {
+    fn default() -> Self {
+        Self {
+            gain: 1.0,
+            pan: 0.0,
+            rate: 1.0,
+            looping: false,
+        }
+    }
+}
+
+/// A voice played by [`MixerControl::play`]. It stays valid until the voice ends, and is never reused for another one.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct VoiceId {
+    slot: u32,
+    generation: u32,
+}
+
+/// The error of a voice that couldn't be played or changed.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum MixerError {
+    /// All the voices of the mixer are playing.
+    NoFreeVoice,
+    /// The voice ended, or was stopped.
+    VoiceEnded,
+    /// The mixer's command queue is full: it hasn't rendered since the last commands, e.g. because the context is suspended.
+    QueueFull,
+}
+
+impl Display for MixerError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        match self {
+            MixerError::NoFreeVoice => write!(f, "All the voices are playing"),
+            MixerError::VoiceEnded => write!(f, "The voice ended"),
+            MixerError::QueueFull => write!(f, "The mixer's command queue is full"),
+        }
+    }
+}
+
+enum Command {
+    Play {
+        slot: usize,
+        clip: Clip,
+        gains: (f32, f32),
+        rate: f32,
+        looping: bool,
+    },
+    Set {
+        slot: usize,
+        gains: (f32, f32),
+        rate: f32,
+    },
+    Stop {
+        slot: usize,
+    },
+}
+
+// The left and right gains of a voice, with a constant-power pan.
+fn pan_gains(params: &VoiceParams) -> (f32, f32) {
+    let angle = (params.pan.clamp(-1.0, 1.0) + 1.0) * std::f32::consts::FRAC_PI_4;
+    (params.gain * angle.cos(), params.gain * angle.sin())
+}
+
+/// Creates a mixer of at most `max_voices` voices playing at once, and its control.
+///
+/// # Examples
+/// ```rust
+/// let (mut control, mut mixer) = mixer(64);
+/// let node = context.create_node("mixer", 0, &[2], move |_, outputs, _| {
+///     if let Some(output) = outputs.first_mut() {
+///         mixer.render(unsafe { frame_samples_mut(output) });
+///     }
+///     true
+/// });
+///
+/// let explosion: Clip = decoded.channels.swap_remove(0).into();
+/// let voice = control
+///     .play(explosion.clone(), VoiceParams { pan: -0.5, ..Default::default() })
+///     .unwrap();
+/// control.set_gain(voice, 0.5).ok();
+/// ```
+pub fn mixer(max_voices: usize) -> (MixerControl, Mixer) {
+    // Each voice is at most played, changed a few times and stopped between two renders.
+    let (commands, command_queue) = spsc::channel(max_voices.max(1) * 4);
+    // Each voice ends once, and its slot isn't reused before its clip came back, so this ring never fills up.
+    let (ended, ended_queue) = spsc::channel(max_voices.max(1));
+    (
+        MixerControl {
+            commands,
+            ended: ended_queue,
+            slots: (0..max_voices)
+                .map(|_| SlotState {
+                    generation: 0,
+                    params: None,
+                })
+                .collect(),
+            free: (0..max_voices).rev().collect(),
+        },
+        Mixer {
+            commands: command_queue,
+            ended,
+            voices: (0..max_voices).map(|_| None).collect(),
+        },
+    )
+}
+
+struct SlotState {
+    generation: u32,
+    // The parameters of the playing voice, or `None` if the slot is free or its voice ended.
+    params: Option<VoiceParams>,
+}
+
+/// The side of a [`mixer`] playing and changing its voices, e.g. on the game's thread.
+pub struct MixerControl {
+    commands: Producer<Command>,
+    ended: Consumer<(usize, Clip)>,
+    slots: Vec<SlotState>,
+    free: Vec<usize>,
+}
+
+impl MixerControl {
+    // Frees the slots of the voices that ended, dropping their clips here rather than on the audio thread.
+    fn collect(&mut self) {
+        while let Some((slot, clip)) = self.ended.try_pop() {
+            drop(clip);
+            let state = &mut self.slots[slot];
+            state.generation = state.generation.wrapping_add(1);
+            state.params = None;
+            self.free.push(slot);
+        }
+    }
+
+    fn playing(&mut self, voice: VoiceId) -> Result<&mut VoiceParams, MixerError> {
+        self.collect();
+        let state = &mut self.slots[voice.slot as usize];
+        match &mut state.params {
+            Some(params) if state.generation == voice.generation => Ok(params),
+            _ => Err(MixerError::VoiceEnded),
+        }
+    }
+
+    fn send(&mut self, command: Command) -> Result<(), MixerError> {
+        self.commands
+            .try_push(command)
+            .map_err(|_| MixerError::QueueFull)
+    }
+
+    /// Plays `clip` with the given parameters, from the next render on.
+    pub fn play(&mut self, clip: Clip, params: VoiceParams) -> Result<VoiceId, MixerError> {
+        self.collect();
+        let slot = *self.free.last().ok_or(MixerError::NoFreeVoice)?;
+        self.send(Command::Play {
+            slot,
+            clip,
+            gains: pan_gains(&params),
+            rate: params.rate.max(0.0),
+            looping: params.looping,
+        })?;
+        self.free.pop();
+        let state = &mut self.slots[slot];
+        state.params = Some(params);
+        Ok(VoiceId {
+            slot: slot as u32,
+            generation: state.generation,
+        })
+    }
+
+    fn update<F>(&mut self, voice: VoiceId, change: F) -> Result<(), MixerError>
+    where
+        F: FnOnce(&mut VoiceParams),
+    {
+        let params = self.playing(voice)?;
+        let mut changed = *params;
+        change(&mut changed);
+        let command = Command::Set {
+            slot: voice.slot as usize,
+            gains: pan_gains(&changed),
+            rate: changed.rate.max(0.0),
+        };
+        self.send(command)?;
+        *self.playing(voice)? = changed;
+        Ok(())
+    }
+
+    /// Changes the gain of a playing voice, ramped over the next render.
+    pub fn set_gain(&mut self, voice: VoiceId, gain: f32) -> Result<(), MixerError> {
+        self.update(voice, |params| params.gain = gain)
+    }
+
+    /// Changes the pan of a playing voice, ramped over the next render.
+    pub fn set_pan(&mut self, voice: VoiceId, pan: f32) -> Result<(), MixerError> {
+        self.update(voice, |params| params.pan = pan)
+    }
+
+    /// Changes the playback rate of a playing voice.
+    pub fn set_rate(&mut self, voice: VoiceId, rate: f32) -> Result<(), MixerError> {
+        self.update(voice, |params| params.rate = rate)
+    }
+
+    /// Stops a playing voice, fading it out over the next render.
+    pub fn stop(&mut self, voice: VoiceId) -> Result<(), MixerError> {
+        self.playing(voice)?;
+        self.send(Command::Stop {
+            slot: voice.slot as usize,
+        })?;
+        // The slot is freed once the mixer gives the clip back.
+        self.slots[voice.slot as usize].params = None;
+        Ok(())
+    }
+
+    /// Returns `true` if the voice is still playing, as far as the control knows: it ends once the mixer reported it.
+    pub fn is_playing(&mut self, voice: VoiceId) -> bool {
+        self.playing(voice).is_ok()
+    }
+}
+
+struct Voice {
+    clip: Clip,
+    // The position in the clip: the frame before it, and the distance to it, in [0, 1).
+    index: usize,
+    frac: f32,
+    rate: f32,
+    looping: bool,
+    // The gains at the start of the next render, and those it ramps to.
+    gains: (f32, f32),
+    target: (f32, f32),
+    stopping: bool,
+}
+
+/// The side of a [`mixer`] rendering its voices, on the audio rendering thread.
+pub struct Mixer {
+    commands: Consumer<Command>,
+    ended: Producer<(usize, Clip)>,
+    voices: Vec<Option<Voice>>,
+}
+
+impl Mixer {
+    fn apply(&mut self, command: Command) {
+        match command {
+            Command::Play {
+                slot,
+                clip,
+                gains,
+                rate,
+                looping,
+            } => {
+                self.voices[slot] = Some(Voice {
+                    clip,
+                    index: 0,
+                    frac: 0.0,
+                    rate,
+                    looping,
+                    gains,
+                    target: gains,
+                    stopping: false,
+                });
+            }
+            Command::Set { slot, gains, rate } => {
+                if let Some(voice) = &mut self.voices[slot] {
+                    if !voice.stopping {
+                        voice.target = gains;
+                        voice.rate = rate;
+                    }
+                }
+            }
+            Command::Stop { slot } => {
+                if let Some(voice) = &mut self.voices[slot] {
+                    voice.target = (0.0, 0.0);
+                    voice.stopping = true;
+                }
+            }
+        }
+    }
+
+    /// Renders the voices into the [`QUANTUM_SIZE`] frames of `output`, laid out like [`frame_samples_mut`]: the left channel,
+    /// then the right one. Their previous samples are overwritten. A mono output gets the sum of both channels, scaled so that
+    /// a centered voice keeps its gain, and the channels past the second one get silence.
+    ///
+    /// [`frame_samples_mut`]: crate::webaudio::frame_samples_mut
+    pub fn render(&mut self, output: &mut [f32]) {
+        while let Some(command) = self.commands.try_pop() {
+            self.apply(command);
+        }
+
+        output.fill(0.0);
+        if output.len() < QUANTUM_SIZE {
+            return;
+        }
+        let stereo = output.len() >= 2 * QUANTUM_SIZE;
+        let mut mono = [0.0; QUANTUM_SIZE];
+        let (left, rest) = output.split_at_mut(QUANTUM_SIZE);
+        let (left, right): (&mut [f32; QUANTUM_SIZE], &mut [f32; QUANTUM_SIZE]) =
+            match rest.get_mut(..QUANTUM_SIZE) {
+                Some(right) => (left.try_into().unwrap(), right.try_into().unwrap()),
+                None => (left.try_into().unwrap(), &mut mono),
+            };
+
+        for slot in 0..self.voices.len() {
+            let Some(voice) = &mut self.voices[slot] else {
+                continue;
+            };
+            if !mix_voice(voice, left, right) || (voice.stopping && voice.gains == (0.0, 0.0)) {
+                let voice = self.voices[slot].take().unwrap();
+                // The ring has room for every voice, see `mixer`.
+                let _ = self.ended.try_push((slot, voice.clip));
+            }
+        }
+
+        if !stereo {
+            for (left, right) in left.iter_mut().zip(mono.iter()) {
+                *left = (*left + right) * std::f32::consts::FRAC_1_SQRT_2;
+            }
+        }
+    }
+}
+
+// Returns the clip's sample at `index`, wrapped around for a looping voice, and silence past the end otherwise.
+#[inline(always)]
+fn sample_at(clip: &[f32], index: usize, looping: bool) -> f32 {
+    match clip.get(index) {
+        Some(&sample) => sample,
+        None if looping => clip[index % clip.len()],
+        None => 0.0,
+    }
+}
+
+// Mixes a quantum of the voice into the output, and returns `false` once the voice ended.
+fn mix_voice(
+    voice: &mut Voice,
+    left: &mut [f32; QUANTUM_SIZE],
+    right: &mut [f32; QUANTUM_SIZE],
+) -> bool {
+    let len = voice.clip.len();
+    if len == 0 {
+        return false;
+    }
+    let steps = (
+        (voice.target.0 - voice.gains.0) / QUANTUM_SIZE as f32,
+        (voice.target.1 - voice.gains.1) / QUANTUM_SIZE as f32,
+    );
+
+    // The interpolation reads the frame after the last position of the quantum.
+    let last = voice.index + (voice.frac + (QUANTUM_SIZE - 1) as f32 * voice.rate) as usize + 1;
+    if last < len {
+        mix_block(voice, steps, left, right);
+    } else {
+        // Near the end of the clip, each frame is wrapped around or cut.
+        for frame in 0..QUANTUM_SIZE {
+            let position = voice.frac + frame as f32 * voice.rate;
+            let mut index = voice.index + position as usize;
+            if index >= len {
+                if !voice.looping {
+                    break;
+                }
+                index %= len;
+            }
+            let t = position.fract();
+            let a = voice.clip[index];
+            let b = sample_at(&voice.clip, index + 1, voice.looping);
+            let sample = a + (b - a) * t;
+            left[frame] += sample * (voice.gains.0 + steps.0 * frame as f32);
+            right[frame] += sample * (voice.gains.1 + steps.1 * frame as f32);
+        }
+    }
+
+    voice.gains = voice.target;
+    let position = voice.frac + QUANTUM_SIZE as f32 * voice.rate;
+    voice.index += position as usize;
+    voice.frac = position.fract();
+    if voice.index >= len {
+        if !voice.looping {
+            return false;
+        }
+        voice.index %= len;
+    }
+    true
+}
+
+// Mixes a quantum of the voice whose interpolated frames are all in the clip.
+#[cfg(target_feature = "simd128")]
+fn mix_block(
+    voice: &Voice,
+    steps: (f32, f32),
+    left: &mut [f32; QUANTUM_SIZE],
+    right: &mut [f32; QUANTUM_SIZE],
+) {
+    use core::arch::wasm32::{
+        f32x4, f32x4_add, f32x4_extract_lane, f32x4_floor, f32x4_mul, f32x4_splat, f32x4_sub, v128,
+        v128_load, v128_store,
+    };
+
+    let clip = &voice.clip[voice.index..];
+    let lanes = f32x4(0.0, 1.0, 2.0, 3.0);
+    let rate = f32x4_splat(voice.rate);
+    let step_left = f32x4_splat(steps.0);
+    let step_right = f32x4_splat(steps.1);
+    for frame in (0..QUANTUM_SIZE).step_by(4) {
+        let base = f32x4_splat(frame as f32);
+        let positions = f32x4_add(
+            f32x4_splat(voice.frac),
+            f32x4_mul(f32x4_add(base, lanes), rate),
+        );
+        let floors = f32x4_floor(positions);
+        let t = f32x4_sub(positions, floors);
+
+        // Wasm SIMD has no gather: the 4 pairs of samples are loaded one at a time.
+        let i0 = f32x4_extract_lane::<0>(floors) as usize;
+        let i1 = f32x4_extract_lane::<1>(floors) as usize;
+        let i2 = f32x4_extract_lane::<2>(floors) as usize;
+        let i3 = f32x4_extract_lane::<3>(floors) as usize;
+        let a = f32x4(clip[i0], clip[i1], clip[i2], clip[i3]);
+        let b = f32x4(clip[i0 + 1], clip[i1 + 1], clip[i2 + 1], clip[i3 + 1]);
+        let sample = f32x4_add(a, f32x4_mul(f32x4_sub(b, a), t));
+
+        let offsets = f32x4_add(base, lanes);
+        let gain_left = f32x4_add(f32x4_splat(voice.gains.0), f32x4_mul(step_left, offsets));
+        let gain_right = f32x4_add(f32x4_splat(voice.gains.1), f32x4_mul(step_right, offsets));
+        // The frames `frame..frame + 4` are in both arrays, and the accesses have no alignment requirement.
+        unsafe {
+            let l = left.as_mut_ptr().add(frame) as *mut v128;
+            let r = right.as_mut_ptr().add(frame) as *mut v128;
+            v128_store(l, f32x4_add(v128_load(l), f32x4_mul(sample, gain_left)));
+            v128_store(r, f32x4_add(v128_load(r), f32x4_mul(sample, gain_right)));
+        }
+    }
+}
+
+#[cfg(not(target_feature = "simd128"))]
+fn mix_block(
+    voice: &Voice,
+    steps: (f32, f32),
+    left: &mut [f32; QUANTUM_SIZE],
+    right: &mut [f32; QUANTUM_SIZE],
+) {
+    let clip = &voice.clip[voice.index..];
+    for frame in 0..QUANTUM_SIZE {
+        let position = voice.frac + frame as f32 * voice.rate;
+        let index = position as usize;
+        let t = position - index as f32;
+        let sample = clip[index] + (clip[index + 1] - clip[index]) * t;
+        left[frame] += sample * (voice.gains.0 + steps.0 * frame as f32);
+        right[frame] += sample * (voice.gains.1 + steps.1 * frame as f32);
+    }
+}
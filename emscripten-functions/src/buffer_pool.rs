@@ -0,0 +1,181 @@
+//! A pool of byte buffers by power-of-two size classes, to receive many messages without allocating one buffer per message.
+//!
+//! [`BufferPool::copy_from`] copies the bytes into a free buffer of the smallest class holding them, and returns it as
+//! a [`PooledBuf`], owned by the caller, which goes back to the pool once dropped. The buffers over [`MAX_CLASS_SIZE`] aren't pooled.
+//! The pool and its buffers can be sent to other threads, e.g. to parse messages off the thread receiving them.
+
+use std::{
+    ops::{Deref, DerefMut},
+    sync::{Arc, Mutex},
+};
+
+// The sizes of the smallest and largest classes: 2^8 and 2^20 bytes.
+const MIN_CLASS_LOG: u32 = 8;
+const MAX_CLASS_LOG: u32 = 20;
+const CLASSES: usize = (MAX_CLASS_LOG - MIN_CLASS_LOG + 1) as usize;
+
+/// The size of the largest buffers kept by a [`BufferPool`].
+pub const MAX_CLASS_SIZE: usize = 1 << MAX_CLASS_LOG;
+
+/// The number of free buffers a [`BufferPool`] keeps per size class, by default.
+pub const DEFAULT_MAX_FREE: usize = 16;
+
+// Returns the class of the buffers holding `len` bytes, or `None` if they're too large to be pooled.
+fn class_of(len: usize) -> Option<usize> {
+    if len > MAX_CLASS_SIZE {
+        return None;
+    }
+    let log = len.max(1).next_power_of_two().trailing_zeros();
+    Some(log.saturating_sub(MIN_CLASS_LOG) as usize)
+}
+
+struct PoolState {
+    free: [Vec<Vec<u8>>; CLASSES],
+    max_free: usize,
+}
+
+/// A pool of byte buffers, shared by its clones. See the [module documentation](self).
+///
+/// # Examples
+/// ```rust
+/// let pool = BufferPool::new();
+/// let mut buf = pool.copy_from(b"snapshot");
+/// buf[0] = b'S';
+/// drop(buf);
+/// // The same buffer is reused.
+/// let buf = pool.copy_from(b"another snapshot");
+/// ```
+#[derive(Clone)]
+pub struct BufferPool {
+    state: Arc<Mutex<PoolState>>,
+}
+
+impl BufferPool {
+    /// Creates a pool keeping [`DEFAULT_MAX_FREE`] free buffers per size class.
+    pub fn new() -> Self {
+        Self::with_max_free(DEFAULT_MAX_FREE)
+    }
+
+    /// Creates a pool keeping at most `max_free` free buffers per size class: those dropped past it are freed.
+    pub fn with_max_free(max_free: usize) -> Self {
+        Self {
+            state: Arc::new(Mutex::new(PoolState {
+                free: Default::default(),
+                max_free,
+            })),
+        }
+    }
+
+    /// Returns a buffer holding a copy of `data`, taken from the pool if it has a free one of its class.
+    pub fn copy_from(&self, data: &[u8]) -> PooledBuf {
+        let mut buf = self.take(data.len());
+        buf.data.extend_from_slice(data);
+        buf
+    }
+
+    /// Returns an empty buffer with room for at least `capacity` bytes, taken from the pool if it has a free one of its class.
+    pub fn take(&self, capacity: usize) -> PooledBuf {
+        let Some(class) = class_of(capacity) else {
+            return PooledBuf {
+                data: Vec::with_capacity(capacity),
+                pool: None,
+            };
+        };
+        let reused = self.state.lock().unwrap().free[class].pop();
+        PooledBuf {
+            data: reused.unwrap_or_else(|| Vec::with_capacity(1 << (class as u32 + MIN_CLASS_LOG))),
+            pool: Some(self.clone()),
+        }
+    }
+
+    /// Returns the number of bytes of the free buffers kept by the pool.
+    pub fn free_bytes(&self) -> usize {
+        let state = self.state.lock().unwrap();
+        state
+            .free
+            .iter()
+            .map(|class| class.iter().map(Vec::capacity).sum::<usize>())
+            .sum()
+    }
+
+    /// Frees all the free buffers kept by the pool, e.g. once a burst of large messages is over.
+    pub fn trim(&self) {
+        let mut state = self.state.lock().unwrap();
+        for class in &mut state.free {
+            *class = Vec::new();
+        }
+    }
+
+    fn give_back(&self, mut data: Vec<u8>) {
+        // A buffer grown or shrunk by the caller goes to the largest class it can hold the messages of.
+        let capacity = data.capacity();
+        if !(1 << MIN_CLASS_LOG..=MAX_CLASS_SIZE).contains(&capacity) {
+            return;
+        }
+        let class = (capacity.ilog2() - MIN_CLASS_LOG) as usize;
+        data.clear();
+        let mut state = self.state.lock().unwrap();
+        let max_free = state.max_free;
+        let free = &mut state.free[class];
+        if free.len() < max_free {
+            free.push(data);
+        }
+    }
+}
+
+impl Default for BufferPool {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+/// A buffer of a [`BufferPool`], given back to it when dropped. It derefs to its bytes, and is grown like a `Vec`.
+pub struct PooledBuf {
+    data: Vec<u8>,
+    // `None` for a buffer too large to be pooled.
+    pool: Option<BufferPool>,
+}
+
+impl PooledBuf {
+    /// Returns the underlying vector, to grow it or write to its spare capacity. Its allocation goes back to the pool on drop.
+    pub fn as_mut_vec(&mut self) -> &mut Vec<u8> {
+        &mut self.data
+    }
+
+    /// Takes the bytes out as a vector, which isn't given back to the pool.
+    pub fn into_vec(mut self) -> Vec<u8> {
+        self.pool = None;
+        std::mem::take(&mut self.data)
+    }
+}
+
+impl Deref for PooledBuf {
+    type Target = [u8];
+
+    fn deref(&self) -> &[u8] {
+        &self.data
+    }
+}
+
+impl DerefMut for PooledBuf {
+    fn deref_mut(&mut self) -> &mut [u8] {
+        &mut self.data
+    }
+}
+
+impl std::fmt::Debug for PooledBuf {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("PooledBuf")
+            .field("len", &self.data.len())
+            .field("capacity", &self.data.capacity())
+            .finish()
+    }
+}
+
+impl Drop for PooledBuf {
+    fn drop(&mut self) {
+        if let Some(pool) = self.pool.take() {
+            pool.give_back(std::mem::take(&mut self.data));
+        }
+    }
+}
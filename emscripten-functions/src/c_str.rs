@@ -0,0 +1,117 @@
+//! Helpers for passing rust strings to C functions that expect NUL-terminated strings, without allocating a `CString` every time,
+//! and for reading the NUL-terminated strings they return.
+
+use std::{borrow::Cow, cell::RefCell, ffi::CStr, os::raw::c_char};
+
+use crate::frame_arena::with_frame_arena;
+
+/// Strings shorter than this many bytes are NUL-terminated in a stack buffer.
+pub(crate) const STACK_BUFFER_SIZE: usize = 256;
+
+// Longer strings are copied in this buffer, which keeps its capacity between calls.
+thread_local! {
+    static SCRATCH_BUFFER: RefCell<Vec<u8>> = RefCell::new(Vec::new());
+}
+
+/// Calls `func` with a pointer to a NUL-terminated copy of `string`, valid only during the call.
+///
+/// Short strings are copied on the stack, longer ones in a reusable thread-local buffer.
+/// If that buffer is already in use (e.g. `func` ends up calling this function again), the string is copied in the thread's frame arena instead.
+///
+/// Like `CString::new(...).unwrap()`, it panics if `string` contains a NUL character.
+pub(crate) fn with_c_str<F, R>(string: &str, func: F) -> R
+where
+    F: FnOnce(*const c_char) -> R,
+{
+    let bytes = string.as_bytes();
+    assert!(
+        !bytes.contains(&0),
+        "the string passed to C must not contain NUL characters"
+    );
+
+    if bytes.len() < STACK_BUFFER_SIZE {
+        let mut buffer = [0u8; STACK_BUFFER_SIZE];
+        buffer[..bytes.len()].copy_from_slice(bytes);
+        return func(buffer.as_ptr() as *const c_char);
+    }
+
+    let mut func = Some(func);
+    let result = SCRATCH_BUFFER.with(|scratch| {
+        let mut scratch = scratch.try_borrow_mut().ok()?;
+        scratch.clear();
+        scratch.extend_from_slice(bytes);
+        scratch.push(0);
+        Some((func.take().unwrap())(scratch.as_ptr() as *const c_char))
+    });
+
+    match result {
+        Some(result) => result,
+        None => {
+            with_frame_arena(|arena| (func.take().unwrap())(arena.alloc_c_str(string).as_ptr()))
+        }
+    }
+}
+
+// Returns the length of the NUL-terminated string at `ptr`, and the length of its leading ASCII run,
+// found over 16-byte chunks with wasm SIMD.
+// The length is found first, with `strlen`: the chunks are then only loaded within the string, as reading past its NUL is UB.
+#[cfg(all(target_arch = "wasm32", target_feature = "simd128"))]
+unsafe fn scan(ptr: *const u8) -> (usize, usize) {
+    use std::arch::wasm32::{u8x16_bitmask, v128, v128_load};
+
+    let len = CStr::from_ptr(ptr as *const c_char).to_bytes().len();
+    let mut ascii_len = 0;
+    while ascii_len + 16 <= len {
+        // The high bit of each byte, set for the non-ASCII ones.
+        let non_ascii = u8x16_bitmask(v128_load(ptr.add(ascii_len) as *const v128));
+        if non_ascii != 0 {
+            return (len, ascii_len + non_ascii.trailing_zeros() as usize);
+        }
+        ascii_len += 16;
+    }
+    // The last bytes, fewer than 16, are read one by one.
+    while ascii_len < len && *ptr.add(ascii_len) < 0x80 {
+        ascii_len += 1;
+    }
+    (len, ascii_len)
+}
+
+// Without SIMD, `strlen` finds the length, and the whole string is left to the UTF-8 validation.
+#[cfg(not(all(target_arch = "wasm32", target_feature = "simd128")))]
+unsafe fn scan(ptr: *const u8) -> (usize, usize) {
+    (CStr::from_ptr(ptr as *const c_char).to_bytes().len(), 0)
+}
+
+/// Calls `func` with the NUL-terminated UTF-8 string at `ptr`, as returned by a C function, without copying it.
+///
+/// Built with `-C target-feature=+simd128`, its leading ASCII run is found with SIMD,
+/// and only the bytes from the first non-ASCII one are validated, which is cheap for ASCII strings like JSON.
+/// Invalid UTF-8 (e.g. the lone surrogates JS strings can contain) is replaced with U+FFFD, in a copy.
+///
+/// # Safety
+/// `ptr` must point to a NUL-terminated string, valid during the call.
+pub(crate) unsafe fn with_returned_str<F, R>(ptr: *const c_char, func: F) -> R
+where
+    F: FnOnce(&str) -> R,
+{
+    let (len, ascii_len) = scan(ptr as *const u8);
+    let bytes = std::slice::from_raw_parts(ptr as *const u8, len);
+
+    // The ASCII prefix is valid UTF-8, and it ends on a character boundary.
+    if std::str::from_utf8(&bytes[ascii_len..]).is_ok() {
+        func(std::str::from_utf8_unchecked(bytes))
+    } else {
+        match String::from_utf8_lossy(bytes) {
+            Cow::Borrowed(string) => func(string),
+            Cow::Owned(string) => func(&string),
+        }
+    }
+}
+
+/// Copies the NUL-terminated string at `ptr`, as returned by a C function, into a new `String`. See [`with_returned_str`].
+///
+/// # Safety
+/// `ptr` must point to a NUL-terminated string.
+pub(crate) unsafe fn returned_string(ptr: *const c_char) -> String {
+    with_returned_str(ptr, str::to_string)
+}
@@ -0,0 +1,166 @@
+//! A canvas resizer built on the [`html5::events`](crate::html5::events) module, that keeps a canvas' drawing buffer at its displayed device-pixel size.
+//!
+//! Dragging a window's edge fires dozens of `resize` events per second, and reallocating the swapchain on each one stalls the renderer.
+//! The [`CanvasResizer`] instead coalesces the `resize` and `scroll` events of the window into one update per animation frame,
+//! and only resizes the canvas when its size in device pixels actually changed.
+
+use std::{cell::RefCell, ffi::CString, rc::Rc};
+
+use emscripten_functions_sys::html5;
+
+use crate::{
+    display::device_pixel_ratio,
+    html5::{
+        events::{on_resize, on_scroll, EventListener, EventTarget},
+        invalidate_canvas_sizes, request_animation_frame, Html5Error,
+    },
+};
+
+type OnResize = Box<dyn FnMut(i32, i32)>;
+type OnScroll = Box<dyn FnMut(i32, i32)>;
+
+struct ResizerState {
+    canvas: CString,
+    // The drawing buffer size last set, in device pixels.
+    size: (i32, i32),
+    frame_requested: bool,
+    // The last scroll position, if it changed since the last frame.
+    scroll: Option<(i32, i32)>,
+    onresize: Option<OnResize>,
+    onscroll: Option<OnScroll>,
+}
+
+/// Keeps the drawing buffer of a canvas at the canvas' CSS size times the device pixel ratio, checking it at most once per animation frame.
+///
+/// The listeners are unregistered when the resizer is dropped.
+///
+/// # Examples
+/// ```rust
+/// let resizer = CanvasResizer::new("#canvas", |width, height| {
+///     // Called only when the size in device pixels changed.
+///     renderer.recreate_swapchain(width, height);
+/// })
+/// .unwrap();
+/// ```
+pub struct CanvasResizer {
+    state: Rc<RefCell<ResizerState>>,
+    _listeners: Vec<EventListener>,
+}
+
+impl CanvasResizer {
+    /// Starts resizing the canvas matching the given CSS selector. The first check happens in the next animation frame.
+    ///
+    /// # Arguments
+    /// * `canvas` - The CSS selector of the canvas, e.g. `#canvas`.
+    /// * `onresize` - The function called with the new drawing buffer width and height, in device pixels, after the canvas was resized.
+    pub fn new<F>(canvas: &str, onresize: F) -> Result<Self, Html5Error>
+    where
+        F: 'static + FnMut(i32, i32),
+    {
+        let state = Rc::new(RefCell::new(ResizerState {
+            canvas: CString::new(canvas).expect("the selector mustn't contain nul bytes"),
+            size: (0, 0),
+            frame_requested: false,
+            scroll: None,
+            onresize: Some(Box::new(onresize)),
+            onscroll: None,
+        }));
+
+        let resize_state = state.clone();
+        let scroll_state = state.clone();
+        let listeners = vec![
+            on_resize(EventTarget::Window, false, move |_| {
+                request_update(&resize_state);
+                false
+            })?,
+            on_scroll(EventTarget::Window, false, move |event| {
+                scroll_state.borrow_mut().scroll = Some((event.scrollLeft, event.scrollTop));
+                request_update(&scroll_state);
+                false
+            })?,
+        ];
+
+        request_update(&state);
+        Ok(Self {
+            state,
+            _listeners: listeners,
+        })
+    }
+
+    /// Sets the function called with the window's last scroll position (left, top), at most once per animation frame in which it scrolled.
+    pub fn on_scroll<F>(&self, onscroll: F)
+    where
+        F: 'static + FnMut(i32, i32),
+    {
+        self.state.borrow_mut().onscroll = Some(Box::new(onscroll));
+    }
+
+    /// Returns the current drawing buffer size, in device pixels.
+    pub fn size(&self) -> (i32, i32) {
+        self.state.borrow().size
+    }
+}
+
+// Requests the animation frame that handles the events received until then, if it isn't requested already.
+fn request_update(state: &Rc<RefCell<ResizerState>>) {
+    if std::mem::replace(&mut state.borrow_mut().frame_requested, true) {
+        return;
+    }
+
+    // A weak reference, so that a dropped resizer doesn't get updated.
+    let state = Rc::downgrade(state);
+    request_animation_frame(move |_| {
+        if let Some(state) = state.upgrade() {
+            update(&state);
+        }
+    });
+}
+
+fn update(state: &Rc<RefCell<ResizerState>>) {
+    let (resized, scroll) = {
+        let mut state = state.borrow_mut();
+        state.frame_requested = false;
+
+        let mut css_width = 0.0;
+        let mut css_height = 0.0;
+        let ratio = device_pixel_ratio();
+        let found = unsafe {
+            html5::emscripten_get_element_css_size(
+                state.canvas.as_ptr(),
+                &mut css_width,
+                &mut css_height,
+            )
+        } == html5::EMSCRIPTEN_RESULT_SUCCESS as i32;
+
+        let size = (
+            (css_width * ratio).round() as i32,
+            (css_height * ratio).round() as i32,
+        );
+        let resized = found && size != state.size;
+        if resized {
+            unsafe {
+                html5::emscripten_set_canvas_element_size(state.canvas.as_ptr(), size.0, size.1);
+            }
+            invalidate_canvas_sizes();
+            state.size = size;
+        }
+
+        (resized.then_some(size), state.scroll.take())
+    };
+
+    // The handlers are taken out during their calls, so that they can use the resizer.
+    if let Some((width, height)) = resized {
+        let onresize = state.borrow_mut().onresize.take();
+        if let Some(mut onresize) = onresize {
+            onresize(width, height);
+            state.borrow_mut().onresize.get_or_insert(onresize);
+        }
+    }
+    if let Some((left, top)) = scroll {
+        let onscroll = state.borrow_mut().onscroll.take();
+        if let Some(mut onscroll) = onscroll {
+            onscroll(left, top);
+            state.borrow_mut().onscroll.get_or_insert(onscroll);
+        }
+    }
+}
@@ -0,0 +1,93 @@
+//! A report of the features the program can use at runtime, detected once and cached, to choose the fastest backend
+//! among those the browser supports, e.g. a thread pool or a single-threaded fallback, from a single build.
+//!
+//! Some features depend on both the build and the browser: the threads need a `-pthread` build, and `SharedArrayBuffer`, which browsers
+//! only expose on cross-origin isolated pages (served with the COOP/COEP headers). [`Capabilities::threads`] tells if both are there.
+
+use std::{fmt::Display, os::raw::c_int, sync::OnceLock};
+
+use emscripten_functions_sys::{html5, threading};
+
+use crate::emscripten::has_asyncify;
+
+extern "C" {
+    fn capabilities_detect() -> c_int;
+}
+
+// The bits of `capabilities_detect`'s result.
+const SHARED_ARRAY_BUFFER: c_int = 1;
+const CROSS_ORIGIN_ISOLATED: c_int = 2;
+const WASM_SIMD: c_int = 4;
+const WEBGPU: c_int = 8;
+
+/// The features available to the program, returned by [`capabilities`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Capabilities {
+    /// Whether the browser exposes `SharedArrayBuffer`.
+    pub shared_array_buffer: bool,
+    /// Whether the page is cross-origin isolated (`crossOriginIsolated`), which `SharedArrayBuffer` needs in current browsers.
+    pub cross_origin_isolated: bool,
+    /// Whether pthreads can be created: the program was built with `-pthread`, and the browser supports shared memory,
+    /// using the emscripten-defined `emscripten_has_threading_support`.
+    pub threads: bool,
+    /// Whether the program was built with the wasm `simd128` target feature.
+    pub simd_build: bool,
+    /// Whether the browser's engine supports wasm SIMD, tested by validating a module using it.
+    pub wasm_simd: bool,
+    /// Whether the browser supports `OffscreenCanvas`, using the emscripten-defined `emscripten_supports_offscreencanvas`.
+    pub offscreen_canvas: bool,
+    /// Whether the program was built with Asyncify, from [`has_asyncify`].
+    pub asyncify: bool,
+    /// Whether the browser exposes WebGPU (`navigator.gpu`). An adapter can still be missing, e.g. on a blocklisted GPU.
+    pub webgpu: bool,
+    /// The number of logical cores, using the emscripten-defined `emscripten_num_logical_cores`.
+    pub logical_cores: i32,
+}
+
+/// Returns the features available to the program. They're detected on the first call, and then cached.
+///
+/// # Examples
+/// ```rust
+/// let caps = capabilities();
+/// let workers = if caps.threads {
+///     (caps.logical_cores - 1).clamp(1, 8)
+/// } else {
+///     0
+/// };
+/// println!("{caps}");
+/// ```
+pub fn capabilities() -> &'static Capabilities {
+    static CAPABILITIES: OnceLock<Capabilities> = OnceLock::new();
+    CAPABILITIES.get_or_init(|| {
+        let flags = unsafe { capabilities_detect() };
+        Capabilities {
+            shared_array_buffer: flags & SHARED_ARRAY_BUFFER != 0,
+            cross_origin_isolated: flags & CROSS_ORIGIN_ISOLATED != 0,
+            threads: unsafe { threading::emscripten_has_threading_support() != 0 },
+            simd_build: cfg!(target_feature = "simd128"),
+            wasm_simd: flags & WASM_SIMD != 0,
+            offscreen_canvas: unsafe { html5::emscripten_supports_offscreencanvas() != 0 },
+            asyncify: has_asyncify(),
+            webgpu: flags & WEBGPU != 0,
+            logical_cores: unsafe { threading::emscripten_num_logical_cores() },
+        }
+    })
+}
+
+impl Display for Capabilities {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        write!(
+            f,
+            "shared_array_buffer={} cross_origin_isolated={} threads={} simd_build={} wasm_simd={} offscreen_canvas={} asyncify={} webgpu={} logical_cores={}",
+            self.shared_array_buffer,
+            self.cross_origin_isolated,
+            self.threads,
+            self.simd_build,
+            self.wasm_simd,
+            self.offscreen_canvas,
+            self.asyncify,
+            self.webgpu,
+            self.logical_cores,
+        )
+    }
+}
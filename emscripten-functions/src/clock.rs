@@ -0,0 +1,152 @@
+//! A monotonic clock over the emscripten-defined [`emscripten_performance_now`], with the time of the current main loop tick cached.
+//!
+//! Every reading of the clock crosses into JS. Code that reads it many times per frame, but only needs frame-granular time
+//! (animations, timers, cooldowns), can use [`frame_time`] instead, which the main loop set with [`set_main_loop_with_arg`] or [`set_main_loop`]
+//! captures once at the start of each tick.
+//!
+//! [`emscripten_performance_now`]: https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_performance_now
+//! [`set_main_loop_with_arg`]: crate::emscripten::set_main_loop_with_arg
+//! [`set_main_loop`]: crate::emscripten::set_main_loop
+
+use std::{
+    cell::Cell,
+    ops::{Add, AddAssign, Sub, SubAssign},
+    time::Duration,
+};
+
+use emscripten_functions_sys::html5;
+
+thread_local! {
+    // The time the running main loop tick started at, in milliseconds, if a tick is running.
+    static FRAME_TIME: Cell<Option<f64>> = const { Cell::new(None) };
+}
+
+/// A reading of the monotonic clock, comparable with the other ones of the same thread.
+///
+/// It's a [`std::time::Instant`] lookalike: the standard one isn't backed by `performance.now()` on emscripten.
+///
+/// # Examples
+/// ```rust
+/// let start = Instant::now();
+/// build_level();
+/// console::log(&format!("The level was built in {:?}", start.elapsed()));
+/// ```
+#[derive(Debug, Clone, Copy, PartialEq, PartialOrd)]
+pub struct Instant {
+    // Milliseconds since the start of the page (or worker), with sub-millisecond precision.
+    millis: f64,
+}
+
+impl Instant {
+    /// Reads the clock, using the emscripten-defined [`emscripten_performance_now`].
+    ///
+    /// [`emscripten_performance_now`]: https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_performance_now
+    pub fn now() -> Self {
+        Self {
+            millis: unsafe { html5::emscripten_performance_now() },
+        }
+    }
+
+    /// Creates an instant from a `performance.now()` timestamp, in milliseconds, e.g. the one of an event.
+    pub fn from_millis(millis: f64) -> Self {
+        Self { millis }
+    }
+
+    /// Returns the `performance.now()` timestamp of the instant, in milliseconds.
+    pub fn as_millis(&self) -> f64 {
+        self.millis
+    }
+
+    /// Returns the time elapsed since the instant, or zero if it's in the future.
+    pub fn elapsed(&self) -> Duration {
+        Self::now().duration_since(*self)
+    }
+
+    /// Returns the time elapsed from `earlier` to this instant, or zero if `earlier` is later.
+    pub fn duration_since(&self, earlier: Instant) -> Duration {
+        self.checked_duration_since(earlier).unwrap_or_default()
+    }
+
+    /// Returns the time elapsed from `earlier` to this instant, or `None` if `earlier` is later.
+    pub fn checked_duration_since(&self, earlier: Instant) -> Option<Duration> {
+        let millis = self.millis - earlier.millis;
+        (millis >= 0.0).then(|| Duration::from_secs_f64(millis / 1000.0))
+    }
+}
+
+impl Add<Duration> for Instant {
+    type Output = Instant;
+
+    fn add(self, duration: Duration) -> Instant {
+        Instant {
+            millis: self.millis + duration.as_secs_f64() * 1000.0,
+        }
+    }
+}
+
+impl AddAssign<Duration> for Instant {
+    fn add_assign(&mut self, duration: Duration) {
+        *self = *self + duration;
+    }
+}
+
+impl Sub<Duration> for Instant {
+    type Output = Instant;
+
+    fn sub(self, duration: Duration) -> Instant {
+        Instant {
+            millis: self.millis - duration.as_secs_f64() * 1000.0,
+        }
+    }
+}
+
+impl SubAssign<Duration> for Instant {
+    fn sub_assign(&mut self, duration: Duration) {
+        *self = *self - duration;
+    }
+}
+
+impl Sub<Instant> for Instant {
+    type Output = Duration;
+
+    fn sub(self, earlier: Instant) -> Duration {
+        self.duration_since(earlier)
+    }
+}
+
+/// Returns the time the running main loop tick of the calling thread started at, without reading the clock.
+/// Outside of a tick of the main loop set with [`set_main_loop_with_arg`] or [`set_main_loop`], it reads the clock like [`Instant::now`].
+///
+/// [`set_main_loop_with_arg`]: crate::emscripten::set_main_loop_with_arg
+/// [`set_main_loop`]: crate::emscripten::set_main_loop
+///
+/// # Examples
+/// ```rust
+/// set_main_loop(move || {
+///     // Every sprite of the frame animates from the same time.
+///     for sprite in &mut sprites {
+///         sprite.animate(frame_time());
+///     }
+/// }, 0, true);
+/// ```
+pub fn frame_time() -> Instant {
+    match FRAME_TIME.with(|time| time.get()) {
+        Some(millis) => Instant { millis },
+        None => Instant::now(),
+    }
+}
+
+/// Returns the wall-clock time, in milliseconds since the Unix epoch, using the emscripten-defined [`emscripten_date_now`].
+/// Unlike [`Instant`], it can jump backwards when the system clock is changed.
+///
+/// [`emscripten_date_now`]: https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_date_now
+pub fn date_now() -> f64 {
+    unsafe { html5::emscripten_date_now() }
+}
+
+// Runs a main loop tick with its start time captured for `frame_time`.
+pub(crate) fn run_frame<F: FnOnce()>(tick: F) {
+    let previous = FRAME_TIME.with(|time| time.replace(Some(Instant::now().millis)));
+    tick();
+    FRAME_TIME.with(|time| time.set(previous));
+}
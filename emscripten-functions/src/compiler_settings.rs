@@ -0,0 +1,174 @@
+//! Typed emscripten settings the program was linked with, to choose its fast paths from them.
+//!
+//! Each setting comes from the first of these sources that knows it:
+//! - the build script of the crate, which parses the `-s` link arguments given in the rust flags (e.g. `-C link-arg=-sASYNCIFY`,
+//!   in `RUSTFLAGS` or the `rustflags` of `.cargo/config.toml`) or in `EMCC_CFLAGS`. Those are known at compile time,
+//!   and the enabled `ALLOW_MEMORY_GROWTH` and `ASYNCIFY` are also exposed as the `emscripten_allow_memory_growth`
+//!   and `emscripten_asyncify` cfg flags, which the crate uses to skip its runtime checks;
+//! - with the `compiler_settings` feature, the emscripten-defined [`emscripten_get_compiler_setting`], a JS lookup
+//!   that needs linking with `-sRETAIN_COMPILER_SETTINGS`, made once when the settings are first read.
+//!
+//! The settings known by neither are `None`: this module doesn't assume emscripten's defaults, which change between its versions.
+//!
+//! [`emscripten_get_compiler_setting`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_get_compiler_setting
+
+use std::{fmt::Display, sync::OnceLock};
+
+/// The settings the program was linked with, returned by [`compiler_settings`]. See the [module documentation](self).
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct CompilerSettings {
+    /// Whether the wasm memory can grow past its initial size (`ALLOW_MEMORY_GROWTH`).
+    pub allow_memory_growth: Option<bool>,
+    /// The Asyncify mode (`ASYNCIFY`): 0 without it, 1 for Asyncify, 2 for JSPI.
+    pub asyncify: Option<u32>,
+    /// The initial size of the wasm memory, in bytes (`INITIAL_MEMORY`).
+    pub initial_memory: Option<u64>,
+    /// The size the wasm memory can grow to, in bytes (`MAXIMUM_MEMORY`).
+    pub maximum_memory: Option<u64>,
+    /// The number of workers created at startup for the pthreads (`PTHREAD_POOL_SIZE`).
+    /// It's `None` if the setting is a JS expression, e.g. `navigator.hardwareConcurrency`, rather than a number.
+    pub pthread_pool_size: Option<u32>,
+    /// The size of the main thread's data stack, in bytes (`STACK_SIZE`).
+    pub stack_size: Option<u64>,
+}
+
+// Parses a setting given to emcc: a number, or for the sizes, a number of kilobytes, megabytes or gigabytes,
+// e.g. `64MB`, as emcc accepts them.
+const fn parse_setting(value: &str) -> Option<u64> {
+    let bytes = value.as_bytes();
+    let mut end = 0;
+    let mut number: u64 = 0;
+    while end < bytes.len() && bytes[end].is_ascii_digit() {
+        number = match number.checked_mul(10) {
+            Some(number) => number + (bytes[end] - b'0') as u64,
+            None => return None,
+        };
+        end += 1;
+    }
+    if end == 0 {
+        return None;
+    }
+    let unit: u64 = match bytes.len() - end {
+        0 => 1,
+        2 if bytes[end + 1] == b'B' => match bytes[end] {
+            b'K' => 1 << 10,
+            b'M' => 1 << 20,
+            b'G' => 1 << 30,
+            _ => return None,
+        },
+        _ => return None,
+    };
+    number.checked_mul(unit)
+}
+
+// Returns the setting exported by the build script, if it was among the link arguments.
+macro_rules! build_setting {
+    ($name:literal) => {
+        match option_env!(concat!("EMSCRIPTEN_FUNCTIONS_SETTING_", $name)) {
+            Some(value) => parse_setting(value),
+            None => None,
+        }
+    };
+}
+
+// Reads a numeric setting retained in the program. The strings are returned as pointers, so they're left out
+// by the callers, for the settings that can be strings.
+#[cfg(feature = "compiler_settings")]
+fn runtime_setting(name: &str) -> Option<u64> {
+    let value = crate::c_str::with_c_str(name, |name| unsafe {
+        emscripten_functions_sys::emscripten::emscripten_get_compiler_setting(name)
+    });
+    u64::try_from(value).ok()
+}
+
+#[cfg(not(feature = "compiler_settings"))]
+fn runtime_setting(_name: &str) -> Option<u64> {
+    None
+}
+
+impl CompilerSettings {
+    /// The settings known at compile time. Those missing from the link arguments are `None`.
+    pub const BUILD: Self = Self {
+        allow_memory_growth: match build_setting!("ALLOW_MEMORY_GROWTH") {
+            Some(value) => Some(value != 0),
+            None => None,
+        },
+        asyncify: match build_setting!("ASYNCIFY") {
+            Some(value) if value <= u32::MAX as u64 => Some(value as u32),
+            _ => None,
+        },
+        initial_memory: build_setting!("INITIAL_MEMORY"),
+        maximum_memory: build_setting!("MAXIMUM_MEMORY"),
+        pthread_pool_size: match build_setting!("PTHREAD_POOL_SIZE") {
+            Some(value) if value <= u32::MAX as u64 => Some(value as u32),
+            _ => None,
+        },
+        stack_size: build_setting!("STACK_SIZE"),
+    };
+
+    fn detect() -> Self {
+        let build = Self::BUILD;
+        Self {
+            allow_memory_growth: build
+                .allow_memory_growth
+                .or_else(|| runtime_setting("ALLOW_MEMORY_GROWTH").map(|value| value != 0)),
+            asyncify: build.asyncify.or_else(|| {
+                runtime_setting("ASYNCIFY").and_then(|value| u32::try_from(value).ok())
+            }),
+            initial_memory: build
+                .initial_memory
+                .or_else(|| runtime_setting("INITIAL_MEMORY")),
+            maximum_memory: build
+                .maximum_memory
+                .or_else(|| runtime_setting("MAXIMUM_MEMORY")),
+            // A JS expression is retained as a string, whose pointer can't be told apart from a number.
+            pthread_pool_size: build.pthread_pool_size,
+            stack_size: build.stack_size.or_else(|| runtime_setting("STACK_SIZE")),
+        }
+    }
+}
+
+/// Returns the settings the program was linked with. They're read on the first call, and then cached.
+///
+/// # Examples
+/// ```rust
+/// // Without memory growth, the allocations must fit in the initial memory, so the caches are kept smaller.
+/// let settings = compiler_settings();
+/// let cache_size = match (settings.allow_memory_growth, settings.initial_memory) {
+///     (Some(false), Some(initial_memory)) => initial_memory / 8,
+///     _ => 64 << 20,
+/// };
+/// println!("{settings}");
+/// ```
+pub fn compiler_settings() -> &'static CompilerSettings {
+    static SETTINGS: OnceLock<CompilerSettings> = OnceLock::new();
+    SETTINGS.get_or_init(CompilerSettings::detect)
+}
+
+// Writes the known settings, as `-s` arguments.
+impl Display for CompilerSettings {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        let settings: [(&str, Option<u64>); 6] = [
+            (
+                "ALLOW_MEMORY_GROWTH",
+                self.allow_memory_growth.map(u64::from),
+            ),
+            ("ASYNCIFY", self.asyncify.map(u64::from)),
+            ("INITIAL_MEMORY", self.initial_memory),
+            ("MAXIMUM_MEMORY", self.maximum_memory),
+            ("PTHREAD_POOL_SIZE", self.pthread_pool_size.map(u64::from)),
+            ("STACK_SIZE", self.stack_size),
+        ];
+        let mut first = true;
+        for (name, value) in settings {
+            if let Some(value) = value {
+                if !first {
+                    write!(f, " ")?;
+                }
+                write!(f, "-s{}={}", name, value)?;
+                first = false;
+            }
+        }
+        Ok(())
+    }
+}
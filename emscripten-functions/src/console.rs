@@ -1,12 +1,31 @@
 //! Select functions (with rust-native parameter types) from the emscripten [`console.h`] [header file].
 //!
+//! The [`log!`](crate::log), [`warn!`](crate::warn), [`error!`](crate::error) and [`dbg!`](crate::dbg) macros format messages without allocating,
+//! and are compiled out below the [`MAX_LEVEL`] set with cargo features.
+//! On pthreads, they can queue their messages in the [`worker_log`](crate::worker_log) sink instead of blocking on the main thread.
+//! [`time`] and [`count`] wrap the `console.time()` and `console.count()` families, with labels interned into numbers.
+//!
 //! [`console.h`]: https://github.com/emscripten-core/emscripten/blob/main/site/source/docs/api_reference/console.h.rst
 //! [header file]: https://github.com/emscripten-core/emscripten/blob/main/system/include/emscripten/console.h
 
-use std::ffi::CString;
+use std::{
+    cell::RefCell,
+    ffi::CString,
+    fmt::{self, Write},
+    os::raw::{c_char, c_int},
+    sync::atomic::{AtomicU32, Ordering},
+};
 
 use emscripten_functions_sys::console;
 
+// The functions defined in `console_n.c`.
+extern "C" {
+    fn console_log_n(string: *const c_char, len: usize);
+    fn console_warn_n(string: *const c_char, len: usize);
+    fn console_error_n(string: *const c_char, len: usize);
+    fn console_label_call(method: c_int, id: c_int, label: *const c_char, len: usize);
+}
+
 /// Prints the given string using the [`console.log()`] JS function.
 ///
 /// [`console.log()`]: https://developer.mozilla.org/en-US/docs/Web/API/console/log
@@ -132,3 +151,619 @@ where
         console::emscripten_dbg(cstring.as_ptr());
     }
 }
+
+/// Prints the given string slice using the [`console.log()`] JS function, without allocating.
+///
+/// Unlike [`log`], the string is passed to JS as a pointer and a length, so no intermediate [`CString`] is built.
+/// If the string contains a NUL character, the output stops there instead of panicking.
+///
+/// [`console.log()`]: https://developer.mozilla.org/en-US/docs/Web/API/console/log
+///
+/// # Arguments
+/// * `string` - The string to print.
+///
+/// # Examples
+/// ```rust
+/// log_str("Hello, world!");
+/// ```
+pub fn log_str(string: &str) {
+    unsafe {
+        console_log_n(string.as_ptr() as *const c_char, string.len());
+    }
+}
+
+/// Prints the given string slice using the [`console.warn()`] JS function, without allocating.
+///
+/// Unlike [`warn`], the string is passed to JS as a pointer and a length, so no intermediate [`CString`] is built.
+/// If the string contains a NUL character, the output stops there instead of panicking.
+///
+/// [`console.warn()`]: https://developer.mozilla.org/en-US/docs/Web/API/console/warn
+///
+/// # Arguments
+/// * `string` - The string to print.
+///
+/// # Examples
+/// ```rust
+/// warn_str("Hello, world!");
+/// ```
+pub fn warn_str(string: &str) {
+    unsafe {
+        console_warn_n(string.as_ptr() as *const c_char, string.len());
+    }
+}
+
+/// Prints the given string slice using the [`console.error()`] JS function, without allocating.
+///
+/// Unlike [`error`], the string is passed to JS as a pointer and a length, so no intermediate [`CString`] is built.
+/// If the string contains a NUL character, the output stops there instead of panicking.
+///
+/// [`console.error()`]: https://developer.mozilla.org/en-US/docs/Web/API/console/error
+///
+/// # Arguments
+/// * `string` - The string to print.
+///
+/// # Examples
+/// ```rust
+/// error_str("Hello, world!");
+/// ```
+pub fn error_str(string: &str) {
+    unsafe {
+        console_error_n(string.as_ptr() as *const c_char, string.len());
+    }
+}
+
+/// Prints the given string slice using the emscripten-defined `out()` JS function, without allocating,
+/// using the emscripten-defined [`emscripten_outn`].
+///
+/// Unlike [`out`], the string is passed to JS as a pointer and a length, so no intermediate [`CString`] is built.
+/// If the string contains a NUL character, the output stops there instead of panicking.
+///
+/// [`emscripten_outn`]: https://github.com/emscripten-core/emscripten/blob/main/system/include/emscripten/console.h
+///
+/// # Arguments
+/// * `string` - The string to print.
+///
+/// # Examples
+/// ```rust
+/// out_str("Hello, world!");
+/// ```
+pub fn out_str(string: &str) {
+    unsafe {
+        console::emscripten_outn(string.as_ptr() as *const c_char, string.len());
+    }
+}
+
+/// Prints the given string slice using the emscripten-defined `err()` JS function, without allocating,
+/// using the emscripten-defined [`emscripten_errn`].
+///
+/// Unlike [`err`], the string is passed to JS as a pointer and a length, so no intermediate [`CString`] is built.
+/// If the string contains a NUL character, the output stops there instead of panicking.
+///
+/// [`emscripten_errn`]: https://github.com/emscripten-core/emscripten/blob/main/system/include/emscripten/console.h
+///
+/// # Arguments
+/// * `string` - The string to print.
+///
+/// # Examples
+/// ```rust
+/// err_str("Hello, world!");
+/// ```
+pub fn err_str(string: &str) {
+    unsafe {
+        console::emscripten_errn(string.as_ptr() as *const c_char, string.len());
+    }
+}
+
+/// Prints the given string slice using the emscripten-defined `dbg()` JS function, without allocating,
+/// using the emscripten-defined [`emscripten_dbgn`].
+///
+/// Unlike [`dbg`], the string is passed to JS as a pointer and a length, so no intermediate [`CString`] is built.
+/// If the string contains a NUL character, the output stops there instead of panicking.
+///
+/// [`emscripten_dbgn`]: https://github.com/emscripten-core/emscripten/blob/main/system/include/emscripten/console.h
+///
+/// # Arguments
+/// * `string` - The string to print.
+///
+/// # Examples
+/// ```rust
+/// dbg_str("Hello, world!");
+/// ```
+pub fn dbg_str(string: &str) {
+    unsafe {
+        console::emscripten_dbgn(string.as_ptr() as *const c_char, string.len());
+    }
+}
+
+/// The level of a message printed with the logging macros, from the most to the least severe.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash)]
+pub enum Level {
+    /// Printed with [`error!`](crate::error), using [`console.error()`](https://developer.mozilla.org/en-US/docs/Web/API/console/error).
+    Error,
+    /// Printed with [`warn!`](crate::warn), using [`console.warn()`](https://developer.mozilla.org/en-US/docs/Web/API/console/warn).
+    Warn,
+    /// Printed with [`log!`](crate::log), using [`console.log()`](https://developer.mozilla.org/en-US/docs/Web/API/console/log).
+    Info,
+    /// Printed with [`dbg!`](crate::dbg), using `emscripten_dbg`.
+    Debug,
+}
+
+/// The least severe level the logging macros print, set at compile time with the cargo features:
+/// `max_level_off`, `max_level_error`, `max_level_warn` and `max_level_info`, or their `release_max_level_*` counterparts,
+/// which only apply without debug assertions. `None` means nothing is printed.
+///
+/// The calls of the macros below it are compiled out, with the formatting of their arguments.
+pub const MAX_LEVEL: Option<Level> = if cfg!(any(
+    feature = "max_level_off",
+    all(not(debug_assertions), feature = "release_max_level_off")
+)) {
+    None
+} else if cfg!(any(
+    feature = "max_level_error",
+    all(not(debug_assertions), feature = "release_max_level_error")
+)) {
+    Some(Level::Error)
+} else if cfg!(any(
+    feature = "max_level_warn",
+    all(not(debug_assertions), feature = "release_max_level_warn")
+)) {
+    Some(Level::Warn)
+} else if cfg!(any(
+    feature = "max_level_info",
+    all(not(debug_assertions), feature = "release_max_level_info")
+)) {
+    Some(Level::Info)
+} else {
+    Some(Level::Debug)
+};
+
+#[doc(hidden)]
+pub const fn __enabled(level: Level) -> bool {
+    match MAX_LEVEL {
+        Some(max) => level as u8 <= max as u8,
+        None => false,
+    }
+}
+
+// The buffer the logging macros format their messages into, which keeps its capacity between messages.
+thread_local! {
+    static FORMAT_BUFFER: RefCell<String> = const { RefCell::new(String::new()) };
+}
+
+// Prints the message of the logging macros, or queues it in the worker log sink if it's enabled outside of the main browser thread.
+fn print_at(level: Level, message: &str) {
+    if crate::worker_log::routes_here() {
+        crate::worker_log::push(level, message);
+        return;
+    }
+    match level {
+        Level::Error => error_str(message),
+        Level::Warn => warn_str(message),
+        Level::Info => log_str(message),
+        Level::Debug => dbg_str(message),
+    }
+}
+
+#[doc(hidden)]
+pub fn __log_fmt(level: Level, args: fmt::Arguments) {
+    // A message formatted without arguments needs no buffer.
+    if let Some(message) = args.as_str() {
+        print_at(level, message);
+        return;
+    }
+    let _ = FORMAT_BUFFER.try_with(|buffer| match buffer.try_borrow_mut() {
+        Ok(mut buffer) => {
+            buffer.clear();
+            // Writing into a `String` never fails.
+            let _ = buffer.write_fmt(args);
+            print_at(level, &buffer);
+        }
+        // A `Display` implementation logging while it's formatted gets its own buffer.
+        Err(_) => print_at(level, &fmt::format(args)),
+    });
+}
+
+/// Prints a message formatted like with [`format!`] using the [`console.log()`] JS function, at the [`Level::Info`] level.
+///
+/// The message is formatted into a reusable thread-local buffer, without allocating a `String`,
+/// and the call is compiled out if the level is above [`MAX_LEVEL`].
+///
+/// [`console.log()`]: https://developer.mozilla.org/en-US/docs/Web/API/console/log
+///
+/// # Examples
+/// ```rust
+/// log!("Loaded {} meshes in {:.1} ms", meshes.len(), millis);
+/// ```
+#[macro_export]
+macro_rules! log {
+    ($($arg:tt)+) => {
+        if const { $crate::console::__enabled($crate::console::Level::Info) } {
+            $crate::console::__log_fmt($crate::console::Level::Info, format_args!($($arg)+));
+        }
+    };
+}
+
+/// Prints a message formatted like with [`format!`] using the [`console.warn()`] JS function, at the [`Level::Warn`] level.
+/// See [`log!`](crate::log).
+///
+/// [`console.warn()`]: https://developer.mozilla.org/en-US/docs/Web/API/console/warn
+#[macro_export]
+macro_rules! warn {
+    ($($arg:tt)+) => {
+        if const { $crate::console::__enabled($crate::console::Level::Warn) } {
+            $crate::console::__log_fmt($crate::console::Level::Warn, format_args!($($arg)+));
+        }
+    };
+}
+
+/// Prints a message formatted like with [`format!`] using the [`console.error()`] JS function, at the [`Level::Error`] level.
+/// See [`log!`](crate::log).
+///
+/// [`console.error()`]: https://developer.mozilla.org/en-US/docs/Web/API/console/error
+#[macro_export]
+macro_rules! error {
+    ($($arg:tt)+) => {
+        if const { $crate::console::__enabled($crate::console::Level::Error) } {
+            $crate::console::__log_fmt($crate::console::Level::Error, format_args!($($arg)+));
+        }
+    };
+}
+
+/// Prints a message formatted like with [`format!`] using the emscripten-defined `emscripten_dbg`, at the [`Level::Debug`] level.
+/// See [`log!`](crate::log).
+///
+/// Unlike the standard `dbg!`, it takes a format string rather than an expression to print.
+///
+/// # Examples
+/// ```rust
+/// emscripten_functions::dbg!("player at {:?}", player.position);
+/// ```
+#[macro_export]
+macro_rules! dbg {
+    ($($arg:tt)+) => {
+        if const { $crate::console::__enabled($crate::console::Level::Debug) } {
+            $crate::console::__log_fmt($crate::console::Level::Debug, format_args!($($arg)+));
+        }
+    };
+}
+
+/// The default size threshold, in bytes, after which a [`BufferedLogger`] level buffer gets flushed.
+pub const DEFAULT_BUFFERED_LOGGER_THRESHOLD: usize = 64 * 1024;
+
+/// A console logger that collects lines in reusable buffers and sends them to JS in batches.
+///
+/// Each level ([`log`], [`warn`], [`error`]) has its own buffer, so the level-based routing is kept:
+/// a flush results in at most one [`console.log()`], one [`console.warn()`] and one [`console.error()`] call, each printing all the buffered lines of its level.
+/// The buffers keep their capacity after a flush, so a logger that is used every frame stops allocating after the first few frames.
+///
+/// A level buffer is flushed when it grows past the threshold given at construction, when [`BufferedLogger::flush`] gets called, and when the logger is dropped.
+/// The lines are only ordered within the same level.
+///
+/// Each thread has its own buffered logger, that can be accessed with [`with_buffered_logger`], and which is flushed automatically
+/// at the end of each tick of the main loop set with [`set_main_loop_with_arg`] or [`set_main_loop`].
+///
+/// [`console.log()`]: https://developer.mozilla.org/en-US/docs/Web/API/console/log
+/// [`console.warn()`]: https://developer.mozilla.org/en-US/docs/Web/API/console/warn
+/// [`console.error()`]: https://developer.mozilla.org/en-US/docs/Web/API/console/error
+/// [`set_main_loop_with_arg`]: crate::emscripten::set_main_loop_with_arg
+/// [`set_main_loop`]: crate::emscripten::set_main_loop
+///
+/// # Examples
+/// ```rust
+/// let mut logger = BufferedLogger::new(DEFAULT_BUFFERED_LOGGER_THRESHOLD);
+/// for i in 0..100 {
+///     logger.log(format!("Line {}", i));
+/// }
+/// logger.warn("Something's odd");
+/// // Only 2 calls to JS are made here.
+/// logger.flush();
+/// ```
+#[derive(Debug)]
+pub struct BufferedLogger {
+    log: String,
+    warn: String,
+    error: String,
+    threshold: usize,
+}
+
+impl BufferedLogger {
+    /// Creates a new buffered logger with empty buffers.
+    ///
+    /// # Arguments
+    /// * `threshold` - The size in bytes after which a level buffer is flushed on its own.
+    pub const fn new(threshold: usize) -> Self {
+        Self {
+            log: String::new(),
+            warn: String::new(),
+            error: String::new(),
+            threshold,
+        }
+    }
+
+    /// Buffers the given line to be printed with [`console.log()`].
+    ///
+    /// [`console.log()`]: https://developer.mozilla.org/en-US/docs/Web/API/console/log
+    pub fn log<T>(&mut self, string: T)
+    where
+        T: AsRef<str>,
+    {
+        Self::push_line(&mut self.log, string.as_ref(), self.threshold, log_str);
+    }
+
+    /// Buffers the given line to be printed with [`console.warn()`].
+    ///
+    /// [`console.warn()`]: https://developer.mozilla.org/en-US/docs/Web/API/console/warn
+    pub fn warn<T>(&mut self, string: T)
+    where
+        T: AsRef<str>,
+    {
+        Self::push_line(&mut self.warn, string.as_ref(), self.threshold, warn_str);
+    }
+
+    /// Buffers the given line to be printed with [`console.error()`].
+    ///
+    /// [`console.error()`]: https://developer.mozilla.org/en-US/docs/Web/API/console/error
+    pub fn error<T>(&mut self, string: T)
+    where
+        T: AsRef<str>,
+    {
+        Self::push_line(&mut self.error, string.as_ref(), self.threshold, error_str);
+    }
+
+    /// Formats the given arguments directly into the [`console.log()`] buffer, without an intermediate `String`.
+    ///
+    /// [`console.log()`]: https://developer.mozilla.org/en-US/docs/Web/API/console/log
+    ///
+    /// # Examples
+    /// ```rust
+    /// logger.log_fmt(format_args!("0.1 + 0.2 = {}", 0.1 + 0.2));
+    /// ```
+    pub fn log_fmt(&mut self, args: fmt::Arguments) {
+        Self::push_fmt(&mut self.log, args, self.threshold, log_str);
+    }
+
+    /// Formats the given arguments directly into the [`console.warn()`] buffer, without an intermediate `String`.
+    ///
+    /// [`console.warn()`]: https://developer.mozilla.org/en-US/docs/Web/API/console/warn
+    pub fn warn_fmt(&mut self, args: fmt::Arguments) {
+        Self::push_fmt(&mut self.warn, args, self.threshold, warn_str);
+    }
+
+    /// Formats the given arguments directly into the [`console.error()`] buffer, without an intermediate `String`.
+    ///
+    /// [`console.error()`]: https://developer.mozilla.org/en-US/docs/Web/API/console/error
+    pub fn error_fmt(&mut self, args: fmt::Arguments) {
+        Self::push_fmt(&mut self.error, args, self.threshold, error_str);
+    }
+
+    /// Prints all the buffered lines, with one JS call per non-empty level buffer.
+    pub fn flush(&mut self) {
+        Self::flush_buffer(&mut self.log, log_str);
+        Self::flush_buffer(&mut self.warn, warn_str);
+        Self::flush_buffer(&mut self.error, error_str);
+    }
+
+    fn push_line(buffer: &mut String, line: &str, threshold: usize, print: fn(&str)) {
+        if !buffer.is_empty() {
+            buffer.push('\n');
+        }
+        buffer.push_str(line);
+
+        if buffer.len() >= threshold {
+            Self::flush_buffer(buffer, print);
+        }
+    }
+
+    fn push_fmt(buffer: &mut String, args: fmt::Arguments, threshold: usize, print: fn(&str)) {
+        if !buffer.is_empty() {
+            buffer.push('\n');
+        }
+        // Writing into a `String` never fails.
+        let _ = buffer.write_fmt(args);
+
+        if buffer.len() >= threshold {
+            Self::flush_buffer(buffer, print);
+        }
+    }
+
+    fn flush_buffer(buffer: &mut String, print: fn(&str)) {
+        if !buffer.is_empty() {
+            print(buffer);
+            // `clear` keeps the allocated capacity for the next lines.
+            buffer.clear();
+        }
+    }
+}
+
+impl Drop for BufferedLogger {
+    fn drop(&mut self) {
+        self.flush();
+    }
+}
+
+thread_local! {
+    static BUFFERED_LOGGER: RefCell<BufferedLogger> = RefCell::new(BufferedLogger::new(DEFAULT_BUFFERED_LOGGER_THRESHOLD));
+}
+
+/// Runs the given function with the calling thread's [`BufferedLogger`].
+///
+/// This logger is flushed at the end of each main loop tick, so the lines logged during a frame get printed together.
+///
+/// # Arguments
+/// * `func` - The function that uses the logger.
+///
+/// # Examples
+/// ```rust
+/// with_buffered_logger(|logger| {
+///     logger.log("Frame started");
+///     logger.log_fmt(format_args!("{} entities", 42));
+/// });
+/// ```
+pub fn with_buffered_logger<F, R>(func: F) -> R
+where
+    F: FnOnce(&mut BufferedLogger) -> R,
+{
+    BUFFERED_LOGGER.with(|logger| func(&mut logger.borrow_mut()))
+}
+
+/// Flushes the calling thread's [`BufferedLogger`].
+///
+/// It is called automatically at the end of each main loop tick; call it yourself if you log outside of the main loop.
+pub fn flush_buffered_logger() {
+    // `try_with` as this can also get called while the thread-locals are being destroyed,
+    // and `try_borrow_mut` so that a flush from inside `with_buffered_logger` doesn't panic.
+    let _ = BUFFERED_LOGGER.try_with(|logger| {
+        if let Ok(mut logger) = logger.try_borrow_mut() {
+            logger.flush();
+        }
+    });
+}
+
+// The methods of `console_label_call`.
+const TIME: c_int = 0;
+const TIME_END: c_int = 1;
+const TIME_LOG: c_int = 2;
+const COUNT: c_int = 3;
+const COUNT_RESET: c_int = 4;
+
+// The last label id given out; ids start at 1, as 0 marks a label without one yet.
+static LAST_LABEL_ID: AtomicU32 = AtomicU32::new(0);
+
+/// A label of the [`time`] and [`count`] functions, interned into a number on its first use.
+///
+/// Each thread's JS keeps the label strings by number, so a call only passes the number and the string without copying it,
+/// and the string is only decoded on the label's first use in the thread. It's usually created with [`console_label!`](crate::console_label).
+#[derive(Debug)]
+pub struct Label {
+    name: &'static str,
+    id: AtomicU32,
+}
+
+impl Label {
+    /// Creates a label, to be stored in a `static`.
+    pub const fn new(name: &'static str) -> Self {
+        Self {
+            name,
+            id: AtomicU32::new(0),
+        }
+    }
+
+    /// Returns the name of the label.
+    pub fn name(&self) -> &'static str {
+        self.name
+    }
+
+    fn id(&self) -> c_int {
+        let id = self.id.load(Ordering::Relaxed);
+        if id != 0 {
+            return id as c_int;
+        }
+        let new_id = LAST_LABEL_ID.fetch_add(1, Ordering::Relaxed) + 1;
+        // Another thread may have given the label its id meanwhile.
+        match self
+            .id
+            .compare_exchange(0, new_id, Ordering::Relaxed, Ordering::Relaxed)
+        {
+            Ok(_) => new_id as c_int,
+            Err(id) => id as c_int,
+        }
+    }
+
+    fn call(&self, method: c_int) {
+        unsafe {
+            console_label_call(
+                method,
+                self.id(),
+                self.name.as_ptr() as *const c_char,
+                self.name.len(),
+            )
+        };
+    }
+}
+
+/// Creates a `&'static` [`Label`](crate::console::Label) with the given name, interned once for the whole program.
+///
+/// # Examples
+/// ```rust
+/// console::count(console_label!("physics step"));
+/// ```
+#[macro_export]
+macro_rules! console_label {
+    ($name:expr) => {{
+        static LABEL: $crate::console::Label = $crate::console::Label::new($name);
+        &LABEL
+    }};
+}
+
+/// A timer started with [`time`], whose elapsed time gets printed by [`console.timeEnd()`] when it's dropped.
+///
+/// [`console.timeEnd()`]: https://developer.mozilla.org/en-US/docs/Web/API/console/timeEnd_static
+#[must_use = "the timer ends when the guard is dropped"]
+#[derive(Debug)]
+pub struct TimeGuard {
+    label: &'static Label,
+}
+
+impl TimeGuard {
+    /// Prints the time elapsed so far, using the [`console.timeLog()`] JS function, without ending the timer.
+    ///
+    /// [`console.timeLog()`]: https://developer.mozilla.org/en-US/docs/Web/API/console/timeLog_static
+    pub fn log(&self) {
+        self.label.call(TIME_LOG);
+    }
+
+    /// Ends the timer, printing its elapsed time. Same as dropping the guard.
+    pub fn end(self) {}
+}
+
+impl Drop for TimeGuard {
+    fn drop(&mut self) {
+        self.label.call(TIME_END);
+    }
+}
+
+/// Starts a timer with the given label using the [`console.time()`] JS function, and returns a guard that ends it when dropped.
+/// The timers are per label: starting one with the label of a running one only makes the browser warn.
+///
+/// [`console.time()`]: https://developer.mozilla.org/en-US/docs/Web/API/console/time_static
+///
+/// # Examples
+/// ```rust
+/// {
+///     let _timer = console::time(console_label!("pathfinding"));
+///     find_paths(&mut agents);
+/// } // Prints "pathfinding: 1.234ms".
+/// ```
+pub fn time(label: &'static Label) -> TimeGuard {
+    label.call(TIME);
+    TimeGuard { label }
+}
+
+/// Ends the timer of the given label, printing its elapsed time, using the [`console.timeEnd()`] JS function,
+/// for timers that don't end in the scope they start in. See [`time`].
+///
+/// [`console.timeEnd()`]: https://developer.mozilla.org/en-US/docs/Web/API/console/timeEnd_static
+pub fn time_end(label: &'static Label) {
+    label.call(TIME_END);
+}
+
+/// Prints the number of times it got called with the given label, using the [`console.count()`] JS function.
+///
+/// [`console.count()`]: https://developer.mozilla.org/en-US/docs/Web/API/console/count_static
+///
+/// # Examples
+/// ```rust
+/// if cache.get(&key).is_none() {
+///     console::count(console_label!("cache miss"));
+/// }
+/// ```
+pub fn count(label: &'static Label) {
+    label.call(COUNT);
+}
+
+/// Resets the counter of the given label, using the [`console.countReset()`] JS function.
+///
+/// [`console.countReset()`]: https://developer.mozilla.org/en-US/docs/Web/API/console/countReset_static
+pub fn count_reset(label: &'static Label) {
+    label.call(COUNT_RESET);
+}
@@ -0,0 +1,240 @@
+//! WebGL context-loss recovery that recreates the GPU resources over several frames, built on the [`webgl::Context`](crate::webgl::Context) callbacks.
+//!
+//! When a context is lost, all its GL objects are gone, and rebuilding them all in the `webglcontextrestored` handler
+//! blocks the page for as long as the whole upload takes.
+//! The [`ContextRecovery`] instead keeps the creation function of each resource, and replays them in registration order
+//! across animation frames, spending at most a time budget per frame.
+
+use std::{
+    cell::RefCell,
+    collections::{BTreeMap, VecDeque},
+    rc::Rc,
+};
+
+use emscripten_functions_sys::html5;
+
+use crate::{
+    emscripten::get_now,
+    html5::{request_animation_frame, Html5Error},
+    webgl::Context,
+};
+
+/// The id of a resource registered to a [`ContextRecovery`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, PartialOrd, Ord)]
+pub struct ResourceId(u64);
+
+type Create = Box<dyn FnMut()>;
+type OnEvent = Box<dyn FnMut()>;
+
+struct RecoveryState {
+    context: html5::EMSCRIPTEN_WEBGL_CONTEXT_HANDLE,
+    budget_ms: f64,
+    next_id: u64,
+    // Ordered by id, i.e. by registration order, so that e.g. textures get recreated before the framebuffers using them.
+    resources: BTreeMap<ResourceId, Option<Create>>,
+    // The resources left to recreate since the last restore.
+    pending: VecDeque<ResourceId>,
+    frame_requested: bool,
+    onlost: Option<OnEvent>,
+    onrecovered: Option<OnEvent>,
+}
+
+/// Recreates the registered GPU resources of a context after it was lost and restored, spread over several frames.
+///
+/// # Examples
+/// ```rust
+/// let mut context = Context::builder().create("#canvas").unwrap();
+/// context.make_current().unwrap();
+///
+/// let recovery = ContextRecovery::new(&mut context, 4.0).unwrap();
+/// for texture in level.textures() {
+///     let handle = texture.handle.clone();
+///     // Called once now, and again after each restore.
+///     recovery.register(move || handle.set(upload_texture(&texture.pixels)));
+/// }
+/// recovery.on_recovered(|| println!("All the resources are back"));
+///
+/// set_main_loop(move || {
+///     if !recovery.is_ready() {
+///         draw_loading_screen();
+///         return;
+///     }
+///     draw_scene();
+/// }, 0, true);
+/// ```
+#[derive(Clone)]
+pub struct ContextRecovery {
+    state: Rc<RefCell<RecoveryState>>,
+}
+
+impl ContextRecovery {
+    /// Starts handling the losses and restores of the context, replacing its [`on_lost`](Context::on_lost)
+    /// and [`on_restored`](Context::on_restored) callbacks.
+    ///
+    /// # Arguments
+    /// * `context` - The context, which must stay current on the calling thread while resources get recreated.
+    /// * `budget_ms` - The time spent recreating resources per animation frame, in milliseconds.
+    ///   At least one resource is recreated per frame, however long it takes.
+    pub fn new(context: &mut Context, budget_ms: f64) -> Result<Self, Html5Error> {
+        let state = Rc::new(RefCell::new(RecoveryState {
+            context: context.as_raw(),
+            budget_ms,
+            next_id: 0,
+            resources: BTreeMap::new(),
+            pending: VecDeque::new(),
+            frame_requested: false,
+            onlost: None,
+            onrecovered: None,
+        }));
+
+        let lost_state = Rc::downgrade(&state);
+        context.on_lost(move || {
+            if let Some(state) = lost_state.upgrade() {
+                // Anything still pending would have been created in the lost context.
+                state.borrow_mut().pending.clear();
+                take_and_call(&state, |state| &mut state.onlost);
+            }
+            // Lets the browser restore the context.
+            true
+        })?;
+
+        let restored_state = Rc::downgrade(&state);
+        context.on_restored(move || {
+            if let Some(state) = restored_state.upgrade() {
+                {
+                    let mut state = state.borrow_mut();
+                    state.pending = state.resources.keys().copied().collect();
+                }
+                request_replay(&state);
+            }
+            false
+        })?;
+
+        Ok(Self { state })
+    }
+
+    /// Registers a resource: `create` is called once now, and again after each restore of the context.
+    pub fn register<F>(&self, mut create: F) -> ResourceId
+    where
+        F: 'static + FnMut(),
+    {
+        create();
+
+        let mut state = self.state.borrow_mut();
+        let id = ResourceId(state.next_id);
+        state.next_id += 1;
+        state.resources.insert(id, Some(Box::new(create)));
+        id
+    }
+
+    /// Stops recreating the given resource, e.g. after deleting it.
+    pub fn unregister(&self, id: ResourceId) {
+        let mut state = self.state.borrow_mut();
+        state.resources.remove(&id);
+        state.pending.retain(|pending| *pending != id);
+    }
+
+    /// Returns `true` if the context is lost, using the emscripten-defined [`emscripten_is_webgl_context_lost`].
+    ///
+    /// [`emscripten_is_webgl_context_lost`]: https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_is_webgl_context_lost
+    pub fn is_lost(&self) -> bool {
+        unsafe { html5::emscripten_is_webgl_context_lost(self.state.borrow().context) != 0 }
+    }
+
+    /// Returns `true` if the context isn't lost, and all the resources got recreated since its last restore.
+    pub fn is_ready(&self) -> bool {
+        !self.is_lost() && self.state.borrow().pending.is_empty()
+    }
+
+    /// Returns the number of resources recreated since the last restore, and the number of registered resources.
+    pub fn progress(&self) -> (usize, usize) {
+        let state = self.state.borrow();
+        let total = state.resources.len();
+        (total - state.pending.len(), total)
+    }
+
+    /// Sets the function called when the context gets lost.
+    pub fn on_lost<F>(&self, onlost: F)
+    where
+        F: 'static + FnMut(),
+    {
+        self.state.borrow_mut().onlost = Some(Box::new(onlost));
+    }
+
+    /// Sets the function called when all the resources got recreated after a restore.
+    pub fn on_recovered<F>(&self, onrecovered: F)
+    where
+        F: 'static + FnMut(),
+    {
+        self.state.borrow_mut().onrecovered = Some(Box::new(onrecovered));
+    }
+}
+
+// Takes the handler out of the state during its call, so that it can use the recovery.
+fn take_and_call(
+    state: &Rc<RefCell<RecoveryState>>,
+    handler: fn(&mut RecoveryState) -> &mut Option<OnEvent>,
+) {
+    let func = handler(&mut state.borrow_mut()).take();
+    if let Some(mut func) = func {
+        func();
+        handler(&mut state.borrow_mut()).get_or_insert(func);
+    }
+}
+
+fn request_replay(state: &Rc<RefCell<RecoveryState>>) {
+    if std::mem::replace(&mut state.borrow_mut().frame_requested, true) {
+        return;
+    }
+
+    let state = Rc::downgrade(state);
+    request_animation_frame(move |_| {
+        if let Some(state) = state.upgrade() {
+            replay(&state);
+        }
+    });
+}
+
+// Recreates pending resources until this frame's budget is spent.
+fn replay(state: &Rc<RefCell<RecoveryState>>) {
+    let (deadline, context) = {
+        let mut state = state.borrow_mut();
+        state.frame_requested = false;
+        (get_now() + state.budget_ms, state.context)
+    };
+    if unsafe { html5::emscripten_is_webgl_context_lost(context) } != 0 {
+        return;
+    }
+
+    loop {
+        let create = {
+            let mut state = state.borrow_mut();
+            let Some(id) = state.pending.pop_front() else {
+                break;
+            };
+            state
+                .resources
+                .get_mut(&id)
+                .and_then(|create| create.take())
+                .map(|create| (id, create))
+        };
+
+        // The function is taken out during its call, so that it can register or unregister resources.
+        if let Some((id, mut create)) = create {
+            create();
+            if let Some(slot) = state.borrow_mut().resources.get_mut(&id) {
+                slot.get_or_insert(create);
+            }
+        }
+
+        if get_now() >= deadline {
+            break;
+        }
+    }
+
+    if state.borrow().pending.is_empty() {
+        take_and_call(state, |state| &mut state.onrecovered);
+    } else {
+        request_replay(state);
+    }
+}
@@ -0,0 +1,164 @@
+//! The device pixel ratio and the screen size, cached on the rust side, with change notifications.
+//!
+//! [`get_device_pixel_ratio`] and [`get_screen_size`] call into JS, and renderers tend to call them every frame to notice changes,
+//! e.g. when the window moves to a screen with another pixel density, or the page gets zoomed.
+//! [`device_pixel_ratio`] and [`screen_size`] instead read values that a JS listener updates: a `matchMedia("(resolution: Xdppx)")`
+//! query, re-armed with the new ratio on each change, and the window's `resize` events. [`on_display_change`] subscribes to the changes.
+//!
+//! The listener is installed by the first call made on the main browser thread. The calls made on other threads before that
+//! read the values from JS, and the cached ones afterwards.
+//!
+//! [`get_device_pixel_ratio`]: crate::emscripten::get_device_pixel_ratio
+//! [`get_screen_size`]: crate::emscripten::get_screen_size
+
+use std::{
+    cell::{Cell, RefCell},
+    marker::PhantomData,
+    os::raw::c_int,
+    rc::Rc,
+    sync::atomic::{AtomicBool, AtomicU64, Ordering},
+};
+
+use crate::{
+    emscripten::{get_device_pixel_ratio, get_screen_size, ScreenSize},
+    threading::is_main_browser_thread,
+};
+
+extern "C" {
+    fn display_listen(callback: unsafe extern "C" fn(ratio: f64, width: c_int, height: c_int));
+}
+
+static INSTALLED: AtomicBool = AtomicBool::new(false);
+static RATIO: AtomicU64 = AtomicU64::new(0);
+// The width in the high 32 bits, and the height in the low ones.
+static SCREEN: AtomicU64 = AtomicU64::new(0);
+
+/// The display values given to the functions subscribed with [`on_display_change`].
+#[derive(Debug, Clone, PartialEq)]
+pub struct DisplayMetrics {
+    /// The device pixel ratio, as given by [`device_pixel_ratio`].
+    pub device_pixel_ratio: f64,
+    /// The size of the screen, as given by [`screen_size`].
+    pub screen_size: ScreenSize,
+}
+
+type OnChange = Rc<RefCell<dyn FnMut(&DisplayMetrics)>>;
+
+thread_local! {
+    // The subscribers of the main browser thread, by identifier.
+    static SUBSCRIBERS: RefCell<Vec<(u64, OnChange)>> = const { RefCell::new(Vec::new()) };
+    static NEXT_ID: Cell<u64> = const { Cell::new(0) };
+}
+
+unsafe extern "C" fn changed(ratio: f64, width: c_int, height: c_int) {
+    let first = RATIO.swap(ratio.to_bits(), Ordering::Relaxed) == 0;
+    SCREEN.store(
+        ((width as u32 as u64) << 32) | height as u32 as u64,
+        Ordering::Relaxed,
+    );
+    // The first report is the initial state, made while installing the listener.
+    if first {
+        return;
+    }
+
+    let metrics = DisplayMetrics {
+        device_pixel_ratio: ratio,
+        screen_size: ScreenSize { width, height },
+    };
+    // The subscribers are called outside of the borrow, so that they can subscribe or unsubscribe.
+    let subscribers: Vec<(u64, OnChange)> =
+        SUBSCRIBERS.with(|subscribers| subscribers.borrow().clone());
+    for (id, subscriber) in subscribers {
+        let subscribed = SUBSCRIBERS.with(|subscribers| {
+            subscribers
+                .borrow()
+                .iter()
+                .any(|(subscribed, _)| *subscribed == id)
+        });
+        if subscribed {
+            (subscriber.borrow_mut())(&metrics);
+        }
+    }
+}
+
+// Installs the listener if it isn't yet and the calling thread is the main browser thread, and returns whether it's installed.
+fn installed() -> bool {
+    if INSTALLED.load(Ordering::Acquire) {
+        return true;
+    }
+    if !is_main_browser_thread() {
+        return false;
+    }
+    // The listener reports the initial values before returning.
+    unsafe { display_listen(changed) };
+    INSTALLED.store(RATIO.load(Ordering::Relaxed) != 0, Ordering::Release);
+    INSTALLED.load(Ordering::Acquire)
+}
+
+/// Returns the device pixel ratio, from the cache once the listener is installed.
+pub fn device_pixel_ratio() -> f64 {
+    if installed() {
+        f64::from_bits(RATIO.load(Ordering::Relaxed))
+    } else {
+        get_device_pixel_ratio()
+    }
+}
+
+/// Returns the size of the screen, from the cache once the listener is installed.
+pub fn screen_size() -> ScreenSize {
+    if installed() {
+        let screen = SCREEN.load(Ordering::Relaxed);
+        ScreenSize {
+            width: (screen >> 32) as u32 as c_int,
+            height: screen as u32 as c_int,
+        }
+    } else {
+        get_screen_size()
+    }
+}
+
+/// A subscription to the display changes, created with [`on_display_change`]. Dropping it unsubscribes.
+#[must_use = "the function is unsubscribed when dropped"]
+pub struct DisplaySubscription {
+    id: u64,
+    _not_send: PhantomData<*const ()>,
+}
+
+impl Drop for DisplaySubscription {
+    fn drop(&mut self) {
+        let removed = SUBSCRIBERS.with(|subscribers| {
+            let mut subscribers = subscribers.borrow_mut();
+            let index = subscribers.iter().position(|(id, _)| *id == self.id);
+            index.map(|index| subscribers.remove(index))
+        });
+        // The function is dropped outside of the borrow, as dropping it could drop other subscriptions.
+        drop(removed);
+    }
+}
+
+/// Subscribes a function to the changes of the device pixel ratio or of the screen size. It must be called from the main browser thread.
+///
+/// # Examples
+/// ```rust
+/// let _subscription = on_display_change(|metrics| {
+///     println!("{}x{} at {}dppx", metrics.screen_size.width, metrics.screen_size.height, metrics.device_pixel_ratio);
+///     renderer.recreate_swapchain();
+/// });
+/// ```
+pub fn on_display_change<F>(func: F) -> DisplaySubscription
+where
+    F: 'static + FnMut(&DisplayMetrics),
+{
+    assert!(
+        installed(),
+        "the display changes must be subscribed to from the main browser thread"
+    );
+
+    let id = NEXT_ID.with(|next| next.replace(next.get() + 1));
+    let func: OnChange = Rc::new(RefCell::new(func));
+    SUBSCRIBERS.with(|subscribers| subscribers.borrow_mut().push((id, func)));
+    DisplaySubscription {
+        id,
+        _not_send: PhantomData,
+    }
+}
@@ -0,0 +1,163 @@
+//! DOM updates recorded in rust, and applied together in one JS call.
+//!
+//! Each `run_script` or [`Script`](crate::script::Script) call updating the DOM crosses into JS.
+//! A [`DomBatch`] records the updates of a frame in a compact command buffer in the wasm memory instead,
+//! and [`DomBatch::apply`] runs them all with one call to a JS interpreter of the commands.
+//!
+//! The nodes are [`JsHandle`]s, e.g. from [`JsHandle::query_selector`]. It must be used from the main browser thread.
+
+use std::os::raw::{c_char, c_int};
+
+use crate::{memory::install_heap_views, script::JsHandle};
+
+extern "C" {
+    fn dom_batch_apply(commands: *const u32, count: c_int, strings: *const c_char);
+}
+
+// The opcodes of the commands, as interpreted in `dom_batch.c`.
+const SET_TEXT: u32 = 0;
+const SET_ATTRIBUTE: u32 = 1;
+const REMOVE_ATTRIBUTE: u32 = 2;
+const SET_STYLE: u32 = 3;
+const TOGGLE_CLASS: u32 = 4;
+const APPEND_CHILD: u32 = 5;
+const REMOVE: u32 = 6;
+
+/// A buffer of DOM commands, applied in order by one JS call.
+///
+/// The handles of the recorded commands must be kept alive until the batch is applied: the commands of released handles are skipped,
+/// but a handle created after the release can take the same slot.
+/// Applying the batch clears it, keeping its memory for the next frame.
+///
+/// # Examples
+/// ```rust
+/// let score = JsHandle::query_selector("#score").unwrap();
+/// let health = JsHandle::query_selector("#health").unwrap();
+/// let mut batch = DomBatch::new();
+///
+/// set_main_loop(move || {
+///     batch.set_text(&score, &points().to_string());
+///     batch.set_style(&health, "width", &format!("{}%", hp()));
+///     batch.toggle_class(&health, "low", hp() < 20);
+///     batch.apply();
+/// }, 0, true);
+/// ```
+#[derive(Debug, Default)]
+pub struct DomBatch {
+    commands: Vec<u32>,
+    strings: Vec<u8>,
+}
+
+impl DomBatch {
+    /// Creates an empty batch.
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    // Stores the string, returning its offset and length as command operands.
+    fn string(&mut self, string: &str) -> [u32; 2] {
+        let offset = self.strings.len() as u32;
+        self.strings.extend_from_slice(string.as_bytes());
+        [offset, string.len() as u32]
+    }
+
+    /// Records setting the `textContent` of the node.
+    pub fn set_text(&mut self, node: &JsHandle, text: &str) {
+        let text = self.string(text);
+        self.commands
+            .extend_from_slice(&[SET_TEXT, node.as_raw() as u32, text[0], text[1]]);
+    }
+
+    /// Records setting an attribute of the element, with `setAttribute`.
+    pub fn set_attribute(&mut self, node: &JsHandle, name: &str, value: &str) {
+        let name = self.string(name);
+        let value = self.string(value);
+        self.commands.extend_from_slice(&[
+            SET_ATTRIBUTE,
+            node.as_raw() as u32,
+            name[0],
+            name[1],
+            value[0],
+            value[1],
+        ]);
+    }
+
+    /// Records removing an attribute of the element, with `removeAttribute`.
+    pub fn remove_attribute(&mut self, node: &JsHandle, name: &str) {
+        let name = self.string(name);
+        self.commands.extend_from_slice(&[
+            REMOVE_ATTRIBUTE,
+            node.as_raw() as u32,
+            name[0],
+            name[1],
+        ]);
+    }
+
+    /// Records setting a CSS property of the element's inline style, e.g. `"width"` or `"--hue"`, with `style.setProperty`.
+    pub fn set_style(&mut self, node: &JsHandle, property: &str, value: &str) {
+        let property = self.string(property);
+        let value = self.string(value);
+        self.commands.extend_from_slice(&[
+            SET_STYLE,
+            node.as_raw() as u32,
+            property[0],
+            property[1],
+            value[0],
+            value[1],
+        ]);
+    }
+
+    /// Records adding the class to the element if `on` is `true`, or removing it otherwise, with `classList.toggle`.
+    pub fn toggle_class(&mut self, node: &JsHandle, class: &str, on: bool) {
+        let class = self.string(class);
+        self.commands.extend_from_slice(&[
+            TOGGLE_CLASS,
+            node.as_raw() as u32,
+            class[0],
+            class[1],
+            on as u32,
+        ]);
+    }
+
+    /// Records appending the `child` node to the `parent` one, which moves it if it's already in the document.
+    pub fn append_child(&mut self, parent: &JsHandle, child: &JsHandle) {
+        self.commands.extend_from_slice(&[
+            APPEND_CHILD,
+            parent.as_raw() as u32,
+            child.as_raw() as u32,
+        ]);
+    }
+
+    /// Records removing the node from the document. Its handle still holds it, so it can be appended again.
+    pub fn remove(&mut self, node: &JsHandle) {
+        self.commands
+            .extend_from_slice(&[REMOVE, node.as_raw() as u32]);
+    }
+
+    /// Returns `true` if no command was recorded since the batch was last applied or cleared.
+    pub fn is_empty(&self) -> bool {
+        self.commands.is_empty()
+    }
+
+    /// Discards the recorded commands, keeping the memory.
+    pub fn clear(&mut self) {
+        self.commands.clear();
+        self.strings.clear();
+    }
+
+    /// Runs the recorded commands in order, with one JS call, and clears the batch. It does nothing if the batch is empty.
+    pub fn apply(&mut self) {
+        if self.commands.is_empty() {
+            return;
+        }
+        install_heap_views();
+        unsafe {
+            dom_batch_apply(
+                self.commands.as_ptr(),
+                self.commands.len() as c_int,
+                self.strings.as_ptr() as *const c_char,
+            );
+        }
+        self.clear();
+    }
+}
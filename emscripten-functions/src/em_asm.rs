@@ -0,0 +1,256 @@
+//! JavaScript code embedded in the program at compile time, like with emscripten's [`em_js.h`] and [`em_asm.h`] C macros.
+//!
+//! The `run_script*` functions pass their script to `eval()` at run time, through a C shim. With these macros, the code is instead
+//! stored in the `em_js` and `em_asm` sections of the wasm module, which emscripten's linker turns into regular JS functions:
+//! they are parsed once with the rest of the JS glue code, and called with typed arguments, without marshalling any string.
+//!
+//! - [`em_js!`](crate::em_js) declares JS functions, that are called like imported C functions.
+//! - [`em_asm!`](crate::em_asm), [`em_asm_int!`](crate::em_asm_int) and [`em_asm_double!`](crate::em_asm_double) run inline JS snippets,
+//!   whose arguments are named `$0`, `$1`, ...
+//! - [`main_thread_em_asm!`](crate::main_thread_em_asm), [`main_thread_em_asm_int!`](crate::main_thread_em_asm_int)
+//!   and [`main_thread_em_asm_double!`](crate::main_thread_em_asm_double) run them on the main browser thread, blocking until they're done.
+//!
+//! The code is a string literal, usually a raw one (`r#"..."#`), as JS doesn't always tokenize as rust.
+//!
+//! The macros need the `em_asm` feature. The sections are emitted with `#[link_section]`, which emcc must extract like
+//! those of the C macros: the `em_asm_link` example checks it does with the toolchain at hand, and aborts otherwise. Run it with
+//! `cargo run --example em_asm_link --features em_asm`.
+//!
+//! [`em_js.h`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.EM_JS
+//! [`em_asm.h`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.EM_ASM
+
+use core::ffi::{c_int, c_void};
+
+/// A type that can be passed to an `em_asm!` snippet, given to JS as a number (or a `BigInt` for the 64-bit integers, with `-sWASM_BIGINT`).
+pub trait EmAsmArg: Copy {
+    /// The type the value is passed as through the variadic arguments.
+    type Raw;
+    /// The character of the type in the signature of the snippet's arguments.
+    const SIG: u8;
+    /// Converts the value to the type it's passed as.
+    fn into_raw(self) -> Self::Raw;
+}
+
+macro_rules! impl_em_asm_arg {
+    ($($ty:ty => $raw:ty, $sig:literal;)*) => {
+        $(
+            impl EmAsmArg for $ty {
+                type Raw = $raw;
+                const SIG: u8 = $sig;
+                fn into_raw(self) -> $raw {
+                    self as $raw
+                }
+            }
+        )*
+    };
+}
+
+impl_em_asm_arg! {
+    i8 => c_int, b'i';
+    u8 => c_int, b'i';
+    i16 => c_int, b'i';
+    u16 => c_int, b'i';
+    i32 => c_int, b'i';
+    u32 => c_int, b'i';
+    bool => c_int, b'i';
+    i64 => i64, b'j';
+    u64 => i64, b'j';
+    isize => isize, b'p';
+    usize => usize, b'p';
+    // Floats are passed as doubles through variadic arguments, like in C.
+    f32 => f64, b'd';
+    f64 => f64, b'd';
+}
+
+impl<T> EmAsmArg for *const T {
+    type Raw = *const c_void;
+    const SIG: u8 = b'p';
+    fn into_raw(self) -> *const c_void {
+        self as *const c_void
+    }
+}
+
+impl<T> EmAsmArg for *mut T {
+    type Raw = *const c_void;
+    const SIG: u8 = b'p';
+    fn into_raw(self) -> *const c_void {
+        self as *const c_void
+    }
+}
+
+#[doc(hidden)]
+pub fn __sig<T: EmAsmArg>(_: &T) -> u8 {
+    T::SIG
+}
+
+// Copies a string into an array, which can then be placed in a link section.
+#[doc(hidden)]
+pub const fn __to_array<const N: usize>(string: &str) -> [u8; N] {
+    let bytes = string.as_bytes();
+    let mut array = [0; N];
+    let mut i = 0;
+    while i < N {
+        array[i] = bytes[i];
+        i += 1;
+    }
+    array
+}
+
+/// Declares JavaScript functions, like the [`EM_JS`] C macro.
+///
+/// Each function is stored in the `em_js` section, and becomes an imported function of the wasm module, called like any other C function.
+/// Its parameters have the names of the rust ones in the JS code, and must have FFI-safe number or pointer types.
+/// A slice is passed as its pointer and length, which the JS code views without a copy, e.g. with `HEAPF32.subarray(ptr >>> 2, (ptr >>> 2) + len)`.
+///
+/// The `__em_js__<name>` string emscripten reads the function from is kept with `#[used]`;
+/// if the linker still drops it, emcc reports the function as an undefined symbol, and it can be kept with
+/// `-C link-arg=-Wl,--export=__em_js__<name>`.
+///
+/// [`EM_JS`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.EM_JS
+///
+/// # Examples
+/// ```rust
+/// em_js! {
+///     /// Sets the width of the progress bar, from 0 to 1.
+///     fn set_progress(fraction: f64) {
+///         r#"document.getElementById("progress").style.width = (fraction * 100) + "%";"#
+///     }
+///
+///     fn device_pixel_ratio() -> f64 {
+///         "return window.devicePixelRatio;"
+///     }
+/// }
+///
+/// unsafe {
+///     set_progress(0.5);
+///     let ratio = device_pixel_ratio();
+/// }
+/// ```
+#[macro_export]
+macro_rules! em_js {
+    ($(
+        $(#[$meta:meta])*
+        $vis:vis fn $name:ident($($arg:ident: $ty:ty),* $(,)?) $(-> $ret:ty)? { $code:literal }
+    )*) => {
+        $(
+            #[link(wasm_import_module = "env")]
+            extern "C" {
+                $(#[$meta])*
+                $vis fn $name($($arg: $ty),*) $(-> $ret)?;
+            }
+
+            const _: () = {
+                // The layout of `EM_JS`: the parameter list, then the body.
+                const CODE: &str = concat!("(", stringify!($($arg),*), ")<::>{", $code, "}\0");
+                #[used]
+                #[export_name = concat!("__em_js__", stringify!($name))]
+                #[link_section = "em_js"]
+                static CODE_BYTES: [u8; CODE.len()] = $crate::em_asm::__to_array(CODE);
+            };
+        )*
+    };
+}
+
+// Binds each argument to a variable, in order, so that it's evaluated once, then calls the given `emscripten_asm_const_*` function
+// with the code stored in the `em_asm` section and the signature of the arguments.
+#[doc(hidden)]
+#[macro_export]
+macro_rules! __em_asm_call {
+    (@bind $func:path, $code:literal, [$($bound:ident)*]) => {{
+        const CODE: &str = concat!($code, "\0");
+        #[link_section = "em_asm"]
+        static CODE_BYTES: [u8; CODE.len()] = $crate::em_asm::__to_array(CODE);
+
+        let sig = [$($crate::em_asm::__sig(&$bound),)* 0u8];
+        $func(
+            CODE_BYTES.as_ptr() as *const ::core::ffi::c_char,
+            sig.as_ptr() as *const ::core::ffi::c_char,
+            $($crate::em_asm::EmAsmArg::into_raw($bound)),*
+        )
+    }};
+    (@bind $func:path, $code:literal, [$($bound:ident)*] $arg:expr $(, $rest:expr)*) => {{
+        // Each expansion's `arg` is a distinct variable, thanks to the macro hygiene.
+        let arg = $arg;
+        $crate::__em_asm_call!(@bind $func, $code, [$($bound)* arg] $($rest),*)
+    }};
+}
+
+/// Runs the given JavaScript snippet, with the given arguments available as `$0`, `$1`, ..., like the [`EM_ASM`] C macro.
+///
+/// The arguments can be of any [`EmAsmArg`](crate::em_asm::EmAsmArg) type: integers, floats, `bool` and raw pointers.
+/// It must be called in an `unsafe` block, like the JS code it runs.
+///
+/// [`EM_ASM`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.EM_ASM
+///
+/// # Examples
+/// ```rust
+/// unsafe {
+///     em_asm!(r#"console.log("frame", $0, "took", $1, "ms");"#, frame, duration);
+/// }
+/// ```
+#[macro_export]
+macro_rules! em_asm {
+    ($code:literal $(, $arg:expr)* $(,)?) => {{
+        $crate::__em_asm_call!(@bind $crate::__emscripten_sys::emscripten_asm_const_int, $code, [] $($arg),*);
+    }};
+}
+
+/// Runs the given JavaScript snippet like [`em_asm!`](crate::em_asm), returning its result converted to a C int, like the [`EM_ASM_INT`] C macro.
+///
+/// [`EM_ASM_INT`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.EM_ASM_INT
+///
+/// # Examples
+/// ```rust
+/// let width = unsafe { em_asm_int!("return window.innerWidth;") };
+/// ```
+#[macro_export]
+macro_rules! em_asm_int {
+    ($code:literal $(, $arg:expr)* $(,)?) => {
+        $crate::__em_asm_call!(@bind $crate::__emscripten_sys::emscripten_asm_const_int, $code, [] $($arg),*)
+    };
+}
+
+/// Runs the given JavaScript snippet like [`em_asm!`](crate::em_asm), returning its result converted to a C double, like the [`EM_ASM_DOUBLE`] C macro.
+///
+/// [`EM_ASM_DOUBLE`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.EM_ASM_DOUBLE
+#[macro_export]
+macro_rules! em_asm_double {
+    ($code:literal $(, $arg:expr)* $(,)?) => {
+        $crate::__em_asm_call!(@bind $crate::__emscripten_sys::emscripten_asm_const_double, $code, [] $($arg),*)
+    };
+}
+
+/// Runs the given JavaScript snippet on the main browser thread, blocking until it's done, like the [`MAIN_THREAD_EM_ASM`] C macro.
+/// In the main browser thread, it runs the snippet like [`em_asm!`](crate::em_asm).
+///
+/// [`MAIN_THREAD_EM_ASM`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.MAIN_THREAD_EM_ASM
+///
+/// # Examples
+/// ```rust
+/// // From a pthread.
+/// unsafe {
+///     main_thread_em_asm!(r#"document.title = "Level " + $0;"#, level);
+/// }
+/// ```
+#[macro_export]
+macro_rules! main_thread_em_asm {
+    ($code:literal $(, $arg:expr)* $(,)?) => {{
+        $crate::__em_asm_call!(@bind $crate::__emscripten_sys::emscripten_asm_const_int_sync_on_main_thread, $code, [] $($arg),*);
+    }};
+}
+
+/// Runs the given JavaScript snippet like [`main_thread_em_asm!`](crate::main_thread_em_asm), returning its result converted to a C int.
+#[macro_export]
+macro_rules! main_thread_em_asm_int {
+    ($code:literal $(, $arg:expr)* $(,)?) => {
+        $crate::__em_asm_call!(@bind $crate::__emscripten_sys::emscripten_asm_const_int_sync_on_main_thread, $code, [] $($arg),*)
+    };
+}
+
+/// Runs the given JavaScript snippet like [`main_thread_em_asm!`](crate::main_thread_em_asm), returning its result converted to a C double.
+#[macro_export]
+macro_rules! main_thread_em_asm_double {
+    ($code:literal $(, $arg:expr)* $(,)?) => {
+        $crate::__em_asm_call!(@bind $crate::__emscripten_sys::emscripten_asm_const_double_sync_on_main_thread, $code, [] $($arg),*)
+    };
+}
@@ -0,0 +1,151 @@
+//! Allocator statistics, fragmentation metrics and trimming, over the emscripten `emmalloc.h` header file.
+//!
+//! emmalloc is emscripten's small allocator. It never gives memory back to the wasm heap by itself:
+//! after a load spike, [`trim`] returns its free memory at the end of the heap, for other `sbrk` users to claim.
+//!
+//! The program must be built with `-sMALLOC=emmalloc` (or one of its `emmalloc-*` variants): with the default allocator these functions aren't linked.
+
+use std::os::raw::c_void;
+
+use emscripten_functions_sys::emmalloc;
+
+/// The number of size classes of a [`FragmentationMap`].
+pub const SIZE_CLASSES: usize = 32;
+
+/// The memory usage of emmalloc, returned by [`stats`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct AllocatorStats {
+    /// The size of the memory governed by emmalloc, that it claimed with `sbrk`, in bytes.
+    pub dynamic_heap_size: usize,
+    /// The free memory inside the dynamic heap, in bytes.
+    pub free_dynamic_memory: usize,
+    /// The memory of the heap emmalloc could still claim with `sbrk`, in bytes.
+    pub unclaimed_heap_memory: usize,
+}
+
+impl AllocatorStats {
+    /// Returns the memory in use by allocations, in bytes.
+    pub fn used(&self) -> usize {
+        self.dynamic_heap_size
+            .saturating_sub(self.free_dynamic_memory)
+    }
+
+    /// Returns the maximum memory that can still be allocated, in bytes, if it weren't fragmented.
+    pub fn available(&self) -> usize {
+        self.free_dynamic_memory + self.unclaimed_heap_memory
+    }
+}
+
+/// Returns the memory usage of emmalloc, using the emscripten-defined `emmalloc_dynamic_heap_size`,
+/// `emmalloc_free_dynamic_memory` and `emmalloc_unclaimed_heap_memory`.
+///
+/// It walks through all the free memory blocks, so it's slow with a fragmented heap: it's meant for periodic telemetry, not for each frame.
+pub fn stats() -> AllocatorStats {
+    unsafe {
+        AllocatorStats {
+            dynamic_heap_size: emmalloc::emmalloc_dynamic_heap_size(),
+            free_dynamic_memory: emmalloc::emmalloc_free_dynamic_memory(),
+            unclaimed_heap_memory: emmalloc::emmalloc_unclaimed_heap_memory(),
+        }
+    }
+}
+
+/// The free memory blocks of emmalloc, by size class, returned by [`fragmentation_map`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct FragmentationMap {
+    /// The number of free blocks whose size is between `2^i` included and `2^(i+1)` excluded bytes, at each index `i`.
+    pub counts: [usize; SIZE_CLASSES],
+    /// The total number of free blocks.
+    pub free_blocks: usize,
+}
+
+impl FragmentationMap {
+    /// Returns the size class of the largest free blocks, if there's any free block:
+    /// they're at least `2^class` and less than `2^(class+1)` bytes big.
+    pub fn largest_class(&self) -> Option<usize> {
+        self.counts.iter().rposition(|&count| count != 0)
+    }
+
+    /// Returns how fragmented the free memory is, between 0 when it's all in blocks of the largest size class, and close to 1 when it's all in small blocks.
+    ///
+    /// It's estimated from the size classes: each block counts for the lower bound of its class.
+    pub fn fragmentation(&self) -> f64 {
+        let Some(largest) = self.largest_class() else {
+            return 0.0;
+        };
+        let total: f64 = self
+            .counts
+            .iter()
+            .enumerate()
+            .map(|(class, &count)| count as f64 * (class as f64).exp2())
+            .sum();
+        let in_largest = self.counts[largest] as f64 * (largest as f64).exp2();
+        1.0 - in_largest / total
+    }
+}
+
+/// Returns the free memory blocks of emmalloc by size class, using the emscripten-defined `emmalloc_compute_free_dynamic_memory_fragmentation_map`.
+///
+/// It walks through all the free memory blocks, so it's slow with a fragmented heap.
+///
+/// # Examples
+/// ```rust
+/// let map = fragmentation_map();
+/// if map.fragmentation() > 0.5 {
+///     console::warn(&format!(
+///         "The heap is fragmented: {} free blocks, the largest at least {} bytes",
+///         map.free_blocks,
+///         map.largest_class().map_or(0, |class| 1usize << class)
+///     ));
+/// }
+/// ```
+pub fn fragmentation_map() -> FragmentationMap {
+    let mut counts = [0; SIZE_CLASSES];
+    let free_blocks = unsafe {
+        emmalloc::emmalloc_compute_free_dynamic_memory_fragmentation_map(counts.as_mut_ptr())
+    };
+    FragmentationMap {
+        counts,
+        free_blocks,
+    }
+}
+
+/// Returns the free memory at the end of emmalloc's dynamic heap back to the wasm heap, keeping `pad` bytes of it,
+/// using the emscripten-defined `emmalloc_trim`. Returns `true` if any memory was returned.
+///
+/// The wasm memory itself can't shrink: the memory is only given back for other `sbrk` users, e.g. another allocator, to claim.
+///
+/// # Examples
+/// ```rust
+/// // The level's allocations were freed, keep 1 MiB for the next one to start with.
+/// unload_level();
+/// trim(1024 * 1024);
+/// ```
+pub fn trim(pad: usize) -> bool {
+    unsafe { emmalloc::emmalloc_trim(pad) != 0 }
+}
+
+/// Returns the number of bytes actually allocated for the given pointer, at least the requested size, using the emscripten-defined `emmalloc_usable_size`.
+/// It returns 0 for a null pointer.
+///
+/// # Safety
+/// The pointer must be null, or returned by emmalloc and not freed yet.
+pub unsafe fn usable_size(ptr: *mut c_void) -> usize {
+    emmalloc::emmalloc_usable_size(ptr)
+}
+
+/// Checks the consistency of emmalloc's memory regions, using the emscripten-defined `emmalloc_validate_memory_regions`.
+/// Returns `true` if they're intact; otherwise an error is also printed to the console.
+pub fn validate() -> bool {
+    unsafe { emmalloc::emmalloc_validate_memory_regions() == 0 }
+}
+
+/// Prints emmalloc's memory regions and their blocks to the console, using the emscripten-defined `emmalloc_dump_memory_regions`.
+pub fn dump_memory_regions() {
+    unsafe { emmalloc::emmalloc_dump_memory_regions() };
+}
+
+/// Prints the [`fragmentation_map`] to the standard output, using the emscripten-defined `emmalloc_dump_free_dynamic_memory_fragmentation_map`.
+pub fn dump_fragmentation_map() {
+    unsafe { emmalloc::emmalloc_dump_free_dynamic_memory_fragmentation_map() };
+}
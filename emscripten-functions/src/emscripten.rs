@@ -4,19 +4,33 @@
 //! [`emscripten.h`]: https://emscripten.org/docs/api_reference/emscripten.h.html
 
 use std::{
-    cell::RefCell,
-    ffi::{CStr, CString},
+    cell::{Cell, RefCell},
+    ffi::CString,
     fmt::Display,
-    os::raw::{c_char, c_double, c_int},
+    os::raw::{c_int, c_void},
+    sync::OnceLock,
+};
+#[cfg(feature = "main_thread_script")]
+use std::{
+    ffi::CStr,
+    os::raw::{c_char, c_double},
 };
 
-use emscripten_functions_sys::emscripten;
+use emscripten_functions_sys::{emscripten, html5};
+
+use crate::c_str::{returned_string, with_c_str, with_returned_str};
+#[cfg(feature = "main_thread_script")]
+use crate::script::check_args;
 
 // The function to run in `set_main_loop_with_arg` sits in this thread-local object so that it will remain permanent throughout the main loop's run.
 // It needs to stay in a global place so that the `wrapper_func` that is passed as argument to `emscripten_set_main_loop`, which must be an `extern "C"` function, can access it (it couldn't have been a closure).
 // As the `thread_local` thing only gives us an immutable reference, we use a `RefCell` to be able to change the data when the function gets called.
 thread_local! {
     static MAIN_LOOP_FUNCTION: RefCell<Option<Box<dyn FnMut()>>> = RefCell::new(None);
+    // The function given to `replace_main_loop_with_arg`, which takes the place of `MAIN_LOOP_FUNCTION` at the start of the next tick.
+    static NEXT_MAIN_LOOP_FUNCTION: RefCell<Option<Box<dyn FnMut()>>> = RefCell::new(None);
+    // Set when `cancel_main_loop` is called from inside the main loop function, which is then freed once it returns.
+    static MAIN_LOOP_CANCELLED: Cell<bool> = const { Cell::new(false) };
 }
 
 /// Sets the given function as the main loop of the calling thread, using the emscripten-defined [`emscripten_set_main_loop`].
@@ -25,8 +39,14 @@ thread_local! {
 /// If you don't need that state argument, check out [`set_main_loop`].
 ///
 /// The main loop can be cancelled using the [`cancel_main_loop`] function.
+/// Its tick durations can be recorded by enabling [`enable_main_loop_stats`].
+/// Each tick runs in a [`with_frame_arena`] call, so the frame arena allocations made during a tick are freed at its end.
+/// The start time of each tick is captured for [`frame_time`].
 ///
 /// [`emscripten_set_main_loop`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_set_main_loop
+/// [`enable_main_loop_stats`]: crate::main_loop_stats::enable_main_loop_stats
+/// [`with_frame_arena`]: crate::frame_arena::with_frame_arena
+/// [`frame_time`]: crate::clock::frame_time
 ///
 /// # Arguments
 /// * `func` - The function to be set as main event loop for the calling thread.
@@ -74,6 +94,10 @@ pub fn set_main_loop_with_arg<F, T>(
 {
     // In `MAIN_LOOP_FUNCTION` we store a closure with no arguments, so that its type would be independent of `T`.
     // That closure calls the `func` parameter with `arg` as parameter, and owns them both.
+    // A replacement queued for the previous main loop doesn't carry over to this one,
+    // and the data of a previous one set with `set_main_loop_with_arg_direct` is freed.
+    NEXT_MAIN_LOOP_FUNCTION.with(|next| next.take());
+    release_direct_main_loop();
     MAIN_LOOP_FUNCTION.with(|func_ref| {
         *func_ref.borrow_mut() = Some(Box::new(move || {
             func(&mut arg);
@@ -81,9 +105,32 @@ pub fn set_main_loop_with_arg<F, T>(
     });
 
     unsafe extern "C" fn wrapper_func() {
-        MAIN_LOOP_FUNCTION.with(|func_ref| {
-            if let Some(function) = &mut *func_ref.borrow_mut() {
-                (*function)();
+        crate::main_loop_stats::run_instrumented(|| {
+            // The frame arena allocations of this tick are freed at its end.
+            crate::frame_arena::with_frame_arena(|_| {
+                // The clock is read once for the whole tick.
+                crate::clock::run_frame(|| {
+                    MAIN_LOOP_FUNCTION.with(|func_ref| {
+                        let mut func_ref = func_ref.borrow_mut();
+                        // The tick boundary is where a replacement function takes over.
+                        if let Some(next) = NEXT_MAIN_LOOP_FUNCTION.with(|next| next.take()) {
+                            *func_ref = Some(next);
+                        }
+                        if let Some(function) = &mut *func_ref {
+                            (*function)();
+                        }
+                        if MAIN_LOOP_CANCELLED.with(|cancelled| cancelled.replace(false)) {
+                            *func_ref = None;
+                        }
+                    });
+                });
+            });
+
+            // The lines logged during this tick get printed together, with the ones queued by the workers.
+            #[cfg(feature = "console")]
+            {
+                crate::worker_log::drain_on_tick();
+                crate::console::flush_buffered_logger();
             }
         });
     }
@@ -93,6 +140,43 @@ pub fn set_main_loop_with_arg<F, T>(
     };
 }
 
+/// Replaces the function of the calling thread's main loop set with [`set_main_loop_with_arg`] or [`set_main_loop`],
+/// keeping the loop registered with the browser, its timing, and its frame pacing.
+/// The new function runs from the next tick on; the current one is dropped then, with its state argument.
+///
+/// It can be called from inside the main loop function, e.g. to switch to another scene, without the frame
+/// the [`cancel_main_loop`] and [`set_main_loop_with_arg`] pair would drop. If it's called several times before the next tick, the last function wins.
+/// It does nothing to a main loop set with [`set_main_loop_with_arg_direct`].
+///
+/// # Examples
+/// ```rust
+/// set_main_loop_with_arg(|menu| {
+///     menu.draw();
+///     if menu.start_clicked() {
+///         replace_main_loop_with_arg(|level| level.update_and_draw(), Level::load(1));
+///     }
+/// }, Menu::new(), 0, true);
+/// ```
+pub fn replace_main_loop_with_arg<F, T>(mut func: F, mut arg: T)
+where
+    F: 'static + FnMut(&mut T),
+    T: 'static,
+{
+    NEXT_MAIN_LOOP_FUNCTION.with(|next| {
+        *next.borrow_mut() = Some(Box::new(move || {
+            func(&mut arg);
+        }));
+    });
+}
+
+/// Replaces the function of the calling thread's main loop like [`replace_main_loop_with_arg`], with a function that has no parameters.
+pub fn replace_main_loop<F>(mut func: F)
+where
+    F: 'static + FnMut(),
+{
+    replace_main_loop_with_arg(move |_| func(), ());
+}
+
 /// Sets the given function as the main loop of the calling thread, using the emscripten-defined [`emscripten_set_main_loop`].
 /// The given function has no parameters.
 ///
@@ -121,16 +205,137 @@ where
     set_main_loop_with_arg(move |_| func(), (), fps, simulate_infinite_loop);
 }
 
-/// Cancels the main loop of the calling thread that was set using [`set_main_loop_with_arg`] or [`set_main_loop`].
+// The data of a main loop set with `set_main_loop_with_arg_direct`, whose raw pointer is passed to `emscripten_set_main_loop_arg`.
+// `running` and `release_requested` let the main loop get cancelled from inside its own function:
+// the data is then freed after the function returns.
+struct DirectMainLoop<F, T> {
+    func: F,
+    arg: T,
+    running: Cell<bool>,
+    release_requested: Cell<bool>,
+}
+
+// The pointer to the `DirectMainLoop` of the calling thread, together with the function that frees it, which knows its concrete type.
+// It's only accessed when setting and cancelling the main loop, not on every frame.
+thread_local! {
+    static DIRECT_MAIN_LOOP: Cell<Option<(*mut c_void, unsafe fn(*mut c_void))>> = Cell::new(None);
+}
+
+/// Sets the given function as the main loop of the calling thread, like [`set_main_loop_with_arg`], but with a cheaper per-frame dispatch.
+///
+/// The function and `arg` are boxed together once, and the raw pointer to them is passed to the emscripten-defined [`emscripten_set_main_loop_arg`]
+/// along with a trampoline function specialized for their types.
+/// That way, each frame is a direct call, without the thread-local lookup and `RefCell` borrow check of [`set_main_loop_with_arg`].
+///
+/// Because of that, the per-tick hooks of [`set_main_loop_with_arg`] (like flushing the [`BufferedLogger`], or freeing the frame arena) aren't run;
+/// call them yourself from `func` if you need them.
+///
+/// The main loop can be cancelled using the [`cancel_main_loop`] function, including from inside `func`.
+///
+/// [`emscripten_set_main_loop_arg`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_set_main_loop_arg
+/// [`BufferedLogger`]: crate::console::BufferedLogger
+///
+/// # Arguments
+/// * `func` - The function to be set as main event loop for the calling thread.
+/// * `arg` - The variable that represents the state that the main event loop ought to interact with.
+///   It will be consumed so that it can be kept alive during the loop.
+/// * `fps` - The number of calls of the function per second.
+///   If set to a value <= 0, the browser's [`requestAnimationFrame()`] function will be used instead of a fixed rate.
+/// * `simulate_infinite_loop` - If `true`, no code after the function call will be executed, otherwise the code after the function call will be executed.
+///
+/// [`requestAnimationFrame()`]: https://developer.mozilla.org/en-US/docs/Web/API/window/requestAnimationFrame
+///
+/// # Examples
+/// ```rust
+/// set_main_loop_with_arg_direct(|frames| {
+///     *frames += 1;
+///     println!("Frame {}", frames);
+/// }, 0u64, 0, true);
+/// ```
+pub fn set_main_loop_with_arg_direct<F, T>(
+    func: F,
+    arg: T,
+    fps: c_int,
+    simulate_infinite_loop: bool,
+) where
+    F: 'static + FnMut(&mut T),
+    T: 'static,
+{
+    unsafe extern "C" fn trampoline<F, T>(data: *mut c_void)
+    where
+        F: FnMut(&mut T),
+    {
+        let data = data as *mut DirectMainLoop<F, T>;
+
+        (*data).running.set(true);
+        ((*data).func)(&mut (*data).arg);
+        (*data).running.set(false);
+
+        if (*data).release_requested.get() {
+            drop(Box::from_raw(data));
+        }
+    }
+
+    unsafe fn release<F, T>(data: *mut c_void) {
+        let data = data as *mut DirectMainLoop<F, T>;
+
+        if (*data).running.get() {
+            (*data).release_requested.set(true);
+        } else {
+            drop(Box::from_raw(data));
+        }
+    }
+
+    // The previous main loop's function and state are freed, whichever setter it was set with.
+    release_direct_main_loop();
+    release_main_loop_function();
+    // A replacement queued for a main loop set with `set_main_loop_with_arg` would otherwise take over the next one.
+    NEXT_MAIN_LOOP_FUNCTION.with(|next| next.take());
+
+    let data = Box::into_raw(Box::new(DirectMainLoop {
+        func,
+        arg,
+        running: Cell::new(false),
+        release_requested: Cell::new(false),
+    })) as *mut c_void;
+    DIRECT_MAIN_LOOP.with(|slot| slot.set(Some((data, release::<F, T>))));
+
+    unsafe {
+        emscripten::emscripten_set_main_loop_arg(
+            Some(trampoline::<F, T>),
+            data,
+            fps,
+            simulate_infinite_loop as c_int,
+        )
+    };
+}
+
+// Frees the data of the calling thread's main loop set with `set_main_loop_with_arg_direct`, if any.
+fn release_direct_main_loop() {
+    if let Some((data, release)) = DIRECT_MAIN_LOOP.with(|slot| slot.take()) {
+        unsafe { release(data) };
+    }
+}
+
+// Frees the function of the calling thread's main loop set with `set_main_loop_with_arg`, and its state arg, if any.
+// If this is called from inside the function, it's freed once it returns.
+fn release_main_loop_function() {
+    MAIN_LOOP_FUNCTION.with(|func_ref| match func_ref.try_borrow_mut() {
+        Ok(mut func) => *func = None,
+        Err(_) => MAIN_LOOP_CANCELLED.with(|cancelled| cancelled.set(true)),
+    });
+}
+
+/// Cancels the main loop of the calling thread that was set using [`set_main_loop_with_arg`], [`set_main_loop`] or [`set_main_loop_with_arg_direct`].
 pub fn cancel_main_loop() {
     unsafe {
         emscripten::emscripten_cancel_main_loop();
     }
 
     // Also let's not forget to free up the main loop function and its state arg.
-    MAIN_LOOP_FUNCTION.with(|func_ref| {
-        *func_ref.borrow_mut() = None;
-    });
+    release_main_loop_function();
+    NEXT_MAIN_LOOP_FUNCTION.with(|next| next.take());
+    release_direct_main_loop();
 }
 
 /// Pauses the main loop of the calling thread.
@@ -147,6 +352,100 @@ pub fn resume_main_loop() {
     }
 }
 
+fn push_blocker<F>(name: &str, func: F, counted: bool)
+where
+    F: 'static + FnOnce(),
+{
+    unsafe extern "C" fn wrapper<F>(arg: *mut c_void)
+    where
+        F: 'static + FnOnce(),
+    {
+        let func = Box::from_raw(arg as *mut F);
+        func();
+    }
+
+    let arg = Box::into_raw(Box::new(func)) as *mut c_void;
+    with_c_str(name, |name| unsafe {
+        if counted {
+            emscripten::_emscripten_push_main_loop_blocker(Some(wrapper::<F>), arg, name);
+        } else {
+            emscripten::_emscripten_push_uncounted_main_loop_blocker(Some(wrapper::<F>), arg, name);
+        }
+    });
+}
+
+/// Queues a function to run once before the next iterations of the main loop, using the emscripten-defined `_emscripten_push_main_loop_blocker`.
+///
+/// While blockers are queued, the main loop runs one of them per iteration instead of its own function (so no frame is drawn).
+/// Each counted blocker that ran advances the progress given to `Module.setStatus`, out of the count set with [`set_main_loop_expected_blockers`].
+///
+/// # Arguments
+/// * `name` - The name of the blocker, for debugging.
+/// * `func` - The function to run.
+///
+/// # Examples
+/// ```rust
+/// set_main_loop_expected_blockers(textures.len() as c_int);
+/// for texture in textures {
+///     // One texture is uploaded per iteration, and the status shows "Please wait... (3/8)".
+///     push_main_loop_blocker("upload texture", move || upload(texture));
+/// }
+/// ```
+pub fn push_main_loop_blocker<F>(name: &str, func: F)
+where
+    F: 'static + FnOnce(),
+{
+    push_blocker(name, func, true);
+}
+
+/// Like [`push_main_loop_blocker`], but the blocker doesn't count towards the progress given to `Module.setStatus`,
+/// using the emscripten-defined `_emscripten_push_uncounted_main_loop_blocker`.
+pub fn push_uncounted_main_loop_blocker<F>(name: &str, func: F)
+where
+    F: 'static + FnOnce(),
+{
+    push_blocker(name, func, false);
+}
+
+/// Sets the number of counted blockers the progress given to `Module.setStatus` is measured against,
+/// using the emscripten-defined [`emscripten_set_main_loop_expected_blockers`].
+///
+/// [`emscripten_set_main_loop_expected_blockers`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_set_main_loop_expected_blockers
+pub fn set_main_loop_expected_blockers(num: c_int) {
+    unsafe {
+        emscripten::emscripten_set_main_loop_expected_blockers(num);
+    }
+}
+
+/// Holds the main loop's function until `ready` returns `true`, using an uncounted main loop blocker that queues itself again.
+///
+/// While held, the main loop only calls `ready` once per iteration of its runner, and draws no frames.
+///
+/// # Examples
+/// ```rust
+/// let loaded = Rc::new(Cell::new(false));
+/// let check = loaded.clone();
+/// hold_main_loop_until("critical assets", move || check.get());
+/// ```
+pub fn hold_main_loop_until<F>(name: &str, ready: F)
+where
+    F: 'static + FnMut() -> bool,
+{
+    fn hold<F>(name: String, mut ready: F)
+    where
+        F: 'static + FnMut() -> bool,
+    {
+        let blocker_name = name.clone();
+        push_uncounted_main_loop_blocker(&blocker_name, move || {
+            if !ready() {
+                hold(name, ready);
+            }
+        });
+    }
+
+    hold(name.to_string(), ready);
+}
+
 /// Parameters of the main loop's scheduling mode.
 ///
 /// While emscripten implements this using 2 `int` variables: `mode` and `value`; we put here only the valid modes.
@@ -274,6 +573,59 @@ pub fn exit_with_live_runtime() {
     }
 }
 
+/// A guard that keeps the runtime alive while it exists, using the emscripten-defined [`emscripten_runtime_keepalive_push`] and [`emscripten_runtime_keepalive_pop`].
+///
+/// Once the main function returned, a program built with `-sEXIT_RUNTIME` exits as soon as no guard is left (and, in the same way, no emscripten-internal work keeps it alive).
+/// Unlike [`exit_with_live_runtime`], this lets a program exit and release its memory once its asynchronous work is done.
+/// The [`timers`](crate::timers), [`fetch`](crate::fetch) and [`worker`](crate::worker) modules take guards automatically while their work is in flight.
+///
+/// [`emscripten_runtime_keepalive_push`]: https://emscripten.org/docs/api_reference/eventloop.h.html#c.emscripten_runtime_keepalive_push
+/// [`emscripten_runtime_keepalive_pop`]: https://emscripten.org/docs/api_reference/eventloop.h.html#c.emscripten_runtime_keepalive_pop
+///
+/// # Examples
+/// ```rust
+/// let keepalive = KeepAlive::new();
+/// store.store("results", results, move |_| {
+///     // The program can exit once the results are saved.
+///     drop(keepalive);
+/// });
+/// ```
+#[derive(Debug)]
+pub struct KeepAlive {
+    _private: (),
+}
+
+impl KeepAlive {
+    /// Keeps the runtime alive until the returned guard is dropped.
+    pub fn new() -> Self {
+        unsafe {
+            html5::emscripten_runtime_keepalive_push();
+        }
+        Self { _private: () }
+    }
+}
+
+impl Default for KeepAlive {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl Drop for KeepAlive {
+    fn drop(&mut self) {
+        unsafe {
+            html5::emscripten_runtime_keepalive_pop();
+        }
+    }
+}
+
+/// Returns `true` if something keeps the runtime alive, using the emscripten-defined [`emscripten_runtime_keepalive_check`].
+///
+/// [`emscripten_runtime_keepalive_check`]: https://emscripten.org/docs/api_reference/eventloop.h.html#c.emscripten_runtime_keepalive_check
+pub fn runtime_keepalive_check() -> bool {
+    unsafe { html5::emscripten_runtime_keepalive_check() != 0 }
+}
+
 /// Exits the program and kills the runtime, using [`emscripten_force_exit`].
 /// Like libc's [`exit`], but works even if [`exit_with_live_runtime`] was run.
 ///
@@ -326,8 +678,7 @@ pub fn get_device_pixel_ratio() -> f64 {
 pub fn get_window_title() -> String {
     let title = unsafe { emscripten::emscripten_get_window_title() };
 
-    let title_cstr = unsafe { CStr::from_ptr(title) };
-    title_cstr.to_str().unwrap().to_string()
+    unsafe { returned_string(title) }
 }
 
 /// Sets the window title, using the emscripten-defined [`emscripten_set_window_title`].
@@ -445,6 +796,8 @@ pub fn get_now() -> f64 {
 
 /// Returns a random number in range [0,1), with [`Math.random()`], using the emscripten-defined [`emscripten_random`].
 ///
+/// Each call crosses into JS: code drawing many numbers should use the generator of the [`rng`](crate::rng) module instead.
+///
 /// [`Math.random()`]: https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Math/random
 /// [`emscripten_random`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_random
 ///
@@ -457,11 +810,62 @@ pub fn random() -> f32 {
     unsafe { emscripten::emscripten_random() }
 }
 
+/// Returns `true` if the program was built with Asyncify (`-sASYNCIFY`), which the blocking functions like [`sleep`] need on the main browser thread,
+/// using the emscripten-defined `emscripten_has_asyncify`. The result is cached after the first call,
+/// and known at compile time when `-sASYNCIFY` is among the link arguments of the rust flags (see [`compiler_settings`](crate::compiler_settings)).
+pub fn has_asyncify() -> bool {
+    if cfg!(emscripten_asyncify) {
+        return true;
+    }
+    static HAS_ASYNCIFY: OnceLock<bool> = OnceLock::new();
+    *HAS_ASYNCIFY.get_or_init(|| unsafe { emscripten::emscripten_has_asyncify() != 0 })
+}
+
+/// The error returned by the blocking functions that need Asyncify, when the program wasn't built with it.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct AsyncifyUnavailable;
+impl Display for AsyncifyUnavailable {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        write!(f, "The program wasn't built with Asyncify")
+    }
+}
+
+/// Blocks the calling thread for the given number of milliseconds, letting the browser run its event loop meanwhile.
+///
+/// With Asyncify, it uses the emscripten-defined [`emscripten_sleep`], which unwinds the stack back to the browser and resumes it after the delay.
+/// Without it, off the main browser thread, it falls back to the blocking [`thread_sleep`];
+/// on the main browser thread, where blocking isn't allowed, it returns an error instead.
+///
+/// [`emscripten_sleep`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_sleep
+/// [`thread_sleep`]: crate::threading::thread_sleep
+///
+/// # Examples
+/// ```rust
+/// // Lets the loading screen repaint between the steps.
+/// for step in loading_steps {
+///     step.run();
+///     sleep(0).unwrap();
+/// }
+/// ```
+pub fn sleep(milliseconds: u32) -> Result<(), AsyncifyUnavailable> {
+    if has_asyncify() {
+        unsafe { emscripten::emscripten_sleep(milliseconds) };
+        Ok(())
+    } else if !crate::threading::is_main_browser_thread() {
+        crate::threading::thread_sleep(milliseconds as f64);
+        Ok(())
+    } else {
+        Err(AsyncifyUnavailable)
+    }
+}
+
 /// Runs the given JavaScript script string with the [`eval()`] JS function, in the calling thread,
 /// using the emscripten-defined [`emscripten_run_script`].
 ///
 /// If you need to run the script in the main thread, check out [`run_script_main_thread`].
+/// If you run the same script many times, check out [`Script`], which doesn't parse it again on every call.
 ///
+/// [`Script`]: crate::script::Script
 /// [`eval()`]: https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/eval
 /// [`emscripten_run_script`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_run_script
 ///
@@ -486,8 +890,27 @@ pub fn run_script<T>(script: T)
 where
     T: AsRef<str>,
 {
-    let script_cstring = CString::new(script.as_ref()).unwrap();
-    unsafe { emscripten::emscripten_run_script(script_cstring.as_ptr()) }
+    with_c_str(script.as_ref(), |script| unsafe {
+        emscripten::emscripten_run_script(script)
+    })
+}
+
+/// Runs the given JavaScript script string with the [`eval()`] JS function, in the calling thread, after the given delay,
+/// using the emscripten-defined [`emscripten_async_run_script`].
+///
+/// [`eval()`]: https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/eval
+/// [`emscripten_async_run_script`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_async_run_script
+///
+/// # Arguments
+/// * `script` - The script to execute.
+/// * `millis` - The delay in milliseconds.
+pub fn run_script_async<T>(script: T, millis: c_int)
+where
+    T: AsRef<str>,
+{
+    with_c_str(script.as_ref(), |script| unsafe {
+        emscripten::emscripten_async_run_script(script, millis)
+    })
 }
 
 /// Runs the given JavaScript script string with the [`eval()`] JS function, in the calling thread,
@@ -512,14 +935,16 @@ pub fn run_script_int<T>(script: T) -> c_int
 where
     T: AsRef<str>,
 {
-    let script_cstring = CString::new(script.as_ref()).unwrap();
-    unsafe { emscripten::emscripten_run_script_int(script_cstring.as_ptr()) }
+    with_c_str(script.as_ref(), |script| unsafe {
+        emscripten::emscripten_run_script_int(script)
+    })
 }
 
 /// Runs the given JavaScript script string with the [`eval()`] JS function, in the calling thread,
 /// using the emscripten-defined [`emscripten_run_script_string`].
 /// It returns the return result of the script, interpreted as a string if possible.
 /// Otherwise, it returns None.
+/// Invalid UTF-8 in the result, like lone surrogates of the JS string, is replaced with U+FFFD.
 ///
 /// [`eval()`]: https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/eval
 /// [`emscripten_run_script_string`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_run_script_string
@@ -537,28 +962,94 @@ pub fn run_script_string<T>(script: T) -> Option<String>
 where
     T: AsRef<str>,
 {
-    let script_cstring = CString::new(script.as_ref()).unwrap();
-    let result = unsafe { emscripten::emscripten_run_script_string(script_cstring.as_ptr()) };
+    let result = with_c_str(script.as_ref(), |script| unsafe {
+        emscripten::emscripten_run_script_string(script)
+    });
 
     if result.is_null() {
         return None;
     }
 
-    let result_cstr = unsafe { CStr::from_ptr(result) };
-    Some(result_cstr.to_str().unwrap().to_string())
+    Some(unsafe { returned_string(result) })
+}
+
+/// Runs the given JavaScript script string like [`run_script_string`], and calls `func` with its result borrowed from emscripten's result buffer,
+/// without copying it. `func` gets `None` if the result isn't a string.
+///
+/// The result is only valid until the next `run_script_string` call, which reuses the buffer, so it can't be kept.
+///
+/// # Examples
+/// ```rust
+/// let hovered = run_script_string_with("window.hoveredId", |id| id == Some("play-button"));
+/// ```
+pub fn run_script_string_with<T, F, R>(script: T, func: F) -> R
+where
+    T: AsRef<str>,
+    F: FnOnce(Option<&str>) -> R,
+{
+    let result = with_c_str(script.as_ref(), |script| unsafe {
+        emscripten::emscripten_run_script_string(script)
+    });
+
+    if result.is_null() {
+        return func(None);
+    }
+    unsafe { with_returned_str(result, |result| func(Some(result))) }
+}
+
+/// Runs the given JavaScript script string like [`run_script_string`], writing its result into `buffer` instead of a new `String`,
+/// so that polling a value every frame reuses the buffer's capacity.
+/// Binary results, like typed arrays, are better taken with [`run_script_bytes`](crate::script::run_script_bytes),
+/// which copies them without encoding them into a string.
+/// It returns `false`, leaving `buffer` empty, if the result isn't a string.
+///
+/// # Examples
+/// ```rust
+/// let mut state = String::new();
+/// set_main_loop(move || {
+///     if run_script_string_into("JSON.stringify(uiState)", &mut state) {
+///         apply_ui_state(&state);
+///     }
+/// }, 0, true);
+/// ```
+pub fn run_script_string_into<T>(script: T, buffer: &mut String) -> bool
+where
+    T: AsRef<str>,
+{
+    buffer.clear();
+    run_script_string_with(script, |result| match result {
+        Some(result) => {
+            buffer.push_str(result);
+            true
+        }
+        None => false,
+    })
 }
 
 // The functions defined in `asm_in_main_thread.c`.
+#[cfg(feature = "main_thread_script")]
 extern "C" {
     fn asm_in_main_thread(script: *const c_char);
     fn asm_in_main_thread_int(script: *const c_char) -> c_int;
     fn asm_in_main_thread_double(script: *const c_char) -> c_double;
+    fn asm_in_main_thread_async(script: *const c_char, len: usize) -> c_int;
+    fn asm_in_main_thread_args_int(
+        script: *const c_char,
+        args: *const c_double,
+        count: c_int,
+    ) -> c_int;
+    fn asm_in_main_thread_args_double(
+        script: *const c_char,
+        args: *const c_double,
+        count: c_int,
+    ) -> c_double;
 }
 
 /// Runs the given JavaScript script string with the [`eval()`] JS function, in the main thread,
 /// using the emscripten-defined [`MAIN_THREAD_EM_ASM`].
 ///
 /// If you need to run the script in the calling thread, check out [`run_script`].
+/// To run rust code on the main thread instead, see [`run_on_main_thread`](crate::proxying::run_on_main_thread).
 ///
 /// [`eval()`]: https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/eval
 /// [`MAIN_THREAD_EM_ASM`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.MAIN_THREAD_EM_ASM
@@ -580,12 +1071,58 @@ extern "C" {
 ///     )
 /// );
 /// ```
+#[cfg(feature = "main_thread_script")]
 pub fn run_script_main_thread<T>(script: T)
 where
     T: AsRef<str>,
 {
-    let script_cstring = CString::new(script.as_ref()).unwrap();
-    unsafe { asm_in_main_thread(script_cstring.as_ptr()) }
+    with_c_str(script.as_ref(), |script| unsafe {
+        asm_in_main_thread(script)
+    })
+}
+
+/// Queues the given JavaScript script string to be run with the [`eval()`] JS function in the main thread, without waiting for it to run.
+/// Unlike [`run_script_main_thread`], the calling thread isn't blocked until the main thread runs the script,
+/// which makes it a better fit for side-effect-only scripts (DOM updates, analytics pings) run from worker threads.
+///
+/// If called from the main thread, the script is run immediately.
+/// The scripts queued by a thread are run in the order they were queued.
+///
+/// The script is copied into a C string whose ownership is passed to the main thread, which frees it after running the script.
+/// If the script contains a NUL character, it is cut there.
+/// If the copy couldn't be allocated, the script isn't run, and an error is returned.
+///
+/// [`eval()`]: https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/eval
+///
+/// # Arguments
+/// * `script` - The script to execute.
+///
+/// # Examples
+/// ```rust
+/// run_script_main_thread_async("document.title = 'Loaded'").unwrap();
+/// // This line can run before the title gets changed.
+/// ```
+#[cfg(feature = "main_thread_script")]
+pub fn run_script_main_thread_async<T>(script: T) -> Result<(), ScriptCopyFailed>
+where
+    T: AsRef<str>,
+{
+    let script = script.as_ref();
+    match unsafe { asm_in_main_thread_async(script.as_ptr() as *const c_char, script.len()) } {
+        0 => Ok(()),
+        _ => Err(ScriptCopyFailed),
+    }
+}
+
+/// The error returned by [`run_script_main_thread_async`] when the copy of the script passed to the main thread couldn't be allocated.
+#[cfg(feature = "main_thread_script")]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct ScriptCopyFailed;
+#[cfg(feature = "main_thread_script")]
+impl Display for ScriptCopyFailed {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        write!(f, "Failed to allocate the copy of the script")
+    }
 }
 
 /// Runs the given JavaScript script string with the [`eval()`] JS function, in the main thread,
@@ -606,12 +1143,14 @@ where
 /// ```rust
 /// assert_eq!(run_script_main_thread_int("1 + 2"), 3);
 /// ```
+#[cfg(feature = "main_thread_script")]
 pub fn run_script_main_thread_int<T>(script: T) -> c_int
 where
     T: AsRef<str>,
 {
-    let script_cstring = CString::new(script.as_ref()).unwrap();
-    unsafe { asm_in_main_thread_int(script_cstring.as_ptr()) }
+    with_c_str(script.as_ref(), |script| unsafe {
+        asm_in_main_thread_int(script)
+    })
 }
 
 /// Runs the given JavaScript script string with the [`eval()`] JS function, in the main thread,
@@ -628,10 +1167,88 @@ where
 /// ```rust
 /// assert_eq!(run_script_main_thread_double("1.1 + 2.1"), 3.2);
 /// ```
+#[cfg(feature = "main_thread_script")]
 pub fn run_script_main_thread_double<T>(script: T) -> c_double
 where
     T: AsRef<str>,
 {
-    let script_cstring = CString::new(script.as_ref()).unwrap();
-    unsafe { asm_in_main_thread_double(script_cstring.as_ptr()) }
+    with_c_str(script.as_ref(), |script| unsafe {
+        asm_in_main_thread_double(script)
+    })
+}
+
+/// Runs the given fixed JavaScript snippet in the main thread, passing it the given numeric arguments, using the emscripten-defined [`MAIN_THREAD_EM_ASM_INT`].
+///
+/// Unlike with [`run_script_main_thread`], the data doesn't need to be formatted into the script:
+/// the snippet is compiled only once (on its first run) into a JS function whose parameters are named `$0`, `$1`, ... `$15`,
+/// and then called with the arguments.
+/// As the snippet is the body of a function, use `return` to give a result.
+///
+/// The compiled functions are cached by the address of their source, that's why it must be `'static`.
+///
+/// [`MAIN_THREAD_EM_ASM_INT`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.MAIN_THREAD_EM_ASM_INT
+///
+/// # Arguments
+/// * `script` - The snippet to execute.
+/// * `args` - The arguments, available in the snippet as `$0`, `$1`, ... It can have at most [`MAX_SCRIPT_ARGS`] elements.
+///   Integers and pointers can be passed by casting them to `f64`, which represents them exactly.
+///
+/// [`MAX_SCRIPT_ARGS`]: crate::script::MAX_SCRIPT_ARGS
+///
+/// # Examples
+/// ```rust
+/// run_script_main_thread_with_args(
+///     c"document.querySelector('progress').value = $0 / $1;",
+///     &[3.0, 4.0],
+/// );
+/// ```
+#[cfg(feature = "main_thread_script")]
+pub fn run_script_main_thread_with_args(script: &'static CStr, args: &[f64]) {
+    run_script_main_thread_int_with_args(script, args);
+}
+
+/// Runs the given fixed JavaScript snippet in the main thread, passing it the given numeric arguments, using the emscripten-defined [`MAIN_THREAD_EM_ASM_INT`].
+/// It returns the return value of the snippet, converted to a C int, with NaN and `undefined` represented as 0.
+///
+/// The snippet is compiled only once, like with [`run_script_main_thread_with_args`].
+///
+/// [`MAIN_THREAD_EM_ASM_INT`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.MAIN_THREAD_EM_ASM_INT
+///
+/// # Arguments
+/// * `script` - The snippet to execute.
+/// * `args` - The arguments, available in the snippet as `$0`, `$1`, ... It can have at most [`MAX_SCRIPT_ARGS`] elements.
+///
+/// [`MAX_SCRIPT_ARGS`]: crate::script::MAX_SCRIPT_ARGS
+///
+/// # Examples
+/// ```rust
+/// assert_eq!(run_script_main_thread_int_with_args(c"return $0 + $1;", &[1.0, 2.0]), 3);
+/// ```
+#[cfg(feature = "main_thread_script")]
+pub fn run_script_main_thread_int_with_args(script: &'static CStr, args: &[f64]) -> c_int {
+    check_args(args);
+    unsafe { asm_in_main_thread_args_int(script.as_ptr(), args.as_ptr(), args.len() as c_int) }
+}
+
+/// Runs the given fixed JavaScript snippet in the main thread, passing it the given numeric arguments, using the emscripten-defined [`MAIN_THREAD_EM_ASM_DOUBLE`].
+/// It returns the return value of the snippet, converted to a C double.
+///
+/// The snippet is compiled only once, like with [`run_script_main_thread_with_args`].
+///
+/// [`MAIN_THREAD_EM_ASM_DOUBLE`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.MAIN_THREAD_EM_ASM_DOUBLE
+///
+/// # Arguments
+/// * `script` - The snippet to execute.
+/// * `args` - The arguments, available in the snippet as `$0`, `$1`, ... It can have at most [`MAX_SCRIPT_ARGS`] elements.
+///
+/// [`MAX_SCRIPT_ARGS`]: crate::script::MAX_SCRIPT_ARGS
+///
+/// # Examples
+/// ```rust
+/// assert_eq!(run_script_main_thread_double_with_args(c"return $0 * $1;", &[1.5, 2.0]), 3.0);
+/// ```
+#[cfg(feature = "main_thread_script")]
+pub fn run_script_main_thread_double_with_args(script: &'static CStr, args: &[f64]) -> c_double {
+    check_args(args);
+    unsafe { asm_in_main_thread_args_double(script.as_ptr(), args.as_ptr(), args.len() as c_int) }
 }
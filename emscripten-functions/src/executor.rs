@@ -0,0 +1,395 @@
+//! A single-threaded executor of rust futures, driven by the browser's event loop, and futures adapting this crate's callback-based APIs.
+//!
+//! Futures spawned with [`spawn_local`] are polled when woken. The wakeups are batched:
+//! all the tasks woken during an event loop turn are polled together in one later turn,
+//! scheduled with [`emscripten_set_immediate`] or [`emscripten_request_animation_frame`], depending on the [`WakeMode`].
+//!
+//! [`emscripten_set_immediate`]: https://emscripten.org/docs/api_reference/eventloop.h.html#c.emscripten_set_immediate
+//! [`emscripten_request_animation_frame`]: https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_request_animation_frame
+
+use std::{
+    cell::{Cell, RefCell},
+    collections::{HashMap, VecDeque},
+    fmt::Display,
+    future::Future,
+    os::raw::{c_int, c_void},
+    pin::Pin,
+    rc::Rc,
+    sync::{
+        atomic::{AtomicBool, Ordering},
+        Arc, Mutex,
+    },
+    task::{Context, Poll, Wake, Waker},
+};
+
+use emscripten_functions_sys::html5;
+
+#[cfg(feature = "idb")]
+use crate::idb::{IdbError, Store};
+use crate::{
+    malloc_buffer::MallocBuffer,
+    timers::{set_timeout, TimerHandle},
+    wget::{get_shared, WgetError, WgetRequest},
+};
+
+/// How the executor schedules the polling of woken tasks.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum WakeMode {
+    /// As soon as possible after the current event loop turn, with `setImmediate`. The default.
+    Immediate,
+    /// Before the next repaint, with `requestAnimationFrame`, so that the polled tasks can render.
+    AnimationFrame,
+}
+
+type LocalTask = Pin<Box<dyn Future<Output = ()>>>;
+
+// The ids of the woken tasks, shared with their wakers.
+type ReadyQueue = Arc<Mutex<VecDeque<usize>>>;
+
+struct TaskWaker {
+    id: usize,
+    queued: AtomicBool,
+    ready: ReadyQueue,
+}
+
+impl Wake for TaskWaker {
+    fn wake(self: Arc<Self>) {
+        self.wake_by_ref();
+    }
+
+    fn wake_by_ref(self: &Arc<Self>) {
+        if !self.queued.swap(true, Ordering::AcqRel) {
+            self.ready.lock().unwrap().push_back(self.id);
+            // Wakers woken on another thread only queue their task; it's polled at the executor's next turn.
+            let _ = EXECUTOR.try_with(|executor| {
+                if Arc::ptr_eq(&executor.ready, &self.ready) {
+                    schedule_turn(executor);
+                }
+            });
+        }
+    }
+}
+
+struct Executor {
+    tasks: RefCell<HashMap<usize, (LocalTask, Arc<TaskWaker>)>>,
+    next_id: Cell<usize>,
+    ready: ReadyQueue,
+    turn_scheduled: Cell<bool>,
+    wake_mode: Cell<WakeMode>,
+}
+
+thread_local! {
+    static EXECUTOR: Executor = Executor {
+        tasks: RefCell::new(HashMap::new()),
+        next_id: Cell::new(0),
+        ready: Arc::new(Mutex::new(VecDeque::new())),
+        turn_scheduled: Cell::new(false),
+        wake_mode: Cell::new(WakeMode::Immediate),
+    };
+}
+
+fn schedule_turn(executor: &Executor) {
+    if executor.turn_scheduled.replace(true) {
+        return;
+    }
+
+    unsafe {
+        match executor.wake_mode.get() {
+            WakeMode::Immediate => {
+                html5::emscripten_set_immediate(Some(immediate_turn), std::ptr::null_mut());
+            }
+            WakeMode::AnimationFrame => {
+                html5::emscripten_request_animation_frame(
+                    Some(animation_frame_turn),
+                    std::ptr::null_mut(),
+                );
+            }
+        }
+    }
+}
+
+unsafe extern "C" fn immediate_turn(_user_data: *mut c_void) {
+    run_turn();
+}
+
+unsafe extern "C" fn animation_frame_turn(_time: f64, _user_data: *mut c_void) -> c_int {
+    run_turn();
+    html5::EM_FALSE as c_int
+}
+
+// Polls the tasks that were woken before the turn started; the ones woken during the turn are polled in the next one.
+fn run_turn() {
+    let ready: Vec<usize> = EXECUTOR.with(|executor| {
+        executor.turn_scheduled.set(false);
+        executor.ready.lock().unwrap().drain(..).collect()
+    });
+
+    for id in ready {
+        // The task is taken out while it's polled, so that it can spawn other tasks.
+        let task = EXECUTOR.with(|executor| executor.tasks.borrow_mut().remove(&id));
+        let Some((mut future, waker_data)) = task else {
+            continue;
+        };
+        waker_data.queued.store(false, Ordering::Release);
+
+        let waker = Waker::from(waker_data.clone());
+        let mut context = Context::from_waker(&waker);
+        if future.as_mut().poll(&mut context).is_pending() {
+            EXECUTOR.with(|executor| executor.tasks.borrow_mut().insert(id, (future, waker_data)));
+        }
+    }
+}
+
+/// Spawns a future on the calling thread's executor. It's first polled in the next executor turn.
+///
+/// The future must be woken on the calling thread to be polled right away; if it's woken on other threads,
+/// it's polled in the executor's next turn that happens for another reason.
+///
+/// # Examples
+/// ```rust
+/// spawn_local(async {
+///     sleep(1000.0).await;
+///     match wget("config.json").await {
+///         Ok(data) => println!("Got {} bytes", data.len()),
+///         Err(err) => println!("{}", err),
+///     }
+/// });
+/// ```
+pub fn spawn_local<F>(future: F)
+where
+    F: 'static + Future<Output = ()>,
+{
+    EXECUTOR.with(|executor| {
+        let id = executor.next_id.get();
+        executor.next_id.set(id + 1);
+
+        let waker = Arc::new(TaskWaker {
+            id,
+            queued: AtomicBool::new(false),
+            ready: executor.ready.clone(),
+        });
+        executor
+            .tasks
+            .borrow_mut()
+            .insert(id, (Box::pin(future), waker.clone()));
+        waker.wake();
+    });
+}
+
+/// Sets how the calling thread's executor schedules the polling of woken tasks. It applies from the next scheduled turn.
+pub fn set_wake_mode(mode: WakeMode) {
+    EXECUTOR.with(|executor| executor.wake_mode.set(mode));
+}
+
+/// Returns the number of tasks of the calling thread's executor that haven't completed yet.
+pub fn pending_tasks() -> usize {
+    EXECUTOR.with(|executor| executor.tasks.borrow().len())
+}
+
+struct CallbackState<T> {
+    value: Option<T>,
+    waker: Option<Waker>,
+}
+
+/// A future that completes with the value passed to a callback. It's created with [`callback_future`].
+pub struct CallbackFuture<T> {
+    state: Rc<RefCell<CallbackState<T>>>,
+}
+
+impl<T> Future for CallbackFuture<T> {
+    type Output = T;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<T> {
+        let mut state = self.state.borrow_mut();
+        match state.value.take() {
+            Some(value) => Poll::Ready(value),
+            None => {
+                state.waker = Some(cx.waker().clone());
+                Poll::Pending
+            }
+        }
+    }
+}
+
+/// Adapts a callback-based API into a future: `start` is called right away with the callback that completes the future.
+///
+/// If the callback is never called, the future never completes.
+///
+/// # Examples
+/// ```rust
+/// let exists = callback_future(|callback| Store::new("saves").exists("slot1", callback)).await;
+/// ```
+pub fn callback_future<T, F>(start: F) -> CallbackFuture<T>
+where
+    T: 'static,
+    F: FnOnce(Box<dyn FnOnce(T)>),
+{
+    let state = Rc::new(RefCell::new(CallbackState {
+        value: None,
+        waker: None,
+    }));
+
+    let callback_state = state.clone();
+    start(Box::new(move |value| {
+        let waker = {
+            let mut state = callback_state.borrow_mut();
+            state.value = Some(value);
+            state.waker.take()
+        };
+        if let Some(waker) = waker {
+            waker.wake();
+        }
+    }));
+
+    CallbackFuture { state }
+}
+
+/// A future that completes after a delay, created with [`sleep`]. Dropping it cancels its timer.
+pub struct Sleep {
+    inner: CallbackFuture<()>,
+    timer: TimerHandle,
+}
+
+impl Future for Sleep {
+    type Output = ();
+
+    fn poll(mut self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<()> {
+        Pin::new(&mut self.inner).poll(cx)
+    }
+}
+
+impl Drop for Sleep {
+    fn drop(&mut self) {
+        self.timer.cancel();
+    }
+}
+
+/// Returns a future that completes after the given delay, in milliseconds, using the [`timers`](crate::timers) module.
+pub fn sleep(delay: f64) -> Sleep {
+    let mut timer = None;
+    let inner = callback_future(|callback| {
+        timer = Some(set_timeout(move || callback(()), delay));
+    });
+
+    Sleep {
+        inner,
+        timer: timer.unwrap(),
+    }
+}
+
+/// The error of a future wrapped with [`timeout`] that didn't complete in time.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct TimedOut;
+impl Display for TimedOut {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        write!(f, "The operation timed out")
+    }
+}
+
+/// A future that completes with its inner future's output, or with [`TimedOut`] after a delay. It's created with [`timeout`].
+pub struct Timeout<F> {
+    future: Pin<Box<F>>,
+    sleep: Sleep,
+}
+
+impl<F> Future for Timeout<F>
+where
+    F: Future,
+{
+    type Output = Result<F::Output, TimedOut>;
+
+    fn poll(mut self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Self::Output> {
+        if let Poll::Ready(output) = self.future.as_mut().poll(cx) {
+            return Poll::Ready(Ok(output));
+        }
+        match Pin::new(&mut self.sleep).poll(cx) {
+            Poll::Ready(()) => Poll::Ready(Err(TimedOut)),
+            Poll::Pending => Poll::Pending,
+        }
+    }
+}
+
+/// Wraps a future so that it fails with [`TimedOut`] if it doesn't complete within the given delay, in milliseconds.
+///
+/// # Examples
+/// ```rust
+/// match timeout(wget("scores.json"), 5000.0).await {
+///     Ok(Ok(data)) => println!("Got {} bytes", data.len()),
+///     Ok(Err(err)) => println!("{}", err),
+///     Err(TimedOut) => println!("The server is too slow"),
+/// }
+/// ```
+pub fn timeout<F>(future: F, delay: f64) -> Timeout<F>
+where
+    F: Future,
+{
+    Timeout {
+        future: Box::pin(future),
+        sleep: sleep(delay),
+    }
+}
+
+/// Downloads the given URL with a `GET` request, using the [`wget`](crate::wget) module.
+pub fn wget<T>(url: T) -> CallbackFuture<Result<MallocBuffer, WgetError>>
+where
+    T: Into<String>,
+{
+    callback_future(|callback| {
+        let callback = Rc::new(RefCell::new(Some(callback)));
+        let error_callback = callback.clone();
+
+        WgetRequest::new(url)
+            .on_load(move |data| {
+                if let Some(callback) = callback.take() {
+                    callback(Ok(data));
+                }
+            })
+            .on_error(move |err| {
+                if let Some(callback) = error_callback.take() {
+                    callback(Err(err));
+                }
+            })
+            .send();
+    })
+}
+
+/// Like [`wget`], but shares the download with the concurrent requests for the same URL, using [`get_shared`](crate::wget::get_shared).
+pub fn wget_shared<T>(url: T) -> CallbackFuture<Result<Rc<MallocBuffer>, WgetError>>
+where
+    T: Into<String>,
+{
+    callback_future(|callback| {
+        let callback = Rc::new(RefCell::new(Some(callback)));
+        let error_callback = callback.clone();
+
+        get_shared(
+            url,
+            move |data| {
+                if let Some(callback) = callback.take() {
+                    callback(Ok(data));
+                }
+            },
+            move |err| {
+                if let Some(callback) = error_callback.take() {
+                    callback(Err(err));
+                }
+            },
+        );
+    })
+}
+
+/// Loads the data stored under the given key of an IndexedDB [`Store`].
+#[cfg(feature = "idb")]
+pub fn idb_load(store: &Store, key: &str) -> CallbackFuture<Result<Vec<u8>, IdbError>> {
+    callback_future(|callback| store.load(key, callback))
+}
+
+/// Stores the given data under the given key of an IndexedDB [`Store`], completing once its batch is written.
+#[cfg(feature = "idb")]
+pub fn idb_store<T, D>(store: &Store, key: T, data: D) -> CallbackFuture<Result<(), IdbError>>
+where
+    T: Into<String>,
+    D: Into<Vec<u8>>,
+{
+    callback_future(|callback| store.store(key, data, callback))
+}
@@ -0,0 +1,379 @@
+//! Transcendental functions that run either on the browser's JS `Math`, with the emscripten `em_math.h` header file,
+//! or on the libm compiled to wasm, chosen per function.
+//!
+//! Each call to JS `Math` crosses the wasm/JS boundary, but the JIT's implementation can still beat the compiled libm
+//! for some functions on some engines. The functions of this module use the libm by default, as the rust `f64` methods do;
+//! [`set_backend`] moves a function to JS `Math`, and [`calibrate`] moves those that [`benchmark`] measures to be faster there,
+//! on the browser the program runs in. The results of the two backends can differ in their last bits.
+//!
+//! The functions with their own wasm instructions, like `sqrt`, `floor` or `abs`, are left out: the `f64` methods compile to them.
+
+use std::{
+    hint::black_box,
+    sync::atomic::{AtomicU32, Ordering},
+};
+
+use emscripten_functions_sys::em_math;
+
+use crate::emscripten::get_now;
+
+/// The implementation of a function, set by [`set_backend`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum Backend {
+    /// The libm compiled to wasm, which the rust `f64` methods call.
+    #[default]
+    Wasm,
+    /// The browser's JS `Math`, with the emscripten-defined `emscripten_math_*` functions.
+    Js,
+}
+
+/// A function of this module, whose [`Backend`] can be chosen, named after the `f64` method it matches.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum MathFunction {
+    Acos,
+    Acosh,
+    Asin,
+    Asinh,
+    Atan,
+    Atan2,
+    Atanh,
+    Cbrt,
+    Cos,
+    Cosh,
+    Exp,
+    ExpM1,
+    Hypot,
+    Ln,
+    Ln1p,
+    Log10,
+    Log2,
+    Pow,
+    Rem,
+    Sin,
+    Sinh,
+    Tan,
+    Tanh,
+}
+
+impl MathFunction {
+    /// All the functions.
+    pub const ALL: [MathFunction; 23] = [
+        MathFunction::Acos,
+        MathFunction::Acosh,
+        MathFunction::Asin,
+        MathFunction::Asinh,
+        MathFunction::Atan,
+        MathFunction::Atan2,
+        MathFunction::Atanh,
+        MathFunction::Cbrt,
+        MathFunction::Cos,
+        MathFunction::Cosh,
+        MathFunction::Exp,
+        MathFunction::ExpM1,
+        MathFunction::Hypot,
+        MathFunction::Ln,
+        MathFunction::Ln1p,
+        MathFunction::Log10,
+        MathFunction::Log2,
+        MathFunction::Pow,
+        MathFunction::Rem,
+        MathFunction::Sin,
+        MathFunction::Sinh,
+        MathFunction::Tan,
+        MathFunction::Tanh,
+    ];
+
+    fn bit(self) -> u32 {
+        1 << self as u32
+    }
+
+    // An input in the function's domain, spread over its interesting range by `t`, in [0, 1).
+    fn input(self, t: f64) -> f64 {
+        match self {
+            MathFunction::Acos | MathFunction::Asin | MathFunction::Atanh => t * 1.98 - 0.99,
+            MathFunction::Acosh => 1.0 + t * 100.0,
+            MathFunction::Ln | MathFunction::Log10 | MathFunction::Log2 | MathFunction::Pow => {
+                1e-3 + t * 1e3
+            }
+            MathFunction::Ln1p => t * 1e3 - 0.99,
+            MathFunction::Exp | MathFunction::ExpM1 | MathFunction::Cosh | MathFunction::Sinh => {
+                t * 40.0 - 20.0
+            }
+            _ => t * 200.0 - 100.0,
+        }
+    }
+
+    // Calls the function with the given backend. The binary ones take `0.75` as their second argument.
+    fn call(self, backend: Backend, x: f64) -> f64 {
+        match backend {
+            Backend::Wasm => match self {
+                MathFunction::Acos => x.acos(),
+                MathFunction::Acosh => x.acosh(),
+                MathFunction::Asin => x.asin(),
+                MathFunction::Asinh => x.asinh(),
+                MathFunction::Atan => x.atan(),
+                MathFunction::Atan2 => x.atan2(0.75),
+                MathFunction::Atanh => x.atanh(),
+                MathFunction::Cbrt => x.cbrt(),
+                MathFunction::Cos => x.cos(),
+                MathFunction::Cosh => x.cosh(),
+                MathFunction::Exp => x.exp(),
+                MathFunction::ExpM1 => x.exp_m1(),
+                MathFunction::Hypot => x.hypot(0.75),
+                MathFunction::Ln => x.ln(),
+                MathFunction::Ln1p => x.ln_1p(),
+                MathFunction::Log10 => x.log10(),
+                MathFunction::Log2 => x.log2(),
+                MathFunction::Pow => x.powf(0.75),
+                MathFunction::Rem => x % 0.75,
+                MathFunction::Sin => x.sin(),
+                MathFunction::Sinh => x.sinh(),
+                MathFunction::Tan => x.tan(),
+                MathFunction::Tanh => x.tanh(),
+            },
+            Backend::Js => unsafe {
+                match self {
+                    MathFunction::Acos => em_math::emscripten_math_acos(x),
+                    MathFunction::Acosh => em_math::emscripten_math_acosh(x),
+                    MathFunction::Asin => em_math::emscripten_math_asin(x),
+                    MathFunction::Asinh => em_math::emscripten_math_asinh(x),
+                    MathFunction::Atan => em_math::emscripten_math_atan(x),
+                    MathFunction::Atan2 => em_math::emscripten_math_atan2(x, 0.75),
+                    MathFunction::Atanh => em_math::emscripten_math_atanh(x),
+                    MathFunction::Cbrt => em_math::emscripten_math_cbrt(x),
+                    MathFunction::Cos => em_math::emscripten_math_cos(x),
+                    MathFunction::Cosh => em_math::emscripten_math_cosh(x),
+                    MathFunction::Exp => em_math::emscripten_math_exp(x),
+                    MathFunction::ExpM1 => em_math::emscripten_math_expm1(x),
+                    MathFunction::Hypot => em_math::emscripten_math_hypot(2, x, 0.75),
+                    MathFunction::Ln => em_math::emscripten_math_log(x),
+                    MathFunction::Ln1p => em_math::emscripten_math_log1p(x),
+                    MathFunction::Log10 => em_math::emscripten_math_log10(x),
+                    MathFunction::Log2 => em_math::emscripten_math_log2(x),
+                    MathFunction::Pow => em_math::emscripten_math_pow(x, 0.75),
+                    MathFunction::Rem => em_math::emscripten_math_fmod(x, 0.75),
+                    MathFunction::Sin => em_math::emscripten_math_sin(x),
+                    MathFunction::Sinh => em_math::emscripten_math_sinh(x),
+                    MathFunction::Tan => em_math::emscripten_math_tan(x),
+                    MathFunction::Tanh => em_math::emscripten_math_tanh(x),
+                }
+            },
+        }
+    }
+}
+
+// The bits of the functions using JS `Math`.
+static JS_FUNCTIONS: AtomicU32 = AtomicU32::new(0);
+
+fn uses_js(function: MathFunction) -> bool {
+    JS_FUNCTIONS.load(Ordering::Relaxed) & function.bit() != 0
+}
+
+/// Sets the implementation of the given function, for all the threads.
+pub fn set_backend(function: MathFunction, backend: Backend) {
+    match backend {
+        Backend::Wasm => JS_FUNCTIONS.fetch_and(!function.bit(), Ordering::Relaxed),
+        Backend::Js => JS_FUNCTIONS.fetch_or(function.bit(), Ordering::Relaxed),
+    };
+}
+
+/// Returns the implementation of the given function.
+#[inline]
+pub fn backend(function: MathFunction) -> Backend {
+    if uses_js(function) {
+        Backend::Js
+    } else {
+        Backend::Wasm
+    }
+}
+
+/// The time taken by both implementations of a function for the same inputs, returned by [`benchmark`].
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct Timing {
+    /// The time taken by the libm compiled to wasm, in milliseconds.
+    pub wasm: f64,
+    /// The time taken by JS `Math`, in milliseconds.
+    pub js: f64,
+}
+
+impl Timing {
+    /// Returns the faster implementation, which must be faster by 10% to replace the default one.
+    pub fn faster(&self) -> Backend {
+        if self.js < self.wasm * 0.9 {
+            Backend::Js
+        } else {
+            Backend::Wasm
+        }
+    }
+}
+
+fn time_backend(function: MathFunction, backend: Backend, iterations: u32) -> f64 {
+    let step = 1.0 / iterations as f64;
+    let start = get_now();
+    let mut sum = 0.0;
+    for i in 0..iterations {
+        sum += function.call(backend, black_box(function.input(i as f64 * step)));
+    }
+    black_box(sum);
+    get_now() - start
+}
+
+/// Times `iterations` calls of both implementations of the given function, over inputs spread across its domain.
+///
+/// Each implementation is run once before being timed, so that both are compiled by the JIT.
+pub fn benchmark(function: MathFunction, iterations: u32) -> Timing {
+    for backend in [Backend::Wasm, Backend::Js] {
+        time_backend(function, backend, iterations.min(1000));
+    }
+    Timing {
+        wasm: time_backend(function, Backend::Wasm, iterations),
+        js: time_backend(function, Backend::Js, iterations),
+    }
+}
+
+/// Benchmarks all the functions with `iterations` calls each, and sets each to its [faster](Timing::faster) implementation.
+///
+/// It blocks for the whole benchmark, e.g. a few tens of milliseconds for 10000 iterations: it's best run behind a loading screen,
+/// or once, with the chosen backends stored for the next sessions.
+///
+/// # Examples
+/// ```rust
+/// calibrate(10000);
+/// for function in MathFunction::ALL {
+///     println!("{:?}: {:?}", function, backend(function));
+/// }
+/// // The synthesizer's oscillators now use the faster `sin` of this browser.
+/// let sample = fastmath::sin(phase * std::f64::consts::TAU);
+/// ```
+pub fn calibrate(iterations: u32) {
+    for function in MathFunction::ALL {
+        set_backend(function, benchmark(function, iterations).faster());
+    }
+}
+
+macro_rules! unary {
+    ($(#[$doc:meta])* $name:ident, $function:ident) => {
+        $(#[$doc])*
+        #[inline]
+        pub fn $name(x: f64) -> f64 {
+            MathFunction::$function.call(backend(MathFunction::$function), x)
+        }
+    };
+}
+
+unary!(
+    /// Returns the arccosine of `x`, like [`f64::acos`].
+    acos, Acos
+);
+unary!(
+    /// Returns the inverse hyperbolic cosine of `x`, like [`f64::acosh`].
+    acosh, Acosh
+);
+unary!(
+    /// Returns the arcsine of `x`, like [`f64::asin`].
+    asin, Asin
+);
+unary!(
+    /// Returns the inverse hyperbolic sine of `x`, like [`f64::asinh`].
+    asinh, Asinh
+);
+unary!(
+    /// Returns the arctangent of `x`, like [`f64::atan`].
+    atan, Atan
+);
+unary!(
+    /// Returns the inverse hyperbolic tangent of `x`, like [`f64::atanh`].
+    atanh, Atanh
+);
+unary!(
+    /// Returns the cube root of `x`, like [`f64::cbrt`].
+    cbrt, Cbrt
+);
+unary!(
+    /// Returns the cosine of `x`, in radians, like [`f64::cos`].
+    cos, Cos
+);
+unary!(
+    /// Returns the hyperbolic cosine of `x`, like [`f64::cosh`].
+    cosh, Cosh
+);
+unary!(
+    /// Returns `e^x`, like [`f64::exp`].
+    exp, Exp
+);
+unary!(
+    /// Returns `e^x - 1`, accurate near 0, like [`f64::exp_m1`].
+    exp_m1, ExpM1
+);
+unary!(
+    /// Returns the natural logarithm of `x`, like [`f64::ln`].
+    ln, Ln
+);
+unary!(
+    /// Returns `ln(1 + x)`, accurate near 0, like [`f64::ln_1p`].
+    ln_1p, Ln1p
+);
+unary!(
+    /// Returns the base 10 logarithm of `x`, like [`f64::log10`].
+    log10, Log10
+);
+unary!(
+    /// Returns the base 2 logarithm of `x`, like [`f64::log2`].
+    log2, Log2
+);
+unary!(
+    /// Returns the sine of `x`, in radians, like [`f64::sin`].
+    sin, Sin
+);
+unary!(
+    /// Returns the hyperbolic sine of `x`, like [`f64::sinh`].
+    sinh, Sinh
+);
+unary!(
+    /// Returns the tangent of `x`, in radians, like [`f64::tan`].
+    tan, Tan
+);
+unary!(
+    /// Returns the hyperbolic tangent of `x`, like [`f64::tanh`].
+    tanh, Tanh
+);
+
+/// Returns the angle of the point `(x, y)`, in radians, like [`f64::atan2`] called on `y`.
+#[inline]
+pub fn atan2(y: f64, x: f64) -> f64 {
+    if uses_js(MathFunction::Atan2) {
+        unsafe { em_math::emscripten_math_atan2(y, x) }
+    } else {
+        y.atan2(x)
+    }
+}
+
+/// Returns the length of the hypotenuse of a right triangle of sides `x` and `y`, like [`f64::hypot`].
+#[inline]
+pub fn hypot(x: f64, y: f64) -> f64 {
+    if uses_js(MathFunction::Hypot) {
+        unsafe { em_math::emscripten_math_hypot(2, x, y) }
+    } else {
+        x.hypot(y)
+    }
+}
+
+/// Returns `x` raised to the power `y`, like [`f64::powf`].
+#[inline]
+pub fn pow(x: f64, y: f64) -> f64 {
+    if uses_js(MathFunction::Pow) {
+        unsafe { em_math::emscripten_math_pow(x, y) }
+    } else {
+        x.powf(y)
+    }
+}
+
+/// Returns the remainder of `x / y`, with the sign of `x`, like the `%` operator of `f64`.
+#[inline]
+pub fn rem(x: f64, y: f64) -> f64 {
+    if uses_js(MathFunction::Rem) {
+        unsafe { em_math::emscripten_math_fmod(x, y) }
+    } else {
+        x % y
+    }
+}
@@ -0,0 +1,816 @@
+//! Select functions (with rust-native parameter types) from the emscripten [fetch.h] header file, that download files using the Fetch API.
+//!
+//! Compared to the [`wget`](crate::wget) functions, fetches can send custom headers and request bodies,
+//! stream the downloaded data in chunks, and store the downloaded files in (or load them from) IndexedDB.
+//!
+//! The program must be linked with the `-sFETCH` flag to use them.
+//!
+//! [fetch.h]: https://emscripten.org/docs/api_reference/fetch.html
+
+use std::{
+    cell::{Cell, RefCell},
+    collections::HashMap,
+    ffi::{CStr, CString},
+    os::raw::{c_char, c_void},
+    rc::Rc,
+    slice,
+};
+
+use emscripten_functions_sys::fetch;
+
+use crate::{
+    decompress::{Compression, DecompressError, Decompressor},
+    emscripten::KeepAlive,
+};
+
+type OnSuccess = Box<dyn FnOnce(FetchResponse)>;
+type OnError = Box<dyn FnOnce(FetchResponse)>;
+type OnProgress = Box<dyn FnMut(&FetchProgress)>;
+type OnChunk = Box<dyn FnMut(&[u8], u64)>;
+type OnDecompressed = Box<dyn FnOnce(Result<(), DecompressError>, FetchResponse)>;
+
+// The state of a started fetch, passed to the callbacks as the fetch's `userData`.
+struct FetchState {
+    onsuccess: Option<OnSuccess>,
+    onerror: Option<OnError>,
+    onprogress: Option<OnProgress>,
+    // Emscripten doesn't copy the request body, so it must live until the fetch finishes.
+    body: Vec<u8>,
+    range: Option<(u64, u64)>,
+    pending: Rc<Cell<bool>>,
+    _keepalive: KeepAlive,
+}
+
+/// A description of a fetch, built with chained method calls and started with [`FetchRequest::send`].
+///
+/// By default, the request is a `GET` and the response body is loaded into memory.
+///
+/// # Examples
+/// ```rust
+/// FetchRequest::new("https://example.com/api/scores")
+///     .method("POST")
+///     .header("Content-Type", "application/json")
+///     .body(r#"{"score": 42}"#)
+///     .on_success(|response| {
+///         println!("{} {}", response.status(), String::from_utf8_lossy(response.data()));
+///     })
+///     .on_error(|response| {
+///         println!("Failed: {} {}", response.status(), response.status_text());
+///     })
+///     .send();
+/// ```
+pub struct FetchRequest {
+    url: String,
+    method: String,
+    attributes: u32,
+    timeout: u32,
+    with_credentials: bool,
+    destination_path: Option<CString>,
+    user_name: Option<CString>,
+    password: Option<CString>,
+    headers: Vec<CString>,
+    mime_type: Option<CString>,
+    body: Vec<u8>,
+    onsuccess: Option<OnSuccess>,
+    onerror: Option<OnError>,
+    onprogress: Option<OnProgress>,
+    onchunk: Option<OnChunk>,
+    range: Option<(u64, u64)>,
+}
+
+fn to_c_string(string: String) -> CString {
+    CString::new(string).expect("the fetch parameters must not contain NUL bytes")
+}
+
+impl FetchRequest {
+    /// Creates a `GET` request for the given URL, that loads the response body into memory.
+    pub fn new<T>(url: T) -> Self
+    where
+        T: Into<String>,
+    {
+        Self {
+            url: url.into(),
+            method: "GET".to_string(),
+            attributes: fetch::EMSCRIPTEN_FETCH_LOAD_TO_MEMORY,
+            timeout: 0,
+            with_credentials: false,
+            destination_path: None,
+            user_name: None,
+            password: None,
+            headers: Vec::new(),
+            mime_type: None,
+            body: Vec::new(),
+            onsuccess: None,
+            onerror: None,
+            onprogress: None,
+            onchunk: None,
+            range: None,
+        }
+    }
+
+    /// Sets the HTTP method, e.g. `"POST"`. It must be shorter than 32 bytes.
+    pub fn method<T>(mut self, method: T) -> Self
+    where
+        T: Into<String>,
+    {
+        let method = method.into();
+        assert!(
+            method.len() < 32,
+            "the HTTP method must be shorter than 32 bytes"
+        );
+        self.method = method;
+        self
+    }
+
+    fn attribute(mut self, attribute: u32, enabled: bool) -> Self {
+        if enabled {
+            self.attributes |= attribute;
+        } else {
+            self.attributes &= !attribute;
+        }
+        self
+    }
+
+    /// Sets whether the whole response body is kept in memory, to be read with [`FetchResponse::data`]. Enabled by default.
+    pub fn load_to_memory(self, enabled: bool) -> Self {
+        self.attribute(fetch::EMSCRIPTEN_FETCH_LOAD_TO_MEMORY, enabled)
+    }
+
+    /// Sets whether the progress handler receives the downloaded data in chunks, with [`FetchProgress::chunk`].
+    pub fn stream_data(self, enabled: bool) -> Self {
+        self.attribute(fetch::EMSCRIPTEN_FETCH_STREAM_DATA, enabled)
+    }
+
+    /// Sets whether the downloaded file is stored in IndexedDB, and looked up there before downloading it.
+    ///
+    /// The file is stored under the request URL, or under the path given with [`FetchRequest::destination_path`].
+    pub fn persist_file(self, enabled: bool) -> Self {
+        self.attribute(fetch::EMSCRIPTEN_FETCH_PERSIST_FILE, enabled)
+    }
+
+    /// Sets whether the file is downloaded again even if it's already stored in IndexedDB, replacing the stored one.
+    pub fn replace(self, enabled: bool) -> Self {
+        self.attribute(fetch::EMSCRIPTEN_FETCH_REPLACE, enabled)
+    }
+
+    /// Sets whether the file is only looked up in IndexedDB, failing instead of downloading it if it isn't stored there.
+    pub fn no_download(self, enabled: bool) -> Self {
+        self.attribute(fetch::EMSCRIPTEN_FETCH_NO_DOWNLOAD, enabled)
+    }
+
+    /// Sets the time after which the request fails, in milliseconds. 0, the default, means no timeout.
+    pub fn timeout(mut self, timeout: u32) -> Self {
+        self.timeout = timeout;
+        self
+    }
+
+    /// Sets whether cross-site requests are made with credentials (cookies, authorization headers).
+    pub fn with_credentials(mut self, enabled: bool) -> Self {
+        self.with_credentials = enabled;
+        self
+    }
+
+    /// Sets the path under which the file is stored in IndexedDB, when [`FetchRequest::persist_file`] is enabled.
+    pub fn destination_path<T>(mut self, path: T) -> Self
+    where
+        T: Into<String>,
+    {
+        self.destination_path = Some(to_c_string(path.into()));
+        self
+    }
+
+    /// Sets the user name and password used to authenticate the request.
+    pub fn credentials<T, U>(mut self, user_name: T, password: U) -> Self
+    where
+        T: Into<String>,
+        U: Into<String>,
+    {
+        self.user_name = Some(to_c_string(user_name.into()));
+        self.password = Some(to_c_string(password.into()));
+        self
+    }
+
+    /// Adds a request header.
+    pub fn header<T, U>(mut self, name: T, value: U) -> Self
+    where
+        T: Into<String>,
+        U: Into<String>,
+    {
+        self.headers.push(to_c_string(name.into()));
+        self.headers.push(to_c_string(value.into()));
+        self
+    }
+
+    /// Requests only `len` bytes of the resource, starting at byte `start`, with a `Range` header.
+    ///
+    /// If the server ignores the header and sends the whole resource, [`FetchResponse::data`] still returns only the requested bytes.
+    pub fn range(mut self, start: u64, len: u64) -> Self {
+        assert!(len > 0, "the requested range must not be empty");
+        self.range = Some((start, len));
+        self.header("Range", format!("bytes={}-{}", start, start + len - 1))
+    }
+
+    /// Forces the browser to treat the response as having the given MIME type.
+    pub fn override_mime_type<T>(mut self, mime_type: T) -> Self
+    where
+        T: Into<String>,
+    {
+        self.mime_type = Some(to_c_string(mime_type.into()));
+        self
+    }
+
+    /// Sets the request body.
+    pub fn body<T>(mut self, body: T) -> Self
+    where
+        T: Into<Vec<u8>>,
+    {
+        self.body = body.into();
+        self
+    }
+
+    /// Sets the function called with the response when the fetch succeeds.
+    pub fn on_success<F>(mut self, onsuccess: F) -> Self
+    where
+        F: 'static + FnOnce(FetchResponse),
+    {
+        self.onsuccess = Some(Box::new(onsuccess));
+        self
+    }
+
+    /// Sets the function called with the response when the fetch fails.
+    pub fn on_error<F>(mut self, onerror: F) -> Self
+    where
+        F: 'static + FnOnce(FetchResponse),
+    {
+        self.onerror = Some(Box::new(onerror));
+        self
+    }
+
+    /// Sets the function called as the download progresses.
+    pub fn on_progress<F>(mut self, onprogress: F) -> Self
+    where
+        F: 'static + FnMut(&FetchProgress),
+    {
+        self.onprogress = Some(Box::new(onprogress));
+        self
+    }
+
+    /// Streams the response body: the given function is called with each downloaded chunk and its offset from the start of the body.
+    ///
+    /// It enables [`FetchRequest::stream_data`] and disables [`FetchRequest::load_to_memory`],
+    /// so that the chunks are given as views straight into the memory emscripten downloaded them into, and the whole body is never buffered.
+    /// The peak memory use is then about one chunk, whatever the size of the response.
+    /// How large the chunks are depends on the browser's support for streamed responses.
+    ///
+    /// # Examples
+    /// ```rust
+    /// let mut hasher = DefaultHasher::new();
+    /// FetchRequest::new("models/weights.bin")
+    ///     .on_chunk(move |chunk, _offset| hasher.write(chunk))
+    ///     .send();
+    /// ```
+    pub fn on_chunk<F>(mut self, onchunk: F) -> Self
+    where
+        F: 'static + FnMut(&[u8], u64),
+    {
+        self.onchunk = Some(Box::new(onchunk));
+        self.stream_data(true).load_to_memory(false)
+    }
+
+    /// Streams the response body into the given buffer, each chunk being copied at its offset,
+    /// then calls `onsuccess` with the filled buffer and the response.
+    ///
+    /// Preallocate the buffer (e.g. with [`Vec::with_capacity`]) if you know the response size, so that it doesn't need to grow.
+    /// If the fetch fails, the buffer is dropped, and the error handler is called as usual.
+    ///
+    /// # Examples
+    /// ```rust
+    /// FetchRequest::new("models/weights.bin")
+    ///     .stream_into(Vec::with_capacity(300 << 20), |weights, _response| {
+    ///         println!("Loaded {} bytes of weights", weights.len());
+    ///     })
+    ///     .send();
+    /// ```
+    pub fn stream_into<F>(self, buffer: Vec<u8>, onsuccess: F) -> Self
+    where
+        F: 'static + FnOnce(Vec<u8>, FetchResponse),
+    {
+        let buffer = Rc::new(RefCell::new(buffer));
+        let chunk_buffer = buffer.clone();
+
+        self.on_chunk(move |chunk, offset| {
+            let mut buffer = chunk_buffer.borrow_mut();
+            let start = offset as usize;
+            let end = start + chunk.len();
+            if buffer.len() < end {
+                buffer.resize(end, 0);
+            }
+            buffer[start..end].copy_from_slice(chunk);
+        })
+        .on_success(move |response| onsuccess(buffer.take(), response))
+    }
+
+    /// Streams the response body through a native [`Decompressor`]: the downloaded chunks are inflated by the browser as they arrive,
+    /// and `onchunk` is called with each decompressed chunk. Once the fetch succeeded and all the data is decompressed,
+    /// `ondone` is called with the result of the decompression and the response.
+    ///
+    /// If the fetch fails or is aborted, the decompression is aborted, and the error handler is called as usual.
+    /// It's meant for compressed files, rather than for a `Content-Encoding` that the browser already decodes.
+    ///
+    /// # Examples
+    /// ```rust
+    /// FetchRequest::new("levels/level1.bin.gz")
+    ///     .decompress_chunks(Compression::Gzip, move |chunk| parser.feed(chunk), |result, _response| {
+    ///         if let Err(err) = result {
+    ///             println!("{}", err);
+    ///         }
+    ///     })
+    ///     .send();
+    /// ```
+    pub fn decompress_chunks<C, D>(self, format: Compression, onchunk: C, ondone: D) -> Self
+    where
+        C: 'static + FnMut(&[u8]),
+        D: 'static + FnOnce(Result<(), DecompressError>, FetchResponse),
+    {
+        let stage = Rc::new(RefCell::new(DecompressStage {
+            decompressor: None,
+            result: None,
+            response: None,
+            ondone: Some(Box::new(ondone)),
+        }));
+
+        let done_stage = stage.clone();
+        let decompressor = Decompressor::new(format, onchunk, move |result| {
+            done_stage.borrow_mut().result = Some(result);
+            DecompressStage::complete(&done_stage);
+        });
+        match decompressor {
+            Ok(decompressor) => stage.borrow_mut().decompressor = Some(decompressor),
+            Err(err) => stage.borrow_mut().result = Some(Err(err)),
+        }
+
+        // The guard lives as long as the fetch's handlers, and aborts the decompression if the fetch didn't succeed.
+        let guard = AbortDecompression(stage.clone());
+        self.on_chunk(move |chunk, _offset| {
+            if let Some(decompressor) = &guard.0.borrow().decompressor {
+                decompressor.write(chunk);
+            }
+        })
+        .on_success(move |response| {
+            let decompressor = {
+                let mut stage = stage.borrow_mut();
+                stage.response = Some(response);
+                stage.decompressor.take()
+            };
+            if let Some(decompressor) = decompressor {
+                decompressor.finish();
+            }
+            DecompressStage::complete(&stage);
+        })
+    }
+
+    /// Like [`decompress_chunks`](Self::decompress_chunks), appending the decompressed chunks to the given buffer,
+    /// then calling `onsuccess` with the filled buffer, or the error of the decompression, and the response.
+    ///
+    /// # Examples
+    /// ```rust
+    /// FetchRequest::new("config.json.gz")
+    ///     .decompress_into(Compression::Gzip, Vec::new(), |config, _response| match config {
+    ///         Ok(config) => load_config(&config),
+    ///         Err(err) => println!("{}", err),
+    ///     })
+    ///     .send();
+    /// ```
+    pub fn decompress_into<F>(self, format: Compression, buffer: Vec<u8>, onsuccess: F) -> Self
+    where
+        F: 'static + FnOnce(Result<Vec<u8>, DecompressError>, FetchResponse),
+    {
+        let buffer = Rc::new(RefCell::new(buffer));
+        let chunk_buffer = buffer.clone();
+
+        self.decompress_chunks(
+            format,
+            move |chunk| chunk_buffer.borrow_mut().extend_from_slice(chunk),
+            move |result, response| onsuccess(result.map(|()| buffer.take()), response),
+        )
+    }
+
+    /// Starts the fetch, returning a handle that can abort it, or `None` if emscripten couldn't start it.
+    pub fn send(self) -> Option<FetchHandle> {
+        let progress_handler: Option<OnProgress> = match (self.onchunk, self.onprogress) {
+            (Some(mut onchunk), mut onprogress) => {
+                Some(Box::new(move |progress: &FetchProgress| {
+                    let chunk = progress.chunk();
+                    if !chunk.is_empty() {
+                        onchunk(chunk, progress.chunk_offset());
+                    }
+                    if let Some(onprogress) = &mut onprogress {
+                        onprogress(progress);
+                    }
+                }))
+            }
+            (None, onprogress) => onprogress,
+        };
+
+        let pending = Rc::new(Cell::new(true));
+        let state = Box::into_raw(Box::new(FetchState {
+            onsuccess: self.onsuccess,
+            onerror: self.onerror,
+            onprogress: progress_handler,
+            body: self.body,
+            range: self.range,
+            pending: pending.clone(),
+            _keepalive: KeepAlive::new(),
+        }));
+
+        // Emscripten copies the strings and the headers array, but not the request body, which is kept in the state.
+        let mut headers: Vec<*const c_char> = self.headers.iter().map(|h| h.as_ptr()).collect();
+        headers.push(std::ptr::null());
+        let optional_ptr =
+            |string: &Option<CString>| string.as_ref().map_or(std::ptr::null(), |s| s.as_ptr());
+        let url = to_c_string(self.url);
+
+        let fetch_ptr = unsafe {
+            let mut attr = std::mem::zeroed::<fetch::emscripten_fetch_attr_t>();
+            fetch::emscripten_fetch_attr_init(&mut attr);
+
+            for (dst, src) in attr.requestMethod.iter_mut().zip(self.method.bytes()) {
+                *dst = src as c_char;
+            }
+            attr.userData = state as *mut c_void;
+            attr.onsuccess = Some(onsuccess);
+            attr.onerror = Some(onerror);
+            attr.onprogress = Some(onprogress);
+            attr.attributes = self.attributes;
+            attr.timeoutMSecs = self.timeout;
+            attr.withCredentials = self.with_credentials as _;
+            attr.destinationPath = optional_ptr(&self.destination_path);
+            attr.userName = optional_ptr(&self.user_name);
+            attr.password = optional_ptr(&self.password);
+            attr.requestHeaders = headers.as_ptr();
+            attr.overriddenMimeType = optional_ptr(&self.mime_type);
+            if !(*state).body.is_empty() {
+                attr.requestData = (*state).body.as_ptr() as *const c_char;
+                attr.requestDataSize = (*state).body.len();
+            }
+
+            fetch::emscripten_fetch(&mut attr, url.as_ptr())
+        };
+
+        if fetch_ptr.is_null() {
+            if pending.get() {
+                drop(unsafe { Box::from_raw(state) });
+            }
+            return None;
+        }
+
+        Some(FetchHandle {
+            fetch: fetch_ptr,
+            pending,
+        })
+    }
+}
+
+// The state shared by the handlers of a fetch streamed through a decompressor, see `FetchRequest::decompress_chunks`.
+struct DecompressStage {
+    decompressor: Option<Decompressor>,
+    result: Option<Result<(), DecompressError>>,
+    response: Option<FetchResponse>,
+    ondone: Option<OnDecompressed>,
+}
+
+impl DecompressStage {
+    // Calls `ondone` once both the fetch and the decompression ended, in whichever order.
+    fn complete(stage: &RefCell<Self>) {
+        let (result, response, ondone) = {
+            let mut stage = stage.borrow_mut();
+            if stage.result.is_none() || stage.response.is_none() {
+                return;
+            }
+            (
+                stage.result.take().unwrap(),
+                stage.response.take().unwrap(),
+                stage.ondone.take(),
+            )
+        };
+        if let Some(ondone) = ondone {
+            ondone(result, response);
+        }
+    }
+}
+
+struct AbortDecompression(Rc<RefCell<DecompressStage>>);
+
+impl Drop for AbortDecompression {
+    fn drop(&mut self) {
+        let decompressor = self.0.borrow_mut().decompressor.take();
+        drop(decompressor);
+    }
+}
+
+/// The handle of a started fetch.
+pub struct FetchHandle {
+    fetch: *mut fetch::emscripten_fetch_t,
+    pending: Rc<Cell<bool>>,
+}
+
+impl FetchHandle {
+    /// Returns `true` if the fetch hasn't finished nor been aborted yet.
+    pub fn is_pending(&self) -> bool {
+        self.pending.get()
+    }
+
+    /// Aborts the fetch. None of its handlers will be called anymore.
+    ///
+    /// It does nothing if the fetch already finished.
+    pub fn abort(&self) {
+        if !self.pending.replace(false) {
+            return;
+        }
+
+        unsafe {
+            // Closing a running fetch calls its error handler, which must not find the state anymore.
+            let state = (*self.fetch).userData as *mut FetchState;
+            (*self.fetch).userData = std::ptr::null_mut();
+            fetch::emscripten_fetch_close(self.fetch);
+            drop(Box::from_raw(state));
+        }
+    }
+}
+
+/// The progress of a fetch, given to its progress handler.
+pub struct FetchProgress<'a> {
+    fetch: &'a fetch::emscripten_fetch_t,
+}
+
+impl FetchProgress<'_> {
+    /// Returns the number of bytes downloaded so far.
+    pub fn loaded_bytes(&self) -> u64 {
+        self.fetch.dataOffset + self.fetch.numBytes
+    }
+
+    /// Returns the total number of bytes of the response body, or 0 if the server didn't report it.
+    pub fn total_bytes(&self) -> u64 {
+        self.fetch.totalBytes
+    }
+
+    /// Returns the offset of [`FetchProgress::chunk`] from the start of the response body.
+    pub fn chunk_offset(&self) -> u64 {
+        self.fetch.dataOffset
+    }
+
+    /// Returns the newly downloaded chunk of data, if [`FetchRequest::stream_data`] is enabled; otherwise it's empty.
+    ///
+    /// It's a view straight into the memory emscripten downloaded the chunk into, that is only valid during the progress handler call.
+    pub fn chunk(&self) -> &[u8] {
+        unsafe { raw_data(self.fetch) }
+    }
+}
+
+/// A finished fetch, given to its success or error handler. The fetch's memory is freed when it's dropped.
+pub struct FetchResponse {
+    fetch: *mut fetch::emscripten_fetch_t,
+    range: Option<(u64, u64)>,
+}
+
+impl FetchResponse {
+    fn fetch(&self) -> &fetch::emscripten_fetch_t {
+        unsafe { &*self.fetch }
+    }
+
+    /// Returns the unique identifier of the fetch.
+    pub fn id(&self) -> u32 {
+        self.fetch().id
+    }
+
+    /// Returns the fetched URL.
+    pub fn url(&self) -> String {
+        unsafe { CStr::from_ptr(self.fetch().url) }
+            .to_string_lossy()
+            .into_owned()
+    }
+
+    /// Returns the HTTP status code of the response.
+    pub fn status(&self) -> u16 {
+        self.fetch().status
+    }
+
+    /// Returns the HTTP status text of the response.
+    pub fn status_text(&self) -> String {
+        unsafe { CStr::from_ptr(self.fetch().statusText.as_ptr()) }
+            .to_string_lossy()
+            .into_owned()
+    }
+
+    /// Returns the response body, if [`FetchRequest::load_to_memory`] is enabled; otherwise it's empty.
+    ///
+    /// For a [`FetchRequest::range`] request answered with the whole resource, only the requested bytes are returned.
+    pub fn data(&self) -> &[u8] {
+        let data = unsafe { raw_data(self.fetch()) };
+
+        match self.range {
+            Some((start, len)) if self.status() == 200 => {
+                let start = (start as usize).min(data.len());
+                let end = start.saturating_add(len as usize).min(data.len());
+                &data[start..end]
+            }
+            _ => data,
+        }
+    }
+
+    /// Returns the total number of bytes of the response body.
+    pub fn total_bytes(&self) -> u64 {
+        self.fetch().totalBytes
+    }
+
+    /// Returns the response headers, as they were received: one `name: value` pair per line.
+    pub fn raw_headers(&self) -> String {
+        unsafe {
+            let length = fetch::emscripten_fetch_get_response_headers_length(self.fetch);
+            let mut buffer = vec![0u8; length + 1];
+            fetch::emscripten_fetch_get_response_headers(
+                self.fetch,
+                buffer.as_mut_ptr() as *mut c_char,
+                buffer.len(),
+            );
+            buffer.truncate(length);
+            String::from_utf8_lossy(&buffer).into_owned()
+        }
+    }
+
+    /// Returns the response headers, as (name, value) pairs.
+    pub fn headers(&self) -> Vec<(String, String)> {
+        self.raw_headers()
+            .lines()
+            .filter_map(|line| line.split_once(':'))
+            .map(|(name, value)| (name.trim().to_string(), value.trim().to_string()))
+            .collect()
+    }
+}
+
+impl Drop for FetchResponse {
+    fn drop(&mut self) {
+        unsafe {
+            fetch::emscripten_fetch_close(self.fetch);
+        }
+    }
+}
+
+unsafe fn raw_data(fetch: &fetch::emscripten_fetch_t) -> &[u8] {
+    if fetch.data.is_null() {
+        &[]
+    } else {
+        slice::from_raw_parts(fetch.data as *const u8, fetch.numBytes as usize)
+    }
+}
+
+// Takes back the state of a finished fetch, or `None` if it was aborted.
+unsafe fn take_state(fetch_ptr: *mut fetch::emscripten_fetch_t) -> Option<Box<FetchState>> {
+    let state = (*fetch_ptr).userData as *mut FetchState;
+    if state.is_null() {
+        return None;
+    }
+    (*fetch_ptr).userData = std::ptr::null_mut();
+
+    let state = Box::from_raw(state);
+    state.pending.set(false);
+    Some(state)
+}
+
+unsafe extern "C" fn onsuccess(fetch_ptr: *mut fetch::emscripten_fetch_t) {
+    if let Some(state) = take_state(fetch_ptr) {
+        let response = FetchResponse {
+            fetch: fetch_ptr,
+            range: state.range,
+        };
+        if let Some(onsuccess) = state.onsuccess {
+            onsuccess(response);
+        }
+    }
+}
+
+unsafe extern "C" fn onerror(fetch_ptr: *mut fetch::emscripten_fetch_t) {
+    if let Some(state) = take_state(fetch_ptr) {
+        let response = FetchResponse {
+            fetch: fetch_ptr,
+            range: state.range,
+        };
+        if let Some(onerror) = state.onerror {
+            onerror(response);
+        }
+    }
+}
+
+unsafe extern "C" fn onprogress(fetch_ptr: *mut fetch::emscripten_fetch_t) {
+    let state = (*fetch_ptr).userData as *mut FetchState;
+    if state.is_null() {
+        return;
+    }
+
+    // The handler is taken out during the call, as it may abort the fetch, freeing its state.
+    let pending = (*state).pending.clone();
+    if let Some(mut onprogress) = (*state).onprogress.take() {
+        onprogress(&FetchProgress { fetch: &*fetch_ptr });
+        if pending.get() {
+            (*state).onprogress = Some(onprogress);
+        }
+    }
+}
+
+/// Creates a request for `len` bytes of the given URL, starting at byte `start`. See [`FetchRequest::range`].
+///
+/// # Examples
+/// ```rust
+/// fetch_range("levels.pack", 4096, 1024)
+///     .on_success(|response| println!("Got {} bytes", response.data().len()))
+///     .send();
+/// ```
+pub fn fetch_range<T>(url: T, start: u64, len: u64) -> FetchRequest
+where
+    T: Into<String>,
+{
+    FetchRequest::new(url).range(start, len)
+}
+
+/// The location of an entry in a [`PackedArchive`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct PackedArchiveEntry {
+    /// The offset of the entry from the start of the archive, in bytes.
+    pub offset: u64,
+    /// The size of the entry, in bytes.
+    pub len: u64,
+}
+
+/// A large archive of packed files on a server, whose entries are downloaded on demand with range requests.
+///
+/// The archive's index (where each entry lies in the archive) must be known beforehand, e.g. shipped with the program or downloaded separately.
+///
+/// # Examples
+/// ```rust
+/// let mut archive = PackedArchive::new("levels.pack");
+/// archive.insert("level1/terrain.bin", 0, 1 << 20);
+/// archive.insert("level1/props.bin", 1 << 20, 4096);
+///
+/// archive.read(
+///     "level1/props.bin",
+///     |response| println!("Props: {} bytes", response.data().len()),
+///     |response| println!("Failed: {}", response.status_text()),
+/// );
+/// ```
+#[derive(Debug, Clone)]
+pub struct PackedArchive {
+    url: String,
+    entries: HashMap<String, PackedArchiveEntry>,
+}
+
+impl PackedArchive {
+    /// Creates an archive with an empty index, at the given URL.
+    pub fn new<T>(url: T) -> Self
+    where
+        T: Into<String>,
+    {
+        Self {
+            url: url.into(),
+            entries: HashMap::new(),
+        }
+    }
+
+    /// Adds an entry to the archive's index, replacing the one with the same name, if any.
+    pub fn insert<T>(&mut self, name: T, offset: u64, len: u64)
+    where
+        T: Into<String>,
+    {
+        self.entries
+            .insert(name.into(), PackedArchiveEntry { offset, len });
+    }
+
+    /// Returns the location of the given entry, if it's in the index.
+    pub fn entry(&self, name: &str) -> Option<PackedArchiveEntry> {
+        self.entries.get(name).copied()
+    }
+
+    /// Creates the request for the given entry, to be customized (e.g. with a progress handler) and sent.
+    /// It returns `None` if the entry isn't in the index.
+    pub fn request(&self, name: &str) -> Option<FetchRequest> {
+        self.entry(name)
+            .map(|entry| fetch_range(self.url.clone(), entry.offset, entry.len))
+    }
+
+    /// Downloads the given entry, returning the fetch's handle,
+    /// or `None` if the entry isn't in the index or the fetch couldn't be started.
+    ///
+    /// # Arguments
+    /// * `name` - The name of the entry.
+    /// * `onsuccess` - The function called with the response, whose [`FetchResponse::data`] is the entry's contents.
+    /// * `onerror` - The function called with the response if the fetch fails.
+    pub fn read<S, E>(&self, name: &str, onsuccess: S, onerror: E) -> Option<FetchHandle>
+    where
+        S: 'static + FnOnce(FetchResponse),
+        E: 'static + FnOnce(FetchResponse),
+    {
+        self.request(name)?
+            .on_success(onsuccess)
+            .on_error(onerror)
+            .send()
+    }
+}
@@ -0,0 +1,215 @@
+//! Stackful coroutines switched within the calling thread, over the emscripten [`fiber.h`] header file.
+//!
+//! A [`Fiber`] runs a function on its own stack until it yields, and [`Fiber::resume`] continues it from there.
+//! Switching is a call into the Asyncify runtime, without a thread of its own nor proxying, so many cooperative tasks
+//! (AI agents, script interpreters) can be interleaved cheaply on one thread.
+//!
+//! The program must be built with `-sASYNCIFY`.
+//!
+//! [`fiber.h`]: https://emscripten.org/docs/api_reference/fiber.h.html
+
+use std::{
+    any::Any,
+    marker::PhantomData,
+    mem::MaybeUninit,
+    os::raw::c_void,
+    panic::{self, AssertUnwindSafe},
+    ptr::NonNull,
+};
+
+use emscripten_functions_sys::fiber;
+
+/// The default size of a fiber's data stack, in bytes.
+pub const DEFAULT_STACK_SIZE: usize = 64 * 1024;
+/// The default size of the stacks Asyncify saves the wasm call stack into when switching, in bytes.
+pub const DEFAULT_ASYNCIFY_STACK_SIZE: usize = 16 * 1024;
+
+/// The state of a [`Fiber`] after it was resumed.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum FiberState {
+    /// The fiber yielded, and can be resumed again.
+    Suspended,
+    /// The function of the fiber returned.
+    Finished,
+}
+
+type FiberFunction = Box<dyn FnOnce(&Yielder)>;
+
+// Allocates a 16-byte aligned buffer of at least `size` bytes, as the stacks must be.
+fn stack_buffer(size: usize) -> Box<[MaybeUninit<u128>]> {
+    vec![MaybeUninit::uninit(); size.div_ceil(16)].into_boxed_slice()
+}
+
+// The parts of a fiber that its running function accesses, boxed so that they keep their address.
+struct Inner {
+    context: fiber::emscripten_fiber_t,
+    // The context that resumed the fiber, which it switches back to.
+    caller: fiber::emscripten_fiber_t,
+    func: Option<FiberFunction>,
+    finished: bool,
+    running: bool,
+    panic: Option<Box<dyn Any + Send>>,
+    c_stack: Box<[MaybeUninit<u128>]>,
+    asyncify_stack: Box<[MaybeUninit<u128>]>,
+    caller_asyncify_stack: Box<[MaybeUninit<u128>]>,
+}
+
+unsafe extern "C" fn entry(arg: *mut c_void) {
+    let inner = arg as *mut Inner;
+    if let Some(func) = (*inner).func.take() {
+        let yielder = Yielder {
+            inner,
+            _not_send: PhantomData,
+        };
+        if let Err(panic) = panic::catch_unwind(AssertUnwindSafe(|| func(&yielder))) {
+            (*inner).panic = Some(panic);
+        }
+    }
+
+    // The entry function mustn't return: the fiber switches back for the last time instead.
+    (*inner).finished = true;
+    (*inner).running = false;
+    fiber::emscripten_fiber_swap(&mut (*inner).context, &mut (*inner).caller);
+}
+
+/// A stackful coroutine running a function on its own stack, in the thread that resumes it.
+///
+/// Dropping a fiber that didn't finish frees its stack without running the destructors of the values on it.
+///
+/// # Examples
+/// ```rust
+/// let mut agent = Fiber::new(|yielder| {
+///     loop {
+///         let target = find_target();
+///         while !reached(target) {
+///             step_towards(target);
+///             // Continues in the next frame.
+///             yielder.yield_now();
+///         }
+///     }
+/// });
+///
+/// set_main_loop(move || {
+///     agent.resume();
+/// }, 0, true);
+/// ```
+pub struct Fiber {
+    inner: NonNull<Inner>,
+    // The contexts belong to the thread that created them.
+    _not_send: PhantomData<*const ()>,
+}
+
+impl Fiber {
+    /// Creates a fiber that runs `func` when first resumed, with the default stack sizes.
+    pub fn new<F>(func: F) -> Self
+    where
+        F: 'static + FnOnce(&Yielder),
+    {
+        Self::with_stack_sizes(func, DEFAULT_STACK_SIZE, DEFAULT_ASYNCIFY_STACK_SIZE)
+    }
+
+    /// Creates a fiber that runs `func` when first resumed.
+    ///
+    /// # Arguments
+    /// * `func` - The function to run in the fiber. It gets the [`Yielder`] that suspends the fiber.
+    /// * `stack_size` - The size of the fiber's data stack, in bytes.
+    /// * `asyncify_stack_size` - The size in bytes of the buffers the wasm call stack is saved into when switching,
+    ///   which must fit the deepest call stack the fiber and its resumer switch from.
+    pub fn with_stack_sizes<F>(func: F, stack_size: usize, asyncify_stack_size: usize) -> Self
+    where
+        F: 'static + FnOnce(&Yielder),
+    {
+        let inner = Box::into_raw(Box::new(Inner {
+            context: unsafe { std::mem::zeroed() },
+            caller: unsafe { std::mem::zeroed() },
+            func: Some(Box::new(func)),
+            finished: false,
+            running: false,
+            panic: None,
+            c_stack: stack_buffer(stack_size),
+            asyncify_stack: stack_buffer(asyncify_stack_size),
+            caller_asyncify_stack: stack_buffer(asyncify_stack_size),
+        }));
+
+        unsafe {
+            let c_stack = &mut (*inner).c_stack;
+            let asyncify_stack = &mut (*inner).asyncify_stack;
+            fiber::emscripten_fiber_init(
+                &mut (*inner).context,
+                Some(entry),
+                inner as *mut c_void,
+                c_stack.as_mut_ptr() as *mut c_void,
+                c_stack.len() * 16,
+                asyncify_stack.as_mut_ptr() as *mut c_void,
+                asyncify_stack.len() * 16,
+            );
+        }
+
+        Self {
+            inner: NonNull::new(inner).unwrap(),
+            _not_send: PhantomData,
+        }
+    }
+
+    /// Runs the fiber until it yields or finishes, using the emscripten-defined [`emscripten_fiber_swap`].
+    /// It does nothing if the fiber already finished.
+    ///
+    /// If the function of the fiber panics, the panic is resumed here.
+    ///
+    /// [`emscripten_fiber_swap`]: https://emscripten.org/docs/api_reference/fiber.h.html#c.emscripten_fiber_swap
+    pub fn resume(&mut self) -> FiberState {
+        let inner = self.inner.as_ptr();
+        unsafe {
+            if (*inner).finished {
+                return FiberState::Finished;
+            }
+            assert!(!(*inner).running, "a fiber can't resume itself");
+
+            let caller_asyncify_stack = &mut (*inner).caller_asyncify_stack;
+            fiber::emscripten_fiber_init_from_current_context(
+                &mut (*inner).caller,
+                caller_asyncify_stack.as_mut_ptr() as *mut c_void,
+                caller_asyncify_stack.len() * 16,
+            );
+            (*inner).running = true;
+            fiber::emscripten_fiber_swap(&mut (*inner).caller, &mut (*inner).context);
+
+            if let Some(panic) = (*inner).panic.take() {
+                panic::resume_unwind(panic);
+            }
+            if (*inner).finished {
+                FiberState::Finished
+            } else {
+                FiberState::Suspended
+            }
+        }
+    }
+
+    /// Returns `true` if the function of the fiber returned.
+    pub fn is_finished(&self) -> bool {
+        unsafe { (*self.inner.as_ptr()).finished }
+    }
+}
+
+impl Drop for Fiber {
+    fn drop(&mut self) {
+        drop(unsafe { Box::from_raw(self.inner.as_ptr()) });
+    }
+}
+
+/// Suspends the fiber it's given to, back to where it was resumed.
+pub struct Yielder {
+    inner: *mut Inner,
+    _not_send: PhantomData<*const ()>,
+}
+
+impl Yielder {
+    /// Suspends the fiber, making its [`Fiber::resume`] call return. The next one continues from here.
+    pub fn yield_now(&self) {
+        unsafe {
+            (*self.inner).running = false;
+            fiber::emscripten_fiber_swap(&mut (*self.inner).context, &mut (*self.inner).caller);
+            (*self.inner).running = true;
+        }
+    }
+}
@@ -0,0 +1,109 @@
+//! A fixed-timestep simulation loop with interpolated rendering, built on [`set_main_loop_with_arg`].
+//!
+//! The simulation runs at a fixed rate, independently of the display's refresh rate,
+//! while rendering happens once per `requestAnimationFrame` tick, with the interpolation factor between the last two simulation steps.
+//!
+//! [`set_main_loop_with_arg`]: crate::emscripten::set_main_loop_with_arg
+
+use crate::emscripten::{get_now, set_main_loop_with_arg};
+
+// The user's state, together with the time of the previous tick and the simulation time debt, in milliseconds.
+struct FixedStepState<T> {
+    state: T,
+    last_time: Option<f64>,
+    accumulator: f64,
+}
+
+/// Sets a fixed-timestep loop as the main loop of the calling thread, using [`set_main_loop_with_arg`] with `requestAnimationFrame` timing.
+///
+/// On each tick, the time elapsed since the previous tick (measured with [`get_now`]) is added to a time debt,
+/// and `simulate` is called once per whole `step` of debt, with the step duration as argument.
+/// Then `render` is called once, with the interpolation factor `alpha` in the range [0, 1):
+/// the fraction of a step elapsed since the last simulation step, to blend the previous and current simulation states.
+///
+/// To prevent a spiral of death (when simulation steps take longer than the time they simulate),
+/// at most `max_steps_per_frame` simulation steps run per tick, and the rest of the time debt is dropped.
+///
+/// The loop can be cancelled using the [`cancel_main_loop`] function.
+///
+/// [`set_main_loop_with_arg`]: crate::emscripten::set_main_loop_with_arg
+/// [`cancel_main_loop`]: crate::emscripten::cancel_main_loop
+///
+/// # Arguments
+/// * `simulate` - The simulation function, called with the state and the step duration, in milliseconds.
+/// * `render` - The render function, called with the state and the interpolation factor.
+/// * `state` - The state the loop functions interact with. It will be consumed so that it can be kept alive during the loop.
+/// * `step` - The fixed duration of a simulation step, in milliseconds.
+/// * `max_steps_per_frame` - The maximum number of simulation steps to run in a tick.
+/// * `simulate_infinite_loop` - If `true`, no code after the function call will be executed, otherwise the code after the function call will be executed.
+///
+/// # Examples
+/// ```rust
+/// struct World {
+///     previous_x: f64,
+///     x: f64,
+/// }
+///
+/// set_fixed_step_loop(
+///     |world, dt| {
+///         world.previous_x = world.x;
+///         world.x += 0.01 * dt;
+///     },
+///     |world, alpha| {
+///         let x = world.previous_x + (world.x - world.previous_x) * alpha;
+///         println!("Drawing at {}", x);
+///     },
+///     World { previous_x: 0.0, x: 0.0 },
+///     1000.0 / 120.0,
+///     8,
+///     true,
+/// );
+/// ```
+pub fn set_fixed_step_loop<S, R, T>(
+    mut simulate: S,
+    mut render: R,
+    state: T,
+    step: f64,
+    max_steps_per_frame: u32,
+    simulate_infinite_loop: bool,
+) where
+    S: 'static + FnMut(&mut T, f64),
+    R: 'static + FnMut(&mut T, f64),
+    T: 'static,
+{
+    assert!(step > 0.0, "the simulation step must be positive");
+
+    let fixed_step_state = FixedStepState {
+        state,
+        last_time: None,
+        accumulator: 0.0,
+    };
+
+    set_main_loop_with_arg(
+        move |data| {
+            let now = get_now();
+            let elapsed = match data.last_time {
+                Some(last_time) => now - last_time,
+                // The first tick only renders the initial state.
+                None => 0.0,
+            };
+            data.last_time = Some(now);
+            data.accumulator += elapsed;
+
+            let mut steps = 0;
+            while data.accumulator >= step && steps < max_steps_per_frame {
+                simulate(&mut data.state, step);
+                data.accumulator -= step;
+                steps += 1;
+            }
+            if steps == max_steps_per_frame && data.accumulator >= step {
+                data.accumulator %= step;
+            }
+
+            render(&mut data.state, data.accumulator / step);
+        },
+        fixed_step_state,
+        0,
+        simulate_infinite_loop,
+    );
+}
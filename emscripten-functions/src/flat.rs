@@ -0,0 +1,378 @@
+//! A flat binary message format, read in place from the received bytes without deserializing them.
+//!
+//! The messages sent to [workers](crate::worker) and over [WebSockets](crate::websocket) are byte buffers. Going through JSON
+//! costs a string build on one side, and a parse and allocations on the other. A message declared with [`flat_message!`] is
+//! instead written once into a `Vec<u8>`, and its view reads each field straight from the received `&[u8]`, at an offset
+//! known at compile time.
+//!
+//! A message is laid out as:
+//! - its tag, a little-endian `u32`, to tell the messages of a channel apart, with [`tag_of`];
+//! - its fixed-size fields, in order, each little-endian: the [`Field`] types are the integers, `f32`, `f64`, `bool`,
+//!   arrays of them, and `str` and `[u8]`, stored as the `u32` offset and length of their bytes;
+//! - the bytes of its `str` and `[u8]` fields.
+//!
+//! The view checks the tag, the size and the `str` and `[u8]` fields when it's created, so that its accessors never fail.
+//! Adding fields at the end of a message keeps it readable by the older views, which ignore them.
+
+use std::fmt::Display;
+
+/// The error of a view created from bytes that aren't a valid message of its type.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum FlatError {
+    /// The bytes are shorter than the tag and the fixed-size fields.
+    TooShort,
+    /// The bytes are a message of another type, of the given tag.
+    WrongTag(u32),
+    /// A `str` or `[u8]` field is out of the bytes, or a `str` field or a `bool` isn't valid.
+    InvalidField,
+}
+
+impl Display for FlatError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        match self {
+            FlatError::TooShort => write!(f, "The message is too short"),
+            FlatError::WrongTag(tag) => write!(f, "Unexpected message tag {}", tag),
+            FlatError::InvalidField => write!(f, "Invalid message field"),
+        }
+    }
+}
+
+/// Returns the tag of a message, to choose the view to read it with, or `None` if it's shorter than a tag.
+pub fn tag_of(bytes: &[u8]) -> Option<u32> {
+    Some(u32::from_le_bytes(bytes.get(..4)?.try_into().unwrap()))
+}
+
+/// The size of the tag of a message.
+pub const TAG_SIZE: usize = 4;
+
+// Returns the offset of the field at `index`, after the tag and the fields before it.
+#[doc(hidden)]
+pub const fn offset(sizes: &[usize], index: usize) -> usize {
+    let mut at = TAG_SIZE;
+    let mut i = 0;
+    while i < index {
+        at += sizes[i];
+        i += 1;
+    }
+    at
+}
+
+// The bytes of a message whose fields were all validated, which the views of `flat_message!` hold.
+// It can only be created with `unsafe`, so that safe code can't make a view over unchecked bytes, even next to its definition.
+#[doc(hidden)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Validated<'a>(&'a [u8]);
+
+impl<'a> Validated<'a> {
+    /// # Safety
+    /// Each field of the message must have been validated with [`Field::validate`].
+    #[inline]
+    pub unsafe fn new(bytes: &'a [u8]) -> Self {
+        Self(bytes)
+    }
+
+    #[inline]
+    pub fn bytes(self) -> &'a [u8] {
+        self.0
+    }
+}
+
+/// A type that can be a field of a [`flat_message!`].
+pub trait Field {
+    /// The size of the field in the fixed-size part of the message.
+    const SIZE: usize;
+    /// The type the view's accessor returns.
+    type Ref<'a>;
+    /// The type the message's `write` function takes.
+    type Arg<'a>;
+
+    /// Returns `true` if the field at `at` of a message at least [`SIZE`](Self::SIZE) bytes past `at` is valid.
+    fn validate(bytes: &[u8], at: usize) -> bool;
+
+    /// Reads the field at `at` of a validated message.
+    ///
+    /// # Safety
+    /// [`validate`](Self::validate) must have returned `true` for the same `bytes` and `at`:
+    /// e.g. a `str` field is read without checking its UTF-8 again.
+    unsafe fn read(bytes: &[u8], at: usize) -> Self::Ref<'_>;
+
+    /// Writes the field at `at` of the message being written from `start` of `buf`, whose fixed-size part is already in it.
+    fn write(value: Self::Arg<'_>, buf: &mut Vec<u8>, start: usize, at: usize);
+}
+
+/// A fixed-size [`Field`], that can be an array element.
+pub trait Scalar: Copy {
+    /// The size of the value.
+    const SIZE: usize;
+
+    /// Returns `true` if the bytes, of [`SIZE`](Self::SIZE), are a valid value.
+    fn is_valid(bytes: &[u8]) -> bool;
+
+    /// Reads the value from its bytes, of [`SIZE`](Self::SIZE).
+    fn from_bytes(bytes: &[u8]) -> Self;
+
+    /// Writes the value into its bytes, of [`SIZE`](Self::SIZE).
+    fn to_bytes(self, bytes: &mut [u8]);
+}
+
+macro_rules! impl_scalar {
+    ($($ty:ty),*) => {
+        $(
+            impl Scalar for $ty {
+                const SIZE: usize = std::mem::size_of::<$ty>();
+
+                fn is_valid(_bytes: &[u8]) -> bool {
+                    true
+                }
+
+                #[inline]
+                fn from_bytes(bytes: &[u8]) -> Self {
+                    <$ty>::from_le_bytes(bytes.try_into().unwrap())
+                }
+
+                #[inline]
+                fn to_bytes(self, bytes: &mut [u8]) {
+                    bytes.copy_from_slice(&self.to_le_bytes());
+                }
+            }
+        )*
+    };
+}
+
+impl_scalar!(u8, i8, u16, i16, u32, i32, u64, i64, f32, f64);
+
+impl Scalar for bool {
+    const SIZE: usize = 1;
+
+    fn is_valid(bytes: &[u8]) -> bool {
+        bytes[0] <= 1
+    }
+
+    #[inline]
+    fn from_bytes(bytes: &[u8]) -> Self {
+        bytes[0] != 0
+    }
+
+    #[inline]
+    fn to_bytes(self, bytes: &mut [u8]) {
+        bytes[0] = self as u8;
+    }
+}
+
+impl<T: Scalar> Field for T {
+    const SIZE: usize = T::SIZE;
+    type Ref<'a> = T;
+    type Arg<'a> = T;
+
+    fn validate(bytes: &[u8], at: usize) -> bool {
+        T::is_valid(&bytes[at..at + T::SIZE])
+    }
+
+    #[inline]
+    unsafe fn read(bytes: &[u8], at: usize) -> T {
+        T::from_bytes(&bytes[at..at + T::SIZE])
+    }
+
+    fn write(value: T, buf: &mut Vec<u8>, start: usize, at: usize) {
+        let at = start + at;
+        value.to_bytes(&mut buf[at..at + T::SIZE]);
+    }
+}
+
+impl<T: Scalar, const N: usize> Field for [T; N] {
+    const SIZE: usize = T::SIZE * N;
+    type Ref<'a> = [T; N];
+    type Arg<'a> = [T; N];
+
+    fn validate(bytes: &[u8], at: usize) -> bool {
+        (0..N).all(|i| T::is_valid(&bytes[at + i * T::SIZE..at + (i + 1) * T::SIZE]))
+    }
+
+    #[inline]
+    unsafe fn read(bytes: &[u8], at: usize) -> [T; N] {
+        std::array::from_fn(|i| T::from_bytes(&bytes[at + i * T::SIZE..at + (i + 1) * T::SIZE]))
+    }
+
+    fn write(value: [T; N], buf: &mut Vec<u8>, start: usize, at: usize) {
+        let at = start + at;
+        for (i, element) in value.into_iter().enumerate() {
+            element.to_bytes(&mut buf[at + i * T::SIZE..at + (i + 1) * T::SIZE]);
+        }
+    }
+}
+
+// The bytes of a variable-size field, from its offset and length.
+fn span(bytes: &[u8], at: usize) -> Option<&[u8]> {
+    let start = u32::from_bytes(&bytes[at..at + 4]) as usize;
+    let len = u32::from_bytes(&bytes[at + 4..at + 8]) as usize;
+    bytes.get(start..start.checked_add(len)?)
+}
+
+// The offsets are relative to the message, which starts at `start` of `buf`.
+fn write_span(data: &[u8], buf: &mut Vec<u8>, start: usize, at: usize) {
+    let at = start + at;
+    let offset = (buf.len() - start) as u32;
+    buf.extend_from_slice(data);
+    offset.to_bytes(&mut buf[at..at + 4]);
+    (data.len() as u32).to_bytes(&mut buf[at + 4..at + 8]);
+}
+
+impl Field for [u8] {
+    const SIZE: usize = 8;
+    type Ref<'a> = &'a [u8];
+    type Arg<'a> = &'a [u8];
+
+    fn validate(bytes: &[u8], at: usize) -> bool {
+        span(bytes, at).is_some()
+    }
+
+    #[inline]
+    unsafe fn read(bytes: &[u8], at: usize) -> &[u8] {
+        span(bytes, at).unwrap_or_default()
+    }
+
+    fn write(value: &[u8], buf: &mut Vec<u8>, start: usize, at: usize) {
+        write_span(value, buf, start, at);
+    }
+}
+
+impl Field for str {
+    const SIZE: usize = 8;
+    type Ref<'a> = &'a str;
+    type Arg<'a> = &'a str;
+
+    fn validate(bytes: &[u8], at: usize) -> bool {
+        span(bytes, at).is_some_and(|text| std::str::from_utf8(text).is_ok())
+    }
+
+    #[inline]
+    unsafe fn read(bytes: &[u8], at: usize) -> &str {
+        // The field was checked to be UTF-8 by `validate`.
+        std::str::from_utf8_unchecked(span(bytes, at).unwrap_or_default())
+    }
+
+    fn write(value: &str, buf: &mut Vec<u8>, start: usize, at: usize) {
+        write_span(value.as_bytes(), buf, start, at);
+    }
+}
+
+/// Declares flat messages: for each, a view type reading its fields in place from the bytes of a message,
+/// and a `write` function appending a message to a `Vec<u8>`. See the [module documentation](crate::flat).
+///
+/// Each message has a tag, given after its name, and fields of [`Field`](crate::flat::Field) types.
+/// The view has an accessor for each field, so the fields can't be named `new`, `write` or `as_bytes`,
+/// and `write` takes the fields in order.
+///
+/// # Examples
+/// ```rust
+/// flat_message! {
+///     /// A player's state, sent by the server each tick.
+///     pub struct PlayerState: 1 {
+///         id: u32,
+///         position: [f32; 3],
+///         alive: bool,
+///         name: str,
+///     }
+/// }
+///
+/// // On the server.
+/// let mut buf = Vec::new();
+/// PlayerState::write(&mut buf, 7, [1.0, 0.0, 2.5], true, "ada");
+/// socket.send_binary(&buf).unwrap();
+///
+/// // On the client, in the message callback.
+/// if let Message::Binary(bytes) = message {
+///     match tag_of(bytes) {
+///         Some(PlayerState::TAG) => {
+///             let state = PlayerState::new(bytes).unwrap();
+///             world.move_player(state.id(), state.position());
+///         }
+///         _ => {}
+///     }
+/// }
+/// ```
+#[macro_export]
+macro_rules! flat_message {
+    ($(
+        $(#[$meta:meta])*
+        $vis:vis struct $name:ident: $tag:literal {
+            $($field:ident: $ty:ty),* $(,)?
+        }
+    )*) => {
+        $(
+            $(#[$meta])*
+            #[derive(Debug, Clone, Copy, PartialEq, Eq)]
+            $vis struct $name<'a> {
+                bytes: $crate::flat::Validated<'a>,
+            }
+
+            const _: () = {
+                use $crate::flat::Field;
+
+                #[allow(non_camel_case_types, dead_code)]
+                enum Index {
+                    $($field),*
+                }
+
+                const SIZES: &[usize] = &[$(<$ty as Field>::SIZE),*];
+
+                impl<'a> $name<'a> {
+                    /// The tag of the message.
+                    pub const TAG: u32 = $tag;
+
+                    /// The size of the tag and the fixed-size fields of the message.
+                    pub const FIXED_SIZE: usize = $crate::flat::offset(SIZES, SIZES.len());
+
+                    /// Returns the view of the given message, after checking its tag, its size and its fields.
+                    pub fn new(bytes: &'a [u8]) -> Result<Self, $crate::flat::FlatError> {
+                        if bytes.len() < Self::FIXED_SIZE {
+                            return Err($crate::flat::FlatError::TooShort);
+                        }
+                        let tag = $crate::flat::tag_of(bytes).unwrap();
+                        if tag != Self::TAG {
+                            return Err($crate::flat::FlatError::WrongTag(tag));
+                        }
+                        let mut at = $crate::flat::TAG_SIZE;
+                        $(
+                            if !<$ty as Field>::validate(bytes, at) {
+                                return Err($crate::flat::FlatError::InvalidField);
+                            }
+                            at += <$ty as Field>::SIZE;
+                        )*
+                        let _ = at;
+                        // Safety: all the fields were validated above.
+                        Ok(Self { bytes: unsafe { $crate::flat::Validated::new(bytes) } })
+                    }
+
+                    /// Returns the bytes of the message.
+                    pub fn as_bytes(&self) -> &'a [u8] {
+                        self.bytes.bytes()
+                    }
+
+                    /// Appends a message with the given fields to `buf`.
+                    #[allow(clippy::too_many_arguments)]
+                    pub fn write(buf: &mut Vec<u8>, $($field: <$ty as Field>::Arg<'_>),*) {
+                        let start = buf.len();
+                        buf.resize(start + Self::FIXED_SIZE, 0);
+                        buf[start..start + $crate::flat::TAG_SIZE].copy_from_slice(&Self::TAG.to_le_bytes());
+                        let mut at = $crate::flat::TAG_SIZE;
+                        $(
+                            <$ty as Field>::write($field, buf, start, at);
+                            at += <$ty as Field>::SIZE;
+                        )*
+                        let _ = at;
+                    }
+
+                    $(
+                        #[inline]
+                        pub fn $field(&self) -> <$ty as Field>::Ref<'a> {
+                            const AT: usize = $crate::flat::offset(SIZES, Index::$field as usize);
+                            // Safety: the view's bytes were validated when it was created.
+                            unsafe { <$ty as Field>::read(self.bytes.bytes(), AT) }
+                        }
+                    )*
+                }
+            };
+        )*
+    };
+}
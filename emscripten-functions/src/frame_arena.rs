@@ -0,0 +1,257 @@
+//! A bump allocator for short-lived allocations, that the main loop set with [`set_main_loop_with_arg`] or [`set_main_loop`] frees at each tick.
+//!
+//! Allocating from a [`FrameArena`] is a pointer bump, and freeing its allocations is resetting it, which keeps its memory:
+//! once it reached the size a frame needs, temporary strings and buffers no longer go through the global allocator.
+//!
+//! Each thread has its own arena, accessed with [`with_frame_arena`]. Its allocations are freed once the outermost call returns;
+//! during a main loop tick, which runs in such a call, this means at the end of the tick.
+//!
+//! [`set_main_loop_with_arg`]: crate::emscripten::set_main_loop_with_arg
+//! [`set_main_loop`]: crate::emscripten::set_main_loop
+
+use std::{
+    alloc::{self, Layout},
+    cell::{Cell, UnsafeCell},
+    ffi::CStr,
+    ptr::NonNull,
+};
+
+// The alignment of the chunks, enough for the primitive types.
+const CHUNK_ALIGN: usize = 16;
+// The size of the first chunk of an arena, in bytes.
+const MIN_CHUNK_SIZE: usize = 4096;
+
+/// A bump allocator for values that don't need dropping.
+///
+/// Its allocations are borrowed from it, so they can't outlive a [`FrameArena::reset`].
+///
+/// # Examples
+/// ```rust
+/// let mut arena = FrameArena::new();
+/// loop {
+///     let positions = arena.alloc_slice_copy(&visible_positions());
+///     let label = arena.alloc_str(&format!("{} visible", positions.len()));
+///     draw(positions, label);
+///     arena.reset();
+/// }
+/// ```
+pub struct FrameArena {
+    // The start and size of each chunk; the allocations are bumped in the last one.
+    chunks: UnsafeCell<Vec<(NonNull<u8>, usize)>>,
+    // The offset of the free space in the last chunk.
+    used: Cell<usize>,
+    allocated: Cell<usize>,
+}
+
+impl FrameArena {
+    /// Creates an empty arena, that allocates its first chunk when first used.
+    pub const fn new() -> Self {
+        Self {
+            chunks: UnsafeCell::new(Vec::new()),
+            used: Cell::new(0),
+            allocated: Cell::new(0),
+        }
+    }
+
+    /// Creates an arena with a chunk of `capacity` bytes already allocated.
+    pub fn with_capacity(capacity: usize) -> Self {
+        let arena = Self::new();
+        if capacity > 0 {
+            arena.push_chunk(capacity);
+        }
+        arena
+    }
+
+    fn push_chunk(&self, size: usize) {
+        let layout = Layout::from_size_align(size, CHUNK_ALIGN).unwrap();
+        let ptr = NonNull::new(unsafe { alloc::alloc(layout) })
+            .unwrap_or_else(|| alloc::handle_alloc_error(layout));
+        unsafe { &mut *self.chunks.get() }.push((ptr, size));
+        self.used.set(0);
+    }
+
+    fn alloc_layout(&self, layout: Layout) -> NonNull<u8> {
+        if layout.size() == 0 {
+            return NonNull::new(layout.align() as *mut u8).unwrap();
+        }
+
+        if let Some(&(chunk, size)) = unsafe { &*self.chunks.get() }.last() {
+            let free = chunk.as_ptr().wrapping_add(self.used.get());
+            let start = self.used.get() + free.align_offset(layout.align());
+            if start + layout.size() <= size {
+                self.used.set(start + layout.size());
+                self.allocated.set(self.allocated.get() + layout.size());
+                return unsafe { NonNull::new_unchecked(chunk.as_ptr().add(start)) };
+            }
+        }
+
+        // The chunks double in size, so that a frame needs few of them.
+        let size = (layout.size() + layout.align())
+            .max(self.capacity() * 2)
+            .max(MIN_CHUNK_SIZE);
+        self.push_chunk(size);
+        self.alloc_layout(layout)
+    }
+
+    /// Moves `value` into the arena, and returns a reference to it.
+    // Each allocation is a distinct part of the arena, so the mutable references don't alias.
+    #[allow(clippy::mut_from_ref)]
+    pub fn alloc<T: Copy>(&self, value: T) -> &mut T {
+        let ptr = self.alloc_layout(Layout::new::<T>()).cast::<T>().as_ptr();
+        unsafe {
+            ptr.write(value);
+            &mut *ptr
+        }
+    }
+
+    /// Copies `values` into the arena, and returns a reference to the copy.
+    // Each allocation is a distinct part of the arena, so the mutable references don't alias.
+    #[allow(clippy::mut_from_ref)]
+    pub fn alloc_slice_copy<T: Copy>(&self, values: &[T]) -> &mut [T] {
+        let ptr = self
+            .alloc_layout(Layout::for_value(values))
+            .cast::<T>()
+            .as_ptr();
+        unsafe {
+            ptr.copy_from_nonoverlapping(values.as_ptr(), values.len());
+            std::slice::from_raw_parts_mut(ptr, values.len())
+        }
+    }
+
+    /// Copies `string` into the arena, and returns a reference to the copy.
+    // Each allocation is a distinct part of the arena, so the mutable references don't alias.
+    #[allow(clippy::mut_from_ref)]
+    pub fn alloc_str(&self, string: &str) -> &mut str {
+        let bytes = self.alloc_slice_copy(string.as_bytes());
+        unsafe { std::str::from_utf8_unchecked_mut(bytes) }
+    }
+
+    /// Copies `string` into the arena, NUL-terminated, to pass it to C functions.
+    ///
+    /// Like `CString::new(...).unwrap()`, it panics if `string` contains a NUL character.
+    pub fn alloc_c_str(&self, string: &str) -> &CStr {
+        let bytes = string.as_bytes();
+        assert!(
+            !bytes.contains(&0),
+            "the string passed to C must not contain NUL characters"
+        );
+
+        let ptr = self
+            .alloc_layout(Layout::array::<u8>(bytes.len() + 1).unwrap())
+            .as_ptr();
+        unsafe {
+            ptr.copy_from_nonoverlapping(bytes.as_ptr(), bytes.len());
+            ptr.add(bytes.len()).write(0);
+            CStr::from_bytes_with_nul_unchecked(std::slice::from_raw_parts(ptr, bytes.len() + 1))
+        }
+    }
+
+    /// Returns the number of bytes allocated since the last reset, without the alignment padding.
+    pub fn allocated(&self) -> usize {
+        self.allocated.get()
+    }
+
+    /// Returns the size of the memory held by the arena, in bytes.
+    pub fn capacity(&self) -> usize {
+        unsafe { &*self.chunks.get() }
+            .iter()
+            .map(|&(_, size)| size)
+            .sum()
+    }
+
+    /// Frees all the allocations, keeping the memory for the next ones.
+    pub fn reset(&mut self) {
+        unsafe { self.reset_unchecked() };
+    }
+
+    // Frees all the allocations. If they took several chunks, they're merged into one as big as them all,
+    // so that the next allocations are bumped in a single chunk.
+    //
+    // No reference to the allocations may be used after that.
+    unsafe fn reset_unchecked(&self) {
+        if (*self.chunks.get()).len() > 1 {
+            let capacity = self.capacity();
+            self.free_chunks();
+            self.push_chunk(capacity);
+        }
+        self.used.set(0);
+        self.allocated.set(0);
+    }
+
+    fn free_chunks(&self) {
+        for (ptr, size) in unsafe { &mut *self.chunks.get() }.drain(..) {
+            unsafe {
+                alloc::dealloc(
+                    ptr.as_ptr(),
+                    Layout::from_size_align_unchecked(size, CHUNK_ALIGN),
+                )
+            };
+        }
+    }
+}
+
+impl Default for FrameArena {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl Drop for FrameArena {
+    fn drop(&mut self) {
+        self.free_chunks();
+    }
+}
+
+thread_local! {
+    static FRAME_ARENA: FrameArena = const { FrameArena::new() };
+    // The number of `with_frame_arena` calls in progress on the thread.
+    static DEPTH: Cell<usize> = const { Cell::new(0) };
+}
+
+// Leaves a `with_frame_arena` call, resetting the arena when it's the outermost one, even on panic.
+struct Scope;
+
+impl Drop for Scope {
+    fn drop(&mut self) {
+        let depth = DEPTH.with(|depth| {
+            depth.set(depth.get() - 1);
+            depth.get()
+        });
+        if depth == 0 {
+            // The allocations were borrowed by the finished calls only.
+            FRAME_ARENA.with(|arena| unsafe { arena.reset_unchecked() });
+        }
+    }
+}
+
+/// Calls `func` with the calling thread's arena.
+///
+/// The allocations are freed once the outermost `with_frame_arena` call returns.
+/// The main loop ticks of [`set_main_loop_with_arg`] and [`set_main_loop`] run in such a call,
+/// so during a tick the allocations are freed at its end, and the arena's memory is reused by the next tick.
+///
+/// [`set_main_loop_with_arg`]: crate::emscripten::set_main_loop_with_arg
+/// [`set_main_loop`]: crate::emscripten::set_main_loop
+///
+/// # Examples
+/// ```rust
+/// set_main_loop(|| {
+///     with_frame_arena(|arena| {
+///         let title = arena.alloc_str(&format!("{} FPS", fps()));
+///         set_window_title(title);
+///     });
+/// }, 0, true);
+/// ```
+pub fn with_frame_arena<F, R>(func: F) -> R
+where
+    F: FnOnce(&FrameArena) -> R,
+{
+    DEPTH.with(|depth| depth.set(depth.get() + 1));
+    let _scope = Scope;
+    FRAME_ARENA.with(|arena| func(arena))
+}
+
+/// Returns the number of bytes allocated in the calling thread's arena since its last reset, and the size of the memory it holds.
+pub fn frame_arena_usage() -> (usize, usize) {
+    FRAME_ARENA.with(|arena| (arena.allocated(), arena.capacity()))
+}
@@ -0,0 +1,243 @@
+//! A futex-based barrier synchronizing worker threads with the frames of the main loop,
+//! so that the workers do their share of each frame's work in parallel, and finish before it's presented.
+//!
+//! The main loop starts each frame with [`FrameBarrier::begin_frame`], which wakes the workers up, and waits for them with
+//! [`FrameBarrier::wait_workers`] before presenting it; [`FrameBarrier::run_frame`] does both around the main thread's own share.
+//! Each worker thread waits for the next frame with [`FrameParticipant::wait_frame`], and reports its share done with
+//! [`FrameParticipant::done`]. The waits sleep on futexes: the workers don't poll flags to find the frame boundaries.
+//!
+//! The wait on the main browser thread is a busy wait, like all the futex waits there, so the workers' shares should fit in the frame.
+//!
+//! The program must be built with `-pthread`.
+
+use std::{
+    os::raw::c_int,
+    sync::{
+        atomic::{AtomicBool, AtomicU32, Ordering},
+        Arc,
+    },
+    thread::JoinHandle,
+};
+
+use crate::{
+    emscripten::get_now,
+    sync::Mutex,
+    threading::{futex_wait, futex_wake},
+};
+
+// The bits of `Shared::remaining` holding the count: the others hold the frame tag.
+const REMAINING_MASK: u32 = 0xffff;
+
+// The `Shared::remaining` value of a frame whose `remaining` participants didn't finish yet.
+fn tagged_remaining(frame: u32, remaining: u32) -> u32 {
+    (frame << 16) | remaining
+}
+
+struct Shared {
+    // The number of the current frame, waited on by the workers.
+    frame: AtomicU32,
+    // The number of workers that didn't finish the current frame, in the low half, tagged with the low half of that frame's number
+    // in the high half, so that a late report of an earlier frame isn't counted for the current one. Waited on by the main thread.
+    remaining: AtomicU32,
+    shutdown: AtomicBool,
+    // The number of participants. Changed under the lock, along with `remaining`, so that the frames count the workers consistently.
+    participants: Mutex<u32>,
+}
+
+/// A barrier between the main loop and the workers taking part in its frames. See the [module documentation](self).
+///
+/// Dropping it shuts it down: the workers waiting for a frame get `None`.
+///
+/// # Examples
+/// ```rust
+/// let barrier = FrameBarrier::new();
+/// for slice in 0..4 {
+///     barrier.spawn_worker(move |frame| animate_skeletons(slice, frame));
+/// }
+///
+/// set_main_loop(
+///     move || {
+///         barrier.run_frame(|frame| update_particles(frame));
+///         present();
+///     },
+///     0,
+///     true,
+/// );
+/// ```
+pub struct FrameBarrier {
+    shared: Arc<Shared>,
+}
+
+/// A worker's membership of a [`FrameBarrier`], created with [`FrameBarrier::join`]. Dropping it leaves the barrier.
+pub struct FrameParticipant {
+    shared: Arc<Shared>,
+    // The last frame it waited for, and the last one it finished.
+    seen: u32,
+    finished: u32,
+}
+
+impl Default for FrameBarrier {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl FrameBarrier {
+    /// Creates a barrier with no participants.
+    pub fn new() -> Self {
+        Self {
+            shared: Arc::new(Shared {
+                frame: AtomicU32::new(0),
+                remaining: AtomicU32::new(0),
+                shutdown: AtomicBool::new(false),
+                participants: Mutex::new(0),
+            }),
+        }
+    }
+
+    /// Adds a participant, which takes part in the frames started after this call.
+    ///
+    /// # Panics
+    /// If the barrier already has 65535 participants.
+    pub fn join(&self) -> FrameParticipant {
+        let mut participants = self.shared.participants.lock();
+        assert!(
+            *participants < REMAINING_MASK,
+            "a frame barrier has at most 65535 participants"
+        );
+        *participants += 1;
+        let frame = self.shared.frame.load(Ordering::Acquire);
+        FrameParticipant {
+            shared: self.shared.clone(),
+            seen: frame,
+            finished: frame,
+        }
+    }
+
+    /// Spawns a thread taking part in the frames, calling `func` with the number of each frame. It returns once the barrier is dropped.
+    pub fn spawn_worker<F>(&self, mut func: F) -> JoinHandle<()>
+    where
+        F: 'static + Send + FnMut(u32),
+    {
+        let mut participant = self.join();
+        std::thread::spawn(move || {
+            while let Some(frame) = participant.wait_frame() {
+                func(frame);
+                participant.done();
+            }
+        })
+    }
+
+    /// Returns the number of participants.
+    pub fn participants(&self) -> u32 {
+        *self.shared.participants.lock()
+    }
+
+    /// Starts a frame, waking the participants up, and returns its number.
+    /// The frame should be waited for with [`wait_workers`](Self::wait_workers) before starting the next one:
+    /// the participants still busy with an earlier frame then take part in the next frame they wait for,
+    /// and their reports of the earlier one aren't counted for the current one.
+    pub fn begin_frame(&self) -> u32 {
+        let participants = self.shared.participants.lock();
+        let frame = self.shared.frame.load(Ordering::Relaxed).wrapping_add(1);
+        self.shared
+            .remaining
+            .store(tagged_remaining(frame, *participants), Ordering::Release);
+        self.shared.frame.store(frame, Ordering::Release);
+        futex_wake(&self.shared.frame, c_int::MAX);
+        frame
+    }
+
+    /// Waits until the participants finished the current frame, for at most `timeout_ms` milliseconds.
+    /// It returns `false` if they didn't finish in time.
+    pub fn wait_workers(&self, timeout_ms: f64) -> bool {
+        let deadline = get_now() + timeout_ms;
+        loop {
+            let remaining = self.shared.remaining.load(Ordering::Acquire);
+            if remaining & REMAINING_MASK == 0 {
+                return true;
+            }
+            let left = deadline - get_now();
+            if left <= 0.0 {
+                return false;
+            }
+            let _ = futex_wait(&self.shared.remaining, remaining, left);
+        }
+    }
+
+    /// Starts a frame, runs `func`, the calling thread's share of its work, with its number,
+    /// and then waits until the participants finished it.
+    pub fn run_frame<F>(&self, func: F)
+    where
+        F: FnOnce(u32),
+    {
+        let frame = self.begin_frame();
+        func(frame);
+        self.wait_workers(f64::INFINITY);
+    }
+}
+
+impl Drop for FrameBarrier {
+    fn drop(&mut self) {
+        self.shared.shutdown.store(true, Ordering::Release);
+        // Changes the waited value, so that a participant about to wait doesn't miss the wakeup.
+        self.shared.frame.fetch_add(1, Ordering::AcqRel);
+        futex_wake(&self.shared.frame, c_int::MAX);
+    }
+}
+
+impl FrameParticipant {
+    /// Waits until the next frame starts, and returns its number, or `None` once the barrier is dropped.
+    ///
+    /// The previous frame should be reported with [`done`](Self::done) first; otherwise it's reported here.
+    pub fn wait_frame(&mut self) -> Option<u32> {
+        self.done();
+        loop {
+            let frame = self.shared.frame.load(Ordering::Acquire);
+            if self.shared.shutdown.load(Ordering::Acquire) {
+                return None;
+            }
+            if frame != self.seen {
+                self.seen = frame;
+                return Some(frame);
+            }
+            let _ = futex_wait(&self.shared.frame, frame, f64::INFINITY);
+        }
+    }
+
+    /// Reports the participant's share of the frame it last waited for as done.
+    /// It does nothing if it was already reported, or if a later frame started since.
+    pub fn done(&mut self) {
+        if self.finished == self.seen {
+            return;
+        }
+        self.finished = self.seen;
+
+        // The count is only decremented while it's tagged with the reported frame.
+        let reported =
+            self.shared
+                .remaining
+                .fetch_update(Ordering::AcqRel, Ordering::Acquire, |remaining| {
+                    let count = remaining & REMAINING_MASK;
+                    (count != 0 && remaining == tagged_remaining(self.seen, count))
+                        .then(|| remaining - 1)
+                });
+        if reported.is_ok_and(|remaining| remaining & REMAINING_MASK == 1) {
+            futex_wake(&self.shared.remaining, 1);
+        }
+    }
+}
+
+impl Drop for FrameParticipant {
+    fn drop(&mut self) {
+        let shared = self.shared.clone();
+        let mut participants = shared.participants.lock();
+        *participants -= 1;
+        // A frame started since it last waited counts it too.
+        let frame = self.shared.frame.load(Ordering::Acquire);
+        if frame != self.finished {
+            self.seen = frame;
+            self.done();
+        }
+    }
+}
@@ -0,0 +1,269 @@
+//! A pipeline simulating the next frame on a [Wasm Worker](crate::wasm_worker) while the main loop renders the current one,
+//! handing the frames over through a lock-free triple buffer.
+//!
+//! A tick that simulates and then renders takes the sum of both. With a [`FramePipeline`], the simulation of frame N+1
+//! runs on a worker while the main thread renders the snapshot of frame N, so a tick only takes the longest of the two.
+//! The renderer draws the newest finished snapshot, a frame behind the simulation: this adds a frame of latency.
+//!
+//! The [`triple_buffer`] the pipeline uses is also usable on its own: the writer always has a buffer to write to, and the reader
+//! always has the newest complete one, without either of them waiting for the other.
+//!
+//! The program must be built with `-sWASM_WORKERS`.
+
+use std::{
+    cell::UnsafeCell,
+    os::raw::c_int,
+    sync::{
+        atomic::{AtomicBool, AtomicU32, Ordering},
+        Arc,
+    },
+};
+
+use crate::{
+    emscripten::set_main_loop_with_arg,
+    threading::{futex_wait, futex_wake},
+    wasm_worker::{self, WasmWorker, WasmWorkerSpawnError},
+};
+
+// The bit of `middle` set when its buffer was published and not read yet.
+const FRESH: u32 = 4;
+const INDEX_MASK: u32 = 3;
+
+// Each buffer is owned by one side at a time: `back` by the writer, `front` by the reader, and the one in `middle` by neither.
+struct TripleBufferShared<T> {
+    buffers: [UnsafeCell<T>; 3],
+    middle: AtomicU32,
+}
+
+unsafe impl<T: Send> Sync for TripleBufferShared<T> {}
+unsafe impl<T: Send> Send for TripleBufferShared<T> {}
+
+/// The writing side of a [`triple_buffer`].
+pub struct SnapshotWriter<T> {
+    shared: Arc<TripleBufferShared<T>>,
+    back: u32,
+}
+
+/// The reading side of a [`triple_buffer`].
+pub struct SnapshotReader<T> {
+    shared: Arc<TripleBufferShared<T>>,
+    front: u32,
+}
+
+/// Creates a lock-free triple buffer, whose three buffers start as clones of `initial`, for handing snapshots from one thread to another.
+///
+/// The writer fills its back buffer and publishes it; the reader reads the newest published buffer.
+/// The snapshots published before the reader got to them are skipped.
+///
+/// # Examples
+/// ```rust
+/// let (mut writer, mut reader) = triple_buffer(Positions::default());
+///
+/// // On the simulation thread.
+/// writer.back_mut().fill_from(&world);
+/// writer.publish();
+///
+/// // On the render thread.
+/// draw(reader.read());
+/// ```
+pub fn triple_buffer<T>(initial: T) -> (SnapshotWriter<T>, SnapshotReader<T>)
+where
+    T: Clone + Send,
+{
+    let shared = Arc::new(TripleBufferShared {
+        buffers: [
+            UnsafeCell::new(initial.clone()),
+            UnsafeCell::new(initial.clone()),
+            UnsafeCell::new(initial),
+        ],
+        middle: AtomicU32::new(1),
+    });
+    (
+        SnapshotWriter {
+            shared: shared.clone(),
+            back: 0,
+        },
+        SnapshotReader { shared, front: 2 },
+    )
+}
+
+impl<T> SnapshotWriter<T> {
+    /// Returns the back buffer, to fill with the next snapshot.
+    /// It holds an older snapshot, not necessarily the last published one, so it should be overwritten completely.
+    pub fn back_mut(&mut self) -> &mut T {
+        unsafe { &mut *self.shared.buffers[self.back as usize].get() }
+    }
+
+    /// Publishes the back buffer as the newest snapshot, and takes another one as the back buffer.
+    pub fn publish(&mut self) {
+        let previous = self.shared.middle.swap(self.back | FRESH, Ordering::AcqRel);
+        self.back = previous & INDEX_MASK;
+    }
+}
+
+impl<T> SnapshotReader<T> {
+    /// Returns `true` if a snapshot was published since the last [`read`](Self::read).
+    pub fn has_new(&self) -> bool {
+        self.shared.middle.load(Ordering::Acquire) & FRESH != 0
+    }
+
+    /// Returns the newest published snapshot, or the last one read if none was published since.
+    pub fn read(&mut self) -> &T {
+        if self.has_new() {
+            let previous = self.shared.middle.swap(self.front, Ordering::AcqRel);
+            self.front = previous & INDEX_MASK;
+        }
+        unsafe { &*self.shared.buffers[self.front as usize].get() }
+    }
+}
+
+/// The stack size of the simulation worker used by [`FramePipeline::spawn`], in bytes.
+pub const DEFAULT_STACK_SIZE: usize = 256 * 1024;
+
+struct Control {
+    // The number of frames requested by the render side, and the number of the last one simulated.
+    requested: AtomicU32,
+    simulated: AtomicU32,
+    shutdown: AtomicBool,
+}
+
+/// A simulation running on a Wasm Worker, a frame ahead of the rendering on the calling thread. See the [module documentation](self).
+///
+/// Each [`tick`](Self::tick) asks the worker to simulate the next frame, then renders the newest finished one.
+/// A worker lagging behind doesn't queue frames up: it simulates one frame at a time, for the latest request, and the renderer
+/// draws the same snapshot again meanwhile.
+///
+/// Dropping the pipeline stops the worker after the frame it's simulating.
+///
+/// # Examples
+/// ```rust
+/// let pipeline = FramePipeline::spawn(
+///     World::new(),
+///     RenderState::default(),
+///     |world, snapshot| {
+///         world.step(1.0 / 60.0);
+///         snapshot.copy_from(world);
+///     },
+/// )
+/// .unwrap();
+/// pipeline.run(|snapshot| renderer.draw(snapshot), 0, true);
+/// ```
+pub struct FramePipeline<T> {
+    reader: SnapshotReader<T>,
+    control: Arc<Control>,
+    worker: WasmWorker,
+}
+
+impl<T> FramePipeline<T>
+where
+    T: 'static + Clone + Send,
+{
+    /// Spawns the simulation worker, with a stack of [`DEFAULT_STACK_SIZE`] bytes. See [`spawn_with_stack_size`](Self::spawn_with_stack_size).
+    pub fn spawn<S, F>(state: S, snapshot: T, simulate: F) -> Result<Self, WasmWorkerSpawnError>
+    where
+        S: 'static + Send,
+        F: 'static + Send + FnMut(&mut S, &mut T),
+    {
+        Self::spawn_with_stack_size(DEFAULT_STACK_SIZE, state, snapshot, simulate)
+    }
+
+    /// Spawns the simulation worker, with a stack of `stack_size` bytes.
+    ///
+    /// # Arguments
+    /// * `stack_size` - The stack size of the worker, in bytes.
+    /// * `state` - The simulation state, moved to the worker.
+    /// * `snapshot` - The initial snapshot, rendered until the first frame is simulated.
+    /// * `simulate` - The function simulating a frame on the worker, which then writes what the renderer needs into the snapshot.
+    ///   The snapshot it gets holds an older frame, so it should be overwritten completely.
+    pub fn spawn_with_stack_size<S, F>(
+        stack_size: usize,
+        mut state: S,
+        snapshot: T,
+        mut simulate: F,
+    ) -> Result<Self, WasmWorkerSpawnError>
+    where
+        S: 'static + Send,
+        F: 'static + Send + FnMut(&mut S, &mut T),
+    {
+        let (mut writer, reader) = triple_buffer(snapshot);
+        let control = Arc::new(Control {
+            requested: AtomicU32::new(0),
+            simulated: AtomicU32::new(0),
+            shutdown: AtomicBool::new(false),
+        });
+
+        let worker_control = control.clone();
+        let worker = wasm_worker::spawn(stack_size, move || {
+            let control = worker_control;
+            loop {
+                let requested = control.requested.load(Ordering::Acquire);
+                if control.shutdown.load(Ordering::Acquire) {
+                    break;
+                }
+                if requested == control.simulated.load(Ordering::Relaxed) {
+                    let _ = futex_wait(&control.requested, requested, f64::INFINITY);
+                    continue;
+                }
+                simulate(&mut state, writer.back_mut());
+                writer.publish();
+                control.simulated.store(requested, Ordering::Release);
+            }
+        })?;
+
+        Ok(Self {
+            reader,
+            control,
+            worker,
+        })
+    }
+
+    /// Asks the worker to simulate the next frame, then renders the newest finished snapshot with `render`.
+    pub fn tick<R>(&mut self, render: R)
+    where
+        R: FnOnce(&T),
+    {
+        self.control.requested.fetch_add(1, Ordering::Release);
+        futex_wake(&self.control.requested, 1);
+        render(self.reader.read());
+    }
+
+    /// Returns the number of frames the worker simulated.
+    pub fn simulated_frames(&self) -> u32 {
+        self.control.simulated.load(Ordering::Acquire)
+    }
+
+    /// Returns the simulation worker.
+    pub fn worker(&self) -> WasmWorker {
+        self.worker
+    }
+
+    /// Sets the pipeline as the main loop of the calling thread, using [`set_main_loop_with_arg`], rendering with `render` on each tick.
+    ///
+    /// # Arguments
+    /// * `render` - The function rendering a snapshot.
+    /// * `fps` - The number of ticks per second.
+    ///   If set to a value <= 0, the browser's [`requestAnimationFrame()`] function will be used instead of a fixed rate.
+    /// * `simulate_infinite_loop` - If `true`, no code after the function call will be executed, otherwise the code after the function call will be executed.
+    ///
+    /// [`requestAnimationFrame()`]: https://developer.mozilla.org/en-US/docs/Web/API/window/requestAnimationFrame
+    pub fn run<R>(self, mut render: R, fps: c_int, simulate_infinite_loop: bool)
+    where
+        R: 'static + FnMut(&T),
+    {
+        set_main_loop_with_arg(
+            move |pipeline: &mut Self| pipeline.tick(&mut render),
+            self,
+            fps,
+            simulate_infinite_loop,
+        );
+    }
+}
+
+impl<T> Drop for FramePipeline<T> {
+    fn drop(&mut self) {
+        self.control.shutdown.store(true, Ordering::Release);
+        // Changes the waited value, so that a worker about to wait doesn't miss the wakeup.
+        self.control.requested.fetch_add(1, Ordering::Release);
+        futex_wake(&self.control.requested, 1);
+    }
+}
@@ -0,0 +1,293 @@
+//! A scheduler of the systems run by a main loop tick, in ordered phases, with per-system time budgets, built on [`set_main_loop_with_arg`].
+//!
+//! An app's tick usually calls its input handling, simulation, rendering and bookkeeping code one after the other.
+//! A [`FrameScheduler`] holds these as [`System`]s: each one sits in a [`Phase`], and the systems of a phase run by decreasing priority.
+//! Each system's run time is measured with [`get_now`] and compared to its budget, and the [`SystemStats`] tell which ones are slow.
+//!
+//! With a frame budget set, a deferrable system (e.g. a minimap redraw, or streaming) is skipped when the time left in the frame
+//! is less than its budget, and runs the next frame instead, before it can be deferred again.
+//!
+//! [`set_main_loop_with_arg`]: crate::emscripten::set_main_loop_with_arg
+
+use std::os::raw::c_int;
+
+use crate::emscripten::{get_now, set_main_loop_with_arg};
+
+/// The phase of the tick a [`System`] runs in. The phases run in this order.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash)]
+pub enum Phase {
+    /// Reading the input of the frame.
+    Input,
+    /// Updating the state, e.g. the simulation.
+    Update,
+    /// Drawing the frame.
+    Render,
+    /// The work after the frame was drawn, e.g. saving or sending metrics.
+    Late,
+}
+
+/// The identifier of a system added to a [`FrameScheduler`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct SystemId(u32);
+
+/// A system to add to a [`FrameScheduler`], with its phase, priority and budget.
+///
+/// # Examples
+/// ```rust
+/// scheduler.add_system(
+///     System::new("minimap", Phase::Render, |game: &mut Game| game.draw_minimap())
+///         .budget(1.0)
+///         .deferrable(true),
+/// );
+/// ```
+pub struct System<T> {
+    name: &'static str,
+    phase: Phase,
+    priority: i32,
+    budget: f64,
+    deferrable: bool,
+    func: Box<dyn FnMut(&mut T)>,
+}
+
+impl<T> System<T> {
+    /// Creates a system of the given phase, with a priority of 0, no budget, and not deferrable.
+    ///
+    /// # Arguments
+    /// * `name` - The name of the system, for its [`SystemStats`].
+    /// * `phase` - The phase of the tick the system runs in.
+    /// * `func` - The function of the system, called with the state of the scheduler.
+    pub fn new<F>(name: &'static str, phase: Phase, func: F) -> Self
+    where
+        F: 'static + FnMut(&mut T),
+    {
+        Self {
+            name,
+            phase,
+            priority: 0,
+            budget: f64::INFINITY,
+            deferrable: false,
+            func: Box::new(func),
+        }
+    }
+
+    /// Sets the priority of the system: the systems of a phase run by decreasing priority, then in the order they were added.
+    pub fn priority(mut self, priority: i32) -> Self {
+        self.priority = priority;
+        self
+    }
+
+    /// Sets the time the system is expected to take, in milliseconds. The runs taking longer are counted as overruns.
+    pub fn budget(mut self, budget: f64) -> Self {
+        self.budget = budget;
+        self
+    }
+
+    /// Sets whether the system can be deferred to the next frame, when the time left in the frame budget is less than its budget.
+    pub fn deferrable(mut self, deferrable: bool) -> Self {
+        self.deferrable = deferrable;
+        self
+    }
+}
+
+/// The run times of a system, in milliseconds, returned by [`FrameScheduler::stats`].
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct SystemStats {
+    /// The name of the system.
+    pub name: &'static str,
+    /// The phase of the system.
+    pub phase: Phase,
+    /// The duration of its last run.
+    pub last: f64,
+    /// The exponential moving average of its run durations, over about the last 32 runs.
+    pub average: f64,
+    /// The longest of its runs.
+    pub max: f64,
+    /// The number of runs that took longer than its budget.
+    pub overruns: u64,
+    /// The number of frames it was deferred from.
+    pub deferrals: u64,
+    /// The number of times it ran.
+    pub runs: u64,
+}
+
+// The weight of the last run in the moving average.
+const AVERAGE_WEIGHT: f64 = 1.0 / 32.0;
+
+struct Entry<T> {
+    id: SystemId,
+    system: System<T>,
+    enabled: bool,
+    // Set when it was deferred from the last frame, so it isn't deferred again.
+    deferred: bool,
+    stats: SystemStats,
+}
+
+/// An ordered set of systems run together on each tick. See the [module documentation](self).
+///
+/// # Examples
+/// ```rust
+/// let mut scheduler = FrameScheduler::new();
+/// scheduler.set_frame_budget(Some(12.0));
+/// scheduler.add_system(System::new("input", Phase::Input, Game::poll_input));
+/// scheduler.add_system(System::new("physics", Phase::Update, Game::step_physics).priority(10));
+/// scheduler.add_system(System::new("ai", Phase::Update, Game::think).budget(2.0).deferrable(true));
+/// scheduler.add_system(System::new("draw", Phase::Render, Game::draw));
+/// scheduler.run(Game::new(), 0, true);
+/// ```
+pub struct FrameScheduler<T> {
+    // Sorted by phase, then by decreasing priority, then by insertion.
+    entries: Vec<Entry<T>>,
+    next_id: u32,
+    frame_budget: Option<f64>,
+}
+
+impl<T> Default for FrameScheduler<T> {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl<T> FrameScheduler<T> {
+    /// Creates a scheduler with no systems and no frame budget.
+    pub fn new() -> Self {
+        Self {
+            entries: Vec::new(),
+            next_id: 0,
+            frame_budget: None,
+        }
+    }
+
+    /// Sets the time the systems of a tick should take together, in milliseconds, past which the deferrable systems are deferred.
+    /// With `None`, the default, no system is deferred.
+    pub fn set_frame_budget(&mut self, budget: Option<f64>) {
+        self.frame_budget = budget;
+    }
+
+    /// Adds the given system, and returns its identifier.
+    pub fn add_system(&mut self, system: System<T>) -> SystemId {
+        let id = SystemId(self.next_id);
+        self.next_id += 1;
+
+        let position = self.entries.partition_point(|entry| {
+            (entry.system.phase, -entry.system.priority) <= (system.phase, -system.priority)
+        });
+        let stats = SystemStats {
+            name: system.name,
+            phase: system.phase,
+            last: 0.0,
+            average: 0.0,
+            max: 0.0,
+            overruns: 0,
+            deferrals: 0,
+            runs: 0,
+        };
+        self.entries.insert(
+            position,
+            Entry {
+                id,
+                system,
+                enabled: true,
+                deferred: false,
+                stats,
+            },
+        );
+        id
+    }
+
+    /// Removes the given system. It returns `false` if there's no such system.
+    pub fn remove_system(&mut self, id: SystemId) -> bool {
+        let len = self.entries.len();
+        self.entries.retain(|entry| entry.id != id);
+        self.entries.len() != len
+    }
+
+    /// Enables or disables the given system; the disabled systems don't run, and keep their stats.
+    /// It returns `false` if there's no such system.
+    pub fn set_enabled(&mut self, id: SystemId, enabled: bool) -> bool {
+        match self.entries.iter_mut().find(|entry| entry.id == id) {
+            Some(entry) => {
+                entry.enabled = enabled;
+                true
+            }
+            None => false,
+        }
+    }
+
+    /// Returns the stats of the given system, or `None` if there's no such system.
+    pub fn system_stats(&self, id: SystemId) -> Option<SystemStats> {
+        self.entries
+            .iter()
+            .find(|entry| entry.id == id)
+            .map(|entry| entry.stats)
+    }
+
+    /// Returns the stats of the systems, in the order they run.
+    pub fn stats(&self) -> impl Iterator<Item = SystemStats> + '_ {
+        self.entries.iter().map(|entry| entry.stats)
+    }
+
+    /// Runs the enabled systems once, in order, with the given state, deferring the deferrable ones that don't fit in the frame budget.
+    pub fn tick(&mut self, state: &mut T) {
+        let frame_start = get_now();
+
+        for entry in &mut self.entries {
+            if !entry.enabled {
+                continue;
+            }
+            let start = get_now();
+
+            if let Some(frame_budget) = self.frame_budget {
+                let left = frame_budget - (start - frame_start);
+                if entry.system.deferrable && !entry.deferred && left < entry.system.budget {
+                    entry.deferred = true;
+                    entry.stats.deferrals += 1;
+                    continue;
+                }
+            }
+            entry.deferred = false;
+
+            (entry.system.func)(state);
+
+            let duration = get_now() - start;
+            let stats = &mut entry.stats;
+            stats.average = if stats.runs == 0 {
+                duration
+            } else {
+                stats.average + (duration - stats.average) * AVERAGE_WEIGHT
+            };
+            stats.last = duration;
+            stats.max = stats.max.max(duration);
+            stats.runs += 1;
+            if duration > entry.system.budget {
+                stats.overruns += 1;
+            }
+        }
+    }
+
+    /// Sets the scheduler as the main loop of the calling thread, using [`set_main_loop_with_arg`], ticking it with the given state.
+    ///
+    /// The systems can't be changed once it runs; a system that needs to, e.g. to add a level's systems, can
+    /// replace the main loop with another scheduler with [`replace_main_loop_with_arg`].
+    ///
+    /// [`set_main_loop_with_arg`]: crate::emscripten::set_main_loop_with_arg
+    /// [`replace_main_loop_with_arg`]: crate::emscripten::replace_main_loop_with_arg
+    ///
+    /// # Arguments
+    /// * `state` - The state the systems interact with. It will be consumed so that it can be kept alive during the loop.
+    /// * `fps` - The number of ticks per second.
+    ///   If set to a value <= 0, the browser's [`requestAnimationFrame()`] function will be used instead of a fixed rate.
+    /// * `simulate_infinite_loop` - If `true`, no code after the function call will be executed, otherwise the code after the function call will be executed.
+    ///
+    /// [`requestAnimationFrame()`]: https://developer.mozilla.org/en-US/docs/Web/API/window/requestAnimationFrame
+    pub fn run(self, state: T, fps: c_int, simulate_infinite_loop: bool)
+    where
+        T: 'static,
+    {
+        set_main_loop_with_arg(
+            |(scheduler, state): &mut (Self, T)| scheduler.tick(state),
+            (self, state),
+            fps,
+            simulate_infinite_loop,
+        );
+    }
+}
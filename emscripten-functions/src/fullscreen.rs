@@ -0,0 +1,222 @@
+//! A builder of emscripten's fullscreen strategies, for the real fullscreen mode and the "soft" one, which fills the browser window.
+//!
+//! Emscripten's default resizes the canvas' drawing buffer to the screen's size in device pixels, which quadruples the pixels
+//! to draw per frame when going fullscreen on a 4K monitor. [`FullscreenStrategy::new`] defaults instead to a strategy favouring
+//! the frame rate: the drawing buffer keeps its size, and the browser's compositor upscales it to the screen, keeping the aspect ratio.
+//!
+//! The renderer learns about the new drawing buffer sizes in the callback set with [`FullscreenStrategy::on_resize`].
+
+use std::{
+    cell::RefCell,
+    os::raw::{c_int, c_void},
+    rc::Rc,
+};
+
+use emscripten_functions_sys::html5;
+
+use crate::{
+    c_str::with_c_str,
+    html5::{get_canvas_element_size, invalidate_canvas_sizes, Html5Error, Target},
+};
+
+/// How the canvas fills the screen.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum FullscreenScale {
+    /// The browser's default: the canvas keeps its CSS size.
+    Default,
+    /// The canvas is stretched to the whole screen, changing its aspect ratio.
+    Stretch,
+    /// The canvas is scaled to fit the screen, keeping its aspect ratio, with black bars if needed.
+    Aspect,
+    /// The canvas keeps its size, centered in the screen.
+    Center,
+}
+
+/// How the canvas' drawing buffer is resized for the fullscreen mode.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum CanvasResolution {
+    /// The drawing buffer keeps its size, and the browser upscales it to the displayed size.
+    Unchanged,
+    /// The drawing buffer is resized to the displayed size in CSS pixels: a half of the device pixels' width on a 2x screen.
+    CssPixels,
+    /// The drawing buffer is resized to the displayed size in device pixels.
+    DevicePixels,
+}
+
+/// How the browser filters the canvas when it upscales it.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum FullscreenFiltering {
+    /// The browser's default, usually bilinear.
+    Default,
+    /// Nearest-neighbour filtering, for crisp pixel art.
+    Nearest,
+    /// Bilinear filtering.
+    Bilinear,
+}
+
+type OnResize = Rc<RefCell<dyn FnMut(i32, i32)>>;
+
+thread_local! {
+    // The canvas in fullscreen, and the callback of its strategy, which emscripten calls until the fullscreen mode is exited.
+    static ACTIVE: RefCell<Option<(Target, OnResize)>> = const { RefCell::new(None) };
+}
+
+unsafe extern "C" fn resized(
+    _event_type: c_int,
+    _reserved: *const c_void,
+    _user_data: *mut c_void,
+) -> c_int {
+    invalidate_canvas_sizes();
+    let active = ACTIVE.with(|active| active.borrow().clone());
+    if let Some((target, onresize)) = active {
+        if let Ok((width, height)) = get_canvas_element_size(target) {
+            (onresize.borrow_mut())(width, height);
+        }
+    }
+    0
+}
+
+/// Sets up a fullscreen strategy, and enters the fullscreen mode with it.
+///
+/// # Examples
+/// ```rust
+/// let _click = on_click(EventTarget::Selector("#canvas"), false, |_| {
+///     FullscreenStrategy::new()
+///         .on_resize(|width, height| renderer.resize(width, height))
+///         .request("#canvas", false)
+///         .unwrap();
+///     true
+/// });
+/// ```
+#[derive(Clone)]
+pub struct FullscreenStrategy {
+    scale: FullscreenScale,
+    resolution: CanvasResolution,
+    filtering: FullscreenFiltering,
+    onresize: Option<OnResize>,
+}
+
+impl Default for FullscreenStrategy {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl FullscreenStrategy {
+    /// Starts from a strategy favouring the frame rate: the canvas fills the screen keeping its aspect ratio,
+    /// and its drawing buffer keeps its size, upscaled with bilinear filtering.
+    pub fn new() -> Self {
+        Self {
+            scale: FullscreenScale::Aspect,
+            resolution: CanvasResolution::Unchanged,
+            filtering: FullscreenFiltering::Bilinear,
+            onresize: None,
+        }
+    }
+
+    /// Sets how the canvas fills the screen.
+    pub fn scale(&mut self, scale: FullscreenScale) -> &mut Self {
+        self.scale = scale;
+        self
+    }
+
+    /// Sets how the canvas' drawing buffer is resized.
+    pub fn resolution(&mut self, resolution: CanvasResolution) -> &mut Self {
+        self.resolution = resolution;
+        self
+    }
+
+    /// Sets how the browser filters the upscaled canvas.
+    pub fn filtering(&mut self, filtering: FullscreenFiltering) -> &mut Self {
+        self.filtering = filtering;
+        self
+    }
+
+    /// Sets the function called with the canvas' drawing buffer width and height after emscripten resized it,
+    /// when entering or exiting the fullscreen mode, or when the window is resized in it.
+    pub fn on_resize<F>(&mut self, onresize: F) -> &mut Self
+    where
+        F: 'static + FnMut(i32, i32),
+    {
+        self.onresize = Some(Rc::new(RefCell::new(onresize)));
+        self
+    }
+
+    /// Requests the fullscreen mode for the target canvas, using the emscripten-defined [`emscripten_request_fullscreen_strategy`].
+    ///
+    /// Browsers only enter the fullscreen mode from the handler of a user gesture, like a click or a key press.
+    ///
+    /// [`emscripten_request_fullscreen_strategy`]: https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_request_fullscreen_strategy
+    ///
+    /// # Arguments
+    /// * `target` - The CSS selector of the canvas.
+    /// * `defer_until_in_event_handler` - Whether to defer the request to the next user gesture's handler if it's not made in one,
+    ///   instead of failing.
+    pub fn request(
+        &self,
+        target: &str,
+        defer_until_in_event_handler: bool,
+    ) -> Result<(), Html5Error> {
+        let strategy = self.activate(target);
+        Html5Error::check(with_c_str(target, |target| unsafe {
+            html5::emscripten_request_fullscreen_strategy(
+                target,
+                defer_until_in_event_handler as c_int,
+                &strategy,
+            )
+        }))
+    }
+
+    /// Enters the soft fullscreen mode, where the target canvas fills the browser window,
+    /// using the emscripten-defined [`emscripten_enter_soft_fullscreen`]. It doesn't need a user gesture.
+    ///
+    /// [`emscripten_enter_soft_fullscreen`]: https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_enter_soft_fullscreen
+    pub fn enter_soft(&self, target: &str) -> Result<(), Html5Error> {
+        let strategy = self.activate(target);
+        Html5Error::check(with_c_str(target, |target| unsafe {
+            html5::emscripten_enter_soft_fullscreen(target, &strategy)
+        }))
+    }
+
+    // Makes the callback the active one, and returns the strategy to give emscripten.
+    fn activate(&self, target: &str) -> html5::EmscriptenFullscreenStrategy {
+        let target = Target::selector(target);
+        ACTIVE.with(|active| {
+            *active.borrow_mut() = self.onresize.clone().map(|onresize| (target, onresize));
+        });
+
+        html5::EmscriptenFullscreenStrategy {
+            scaleMode: match self.scale {
+                FullscreenScale::Default => html5::EMSCRIPTEN_FULLSCREEN_SCALE_DEFAULT,
+                FullscreenScale::Stretch => html5::EMSCRIPTEN_FULLSCREEN_SCALE_STRETCH,
+                FullscreenScale::Aspect => html5::EMSCRIPTEN_FULLSCREEN_SCALE_ASPECT,
+                FullscreenScale::Center => html5::EMSCRIPTEN_FULLSCREEN_SCALE_CENTER,
+            } as c_int,
+            canvasResolutionScaleMode: match self.resolution {
+                CanvasResolution::Unchanged => html5::EMSCRIPTEN_FULLSCREEN_CANVAS_SCALE_NONE,
+                CanvasResolution::CssPixels => html5::EMSCRIPTEN_FULLSCREEN_CANVAS_SCALE_STDDEF,
+                CanvasResolution::DevicePixels => html5::EMSCRIPTEN_FULLSCREEN_CANVAS_SCALE_HIDEF,
+            } as c_int,
+            filteringMode: match self.filtering {
+                FullscreenFiltering::Default => html5::EMSCRIPTEN_FULLSCREEN_FILTERING_DEFAULT,
+                FullscreenFiltering::Nearest => html5::EMSCRIPTEN_FULLSCREEN_FILTERING_NEAREST,
+                FullscreenFiltering::Bilinear => html5::EMSCRIPTEN_FULLSCREEN_FILTERING_BILINEAR,
+            } as c_int,
+            // Always set, as the resizes invalidate the cached canvas sizes.
+            canvasResizedCallback: Some(resized),
+            canvasResizedCallbackUserData: std::ptr::null_mut(),
+            // `EM_CALLBACK_THREAD_CONTEXT_CALLING_THREAD`.
+            canvasResizedCallbackTargetThread: 0x2 as html5::pthread_t,
+        }
+    }
+}
+
+/// Exits the fullscreen mode, using the emscripten-defined `emscripten_exit_fullscreen`.
+pub fn exit_fullscreen() -> Result<(), Html5Error> {
+    Html5Error::check(unsafe { html5::emscripten_exit_fullscreen() })
+}
+
+/// Exits the soft fullscreen mode, using the emscripten-defined `emscripten_exit_soft_fullscreen`.
+pub fn exit_soft_fullscreen() -> Result<(), Html5Error> {
+    Html5Error::check(unsafe { html5::emscripten_exit_soft_fullscreen() })
+}
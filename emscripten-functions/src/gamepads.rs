@@ -0,0 +1,173 @@
+//! Batched gamepad polling: all the gamepads are sampled with one JS call per frame, into reusable preallocated states.
+//!
+//! Polling with emscripten's [gamepad functions] takes a JS call per pad, each copying a large `EmscriptenGamepadEvent`.
+//! [`Gamepads::poll`] instead reads `navigator.getGamepads()` once, writing the compact state of every pad straight into wasm memory,
+//! and reports which pads changed since the previous poll.
+//!
+//! [gamepad functions]: https://emscripten.org/docs/api_reference/html5.h.html#gamepad
+
+use std::os::raw::{c_int, c_void};
+
+extern "C" {
+    fn gamepads_sample(states: *mut c_void, max_pads: c_int) -> c_int;
+}
+
+/// The maximum number of gamepads sampled; browsers expose at most 4 in practice.
+pub const MAX_GAMEPADS: usize = 8;
+/// The maximum number of axes sampled per gamepad.
+pub const MAX_AXES: usize = 16;
+/// The maximum number of buttons sampled per gamepad.
+pub const MAX_BUTTONS: usize = 32;
+
+/// The sampled state of a gamepad.
+///
+/// Its layout is written to by the JS sampling code in `gamepad.c`, so it must be kept in sync with it.
+#[repr(C)]
+#[derive(Debug, Clone, Copy)]
+pub struct GamepadState {
+    /// The browser's timestamp of the gamepad's last change, in milliseconds.
+    pub timestamp: f64,
+    connected: c_int,
+    num_axes: c_int,
+    num_buttons: c_int,
+    pressed: u32,
+    axes: [f32; MAX_AXES],
+    buttons: [f32; MAX_BUTTONS],
+}
+
+const _: () = assert!(std::mem::size_of::<GamepadState>() == 216);
+
+impl GamepadState {
+    const DISCONNECTED: GamepadState = GamepadState {
+        timestamp: 0.0,
+        connected: 0,
+        num_axes: 0,
+        num_buttons: 0,
+        pressed: 0,
+        axes: [0.0; MAX_AXES],
+        buttons: [0.0; MAX_BUTTONS],
+    };
+
+    /// Returns `true` if the gamepad is connected. The other values of a disconnected gamepad are meaningless.
+    pub fn is_connected(&self) -> bool {
+        self.connected != 0
+    }
+
+    /// Returns the positions of the gamepad's axes, from -1.0 to 1.0.
+    pub fn axes(&self) -> &[f32] {
+        &self.axes[..(self.num_axes.max(0) as usize).min(MAX_AXES)]
+    }
+
+    /// Returns the analog values of the gamepad's buttons, from 0.0 to 1.0.
+    pub fn button_values(&self) -> &[f32] {
+        &self.buttons[..(self.num_buttons.max(0) as usize).min(MAX_BUTTONS)]
+    }
+
+    /// Returns `true` if the given button is pressed.
+    pub fn is_pressed(&self, button: usize) -> bool {
+        button < MAX_BUTTONS && self.pressed & (1 << button) != 0
+    }
+
+    /// Returns the pressed buttons as a bitmask, bit `i` being set if button `i` is pressed.
+    pub fn pressed_mask(&self) -> u32 {
+        self.pressed
+    }
+}
+
+impl PartialEq for GamepadState {
+    fn eq(&self, other: &Self) -> bool {
+        match (self.is_connected(), other.is_connected()) {
+            (false, false) => true,
+            (true, true) => {
+                self.timestamp == other.timestamp
+                    && self.pressed == other.pressed
+                    && self.axes() == other.axes()
+                    && self.button_values() == other.button_values()
+            }
+            _ => false,
+        }
+    }
+}
+
+/// The states of all the gamepads, updated with [`Gamepads::poll`].
+///
+/// # Examples
+/// ```rust
+/// let mut gamepads = Gamepads::new();
+///
+/// set_main_loop(move || {
+///     for (index, pad) in gamepads.poll() {
+///         if !pad.is_connected() {
+///             println!("Gamepad {} disconnected", index);
+///         } else if pad.is_pressed(0) {
+///             jump(index);
+///         }
+///     }
+///     update_and_draw();
+/// }, 0, true);
+/// ```
+pub struct Gamepads {
+    states: Box<[GamepadState; MAX_GAMEPADS]>,
+    previous: Box<[GamepadState; MAX_GAMEPADS]>,
+    // Bit `i` is set if pad `i` changed at the last poll.
+    changed: u32,
+}
+
+impl Gamepads {
+    /// Creates the states, all disconnected until the first poll.
+    pub fn new() -> Self {
+        Self {
+            states: Box::new([GamepadState::DISCONNECTED; MAX_GAMEPADS]),
+            previous: Box::new([GamepadState::DISCONNECTED; MAX_GAMEPADS]),
+            changed: 0,
+        }
+    }
+
+    /// Samples all the gamepads with one JS call, and returns the index and state of each gamepad that changed since the previous poll,
+    /// including the ones that got connected or disconnected.
+    ///
+    /// Call it once per frame: the browser updates the gamepad states at most once per frame anyway.
+    pub fn poll(&mut self) -> impl Iterator<Item = (usize, &GamepadState)> {
+        std::mem::swap(&mut self.states, &mut self.previous);
+        unsafe {
+            gamepads_sample(
+                self.states.as_mut_ptr() as *mut c_void,
+                MAX_GAMEPADS as c_int,
+            );
+        }
+
+        self.changed = 0;
+        for index in 0..MAX_GAMEPADS {
+            if self.states[index] != self.previous[index] {
+                self.changed |= 1 << index;
+            }
+        }
+
+        let changed = self.changed;
+        self.states
+            .iter()
+            .enumerate()
+            .filter(move |(index, _)| changed & (1 << index) != 0)
+    }
+
+    /// Returns the state of the given gamepad at the last poll, if it's connected.
+    pub fn get(&self, index: usize) -> Option<&GamepadState> {
+        self.states.get(index).filter(|state| state.is_connected())
+    }
+
+    /// Returns `true` if the given gamepad changed at the last poll.
+    pub fn is_changed(&self, index: usize) -> bool {
+        index < MAX_GAMEPADS && self.changed & (1 << index) != 0
+    }
+
+    /// Returns the states of the gamepads at the last poll, connected or not.
+    pub fn states(&self) -> &[GamepadState] {
+        &self.states[..]
+    }
+}
+
+impl Default for Gamepads {
+    fn default() -> Self {
+        Self::new()
+    }
+}
@@ -0,0 +1,185 @@
+//! Scanning of the roots of a conservative garbage collector, over the emscripten-defined [`emscripten_scan_stack`] and [`emscripten_scan_registers`].
+//!
+//! A conservative collector treats every word of its roots that looks like a pointer into its heap as one. On wasm, the roots
+//! are the values on the data stack, given by [`scan_stack`], and those held in wasm locals, which aren't in memory:
+//! with Asyncify, [`scan_registers`] unwinds the call stack to spill them, and gives the memory they were spilled to.
+//!
+//! The ranges are only valid during the scan, as the stack is reused right after. To spread the marking of the roots over
+//! several main loop ticks, [`RootSnapshot::capture`] copies their words at once, e.g. when a collection starts, and
+//! [`RootSnapshot::scan`] gives them to the collector a slice at a time, within a time budget.
+//! The objects allocated or stored by the program after the capture must then be kept alive by the collector itself,
+//! e.g. with a write barrier, as with any incremental marking.
+//!
+//! [`emscripten_scan_stack`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_scan_stack
+//! [`emscripten_scan_registers`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_scan_registers
+
+use std::{cell::Cell, ops::Range, os::raw::c_void};
+
+use emscripten_functions_sys::emscripten;
+
+use crate::{
+    emscripten::{get_now, has_asyncify, AsyncifyUnavailable},
+    scheduler::Step,
+};
+
+// The number of words given to the visitor at a time by `RootSnapshot::scan`, between checks of the time budget.
+const SCAN_CHUNK: usize = 1024;
+
+const WORD: usize = std::mem::size_of::<usize>();
+
+thread_local! {
+    // The visitor of the running scan. Emscripten's scan functions take no user data, so it's passed here.
+    static VISITOR: Cell<*mut c_void> = const { Cell::new(std::ptr::null_mut()) };
+}
+
+unsafe extern "C" fn visit_trampoline<F>(begin: *mut c_void, end: *mut c_void)
+where
+    F: FnMut(Range<usize>),
+{
+    let visit = &mut *(VISITOR.get() as *mut F);
+    visit(begin as usize..end as usize);
+}
+
+// Runs the emscripten scan function with the given visitor, restoring the previous one for nested scans.
+fn scan_with<F>(scan: unsafe extern "C" fn(emscripten::em_scan_func), mut visit: F)
+where
+    F: FnMut(Range<usize>),
+{
+    // The visitor lives in linear memory, which the unwinding of `emscripten_scan_registers` keeps intact.
+    let previous = VISITOR.replace(&mut visit as *mut F as *mut c_void);
+    unsafe { scan(Some(visit_trampoline::<F>)) };
+    VISITOR.set(previous);
+}
+
+/// Calls `visit` with the address range of the calling thread's data stack in use, from the stack pointer to the stack base.
+///
+/// The range is only valid during the call.
+///
+/// # Examples
+/// ```rust
+/// scan_stack(|range| {
+///     // Safety: the range is memory of the stack, valid during the call.
+///     let words = unsafe { std::slice::from_raw_parts(range.start as *const usize, range.len() / std::mem::size_of::<usize>()) };
+///     gc.mark_conservatively(words);
+/// });
+/// ```
+pub fn scan_stack<F>(visit: F)
+where
+    F: FnMut(Range<usize>),
+{
+    scan_with(emscripten::emscripten_scan_stack, visit);
+}
+
+/// Calls `visit` with the address range the wasm locals of the calling thread's call stack were spilled to,
+/// or returns an error if the program wasn't built with Asyncify, which spills them.
+///
+/// The range is only valid during the call, while the call stack is unwound: `visit` must not call functions that unwind it,
+/// like [`sleep`](crate::emscripten::sleep).
+pub fn scan_registers<F>(visit: F) -> Result<(), AsyncifyUnavailable>
+where
+    F: FnMut(Range<usize>),
+{
+    if !has_asyncify() {
+        return Err(AsyncifyUnavailable);
+    }
+    scan_with(emscripten::emscripten_scan_registers, visit);
+    Ok(())
+}
+
+/// Calls `visit` with the address ranges of all the roots of the calling thread: the spilled wasm locals with Asyncify,
+/// then the data stack.
+///
+/// Without Asyncify, the pointers only held in wasm locals are missed: the collector should then only run
+/// from the main loop's function, where no collected object is held by a caller.
+pub fn scan_roots<F>(mut visit: F)
+where
+    F: FnMut(Range<usize>),
+{
+    if has_asyncify() {
+        scan_with(emscripten::emscripten_scan_registers, &mut visit);
+    }
+    scan_with(emscripten::emscripten_scan_stack, &mut visit);
+}
+
+/// A copy of the words of the calling thread's roots, scanned incrementally. See the [module documentation](self).
+///
+/// # Examples
+/// ```rust
+/// // A collection starts: the roots are captured, and marked over the next ticks, at most 2 ms per tick.
+/// let mut roots = RootSnapshot::capture();
+/// spawn_task(move || {
+///     roots.scan(2.0, |words| {
+///         for &word in words {
+///             gc.mark_if_pointer(word);
+///         }
+///     })
+/// });
+/// ```
+#[derive(Debug, Clone, Default)]
+pub struct RootSnapshot {
+    words: Vec<usize>,
+    position: usize,
+}
+
+impl RootSnapshot {
+    /// Copies the words of the calling thread's roots, as found by [`scan_roots`].
+    pub fn capture() -> Self {
+        let mut words = Vec::new();
+        scan_roots(|range| {
+            // Pointers are word-aligned, so the ranges are cut to whole words.
+            let start = range.start.next_multiple_of(WORD);
+            let end = range.end & !(WORD - 1);
+            if end > start {
+                // The ranges are memory of the data stack or of Asyncify's buffer, valid during the scan.
+                let range = unsafe {
+                    std::slice::from_raw_parts(start as *const usize, (end - start) / WORD)
+                };
+                words.extend_from_slice(range);
+            }
+        });
+        Self { words, position: 0 }
+    }
+
+    /// Returns all the captured words.
+    pub fn words(&self) -> &[usize] {
+        &self.words
+    }
+
+    /// Returns the number of captured words not scanned yet.
+    pub fn remaining(&self) -> usize {
+        self.words.len() - self.position
+    }
+
+    /// Returns `true` if all the captured words were scanned.
+    pub fn is_done(&self) -> bool {
+        self.position == self.words.len()
+    }
+
+    /// Gives the words not scanned yet to `visit`, a slice at a time, until they're all scanned or `budget` milliseconds passed.
+    /// It returns [`Step::Done`] once they're all scanned, and [`Step::Continue`] otherwise, e.g. to be run as a scheduler task.
+    pub fn scan<F>(&mut self, budget: f64, mut visit: F) -> Step
+    where
+        F: FnMut(&[usize]),
+    {
+        let start = get_now();
+        while !self.is_done() {
+            let end = (self.position + SCAN_CHUNK).min(self.words.len());
+            visit(&self.words[self.position..end]);
+            self.position = end;
+            if get_now() - start >= budget {
+                break;
+            }
+        }
+
+        if self.is_done() {
+            Step::Done
+        } else {
+            Step::Continue
+        }
+    }
+
+    /// Starts scanning the captured words again from the first one.
+    pub fn rewind(&mut self) {
+        self.position = 0;
+    }
+}
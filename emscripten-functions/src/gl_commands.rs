@@ -0,0 +1,1036 @@
+//! GL command buffers recorded on any thread and replayed on the thread owning the WebGL context, in one batch per frame.
+//!
+//! Without `OffscreenCanvas`, a WebGL context lives on the main browser thread, and all GL calls must be made there.
+//! A [`CommandBuffer`] instead records the calls as compact words, without touching GL, so that workers can record parts
+//! of a frame in parallel. They [`submit`](CommandQueue::submit) them to a shared [`CommandQueue`], and the main thread's
+//! [`Replayer`] replays them all, in submission order, once per frame.
+//!
+//! The GL objects are referred to by [`GlObject`] ids, which the recording threads allocate without a round-trip to the main thread,
+//! and which the replayer maps to the real objects it creates. The objects created on the main thread, like the programs built
+//! with a [`ProgramCompiler`](crate::webgl_programs::ProgramCompiler), get ids with [`Replayer::import`].
+//! The uniform locations are the integers of `glGetUniformLocation`, looked up on the main thread once.
+
+use std::{
+    marker::PhantomData,
+    os::raw::c_void,
+    sync::{
+        atomic::{AtomicU32, Ordering},
+        Arc,
+    },
+};
+
+use crate::{
+    sync::Mutex,
+    webgl::{GlProc, GlVersion},
+};
+
+macro_rules! gl_procs {
+    ($($name:ident = $symbol:literal: fn($($arg:ty),*);)*) => {
+        $(
+            static $name: GlProc<unsafe extern "C" fn($($arg),*)> =
+                unsafe { GlProc::new($symbol, GlVersion::Any) };
+        )*
+    };
+}
+
+// Calls the GL function if the context has it.
+macro_rules! gl {
+    ($name:ident($($arg:expr),*)) => {
+        if let Some(func) = $name.get() {
+            unsafe { func($($arg),*) };
+        }
+    };
+}
+
+gl_procs! {
+    GL_GEN_BUFFERS = c"glGenBuffers": fn(i32, *mut u32);
+    GL_DELETE_BUFFERS = c"glDeleteBuffers": fn(i32, *const u32);
+    GL_BIND_BUFFER = c"glBindBuffer": fn(u32, u32);
+    GL_BUFFER_DATA = c"glBufferData": fn(u32, isize, *const c_void, u32);
+    GL_BUFFER_SUB_DATA = c"glBufferSubData": fn(u32, isize, isize, *const c_void);
+    GL_GEN_TEXTURES = c"glGenTextures": fn(i32, *mut u32);
+    GL_DELETE_TEXTURES = c"glDeleteTextures": fn(i32, *const u32);
+    GL_BIND_TEXTURE = c"glBindTexture": fn(u32, u32);
+    GL_ACTIVE_TEXTURE = c"glActiveTexture": fn(u32);
+    GL_TEX_IMAGE_2D = c"glTexImage2D": fn(u32, i32, i32, i32, i32, i32, u32, u32, *const c_void);
+    GL_TEX_SUB_IMAGE_2D = c"glTexSubImage2D": fn(u32, i32, i32, i32, i32, i32, u32, u32, *const c_void);
+    GL_TEX_PARAMETERI = c"glTexParameteri": fn(u32, u32, i32);
+    GL_GENERATE_MIPMAP = c"glGenerateMipmap": fn(u32);
+    GL_GEN_FRAMEBUFFERS = c"glGenFramebuffers": fn(i32, *mut u32);
+    GL_DELETE_FRAMEBUFFERS = c"glDeleteFramebuffers": fn(i32, *const u32);
+    GL_BIND_FRAMEBUFFER = c"glBindFramebuffer": fn(u32, u32);
+    GL_FRAMEBUFFER_TEXTURE_2D = c"glFramebufferTexture2D": fn(u32, u32, u32, u32, i32);
+    GL_GEN_VERTEX_ARRAYS = c"glGenVertexArrays": fn(i32, *mut u32);
+    GL_DELETE_VERTEX_ARRAYS = c"glDeleteVertexArrays": fn(i32, *const u32);
+    GL_BIND_VERTEX_ARRAY = c"glBindVertexArray": fn(u32);
+    GL_VERTEX_ATTRIB_POINTER = c"glVertexAttribPointer": fn(u32, i32, u32, u8, i32, *const c_void);
+    GL_ENABLE_VERTEX_ATTRIB_ARRAY = c"glEnableVertexAttribArray": fn(u32);
+    GL_DISABLE_VERTEX_ATTRIB_ARRAY = c"glDisableVertexAttribArray": fn(u32);
+    GL_VERTEX_ATTRIB_DIVISOR = c"glVertexAttribDivisor": fn(u32, u32);
+    GL_USE_PROGRAM = c"glUseProgram": fn(u32);
+    GL_UNIFORM_1I = c"glUniform1i": fn(i32, i32);
+    GL_UNIFORM_1F = c"glUniform1f": fn(i32, f32);
+    GL_UNIFORM_2F = c"glUniform2f": fn(i32, f32, f32);
+    GL_UNIFORM_3F = c"glUniform3f": fn(i32, f32, f32, f32);
+    GL_UNIFORM_4F = c"glUniform4f": fn(i32, f32, f32, f32, f32);
+    GL_UNIFORM_MATRIX_4FV = c"glUniformMatrix4fv": fn(i32, i32, u8, *const f32);
+    GL_VIEWPORT = c"glViewport": fn(i32, i32, i32, i32);
+    GL_SCISSOR = c"glScissor": fn(i32, i32, i32, i32);
+    GL_CLEAR_COLOR = c"glClearColor": fn(f32, f32, f32, f32);
+    GL_CLEAR_DEPTHF = c"glClearDepthf": fn(f32);
+    GL_CLEAR = c"glClear": fn(u32);
+    GL_ENABLE = c"glEnable": fn(u32);
+    GL_DISABLE = c"glDisable": fn(u32);
+    GL_BLEND_FUNC = c"glBlendFunc": fn(u32, u32);
+    GL_DEPTH_FUNC = c"glDepthFunc": fn(u32);
+    GL_DEPTH_MASK = c"glDepthMask": fn(u8);
+    GL_COLOR_MASK = c"glColorMask": fn(u8, u8, u8, u8);
+    GL_CULL_FACE = c"glCullFace": fn(u32);
+    GL_DRAW_ARRAYS = c"glDrawArrays": fn(u32, i32, i32);
+    GL_DRAW_ELEMENTS = c"glDrawElements": fn(u32, i32, u32, *const c_void);
+    GL_DRAW_ARRAYS_INSTANCED = c"glDrawArraysInstanced": fn(u32, i32, i32, i32);
+    GL_DRAW_ELEMENTS_INSTANCED = c"glDrawElementsInstanced": fn(u32, i32, u32, *const c_void, i32);
+}
+
+// The opcodes of the recorded commands, each followed by its arguments.
+mod op {
+    pub const CREATE_BUFFER: u32 = 0;
+    pub const DELETE_BUFFER: u32 = 1;
+    pub const BIND_BUFFER: u32 = 2;
+    pub const BUFFER_DATA: u32 = 3;
+    pub const BUFFER_SUB_DATA: u32 = 4;
+    pub const CREATE_TEXTURE: u32 = 5;
+    pub const DELETE_TEXTURE: u32 = 6;
+    pub const BIND_TEXTURE: u32 = 7;
+    pub const ACTIVE_TEXTURE: u32 = 8;
+    pub const TEX_IMAGE_2D: u32 = 9;
+    pub const TEX_SUB_IMAGE_2D: u32 = 10;
+    pub const TEX_PARAMETER_I: u32 = 11;
+    pub const GENERATE_MIPMAP: u32 = 12;
+    pub const CREATE_FRAMEBUFFER: u32 = 13;
+    pub const DELETE_FRAMEBUFFER: u32 = 14;
+    pub const BIND_FRAMEBUFFER: u32 = 15;
+    pub const FRAMEBUFFER_TEXTURE_2D: u32 = 16;
+    pub const CREATE_VERTEX_ARRAY: u32 = 17;
+    pub const DELETE_VERTEX_ARRAY: u32 = 18;
+    pub const BIND_VERTEX_ARRAY: u32 = 19;
+    pub const VERTEX_ATTRIB_POINTER: u32 = 20;
+    pub const ENABLE_VERTEX_ATTRIB_ARRAY: u32 = 21;
+    pub const DISABLE_VERTEX_ATTRIB_ARRAY: u32 = 22;
+    pub const VERTEX_ATTRIB_DIVISOR: u32 = 23;
+    pub const USE_PROGRAM: u32 = 24;
+    pub const UNIFORM_1I: u32 = 25;
+    pub const UNIFORM_1F: u32 = 26;
+    pub const UNIFORM_2F: u32 = 27;
+    pub const UNIFORM_3F: u32 = 28;
+    pub const UNIFORM_4F: u32 = 29;
+    pub const UNIFORM_MATRIX_4FV: u32 = 30;
+    pub const VIEWPORT: u32 = 31;
+    pub const SCISSOR: u32 = 32;
+    pub const CLEAR_COLOR: u32 = 33;
+    pub const CLEAR_DEPTH: u32 = 34;
+    pub const CLEAR: u32 = 35;
+    pub const ENABLE: u32 = 36;
+    pub const DISABLE: u32 = 37;
+    pub const BLEND_FUNC: u32 = 38;
+    pub const DEPTH_FUNC: u32 = 39;
+    pub const DEPTH_MASK: u32 = 40;
+    pub const COLOR_MASK: u32 = 41;
+    pub const CULL_FACE: u32 = 42;
+    pub const DRAW_ARRAYS: u32 = 43;
+    pub const DRAW_ELEMENTS: u32 = 44;
+    pub const DRAW_ARRAYS_INSTANCED: u32 = 45;
+    pub const DRAW_ELEMENTS_INSTANCED: u32 = 46;
+}
+
+// The data of a command without any, like `glTexImage2D` with a null pointer.
+const NO_DATA: u32 = u32::MAX;
+
+/// The id of a GL object in the recorded commands, mapped to the real object by the [`Replayer`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct GlObject(u32);
+
+impl GlObject {
+    /// The null object, e.g. to unbind a buffer.
+    pub const NONE: GlObject = GlObject(0);
+}
+
+// The words and data of a recorded buffer.
+type Recording = (Vec<u32>, Vec<u8>);
+
+struct QueueState {
+    // The submitted buffers, by submission order.
+    // The buffers' `Arc` isn't kept, so that the queue doesn't own itself.
+    submitted: Mutex<Vec<(u32, Recording)>>,
+    // The allocations of the replayed buffers, cleared, for the recording threads to reuse.
+    pool: Mutex<Vec<Recording>>,
+    next_id: AtomicU32,
+    // The ids of the deleted objects, once their deletion is replayed.
+    free_ids: Mutex<Vec<u32>>,
+}
+
+impl QueueState {
+    fn allocate_id(&self) -> GlObject {
+        if let Some(id) = self.free_ids.lock().pop() {
+            return GlObject(id);
+        }
+        GlObject(self.next_id.fetch_add(1, Ordering::Relaxed))
+    }
+}
+
+/// The queue the recording threads submit their [`CommandBuffer`]s to, shared with the [`Replayer`]. Cloning it shares the queue.
+#[derive(Clone)]
+pub struct CommandQueue {
+    state: Arc<QueueState>,
+}
+
+impl Default for CommandQueue {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl CommandQueue {
+    /// Creates an empty queue.
+    pub fn new() -> Self {
+        Self {
+            state: Arc::new(QueueState {
+                submitted: Mutex::new(Vec::new()),
+                pool: Mutex::new(Vec::new()),
+                // The id 0 is the null object.
+                next_id: AtomicU32::new(1),
+                free_ids: Mutex::new(Vec::new()),
+            }),
+        }
+    }
+
+    /// Returns an empty command buffer, reusing the allocations of a replayed one if there's one.
+    pub fn recorder(&self) -> CommandBuffer {
+        let (words, data) = self.state.pool.lock().pop().unwrap_or_default();
+        CommandBuffer {
+            words,
+            data,
+            queue: self.state.clone(),
+        }
+    }
+
+    /// Submits a recorded buffer, for the next [`Replayer::replay`]. The buffers of a replay are replayed by increasing `order`,
+    /// e.g. the index of the part of the frame they draw, whatever the order in which the threads submitted them.
+    pub fn submit(&self, order: u32, buffer: CommandBuffer) {
+        debug_assert!(
+            Arc::ptr_eq(&buffer.queue, &self.state),
+            "the buffer must come from this queue"
+        );
+        self.state
+            .submitted
+            .lock()
+            .push((order, (buffer.words, buffer.data)));
+    }
+}
+
+/// A buffer of recorded GL calls, got from [`CommandQueue::recorder`]. It can be sent to other threads.
+///
+/// The methods record the GL function of the same name, with [`GlObject`] ids in place of the objects.
+///
+/// # Examples
+/// ```rust
+/// let queue = CommandQueue::new();
+/// let program = replayer.import(compiler_program);
+///
+/// let worker_queue = queue.clone();
+/// pool.spawn(move || {
+///     let mut commands = worker_queue.recorder();
+///     commands.use_program(program);
+///     for sprite in &sprites {
+///         commands.uniform_4f(offset_location, sprite.x, sprite.y, sprite.width, sprite.height);
+///         commands.draw_arrays(0x0005, 0, 4); // TRIANGLE_STRIP
+///     }
+///     worker_queue.submit(1, commands);
+/// });
+/// ```
+pub struct CommandBuffer {
+    words: Vec<u32>,
+    // The bytes of the buffers' and textures' data.
+    data: Vec<u8>,
+    queue: Arc<QueueState>,
+}
+
+impl CommandBuffer {
+    /// Returns the number of words recorded, 4 bytes each.
+    pub fn len(&self) -> usize {
+        self.words.len()
+    }
+
+    /// Returns `true` if no call is recorded.
+    pub fn is_empty(&self) -> bool {
+        self.words.is_empty()
+    }
+
+    /// Forgets the recorded calls, keeping the allocations.
+    pub fn reset(&mut self) {
+        self.words.clear();
+        self.data.clear();
+    }
+
+    fn push(&mut self, words: &[u32]) {
+        self.words.extend_from_slice(words);
+    }
+
+    // Appends the data, and returns its offset and length words.
+    fn push_data(&mut self, data: &[u8]) -> [u32; 2] {
+        let offset = self.data.len() as u32;
+        self.data.extend_from_slice(data);
+        [offset, data.len() as u32]
+    }
+
+    fn create(&mut self, op: u32) -> GlObject {
+        let object = self.queue.allocate_id();
+        self.push(&[op, object.0]);
+        object
+    }
+
+    /// Records the creation of a buffer, like `glGenBuffers`.
+    pub fn create_buffer(&mut self) -> GlObject {
+        self.create(op::CREATE_BUFFER)
+    }
+
+    /// Records the deletion of a buffer, like `glDeleteBuffers`.
+    pub fn delete_buffer(&mut self, buffer: GlObject) {
+        self.push(&[op::DELETE_BUFFER, buffer.0]);
+    }
+
+    /// Records `glBindBuffer`.
+    pub fn bind_buffer(&mut self, target: u32, buffer: GlObject) {
+        self.push(&[op::BIND_BUFFER, target, buffer.0]);
+    }
+
+    /// Records `glBufferData`, copying the data into the command buffer.
+    pub fn buffer_data(&mut self, target: u32, data: &[u8], usage: u32) {
+        let [offset, len] = self.push_data(data);
+        self.push(&[op::BUFFER_DATA, target, offset, len, usage]);
+    }
+
+    /// Records `glBufferSubData`, copying the data into the command buffer.
+    pub fn buffer_sub_data(&mut self, target: u32, dst_offset: usize, data: &[u8]) {
+        let [offset, len] = self.push_data(data);
+        self.push(&[op::BUFFER_SUB_DATA, target, dst_offset as u32, offset, len]);
+    }
+
+    /// Records the creation of a texture, like `glGenTextures`.
+    pub fn create_texture(&mut self) -> GlObject {
+        self.create(op::CREATE_TEXTURE)
+    }
+
+    /// Records the deletion of a texture, like `glDeleteTextures`.
+    pub fn delete_texture(&mut self, texture: GlObject) {
+        self.push(&[op::DELETE_TEXTURE, texture.0]);
+    }
+
+    /// Records `glBindTexture`.
+    pub fn bind_texture(&mut self, target: u32, texture: GlObject) {
+        self.push(&[op::BIND_TEXTURE, target, texture.0]);
+    }
+
+    /// Records `glActiveTexture`.
+    pub fn active_texture(&mut self, texture: u32) {
+        self.push(&[op::ACTIVE_TEXTURE, texture]);
+    }
+
+    /// Records `glTexImage2D`, copying the pixels into the command buffer; `None` allocates the texture without them.
+    #[allow(clippy::too_many_arguments)]
+    pub fn tex_image_2d(
+        &mut self,
+        target: u32,
+        level: i32,
+        internal_format: i32,
+        width: i32,
+        height: i32,
+        format: u32,
+        ty: u32,
+        pixels: Option<&[u8]>,
+    ) {
+        let [offset, len] = pixels.map_or([NO_DATA, 0], |pixels| self.push_data(pixels));
+        self.push(&[
+            op::TEX_IMAGE_2D,
+            target,
+            level as u32,
+            internal_format as u32,
+            width as u32,
+            height as u32,
+            format,
+            ty,
+            offset,
+            len,
+        ]);
+    }
+
+    /// Records `glTexSubImage2D`, copying the pixels into the command buffer.
+    #[allow(clippy::too_many_arguments)]
+    pub fn tex_sub_image_2d(
+        &mut self,
+        target: u32,
+        level: i32,
+        x: i32,
+        y: i32,
+        width: i32,
+        height: i32,
+        format: u32,
+        ty: u32,
+        pixels: &[u8],
+    ) {
+        let [offset, len] = self.push_data(pixels);
+        self.push(&[
+            op::TEX_SUB_IMAGE_2D,
+            target,
+            level as u32,
+            x as u32,
+            y as u32,
+            width as u32,
+            height as u32,
+            format,
+            ty,
+            offset,
+            len,
+        ]);
+    }
+
+    /// Records `glTexParameteri`.
+    pub fn tex_parameter_i(&mut self, target: u32, pname: u32, param: i32) {
+        self.push(&[op::TEX_PARAMETER_I, target, pname, param as u32]);
+    }
+
+    /// Records `glGenerateMipmap`.
+    pub fn generate_mipmap(&mut self, target: u32) {
+        self.push(&[op::GENERATE_MIPMAP, target]);
+    }
+
+    /// Records the creation of a framebuffer, like `glGenFramebuffers`.
+    pub fn create_framebuffer(&mut self) -> GlObject {
+        self.create(op::CREATE_FRAMEBUFFER)
+    }
+
+    /// Records the deletion of a framebuffer, like `glDeleteFramebuffers`.
+    pub fn delete_framebuffer(&mut self, framebuffer: GlObject) {
+        self.push(&[op::DELETE_FRAMEBUFFER, framebuffer.0]);
+    }
+
+    /// Records `glBindFramebuffer`; [`GlObject::NONE`] binds the canvas' drawing buffer.
+    pub fn bind_framebuffer(&mut self, target: u32, framebuffer: GlObject) {
+        self.push(&[op::BIND_FRAMEBUFFER, target, framebuffer.0]);
+    }
+
+    pub fn framebuffer_texture_2d(
+        &mut self,
+        target: u32,
+        attachment: u32,
+        textarget: u32,
+        texture: GlObject,
+        level: i32,
+    ) {
+        self.push(&[
+            op::FRAMEBUFFER_TEXTURE_2D,
+            target,
+            attachment,
+            textarget,
+            texture.0,
+            level as u32,
+        ]);
+    }
+
+    /// Records the creation of a vertex array object, like `glGenVertexArrays`.
+    pub fn create_vertex_array(&mut self) -> GlObject {
+        self.create(op::CREATE_VERTEX_ARRAY)
+    }
+
+    /// Records the deletion of a vertex array object, like `glDeleteVertexArrays`.
+    pub fn delete_vertex_array(&mut self, vertex_array: GlObject) {
+        self.push(&[op::DELETE_VERTEX_ARRAY, vertex_array.0]);
+    }
+
+    /// Records `glBindVertexArray`.
+    pub fn bind_vertex_array(&mut self, vertex_array: GlObject) {
+        self.push(&[op::BIND_VERTEX_ARRAY, vertex_array.0]);
+    }
+
+    /// Records `glVertexAttribPointer`, with the offset in the bound array buffer.
+    pub fn vertex_attrib_pointer(
+        &mut self,
+        index: u32,
+        size: i32,
+        ty: u32,
+        normalized: bool,
+        stride: i32,
+        offset: usize,
+    ) {
+        self.push(&[
+            op::VERTEX_ATTRIB_POINTER,
+            index,
+            size as u32,
+            ty,
+            normalized as u32,
+            stride as u32,
+            offset as u32,
+        ]);
+    }
+
+    /// Records `glEnableVertexAttribArray`.
+    pub fn enable_vertex_attrib_array(&mut self, index: u32) {
+        self.push(&[op::ENABLE_VERTEX_ATTRIB_ARRAY, index]);
+    }
+
+    /// Records `glDisableVertexAttribArray`.
+    pub fn disable_vertex_attrib_array(&mut self, index: u32) {
+        self.push(&[op::DISABLE_VERTEX_ATTRIB_ARRAY, index]);
+    }
+
+    /// Records `glVertexAttribDivisor`.
+    pub fn vertex_attrib_divisor(&mut self, index: u32, divisor: u32) {
+        self.push(&[op::VERTEX_ATTRIB_DIVISOR, index, divisor]);
+    }
+
+    /// Records `glUseProgram`.
+    pub fn use_program(&mut self, program: GlObject) {
+        self.push(&[op::USE_PROGRAM, program.0]);
+    }
+
+    /// Records `glUniform1i`.
+    pub fn uniform_1i(&mut self, location: i32, x: i32) {
+        self.push(&[op::UNIFORM_1I, location as u32, x as u32]);
+    }
+
+    /// Records `glUniform1f`.
+    pub fn uniform_1f(&mut self, location: i32, x: f32) {
+        self.push(&[op::UNIFORM_1F, location as u32, x.to_bits()]);
+    }
+
+    /// Records `glUniform2f`.
+    pub fn uniform_2f(&mut self, location: i32, x: f32, y: f32) {
+        self.push(&[op::UNIFORM_2F, location as u32, x.to_bits(), y.to_bits()]);
+    }
+
+    /// Records `glUniform3f`.
+    pub fn uniform_3f(&mut self, location: i32, x: f32, y: f32, z: f32) {
+        self.push(&[
+            op::UNIFORM_3F,
+            location as u32,
+            x.to_bits(),
+            y.to_bits(),
+            z.to_bits(),
+        ]);
+    }
+
+    /// Records `glUniform4f`.
+    pub fn uniform_4f(&mut self, location: i32, x: f32, y: f32, z: f32, w: f32) {
+        self.push(&[
+            op::UNIFORM_4F,
+            location as u32,
+            x.to_bits(),
+            y.to_bits(),
+            z.to_bits(),
+            w.to_bits(),
+        ]);
+    }
+
+    /// Records `glUniformMatrix4fv` for one column-major matrix.
+    pub fn uniform_matrix_4fv(&mut self, location: i32, transpose: bool, matrix: &[f32; 16]) {
+        self.push(&[op::UNIFORM_MATRIX_4FV, location as u32, transpose as u32]);
+        self.words
+            .extend(matrix.iter().map(|value| value.to_bits()));
+    }
+
+    /// Records `glViewport`.
+    pub fn viewport(&mut self, x: i32, y: i32, width: i32, height: i32) {
+        self.push(&[
+            op::VIEWPORT,
+            x as u32,
+            y as u32,
+            width as u32,
+            height as u32,
+        ]);
+    }
+
+    /// Records `glScissor`.
+    pub fn scissor(&mut self, x: i32, y: i32, width: i32, height: i32) {
+        self.push(&[op::SCISSOR, x as u32, y as u32, width as u32, height as u32]);
+    }
+
+    /// Records `glClearColor`.
+    pub fn clear_color(&mut self, red: f32, green: f32, blue: f32, alpha: f32) {
+        self.push(&[
+            op::CLEAR_COLOR,
+            red.to_bits(),
+            green.to_bits(),
+            blue.to_bits(),
+            alpha.to_bits(),
+        ]);
+    }
+
+    /// Records `glClearDepthf`.
+    pub fn clear_depth(&mut self, depth: f32) {
+        self.push(&[op::CLEAR_DEPTH, depth.to_bits()]);
+    }
+
+    /// Records `glClear`.
+    pub fn clear(&mut self, mask: u32) {
+        self.push(&[op::CLEAR, mask]);
+    }
+
+    /// Records `glEnable`.
+    pub fn enable(&mut self, capability: u32) {
+        self.push(&[op::ENABLE, capability]);
+    }
+
+    /// Records `glDisable`.
+    pub fn disable(&mut self, capability: u32) {
+        self.push(&[op::DISABLE, capability]);
+    }
+
+    /// Records `glBlendFunc`.
+    pub fn blend_func(&mut self, source: u32, destination: u32) {
+        self.push(&[op::BLEND_FUNC, source, destination]);
+    }
+
+    /// Records `glDepthFunc`.
+    pub fn depth_func(&mut self, func: u32) {
+        self.push(&[op::DEPTH_FUNC, func]);
+    }
+
+    /// Records `glDepthMask`.
+    pub fn depth_mask(&mut self, flag: bool) {
+        self.push(&[op::DEPTH_MASK, flag as u32]);
+    }
+
+    /// Records `glColorMask`.
+    pub fn color_mask(&mut self, red: bool, green: bool, blue: bool, alpha: bool) {
+        self.push(&[
+            op::COLOR_MASK,
+            red as u32,
+            green as u32,
+            blue as u32,
+            alpha as u32,
+        ]);
+    }
+
+    /// Records `glCullFace`.
+    pub fn cull_face(&mut self, mode: u32) {
+        self.push(&[op::CULL_FACE, mode]);
+    }
+
+    /// Records `glDrawArrays`.
+    pub fn draw_arrays(&mut self, mode: u32, first: i32, count: i32) {
+        self.push(&[op::DRAW_ARRAYS, mode, first as u32, count as u32]);
+    }
+
+    /// Records `glDrawElements`, with the offset in the bound element array buffer.
+    pub fn draw_elements(&mut self, mode: u32, count: i32, ty: u32, offset: usize) {
+        self.push(&[op::DRAW_ELEMENTS, mode, count as u32, ty, offset as u32]);
+    }
+
+    /// Records `glDrawArraysInstanced`.
+    pub fn draw_arrays_instanced(&mut self, mode: u32, first: i32, count: i32, instances: i32) {
+        self.push(&[
+            op::DRAW_ARRAYS_INSTANCED,
+            mode,
+            first as u32,
+            count as u32,
+            instances as u32,
+        ]);
+    }
+
+    /// Records `glDrawElementsInstanced`, with the offset in the bound element array buffer.
+    pub fn draw_elements_instanced(
+        &mut self,
+        mode: u32,
+        count: i32,
+        ty: u32,
+        offset: usize,
+        instances: i32,
+    ) {
+        self.push(&[
+            op::DRAW_ELEMENTS_INSTANCED,
+            mode,
+            count as u32,
+            ty,
+            offset as u32,
+            instances as u32,
+        ]);
+    }
+}
+
+/// Replays the submitted [`CommandBuffer`]s on the thread owning the WebGL context, which must be the current one.
+/// See the [module documentation](self).
+///
+/// # Examples
+/// ```rust
+/// let mut replayer = Replayer::new(&queue);
+/// set_main_loop(move || {
+///     frame_barrier.wait_for_workers();
+///     replayer.replay();
+/// }, 0, true);
+/// ```
+pub struct Replayer {
+    queue: Arc<QueueState>,
+    // The real objects, by id; 0 for the ids without one.
+    objects: Vec<u32>,
+    _not_send: PhantomData<*const ()>,
+}
+
+impl Replayer {
+    /// Creates a replayer of the queue's buffers.
+    pub fn new(queue: &CommandQueue) -> Self {
+        Self {
+            queue: queue.state.clone(),
+            objects: Vec::new(),
+            _not_send: PhantomData,
+        }
+    }
+
+    /// Gives an id to a real GL object created on the replaying thread, e.g. a program, for the recorded commands to use.
+    pub fn import(&mut self, object: u32) -> GlObject {
+        let id = self.queue.allocate_id();
+        self.set(id, object);
+        id
+    }
+
+    /// Forgets an id given by [`import`](Self::import), without deleting the real object.
+    pub fn forget(&mut self, id: GlObject) {
+        self.release(id);
+    }
+
+    /// Returns the real GL object of an id, or 0 if its creation isn't replayed yet.
+    pub fn object(&self, id: GlObject) -> u32 {
+        self.objects.get(id.0 as usize).copied().unwrap_or(0)
+    }
+
+    fn set(&mut self, id: GlObject, object: u32) {
+        let index = id.0 as usize;
+        if index >= self.objects.len() {
+            self.objects.resize(index + 1, 0);
+        }
+        self.objects[index] = object;
+    }
+
+    // Forgets the real object of an id, returning it, and makes the id reusable.
+    fn release(&mut self, id: GlObject) -> u32 {
+        if id == GlObject::NONE {
+            return 0;
+        }
+        let object = self.object(id);
+        self.set(id, 0);
+        self.queue.free_ids.lock().push(id.0);
+        object
+    }
+
+    /// Replays all the buffers submitted since the previous call, by increasing order, and returns their number.
+    pub fn replay(&mut self) -> usize {
+        let mut buffers = std::mem::take(&mut *self.queue.submitted.lock());
+        // The sort is stable, so the buffers of the same order keep their submission order.
+        buffers.sort_by_key(|(order, _)| *order);
+
+        let count = buffers.len();
+        for (_, (mut words, mut data)) in buffers {
+            self.replay_buffer(&words, &data);
+            words.clear();
+            data.clear();
+            self.queue.pool.lock().push((words, data));
+        }
+        count
+    }
+
+    fn replay_buffer(&mut self, words: &[u32], bytes: &[u8]) {
+        let data = |offset: u32, len: u32| -> *const c_void {
+            if offset == NO_DATA {
+                std::ptr::null()
+            } else {
+                bytes[offset as usize..(offset + len) as usize].as_ptr() as *const c_void
+            }
+        };
+        let float = |word: u32| f32::from_bits(word);
+
+        let mut i = 0;
+        while i < words.len() {
+            let op = words[i];
+            let a = &words[i + 1..];
+            i += 1 + match op {
+                op::CREATE_BUFFER
+                | op::CREATE_TEXTURE
+                | op::CREATE_FRAMEBUFFER
+                | op::CREATE_VERTEX_ARRAY => {
+                    let gen = match op {
+                        op::CREATE_BUFFER => &GL_GEN_BUFFERS,
+                        op::CREATE_TEXTURE => &GL_GEN_TEXTURES,
+                        op::CREATE_FRAMEBUFFER => &GL_GEN_FRAMEBUFFERS,
+                        _ => &GL_GEN_VERTEX_ARRAYS,
+                    };
+                    let mut object = 0;
+                    if let Some(gen) = gen.get() {
+                        unsafe { gen(1, &mut object) };
+                    }
+                    self.set(GlObject(a[0]), object);
+                    1
+                }
+                op::DELETE_BUFFER
+                | op::DELETE_TEXTURE
+                | op::DELETE_FRAMEBUFFER
+                | op::DELETE_VERTEX_ARRAY => {
+                    let delete = match op {
+                        op::DELETE_BUFFER => &GL_DELETE_BUFFERS,
+                        op::DELETE_TEXTURE => &GL_DELETE_TEXTURES,
+                        op::DELETE_FRAMEBUFFER => &GL_DELETE_FRAMEBUFFERS,
+                        _ => &GL_DELETE_VERTEX_ARRAYS,
+                    };
+                    let object = self.release(GlObject(a[0]));
+                    if let Some(delete) = delete.get() {
+                        unsafe { delete(1, &object) };
+                    }
+                    1
+                }
+                op::BIND_BUFFER => {
+                    gl!(GL_BIND_BUFFER(a[0], self.object(GlObject(a[1]))));
+                    2
+                }
+                op::BUFFER_DATA => {
+                    gl!(GL_BUFFER_DATA(a[0], a[2] as isize, data(a[1], a[2]), a[3]));
+                    4
+                }
+                op::BUFFER_SUB_DATA => {
+                    gl!(GL_BUFFER_SUB_DATA(
+                        a[0],
+                        a[1] as isize,
+                        a[3] as isize,
+                        data(a[2], a[3])
+                    ));
+                    4
+                }
+                op::BIND_TEXTURE => {
+                    gl!(GL_BIND_TEXTURE(a[0], self.object(GlObject(a[1]))));
+                    2
+                }
+                op::ACTIVE_TEXTURE => {
+                    gl!(GL_ACTIVE_TEXTURE(a[0]));
+                    1
+                }
+                op::TEX_IMAGE_2D => {
+                    gl!(GL_TEX_IMAGE_2D(
+                        a[0],
+                        a[1] as i32,
+                        a[2] as i32,
+                        a[3] as i32,
+                        a[4] as i32,
+                        0,
+                        a[5],
+                        a[6],
+                        data(a[7], a[8])
+                    ));
+                    9
+                }
+                op::TEX_SUB_IMAGE_2D => {
+                    gl!(GL_TEX_SUB_IMAGE_2D(
+                        a[0],
+                        a[1] as i32,
+                        a[2] as i32,
+                        a[3] as i32,
+                        a[4] as i32,
+                        a[5] as i32,
+                        a[6],
+                        a[7],
+                        data(a[8], a[9])
+                    ));
+                    10
+                }
+                op::TEX_PARAMETER_I => {
+                    gl!(GL_TEX_PARAMETERI(a[0], a[1], a[2] as i32));
+                    3
+                }
+                op::GENERATE_MIPMAP => {
+                    gl!(GL_GENERATE_MIPMAP(a[0]));
+                    1
+                }
+                op::BIND_FRAMEBUFFER => {
+                    gl!(GL_BIND_FRAMEBUFFER(a[0], self.object(GlObject(a[1]))));
+                    2
+                }
+                op::FRAMEBUFFER_TEXTURE_2D => {
+                    gl!(GL_FRAMEBUFFER_TEXTURE_2D(
+                        a[0],
+                        a[1],
+                        a[2],
+                        self.object(GlObject(a[3])),
+                        a[4] as i32
+                    ));
+                    5
+                }
+                op::BIND_VERTEX_ARRAY => {
+                    gl!(GL_BIND_VERTEX_ARRAY(self.object(GlObject(a[0]))));
+                    1
+                }
+                op::VERTEX_ATTRIB_POINTER => {
+                    gl!(GL_VERTEX_ATTRIB_POINTER(
+                        a[0],
+                        a[1] as i32,
+                        a[2],
+                        a[3] as u8,
+                        a[4] as i32,
+                        a[5] as usize as *const c_void
+                    ));
+                    6
+                }
+                op::ENABLE_VERTEX_ATTRIB_ARRAY => {
+                    gl!(GL_ENABLE_VERTEX_ATTRIB_ARRAY(a[0]));
+                    1
+                }
+                op::DISABLE_VERTEX_ATTRIB_ARRAY => {
+                    gl!(GL_DISABLE_VERTEX_ATTRIB_ARRAY(a[0]));
+                    1
+                }
+                op::VERTEX_ATTRIB_DIVISOR => {
+                    gl!(GL_VERTEX_ATTRIB_DIVISOR(a[0], a[1]));
+                    2
+                }
+                op::USE_PROGRAM => {
+                    gl!(GL_USE_PROGRAM(self.object(GlObject(a[0]))));
+                    1
+                }
+                op::UNIFORM_1I => {
+                    gl!(GL_UNIFORM_1I(a[0] as i32, a[1] as i32));
+                    2
+                }
+                op::UNIFORM_1F => {
+                    gl!(GL_UNIFORM_1F(a[0] as i32, float(a[1])));
+                    2
+                }
+                op::UNIFORM_2F => {
+                    gl!(GL_UNIFORM_2F(a[0] as i32, float(a[1]), float(a[2])));
+                    3
+                }
+                op::UNIFORM_3F => {
+                    gl!(GL_UNIFORM_3F(
+                        a[0] as i32,
+                        float(a[1]),
+                        float(a[2]),
+                        float(a[3])
+                    ));
+                    4
+                }
+                op::UNIFORM_4F => {
+                    gl!(GL_UNIFORM_4F(
+                        a[0] as i32,
+                        float(a[1]),
+                        float(a[2]),
+                        float(a[3]),
+                        float(a[4])
+                    ));
+                    5
+                }
+                op::UNIFORM_MATRIX_4FV => {
+                    // The matrix words are the bits of its floats, in the same layout.
+                    gl!(GL_UNIFORM_MATRIX_4FV(
+                        a[0] as i32,
+                        1,
+                        a[1] as u8,
+                        a[2..18].as_ptr() as *const f32
+                    ));
+                    18
+                }
+                op::VIEWPORT => {
+                    gl!(GL_VIEWPORT(
+                        a[0] as i32,
+                        a[1] as i32,
+                        a[2] as i32,
+                        a[3] as i32
+                    ));
+                    4
+                }
+                op::SCISSOR => {
+                    gl!(GL_SCISSOR(
+                        a[0] as i32,
+                        a[1] as i32,
+                        a[2] as i32,
+                        a[3] as i32
+                    ));
+                    4
+                }
+                op::CLEAR_COLOR => {
+                    gl!(GL_CLEAR_COLOR(
+                        float(a[0]),
+                        float(a[1]),
+                        float(a[2]),
+                        float(a[3])
+                    ));
+                    4
+                }
+                op::CLEAR_DEPTH => {
+                    gl!(GL_CLEAR_DEPTHF(float(a[0])));
+                    1
+                }
+                op::CLEAR => {
+                    gl!(GL_CLEAR(a[0]));
+                    1
+                }
+                op::ENABLE => {
+                    gl!(GL_ENABLE(a[0]));
+                    1
+                }
+                op::DISABLE => {
+                    gl!(GL_DISABLE(a[0]));
+                    1
+                }
+                op::BLEND_FUNC => {
+                    gl!(GL_BLEND_FUNC(a[0], a[1]));
+                    2
+                }
+                op::DEPTH_FUNC => {
+                    gl!(GL_DEPTH_FUNC(a[0]));
+                    1
+                }
+                op::DEPTH_MASK => {
+                    gl!(GL_DEPTH_MASK(a[0] as u8));
+                    1
+                }
+                op::COLOR_MASK => {
+                    gl!(GL_COLOR_MASK(
+                        a[0] as u8, a[1] as u8, a[2] as u8, a[3] as u8
+                    ));
+                    4
+                }
+                op::CULL_FACE => {
+                    gl!(GL_CULL_FACE(a[0]));
+                    1
+                }
+                op::DRAW_ARRAYS => {
+                    gl!(GL_DRAW_ARRAYS(a[0], a[1] as i32, a[2] as i32));
+                    3
+                }
+                op::DRAW_ELEMENTS => {
+                    gl!(GL_DRAW_ELEMENTS(
+                        a[0],
+                        a[1] as i32,
+                        a[2],
+                        a[3] as usize as *const c_void
+                    ));
+                    4
+                }
+                op::DRAW_ARRAYS_INSTANCED => {
+                    gl!(GL_DRAW_ARRAYS_INSTANCED(
+                        a[0],
+                        a[1] as i32,
+                        a[2] as i32,
+                        a[3] as i32
+                    ));
+                    4
+                }
+                op::DRAW_ELEMENTS_INSTANCED => {
+                    gl!(GL_DRAW_ELEMENTS_INSTANCED(
+                        a[0],
+                        a[1] as i32,
+                        a[2],
+                        a[3] as usize as *const c_void,
+                        a[4] as i32
+                    ));
+                    5
+                }
+                _ => unreachable!("unknown GL command {op}"),
+            };
+        }
+    }
+}
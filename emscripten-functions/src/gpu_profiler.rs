@@ -0,0 +1,248 @@
+//! A GPU profiler timing named render passes with WebGL 2 timer queries, from the `EXT_disjoint_timer_query_webgl2` extension.
+//!
+//! The CPU time of a frame says nothing about the time the GPU spends on each pass. A [`GpuProfiler`] brackets the passes
+//! with `TIME_ELAPSED_EXT` queries, taken from a pool, and reads their results a few frames later once they're available,
+//! in [`GpuProfiler::poll`], without stalling the pipeline. The pass times go to the functions set with [`GpuProfiler::on_pass_time`],
+//! to the [metrics](crate::metrics) attached with [`GpuProfiler::record_to`], and optionally to the [tracer](crate::trace).
+//!
+//! The extension is missing in Firefox and Safari, and in Chrome on some GPUs: [`GpuProfiler::is_supported`] tells if it's there,
+//! and the passes are not timed otherwise. The results of the frames during which the GPU timer got disjoint, e.g. by a power state
+//! change, are dropped.
+
+use std::{
+    collections::{HashMap, VecDeque},
+    marker::PhantomData,
+    os::raw::c_int,
+};
+
+use emscripten_functions_sys::html5;
+
+use crate::{
+    metrics::ValueMetric,
+    trace,
+    webgl::{Context, GlProc, GlVersion},
+    webgl_extensions::Extension,
+};
+
+const TIME_ELAPSED_EXT: u32 = 0x88BF;
+const QUERY_RESULT: u32 = 0x8866;
+const QUERY_RESULT_AVAILABLE: u32 = 0x8867;
+const GPU_DISJOINT_EXT: c_int = 0x8FBB;
+
+static GL_GEN_QUERIES: GlProc<unsafe extern "C" fn(i32, *mut u32)> =
+    unsafe { GlProc::new(c"glGenQueries", GlVersion::WebGL2) };
+static GL_DELETE_QUERIES: GlProc<unsafe extern "C" fn(i32, *const u32)> =
+    unsafe { GlProc::new(c"glDeleteQueries", GlVersion::WebGL2) };
+static GL_BEGIN_QUERY: GlProc<unsafe extern "C" fn(u32, u32)> =
+    unsafe { GlProc::new(c"glBeginQuery", GlVersion::WebGL2) };
+static GL_END_QUERY: GlProc<unsafe extern "C" fn(u32)> =
+    unsafe { GlProc::new(c"glEndQuery", GlVersion::WebGL2) };
+static GL_GET_QUERY_OBJECTUIV: GlProc<unsafe extern "C" fn(u32, u32, *mut u32)> =
+    unsafe { GlProc::new(c"glGetQueryObjectuiv", GlVersion::WebGL2) };
+
+type OnPassTime = Box<dyn FnMut(&'static str, f64)>;
+
+struct PendingQuery {
+    query: u32,
+    pass: &'static str,
+    // Whether the timer got disjoint while the query was pending, making its result meaningless.
+    discarded: bool,
+}
+
+/// Times the render passes on the GPU. See the [module documentation](self).
+///
+/// It acts on the calling thread's current context, which must be the one it was created for.
+/// The timer queries can't be nested: each pass must end before the next one begins.
+///
+/// # Examples
+/// ```rust
+/// static SHADOW_PASS_MS: Histogram<4> = Histogram::new("gpu_shadow_ms", [1.0, 2.0, 4.0, 8.0]);
+///
+/// metrics::register(&SHADOW_PASS_MS);
+/// let mut profiler = GpuProfiler::new(&context);
+/// profiler.record_to("shadows", &SHADOW_PASS_MS);
+///
+/// set_main_loop(move || {
+///     profiler.poll();
+///     profiler.pass("shadows", || renderer.draw_shadows());
+///     profiler.pass("opaque", || renderer.draw_opaque());
+///     println!("Opaque pass: {:?}ms", profiler.pass_time("opaque"));
+/// }, 0, true);
+/// ```
+pub struct GpuProfiler {
+    supported: bool,
+    free: Vec<u32>,
+    pending: VecDeque<PendingQuery>,
+    // The query of the pass begun and not ended yet.
+    active: Option<PendingQuery>,
+    latest: HashMap<&'static str, f64>,
+    metrics: HashMap<&'static str, &'static dyn ValueMetric>,
+    onpasstime: Option<OnPassTime>,
+    trace: bool,
+    _not_send: PhantomData<*const ()>,
+}
+
+impl GpuProfiler {
+    /// Creates a profiler for the WebGL 2 context, enabling its `EXT_disjoint_timer_query_webgl2` extension if it's supported.
+    pub fn new(context: &Context) -> Self {
+        let supported = context.enable_extension(Extension::EXT_disjoint_timer_query_webgl2.name())
+            && GL_BEGIN_QUERY.get().is_some();
+        Self {
+            supported,
+            free: Vec::new(),
+            pending: VecDeque::new(),
+            active: None,
+            latest: HashMap::new(),
+            metrics: HashMap::new(),
+            onpasstime: None,
+            trace: false,
+            _not_send: PhantomData,
+        }
+    }
+
+    /// Returns `true` if the context has the timer queries, so that the passes get timed.
+    pub fn is_supported(&self) -> bool {
+        self.supported
+    }
+
+    /// Sets the function called with the name and the GPU time of each timed pass, in milliseconds, once it's known.
+    pub fn on_pass_time<F>(&mut self, onpasstime: F)
+    where
+        F: 'static + FnMut(&'static str, f64),
+    {
+        self.onpasstime = Some(Box::new(onpasstime));
+    }
+
+    /// Records the GPU times of the given pass into a metric, in milliseconds, e.g. a [`Histogram`](crate::metrics::Histogram).
+    pub fn record_to(&mut self, pass: &'static str, metric: &'static dyn ValueMetric) {
+        self.metrics.insert(pass, metric);
+    }
+
+    /// Sets whether the GPU times of the passes are logged to the tracer's `gpu` channel, with [`trace::log_message`].
+    pub fn set_trace(&mut self, enabled: bool) {
+        self.trace = enabled;
+    }
+
+    /// Returns the last known GPU time of the pass, in milliseconds, or `None` before the first result.
+    pub fn pass_time(&self, pass: &'static str) -> Option<f64> {
+        self.latest.get(pass).copied()
+    }
+
+    /// Begins timing a pass, until [`end_pass`](Self::end_pass).
+    pub fn begin_pass(&mut self, pass: &'static str) {
+        if !self.supported {
+            return;
+        }
+        debug_assert!(
+            self.active.is_none(),
+            "the GPU timer queries can't be nested"
+        );
+
+        let query = self.free.pop().unwrap_or_else(|| {
+            let mut query = 0;
+            if let Some(gl_gen_queries) = GL_GEN_QUERIES.get() {
+                unsafe { gl_gen_queries(1, &mut query) };
+            }
+            query
+        });
+        if let Some(gl_begin_query) = GL_BEGIN_QUERY.get() {
+            unsafe { gl_begin_query(TIME_ELAPSED_EXT, query) };
+        }
+        self.active = Some(PendingQuery {
+            query,
+            pass,
+            discarded: false,
+        });
+    }
+
+    /// Ends timing the pass begun with [`begin_pass`](Self::begin_pass). Its time is known a few frames later.
+    pub fn end_pass(&mut self) {
+        let Some(active) = self.active.take() else {
+            return;
+        };
+        if let Some(gl_end_query) = GL_END_QUERY.get() {
+            unsafe { gl_end_query(TIME_ELAPSED_EXT) };
+        }
+        self.pending.push_back(active);
+    }
+
+    /// Times the GPU work of the GL calls made by `func`, under the given pass name.
+    pub fn pass<F, R>(&mut self, pass: &'static str, func: F) -> R
+    where
+        F: FnOnce() -> R,
+    {
+        self.begin_pass(pass);
+        let result = func();
+        self.end_pass();
+        result
+    }
+
+    /// Reads the results of the queries that became available, in submission order, and reports them.
+    /// It's meant to be called once per frame, e.g. at the start of the main loop's function.
+    pub fn poll(&mut self) {
+        let Some(gl_get_query_objectuiv) = GL_GET_QUERY_OBJECTUIV.get() else {
+            return;
+        };
+        if self.pending.is_empty() {
+            return;
+        }
+
+        // Reading the flag resets it, and it covers all the queries in flight.
+        let disjoint = unsafe { html5::emscripten_webgl_get_parameter_d(GPU_DISJOINT_EXT) } != 0.0;
+        if disjoint {
+            for pending in &mut self.pending {
+                pending.discarded = true;
+            }
+        }
+
+        while let Some(pending) = self.pending.front() {
+            let mut available = 0;
+            unsafe {
+                gl_get_query_objectuiv(pending.query, QUERY_RESULT_AVAILABLE, &mut available)
+            };
+            // The queries complete in order, so the later ones aren't available either.
+            if available == 0 {
+                break;
+            }
+
+            let pending = self.pending.pop_front().unwrap();
+            self.free.push(pending.query);
+            if pending.discarded {
+                continue;
+            }
+            let mut nanoseconds = 0;
+            unsafe { gl_get_query_objectuiv(pending.query, QUERY_RESULT, &mut nanoseconds) };
+            self.report(pending.pass, nanoseconds as f64 / 1_000_000.0);
+        }
+    }
+
+    fn report(&mut self, pass: &'static str, milliseconds: f64) {
+        self.latest.insert(pass, milliseconds);
+        if let Some(metric) = self.metrics.get(pass) {
+            metric.record_value(milliseconds);
+        }
+        if self.trace {
+            trace::log_message("gpu", &format!("{pass}: {milliseconds:.3}ms"));
+        }
+        if let Some(onpasstime) = &mut self.onpasstime {
+            onpasstime(pass, milliseconds);
+        }
+    }
+}
+
+impl Drop for GpuProfiler {
+    fn drop(&mut self) {
+        self.end_pass();
+        let queries: Vec<u32> = self
+            .free
+            .drain(..)
+            .chain(self.pending.drain(..).map(|pending| pending.query))
+            .collect();
+        if queries.is_empty() {
+            return;
+        }
+        if let Some(gl_delete_queries) = GL_DELETE_QUERIES.get() {
+            unsafe { gl_delete_queries(queries.len() as i32, queries.as_ptr()) };
+        }
+    }
+}
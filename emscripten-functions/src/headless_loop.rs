@@ -0,0 +1,159 @@
+//! A main loop for headless programs, e.g. simulation servers run in Node.js, that ticks at a fixed rate or as fast as possible.
+//!
+//! [`set_main_loop_with_arg`] is paced by `requestAnimationFrame`, which Node.js doesn't have, or by `setTimeout`, which is clamped and drifts.
+//! The loop of [`set_headless_loop`] is driven by the emscripten-defined [`emscripten_set_immediate`] instead, `setImmediate` in Node.js
+//! and a `postMessage` in browsers, with no minimum delay. At a fixed rate, the ticks are scheduled from the start time of the loop,
+//! so that the late ones don't delay the following ones: the rate doesn't drift. The waits longer than a couple of milliseconds are
+//! done with [`emscripten_set_timeout`], so that an idle server doesn't keep a core busy.
+//!
+//! [`set_main_loop_with_arg`]: crate::emscripten::set_main_loop_with_arg
+//! [`emscripten_set_immediate`]: https://emscripten.org/docs/api_reference/eventloop.h.html#c.emscripten_set_immediate
+//! [`emscripten_set_timeout`]: https://emscripten.org/docs/api_reference/eventloop.h.html#c.emscripten_set_timeout
+
+use std::os::raw::c_void;
+
+use emscripten_functions_sys::html5;
+
+use crate::{emscripten::get_now, scheduler::Step};
+
+// The part of a wait done with immediates rather than a timeout, in milliseconds, as timeouts can fire a millisecond late.
+const TIMEOUT_MARGIN: f64 = 2.0;
+
+/// How a loop set with [`set_headless_loop`] schedules its ticks.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub enum HeadlessTiming {
+    /// A tick every `interval` milliseconds. When the ticks fall behind, up to `max_catch_up` of them run in a row,
+    /// and the rest of the delay is dropped.
+    Fixed { interval: f64, max_catch_up: u32 },
+    /// Ticks back to back, giving the event loop a turn every `slice` milliseconds, for the I/O callbacks to run.
+    Unbounded { slice: f64 },
+}
+
+impl HeadlessTiming {
+    /// A fixed rate of `rate` ticks per second, catching up with at most 4 ticks in a row.
+    pub fn fixed_rate(rate: f64) -> Self {
+        HeadlessTiming::Fixed {
+            interval: 1000.0 / rate,
+            max_catch_up: 4,
+        }
+    }
+}
+
+struct HeadlessState<F, T> {
+    tick: F,
+    state: T,
+    timing: HeadlessTiming,
+    // The time of the next tick with a fixed interval, or of the previous tick otherwise.
+    time: f64,
+}
+
+// Schedules the next turn of the loop in `delay` milliseconds.
+unsafe fn schedule<F, T>(arg: *mut HeadlessState<F, T>, delay: f64)
+where
+    F: 'static + FnMut(&mut T, f64) -> Step,
+    T: 'static,
+{
+    let func = arg as *mut c_void;
+    if delay > TIMEOUT_MARGIN {
+        html5::emscripten_set_timeout(Some(turn::<F, T>), delay - TIMEOUT_MARGIN, func);
+    } else {
+        html5::emscripten_set_immediate(Some(turn::<F, T>), func);
+    }
+}
+
+unsafe extern "C" fn turn<F, T>(arg: *mut c_void)
+where
+    F: 'static + FnMut(&mut T, f64) -> Step,
+    T: 'static,
+{
+    let arg = arg as *mut HeadlessState<F, T>;
+    let data = &mut *arg;
+    match data.timing {
+        HeadlessTiming::Fixed {
+            interval,
+            max_catch_up,
+        } => {
+            let now = get_now();
+            let mut ticks = 0;
+            while data.time <= now && ticks < max_catch_up.max(1) {
+                if (data.tick)(&mut data.state, interval) == Step::Done {
+                    drop(Box::from_raw(arg));
+                    return;
+                }
+                data.time += interval;
+                ticks += 1;
+            }
+            if data.time <= now {
+                data.time = now + interval;
+            }
+            schedule(arg, data.time - get_now());
+        }
+        HeadlessTiming::Unbounded { slice } => {
+            let start = get_now();
+            loop {
+                let now = get_now();
+                let elapsed = now - data.time;
+                data.time = now;
+                if (data.tick)(&mut data.state, elapsed) == Step::Done {
+                    drop(Box::from_raw(arg));
+                    return;
+                }
+                if now - start >= slice {
+                    break;
+                }
+            }
+            schedule(arg, 0.0);
+        }
+    }
+}
+
+/// Starts a headless loop, calling `tick` with the given timing until it returns [`Step::Done`].
+/// It returns right away: the ticks run from the event loop, which keeps the runtime alive meanwhile.
+///
+/// # Arguments
+/// * `tick` - The tick function, called with the state and the time step, in milliseconds: the interval with a fixed timing,
+///   and the time since the previous tick otherwise.
+/// * `state` - The state the tick function interacts with. It will be consumed so that it can be kept alive during the loop.
+/// * `timing` - How the ticks are scheduled.
+///
+/// # Examples
+/// ```rust
+/// // An authoritative server simulating at 60 Hz.
+/// set_headless_loop(
+///     |world, dt| {
+///         world.apply_inputs(network.poll());
+///         world.step(dt);
+///         network.broadcast(world.snapshot());
+///         Step::Continue
+///     },
+///     World::new(),
+///     HeadlessTiming::fixed_rate(60.0),
+/// );
+///
+/// // A benchmark running the simulation as fast as possible.
+/// set_headless_loop(
+///     |world, _| {
+///         world.step(1000.0 / 60.0);
+///         if world.frame() == 100_000 { Step::Done } else { Step::Continue }
+///     },
+///     World::new(),
+///     HeadlessTiming::Unbounded { slice: 10.0 },
+/// );
+/// ```
+pub fn set_headless_loop<F, T>(tick: F, state: T, timing: HeadlessTiming)
+where
+    F: 'static + FnMut(&mut T, f64) -> Step,
+    T: 'static,
+{
+    if let HeadlessTiming::Fixed { interval, .. } = timing {
+        assert!(interval > 0.0, "the tick interval must be positive");
+    }
+
+    let arg = Box::into_raw(Box::new(HeadlessState {
+        tick,
+        state,
+        timing,
+        time: get_now(),
+    }));
+    unsafe { schedule(arg, 0.0) };
+}
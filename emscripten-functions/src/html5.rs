@@ -0,0 +1,331 @@
+//! Select functions (with rust-native parameter and return value types) from the emscripten [`html5.h`] header file.
+//!
+//! [`html5.h`]: https://emscripten.org/docs/api_reference/html5.h.html
+
+use std::{
+    cell::RefCell,
+    collections::BTreeMap,
+    ffi::{CStr, CString},
+    fmt::Display,
+    mem::MaybeUninit,
+    os::raw::{c_char, c_int, c_void},
+    rc::Rc,
+    sync::{
+        atomic::{AtomicU32, Ordering},
+        Mutex,
+    },
+};
+
+use emscripten_functions_sys::html5;
+
+pub mod events;
+
+/// The error returned by a failed html5 function, from its `EMSCRIPTEN_RESULT` value.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Html5Error {
+    /// The browser doesn't support the operation.
+    NotSupported,
+    /// The operation needs to run from an event handler, and couldn't be deferred to one.
+    FailedNotDeferred,
+    /// The target is invalid.
+    InvalidTarget,
+    /// The target couldn't be found in the document.
+    UnknownTarget,
+    /// A parameter is invalid.
+    InvalidParam,
+    /// The operation failed.
+    Failed,
+    /// There's no data to return.
+    NoData,
+    /// The operation timed out.
+    TimedOut,
+    /// Another `EMSCRIPTEN_RESULT` value.
+    Other(c_int),
+}
+
+impl Html5Error {
+    // Converts the result of an html5 function; `EMSCRIPTEN_RESULT_DEFERRED` counts as a success.
+    pub(crate) fn check(result: c_int) -> Result<(), Html5Error> {
+        match result {
+            0 | 1 => Ok(()),
+            html5::EMSCRIPTEN_RESULT_NOT_SUPPORTED => Err(Html5Error::NotSupported),
+            html5::EMSCRIPTEN_RESULT_FAILED_NOT_DEFERRED => Err(Html5Error::FailedNotDeferred),
+            html5::EMSCRIPTEN_RESULT_INVALID_TARGET => Err(Html5Error::InvalidTarget),
+            html5::EMSCRIPTEN_RESULT_UNKNOWN_TARGET => Err(Html5Error::UnknownTarget),
+            html5::EMSCRIPTEN_RESULT_INVALID_PARAM => Err(Html5Error::InvalidParam),
+            html5::EMSCRIPTEN_RESULT_FAILED => Err(Html5Error::Failed),
+            html5::EMSCRIPTEN_RESULT_NO_DATA => Err(Html5Error::NoData),
+            html5::EMSCRIPTEN_RESULT_TIMED_OUT => Err(Html5Error::TimedOut),
+            other => Err(Html5Error::Other(other)),
+        }
+    }
+}
+
+impl Display for Html5Error {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        match self {
+            Html5Error::NotSupported => write!(f, "Operation not supported"),
+            Html5Error::FailedNotDeferred => {
+                write!(
+                    f,
+                    "Operation failed, and couldn't be deferred to an event handler"
+                )
+            }
+            Html5Error::InvalidTarget => write!(f, "Invalid target"),
+            Html5Error::UnknownTarget => write!(f, "Unknown target"),
+            Html5Error::InvalidParam => write!(f, "Invalid parameter"),
+            Html5Error::Failed => write!(f, "Operation failed"),
+            Html5Error::NoData => write!(f, "No data"),
+            Html5Error::TimedOut => write!(f, "Operation timed out"),
+            Html5Error::Other(result) => write!(f, "Operation failed with result {}", result),
+        }
+    }
+}
+
+// The selectors interned by `Target::selector`, leaked so that their pointers stay valid for the rest of the program.
+static INTERNED_SELECTORS: Mutex<BTreeMap<Box<str>, &'static CStr>> = Mutex::new(BTreeMap::new());
+
+/// The `const char *target` of the html5 functions: one of the special `EMSCRIPTEN_EVENT_TARGET_*` values, or a CSS selector
+/// interned for the rest of the program.
+///
+/// Creating one for each call of a per-frame query (e.g. [`get_canvas_element_size`]) would build a C string every time:
+/// a `Target` is instead created once, and copied into each call.
+///
+/// # Examples
+/// ```rust
+/// let canvas = Target::selector("#canvas");
+/// set_main_loop(move || {
+///     let (width, height) = get_element_css_size(canvas).unwrap();
+///     render(width, height);
+/// }, 0, true);
+/// ```
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Target(
+    // The pointer: either a special value, or a leaked string that's never written to.
+    usize,
+);
+
+impl Target {
+    /// `EMSCRIPTEN_EVENT_TARGET_DOCUMENT`, the `document` object.
+    pub const DOCUMENT: Target = Target(1);
+    /// `EMSCRIPTEN_EVENT_TARGET_WINDOW`, the `window` object.
+    pub const WINDOW: Target = Target(2);
+    /// `EMSCRIPTEN_EVENT_TARGET_SCREEN`, the `screen` object.
+    pub const SCREEN: Target = Target(3);
+
+    /// Returns the target of the elements matching the given CSS selector, e.g. `"#canvas"`.
+    /// The selector is copied once per program: the next calls with the same selector return the same target.
+    ///
+    /// # Panics
+    /// If the selector contains a NUL character.
+    pub fn selector(selector: &str) -> Target {
+        let mut interned = INTERNED_SELECTORS.lock().unwrap();
+        if let Some(selector) = interned.get(selector) {
+            return Target(selector.as_ptr() as usize);
+        }
+
+        let c_selector: &'static CStr = Box::leak(
+            CString::new(selector)
+                .expect("the selector mustn't contain nul bytes")
+                .into_boxed_c_str(),
+        );
+        interned.insert(selector.into(), c_selector);
+        Target(c_selector.as_ptr() as usize)
+    }
+
+    /// Returns the target of the given static selector, without interning it.
+    pub fn from_static(selector: &'static CStr) -> Target {
+        Target(selector.as_ptr() as usize)
+    }
+
+    /// Returns the pointer to pass to the html5 functions.
+    pub fn as_ptr(&self) -> *const c_char {
+        self.0 as *const c_char
+    }
+}
+
+/// Returns the size of the canvas' drawing buffer, in pixels, using the emscripten-defined [`emscripten_get_canvas_element_size`].
+///
+/// [`emscripten_get_canvas_element_size`]: https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_get_canvas_element_size
+pub fn get_canvas_element_size(target: Target) -> Result<(c_int, c_int), Html5Error> {
+    let (mut width, mut height) = (0, 0);
+    Html5Error::check(unsafe {
+        html5::emscripten_get_canvas_element_size(target.as_ptr(), &mut width, &mut height)
+    })?;
+    Ok((width, height))
+}
+
+// Bumped whenever a canvas may have been resized, invalidating the cached sizes, like the ones of `webgl::Context`.
+static CANVAS_SIZE_GENERATION: AtomicU32 = AtomicU32::new(0);
+
+/// Invalidates the canvas sizes cached by this crate, e.g. after JS code resized a canvas by setting its `width` or `height`.
+/// The crate's own resizes, and the fullscreen strategies' resize callbacks, invalidate them already.
+pub fn invalidate_canvas_sizes() {
+    CANVAS_SIZE_GENERATION.fetch_add(1, Ordering::Release);
+}
+
+// Returns the number of invalidations so far, which the caches compare with the one they were filled at.
+#[cfg(feature = "webgl")]
+pub(crate) fn canvas_size_generation() -> u32 {
+    CANVAS_SIZE_GENERATION.load(Ordering::Acquire)
+}
+
+/// Sets the size of the canvas' drawing buffer, in pixels, using the emscripten-defined [`emscripten_set_canvas_element_size`].
+///
+/// [`emscripten_set_canvas_element_size`]: https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_set_canvas_element_size
+pub fn set_canvas_element_size(
+    target: Target,
+    width: c_int,
+    height: c_int,
+) -> Result<(), Html5Error> {
+    let result = Html5Error::check(unsafe {
+        html5::emscripten_set_canvas_element_size(target.as_ptr(), width, height)
+    });
+    invalidate_canvas_sizes();
+    result
+}
+
+/// Returns the CSS size of the element, in CSS pixels, using the emscripten-defined [`emscripten_get_element_css_size`].
+///
+/// [`emscripten_get_element_css_size`]: https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_get_element_css_size
+pub fn get_element_css_size(target: Target) -> Result<(f64, f64), Html5Error> {
+    let (mut width, mut height) = (0.0, 0.0);
+    Html5Error::check(unsafe {
+        html5::emscripten_get_element_css_size(target.as_ptr(), &mut width, &mut height)
+    })?;
+    Ok((width, height))
+}
+
+/// Sets the CSS size of the element, in CSS pixels, using the emscripten-defined [`emscripten_set_element_css_size`].
+///
+/// [`emscripten_set_element_css_size`]: https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_set_element_css_size
+pub fn set_element_css_size(target: Target, width: f64, height: f64) -> Result<(), Html5Error> {
+    Html5Error::check(unsafe {
+        html5::emscripten_set_element_css_size(target.as_ptr(), width, height)
+    })
+}
+
+/// Returns the current visibility of the page, using the emscripten-defined [`emscripten_get_visibility_status`].
+///
+/// [`emscripten_get_visibility_status`]: https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_get_visibility_status
+///
+/// # Examples
+/// ```rust
+/// if get_visibility_status().map_or(false, |status| status.hidden != 0) {
+///     println!("Started in a background tab");
+/// }
+/// ```
+pub fn get_visibility_status() -> Result<html5::EmscriptenVisibilityChangeEvent, Html5Error> {
+    let mut status = html5::EmscriptenVisibilityChangeEvent {
+        hidden: 0,
+        visibilityState: 0,
+    };
+    Html5Error::check(unsafe { html5::emscripten_get_visibility_status(&mut status) })?;
+    Ok(status)
+}
+
+/// Returns the state of the mouse as of its last event, using the emscripten-defined [`emscripten_get_mouse_status`].
+///
+/// Emscripten only records the mouse events of the targets with a mouse event listener, e.g. registered with
+/// [`on_mousemove`](events::on_mousemove); the state is all zeroes before the first one.
+///
+/// [`emscripten_get_mouse_status`]: https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_get_mouse_status
+pub fn get_mouse_status() -> Result<html5::EmscriptenMouseEvent, Html5Error> {
+    let mut status = MaybeUninit::<html5::EmscriptenMouseEvent>::zeroed();
+    Html5Error::check(unsafe { html5::emscripten_get_mouse_status(status.as_mut_ptr()) })?;
+    Ok(unsafe { status.assume_init() })
+}
+
+/// Runs the given function before every repaint, until it returns `false`, using the emscripten-defined [`emscripten_request_animation_frame_loop`].
+///
+/// Compared to [`set_main_loop`](crate::emscripten::set_main_loop), it skips the main loop machinery (blockers, timing modes, runner bookkeeping),
+/// and several loops can run at once.
+///
+/// [`emscripten_request_animation_frame_loop`]: https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_request_animation_frame_loop
+///
+/// # Arguments
+/// * `func` - The function to run. It's given the frame's high-resolution timestamp, in milliseconds, as given by the browser to `requestAnimationFrame` callbacks.
+///
+/// # Examples
+/// ```rust
+/// let mut last = None;
+/// request_animation_frame_loop(move |time| {
+///     let dt = last.map_or(0.0, |last| time - last);
+///     last = Some(time);
+///     render(dt);
+///     !should_quit()
+/// });
+/// ```
+pub fn request_animation_frame_loop<F>(func: F)
+where
+    F: 'static + FnMut(f64) -> bool,
+{
+    unsafe extern "C" fn wrapper<F>(time: f64, user_data: *mut c_void) -> c_int
+    where
+        F: 'static + FnMut(f64) -> bool,
+    {
+        let func = user_data as *mut F;
+        if (*func)(time) {
+            html5::EM_TRUE as c_int
+        } else {
+            // The loop stops, so its function is dropped.
+            drop(Box::from_raw(func));
+            html5::EM_FALSE as c_int
+        }
+    }
+
+    let func = Box::into_raw(Box::new(func));
+    unsafe {
+        html5::emscripten_request_animation_frame_loop(Some(wrapper::<F>), func as *mut c_void);
+    }
+}
+
+type FrameCallback = Rc<RefCell<Option<Box<dyn FnOnce(f64)>>>>;
+
+/// The handle of a callback requested with [`request_animation_frame`].
+pub struct AnimationFrameHandle {
+    id: c_int,
+    func: FrameCallback,
+}
+
+impl AnimationFrameHandle {
+    /// Cancels the callback, using the emscripten-defined [`emscripten_cancel_animation_frame`].
+    /// It does nothing if the callback already ran.
+    ///
+    /// [`emscripten_cancel_animation_frame`]: https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_cancel_animation_frame
+    pub fn cancel(self) {
+        if self.func.borrow_mut().take().is_some() {
+            unsafe {
+                html5::emscripten_cancel_animation_frame(self.id);
+                // The reference given to the callback won't be taken back by it anymore.
+                drop(Rc::from_raw(Rc::as_ptr(&self.func)));
+            }
+        }
+    }
+}
+
+/// Runs the given function once, before the next repaint, using the emscripten-defined [`emscripten_request_animation_frame`].
+///
+/// [`emscripten_request_animation_frame`]: https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_request_animation_frame
+///
+/// # Arguments
+/// * `func` - The function to run. It's given the frame's high-resolution timestamp, in milliseconds.
+pub fn request_animation_frame<F>(func: F) -> AnimationFrameHandle
+where
+    F: 'static + FnOnce(f64),
+{
+    unsafe extern "C" fn wrapper(time: f64, user_data: *mut c_void) -> c_int {
+        let func = Rc::from_raw(user_data as *const RefCell<Option<Box<dyn FnOnce(f64)>>>);
+        let func = func.borrow_mut().take();
+        if let Some(func) = func {
+            func(time);
+        }
+        html5::EM_FALSE as c_int
+    }
+
+    let func: FrameCallback = Rc::new(RefCell::new(Some(Box::new(func))));
+    let user_data = Rc::into_raw(func.clone()) as *mut c_void;
+    let id = unsafe { html5::emscripten_request_animation_frame(Some(wrapper), user_data) };
+
+    AnimationFrameHandle { id, func }
+}
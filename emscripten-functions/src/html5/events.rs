@@ -0,0 +1,1043 @@
+//! Safe registration of the html5 [event callbacks], with closures given a borrowed event struct.
+//!
+//! The closure of a listener is boxed once, when it's registered: each event only borrows the struct emscripten filled in,
+//! so high-frequency streams like `mousemove` don't allocate.
+//! A closure returns `true` if it handled the event, which prevents the browser's default action for it.
+//!
+//! The `on_*_on_thread` functions have the events delivered straight to another thread, e.g. a pthread running the game logic,
+//! instead of the registering one.
+//!
+//! The `on_*_passive` functions register [passive] touch and wheel listeners, whose closures can't prevent the default action:
+//! the browser then scrolls without waiting for them, which keeps the scrolling smooth on mobile while wasm handles the event.
+//!
+//! [event callbacks]: https://emscripten.org/docs/api_reference/html5.h.html#registration-functions
+//! [passive]: https://developer.mozilla.org/en-US/docs/Web/API/EventTarget/addEventListener#passive
+
+use std::{
+    cell::{Cell, RefCell, UnsafeCell},
+    ffi::CString,
+    os::raw::{c_char, c_int, c_void},
+    rc::Rc,
+};
+
+use emscripten_functions_sys::{html5, proxying, threading};
+
+pub use emscripten_functions_sys::html5::{
+    EmscriptenFocusEvent, EmscriptenKeyboardEvent, EmscriptenMouseEvent,
+    EmscriptenPointerlockChangeEvent, EmscriptenTouchEvent, EmscriptenTouchPoint,
+    EmscriptenUiEvent, EmscriptenVisibilityChangeEvent, EmscriptenWheelEvent,
+};
+
+use super::{Html5Error, Target};
+
+extern "C" {
+    fn passive_events_begin();
+    fn passive_events_end();
+}
+
+/// The thread an event listener's closure is called on.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum EventThread {
+    /// The thread that registered the listener.
+    CallingThread,
+    /// The main runtime thread (the one that ran `main`).
+    MainRuntimeThread,
+    /// The given pthread. The events are proxied to it, and handled when it returns to its event loop.
+    Thread(html5::pthread_t),
+}
+
+impl EventThread {
+    // `EM_CALLBACK_THREAD_CONTEXT_MAIN_RUNTIME_THREAD` and `EM_CALLBACK_THREAD_CONTEXT_CALLING_THREAD`, pointer-valued macros bindgen doesn't generate.
+    fn as_raw(self) -> html5::pthread_t {
+        match self {
+            EventThread::CallingThread => 0x2 as html5::pthread_t,
+            EventThread::MainRuntimeThread => 0x1 as html5::pthread_t,
+            EventThread::Thread(thread) => thread,
+        }
+    }
+}
+
+/// The element an event listener is registered on.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum EventTarget<'a> {
+    /// The `window` object.
+    Window,
+    /// The `document` object.
+    Document,
+    /// The `screen` object.
+    Screen,
+    /// The element matching a CSS selector, e.g. `#canvas`.
+    Selector(&'a str),
+    /// The given target, without copying its selector.
+    Target(Target),
+}
+
+// The target in the form emscripten takes it: a special pointer value, or a selector string.
+// The special targets are compared by value, and the selectors by content.
+#[derive(PartialEq, Eq)]
+enum RawTarget {
+    Special(usize),
+    Selector(CString),
+}
+
+impl RawTarget {
+    fn new(target: EventTarget) -> Self {
+        match target {
+            EventTarget::Document => RawTarget::Special(1),
+            EventTarget::Window => RawTarget::Special(2),
+            EventTarget::Screen => RawTarget::Special(3),
+            EventTarget::Target(target) => RawTarget::Special(target.as_ptr() as usize),
+            EventTarget::Selector(selector) => RawTarget::Selector(
+                CString::new(selector).expect("the selector mustn't contain nul bytes"),
+            ),
+        }
+    }
+
+    fn as_ptr(&self) -> *const c_char {
+        match self {
+            RawTarget::Special(value) => *value as *const c_char,
+            RawTarget::Selector(selector) => selector.as_ptr(),
+        }
+    }
+}
+
+type Callback<E> = Option<
+    unsafe extern "C" fn(event_type: c_int, event: *const E, user_data: *mut c_void) -> c_int,
+>;
+type Setter<E> = unsafe extern "C" fn(
+    target: *const c_char,
+    user_data: *mut c_void,
+    use_capture: c_int,
+    callback: Callback<E>,
+    target_thread: html5::pthread_t,
+) -> c_int;
+
+/// A registered event listener. Dropping it unregisters the listener and drops its closure.
+///
+/// Several listeners can be registered for the same event and target. Emscripten only removes all of a target's listeners
+/// of an event at once: dropping one of them re-registers the others of the thread, so that they keep getting the events.
+#[must_use = "the listener is unregistered when dropped"]
+pub struct EventListener {
+    // Shared with the listener's registration, which outlives it once it's forgotten.
+    target: Rc<RawTarget>,
+    use_capture: bool,
+    thread: EventThread,
+    user_data: *mut c_void,
+    // The listener's slot in the thread's registry.
+    slot: usize,
+    // Unregisters the listener and drops its closure; `None` once forgotten.
+    release: Option<unsafe fn(&EventListener)>,
+}
+
+impl EventListener {
+    /// Keeps the listener registered for the rest of the program.
+    pub fn forget(mut self) {
+        // Its registration stays in the registry, to be re-registered along with the others.
+        self.release = None;
+    }
+}
+
+impl Drop for EventListener {
+    fn drop(&mut self) {
+        if let Some(release) = self.release {
+            let registration = REGISTRY.with(|registry| registry.borrow_mut().remove(self.slot));
+            unsafe { release(self) };
+            rearm_all(&registration);
+        }
+    }
+}
+
+// What's needed to register a listener again, with the types of its setter and trampoline erased.
+#[derive(Clone)]
+struct Registration {
+    target: Rc<RawTarget>,
+    setter: usize,
+    trampoline: usize,
+    user_data: *mut c_void,
+    use_capture: bool,
+    thread: EventThread,
+    passive: bool,
+    // `arm::<E>`, registering the listener, or unregistering all the listeners of its event and target.
+    arm: unsafe fn(&Registration, bool) -> c_int,
+}
+
+impl Registration {
+    // Whether the two listeners share their event and target.
+    fn same_event(&self, other: &Registration) -> bool {
+        self.setter == other.setter && self.target == other.target
+    }
+}
+
+unsafe fn arm<E>(registration: &Registration, register: bool) -> c_int {
+    let setter = std::mem::transmute::<usize, Setter<E>>(registration.setter);
+    if !register {
+        return setter(
+            registration.target.as_ptr(),
+            std::ptr::null_mut(),
+            registration.use_capture as c_int,
+            None,
+            registration.thread.as_raw(),
+        );
+    }
+
+    if registration.passive {
+        passive_events_begin();
+    }
+    let result = setter(
+        registration.target.as_ptr(),
+        registration.user_data,
+        registration.use_capture as c_int,
+        Some(std::mem::transmute::<
+            usize,
+            unsafe extern "C" fn(c_int, *const E, *mut c_void) -> c_int,
+        >(registration.trampoline)),
+        registration.thread.as_raw(),
+    );
+    if registration.passive {
+        passive_events_end();
+    }
+    result
+}
+
+// The listeners registered on the thread, in a slab indexed by the listeners' slots.
+#[derive(Default)]
+struct Registry {
+    slots: Vec<Option<Registration>>,
+    free: Vec<usize>,
+}
+
+impl Registry {
+    fn insert(&mut self, registration: Registration) -> usize {
+        match self.free.pop() {
+            Some(slot) => {
+                self.slots[slot] = Some(registration);
+                slot
+            }
+            None => {
+                self.slots.push(Some(registration));
+                self.slots.len() - 1
+            }
+        }
+    }
+
+    fn remove(&mut self, slot: usize) -> Registration {
+        self.free.push(slot);
+        self.slots[slot].take().unwrap()
+    }
+}
+
+thread_local! {
+    static REGISTRY: RefCell<Registry> = RefCell::new(Registry::default());
+}
+
+// Registers again the thread's listeners of the event and target of a removed one, which emscripten removed along with it.
+// The registry is read after the removed listener's closure is dropped, as dropping it may drop other listeners.
+fn rearm_all(removed: &Registration) {
+    let others: Vec<Registration> = REGISTRY.with(|registry| {
+        registry
+            .borrow()
+            .slots
+            .iter()
+            .flatten()
+            .filter(|registration| registration.same_event(removed))
+            .cloned()
+            .collect()
+    });
+    if let Some(first) = others.first() {
+        unsafe {
+            // A listener dropped along with the closure may have re-registered them already.
+            (first.arm)(first, false);
+            for registration in &others {
+                (registration.arm)(registration, true);
+            }
+        }
+    }
+}
+
+// The boxed closure of a listener, which counts the calls in progress:
+// a closure dropping its own listener has its drop deferred until it returns, instead of being freed while it runs.
+struct Boxed<F> {
+    calls: Cell<usize>,
+    released: Cell<bool>,
+    callback: UnsafeCell<F>,
+}
+
+// Calls the closure boxed at `user_data` with `call`, then drops it if it was released meanwhile.
+unsafe fn call_boxed<F, R>(user_data: *mut c_void, call: impl FnOnce(&mut F) -> R) -> R {
+    let boxed = &*(user_data as *const Boxed<F>);
+    boxed.calls.set(boxed.calls.get() + 1);
+    let result = call(&mut *boxed.callback.get());
+    let calls = boxed.calls.get() - 1;
+    boxed.calls.set(calls);
+    if calls == 0 && boxed.released.get() {
+        drop(Box::from_raw(user_data as *mut Boxed<F>));
+    }
+    result
+}
+
+unsafe extern "C" fn trampoline<E, F>(
+    _event_type: c_int,
+    event: *const E,
+    user_data: *mut c_void,
+) -> c_int
+where
+    F: FnMut(&E) -> bool,
+{
+    call_boxed(user_data, |callback: &mut F| callback(&*event) as c_int)
+}
+
+fn listen<E, F>(
+    setter: Setter<E>,
+    release: unsafe fn(&EventListener),
+    target: EventTarget,
+    use_capture: bool,
+    thread: EventThread,
+    callback: F,
+) -> Result<EventListener, Html5Error>
+where
+    F: 'static + FnMut(&E) -> bool,
+{
+    listen_with(
+        setter,
+        release,
+        target,
+        use_capture,
+        thread,
+        callback,
+        trampoline::<E, F>,
+        false,
+    )
+}
+
+// Like `listen`, with the given trampoline calling the closure of type `F`, and the listener made passive if asked for.
+#[allow(clippy::too_many_arguments)]
+fn listen_with<E, F>(
+    setter: Setter<E>,
+    release: unsafe fn(&EventListener),
+    target: EventTarget,
+    use_capture: bool,
+    thread: EventThread,
+    callback: F,
+    trampoline: unsafe extern "C" fn(c_int, *const E, *mut c_void) -> c_int,
+    passive: bool,
+) -> Result<EventListener, Html5Error>
+where
+    F: 'static,
+{
+    let target = Rc::new(RawTarget::new(target));
+    let user_data = Box::into_raw(Box::new(Boxed {
+        calls: Cell::new(0),
+        released: Cell::new(false),
+        callback: UnsafeCell::new(callback),
+    })) as *mut c_void;
+
+    let registration = Registration {
+        target: target.clone(),
+        setter: setter as usize,
+        trampoline: trampoline as usize,
+        user_data,
+        use_capture,
+        thread,
+        passive,
+        arm: arm::<E>,
+    };
+    let result = unsafe { arm::<E>(&registration, true) };
+    if let Err(err) = Html5Error::check(result) {
+        drop(unsafe { Box::from_raw(user_data as *mut Boxed<F>) });
+        return Err(err);
+    }
+
+    Ok(EventListener {
+        target,
+        use_capture,
+        thread,
+        user_data,
+        slot: REGISTRY.with(|registry| registry.borrow_mut().insert(registration)),
+        release: Some(release),
+    })
+}
+
+// Runs on the thread the closure is called on, so a call in progress there is the closure dropping its own listener.
+unsafe extern "C" fn drop_callback<F>(user_data: *mut c_void) {
+    let boxed = &*(user_data as *const Boxed<F>);
+    if boxed.calls.get() > 0 {
+        boxed.released.set(true);
+    } else {
+        drop(Box::from_raw(user_data as *mut Boxed<F>));
+    }
+}
+
+// The `release` of a listener registered with `setter` and a closure of type `F`.
+unsafe fn unregister<E, F>(setter: Setter<E>, listener: &EventListener) {
+    setter(
+        listener.target.as_ptr(),
+        std::ptr::null_mut(),
+        listener.use_capture as c_int,
+        None,
+        listener.thread.as_raw(),
+    );
+
+    let target_thread = match listener.thread {
+        EventThread::CallingThread => None,
+        EventThread::MainRuntimeThread => Some(threading::emscripten_main_runtime_thread_id()),
+        EventThread::Thread(thread) => Some(thread),
+    };
+    match target_thread {
+        // Events proxied before the listener was unregistered may still be queued on the target thread:
+        // the closure is dropped there, after them, as the system queue runs its calls in order.
+        Some(target_thread)
+            if proxying::emscripten_proxy_async(
+                proxying::emscripten_proxy_get_system_queue(),
+                target_thread,
+                Some(drop_callback::<F>),
+                listener.user_data,
+            ) != 0 => {}
+        _ => drop_callback::<F>(listener.user_data),
+    }
+}
+
+// Registers a listener delivered on the calling thread.
+// `release` is the matching `release_*` function: a closure capturing the setter couldn't be a `fn` pointer.
+fn register<E, F>(
+    setter: Setter<E>,
+    release: unsafe fn(&EventListener),
+    target: EventTarget,
+    use_capture: bool,
+    callback: F,
+) -> Result<EventListener, Html5Error>
+where
+    F: 'static + FnMut(&E) -> bool,
+{
+    listen(
+        setter,
+        release,
+        target,
+        use_capture,
+        EventThread::CallingThread,
+        callback,
+    )
+}
+
+unsafe extern "C" fn passive_trampoline<E, F>(
+    _event_type: c_int,
+    event: *const E,
+    user_data: *mut c_void,
+) -> c_int
+where
+    F: FnMut(&E),
+{
+    call_boxed(user_data, |callback: &mut F| callback(&*event));
+    0
+}
+
+// Registers a passive listener delivered on the calling thread, which must be the main browser thread:
+// the registrations made on other threads are proxied to it, and wouldn't be made passive.
+fn register_passive<E, F>(
+    setter: Setter<E>,
+    release: unsafe fn(&EventListener),
+    target: EventTarget,
+    use_capture: bool,
+    callback: F,
+) -> Result<EventListener, Html5Error>
+where
+    F: 'static + FnMut(&E),
+{
+    debug_assert!(
+        crate::threading::is_main_browser_thread(),
+        "passive listeners must be registered from the main browser thread"
+    );
+    listen_with(
+        setter,
+        release,
+        target,
+        use_capture,
+        EventThread::CallingThread,
+        callback,
+        passive_trampoline::<E, F>,
+        true,
+    )
+}
+
+// Defines the listener functions of events whose setter takes a target: `on_<event>`, which registers the closure on the calling thread,
+// `on_<event>_on_thread`, which has the events delivered to another one, and the function unregistering their listeners.
+// Each comes with the event struct its closures borrow, and the emscripten setter.
+macro_rules! event_listeners {
+    ($(
+        $(#[$doc:meta])*
+        fn $on:ident;
+        $(#[$thread_doc:meta])*
+        fn $on_thread:ident;
+        fn $release:ident($event:ty, $setter:ident);
+    )*) => {$(
+        unsafe fn $release<F>(listener: &EventListener) {
+            unregister::<$event, F>(html5::$setter, listener);
+        }
+
+        $(#[$doc])*
+        pub fn $on<F>(
+            target: EventTarget,
+            use_capture: bool,
+            callback: F,
+        ) -> Result<EventListener, Html5Error>
+        where
+            F: 'static + FnMut(&$event) -> bool,
+        {
+            register(
+                html5::$setter,
+                $release::<F>,
+                target,
+                use_capture,
+                callback,
+            )
+        }
+
+        $(#[$thread_doc])*
+        pub fn $on_thread<F>(
+            target: EventTarget,
+            use_capture: bool,
+            thread: EventThread,
+            callback: F,
+        ) -> Result<EventListener, Html5Error>
+        where
+            F: 'static + Send + FnMut(&$event) -> bool,
+        {
+            listen(
+                html5::$setter,
+                $release::<F>,
+                target,
+                use_capture,
+                thread,
+                callback,
+            )
+        }
+    )*};
+}
+
+// The `visibilitychange` setter has no target (it's always the document), so it's adapted to the other setters' signature.
+unsafe extern "C" fn set_visibilitychange_callback_on_thread(
+    _target: *const c_char,
+    user_data: *mut c_void,
+    use_capture: c_int,
+    callback: Callback<EmscriptenVisibilityChangeEvent>,
+    target_thread: html5::pthread_t,
+) -> c_int {
+    html5::emscripten_set_visibilitychange_callback_on_thread(
+        user_data,
+        use_capture,
+        callback,
+        target_thread,
+    )
+}
+
+unsafe fn release_visibilitychange<F>(listener: &EventListener) {
+    unregister::<EmscriptenVisibilityChangeEvent, F>(
+        set_visibilitychange_callback_on_thread,
+        listener,
+    );
+}
+
+// The WebGL context events carry no event struct, so their closures take no argument.
+unsafe extern "C" fn context_trampoline<F>(
+    _event_type: c_int,
+    _reserved: *const c_void,
+    user_data: *mut c_void,
+) -> c_int
+where
+    F: FnMut() -> bool,
+{
+    call_boxed(user_data, |callback: &mut F| callback() as c_int)
+}
+
+unsafe fn release_webglcontextlost<F>(listener: &EventListener) {
+    unregister::<c_void, F>(
+        html5::emscripten_set_webglcontextlost_callback_on_thread,
+        listener,
+    );
+}
+unsafe fn release_webglcontextrestored<F>(listener: &EventListener) {
+    unregister::<c_void, F>(
+        html5::emscripten_set_webglcontextrestored_callback_on_thread,
+        listener,
+    );
+}
+
+event_listeners! {
+    /// Listens to the `keydown` events of the target, using the emscripten-defined [`emscripten_set_keydown_callback_on_thread`].
+    ///
+    /// [`emscripten_set_keydown_callback_on_thread`]: https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_set_keydown_callback_on_thread
+    ///
+    /// # Arguments
+    /// * `target` - The element to listen on.
+    /// * `use_capture` - Whether to listen in the capture phase, rather than the bubbling phase.
+    /// * `callback` - The function called with each event. It returns `true` to prevent the event's default action.
+    ///
+    /// # Examples
+    /// ```rust
+    /// let listener = on_keydown(EventTarget::Window, false, |event| {
+    ///     println!("Key {} down", event.keyCode);
+    ///     false
+    /// })
+    /// .unwrap();
+    /// listener.forget();
+    /// ```
+    fn on_keydown;
+    /// Listens to the `keydown` events of the target like [`on_keydown`], calling `callback` on the given thread.
+    ///
+    /// # Examples
+    /// ```rust
+    /// // On the main thread, with `logic_thread` the pthread running the game logic.
+    /// on_keydown_on_thread(EventTarget::Window, false, EventThread::Thread(logic_thread), |event| {
+    ///     queue_key(event.keyCode);
+    ///     true
+    /// })
+    /// .unwrap()
+    /// .forget();
+    /// ```
+    fn on_keydown_on_thread;
+    fn release_keydown(EmscriptenKeyboardEvent, emscripten_set_keydown_callback_on_thread);
+
+    /// Listens to the `keyup` events of the target, like [`on_keydown`].
+    fn on_keyup;
+    /// Listens to the `keyup` events of the target like [`on_keyup`], calling `callback` on the given thread.
+    fn on_keyup_on_thread;
+    fn release_keyup(EmscriptenKeyboardEvent, emscripten_set_keyup_callback_on_thread);
+
+    /// Listens to the `keypress` events of the target, like [`on_keydown`].
+    fn on_keypress;
+    /// Listens to the `keypress` events of the target like [`on_keypress`], calling `callback` on the given thread.
+    fn on_keypress_on_thread;
+    fn release_keypress(EmscriptenKeyboardEvent, emscripten_set_keypress_callback_on_thread);
+
+    /// Listens to the `click` events of the target, like [`on_keydown`].
+    fn on_click;
+    /// Listens to the `click` events of the target like [`on_click`], calling `callback` on the given thread.
+    fn on_click_on_thread;
+    fn release_click(EmscriptenMouseEvent, emscripten_set_click_callback_on_thread);
+
+    /// Listens to the `mousedown` events of the target, like [`on_keydown`].
+    fn on_mousedown;
+    /// Listens to the `mousedown` events of the target like [`on_mousedown`], calling `callback` on the given thread.
+    fn on_mousedown_on_thread;
+    fn release_mousedown(EmscriptenMouseEvent, emscripten_set_mousedown_callback_on_thread);
+
+    /// Listens to the `mouseup` events of the target, like [`on_keydown`].
+    fn on_mouseup;
+    /// Listens to the `mouseup` events of the target like [`on_mouseup`], calling `callback` on the given thread.
+    fn on_mouseup_on_thread;
+    fn release_mouseup(EmscriptenMouseEvent, emscripten_set_mouseup_callback_on_thread);
+
+    /// Listens to the `dblclick` events of the target, like [`on_keydown`].
+    fn on_dblclick;
+    /// Listens to the `dblclick` events of the target like [`on_dblclick`], calling `callback` on the given thread.
+    fn on_dblclick_on_thread;
+    fn release_dblclick(EmscriptenMouseEvent, emscripten_set_dblclick_callback_on_thread);
+
+    /// Listens to the `mousemove` events of the target, like [`on_keydown`].
+    ///
+    /// # Examples
+    /// ```rust
+    /// let mut look = (0, 0);
+    /// let listener = on_mousemove(EventTarget::Selector("#canvas"), false, move |event| {
+    ///     look.0 += event.movementX;
+    ///     look.1 += event.movementY;
+    ///     true
+    /// })
+    /// .unwrap();
+    /// ```
+    fn on_mousemove;
+    /// Listens to the `mousemove` events of the target like [`on_mousemove`], calling `callback` on the given thread.
+    fn on_mousemove_on_thread;
+    fn release_mousemove(EmscriptenMouseEvent, emscripten_set_mousemove_callback_on_thread);
+
+    /// Listens to the `mouseenter` events of the target, like [`on_keydown`].
+    fn on_mouseenter;
+    /// Listens to the `mouseenter` events of the target like [`on_mouseenter`], calling `callback` on the given thread.
+    fn on_mouseenter_on_thread;
+    fn release_mouseenter(EmscriptenMouseEvent, emscripten_set_mouseenter_callback_on_thread);
+
+    /// Listens to the `mouseleave` events of the target, like [`on_keydown`].
+    fn on_mouseleave;
+    /// Listens to the `mouseleave` events of the target like [`on_mouseleave`], calling `callback` on the given thread.
+    fn on_mouseleave_on_thread;
+    fn release_mouseleave(EmscriptenMouseEvent, emscripten_set_mouseleave_callback_on_thread);
+
+    /// Listens to the `wheel` events of the target, like [`on_keydown`].
+    fn on_wheel;
+    /// Listens to the `wheel` events of the target like [`on_wheel`], calling `callback` on the given thread.
+    fn on_wheel_on_thread;
+    fn release_wheel(EmscriptenWheelEvent, emscripten_set_wheel_callback_on_thread);
+}
+
+/// Returns the valid points of a touch event: the first `numTouches` of its `touches`, borrowed from the event.
+pub fn touch_points(event: &EmscriptenTouchEvent) -> &[EmscriptenTouchPoint] {
+    let count = (event.numTouches.max(0) as usize).min(event.touches.len());
+    &event.touches[..count]
+}
+
+/// Returns an iterator over the points of a touch event that changed with it, e.g. the fingers that moved for a `touchmove` event,
+/// borrowed from the event.
+pub fn changed_touches(
+    event: &EmscriptenTouchEvent,
+) -> impl Iterator<Item = &EmscriptenTouchPoint> + '_ {
+    touch_points(event)
+        .iter()
+        .filter(|point| point.isChanged != 0)
+}
+
+event_listeners! {
+    /// Listens to the `touchstart` events of the target, like [`on_keydown`].
+    ///
+    /// Only the first `numTouches` points of the event's `touches` are valid: [`touch_points`] and [`changed_touches`] borrow
+    /// them from the event, which is over 2KB, without copying it.
+    ///
+    /// # Examples
+    /// ```rust
+    /// let _touchmove = on_touchmove(EventTarget::Selector("#canvas"), false, |event| {
+    ///     for point in changed_touches(event) {
+    ///         drag(point.identifier, point.targetX, point.targetY);
+    ///     }
+    ///     true
+    /// })
+    /// .unwrap();
+    /// ```
+    fn on_touchstart;
+    /// Listens to the `touchstart` events of the target like [`on_touchstart`], calling `callback` on the given thread.
+    fn on_touchstart_on_thread;
+    fn release_touchstart(EmscriptenTouchEvent, emscripten_set_touchstart_callback_on_thread);
+
+    /// Listens to the `touchend` events of the target, like [`on_touchstart`].
+    fn on_touchend;
+    /// Listens to the `touchend` events of the target like [`on_touchend`], calling `callback` on the given thread.
+    fn on_touchend_on_thread;
+    fn release_touchend(EmscriptenTouchEvent, emscripten_set_touchend_callback_on_thread);
+
+    /// Listens to the `touchmove` events of the target, like [`on_touchstart`].
+    fn on_touchmove;
+    /// Listens to the `touchmove` events of the target like [`on_touchmove`], calling `callback` on the given thread.
+    fn on_touchmove_on_thread;
+    fn release_touchmove(EmscriptenTouchEvent, emscripten_set_touchmove_callback_on_thread);
+
+    /// Listens to the `touchcancel` events of the target, like [`on_touchstart`].
+    fn on_touchcancel;
+    /// Listens to the `touchcancel` events of the target like [`on_touchcancel`], calling `callback` on the given thread.
+    fn on_touchcancel_on_thread;
+    fn release_touchcancel(EmscriptenTouchEvent, emscripten_set_touchcancel_callback_on_thread);
+}
+
+/// Listens to the `wheel` events of the target with a passive listener, whose closure can't prevent the default action, e.g. the scrolling.
+/// It must be called from the main browser thread.
+///
+/// # Examples
+/// ```rust
+/// let _wheel = on_wheel_passive(EventTarget::Window, false, |event| {
+///     analytics.record_scroll(event.deltaY);
+/// })
+/// .unwrap();
+/// ```
+pub fn on_wheel_passive<F>(
+    target: EventTarget,
+    use_capture: bool,
+    callback: F,
+) -> Result<EventListener, Html5Error>
+where
+    F: 'static + FnMut(&EmscriptenWheelEvent),
+{
+    register_passive(
+        html5::emscripten_set_wheel_callback_on_thread,
+        release_wheel::<F>,
+        target,
+        use_capture,
+        callback,
+    )
+}
+
+/// Listens to the `touchstart` events of the target with a passive listener, whose closure can't prevent the default action, e.g. the scrolling.
+/// It must be called from the main browser thread.
+pub fn on_touchstart_passive<F>(
+    target: EventTarget,
+    use_capture: bool,
+    callback: F,
+) -> Result<EventListener, Html5Error>
+where
+    F: 'static + FnMut(&EmscriptenTouchEvent),
+{
+    register_passive(
+        html5::emscripten_set_touchstart_callback_on_thread,
+        release_touchstart::<F>,
+        target,
+        use_capture,
+        callback,
+    )
+}
+
+/// Listens to the `touchend` events of the target with a passive listener, whose closure can't prevent the default action, e.g. the scrolling.
+/// It must be called from the main browser thread.
+pub fn on_touchend_passive<F>(
+    target: EventTarget,
+    use_capture: bool,
+    callback: F,
+) -> Result<EventListener, Html5Error>
+where
+    F: 'static + FnMut(&EmscriptenTouchEvent),
+{
+    register_passive(
+        html5::emscripten_set_touchend_callback_on_thread,
+        release_touchend::<F>,
+        target,
+        use_capture,
+        callback,
+    )
+}
+
+/// Listens to the `touchmove` events of the target with a passive listener, whose closure can't prevent the default action, e.g. the scrolling.
+/// It must be called from the main browser thread.
+pub fn on_touchmove_passive<F>(
+    target: EventTarget,
+    use_capture: bool,
+    callback: F,
+) -> Result<EventListener, Html5Error>
+where
+    F: 'static + FnMut(&EmscriptenTouchEvent),
+{
+    register_passive(
+        html5::emscripten_set_touchmove_callback_on_thread,
+        release_touchmove::<F>,
+        target,
+        use_capture,
+        callback,
+    )
+}
+
+/// Listens to the `touchcancel` events of the target with a passive listener, whose closure can't prevent the default action, e.g. the scrolling.
+/// It must be called from the main browser thread.
+pub fn on_touchcancel_passive<F>(
+    target: EventTarget,
+    use_capture: bool,
+    callback: F,
+) -> Result<EventListener, Html5Error>
+where
+    F: 'static + FnMut(&EmscriptenTouchEvent),
+{
+    register_passive(
+        html5::emscripten_set_touchcancel_callback_on_thread,
+        release_touchcancel::<F>,
+        target,
+        use_capture,
+        callback,
+    )
+}
+
+event_listeners! {
+    /// Listens to the `focus` events of the target, like [`on_keydown`].
+    fn on_focus;
+    /// Listens to the `focus` events of the target like [`on_focus`], calling `callback` on the given thread.
+    fn on_focus_on_thread;
+    fn release_focus(EmscriptenFocusEvent, emscripten_set_focus_callback_on_thread);
+
+    /// Listens to the `blur` events of the target, like [`on_keydown`].
+    fn on_blur;
+    /// Listens to the `blur` events of the target like [`on_blur`], calling `callback` on the given thread.
+    fn on_blur_on_thread;
+    fn release_blur(EmscriptenFocusEvent, emscripten_set_blur_callback_on_thread);
+
+    /// Listens to the `resize` events of the target, like [`on_keydown`].
+    fn on_resize;
+    /// Listens to the `resize` events of the target like [`on_resize`], calling `callback` on the given thread.
+    fn on_resize_on_thread;
+    fn release_resize(EmscriptenUiEvent, emscripten_set_resize_callback_on_thread);
+
+    /// Listens to the `scroll` events of the target, like [`on_keydown`].
+    fn on_scroll;
+    /// Listens to the `scroll` events of the target like [`on_scroll`], calling `callback` on the given thread.
+    fn on_scroll_on_thread;
+    fn release_scroll(EmscriptenUiEvent, emscripten_set_scroll_callback_on_thread);
+}
+
+/// Listens to the `visibilitychange` events of the document, like [`on_keydown`].
+///
+/// The current visibility can be read with [`get_visibility_status`](crate::html5::get_visibility_status).
+pub fn on_visibilitychange<F>(use_capture: bool, callback: F) -> Result<EventListener, Html5Error>
+where
+    F: 'static + FnMut(&EmscriptenVisibilityChangeEvent) -> bool,
+{
+    register(
+        set_visibilitychange_callback_on_thread,
+        release_visibilitychange::<F>,
+        EventTarget::Document,
+        use_capture,
+        callback,
+    )
+}
+
+/// Listens to the `visibilitychange` events of the document like [`on_visibilitychange`], calling `callback` on the given thread.
+pub fn on_visibilitychange_on_thread<F>(
+    use_capture: bool,
+    thread: EventThread,
+    callback: F,
+) -> Result<EventListener, Html5Error>
+where
+    F: 'static + Send + FnMut(&EmscriptenVisibilityChangeEvent) -> bool,
+{
+    listen(
+        set_visibilitychange_callback_on_thread,
+        release_visibilitychange::<F>,
+        EventTarget::Document,
+        use_capture,
+        thread,
+        callback,
+    )
+}
+
+event_listeners! {
+    /// Listens to the `pointerlockchange` events of the target, usually the document, like [`on_keydown`].
+    ///
+    /// The lock is requested with [`request_pointer_lock`](crate::pointer_lock::request_pointer_lock); the event tells when it's lost, e.g. when the user presses Escape.
+    fn on_pointerlockchange;
+    /// Listens to the `pointerlockchange` events of the target like [`on_pointerlockchange`], calling `callback` on the given thread.
+    fn on_pointerlockchange_on_thread;
+    fn release_pointerlockchange(EmscriptenPointerlockChangeEvent, emscripten_set_pointerlockchange_callback_on_thread);
+}
+
+/// Listens to the `webglcontextlost` events of the target canvas, like [`on_keydown`].
+///
+/// Returning `true` from `callback` prevents the default action, which lets the browser restore the context later.
+/// The [`webgl::Context`](crate::webgl::Context) type registers these listeners with [`Context::on_lost`](crate::webgl::Context::on_lost).
+pub fn on_webglcontextlost<F>(
+    target: EventTarget,
+    use_capture: bool,
+    callback: F,
+) -> Result<EventListener, Html5Error>
+where
+    F: 'static + FnMut() -> bool,
+{
+    listen_with(
+        html5::emscripten_set_webglcontextlost_callback_on_thread,
+        release_webglcontextlost::<F>,
+        target,
+        use_capture,
+        EventThread::CallingThread,
+        callback,
+        context_trampoline::<F>,
+        false,
+    )
+}
+
+/// Listens to the `webglcontextrestored` events of the target canvas, like [`on_keydown`].
+///
+/// All the GL resources of the context were lost with it, and have to be recreated.
+pub fn on_webglcontextrestored<F>(
+    target: EventTarget,
+    use_capture: bool,
+    callback: F,
+) -> Result<EventListener, Html5Error>
+where
+    F: 'static + FnMut() -> bool,
+{
+    listen_with(
+        html5::emscripten_set_webglcontextrestored_callback_on_thread,
+        release_webglcontextrestored::<F>,
+        target,
+        use_capture,
+        EventThread::CallingThread,
+        callback,
+        context_trampoline::<F>,
+        false,
+    )
+}
+
+#[cfg(test)]
+mod tests {
+    use std::ffi::CStr;
+
+    use super::*;
+
+    thread_local! {
+        // The selectors and registered-ness of the calls of `fake_setter`.
+        static CALLS: RefCell<Vec<(String, bool)>> = const { RefCell::new(Vec::new()) };
+    }
+
+    unsafe extern "C" fn fake_setter(
+        target: *const c_char,
+        _user_data: *mut c_void,
+        _use_capture: c_int,
+        callback: Callback<EmscriptenMouseEvent>,
+        _target_thread: html5::pthread_t,
+    ) -> c_int {
+        let selector = CStr::from_ptr(target).to_string_lossy().into_owned();
+        CALLS.with(|calls| calls.borrow_mut().push((selector, callback.is_some())));
+        html5::EMSCRIPTEN_RESULT_SUCCESS as c_int
+    }
+
+    unsafe fn release_fake<F>(listener: &EventListener) {
+        unregister::<EmscriptenMouseEvent, F>(fake_setter, listener);
+    }
+
+    fn listen_fake<F>(callback: F) -> EventListener
+    where
+        F: 'static + FnMut(&EmscriptenMouseEvent) -> bool,
+    {
+        register(
+            fake_setter,
+            release_fake::<F>,
+            EventTarget::Selector("#canvas"),
+            false,
+            callback,
+        )
+        .unwrap()
+    }
+
+    #[test]
+    fn closure_can_drop_its_own_listener() {
+        struct Flag(Rc<Cell<bool>>);
+        impl Drop for Flag {
+            fn drop(&mut self) {
+                self.0.set(true);
+            }
+        }
+
+        let dropped = Rc::new(Cell::new(false));
+        let own: Rc<RefCell<Option<EventListener>>> = Rc::default();
+        let flag = Flag(dropped.clone());
+        let listener = listen_fake({
+            let own = own.clone();
+            move |_| {
+                own.borrow_mut().take();
+                // The closure, and what it captured, outlives the call.
+                !flag.0.get()
+            }
+        });
+        let user_data = listener.user_data;
+        let trampoline = REGISTRY.with(|registry| {
+            registry.borrow().slots[listener.slot]
+                .as_ref()
+                .unwrap()
+                .trampoline
+        });
+        *own.borrow_mut() = Some(listener);
+
+        // Delivers an event the way emscripten would.
+        let event: EmscriptenMouseEvent = unsafe { std::mem::zeroed() };
+        let handled = unsafe {
+            let trampoline = std::mem::transmute::<
+                usize,
+                unsafe extern "C" fn(c_int, *const EmscriptenMouseEvent, *mut c_void) -> c_int,
+            >(trampoline);
+            trampoline(0, &event, user_data)
+        };
+        assert_eq!(handled, 1);
+        assert!(dropped.get());
+    }
+
+    #[test]
+    fn forgotten_listener_is_rearmed_with_its_selector() {
+        listen_fake(|_| false).forget();
+        let sibling = listen_fake(|_| true);
+        CALLS.with(|calls| calls.borrow_mut().clear());
+
+        // The forgotten listener's selector outlives it: it's unregistered and registered again with it.
+        drop(sibling);
+        let calls = CALLS.with(|calls| calls.take());
+        assert!(calls.iter().all(|(selector, _)| selector == "#canvas"));
+        assert_eq!(calls.last().map(|(_, registered)| *registered), Some(true));
+    }
+}
@@ -0,0 +1,555 @@
+//! A key-value store on top of the emscripten-defined asynchronous [IndexedDB functions].
+//!
+//! [IndexedDB functions]: https://emscripten.org/docs/api_reference/emscripten.h.html#asynchronous-indexeddb-api
+
+use std::{
+    cell::{Cell, RefCell},
+    ffi::{CStr, CString},
+    fmt::Display,
+    os::raw::{c_char, c_int, c_uchar, c_void},
+    rc::Rc,
+    slice,
+};
+
+use emscripten_functions_sys::emscripten;
+
+use crate::c_str::with_c_str;
+
+extern "C" {
+    fn idb_store_batch(
+        db_name: *const c_char,
+        keys: *const *const c_char,
+        data: *const *const c_uchar,
+        sizes: *const c_int,
+        count: c_int,
+        callback: unsafe extern "C" fn(*mut c_void, c_int),
+        arg: *mut c_void,
+    );
+    fn idb_load_batch(
+        db_name: *const c_char,
+        keys: *const *const c_char,
+        count: c_int,
+        item: unsafe extern "C" fn(*mut c_void, c_int, *const c_void, c_int, c_int),
+        callback: unsafe extern "C" fn(*mut c_void, c_int),
+        arg: *mut c_void,
+    );
+}
+
+/// The error given to the callbacks of a failed IndexedDB operation.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct IdbError;
+impl Display for IdbError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        write!(f, "IndexedDB operation failed")
+    }
+}
+
+type StoreCallback = Box<dyn FnOnce(Result<(), IdbError>)>;
+
+struct PendingStore {
+    key: String,
+    data: Vec<u8>,
+    callback: StoreCallback,
+}
+
+struct StoreState {
+    db_name: CString,
+    batch: RefCell<Vec<PendingStore>>,
+    flush_scheduled: Cell<bool>,
+}
+
+/// A key-value store in an IndexedDB database, with closure callbacks.
+///
+/// The [`Store::store`] calls are coalesced: all the ones made before the program yields to the browser's event loop
+/// (e.g. during one main loop tick) are written in a single IndexedDB transaction.
+///
+/// The stored data is compatible with emscripten's other IDB functions, using the same database name.
+/// Cloning a `Store` gives another handle to the same store, sharing its pending batch.
+///
+/// # Examples
+/// ```rust
+/// let saves = Store::new("saves");
+///
+/// // Both keys are written in the same transaction.
+/// saves.store("player", player_bytes, |result| {
+///     if result.is_err() {
+///         println!("Couldn't save the player");
+///     }
+/// });
+/// saves.store("world", world_bytes, |_| {});
+///
+/// saves.load("player", |result| match result {
+///     Ok(data) => println!("Loaded {} bytes", data.len()),
+///     Err(err) => println!("{}", err),
+/// });
+/// ```
+#[derive(Clone)]
+pub struct Store {
+    state: Rc<StoreState>,
+}
+
+impl Store {
+    /// Creates a handle to the store in the IndexedDB database with the given name.
+    pub fn new<T>(db_name: T) -> Self
+    where
+        T: Into<String>,
+    {
+        Self {
+            state: Rc::new(StoreState {
+                db_name: CString::new(db_name.into())
+                    .expect("the database name must not contain NUL bytes"),
+                batch: RefCell::new(Vec::new()),
+                flush_scheduled: Cell::new(false),
+            }),
+        }
+    }
+
+    // The name of the database, for the JS functions of other modules using it.
+    pub(crate) fn db_name(&self) -> &CStr {
+        &self.state.db_name
+    }
+
+    /// Queues the storing of the given data under the given key, in the batch written at the next flush.
+    ///
+    /// The batch is flushed automatically once the program yields to the browser's event loop, or with [`Store::flush`].
+    ///
+    /// # Arguments
+    /// * `key` - The key to store the data under.
+    /// * `data` - The data to store.
+    /// * `callback` - The function called with the result of the batch's transaction.
+    pub fn store<T, D, F>(&self, key: T, data: D, callback: F)
+    where
+        T: Into<String>,
+        D: Into<Vec<u8>>,
+        F: 'static + FnOnce(Result<(), IdbError>),
+    {
+        self.state.batch.borrow_mut().push(PendingStore {
+            key: key.into(),
+            data: data.into(),
+            callback: Box::new(callback),
+        });
+
+        if !self.state.flush_scheduled.replace(true) {
+            unsafe {
+                emscripten::emscripten_async_call(
+                    Some(flush_scheduled),
+                    Rc::into_raw(self.state.clone()) as *mut c_void,
+                    0,
+                );
+            }
+        }
+    }
+
+    /// Writes the pending batch of [`Store::store`] calls right away, in a single transaction.
+    pub fn flush(&self) {
+        flush(&self.state);
+    }
+
+    /// Loads the data stored under the given key.
+    ///
+    /// If the key is in the pending batch, its data is given right away, from the batch.
+    pub fn load<F>(&self, key: &str, callback: F)
+    where
+        F: 'static + FnOnce(Result<Vec<u8>, IdbError>),
+    {
+        let pending = self
+            .state
+            .batch
+            .borrow()
+            .iter()
+            .rev()
+            .find(|pending| pending.key == key)
+            .map(|pending| pending.data.clone());
+        if let Some(data) = pending {
+            callback(Ok(data));
+            return;
+        }
+
+        let callback: Box<LoadCallback> = Box::new(Box::new(callback));
+        with_c_str(key, |key| unsafe {
+            emscripten::emscripten_idb_async_load(
+                self.state.db_name.as_ptr(),
+                key,
+                Box::into_raw(callback) as *mut c_void,
+                Some(onload),
+                Some(onload_error),
+            );
+        });
+    }
+
+    /// Loads the data stored under each of the given keys, in a single readonly transaction,
+    /// calling `onitem` with each key's index in `keys` and its data as soon as it's read, in no particular order.
+    /// A missing key is given an error. `ondone` is called once the transaction ended; if it failed,
+    /// the keys not given to `onitem` yet won't be.
+    ///
+    /// The keys in the pending batch are given right away, from the batch.
+    ///
+    /// # Examples
+    /// ```rust
+    /// let keys: Vec<String> = (0..500).map(|chunk| format!("chunk:{chunk}")).collect();
+    /// cache.load_each(&keys, |index, data| {
+    ///     if let Ok(data) = data {
+    ///         world.load_chunk(index, &data);
+    ///     }
+    /// }, |_| println!("All the chunks are loaded"));
+    /// ```
+    pub fn load_each<T, I, D>(&self, keys: &[T], mut onitem: I, ondone: D)
+    where
+        T: AsRef<str>,
+        I: 'static + FnMut(usize, Result<Vec<u8>, IdbError>),
+        D: 'static + FnOnce(Result<(), IdbError>),
+    {
+        let mut indices = Vec::new();
+        let mut names = Vec::new();
+        {
+            let batch = self.state.batch.borrow();
+            for (index, key) in keys.iter().enumerate() {
+                let key = key.as_ref();
+                match batch.iter().rev().find(|pending| pending.key == key) {
+                    Some(pending) => onitem(index, Ok(pending.data.clone())),
+                    None => {
+                        indices.push(index);
+                        names.push(CString::new(key).expect("the keys must not contain NUL bytes"));
+                    }
+                }
+            }
+        }
+        if names.is_empty() {
+            ondone(Ok(()));
+            return;
+        }
+
+        let name_ptrs: Vec<*const c_char> = names.iter().map(|name| name.as_ptr()).collect();
+        let state = Box::new(LoadBatch {
+            indices,
+            onitem: Box::new(onitem),
+            ondone: Box::new(ondone),
+        });
+        // The keys are copied by the JS side during the call.
+        unsafe {
+            idb_load_batch(
+                self.state.db_name.as_ptr(),
+                name_ptrs.as_ptr(),
+                name_ptrs.len() as c_int,
+                onbatch_item,
+                onload_batch,
+                Box::into_raw(state) as *mut c_void,
+            );
+        }
+    }
+
+    /// Like [`Store::load_each`], but gives all the results at once, in the order of `keys`, once the transaction ended.
+    /// If it failed, the keys that weren't read are given an error.
+    pub fn load_many<T, F>(&self, keys: &[T], callback: F)
+    where
+        T: AsRef<str>,
+        F: 'static + FnOnce(Vec<Result<Vec<u8>, IdbError>>),
+    {
+        let results: Rc<RefCell<Vec<Option<LoadResult>>>> =
+            Rc::new(RefCell::new((0..keys.len()).map(|_| None).collect()));
+        let item_results = results.clone();
+
+        self.load_each(
+            keys,
+            move |index, result| item_results.borrow_mut()[index] = Some(result),
+            move |_| {
+                let results = results
+                    .take()
+                    .into_iter()
+                    .map(|result| result.unwrap_or(Err(IdbError)))
+                    .collect();
+                callback(results);
+            },
+        );
+    }
+
+    /// Checks whether some data is stored under the given key.
+    ///
+    /// If the key is in the pending batch, `true` is given right away.
+    pub fn exists<F>(&self, key: &str, callback: F)
+    where
+        F: 'static + FnOnce(Result<bool, IdbError>),
+    {
+        if self
+            .state
+            .batch
+            .borrow()
+            .iter()
+            .any(|pending| pending.key == key)
+        {
+            callback(Ok(true));
+            return;
+        }
+
+        let callback: Box<ExistsCallback> = Box::new(Box::new(callback));
+        with_c_str(key, |key| unsafe {
+            emscripten::emscripten_idb_async_exists(
+                self.state.db_name.as_ptr(),
+                key,
+                Box::into_raw(callback) as *mut c_void,
+                Some(onexists),
+                Some(onexists_error),
+            );
+        });
+    }
+
+    /// Deletes the data stored under the given key.
+    ///
+    /// The pending stores of the same key are dropped from the batch; their callbacks are given `Ok(())`, as they're superseded.
+    pub fn delete<F>(&self, key: &str, callback: F)
+    where
+        F: 'static + FnOnce(Result<(), IdbError>),
+    {
+        let superseded: Vec<PendingStore> = {
+            let mut batch = self.state.batch.borrow_mut();
+            let (superseded, kept) = batch.drain(..).partition(|pending| pending.key == key);
+            *batch = kept;
+            superseded
+        };
+        for pending in superseded {
+            (pending.callback)(Ok(()));
+        }
+
+        let callback: Box<StoreCallback> = Box::new(Box::new(callback));
+        with_c_str(key, |key| unsafe {
+            emscripten::emscripten_idb_async_delete(
+                self.state.db_name.as_ptr(),
+                key,
+                Box::into_raw(callback) as *mut c_void,
+                Some(ondone),
+                Some(ondone_error),
+            );
+        });
+    }
+
+    /// Deletes all the data of the store, including the pending batch, whose callbacks are given `Ok(())`.
+    pub fn clear<F>(&self, callback: F)
+    where
+        F: 'static + FnOnce(Result<(), IdbError>),
+    {
+        let superseded = std::mem::take(&mut *self.state.batch.borrow_mut());
+        for pending in superseded {
+            (pending.callback)(Ok(()));
+        }
+
+        let callback: Box<StoreCallback> = Box::new(Box::new(callback));
+        unsafe {
+            emscripten::emscripten_idb_async_clear(
+                self.state.db_name.as_ptr(),
+                Box::into_raw(callback) as *mut c_void,
+                Some(ondone),
+                Some(ondone_error),
+            );
+        }
+    }
+
+    /// Stores the given data under the given key as a blob, that can be read in parts with [`Store::load_blob`].
+    ///
+    /// Unlike the other methods, it blocks until the data is stored, which requires the program to be linked with `-sASYNCIFY`.
+    /// The pending batch isn't flushed.
+    pub fn store_blob(&self, key: &str, data: &[u8]) -> Result<(), IdbError> {
+        let mut error: c_int = 0;
+        with_c_str(key, |key| unsafe {
+            emscripten::emscripten_idb_store_blob(
+                self.state.db_name.as_ptr(),
+                key,
+                data.as_ptr() as *mut c_void,
+                data.len() as c_int,
+                &mut error,
+            );
+        });
+
+        if error != 0 {
+            Err(IdbError)
+        } else {
+            Ok(())
+        }
+    }
+
+    /// Loads a handle to the blob stored under the given key with [`Store::store_blob`], without reading its data into memory.
+    ///
+    /// It blocks until the blob is loaded, which requires the program to be linked with `-sASYNCIFY`.
+    pub fn load_blob(&self, key: &str) -> Result<IdbBlob, IdbError> {
+        let mut blob: c_int = 0;
+        let mut error: c_int = 0;
+        with_c_str(key, |key| unsafe {
+            emscripten::emscripten_idb_load_blob(
+                self.state.db_name.as_ptr(),
+                key,
+                &mut blob,
+                &mut error,
+            );
+        });
+
+        if error != 0 {
+            Err(IdbError)
+        } else {
+            Ok(IdbBlob { handle: blob })
+        }
+    }
+}
+
+/// A handle to a blob stored in IndexedDB, loaded with [`Store::load_blob`], whose parts can be read on demand.
+///
+/// The blob is freed when the handle is dropped.
+///
+/// # Examples
+/// ```rust
+/// let blob = Store::new("assets").load_blob("terrain").unwrap();
+///
+/// // Streamed in 1MiB parts, straight into the upload buffer.
+/// for (i, part) in upload_buffer.chunks_mut(1 << 20).enumerate() {
+///     blob.read_into(part, i << 20);
+/// }
+/// ```
+#[derive(Debug)]
+pub struct IdbBlob {
+    handle: c_int,
+}
+
+impl IdbBlob {
+    /// Fills `buffer` with the blob's bytes starting at `offset`, using the emscripten-defined `emscripten_idb_read_from_blob`.
+    ///
+    /// The bytes are written straight into `buffer`, without reading the rest of the blob.
+    /// Reading blobs synchronously is only supported in workers.
+    pub fn read_into(&self, buffer: &mut [u8], offset: usize) {
+        unsafe {
+            emscripten::emscripten_idb_read_from_blob(
+                self.handle,
+                offset as c_int,
+                buffer.len() as c_int,
+                buffer.as_mut_ptr() as *mut c_void,
+            );
+        }
+    }
+}
+
+impl Drop for IdbBlob {
+    fn drop(&mut self) {
+        unsafe {
+            emscripten::emscripten_idb_free_blob(self.handle);
+        }
+    }
+}
+
+type LoadResult = Result<Vec<u8>, IdbError>;
+type LoadCallback = Box<dyn FnOnce(LoadResult)>;
+type ExistsCallback = Box<dyn FnOnce(Result<bool, IdbError>)>;
+
+fn flush(state: &StoreState) {
+    let batch = std::mem::take(&mut *state.batch.borrow_mut());
+    if batch.is_empty() {
+        return;
+    }
+
+    let keys: Vec<CString> = batch
+        .iter()
+        .map(|pending| {
+            CString::new(pending.key.as_str()).expect("the keys must not contain NUL bytes")
+        })
+        .collect();
+    let key_ptrs: Vec<*const c_char> = keys.iter().map(|key| key.as_ptr()).collect();
+    let data_ptrs: Vec<*const c_uchar> =
+        batch.iter().map(|pending| pending.data.as_ptr()).collect();
+    let sizes: Vec<c_int> = batch
+        .iter()
+        .map(|pending| pending.data.len() as c_int)
+        .collect();
+    let count = batch.len() as c_int;
+
+    // The data is copied by the JS side during the call, so only the callbacks need to be kept.
+    let callbacks: Box<Vec<StoreCallback>> =
+        Box::new(batch.into_iter().map(|pending| pending.callback).collect());
+
+    unsafe {
+        idb_store_batch(
+            state.db_name.as_ptr(),
+            key_ptrs.as_ptr(),
+            data_ptrs.as_ptr(),
+            sizes.as_ptr(),
+            count,
+            onbatch,
+            Box::into_raw(callbacks) as *mut c_void,
+        );
+    }
+}
+
+unsafe extern "C" fn flush_scheduled(arg: *mut c_void) {
+    let state = Rc::from_raw(arg as *const StoreState);
+    state.flush_scheduled.set(false);
+    flush(&state);
+}
+
+unsafe extern "C" fn onbatch(arg: *mut c_void, ok: c_int) {
+    let callbacks = Box::from_raw(arg as *mut Vec<StoreCallback>);
+    let result = if ok != 0 { Ok(()) } else { Err(IdbError) };
+    for callback in *callbacks {
+        callback(result);
+    }
+}
+
+// The state of a `Store::load_each` transaction.
+struct LoadBatch {
+    // The index in the caller's keys of each key of the transaction.
+    indices: Vec<usize>,
+    onitem: Box<dyn FnMut(usize, LoadResult)>,
+    ondone: StoreCallback,
+}
+
+unsafe extern "C" fn onbatch_item(
+    arg: *mut c_void,
+    index: c_int,
+    data: *const c_void,
+    size: c_int,
+    found: c_int,
+) {
+    let state = &mut *(arg as *mut LoadBatch);
+    let result = if found != 0 {
+        // The JS side frees the data once this function returns.
+        Ok(slice::from_raw_parts(data as *const u8, size as usize).to_vec())
+    } else {
+        Err(IdbError)
+    };
+    (state.onitem)(state.indices[index as usize], result);
+}
+
+unsafe extern "C" fn onload_batch(arg: *mut c_void, ok: c_int) {
+    let state = Box::from_raw(arg as *mut LoadBatch);
+    (state.ondone)(if ok != 0 { Ok(()) } else { Err(IdbError) });
+}
+
+unsafe extern "C" fn onload(arg: *mut c_void, data: *mut c_void, size: c_int) {
+    let callback = Box::from_raw(arg as *mut LoadCallback);
+    // Emscripten frees the data once this function returns.
+    let data = if data.is_null() {
+        Vec::new()
+    } else {
+        slice::from_raw_parts(data as *const u8, size as usize).to_vec()
+    };
+    callback(Ok(data));
+}
+
+unsafe extern "C" fn onload_error(arg: *mut c_void) {
+    let callback = Box::from_raw(arg as *mut LoadCallback);
+    callback(Err(IdbError));
+}
+
+unsafe extern "C" fn onexists(arg: *mut c_void, exists: c_int) {
+    let callback = Box::from_raw(arg as *mut ExistsCallback);
+    callback(Ok(exists != 0));
+}
+
+unsafe extern "C" fn onexists_error(arg: *mut c_void) {
+    let callback = Box::from_raw(arg as *mut ExistsCallback);
+    callback(Err(IdbError));
+}
+
+unsafe extern "C" fn ondone(arg: *mut c_void) {
+    let callback = Box::from_raw(arg as *mut StoreCallback);
+    callback(Ok(()));
+}
+
+unsafe extern "C" fn ondone_error(arg: *mut c_void) {
+    let callback = Box::from_raw(arg as *mut StoreCallback);
+    callback(Err(IdbError));
+}
@@ -0,0 +1,195 @@
+//! A queue of low-priority tasks run while the browser is idle, with [`requestIdleCallback()`], between the frames and input handling.
+//!
+//! Work like cache warming, storage flushes or prefetching doesn't need to run at a precise time, but running it from the main loop
+//! competes with the frame's own work. The tasks queued with [`schedule_idle`] run in the browser's idle periods instead:
+//! each call gets an [`IdleDeadline`] telling how much of the idle period is left, and returns [`Step::Continue`]
+//! to be called again (in this period if there's time left, or in the next one) or [`Step::Done`].
+//!
+//! Where `requestIdleCallback()` is missing (Safari, node), the idle periods are emulated with the emscripten-defined [`emscripten_set_timeout`]:
+//! slices of [`FALLBACK_SLICE`] milliseconds, [`FALLBACK_DELAY`] milliseconds apart.
+//!
+//! [`requestIdleCallback()`]: https://developer.mozilla.org/en-US/docs/Web/API/Window/requestIdleCallback
+//! [`emscripten_set_timeout`]: https://emscripten.org/docs/api_reference/eventloop.h.html#c.emscripten_set_timeout
+
+use std::{
+    cell::{Cell, RefCell},
+    collections::VecDeque,
+    os::raw::{c_int, c_void},
+};
+
+use emscripten_functions_sys::html5;
+
+use crate::{emscripten::get_now, scheduler::Step};
+
+extern "C" {
+    fn idle_request(
+        callback: unsafe extern "C" fn(arg: *mut c_void, did_timeout: c_int),
+        arg: *mut c_void,
+        timeout: f64,
+    ) -> c_int;
+    fn idle_time_remaining() -> f64;
+}
+
+/// The length of an emulated idle period, in milliseconds, where `requestIdleCallback()` is missing.
+pub const FALLBACK_SLICE: f64 = 4.0;
+
+/// The time between the emulated idle periods, in milliseconds, where `requestIdleCallback()` is missing.
+pub const FALLBACK_DELAY: f64 = 16.0;
+
+type IdleTask = Box<dyn FnMut(&IdleDeadline) -> Step>;
+
+thread_local! {
+    static IDLE_QUEUE: RefCell<VecDeque<IdleTask>> = const { RefCell::new(VecDeque::new()) };
+    static REQUESTED: Cell<bool> = const { Cell::new(false) };
+    // The timeout of the idle callback requests, in milliseconds; none if <= 0.
+    static TIMEOUT: Cell<f64> = const { Cell::new(0.0) };
+    static PAUSED: Cell<bool> = const { Cell::new(false) };
+}
+
+/// The time left in the idle period a task runs in, given to the tasks queued with [`schedule_idle`].
+pub struct IdleDeadline {
+    // The end of the emulated idle period, or `None` for the browser's one.
+    fallback_end: Option<f64>,
+    did_timeout: bool,
+}
+
+impl IdleDeadline {
+    /// Returns the time left in the idle period, in milliseconds: at most 50, and 0 once it's over.
+    pub fn time_remaining(&self) -> f64 {
+        match self.fallback_end {
+            Some(end) => (end - get_now()).max(0.0),
+            None => unsafe { idle_time_remaining() },
+        }
+    }
+
+    /// Returns `true` if the tasks run because the timeout set with [`set_idle_timeout`] elapsed, rather than because the browser was idle.
+    /// The tasks should then still do a step of their work, even with no time remaining.
+    pub fn did_timeout(&self) -> bool {
+        self.did_timeout
+    }
+}
+
+/// Queues a task to run in the browser's idle periods, until it returns [`Step::Done`].
+///
+/// A task is called with the [`IdleDeadline`] of the period, and should return [`Step::Continue`] once [`IdleDeadline::time_remaining`]
+/// gets low, to be called again in a later period. The tasks run in the order they were queued; one returning `Continue` goes to the back.
+///
+/// # Examples
+/// ```rust
+/// let mut pending = assets_to_warm();
+/// schedule_idle(move |deadline| {
+///     while deadline.time_remaining() > 1.0 {
+///         match pending.pop() {
+///             Some(asset) => warm(asset),
+///             None => return Step::Done,
+///         }
+///     }
+///     Step::Continue
+/// });
+/// ```
+pub fn schedule_idle<F>(task: F)
+where
+    F: 'static + FnMut(&IdleDeadline) -> Step,
+{
+    IDLE_QUEUE.with(|queue| queue.borrow_mut().push_back(Box::new(task)));
+    request_idle_period();
+}
+
+/// Queues a function to run once, in one of the browser's next idle periods.
+pub fn schedule_idle_once<F>(func: F)
+where
+    F: 'static + FnOnce(&IdleDeadline),
+{
+    let mut func = Some(func);
+    schedule_idle(move |deadline| {
+        if let Some(func) = func.take() {
+            func(deadline);
+        }
+        Step::Done
+    });
+}
+
+/// Sets the longest time to wait for an idle period, in milliseconds: past that, the queued tasks run anyway,
+/// with [`IdleDeadline::did_timeout`] returning `true`. With `None`, the default, they wait as long as the browser is busy.
+///
+/// It applies from the next idle period requested.
+pub fn set_idle_timeout(timeout: Option<f64>) {
+    TIMEOUT.with(|value| value.set(timeout.unwrap_or(0.0)));
+}
+
+/// Pauses or resumes the queued idle tasks, e.g. to stop prefetching while the device saves power.
+/// The paused tasks stay queued, and the tasks queued while paused wait for the resume.
+pub fn set_idle_paused(paused: bool) {
+    PAUSED.with(|value| value.set(paused));
+    if !paused && pending_idle_tasks() > 0 {
+        request_idle_period();
+    }
+}
+
+/// Returns `true` if the idle tasks are paused with [`set_idle_paused`].
+pub fn is_idle_paused() -> bool {
+    PAUSED.with(Cell::get)
+}
+
+/// Returns the number of queued idle tasks.
+pub fn pending_idle_tasks() -> usize {
+    IDLE_QUEUE.with(|queue| queue.borrow().len())
+}
+
+/// Drops the queued idle tasks.
+pub fn clear_idle_tasks() {
+    // The tasks are dropped outside of the borrow, as they could queue other ones when dropped.
+    let tasks = IDLE_QUEUE.with(|queue| std::mem::take(&mut *queue.borrow_mut()));
+    drop(tasks);
+}
+
+fn request_idle_period() {
+    if is_idle_paused() || REQUESTED.with(|requested| requested.replace(true)) {
+        return;
+    }
+    let timeout = TIMEOUT.with(Cell::get);
+    unsafe {
+        if idle_request(run_idle_period, std::ptr::null_mut(), timeout) == 0 {
+            html5::emscripten_set_timeout(
+                Some(run_fallback_period),
+                FALLBACK_DELAY,
+                std::ptr::null_mut(),
+            );
+        }
+    }
+}
+
+unsafe extern "C" fn run_idle_period(_arg: *mut c_void, did_timeout: c_int) {
+    run_tasks(&IdleDeadline {
+        fallback_end: None,
+        did_timeout: did_timeout != 0,
+    });
+}
+
+unsafe extern "C" fn run_fallback_period(_arg: *mut c_void) {
+    run_tasks(&IdleDeadline {
+        fallback_end: Some(get_now() + FALLBACK_SLICE),
+        did_timeout: false,
+    });
+}
+
+fn run_tasks(deadline: &IdleDeadline) {
+    REQUESTED.with(|requested| requested.set(false));
+
+    // After a timeout, one step runs even with no time remaining.
+    let mut force_one = deadline.did_timeout();
+    while !is_idle_paused() && (force_one || deadline.time_remaining() > 0.0) {
+        force_one = false;
+        // The queue isn't borrowed during the step, so that the task can queue other ones.
+        let Some(mut task) = IDLE_QUEUE.with(|queue| queue.borrow_mut().pop_front()) else {
+            break;
+        };
+        if task(deadline) == Step::Continue {
+            IDLE_QUEUE.with(|queue| queue.borrow_mut().push_back(task));
+        }
+    }
+
+    if pending_idle_tasks() > 0 {
+        request_idle_period();
+    }
+}
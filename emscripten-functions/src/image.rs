@@ -0,0 +1,150 @@
+//! Image decoding by the browser's native decoders, using emscripten's preload plugins through [`emscripten_run_preload_plugins_data`].
+//!
+//! The browser decodes PNG, JPEG and BMP images off the main thread, often with hardware acceleration,
+//! several times faster than a decoder compiled to wasm, and without blocking the frame.
+//! It must be used from the main browser thread, and the program must not set `Module.noImageDecoding`.
+//!
+//! [`emscripten_run_preload_plugins_data`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_run_preload_plugins_data
+
+use std::{
+    fmt::Display,
+    os::raw::{c_char, c_int, c_void},
+};
+
+use emscripten_functions_sys::emscripten;
+
+use crate::{
+    c_str::with_c_str,
+    executor::{callback_future, CallbackFuture},
+    malloc_buffer::MallocBuffer,
+};
+
+extern "C" {
+    fn image_release_preloaded(name: *const c_char);
+}
+
+/// The error of an image that the browser couldn't decode, or that the preload plugins didn't store in their table.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct ImageDecodeError;
+impl Display for ImageDecodeError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        write!(f, "The image couldn't be decoded")
+    }
+}
+
+/// An image decoded by the browser, with 8-bit RGBA pixels, row by row from the top.
+#[derive(Debug)]
+pub struct DecodedImage {
+    /// The width of the image, in pixels.
+    pub width: u32,
+    /// The height of the image, in pixels.
+    pub height: u32,
+    /// The pixels, `width * height * 4` bytes, in the buffer emscripten allocated for them.
+    pub pixels: MallocBuffer,
+}
+
+impl DecodedImage {
+    /// Copies the pixels into the given buffer, e.g. a texture upload buffer reused between images.
+    ///
+    /// # Panics
+    /// If the buffer isn't `width * height * 4` bytes long.
+    pub fn copy_to(&self, buffer: &mut [u8]) {
+        buffer.copy_from_slice(&self.pixels);
+    }
+}
+
+type OnDecode = Box<dyn FnOnce(Result<DecodedImage, ImageDecodeError>)>;
+
+// The encoded data, kept alive until the decoding ends, and the callback.
+struct Decode {
+    _data: Vec<u8>,
+    callback: OnDecode,
+}
+
+unsafe extern "C" fn onload(arg: *mut c_void, name: *const c_char) {
+    let decode = Box::from_raw(arg as *mut Decode);
+
+    let mut width: c_int = 0;
+    let mut height: c_int = 0;
+    let pixels = emscripten::emscripten_get_preloaded_image_data(name, &mut width, &mut height);
+    image_release_preloaded(name);
+
+    if pixels.is_null() {
+        (decode.callback)(Err(ImageDecodeError));
+        return;
+    }
+    let len = width as usize * height as usize * 4;
+    (decode.callback)(Ok(DecodedImage {
+        width: width as u32,
+        height: height as u32,
+        pixels: MallocBuffer::from_raw(pixels as *mut u8, len),
+    }));
+}
+
+unsafe extern "C" fn onerror(arg: *mut c_void) {
+    let decode = Box::from_raw(arg as *mut Decode);
+    (decode.callback)(Err(ImageDecodeError));
+}
+
+/// Decodes the given encoded image with the browser's decoders, and calls `callback` with its pixels.
+///
+/// The decoding goes through the image preload plugin emscripten registers at startup, the one `--use-preload-plugins` uses for the packaged files,
+/// which stores the decoded canvas in its `preloadedImages` table. There's no fallback decoder: if the program sets `Module.noImageDecoding`,
+/// if the browser can't decode the format, or if the canvas isn't in the table, `callback` gets an [`ImageDecodeError`].
+///
+/// # Arguments
+/// * `data` - The encoded image. It's kept until the decoding ends.
+/// * `extension` - The extension of its format, which selects the decoder: `"png"`, `"jpg"`, `"jpeg"` or `"bmp"`.
+/// * `callback` - The function called with the decoded image, or the error.
+///
+/// # Examples
+/// ```rust
+/// decode_image(png_bytes, "png", |result| match result {
+///     Ok(image) => upload_texture(image.width, image.height, &image.pixels),
+///     Err(err) => console::error(&err.to_string()),
+/// });
+/// ```
+pub fn decode_image<D, F>(data: D, extension: &str, callback: F)
+where
+    D: Into<Vec<u8>>,
+    F: 'static + FnOnce(Result<DecodedImage, ImageDecodeError>),
+{
+    let mut data = data.into();
+    let ptr = data.as_mut_ptr() as *mut c_char;
+    let size = data.len() as c_int;
+    let arg = Box::into_raw(Box::new(Decode {
+        _data: data,
+        callback: Box::new(callback),
+    })) as *mut c_void;
+
+    with_c_str(extension, |extension| unsafe {
+        emscripten::emscripten_run_preload_plugins_data(
+            ptr,
+            size,
+            extension,
+            arg,
+            Some(onload),
+            Some(onerror),
+        )
+    });
+}
+
+/// Returns a future completing with the pixels of the given encoded image, decoded by the browser. See [`decode_image`].
+///
+/// # Examples
+/// ```rust
+/// spawn_local(async {
+///     let data = wget("sprites.png").await.unwrap();
+///     let image = decode_image_async(data.into_vec(), "png").await.unwrap();
+///     image.copy_to(&mut staging_buffer);
+/// });
+/// ```
+pub fn decode_image_async<D>(
+    data: D,
+    extension: &str,
+) -> CallbackFuture<Result<DecodedImage, ImageDecodeError>>
+where
+    D: Into<Vec<u8>>,
+{
+    callback_future(|callback| decode_image(data, extension, callback))
+}
@@ -0,0 +1,401 @@
+//! An input collector built on the [`html5::events`](crate::html5::events) module, that queues compact input records to drain once per frame.
+//!
+//! Handling each DOM event in the game logic as it comes makes the input timing depend on when the browser delivers events within a frame,
+//! and does the full handling work for each of the many `mousemove` events of a frame.
+//! The [`InputCollector`] instead writes a small record per event into a preallocated ring buffer, merging consecutive moves into one,
+//! and the game loop drains the queue at the start of each tick.
+
+use std::{cell::RefCell, rc::Rc};
+
+use crate::{
+    html5::{
+        events::{
+            changed_touches, on_keydown, on_keyup, on_mousedown, on_mousemove, on_mouseup,
+            on_touchcancel, on_touchend, on_touchmove, on_touchstart, on_wheel,
+            EmscriptenKeyboardEvent, EmscriptenMouseEvent, EmscriptenTouchEvent, EventListener,
+            EventTarget,
+        },
+        Html5Error,
+    },
+    keyboard::dom_pk_code,
+};
+
+/// The modifier keys held during an input event.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct Modifiers {
+    pub ctrl: bool,
+    pub shift: bool,
+    pub alt: bool,
+    pub meta: bool,
+}
+
+impl Modifiers {
+    fn new(ctrl: i32, shift: i32, alt: i32, meta: i32) -> Self {
+        Self {
+            ctrl: ctrl != 0,
+            shift: shift != 0,
+            alt: alt != 0,
+            meta: meta != 0,
+        }
+    }
+}
+
+/// The phase of a touch point's [`InputEvent::Touch`] record.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum TouchPhase {
+    Start,
+    Move,
+    End,
+    Cancel,
+}
+
+/// A compact input record. The positions are in CSS pixels, relative to the target element.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub enum InputEvent {
+    /// The mouse moved; consecutive moves are merged, summing their movement.
+    MouseMove {
+        x: i32,
+        y: i32,
+        /// The movement since the previous record, as reported by the browser (it's also given while the pointer is locked).
+        dx: i32,
+        dy: i32,
+    },
+    /// A mouse button was pressed or released.
+    MouseButton {
+        button: u16,
+        pressed: bool,
+        x: i32,
+        y: i32,
+        modifiers: Modifiers,
+    },
+    /// The wheel scrolled; consecutive scrolls with the same delta mode are merged, summing their deltas.
+    Wheel {
+        dx: f64,
+        dy: f64,
+        dz: f64,
+        /// The unit of the deltas: [`DOM_DELTA_PIXEL`](emscripten_functions_sys::html5::DOM_DELTA_PIXEL), `DOM_DELTA_LINE` or `DOM_DELTA_PAGE`.
+        delta_mode: u32,
+    },
+    /// A key was pressed or released.
+    Key {
+        /// The legacy `keyCode` of the key.
+        key_code: u32,
+        /// The `DOM_PK_*` code of the physical key, see [`keyboard`](crate::keyboard).
+        code: u32,
+        pressed: bool,
+        repeat: bool,
+        modifiers: Modifiers,
+    },
+    /// A touch point started, moved, ended or was cancelled; consecutive moves of the same point are merged.
+    Touch {
+        id: i32,
+        phase: TouchPhase,
+        x: i32,
+        y: i32,
+    },
+}
+
+/// An input record, with the time of its (last merged) event.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct InputRecord {
+    /// The event's timestamp, in milliseconds, comparable to [`get_now`](crate::emscripten::get_now).
+    pub timestamp: f64,
+    pub event: InputEvent,
+}
+
+// A fixed-capacity ring buffer of records, overwriting the oldest when full.
+struct InputRing {
+    records: Vec<InputRecord>,
+    capacity: usize,
+    // The index of the oldest record.
+    head: usize,
+    len: usize,
+    dropped: usize,
+    // The sum of the mouse movements since the last `take_mouse_delta`, kept even when the records are dropped.
+    mouse_delta: (i32, i32),
+}
+
+impl InputRing {
+    fn last_mut(&mut self) -> Option<&mut InputRecord> {
+        if self.len == 0 {
+            return None;
+        }
+        let index = (self.head + self.len - 1) % self.capacity;
+        self.records.get_mut(index)
+    }
+
+    fn push(&mut self, record: InputRecord) {
+        if self.len == self.capacity {
+            self.head = (self.head + 1) % self.capacity;
+            self.len -= 1;
+            self.dropped += 1;
+        }
+
+        let index = (self.head + self.len) % self.capacity;
+        if index == self.records.len() {
+            // Only while the buffer hasn't wrapped once; the capacity is reserved upfront.
+            self.records.push(record);
+        } else {
+            self.records[index] = record;
+        }
+        self.len += 1;
+    }
+
+    // Merges the record into the last one if both are mergeable moves, or queues it.
+    fn push_coalesced(&mut self, record: InputRecord) {
+        if let Some(last) = self.last_mut() {
+            let merged = match (&mut last.event, record.event) {
+                (
+                    InputEvent::MouseMove { x, y, dx, dy },
+                    InputEvent::MouseMove {
+                        x: new_x,
+                        y: new_y,
+                        dx: new_dx,
+                        dy: new_dy,
+                    },
+                ) => {
+                    (*x, *y) = (new_x, new_y);
+                    *dx += new_dx;
+                    *dy += new_dy;
+                    true
+                }
+                (
+                    InputEvent::Wheel {
+                        dx,
+                        dy,
+                        dz,
+                        delta_mode,
+                    },
+                    InputEvent::Wheel {
+                        dx: new_dx,
+                        dy: new_dy,
+                        dz: new_dz,
+                        delta_mode: new_mode,
+                    },
+                ) if *delta_mode == new_mode => {
+                    *dx += new_dx;
+                    *dy += new_dy;
+                    *dz += new_dz;
+                    true
+                }
+                (
+                    InputEvent::Touch {
+                        id,
+                        phase: TouchPhase::Move,
+                        x,
+                        y,
+                    },
+                    InputEvent::Touch {
+                        id: new_id,
+                        phase: TouchPhase::Move,
+                        x: new_x,
+                        y: new_y,
+                    },
+                ) if *id == new_id => {
+                    (*x, *y) = (new_x, new_y);
+                    true
+                }
+                _ => false,
+            };
+            if merged {
+                last.timestamp = record.timestamp;
+                return;
+            }
+        }
+
+        self.push(record);
+    }
+}
+
+/// Collects the mouse, wheel and touch events of a target, and the keyboard events of the window, into a queue drained once per frame.
+///
+/// The listeners are unregistered when the collector is dropped.
+///
+/// # Examples
+/// ```rust
+/// let input = InputCollector::new(EventTarget::Selector("#canvas"), 256).unwrap();
+///
+/// set_main_loop(move || {
+///     input.drain(|record| match record.event {
+///         InputEvent::MouseMove { dx, dy, .. } => camera.rotate(dx, dy),
+///         InputEvent::Key { key_code, pressed, .. } => keys.set(key_code, pressed),
+///         _ => {}
+///     });
+///     update_and_draw();
+/// }, 0, true);
+/// ```
+pub struct InputCollector {
+    ring: Rc<RefCell<InputRing>>,
+    _listeners: Vec<EventListener>,
+}
+
+impl InputCollector {
+    /// Starts collecting input events.
+    ///
+    /// # Arguments
+    /// * `target` - The element whose mouse, wheel and touch events are collected, usually the canvas.
+    /// * `capacity` - The number of records the queue holds; when it's full, the oldest records are dropped.
+    pub fn new(target: EventTarget, capacity: usize) -> Result<Self, Html5Error> {
+        assert!(capacity > 0, "the queue must hold at least 1 record");
+
+        let ring = Rc::new(RefCell::new(InputRing {
+            records: Vec::with_capacity(capacity),
+            capacity,
+            head: 0,
+            len: 0,
+            dropped: 0,
+            mouse_delta: (0, 0),
+        }));
+
+        let mouse_button = |pressed: bool| {
+            let ring = ring.clone();
+            move |event: &EmscriptenMouseEvent| {
+                ring.borrow_mut().push(InputRecord {
+                    timestamp: event.timestamp,
+                    event: InputEvent::MouseButton {
+                        button: event.button,
+                        pressed,
+                        x: event.targetX as i32,
+                        y: event.targetY as i32,
+                        modifiers: Modifiers::new(
+                            event.ctrlKey,
+                            event.shiftKey,
+                            event.altKey,
+                            event.metaKey,
+                        ),
+                    },
+                });
+                false
+            }
+        };
+        let key = |pressed: bool| {
+            let ring = ring.clone();
+            move |event: &EmscriptenKeyboardEvent| {
+                ring.borrow_mut().push(InputRecord {
+                    timestamp: event.timestamp,
+                    event: InputEvent::Key {
+                        key_code: event.keyCode as u32,
+                        code: dom_pk_code(event),
+                        pressed,
+                        repeat: event.repeat != 0,
+                        modifiers: Modifiers::new(
+                            event.ctrlKey,
+                            event.shiftKey,
+                            event.altKey,
+                            event.metaKey,
+                        ),
+                    },
+                });
+                false
+            }
+        };
+        let touch = |phase: TouchPhase| {
+            let ring = ring.clone();
+            move |event: &EmscriptenTouchEvent| {
+                let mut ring = ring.borrow_mut();
+                for point in changed_touches(event) {
+                    ring.push_coalesced(InputRecord {
+                        timestamp: event.timestamp,
+                        event: InputEvent::Touch {
+                            id: point.identifier as i32,
+                            phase,
+                            x: point.targetX as i32,
+                            y: point.targetY as i32,
+                        },
+                    });
+                }
+                // Keeps the browser from also sending emulated mouse events.
+                true
+            }
+        };
+
+        let move_ring = ring.clone();
+        let wheel_ring = ring.clone();
+        let listeners = vec![
+            on_mousemove(target, false, move |event| {
+                let mut ring = move_ring.borrow_mut();
+                ring.mouse_delta.0 += event.movementX as i32;
+                ring.mouse_delta.1 += event.movementY as i32;
+                ring.push_coalesced(InputRecord {
+                    timestamp: event.timestamp,
+                    event: InputEvent::MouseMove {
+                        x: event.targetX as i32,
+                        y: event.targetY as i32,
+                        dx: event.movementX as i32,
+                        dy: event.movementY as i32,
+                    },
+                });
+                false
+            })?,
+            on_mousedown(target, false, mouse_button(true))?,
+            on_mouseup(target, false, mouse_button(false))?,
+            on_wheel(target, false, move |event| {
+                wheel_ring.borrow_mut().push_coalesced(InputRecord {
+                    timestamp: event.mouse.timestamp,
+                    event: InputEvent::Wheel {
+                        dx: event.deltaX,
+                        dy: event.deltaY,
+                        dz: event.deltaZ,
+                        delta_mode: event.deltaMode as u32,
+                    },
+                });
+                true
+            })?,
+            on_touchstart(target, false, touch(TouchPhase::Start))?,
+            on_touchmove(target, false, touch(TouchPhase::Move))?,
+            on_touchend(target, false, touch(TouchPhase::End))?,
+            on_touchcancel(target, false, touch(TouchPhase::Cancel))?,
+            on_keydown(EventTarget::Window, false, key(true))?,
+            on_keyup(EventTarget::Window, false, key(false))?,
+        ];
+
+        Ok(Self {
+            ring,
+            _listeners: listeners,
+        })
+    }
+
+    /// Calls `func` with each queued record, oldest first, and empties the queue.
+    pub fn drain<F>(&self, mut func: F)
+    where
+        F: FnMut(&InputRecord),
+    {
+        loop {
+            // The ring isn't borrowed during the call, so that `func` can run code that collects input (e.g. a nested event loop).
+            let record = {
+                let mut ring = self.ring.borrow_mut();
+                if ring.len == 0 {
+                    return;
+                }
+                let record = ring.records[ring.head];
+                ring.head = (ring.head + 1) % ring.capacity;
+                ring.len -= 1;
+                record
+            };
+            func(&record);
+        }
+    }
+
+    /// Returns the number of queued records.
+    pub fn len(&self) -> usize {
+        self.ring.borrow().len
+    }
+
+    /// Returns `true` if no records are queued.
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// Returns the sum of the mouse movements since the last call, and resets it.
+    ///
+    /// Meant to be called once per frame, e.g. to turn the camera while the pointer is [locked](crate::pointer_lock::request_pointer_lock):
+    /// unlike the [`InputEvent::MouseMove`] records, the sum isn't split by the other events, and isn't lost when the queue is full.
+    pub fn take_mouse_delta(&self) -> (i32, i32) {
+        std::mem::take(&mut self.ring.borrow_mut().mouse_delta)
+    }
+
+    /// Returns the number of records dropped because the queue was full, and resets the count.
+    pub fn take_dropped(&self) -> usize {
+        std::mem::take(&mut self.ring.borrow_mut().dropped)
+    }
+}
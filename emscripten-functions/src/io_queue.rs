@@ -0,0 +1,234 @@
+//! A submission queue of file reads and writes, run on dedicated I/O threads, whose completions the main loop collects in batches.
+//!
+//! With WasmFS, `std::fs` calls block the calling thread until the storage backend answers: for the OPFS one, a round trip
+//! to its worker per call, during which the main thread can't render. An [`IoQueue`] runs the submitted requests on its own threads
+//! instead, and queues their [`Completion`]s, which [`IoQueue::completions`] returns in a batch without blocking, e.g. once per frame.
+//!
+//! The program must be built with `-pthread`, and with `-sWASMFS` for the [`wasmfs`](crate::wasmfs) backends.
+
+use std::{
+    cell::Cell,
+    fs::{File, OpenOptions},
+    io::{self, Read, Seek, SeekFrom, Write},
+    path::{Path, PathBuf},
+    sync::{
+        mpsc::{self, Receiver, Sender},
+        Arc, Mutex,
+    },
+    thread,
+};
+
+/// The identifier of a request submitted to an [`IoQueue`], given back in its [`Completion`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct RequestId(u64);
+
+/// The operation of a request submitted to an [`IoQueue`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum IoKind {
+    /// A read, whose completion has the bytes read.
+    Read,
+    /// A write, whose completion gives the written buffer back, to be reused.
+    Write,
+}
+
+/// The result of a request submitted to an [`IoQueue`].
+#[derive(Debug)]
+pub struct Completion {
+    /// The identifier returned when the request was submitted.
+    pub id: RequestId,
+    /// The operation of the request.
+    pub kind: IoKind,
+    /// The bytes read, or the buffer written.
+    pub result: io::Result<Vec<u8>>,
+}
+
+enum Op {
+    // Reads `len` bytes from `offset`, or up to the end of the file if `None`.
+    Read { offset: u64, len: Option<usize> },
+    // Writes at `offset`, or replaces the file's contents if `None`.
+    Write { offset: Option<u64>, data: Vec<u8> },
+}
+
+struct Request {
+    id: RequestId,
+    path: PathBuf,
+    op: Op,
+}
+
+fn run(path: &Path, op: Op) -> io::Result<Vec<u8>> {
+    match op {
+        Op::Read { offset, len } => {
+            let mut file = File::open(path)?;
+            if offset > 0 {
+                file.seek(SeekFrom::Start(offset))?;
+            }
+            let mut data = Vec::new();
+            match len {
+                Some(len) => {
+                    data.resize(len, 0);
+                    let mut read = 0;
+                    while read < len {
+                        match file.read(&mut data[read..])? {
+                            0 => break,
+                            n => read += n,
+                        }
+                    }
+                    data.truncate(read);
+                }
+                None => {
+                    file.read_to_end(&mut data)?;
+                }
+            }
+            Ok(data)
+        }
+        Op::Write { offset: None, data } => {
+            std::fs::write(path, &data)?;
+            Ok(data)
+        }
+        Op::Write {
+            offset: Some(offset),
+            data,
+        } => {
+            let mut file = OpenOptions::new()
+                .write(true)
+                .create(true)
+                .truncate(false)
+                .open(path)?;
+            file.seek(SeekFrom::Start(offset))?;
+            file.write_all(&data)?;
+            Ok(data)
+        }
+    }
+}
+
+fn worker(requests: Arc<Mutex<Receiver<Request>>>, completions: Sender<Completion>) {
+    loop {
+        // The lock is released before running the request, so that the other threads take the next ones meanwhile.
+        let Ok(request) = requests.lock().unwrap().recv() else {
+            return;
+        };
+        let kind = match request.op {
+            Op::Read { .. } => IoKind::Read,
+            Op::Write { .. } => IoKind::Write,
+        };
+        let result = run(&request.path, request.op);
+        // The queue was dropped: the remaining requests are still run, but nobody collects them.
+        let _ = completions.send(Completion {
+            id: request.id,
+            kind,
+            result,
+        });
+    }
+}
+
+/// A queue of file requests run on its I/O threads. See the [module documentation](self).
+///
+/// Dropping the queue lets its threads finish the submitted requests, and exit.
+///
+/// # Examples
+/// ```rust
+/// let queue = IoQueue::new(1)?;
+/// queue.write("/opfs/save.bin", serialize(&state));
+/// for level in 0..8 {
+///     queue.read(format!("/opfs/levels/{level}.bin"));
+/// }
+///
+/// // In the main loop.
+/// for completion in queue.completions() {
+///     match completion.result {
+///         Ok(data) if completion.kind == IoKind::Read => load_level(data),
+///         Ok(_) => {}
+///         Err(err) => eprintln!("I/O error: {err}"),
+///     }
+/// }
+/// ```
+pub struct IoQueue {
+    requests: Sender<Request>,
+    completions: Receiver<Completion>,
+    next_id: Cell<u64>,
+    in_flight: Cell<usize>,
+}
+
+impl IoQueue {
+    /// Starts a queue running its requests on `threads` I/O threads, at least one.
+    ///
+    /// With a single thread, the requests run in the order they were submitted. With more, the requests of different threads
+    /// overlap, letting the storage backend work on several at once, but those on the same file may then run in any order.
+    pub fn new(threads: usize) -> io::Result<Self> {
+        let (requests, receiver) = mpsc::channel();
+        let (sender, completions) = mpsc::channel();
+        let receiver = Arc::new(Mutex::new(receiver));
+        for index in 0..threads.max(1) {
+            let receiver = receiver.clone();
+            let sender = sender.clone();
+            thread::Builder::new()
+                .name(format!("io-{index}"))
+                .spawn(move || worker(receiver, sender))?;
+        }
+        Ok(Self {
+            requests,
+            completions,
+            next_id: Cell::new(0),
+            in_flight: Cell::new(0),
+        })
+    }
+
+    fn submit(&self, path: PathBuf, op: Op) -> RequestId {
+        let id = RequestId(self.next_id.get());
+        self.next_id.set(id.0 + 1);
+        self.in_flight.set(self.in_flight.get() + 1);
+        // The threads only exit once the queue is dropped.
+        let _ = self.requests.send(Request { id, path, op });
+        id
+    }
+
+    /// Submits a read of a whole file.
+    pub fn read<P: Into<PathBuf>>(&self, path: P) -> RequestId {
+        self.submit(
+            path.into(),
+            Op::Read {
+                offset: 0,
+                len: None,
+            },
+        )
+    }
+
+    /// Submits a read of `len` bytes of a file, from `offset`. It completes with fewer bytes if the file ends before.
+    pub fn read_at<P: Into<PathBuf>>(&self, path: P, offset: u64, len: usize) -> RequestId {
+        self.submit(
+            path.into(),
+            Op::Read {
+                offset,
+                len: Some(len),
+            },
+        )
+    }
+
+    /// Submits a write replacing the contents of a file, which is created if it doesn't exist.
+    pub fn write<P: Into<PathBuf>>(&self, path: P, data: Vec<u8>) -> RequestId {
+        self.submit(path.into(), Op::Write { offset: None, data })
+    }
+
+    /// Submits a write of `data` at `offset` in a file, which is created if it doesn't exist, keeping the rest of its contents.
+    pub fn write_at<P: Into<PathBuf>>(&self, path: P, offset: u64, data: Vec<u8>) -> RequestId {
+        self.submit(
+            path.into(),
+            Op::Write {
+                offset: Some(offset),
+                data,
+            },
+        )
+    }
+
+    /// Returns the completions of the requests done since the last call, without blocking.
+    pub fn completions(&self) -> impl Iterator<Item = Completion> + '_ {
+        self.completions.try_iter().inspect(|_| {
+            self.in_flight.set(self.in_flight.get() - 1);
+        })
+    }
+
+    /// Returns the number of submitted requests whose completions weren't returned yet.
+    pub fn in_flight(&self) -> usize {
+        self.in_flight.get()
+    }
+}
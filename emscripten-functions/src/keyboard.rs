@@ -0,0 +1,173 @@
+//! Integer key codes, and a keyboard state kept as a bitset, built on emscripten's `dom_pk_codes.h`.
+//!
+//! The html5 keyboard events give the physical key as the `code` string, e.g. `"KeyW"`, and matching it against the keys of a game
+//! is a string comparison per key per event. [`dom_pk_code`] hashes it into a `DOM_PK_*` integer code instead, the same for a key
+//! whatever the keyboard layout, to use in a `match` or as an index.
+//!
+//! A [`KeyboardState`] holds the pressed keys in 256 bits, and a [`KeyboardTracker`] keeps one up to date from the window's events,
+//! so that the game loop asks whether a key is down with a bit test.
+
+use std::{cell::Cell, ffi::CStr, os::raw::c_int, rc::Rc};
+
+use emscripten_functions_sys::dom_pk_codes;
+
+pub use emscripten_functions_sys::dom_pk_codes::*;
+
+use crate::html5::{
+    events::{on_blur, on_keydown, on_keyup, EmscriptenKeyboardEvent, EventListener, EventTarget},
+    Html5Error,
+};
+
+/// Returns the `DOM_PK_*` code of the physical key of a keyboard event, or [`DOM_PK_UNKNOWN`] for keys without one.
+pub fn dom_pk_code(event: &EmscriptenKeyboardEvent) -> u32 {
+    unsafe { dom_pk_codes::emscripten_compute_dom_pk_code(event.code.as_ptr()) as u32 }
+}
+
+/// Returns the name of a `DOM_PK_*` code, e.g. `"DOM_PK_W"`, using the emscripten-defined `emscripten_dom_pk_code_to_string`.
+pub fn dom_pk_code_name(code: u32) -> &'static str {
+    let name = unsafe { dom_pk_codes::emscripten_dom_pk_code_to_string(code as c_int) };
+    if name.is_null() {
+        return "";
+    }
+    // The names are static ASCII strings.
+    unsafe { CStr::from_ptr(name) }.to_str().unwrap_or("")
+}
+
+// The bit of a code: the codes are either below 0x80, or 0xE0 followed by a byte below 0x80.
+fn bit(code: u32) -> Option<usize> {
+    let low = (code & 0xff) as usize;
+    match code >> 8 {
+        _ if low >= 0x80 => None,
+        0 => Some(low),
+        0xe0 => Some(0x80 | low),
+        _ => None,
+    }
+}
+
+/// The set of the pressed keys, by `DOM_PK_*` code.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq, Hash)]
+pub struct KeyboardState {
+    bits: [u64; 4],
+}
+
+impl KeyboardState {
+    /// Creates a state with no pressed keys.
+    pub const fn new() -> Self {
+        Self { bits: [0; 4] }
+    }
+
+    /// Returns `true` if the key is pressed.
+    pub fn is_down(&self, code: u32) -> bool {
+        bit(code).is_some_and(|bit| self.bits[bit / 64] & (1 << (bit % 64)) != 0)
+    }
+
+    /// Marks the key as pressed or released. Codes outside of `dom_pk_codes.h` are ignored.
+    pub fn set(&mut self, code: u32, down: bool) {
+        if let Some(bit) = bit(code) {
+            if down {
+                self.bits[bit / 64] |= 1 << (bit % 64);
+            } else {
+                self.bits[bit / 64] &= !(1 << (bit % 64));
+            }
+        }
+    }
+
+    /// Releases all the keys.
+    pub fn clear(&mut self) {
+        self.bits = [0; 4];
+    }
+
+    /// Returns `true` if no key is pressed.
+    pub fn is_empty(&self) -> bool {
+        self.bits == [0; 4]
+    }
+
+    /// Returns the keys pressed in this state but not in `previous`, e.g. the state of the previous frame.
+    pub fn pressed_since(&self, previous: &Self) -> Self {
+        let mut bits = self.bits;
+        for (bits, previous) in bits.iter_mut().zip(previous.bits) {
+            *bits &= !previous;
+        }
+        Self { bits }
+    }
+
+    /// Returns an iterator over the codes of the pressed keys.
+    pub fn iter(&self) -> impl Iterator<Item = u32> + '_ {
+        (0..256usize)
+            .filter(move |bit| self.bits[bit / 64] & (1 << (bit % 64)) != 0)
+            .map(|bit| {
+                let low = (bit & 0x7f) as u32;
+                if bit & 0x80 != 0 {
+                    0xe000 | low
+                } else {
+                    low
+                }
+            })
+    }
+}
+
+/// A [`KeyboardState`] kept up to date by the `keydown` and `keyup` events of the window. Dropping it removes the event listeners.
+///
+/// The window's `blur` event releases all the keys, as the keys released while another window has the focus send no `keyup` event.
+///
+/// # Examples
+/// ```rust
+/// let keyboard = KeyboardTracker::new().unwrap();
+/// let mut previous = KeyboardState::new();
+/// set_main_loop(move || {
+///     let keys = keyboard.state();
+///     if keys.is_down(DOM_PK_W) {
+///         player.forward();
+///     }
+///     if keys.pressed_since(&previous).is_down(DOM_PK_SPACE) {
+///         player.jump();
+///     }
+///     previous = keys;
+/// }, 0, true);
+/// ```
+#[must_use = "the listeners are removed when dropped"]
+pub struct KeyboardTracker {
+    state: Rc<Cell<KeyboardState>>,
+    _listeners: [EventListener; 3],
+}
+
+impl KeyboardTracker {
+    /// Starts tracking the keyboard.
+    pub fn new() -> Result<Self, Html5Error> {
+        let state = Rc::new(Cell::new(KeyboardState::new()));
+
+        let key = |down: bool| {
+            let state = state.clone();
+            move |event: &EmscriptenKeyboardEvent| {
+                let mut keys = state.get();
+                keys.set(dom_pk_code(event), down);
+                state.set(keys);
+                false
+            }
+        };
+        let blur_state = state.clone();
+        let listeners = [
+            on_keydown(EventTarget::Window, false, key(true))?,
+            on_keyup(EventTarget::Window, false, key(false))?,
+            on_blur(EventTarget::Window, false, move |_| {
+                blur_state.set(KeyboardState::new());
+                false
+            })?,
+        ];
+
+        Ok(Self {
+            state,
+            _listeners: listeners,
+        })
+    }
+
+    /// Returns `true` if the key is pressed.
+    pub fn is_down(&self, code: u32) -> bool {
+        self.state.get().is_down(code)
+    }
+
+    /// Returns a copy of the current state.
+    pub fn state(&self) -> KeyboardState {
+        self.state.get()
+    }
+}
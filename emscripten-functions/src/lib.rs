@@ -2,6 +2,211 @@
 //! They are grouped by the original function's header file.
 
 #![cfg(target_os = "emscripten")]
+// Without the `std` feature, only the `minimal` module and, with their feature, the `em_asm` macros are available.
+#![cfg_attr(not(feature = "std"), no_std)]
 
+extern crate alloc;
+
+#[cfg(feature = "std")]
+mod c_str;
+
+// Used by the `em_asm!` family of macros.
+#[cfg(feature = "em_asm")]
+#[doc(hidden)]
+pub use emscripten_functions_sys::emscripten as __emscripten_sys;
+
+#[cfg(feature = "std")]
+pub mod adaptive_timing;
+#[cfg(all(feature = "fetch", feature = "idb"))]
+pub mod asset_cache;
+#[cfg(feature = "std")]
+pub mod asset_loader;
+#[cfg(feature = "std")]
+pub mod audio_mixer;
+#[cfg(feature = "std")]
+pub mod buffer_pool;
+#[cfg(feature = "html5")]
+pub mod canvas_resizer;
+#[cfg(feature = "std")]
+pub mod capabilities;
+#[cfg(feature = "std")]
+pub mod clock;
+#[cfg(feature = "std")]
+pub mod compiler_settings;
+#[cfg(feature = "console")]
 pub mod console;
+#[cfg(feature = "webgl")]
+pub mod context_recovery;
+#[cfg(feature = "std")]
+pub mod decompress;
+#[cfg(feature = "std")]
+pub mod display;
+#[cfg(feature = "std")]
+pub mod dom_batch;
+#[cfg(feature = "em_asm")]
+pub mod em_asm;
+#[cfg(feature = "std")]
+pub mod emmalloc;
+#[cfg(feature = "std")]
 pub mod emscripten;
+#[cfg(feature = "std")]
+pub mod executor;
+#[cfg(feature = "std")]
+pub mod fastmath;
+#[cfg(feature = "fetch")]
+pub mod fetch;
+#[cfg(feature = "std")]
+pub mod fiber;
+#[cfg(feature = "std")]
+pub mod fixed_step_loop;
+#[cfg(feature = "std")]
+pub mod flat;
+#[cfg(feature = "std")]
+pub mod frame_arena;
+#[cfg(feature = "std")]
+pub mod frame_barrier;
+#[cfg(feature = "std")]
+pub mod frame_pipeline;
+#[cfg(feature = "std")]
+pub mod frame_scheduler;
+#[cfg(feature = "html5")]
+pub mod fullscreen;
+#[cfg(feature = "std")]
+pub mod gamepads;
+#[cfg(feature = "std")]
+pub mod gc_roots;
+#[cfg(feature = "webgl")]
+pub mod gl_commands;
+#[cfg(feature = "webgl")]
+pub mod gpu_profiler;
+#[cfg(feature = "std")]
+pub mod headless_loop;
+#[cfg(feature = "html5")]
+pub mod html5;
+#[cfg(feature = "idb")]
+pub mod idb;
+#[cfg(feature = "std")]
+pub mod idle;
+#[cfg(feature = "std")]
+pub mod image;
+#[cfg(feature = "std")]
+pub mod io_queue;
+#[cfg(feature = "html5")]
+pub mod input_queue;
+#[cfg(feature = "html5")]
+pub mod keyboard;
+#[cfg(feature = "std")]
+pub mod long_tasks;
+#[cfg(feature = "std")]
+pub mod lz4;
+#[cfg(feature = "std")]
+pub mod main_loop_stats;
+#[cfg(feature = "std")]
+pub mod malloc_buffer;
+#[cfg(feature = "std")]
+pub mod memory;
+#[cfg(feature = "std")]
+pub mod metrics;
+pub mod minimal;
+#[cfg(feature = "std")]
+pub mod modules;
+#[cfg(feature = "html5")]
+pub mod mouse;
+#[cfg(feature = "webgl")]
+pub mod offscreen;
+#[cfg(feature = "std")]
+pub mod page_lifecycle;
+#[cfg(feature = "std")]
+pub mod parallel;
+#[cfg(feature = "std")]
+pub mod perf;
+#[cfg(feature = "std")]
+pub mod pointer;
+#[cfg(feature = "html5")]
+pub mod pointer_lock;
+#[cfg(feature = "html5")]
+pub mod posix_socket;
+#[cfg(feature = "std")]
+pub mod post_task;
+#[cfg(feature = "html5")]
+pub mod power_policy;
+#[cfg(feature = "idb")]
+pub mod prefetcher;
+#[cfg(feature = "std")]
+pub mod preload_hints;
+#[cfg(feature = "std")]
+pub mod profiler;
+#[cfg(feature = "std")]
+pub mod promise;
+#[cfg(feature = "std")]
+pub mod proxying;
+#[cfg(feature = "html5")]
+pub mod resolution_scaler;
+#[cfg(feature = "std")]
+pub mod rng;
+#[cfg(all(feature = "html5", feature = "idb"))]
+pub mod save_cache;
+#[cfg(feature = "std")]
+pub mod scheduler;
+#[cfg(feature = "std")]
+pub mod script;
+#[cfg(feature = "std")]
+pub mod sensors;
+#[cfg(feature = "std")]
+pub mod spsc;
+#[cfg(feature = "std")]
+pub mod stack;
+#[cfg(feature = "std")]
+pub mod startup;
+#[cfg(feature = "std")]
+pub mod storage;
+#[cfg(feature = "console")]
+pub mod structured_log;
+#[cfg(feature = "std")]
+pub mod sync;
+#[cfg(feature = "std")]
+pub mod tabs;
+#[cfg(feature = "std")]
+pub mod threading;
+#[cfg(feature = "std")]
+pub mod timers;
+#[cfg(feature = "std")]
+pub mod trace;
+#[cfg(feature = "std")]
+pub mod trace_recorder;
+#[cfg(feature = "std")]
+pub mod tracking_alloc;
+#[cfg(feature = "fetch")]
+pub mod upload;
+#[cfg(feature = "html5")]
+pub mod visibility_throttle;
+#[cfg(feature = "std")]
+pub mod wasm_worker;
+#[cfg(feature = "std")]
+pub mod wasm_worker_pool;
+#[cfg(feature = "std")]
+pub mod wasmfs;
+#[cfg(feature = "std")]
+pub mod webaudio;
+#[cfg(feature = "webgl")]
+pub mod webgl;
+#[cfg(feature = "webgl")]
+pub mod webgl_extensions;
+#[cfg(feature = "webgl")]
+pub mod webgl_programs;
+#[cfg(feature = "webgl")]
+pub mod webgl_state;
+#[cfg(feature = "std")]
+pub mod webgpu;
+#[cfg(feature = "std")]
+pub mod webgpu_staging;
+#[cfg(feature = "html5")]
+pub mod websocket;
+#[cfg(feature = "std")]
+pub mod wget;
+#[cfg(feature = "std")]
+pub mod window_title;
+#[cfg(feature = "worker")]
+pub mod worker;
+#[cfg(feature = "console")]
+pub mod worker_log;
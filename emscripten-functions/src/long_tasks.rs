@@ -0,0 +1,229 @@
+//! Long tasks and long animation frames reported by the browser, through a `PerformanceObserver`, with the main loop tick they happened in.
+//!
+//! The [`main_loop_stats`](crate::main_loop_stats) tell that a frame was slow, but not why. The browser's
+//! [`long-animation-frame`] entries break a slow frame down, into the time spent in scripts (and in the program's own one, running the wasm code),
+//! in forced style and layout, and in rendering; what's left is the browser's own work, like garbage collection.
+//! The older [`longtask`] entries, supported by more browsers, only have the start and duration of the task.
+//!
+//! Each entry is given to rust as a [`LongTask`] record, with the index of the main loop tick that was running when it started,
+//! as counted by [`frame_index`](crate::main_loop_stats::frame_index).
+//!
+//! [`long-animation-frame`]: https://developer.mozilla.org/en-US/docs/Web/API/PerformanceLongAnimationFrameTiming
+//! [`longtask`]: https://developer.mozilla.org/en-US/docs/Web/API/PerformanceLongTaskTiming
+
+use std::{
+    cell::{Cell, RefCell},
+    collections::VecDeque,
+    marker::PhantomData,
+    os::raw::{c_int, c_void},
+};
+
+use crate::emscripten::get_now;
+
+extern "C" {
+    fn long_tasks_observe(
+        record: *mut f64,
+        callback: unsafe extern "C" fn(arg: *mut c_void),
+        arg: *mut c_void,
+    ) -> c_int;
+    fn long_tasks_disconnect(record: *mut f64);
+}
+
+// The number of tick start times kept to find the tick of an entry, about 4 seconds at 60Hz.
+const FRAME_HISTORY: usize = 256;
+
+thread_local! {
+    // The index and start time of the last ticks, kept while there are observers.
+    static FRAME_STARTS: RefCell<VecDeque<(u64, f64)>> = const { RefCell::new(VecDeque::new()) };
+    static OBSERVERS: Cell<usize> = const { Cell::new(0) };
+}
+
+// Records the start of a main loop tick, if there are observers to correlate the entries with it.
+pub(crate) fn tick_started(index: u64) {
+    if OBSERVERS.with(Cell::get) == 0 {
+        return;
+    }
+    FRAME_STARTS.with(|starts| {
+        let mut starts = starts.borrow_mut();
+        if starts.len() == FRAME_HISTORY {
+            starts.pop_front();
+        }
+        starts.push_back((index, get_now()));
+    });
+}
+
+// Returns the index of the last tick started at or before the given time.
+fn frame_at(time: f64) -> Option<u64> {
+    FRAME_STARTS.with(|starts| {
+        let starts = starts.borrow();
+        let after = starts.partition_point(|&(_, start)| start <= time);
+        // An entry older than the kept history can't be placed.
+        (after > 0).then(|| starts[after - 1].0)
+    })
+}
+
+/// The type of a [`LongTask`] entry.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum LongTaskKind {
+    /// A `longtask` entry: a task that kept the main thread busy for over 50 milliseconds.
+    LongTask,
+    /// A `long-animation-frame` entry: a frame whose rendering got delayed past 50 milliseconds.
+    LongAnimationFrame,
+}
+
+/// A long task or long animation frame entry. The times are in milliseconds, on the [`get_now`](crate::emscripten::get_now) clock.
+///
+/// The breakdown fields are 0 for [`LongTaskKind::LongTask`] entries, which don't have it.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct LongTask {
+    /// The type of the entry.
+    pub kind: LongTaskKind,
+    /// The time the task or frame started at.
+    pub start: f64,
+    /// The duration of the task or frame.
+    pub duration: f64,
+    /// The time the main thread was blocked for, beyond the first 50 milliseconds of each task.
+    pub blocking_duration: f64,
+    /// The time the rendering of the frame started at, or 0 if there was none.
+    pub render_start: f64,
+    /// The time the style and layout of the frame started at, or 0 if there was none.
+    pub style_and_layout_start: f64,
+    /// The time spent in the scripts of the frame, the ones that took over 5 milliseconds.
+    pub script_duration: f64,
+    /// The time the scripts spent in forced style and layout, e.g. reading `offsetWidth` after a DOM change.
+    pub forced_style_and_layout_duration: f64,
+    /// The part of [`LongTask::script_duration`] spent in the program's own JS file, which the wasm code runs under.
+    pub own_script_duration: f64,
+    /// The index of the main loop tick of the calling thread that was running when the entry started,
+    /// or `None` if there's no such tick in the last few seconds.
+    pub frame: Option<u64>,
+}
+
+impl LongTask {
+    /// Returns the time spent rendering the frame, from its render start to its end, style and layout included.
+    pub fn render_duration(&self) -> f64 {
+        if self.render_start > 0.0 {
+            (self.start + self.duration - self.render_start).max(0.0)
+        } else {
+            0.0
+        }
+    }
+
+    /// Returns the time spent in the style and layout of the frame's rendering.
+    pub fn style_and_layout_duration(&self) -> f64 {
+        if self.style_and_layout_start > 0.0 {
+            (self.start + self.duration - self.style_and_layout_start).max(0.0)
+        } else {
+            0.0
+        }
+    }
+
+    /// Returns the time of the frame spent neither in its long scripts nor rendering it:
+    /// garbage collection, short scripts, parsing and the browser's own work.
+    pub fn unattributed_duration(&self) -> f64 {
+        (self.duration - self.script_duration - self.render_duration()).max(0.0)
+    }
+}
+
+// The record the JS code writes the entries into, then the callback reading it.
+#[repr(C)]
+struct ObserverState {
+    record: [f64; 9],
+    callback: Box<dyn FnMut(&LongTask)>,
+}
+
+unsafe extern "C" fn report_trampoline(arg: *mut c_void) {
+    let state = &mut *(arg as *mut ObserverState);
+    let record = state.record;
+    let task = LongTask {
+        kind: if record[0] == 0.0 {
+            LongTaskKind::LongTask
+        } else {
+            LongTaskKind::LongAnimationFrame
+        },
+        start: record[1],
+        duration: record[2],
+        blocking_duration: record[3],
+        render_start: record[4],
+        style_and_layout_start: record[5],
+        script_duration: record[6],
+        forced_style_and_layout_duration: record[7],
+        own_script_duration: record[8],
+        frame: frame_at(record[1]),
+    };
+    (state.callback)(&task);
+}
+
+/// A subscription to the long task entries, created with [`observe_long_tasks`]. Dropping it disconnects the observer.
+#[must_use = "the observer is disconnected when dropped"]
+pub struct LongTaskObserver {
+    state: *mut ObserverState,
+    long_tasks: bool,
+    long_animation_frames: bool,
+    _not_send: PhantomData<*const ()>,
+}
+
+impl LongTaskObserver {
+    /// Returns `true` if the browser reports `longtask` entries.
+    pub fn observes_long_tasks(&self) -> bool {
+        self.long_tasks
+    }
+
+    /// Returns `true` if the browser reports `long-animation-frame` entries.
+    pub fn observes_long_animation_frames(&self) -> bool {
+        self.long_animation_frames
+    }
+}
+
+impl Drop for LongTaskObserver {
+    fn drop(&mut self) {
+        unsafe {
+            long_tasks_disconnect(self.state as *mut f64);
+            drop(Box::from_raw(self.state));
+        }
+        OBSERVERS.with(|observers| observers.set(observers.get() - 1));
+        if OBSERVERS.with(Cell::get) == 0 {
+            FRAME_STARTS.with(|starts| starts.borrow_mut().clear());
+        }
+    }
+}
+
+/// Calls the given function with each `longtask` and `long-animation-frame` entry, the ones the browser supports,
+/// including the ones buffered before the call. It must be called from the main browser thread.
+///
+/// Returns `None` if the browser supports neither.
+///
+/// # Examples
+/// ```rust
+/// let observer = observe_long_tasks(|task| {
+///     if task.kind == LongTaskKind::LongAnimationFrame {
+///         warn!(
+///             "frame {:?} took {:.0} ms: {:.0} in our code, {:.0} rendering, {:.0} unattributed",
+///             task.frame, task.duration, task.own_script_duration, task.render_duration(), task.unattributed_duration()
+///         );
+///     }
+/// });
+/// ```
+pub fn observe_long_tasks<F>(callback: F) -> Option<LongTaskObserver>
+where
+    F: 'static + FnMut(&LongTask),
+{
+    let state = Box::into_raw(Box::new(ObserverState {
+        record: [0.0; 9],
+        callback: Box::new(callback),
+    }));
+    let types =
+        unsafe { long_tasks_observe(state as *mut f64, report_trampoline, state as *mut c_void) };
+    if types == 0 {
+        drop(unsafe { Box::from_raw(state) });
+        return None;
+    }
+
+    OBSERVERS.with(|observers| observers.set(observers.get() + 1));
+    Some(LongTaskObserver {
+        state,
+        long_tasks: types & 1 != 0,
+        long_animation_frames: types & 2 != 0,
+        _not_send: PhantomData,
+    })
+}
@@ -0,0 +1,281 @@
+//! A compressor and decompressor of the [LZ4 block format], running in wasm, for data stored by the program.
+//!
+//! LZ4 compresses text-like data such as JSON levels and meshes to a half or a third of its size, and decompresses it
+//! at several hundred MB/s, so storing compressed data costs less quota and IndexedDB reads than the copy it saves.
+//! Built with `-C target-feature=+simd128`, the match search compares 16 bytes at a time with SIMD instructions.
+//!
+//! The blocks carry neither a header nor their decompressed size, which the caller stores next to them.
+//! [`is_compressible`] guesses from a sample whether compressing some data is worth it: already compressed images and audio aren't.
+//!
+//! [LZ4 block format]: https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+
+use std::fmt::Display;
+
+// The minimum length of a match.
+const MIN_MATCH: usize = 4;
+// The last bytes of a block are always literals.
+const LAST_LITERALS: usize = 5;
+// The last match must start at least this many bytes before the end of the block.
+const MF_LIMIT: usize = 12;
+// The maximum distance back to a match, the range of its 16-bit offset.
+const MAX_OFFSET: usize = 65535;
+
+const HASH_LOG: u32 = 12;
+// The number of failed searches after which the compressor skips through the data faster, 1 << 6 as in the reference implementation.
+const SKIP_TRIGGER: u32 = 6;
+
+// The number of bytes compressed by `is_compressible`, and the ratio below which the data is considered compressible.
+const SAMPLE_BYTES: usize = 16 << 10;
+const COMPRESSIBLE_RATIO: f64 = 0.875;
+
+/// The error of the decompression of invalid or truncated LZ4 data, or of data of another size than the given one.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Lz4Error;
+impl Display for Lz4Error {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        write!(f, "The LZ4 data is invalid")
+    }
+}
+
+/// Returns the maximum size of the compressed block of the given number of bytes.
+pub fn compress_bound(size: usize) -> usize {
+    size + size / 255 + 16
+}
+
+/// Compresses the data into an LZ4 block.
+///
+/// # Examples
+/// ```rust
+/// let level = serde_json::to_vec(&level).unwrap();
+/// let compressed = compress(&level);
+/// // The decompressed size must be kept with the block.
+/// assert_eq!(decompress(&compressed, level.len()).unwrap(), level);
+/// ```
+pub fn compress(data: &[u8]) -> Vec<u8> {
+    let mut out = Vec::new();
+    compress_into(data, &mut out);
+    out
+}
+
+/// Compresses the data into an LZ4 block appended to `out`, reusing its allocation.
+pub fn compress_into(data: &[u8], out: &mut Vec<u8>) {
+    out.reserve(compress_bound(data.len()));
+    let mut anchor = 0;
+
+    if data.len() > MF_LIMIT {
+        let mut table = [0u32; 1 << HASH_LOG];
+        let match_limit = data.len() - LAST_LITERALS;
+        let search_limit = data.len() - MF_LIMIT;
+        let mut pos = 0;
+        let mut attempts = 1 << SKIP_TRIGGER;
+
+        while pos <= search_limit {
+            let sequence = read_u32(data, pos);
+            let slot = hash(sequence);
+            let candidate = table[slot] as usize;
+            table[slot] = pos as u32;
+
+            if candidate >= pos
+                || pos - candidate > MAX_OFFSET
+                || read_u32(data, candidate) != sequence
+            {
+                pos += attempts >> SKIP_TRIGGER;
+                attempts += 1;
+                continue;
+            }
+
+            // Extends the match backwards, over the pending literals.
+            let (mut start, mut reference) = (pos, candidate);
+            while start > anchor && reference > 0 && data[start - 1] == data[reference - 1] {
+                start -= 1;
+                reference -= 1;
+            }
+            let length = MIN_MATCH
+                + common_prefix(
+                    &data[start + MIN_MATCH..match_limit],
+                    &data[reference + MIN_MATCH..],
+                );
+
+            write_sequence(out, &data[anchor..start], start - reference, length);
+            pos = start + length;
+            anchor = pos;
+            attempts = 1 << SKIP_TRIGGER;
+
+            // Indexes a position inside the match, which improves the ratio for little cost.
+            if pos <= search_limit {
+                table[hash(read_u32(data, pos - 2))] = (pos - 2) as u32;
+            }
+        }
+    }
+
+    let literals = &data[anchor..];
+    out.push((literals.len().min(15) as u8) << 4);
+    if literals.len() >= 15 {
+        write_length(out, literals.len() - 15);
+    }
+    out.extend_from_slice(literals);
+}
+
+/// Decompresses an LZ4 block of the given decompressed size.
+pub fn decompress(data: &[u8], size: usize) -> Result<Vec<u8>, Lz4Error> {
+    let mut out = Vec::new();
+    decompress_into(data, size, &mut out)?;
+    Ok(out)
+}
+
+/// Decompresses an LZ4 block of the given decompressed size, appending it to `out`, reusing its allocation.
+/// On error, `out` is left with part of the data appended.
+pub fn decompress_into(data: &[u8], size: usize, out: &mut Vec<u8>) -> Result<(), Lz4Error> {
+    let start = out.len();
+    out.reserve(size);
+    let mut pos = 0;
+
+    loop {
+        let token = *data.get(pos).ok_or(Lz4Error)?;
+        pos += 1;
+
+        let mut literals = (token >> 4) as usize;
+        if literals == 15 {
+            literals += read_length(data, &mut pos)?;
+        }
+        let end = pos.checked_add(literals).ok_or(Lz4Error)?;
+        if out.len() - start + literals > size {
+            return Err(Lz4Error);
+        }
+        out.extend_from_slice(data.get(pos..end).ok_or(Lz4Error)?);
+        pos = end;
+
+        // The last sequence has no match.
+        if pos == data.len() {
+            break;
+        }
+
+        let offset = match data.get(pos..pos + 2) {
+            Some(bytes) => u16::from_le_bytes([bytes[0], bytes[1]]) as usize,
+            None => return Err(Lz4Error),
+        };
+        pos += 2;
+        let mut length = (token & 15) as usize;
+        if length == 15 {
+            length += read_length(data, &mut pos)?;
+        }
+        length += MIN_MATCH;
+        if offset == 0 || offset > out.len() - start || out.len() - start + length > size {
+            return Err(Lz4Error);
+        }
+        copy_match(out, offset, length);
+    }
+
+    if out.len() - start != size {
+        return Err(Lz4Error);
+    }
+    Ok(())
+}
+
+/// Returns `true` if the data compresses well enough to be worth storing compressed, from the compression of its first bytes.
+pub fn is_compressible(data: &[u8]) -> bool {
+    let sample = &data[..data.len().min(SAMPLE_BYTES)];
+    // Blocks this small can't gain much.
+    if sample.len() <= MF_LIMIT {
+        return false;
+    }
+    let mut out = Vec::new();
+    compress_into(sample, &mut out);
+    (out.len() as f64) < sample.len() as f64 * COMPRESSIBLE_RATIO
+}
+
+#[inline(always)]
+fn read_u32(data: &[u8], pos: usize) -> u32 {
+    u32::from_le_bytes([data[pos], data[pos + 1], data[pos + 2], data[pos + 3]])
+}
+
+#[inline(always)]
+fn hash(sequence: u32) -> usize {
+    (sequence.wrapping_mul(2654435761) >> (32 - HASH_LOG)) as usize
+}
+
+fn write_length(out: &mut Vec<u8>, mut length: usize) {
+    while length >= 255 {
+        out.push(255);
+        length -= 255;
+    }
+    out.push(length as u8);
+}
+
+fn write_sequence(out: &mut Vec<u8>, literals: &[u8], offset: usize, length: usize) {
+    let length = length - MIN_MATCH;
+    out.push(((literals.len().min(15) as u8) << 4) | length.min(15) as u8);
+    if literals.len() >= 15 {
+        write_length(out, literals.len() - 15);
+    }
+    out.extend_from_slice(literals);
+    out.extend_from_slice(&(offset as u16).to_le_bytes());
+    if length >= 15 {
+        write_length(out, length - 15);
+    }
+}
+
+fn read_length(data: &[u8], pos: &mut usize) -> Result<usize, Lz4Error> {
+    let mut length = 0;
+    loop {
+        let byte = *data.get(*pos).ok_or(Lz4Error)?;
+        *pos += 1;
+        length += byte as usize;
+        if byte != 255 {
+            return Ok(length);
+        }
+    }
+}
+
+// Appends `length` bytes copied from `offset` bytes back, which may overlap the appended ones.
+fn copy_match(out: &mut Vec<u8>, offset: usize, length: usize) {
+    let from = out.len() - offset;
+    let end = out.len() + length;
+    // An overlapping match repeats the last `offset` bytes: each copy doubles the repeated run.
+    while out.len() < end {
+        let chunk = (out.len() - from).min(end - out.len());
+        out.extend_from_within(from..from + chunk);
+    }
+}
+
+// Returns the length of the common prefix of the two slices.
+#[cfg(target_feature = "simd128")]
+fn common_prefix(a: &[u8], b: &[u8]) -> usize {
+    use core::arch::wasm32::{u8x16_bitmask, u8x16_eq, v128, v128_load};
+
+    let len = a.len().min(b.len());
+    let mut i = 0;
+    while i + 16 <= len {
+        // Both slices have at least 16 bytes from `i`, and the loads have no alignment requirement.
+        let equal = unsafe {
+            let x = v128_load(a.as_ptr().add(i) as *const v128);
+            let y = v128_load(b.as_ptr().add(i) as *const v128);
+            u8x16_bitmask(u8x16_eq(x, y))
+        };
+        if equal != 0xffff {
+            return i + (!equal).trailing_zeros() as usize;
+        }
+        i += 16;
+    }
+    i + common_prefix_bytes(&a[i..len], &b[i..len])
+}
+
+// Returns the length of the common prefix of the two slices.
+#[cfg(not(target_feature = "simd128"))]
+fn common_prefix(a: &[u8], b: &[u8]) -> usize {
+    let len = a.len().min(b.len());
+    let mut i = 0;
+    while i + 8 <= len {
+        let x = u64::from_le_bytes(a[i..i + 8].try_into().unwrap());
+        let y = u64::from_le_bytes(b[i..i + 8].try_into().unwrap());
+        if x != y {
+            return i + ((x ^ y).trailing_zeros() / 8) as usize;
+        }
+        i += 8;
+    }
+    i + common_prefix_bytes(&a[i..len], &b[i..len])
+}
+
+fn common_prefix_bytes(a: &[u8], b: &[u8]) -> usize {
+    a.iter().zip(b).take_while(|(x, y)| x == y).count()
+}
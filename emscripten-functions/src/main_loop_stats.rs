@@ -0,0 +1,229 @@
+//! Opt-in frame-time instrumentation of the main loop set with [`set_main_loop_with_arg`] or [`set_main_loop`].
+//!
+//! Once enabled with [`enable_main_loop_stats`], the start and end of each main loop tick of the calling thread are recorded using [`get_now`],
+//! and the durations of the last ticks are kept in a lock-free ring buffer.
+//! A [`MainLoopStats`] summary (percentiles, dropped frames) can be computed from it at any time, from any thread.
+//!
+//! [`set_main_loop_with_arg`]: crate::emscripten::set_main_loop_with_arg
+//! [`set_main_loop`]: crate::emscripten::set_main_loop
+//! [`get_now`]: crate::emscripten::get_now
+
+use std::{
+    cell::{Cell, RefCell},
+    fmt::Display,
+    sync::{
+        atomic::{AtomicU32, AtomicU64, AtomicUsize, Ordering},
+        Arc,
+    },
+};
+
+use crate::emscripten::get_now;
+
+/// The frame budget, in milliseconds, of a 60Hz display.
+pub const FRAME_BUDGET_60HZ: f64 = 1000.0 / 60.0;
+
+/// Records the tick durations of a main loop. It's created with [`enable_main_loop_stats`].
+///
+/// Only the main loop's thread writes to it, but it can be shared with (and read from) other threads.
+#[derive(Debug)]
+pub struct MainLoopStatsRecorder {
+    // The durations in milliseconds, stored as `f32` bits.
+    durations: Box<[AtomicU32]>,
+    next: AtomicUsize,
+    frames: AtomicU64,
+    dropped_frames: AtomicU64,
+    // The start time of the previous tick, stored as `f64` bits.
+    last_start: AtomicU64,
+    frame_budget: f64,
+}
+
+impl MainLoopStatsRecorder {
+    fn new(capacity: usize, frame_budget: f64) -> Self {
+        assert!(capacity > 0, "the stats capacity must be at least 1");
+
+        Self {
+            durations: (0..capacity).map(|_| AtomicU32::new(0)).collect(),
+            next: AtomicUsize::new(0),
+            frames: AtomicU64::new(0),
+            dropped_frames: AtomicU64::new(0),
+            last_start: AtomicU64::new(f64::NAN.to_bits()),
+            frame_budget,
+        }
+    }
+
+    /// Records a tick that started and ended at the given [`get_now`] times.
+    ///
+    /// It is called automatically by the main loop wrapper; call it yourself only if you drive your own loop.
+    ///
+    /// [`get_now`]: crate::emscripten::get_now
+    pub fn record(&self, start: f64, end: f64) {
+        let index = self.next.load(Ordering::Relaxed);
+        self.durations[index].store(((end - start) as f32).to_bits(), Ordering::Relaxed);
+        self.next
+            .store((index + 1) % self.durations.len(), Ordering::Relaxed);
+        self.frames.fetch_add(1, Ordering::Release);
+
+        // The frames missed between 2 ticks are estimated from the time between their starts.
+        let last_start = f64::from_bits(self.last_start.swap(start.to_bits(), Ordering::Relaxed));
+        if !last_start.is_nan() {
+            let missed = ((start - last_start) / self.frame_budget).round() - 1.0;
+            if missed >= 1.0 {
+                self.dropped_frames
+                    .fetch_add(missed as u64, Ordering::Relaxed);
+            }
+        }
+    }
+
+    /// Computes the statistics of the recorded ticks.
+    pub fn stats(&self) -> MainLoopStats {
+        let frames = self.frames.load(Ordering::Acquire);
+        let window = (frames as usize).min(self.durations.len());
+
+        let mut durations: Vec<f32> = self.durations[..window]
+            .iter()
+            .map(|duration| f32::from_bits(duration.load(Ordering::Relaxed)))
+            .collect();
+        durations.sort_unstable_by(|a, b| a.total_cmp(b));
+
+        let percentile = |p: f64| -> f64 {
+            if durations.is_empty() {
+                return 0.0;
+            }
+            let index = ((durations.len() - 1) as f64 * p).round() as usize;
+            durations[index] as f64
+        };
+
+        MainLoopStats {
+            frames,
+            dropped_frames: self.dropped_frames.load(Ordering::Relaxed),
+            window,
+            mean: if durations.is_empty() {
+                0.0
+            } else {
+                durations.iter().map(|d| *d as f64).sum::<f64>() / durations.len() as f64
+            },
+            p50: percentile(0.50),
+            p95: percentile(0.95),
+            p99: percentile(0.99),
+            max: durations.last().copied().unwrap_or(0.0) as f64,
+        }
+    }
+}
+
+/// A summary of the main loop's tick durations, as returned by [`main_loop_stats`].
+///
+/// The durations are in milliseconds, and computed from the last [`window`](MainLoopStats::window) ticks.
+///
+/// Implements [`Display`] as a one-line summary.
+#[derive(Debug, Clone, PartialEq)]
+pub struct MainLoopStats {
+    /// The number of ticks recorded since the stats were enabled.
+    pub frames: u64,
+    /// The estimated number of display frames missed since the stats were enabled,
+    /// based on the time between the starts of consecutive ticks.
+    pub dropped_frames: u64,
+    /// The number of ticks the durations below are computed from.
+    pub window: usize,
+    pub mean: f64,
+    pub p50: f64,
+    pub p95: f64,
+    pub p99: f64,
+    pub max: f64,
+}
+impl Display for MainLoopStats {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        write!(
+            f,
+            "{} frames ({} dropped), last {}: mean {:.2}ms, p50 {:.2}ms, p95 {:.2}ms, p99 {:.2}ms, max {:.2}ms",
+            self.frames,
+            self.dropped_frames,
+            self.window,
+            self.mean,
+            self.p50,
+            self.p95,
+            self.p99,
+            self.max
+        )
+    }
+}
+
+thread_local! {
+    static MAIN_LOOP_STATS: RefCell<Option<Arc<MainLoopStatsRecorder>>> = RefCell::new(None);
+    // The number of main loop ticks started on the thread.
+    static FRAME_INDEX: Cell<u64> = const { Cell::new(0) };
+}
+
+/// Enables the instrumentation of the calling thread's main loop, replacing the previous recorder, if any.
+///
+/// It returns the recorder, which can be sent to other threads to read the stats from there.
+///
+/// # Arguments
+/// * `capacity` - The number of last tick durations to keep.
+/// * `frame_budget` - The expected time between ticks, in milliseconds, used to count the dropped frames.
+///   Use [`FRAME_BUDGET_60HZ`] for a `requestAnimationFrame` main loop on a 60Hz display.
+///
+/// # Examples
+/// ```rust
+/// enable_main_loop_stats(240, FRAME_BUDGET_60HZ);
+///
+/// set_main_loop(|| {
+///     // ...
+///     if let Some(stats) = main_loop_stats() {
+///         if stats.p99 > FRAME_BUDGET_60HZ {
+///             println!("Janky: {}", stats);
+///         }
+///     }
+/// }, 0, true);
+/// ```
+pub fn enable_main_loop_stats(capacity: usize, frame_budget: f64) -> Arc<MainLoopStatsRecorder> {
+    let recorder = Arc::new(MainLoopStatsRecorder::new(capacity, frame_budget));
+    MAIN_LOOP_STATS.with(|stats| *stats.borrow_mut() = Some(recorder.clone()));
+    recorder
+}
+
+/// Disables the instrumentation of the calling thread's main loop.
+pub fn disable_main_loop_stats() {
+    MAIN_LOOP_STATS.with(|stats| *stats.borrow_mut() = None);
+}
+
+/// Returns the index of the running main loop tick of the calling thread, counted from 0 whether the instrumentation is enabled or not,
+/// or the number of ticks so far outside of a tick.
+pub fn frame_index() -> u64 {
+    FRAME_INDEX.with(Cell::get)
+}
+
+/// Returns the stats of the calling thread's main loop, or `None` if the instrumentation isn't enabled.
+pub fn main_loop_stats() -> Option<MainLoopStats> {
+    MAIN_LOOP_STATS.with(|stats| stats.borrow().as_ref().map(|recorder| recorder.stats()))
+}
+
+// Used by the main loop wrapper: runs `tick`, measuring its duration if the instrumentation or the adaptive timing controller is enabled.
+pub(crate) fn run_instrumented<F>(tick: F)
+where
+    F: FnOnce(),
+{
+    // The index is the one of this tick while it runs.
+    let index = FRAME_INDEX.with(Cell::get);
+    crate::long_tasks::tick_started(index);
+    crate::startup::tick_started();
+    let recorder = MAIN_LOOP_STATS.with(|stats| stats.borrow().clone());
+    let adaptive_timing = crate::adaptive_timing::is_enabled();
+
+    if recorder.is_none() && !adaptive_timing {
+        tick();
+        FRAME_INDEX.with(|frame| frame.set(index + 1));
+        return;
+    }
+
+    let start = get_now();
+    tick();
+    let end = get_now();
+    FRAME_INDEX.with(|frame| frame.set(index + 1));
+
+    if let Some(recorder) = recorder {
+        recorder.record(start, end);
+    }
+    if adaptive_timing {
+        crate::adaptive_timing::observe_tick(end - start);
+    }
+}
@@ -0,0 +1,101 @@
+//! An owned byte buffer allocated by emscripten's `malloc`, as returned by some asynchronous emscripten functions.
+
+use std::{
+    fmt::Debug,
+    ops::{Deref, DerefMut},
+    os::raw::c_void,
+    ptr::NonNull,
+    slice,
+};
+
+extern "C" {
+    fn free(ptr: *mut c_void);
+}
+
+/// A byte buffer allocated with the C `malloc`, that is `free`d when dropped.
+///
+/// Emscripten hands over the data of e.g. finished downloads as `malloc`-allocated buffers.
+/// This type takes their ownership without copying them; it dereferences to a byte slice.
+/// As the rust global allocator isn't necessarily `malloc`, it can't be turned into a `Vec<u8>` without a copy,
+/// which is what [`MallocBuffer::into_vec`] does.
+pub struct MallocBuffer {
+    // `None` for an empty buffer that doesn't own any allocation.
+    ptr: Option<NonNull<u8>>,
+    len: usize,
+}
+
+impl MallocBuffer {
+    /// Takes the ownership of the given `malloc`-allocated buffer.
+    ///
+    /// # Safety
+    /// `ptr` must either be null (for an empty buffer) or point to a `malloc`-allocated buffer of at least `len` bytes,
+    /// which isn't used or freed by anyone else.
+    pub unsafe fn from_raw(ptr: *mut u8, len: usize) -> Self {
+        let ptr = NonNull::new(ptr);
+        let len = if ptr.is_some() { len } else { 0 };
+        Self { ptr, len }
+    }
+
+    /// Copies the data into a `Vec<u8>`, freeing the buffer.
+    pub fn into_vec(self) -> Vec<u8> {
+        self.to_vec()
+    }
+
+    /// Gives up the ownership of the buffer, returning its pointer (null for an empty buffer that owns no allocation) and length.
+    /// The buffer must then be freed with `free`.
+    pub fn into_raw(self) -> (*mut u8, usize) {
+        let raw = (self.data_ptr(), self.len);
+        std::mem::forget(self);
+        raw
+    }
+
+    fn data_ptr(&self) -> *mut u8 {
+        self.ptr.map_or(std::ptr::null_mut(), NonNull::as_ptr)
+    }
+}
+
+impl Deref for MallocBuffer {
+    type Target = [u8];
+
+    fn deref(&self) -> &[u8] {
+        match self.ptr {
+            Some(ptr) => unsafe { slice::from_raw_parts(ptr.as_ptr(), self.len) },
+            None => &[],
+        }
+    }
+}
+
+impl DerefMut for MallocBuffer {
+    fn deref_mut(&mut self) -> &mut [u8] {
+        match self.ptr {
+            Some(ptr) => unsafe { slice::from_raw_parts_mut(ptr.as_ptr(), self.len) },
+            None => &mut [],
+        }
+    }
+}
+
+impl AsRef<[u8]> for MallocBuffer {
+    fn as_ref(&self) -> &[u8] {
+        self
+    }
+}
+
+impl Debug for MallocBuffer {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("MallocBuffer")
+            .field("len", &self.len)
+            .finish()
+    }
+}
+
+impl Drop for MallocBuffer {
+    fn drop(&mut self) {
+        if let Some(ptr) = self.ptr {
+            unsafe { free(ptr.as_ptr() as *mut c_void) }
+        }
+    }
+}
+
+// The buffer is uniquely owned, like a `Box<[u8]>`.
+unsafe impl Send for MallocBuffer {}
+unsafe impl Sync for MallocBuffer {}
@@ -0,0 +1,441 @@
+//! Linear memory usage and growth instrumentation, over the emscripten `heap.h` header file.
+//!
+//! Each growth of the wasm memory invalidates the JS typed-array views over it, and can copy it on some engines,
+//! stalling the frame it happens in. [`on_growth`] reports when and from where the heap grows,
+//! so that the size reached during a session can be reserved upfront.
+//!
+//! A [`MemorySampler`] reports the whole memory of the program periodically: the heap, the allocator usage, and the JS heap
+//! and DOM memory measured by the browser, which the wasm heap doesn't account for.
+//!
+//! A growth also detaches the typed arrays viewing the old buffer, that JS code keeps. [`install_heap_views`] provides views
+//! that are only created again after a growth, which the [`Script`](crate::script::Script)s and the
+//! [`DomBatch`](crate::dom_batch::DomBatch)es use.
+
+use std::{
+    cell::{Cell, RefCell},
+    fmt::Display,
+    os::raw::{c_char, c_int, c_void},
+    rc::Rc,
+};
+
+use emscripten_functions_sys::heap;
+
+use crate::{
+    emmalloc::AllocatorStats,
+    emscripten::get_now,
+    timers::{set_interval, TimerHandle},
+};
+
+type MeasureCallback = unsafe extern "C" fn(
+    arg: *mut c_void,
+    ok: c_int,
+    total: f64,
+    javascript: f64,
+    dom: f64,
+    shared: f64,
+    other: f64,
+);
+
+extern "C" {
+    fn memory_watch_growth(callback: unsafe extern "C" fn(usize, usize));
+    fn memory_growth_stack(buffer: *mut c_char, size: usize) -> usize;
+    fn memory_measure(callback: MeasureCallback, arg: *mut c_void) -> c_int;
+    fn memory_views_install();
+}
+
+/// The size of a wasm memory page, by which the heap grows, in bytes.
+pub const PAGE_SIZE: usize = heap::WASM_PAGE_SIZE as usize;
+
+/// The memory usage of the program, returned by [`stats`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct MemoryStats {
+    /// The current size of the wasm memory, in bytes.
+    pub heap_size: usize,
+    /// The size the wasm memory can grow to, in bytes: the `MAXIMUM_MEMORY` setting, or the heap size without `ALLOW_MEMORY_GROWTH`.
+    pub heap_max: usize,
+    /// The end of the memory claimed by the allocator with `sbrk`. What's past it is free for the allocator to grow into.
+    pub sbrk_top: usize,
+}
+
+impl MemoryStats {
+    /// Returns the number of bytes of the heap the allocator didn't claim yet.
+    pub fn unclaimed(&self) -> usize {
+        self.heap_size.saturating_sub(self.sbrk_top)
+    }
+}
+
+/// Returns the current memory usage, using the emscripten-defined `emscripten_get_heap_size`, `emscripten_get_heap_max` and `emscripten_get_sbrk_ptr`.
+pub fn stats() -> MemoryStats {
+    unsafe {
+        MemoryStats {
+            heap_size: heap::emscripten_get_heap_size(),
+            heap_max: heap::emscripten_get_heap_max(),
+            sbrk_top: *heap::emscripten_get_sbrk_ptr(),
+        }
+    }
+}
+
+/// The error returned by [`reserve`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum ReserveError {
+    /// The requested size is bigger than the maximum size of the heap.
+    OverMaximum {
+        /// The maximum size of the heap, in bytes.
+        heap_max: usize,
+    },
+    /// The memory couldn't be grown, e.g. because the program was built without `-sALLOW_MEMORY_GROWTH`, or the browser is out of memory.
+    GrowthFailed,
+}
+
+impl Display for ReserveError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        match self {
+            ReserveError::OverMaximum { heap_max } => {
+                write!(f, "The heap can't grow over {} bytes", heap_max)
+            }
+            ReserveError::GrowthFailed => write!(f, "Failed to grow the heap"),
+        }
+    }
+}
+
+/// Grows the wasm memory to at least `bytes` bytes at once, using the emscripten-defined `emscripten_resize_heap`,
+/// and returns its new size. Nothing is done if the heap is already that big.
+///
+/// Reserving the size a session reaches, e.g. learned from [`on_growth`] telemetry, at startup,
+/// avoids the stalls of growing the memory mid-game, and the invalidation of the JS views over it each time.
+/// The memory isn't claimed by the allocator: it only grows into it, without growing the memory anymore.
+///
+/// # Examples
+/// ```rust
+/// // The peak usage of the previous sessions.
+/// let peak = load_setting("heap_peak").unwrap_or(256 * 1024 * 1024);
+/// if let Err(err) = reserve(peak) {
+///     console::warn(&format!("Couldn't reserve the heap: {}", err));
+/// }
+/// ```
+pub fn reserve(bytes: usize) -> Result<usize, ReserveError> {
+    let current = stats();
+    if current.heap_size >= bytes {
+        return Ok(current.heap_size);
+    }
+    if bytes > current.heap_max {
+        return Err(ReserveError::OverMaximum {
+            heap_max: current.heap_max,
+        });
+    }
+
+    if unsafe { heap::emscripten_resize_heap(bytes) } == 0 {
+        return Err(ReserveError::GrowthFailed);
+    }
+    Ok(unsafe { heap::emscripten_get_heap_size() })
+}
+
+/// A growth of the wasm memory, reported by [`on_growth`].
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct Growth {
+    /// The size of the memory before the growth, in bytes.
+    pub old_size: usize,
+    /// The size of the memory after the growth, in bytes.
+    pub new_size: usize,
+    /// The JS stack trace of the growth, which includes the wasm functions that allocated, when the program keeps its function names.
+    pub stack: String,
+}
+
+type OnGrowth = Box<dyn FnMut(&Growth)>;
+
+thread_local! {
+    static ONGROWTH: RefCell<Option<OnGrowth>> = const { RefCell::new(None) };
+}
+
+unsafe extern "C" fn growth_trampoline(old_size: usize, new_size: usize) {
+    let length = memory_growth_stack(std::ptr::null_mut(), 0);
+    let mut stack = vec![0u8; length + 1];
+    memory_growth_stack(stack.as_mut_ptr() as *mut c_char, stack.len());
+    stack.truncate(length);
+
+    let growth = Growth {
+        old_size,
+        new_size,
+        stack: String::from_utf8_lossy(&stack).into_owned(),
+    };
+
+    // Taken out during the call, so that it can set another function.
+    let func = ONGROWTH.with(|ongrowth| ongrowth.borrow_mut().take());
+    if let Some(mut func) = func {
+        func(&growth);
+        ONGROWTH.with(|ongrowth| {
+            ongrowth.borrow_mut().get_or_insert(func);
+        });
+    }
+}
+
+/// Sets the function called after each growth of the wasm memory triggered by the calling thread, replacing the previous one.
+///
+/// The growths happen inside the allocator, so they're reported from a timeout right after, on the event loop.
+///
+/// # Examples
+/// ```rust
+/// on_growth(|growth| {
+///     console::warn(&format!(
+///         "The heap grew from {} to {} bytes:\n{}",
+///         growth.old_size, growth.new_size, growth.stack
+///     ));
+/// });
+/// ```
+pub fn on_growth<F>(ongrowth: F)
+where
+    F: 'static + FnMut(&Growth),
+{
+    ONGROWTH.with(|cell| *cell.borrow_mut() = Some(Box::new(ongrowth)));
+    unsafe { memory_watch_growth(growth_trampoline) };
+}
+
+thread_local! {
+    static VIEWS_INSTALLED: Cell<bool> = const { Cell::new(false) };
+}
+
+/// Installs the calling thread's cache of typed-array views of the wasm memory, `Module.emscriptenFunctionsHeap`, for the JS code
+/// that reads and writes the memory, e.g. in `EM_ASM` blocks or [`Script`](crate::script::Script)s, which get it as `$heap`.
+///
+/// Its `HEAP8`, `HEAPU8`, `HEAP16`, `HEAPU16`, `HEAP32`, `HEAPU32`, `HEAPF32` and `HEAPF64` properties are views of the current
+/// buffer of the memory, created again on the first access after the memory grew, including when another thread grew it:
+/// unlike emscripten's own `HEAP*` variables in a multithreaded program, they're never stale, and unlike views created for each
+/// call, they're not garbage. The functions given to its `onChange` method are called with it when the views are created again,
+/// to replace the views of the old buffer they keep.
+///
+/// It does nothing if the views are already installed.
+///
+/// # Examples
+/// ```rust
+/// install_heap_views();
+/// let positions: Vec<f32> = vec![0.0; 3 * 1024];
+/// let upload = Script::compile(r#"
+///     var gl = $h($2);
+///     gl.bufferSubData(gl.ARRAY_BUFFER, 0, $heap.HEAPF32, $0 >>> 2, $1);
+/// "#).unwrap();
+/// upload.call(&[positions.as_ptr() as usize as f64, positions.len() as f64, gl.as_arg()]);
+/// ```
+pub fn install_heap_views() {
+    VIEWS_INSTALLED.with(|installed| {
+        if !installed.replace(true) {
+            unsafe { memory_views_install() };
+        }
+    });
+}
+
+/// The memory of the page measured by the browser, returned by [`measure_user_agent_memory`], in bytes.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct UserAgentMemory {
+    /// The memory of the whole page and its workers.
+    pub total: u64,
+    /// The memory of the JS heaps, which includes the wasm memory.
+    pub javascript: u64,
+    /// The memory of the DOM, e.g. the elements, images and canvases.
+    pub dom: u64,
+    /// The memory shared between the page and its workers, e.g. a shared wasm memory.
+    pub shared: u64,
+    /// The memory of the other types the browser reports.
+    pub other: u64,
+}
+
+type OnMeasure = Box<dyn FnOnce(Option<UserAgentMemory>)>;
+
+unsafe extern "C" fn measure_trampoline(
+    arg: *mut c_void,
+    ok: c_int,
+    total: f64,
+    javascript: f64,
+    dom: f64,
+    shared: f64,
+    other: f64,
+) {
+    let func = Box::from_raw(arg as *mut OnMeasure);
+    func((ok != 0).then_some(UserAgentMemory {
+        total: total as u64,
+        javascript: javascript as u64,
+        dom: dom as u64,
+        shared: shared as u64,
+        other: other as u64,
+    }));
+}
+
+/// Measures the memory of the page with `performance.measureUserAgentSpecificMemory`, and calls `callback` with it,
+/// or with `None` if the measurement failed.
+///
+/// The browser answers after its next garbage collection, which can take seconds. The measurement is only available to
+/// cross-origin isolated pages, served with the `Cross-Origin-Opener-Policy` and `Cross-Origin-Embedder-Policy` headers,
+/// and only in Chromium browsers: elsewhere `callback` is called with `None` right away.
+///
+/// # Examples
+/// ```rust
+/// measure_user_agent_memory(|memory| match memory {
+///     Some(memory) => console::log(&format!("The page uses {} bytes", memory.total)),
+///     None => console::log("The page memory can't be measured"),
+/// });
+/// ```
+pub fn measure_user_agent_memory<F>(callback: F)
+where
+    F: 'static + FnOnce(Option<UserAgentMemory>),
+{
+    let arg = Box::into_raw(Box::new(Box::new(callback) as OnMeasure));
+    if unsafe { memory_measure(measure_trampoline, arg as *mut c_void) } == 0 {
+        let func = unsafe { Box::from_raw(arg) };
+        func(None);
+    }
+}
+
+/// A sample of the memory of the program, taken by a [`MemorySampler`].
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct MemoryReport {
+    /// The time the sample was taken at, in milliseconds, as returned by [`get_now`].
+    pub time: f64,
+    /// The usage of the wasm heap.
+    pub heap: MemoryStats,
+    /// The usage of the allocator, if the sampler was given its statistics.
+    pub allocator: Option<AllocatorStats>,
+    /// The memory of the page measured by the browser, if the measurement is available.
+    pub user_agent: Option<UserAgentMemory>,
+    /// The GPU memory, in bytes, as estimated by the program, if the sampler was given an estimate.
+    pub gpu: Option<usize>,
+}
+
+impl MemoryReport {
+    /// Returns the JS heap memory outside of the wasm memory, in bytes, if the browser measured it.
+    pub fn js_outside_heap(&self) -> Option<u64> {
+        let user_agent = self.user_agent?;
+        Some((user_agent.javascript + user_agent.shared).saturating_sub(self.heap.heap_size as u64))
+    }
+}
+
+struct SamplerState {
+    allocator: Option<fn() -> AllocatorStats>,
+    gpu: Option<Box<dyn FnMut() -> usize>>,
+    user_agent: bool,
+    // Whether a browser measurement is pending, during which the samples are skipped.
+    measuring: bool,
+    stopped: bool,
+    onreport: Box<dyn FnMut(&MemoryReport)>,
+}
+
+fn sample(state: &Rc<RefCell<SamplerState>>) {
+    let mut data = state.borrow_mut();
+    if data.measuring {
+        return;
+    }
+    let mut report = MemoryReport {
+        time: get_now(),
+        heap: stats(),
+        allocator: data.allocator.map(|allocator| allocator()),
+        user_agent: None,
+        gpu: data.gpu.as_mut().map(|gpu| gpu()),
+    };
+    if !data.user_agent {
+        (data.onreport)(&report);
+        return;
+    }
+
+    data.measuring = true;
+    drop(data);
+    let state = state.clone();
+    measure_user_agent_memory(move |user_agent| {
+        let mut data = state.borrow_mut();
+        data.measuring = false;
+        if data.stopped {
+            return;
+        }
+        // The measurement stays unavailable, so the next samples don't wait for it.
+        if user_agent.is_none() {
+            data.user_agent = false;
+        }
+        report.user_agent = user_agent;
+        (data.onreport)(&report);
+    });
+}
+
+/// Samples the memory of the program periodically, and reports it to a callback.
+///
+/// Each [`MemoryReport`] has the heap usage, the allocator usage given by [`with_allocator_stats`](Self::with_allocator_stats),
+/// the GPU memory estimated by [`with_gpu_estimate`](Self::with_gpu_estimate), and the page memory measured by the browser
+/// where it's available, see [`measure_user_agent_memory`]: the sample is then reported once the browser answers,
+/// and the samples due meanwhile are skipped. The browsers don't expose the GPU memory, so it has to be counted by the program,
+/// e.g. from the sizes of the textures and buffers it created.
+///
+/// Dropping the sampler stops the sampling.
+///
+/// # Examples
+/// ```rust
+/// // Built with `-sMALLOC=emmalloc`.
+/// let sampler = MemorySampler::new()
+///     .with_allocator_stats(emmalloc::stats)
+///     .with_gpu_estimate(|| renderer.texture_bytes() + renderer.buffer_bytes())
+///     .start(10_000.0, |report| {
+///         metrics::record("heap_size", report.heap.heap_size as f64);
+///         if let Some(user_agent) = report.user_agent {
+///             metrics::record("dom_memory", user_agent.dom as f64);
+///         }
+///     });
+/// ```
+pub struct MemorySampler {
+    allocator: Option<fn() -> AllocatorStats>,
+    gpu: Option<Box<dyn FnMut() -> usize>>,
+}
+
+impl MemorySampler {
+    /// Creates a sampler of the heap usage and the browser measurement.
+    #[allow(clippy::new_without_default)]
+    pub fn new() -> Self {
+        Self {
+            allocator: None,
+            gpu: None,
+        }
+    }
+
+    /// Adds the allocator usage to the reports, e.g. with [`emmalloc::stats`](crate::emmalloc::stats)
+    /// for a program built with `-sMALLOC=emmalloc`.
+    pub fn with_allocator_stats(mut self, allocator: fn() -> AllocatorStats) -> Self {
+        self.allocator = Some(allocator);
+        self
+    }
+
+    /// Adds the GPU memory estimated by the given function to the reports, in bytes.
+    pub fn with_gpu_estimate<F>(mut self, gpu: F) -> Self
+    where
+        F: 'static + FnMut() -> usize,
+    {
+        self.gpu = Some(Box::new(gpu));
+        self
+    }
+
+    /// Starts sampling now, and then every `interval` milliseconds, on the calling thread's [`timers`](crate::timers).
+    pub fn start<F>(self, interval: f64, onreport: F) -> RunningMemorySampler
+    where
+        F: 'static + FnMut(&MemoryReport),
+    {
+        let state = Rc::new(RefCell::new(SamplerState {
+            allocator: self.allocator,
+            gpu: self.gpu,
+            user_agent: true,
+            measuring: false,
+            stopped: false,
+            onreport: Box::new(onreport),
+        }));
+        sample(&state);
+        let interval_state = state.clone();
+        let timer = set_interval(move || sample(&interval_state), interval);
+        RunningMemorySampler { timer, state }
+    }
+}
+
+/// A started [`MemorySampler`], which stops sampling when dropped.
+pub struct RunningMemorySampler {
+    timer: TimerHandle,
+    state: Rc<RefCell<SamplerState>>,
+}
+
+impl Drop for RunningMemorySampler {
+    fn drop(&mut self) {
+        self.timer.cancel();
+        // A pending browser measurement isn't reported.
+        self.state.borrow_mut().stopped = true;
+    }
+}
@@ -0,0 +1,416 @@
+//! Counters, gauges and histograms updated lock-free from any thread, and exported in batches with `navigator.sendBeacon`.
+//!
+//! The metrics are `static`s, [`register`]ed once. An [`Exporter`], started on the main browser thread,
+//! serializes all the registered metrics into one JSON payload every interval, with [`set_interval`], and once more when the page unloads,
+//! from a `beforeunload` callback set with the emscripten-defined [`emscripten_set_beforeunload_callback_on_thread`].
+//! There is only one request per interval, however many events were recorded.
+//!
+//! Each payload holds the changes since the previous one: the counters and histograms are reset by the export, while the gauges keep their value.
+//! A payload the browser didn't queue is kept, and sent again before the next one, so that the changes it holds aren't lost.
+//! It looks like this:
+//! ```json
+//! {"time":1700000000000,"metrics":{"frames":3600,"entities":812,"frame_ms":{"bounds":[8,16,33],"counts":[3000,550,40,10],"sum":41000.5}}}
+//! ```
+//! where the last count of a histogram is the one of the values above its last bound.
+//!
+//! [`set_interval`]: crate::timers::set_interval
+//! [`emscripten_set_beforeunload_callback_on_thread`]: https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_set_beforeunload_callback_on_thread
+
+use std::{
+    cell::RefCell,
+    collections::VecDeque,
+    ffi::CString,
+    fmt::Write,
+    os::raw::{c_char, c_int, c_void},
+    rc::Rc,
+    sync::atomic::{AtomicU64, Ordering},
+};
+
+use emscripten_functions_sys::html5;
+
+use crate::{
+    clock::date_now,
+    sync::Mutex,
+    timers::{set_interval, TimerHandle},
+};
+
+extern "C" {
+    fn metrics_send_beacon(url: *const c_char, data: *const c_char, len: usize) -> c_int;
+}
+
+// `EM_CALLBACK_THREAD_CONTEXT_CALLING_THREAD`, a pointer-valued macro bindgen doesn't generate.
+const CALLING_THREAD: html5::pthread_t = 0x2 as html5::pthread_t;
+
+/// A metric that can be [`register`]ed for export.
+pub trait Metric: Sync {
+    /// Returns the name of the metric, its key in the payload.
+    fn name(&self) -> &'static str;
+    /// Writes the JSON value of the metric, and resets the parts of it that are reported as changes.
+    fn export(&self, out: &mut String);
+}
+
+/// A metric that takes measured values: a [`Gauge`] keeps the last one, and a [`Histogram`] counts them.
+/// Other modules record their measurements into one, like the [GPU profiler](crate::gpu_profiler)'s pass times.
+pub trait ValueMetric: Metric {
+    /// Records a measured value.
+    fn record_value(&self, value: f64);
+}
+
+// Writes the float as a JSON number, or `null` for the values JSON can't represent.
+fn write_number(out: &mut String, value: f64) {
+    if value.is_finite() {
+        let _ = write!(out, "{}", value);
+    } else {
+        out.push_str("null");
+    }
+}
+
+fn write_string(out: &mut String, string: &str) {
+    out.push('"');
+    for c in string.chars() {
+        match c {
+            '"' => out.push_str("\\\""),
+            '\\' => out.push_str("\\\\"),
+            c if (c as u32) < 0x20 => {
+                let _ = write!(out, "\\u{:04x}", c as u32);
+            }
+            c => out.push(c),
+        }
+    }
+    out.push('"');
+}
+
+// Adds to a float stored as its bits.
+fn add_f64(atomic: &AtomicU64, value: f64) {
+    let _ = atomic.fetch_update(Ordering::Relaxed, Ordering::Relaxed, |bits| {
+        Some((f64::from_bits(bits) + value).to_bits())
+    });
+}
+
+/// A count of events, reported as the number of events since the previous export.
+///
+/// # Examples
+/// ```rust
+/// static ASSET_FETCHES: Counter = Counter::new("asset_fetches");
+///
+/// metrics::register(&ASSET_FETCHES);
+/// ASSET_FETCHES.increment();
+/// ```
+#[derive(Debug)]
+pub struct Counter {
+    name: &'static str,
+    value: AtomicU64,
+}
+
+impl Counter {
+    /// Creates a counter at 0, to be stored in a `static`.
+    pub const fn new(name: &'static str) -> Self {
+        Self {
+            name,
+            value: AtomicU64::new(0),
+        }
+    }
+
+    /// Adds 1 to the counter.
+    pub fn increment(&self) {
+        self.add(1);
+    }
+
+    /// Adds the given number to the counter.
+    pub fn add(&self, count: u64) {
+        self.value.fetch_add(count, Ordering::Relaxed);
+    }
+
+    /// Returns the count since the previous export.
+    pub fn get(&self) -> u64 {
+        self.value.load(Ordering::Relaxed)
+    }
+}
+
+impl Metric for Counter {
+    fn name(&self) -> &'static str {
+        self.name
+    }
+
+    fn export(&self, out: &mut String) {
+        let _ = write!(out, "{}", self.value.swap(0, Ordering::Relaxed));
+    }
+}
+
+/// A value that goes up and down, e.g. a number of entities or of bytes in use, reported as its last value.
+#[derive(Debug)]
+pub struct Gauge {
+    name: &'static str,
+    // The bits of the value.
+    value: AtomicU64,
+}
+
+impl Gauge {
+    /// Creates a gauge at 0, to be stored in a `static`.
+    pub const fn new(name: &'static str) -> Self {
+        Self {
+            name,
+            value: AtomicU64::new(0),
+        }
+    }
+
+    /// Sets the value of the gauge.
+    pub fn set(&self, value: f64) {
+        self.value.store(value.to_bits(), Ordering::Relaxed);
+    }
+
+    /// Adds the given amount to the gauge, which can be negative.
+    pub fn add(&self, amount: f64) {
+        add_f64(&self.value, amount);
+    }
+
+    /// Returns the value of the gauge.
+    pub fn get(&self) -> f64 {
+        f64::from_bits(self.value.load(Ordering::Relaxed))
+    }
+}
+
+impl Metric for Gauge {
+    fn name(&self) -> &'static str {
+        self.name
+    }
+
+    fn export(&self, out: &mut String) {
+        write_number(out, self.get());
+    }
+}
+
+/// A distribution of values over fixed buckets, e.g. of frame times, reported as the bucket counts and the sum of the values since the previous export.
+///
+/// The `N` bounds are the inclusive upper bounds of the first `N` buckets, in increasing order; the values above the last one are counted in an extra bucket.
+///
+/// # Examples
+/// ```rust
+/// static FRAME_MS: Histogram<4> = Histogram::new("frame_ms", [8.0, 16.7, 33.3, 50.0]);
+///
+/// metrics::register(&FRAME_MS);
+/// set_main_loop(|| {
+///     let start = Instant::now();
+///     update();
+///     FRAME_MS.record(start.elapsed().as_secs_f64() * 1000.0);
+/// }, 0, true);
+/// ```
+#[derive(Debug)]
+pub struct Histogram<const N: usize> {
+    name: &'static str,
+    bounds: [f64; N],
+    counts: [AtomicU64; N],
+    above: AtomicU64,
+    // The bits of the sum of the values.
+    sum: AtomicU64,
+}
+
+impl<const N: usize> Histogram<N> {
+    /// Creates an empty histogram with the given bucket bounds, to be stored in a `static`.
+    pub const fn new(name: &'static str, bounds: [f64; N]) -> Self {
+        Self {
+            name,
+            bounds,
+            counts: [const { AtomicU64::new(0) }; N],
+            above: AtomicU64::new(0),
+            sum: AtomicU64::new(0),
+        }
+    }
+
+    /// Counts the value in its bucket.
+    pub fn record(&self, value: f64) {
+        let bucket = self.bounds.partition_point(|&bound| bound < value);
+        self.counts
+            .get(bucket)
+            .unwrap_or(&self.above)
+            .fetch_add(1, Ordering::Relaxed);
+        add_f64(&self.sum, value);
+    }
+
+    /// Returns the bucket bounds.
+    pub fn bounds(&self) -> &[f64; N] {
+        &self.bounds
+    }
+}
+
+impl ValueMetric for Gauge {
+    fn record_value(&self, value: f64) {
+        self.set(value);
+    }
+}
+
+impl<const N: usize> ValueMetric for Histogram<N> {
+    fn record_value(&self, value: f64) {
+        self.record(value);
+    }
+}
+
+impl<const N: usize> Metric for Histogram<N> {
+    fn name(&self) -> &'static str {
+        self.name
+    }
+
+    fn export(&self, out: &mut String) {
+        out.push_str("{\"bounds\":[");
+        for (i, bound) in self.bounds.iter().enumerate() {
+            if i > 0 {
+                out.push(',');
+            }
+            write_number(out, *bound);
+        }
+        out.push_str("],\"counts\":[");
+        for count in &self.counts {
+            let _ = write!(out, "{},", count.swap(0, Ordering::Relaxed));
+        }
+        let _ = write!(out, "{}],\"sum\":", self.above.swap(0, Ordering::Relaxed));
+        write_number(out, f64::from_bits(self.sum.swap(0, Ordering::Relaxed)));
+        out.push('}');
+    }
+}
+
+static REGISTRY: Mutex<Vec<&'static dyn Metric>> = Mutex::new(Vec::new());
+
+/// Adds the metric to the exported ones. Registering a metric twice exports it once.
+pub fn register(metric: &'static dyn Metric) {
+    let mut registry = REGISTRY.lock();
+    let address = metric as *const dyn Metric as *const ();
+    if !registry
+        .iter()
+        .any(|registered| *registered as *const dyn Metric as *const () == address)
+    {
+        registry.push(metric);
+    }
+}
+
+/// Serializes the registered metrics into the given buffer, as the JSON payload described in the [module documentation](self),
+/// which resets the counters and histograms.
+pub fn export_json(out: &mut String) {
+    let registry = REGISTRY.lock();
+    let _ = write!(out, "{{\"time\":{},\"metrics\":{{", date_now());
+    for (i, metric) in registry.iter().enumerate() {
+        if i > 0 {
+            out.push(',');
+        }
+        write_string(out, metric.name());
+        out.push(':');
+        metric.export(out);
+    }
+    out.push_str("}}");
+}
+
+/// Queues a POST request of the given data to the URL with [`navigator.sendBeacon()`], as `application/json`.
+/// Returns `true` if the browser queued it.
+///
+/// It must be called from the main browser thread, as workers don't have `sendBeacon`.
+///
+/// [`navigator.sendBeacon()`]: https://developer.mozilla.org/en-US/docs/Web/API/Navigator/sendBeacon
+pub fn send_beacon(url: &str, data: &[u8]) -> bool {
+    let Ok(url) = CString::new(url) else {
+        return false;
+    };
+    unsafe { metrics_send_beacon(url.as_ptr(), data.as_ptr() as *const c_char, data.len()) != 0 }
+}
+
+// The number of payloads an exporter keeps while the browser doesn't queue them: the oldest ones are dropped beyond it.
+const MAX_UNSENT_PAYLOADS: usize = 16;
+
+// The state shared by the interval and the `beforeunload` callback of an exporter.
+struct ExporterState {
+    url: String,
+    payload: RefCell<String>,
+    // The payloads the browser didn't queue, oldest first, sent again before the next one.
+    unsent: RefCell<VecDeque<String>>,
+}
+
+impl ExporterState {
+    fn export(&self) {
+        let mut unsent = self.unsent.borrow_mut();
+        while let Some(payload) = unsent.front() {
+            if !send_beacon(&self.url, payload.as_bytes()) {
+                break;
+            }
+            unsent.pop_front();
+        }
+
+        let mut payload = self.payload.borrow_mut();
+        payload.clear();
+        export_json(&mut payload);
+        // The counters and histograms were reset by the export: the payload is kept until it's sent, in order.
+        if !unsent.is_empty() || !send_beacon(&self.url, payload.as_bytes()) {
+            if unsent.len() == MAX_UNSENT_PAYLOADS {
+                unsent.pop_front();
+            }
+            unsent.push_back(std::mem::take(&mut *payload));
+        }
+    }
+}
+
+unsafe extern "C" fn beforeunload_trampoline(
+    _event_type: c_int,
+    _reserved: *const c_void,
+    user_data: *mut c_void,
+) -> *const c_char {
+    let state = &*(user_data as *const ExporterState);
+    state.export();
+    // No confirmation dialog is asked for.
+    std::ptr::null()
+}
+
+/// Sends the registered metrics to a URL periodically, and when the page unloads. Dropping it stops the exports.
+///
+/// There can be only one exporter at a time, as the page has one `beforeunload` callback.
+/// It keeps up to 16 payloads the browser didn't queue, e.g. over its `sendBeacon` quota, and sends them again before the next one.
+///
+/// # Examples
+/// ```rust
+/// let exporter = Exporter::start("https://telemetry.example.com/metrics", 60_000.0);
+/// // Keeps exporting for the rest of the program.
+/// std::mem::forget(exporter);
+/// ```
+#[must_use = "the exports stop when the exporter is dropped"]
+pub struct Exporter {
+    state: Rc<ExporterState>,
+    timer: TimerHandle,
+}
+
+impl Exporter {
+    /// Starts exporting to the given URL every `interval` milliseconds, and on `beforeunload`.
+    /// It must be called from the main browser thread.
+    pub fn start(url: &str, interval: f64) -> Self {
+        let state = Rc::new(ExporterState {
+            url: url.to_string(),
+            payload: RefCell::new(String::new()),
+            unsent: RefCell::new(VecDeque::new()),
+        });
+
+        let interval_state = state.clone();
+        let timer = set_interval(move || interval_state.export(), interval);
+        unsafe {
+            html5::emscripten_set_beforeunload_callback_on_thread(
+                Rc::as_ptr(&state) as *mut c_void,
+                Some(beforeunload_trampoline),
+                CALLING_THREAD,
+            );
+        }
+
+        Self { state, timer }
+    }
+
+    /// Exports the metrics right away, e.g. after the loading finished.
+    pub fn export_now(&self) {
+        self.state.export();
+    }
+}
+
+impl Drop for Exporter {
+    fn drop(&mut self) {
+        self.timer.cancel();
+        unsafe {
+            html5::emscripten_set_beforeunload_callback_on_thread(
+                std::ptr::null_mut(),
+                None,
+                CALLING_THREAD,
+            );
+        }
+    }
+}
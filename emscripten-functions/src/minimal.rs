@@ -0,0 +1,196 @@
+//! A small set of functions that only need `core` and `alloc`, for programs built without the `std` feature:
+//! the main loop, running scripts, logging to the console, the time, and an allocator over emscripten's `malloc`.
+//!
+//! Without `std`, the crate is `no_std`, and only has this module and, with their feature, the `em_asm` macros:
+//! a tiny program, like a widget embedded in a page, then doesn't link std's formatting and panic machinery.
+//! The program itself is `#![no_std]`, sets [`Malloc`] as its `#[global_allocator]`, and defines its `#[panic_handler]`:
+//!
+//! ```rust
+//! #![no_std]
+//! #![no_main]
+//!
+//! use emscripten_functions::minimal::{self, Malloc};
+//!
+//! #[global_allocator]
+//! static ALLOCATOR: Malloc = Malloc;
+//!
+//! #[panic_handler]
+//! fn panic(_: &core::panic::PanicInfo) -> ! {
+//!     core::arch::wasm32::unreachable()
+//! }
+//!
+//! #[no_mangle]
+//! extern "C" fn main() -> i32 {
+//!     minimal::log(c"started");
+//!     minimal::set_main_loop(|| minimal::run_script(c"tick()"), 0, true);
+//!     0
+//! }
+//! ```
+//!
+//! The strings are passed as [`CStr`]s, usually `c"..."` literals, so that no copy is made to add their NUL terminator.
+
+use core::{
+    alloc::{GlobalAlloc, Layout},
+    ffi::{c_int, c_void, CStr},
+};
+
+use emscripten_functions_sys::{console, emscripten};
+
+extern "C" {
+    fn malloc(size: usize) -> *mut c_void;
+    fn free(ptr: *mut c_void);
+    fn realloc(ptr: *mut c_void, size: usize) -> *mut c_void;
+    fn memalign(alignment: usize, size: usize) -> *mut c_void;
+}
+
+// The alignment `malloc` guarantees on wasm32, with either dlmalloc or emmalloc.
+const MALLOC_ALIGN: usize = 8;
+
+/// A global allocator over emscripten's `malloc`, the one std's `System` allocator uses, for `no_std` programs.
+pub struct Malloc;
+
+unsafe impl GlobalAlloc for Malloc {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        if layout.align() <= MALLOC_ALIGN {
+            malloc(layout.size()) as *mut u8
+        } else {
+            memalign(layout.align(), layout.size()) as *mut u8
+        }
+    }
+
+    unsafe fn dealloc(&self, ptr: *mut u8, _layout: Layout) {
+        free(ptr as *mut c_void);
+    }
+
+    unsafe fn realloc(&self, ptr: *mut u8, layout: Layout, new_size: usize) -> *mut u8 {
+        if layout.align() <= MALLOC_ALIGN {
+            return realloc(ptr as *mut c_void, new_size) as *mut u8;
+        }
+        // `realloc` could lose the alignment.
+        let new_ptr = self.alloc(Layout::from_size_align_unchecked(new_size, layout.align()));
+        if !new_ptr.is_null() {
+            core::ptr::copy_nonoverlapping(ptr, new_ptr, layout.size().min(new_size));
+            self.dealloc(ptr, layout);
+        }
+        new_ptr
+    }
+}
+
+// The main loop is only available in builds without pthreads, which have a single thread.
+#[cfg(not(target_feature = "atomics"))]
+mod main_loop {
+    use alloc::boxed::Box;
+    use core::{
+        cell::{Cell, UnsafeCell},
+        ffi::c_int,
+    };
+
+    use emscripten_functions_sys::emscripten;
+
+    // The main loop closure. The builds without pthreads have a single thread, so a static slot works like std's `thread_local!` would.
+    // The generation changes when the main loop is set or cancelled, so that a tick knows if its closure was replaced while running.
+    struct MainLoopSlot {
+        func: UnsafeCell<Option<Box<dyn FnMut()>>>,
+        generation: Cell<u32>,
+    }
+
+    // There's no other thread to share it with.
+    unsafe impl Sync for MainLoopSlot {}
+
+    static MAIN_LOOP: MainLoopSlot = MainLoopSlot {
+        func: UnsafeCell::new(None),
+        generation: Cell::new(0),
+    };
+
+    unsafe extern "C" fn main_loop_trampoline() {
+        // The closure is taken out of the slot while it runs, so that it can set or cancel the main loop.
+        let generation = MAIN_LOOP.generation.get();
+        if let Some(mut func) = (*MAIN_LOOP.func.get()).take() {
+            func();
+            if MAIN_LOOP.generation.get() == generation {
+                *MAIN_LOOP.func.get() = Some(func);
+            }
+        }
+    }
+
+    /// Sets the given function as the main loop, like [`set_main_loop`](crate::emscripten::set_main_loop) does with std,
+    /// using the emscripten-defined [`emscripten_set_main_loop`]. It's only available in builds without pthreads.
+    ///
+    /// [`emscripten_set_main_loop`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_set_main_loop
+    ///
+    /// # Arguments
+    /// * `func` - The function to be set as main event loop.
+    /// * `fps` - The number of calls of the function per second.
+    ///   If set to a value <= 0, the browser's [`requestAnimationFrame()`] function will be used instead of a fixed rate.
+    /// * `simulate_infinite_loop` - If `true`, no code after the function call will be executed, otherwise the code after the function call will be executed.
+    ///
+    /// [`requestAnimationFrame()`]: https://developer.mozilla.org/en-US/docs/Web/API/window/requestAnimationFrame
+    pub fn set_main_loop<F>(func: F, fps: c_int, simulate_infinite_loop: bool)
+    where
+        F: 'static + FnMut(),
+    {
+        MAIN_LOOP
+            .generation
+            .set(MAIN_LOOP.generation.get().wrapping_add(1));
+        unsafe {
+            *MAIN_LOOP.func.get() = Some(Box::new(func));
+            emscripten::emscripten_set_main_loop(
+                Some(main_loop_trampoline),
+                fps,
+                simulate_infinite_loop as c_int,
+            );
+        }
+    }
+
+    /// Cancels the main loop set with [`set_main_loop`], and frees its function. It can be called from inside the function.
+    pub fn cancel_main_loop() {
+        MAIN_LOOP
+            .generation
+            .set(MAIN_LOOP.generation.get().wrapping_add(1));
+        unsafe {
+            emscripten::emscripten_cancel_main_loop();
+            *MAIN_LOOP.func.get() = None;
+        }
+    }
+}
+
+#[cfg(not(target_feature = "atomics"))]
+pub use main_loop::{cancel_main_loop, set_main_loop};
+
+/// Runs the given JavaScript script with the [`eval()`] JS function, using the emscripten-defined [`emscripten_run_script`].
+///
+/// [`eval()`]: https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/eval
+/// [`emscripten_run_script`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_run_script
+pub fn run_script(script: &CStr) {
+    unsafe { emscripten::emscripten_run_script(script.as_ptr()) };
+}
+
+/// Runs the given JavaScript script like [`run_script`], and returns its result converted to a C int,
+/// using the emscripten-defined [`emscripten_run_script_int`].
+///
+/// [`emscripten_run_script_int`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_run_script_int
+pub fn run_script_int(script: &CStr) -> c_int {
+    unsafe { emscripten::emscripten_run_script_int(script.as_ptr()) }
+}
+
+/// Returns the time in milliseconds, with sub-millisecond precision, using the emscripten-defined [`emscripten_get_now`].
+///
+/// [`emscripten_get_now`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_get_now
+pub fn get_now() -> f64 {
+    unsafe { emscripten::emscripten_get_now() }
+}
+
+/// Prints the given string with `console.log()`, using the emscripten-defined `emscripten_console_log`.
+pub fn log(message: &CStr) {
+    unsafe { console::emscripten_console_log(message.as_ptr()) };
+}
+
+/// Prints the given string with `console.warn()`, using the emscripten-defined `emscripten_console_warn`.
+pub fn warn(message: &CStr) {
+    unsafe { console::emscripten_console_warn(message.as_ptr()) };
+}
+
+/// Prints the given string with `console.error()`, using the emscripten-defined `emscripten_console_error`.
+pub fn error(message: &CStr) {
+    unsafe { console::emscripten_console_error(message.as_ptr()) };
+}
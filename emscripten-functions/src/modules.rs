@@ -0,0 +1,247 @@
+//! Loading code on demand: side modules with the emscripten-defined [`emscripten_dlopen`], and the Asyncify lazy code loading.
+//!
+//! Moving rarely used parts of a program (editor tooling, extra game modes) into side modules takes them out of the initial download and compilation.
+//! The main program must be built with `-sMAIN_MODULE` (or `-sMAIN_MODULE=2` with the exported symbols listed), and the side modules with `-sSIDE_MODULE`.
+//!
+//! [`emscripten_dlopen`]: https://emscripten.org/docs/compiling/Dynamic-Linking.html
+
+use std::{
+    ffi::CStr,
+    fmt::Display,
+    marker::PhantomData,
+    os::raw::{c_char, c_int, c_void},
+};
+
+use emscripten_functions_sys::emscripten;
+
+#[cfg(feature = "idb")]
+use crate::idb::Store;
+use crate::{
+    c_str::with_c_str,
+    emscripten::{has_asyncify, AsyncifyUnavailable},
+    executor::{callback_future, CallbackFuture},
+};
+
+extern "C" {
+    #[cfg(feature = "idb")]
+    fn modules_precompile_cached(
+        path: *const c_char,
+        db_name: *const c_char,
+        callback: unsafe extern "C" fn(*mut c_void, c_int),
+        arg: *mut c_void,
+    );
+    fn dlsym(handle: *mut c_void, name: *const c_char) -> *mut c_void;
+    fn dlclose(handle: *mut c_void) -> c_int;
+    fn dlerror() -> *mut c_char;
+}
+
+// The `dlopen` flag resolving all the symbols of the module when it's loaded.
+const RTLD_NOW: c_int = 2;
+
+/// The error of a module that couldn't be loaded, with the message of `dlerror`.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct LoadError(pub String);
+impl Display for LoadError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        write!(f, "Failed to load the module: {}", self.0)
+    }
+}
+
+fn last_error() -> LoadError {
+    let message = unsafe { dlerror() };
+    if message.is_null() {
+        LoadError(String::new())
+    } else {
+        LoadError(
+            unsafe { CStr::from_ptr(message) }
+                .to_string_lossy()
+                .into_owned(),
+        )
+    }
+}
+
+/// A loaded side module, closed when dropped. It belongs to the thread that loaded it.
+#[derive(Debug)]
+pub struct Module {
+    handle: *mut c_void,
+    _not_send: PhantomData<*const ()>,
+}
+
+impl Module {
+    /// Looks up the symbol of the module with the given name, using `dlsym`.
+    ///
+    /// # Safety
+    /// `T` must be the type of the symbol: a function pointer with the signature of the function it names (usually `extern "C"`),
+    /// or a pointer to data. Calling a function through a wrong signature is undefined behaviour.
+    ///
+    /// # Examples
+    /// ```rust
+    /// let editor = load_async("editor.wasm").await.unwrap();
+    /// let open_editor: extern "C" fn(c_int) = unsafe { editor.symbol("open_editor") }.unwrap();
+    /// open_editor(1);
+    /// ```
+    pub unsafe fn symbol<T: Copy>(&self, name: &str) -> Option<T> {
+        assert_eq!(
+            std::mem::size_of::<T>(),
+            std::mem::size_of::<*mut c_void>(),
+            "the symbol type must be a pointer"
+        );
+
+        let symbol = with_c_str(name, |name| dlsym(self.handle, name));
+        (!symbol.is_null()).then(|| std::mem::transmute_copy(&symbol))
+    }
+
+    /// Returns the `dlopen` handle of the module.
+    pub fn as_raw(&self) -> *mut c_void {
+        self.handle
+    }
+}
+
+impl Drop for Module {
+    fn drop(&mut self) {
+        unsafe { dlclose(self.handle) };
+    }
+}
+
+type OnLoad = Box<dyn FnOnce(Result<Module, LoadError>)>;
+
+unsafe extern "C" fn onsuccess(handle: *mut c_void, user_data: *mut c_void) {
+    let callback = Box::from_raw(user_data as *mut OnLoad);
+    callback(Ok(Module {
+        handle,
+        _not_send: PhantomData,
+    }));
+}
+
+unsafe extern "C" fn onerror(user_data: *mut c_void) {
+    let callback = Box::from_raw(user_data as *mut OnLoad);
+    callback(Err(last_error()));
+}
+
+/// Downloads, compiles and links the side module at the given path or URL without blocking, using the emscripten-defined [`emscripten_dlopen`],
+/// and calls `callback` with it once it's loaded.
+///
+/// [`emscripten_dlopen`]: https://emscripten.org/docs/compiling/Dynamic-Linking.html
+pub fn load<F>(path: &str, callback: F)
+where
+    F: 'static + FnOnce(Result<Module, LoadError>),
+{
+    let callback: OnLoad = Box::new(callback);
+    let user_data = Box::into_raw(Box::new(callback)) as *mut c_void;
+    with_c_str(path, |path| unsafe {
+        emscripten::emscripten_dlopen(path, RTLD_NOW, user_data, Some(onsuccess), Some(onerror))
+    });
+}
+
+/// Returns a future completing with the side module at the given path or URL once it's loaded. See [`load`].
+///
+/// # Examples
+/// ```rust
+/// spawn_local(async {
+///     match load_async("modes/battle_royale.wasm").await {
+///         Ok(module) => start_mode(module),
+///         Err(err) => console::error(&err.to_string()),
+///     }
+/// });
+/// ```
+pub fn load_async(path: &str) -> CallbackFuture<Result<Module, LoadError>> {
+    callback_future(|callback| load(path, callback))
+}
+
+/// How the `WebAssembly.Module` of a side module loaded with [`load_cached`] was obtained.
+#[cfg(feature = "idb")]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum CompileSource {
+    /// It was stored in the cache by a previous session, so it wasn't compiled.
+    Cache,
+    /// It was compiled, and stored in the cache if the browser allows it.
+    Compiled,
+    /// It couldn't be precompiled, e.g. because it couldn't be downloaded, so `dlopen` loaded it by itself.
+    Uncached,
+}
+
+#[cfg(feature = "idb")]
+type OnCachedLoad = Box<dyn FnOnce(Result<(Module, CompileSource), LoadError>)>;
+
+// The path and callback of a `load_cached` call, waiting for the precompilation.
+#[cfg(feature = "idb")]
+struct CachedLoad {
+    path: String,
+    callback: OnCachedLoad,
+}
+
+#[cfg(feature = "idb")]
+unsafe extern "C" fn precompiled(arg: *mut c_void, result: c_int) {
+    let CachedLoad { path, callback } = *Box::from_raw(arg as *mut CachedLoad);
+    let source = match result {
+        3 => {
+            callback(Err(LoadError(
+                "the dynamic linker has no preloadedWasm table, the program must be built with -sMAIN_MODULE"
+                    .to_string(),
+            )));
+            return;
+        }
+        2 => CompileSource::Cache,
+        1 => CompileSource::Compiled,
+        _ => CompileSource::Uncached,
+    };
+    load(&path, move |module| {
+        callback(module.map(|module| (module, source)))
+    });
+}
+
+/// Loads the side module at the given path or URL like [`load`], keeping its compiled `WebAssembly.Module` in the IndexedDB database of `cache`,
+/// keyed by the SHA-256 of its bytes: the next sessions load it without compiling it again, as long as it doesn't change.
+///
+/// The bytes are still downloaded to be hashed, so the module should be served with HTTP caching.
+/// Browsers that can't store compiled modules in IndexedDB (like Chromium-based ones) only compile it.
+/// The modules are stored under `wasm-module:`-prefixed keys, and removed with the other keys by [`Store::clear`].
+///
+/// The compiled module is handed to `dlopen` through the `preloadedWasm` table of emscripten's dynamic linker, the one `--use-preload-plugins` fills in,
+/// which only exists in a main module: without it, `callback` gets an error, rather than the module being compiled twice.
+///
+/// # Examples
+/// ```rust
+/// let cache = Store::new("module-cache");
+/// load_cached("editor.wasm", &cache, |result| match result {
+///     Ok((editor, source)) => {
+///         console::log(&format!("Editor loaded from {:?}", source));
+///         open_editor(editor);
+///     }
+///     Err(err) => console::error(&err.to_string()),
+/// });
+/// ```
+#[cfg(feature = "idb")]
+pub fn load_cached<F>(path: &str, cache: &Store, callback: F)
+where
+    F: 'static + FnOnce(Result<(Module, CompileSource), LoadError>),
+{
+    let arg = Box::into_raw(Box::new(CachedLoad {
+        path: path.to_string(),
+        callback: Box::new(callback),
+    })) as *mut c_void;
+    with_c_str(path, |path| unsafe {
+        modules_precompile_cached(path, cache.db_name().as_ptr(), precompiled, arg)
+    });
+}
+
+/// Returns a future completing with the side module at the given path or URL once it's loaded. See [`load_cached`].
+#[cfg(feature = "idb")]
+pub fn load_cached_async(
+    path: &str,
+    cache: &Store,
+) -> CallbackFuture<Result<(Module, CompileSource), LoadError>> {
+    callback_future(|callback| load_cached(path, cache, callback))
+}
+
+/// Loads the rest of the code of a program built with `-sASYNCIFY_LAZY_LOAD_CODE`, blocking until it's done,
+/// using the emscripten-defined [`emscripten_lazy_load_code`]. It does nothing once the code is loaded.
+///
+/// [`emscripten_lazy_load_code`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_lazy_load_code
+pub fn lazy_load_code() -> Result<(), AsyncifyUnavailable> {
+    if !has_asyncify() {
+        return Err(AsyncifyUnavailable);
+    }
+    unsafe { emscripten::emscripten_lazy_load_code() };
+    Ok(())
+}
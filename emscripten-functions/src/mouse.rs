@@ -0,0 +1,192 @@
+//! A polled mouse state, read once per tick, for games that poll their input rather than handle events.
+//!
+//! [`get_mouse_status`] gives the state of the mouse as of its last event, but the movements and the wheel scrolls of the other events
+//! of the frame, and the clicks shorter than a frame, are lost between two polls. A [`MouseTracker`] sums them from its event listeners,
+//! and [`MouseTracker::poll`] combines them with the last status into a [`MouseState`], resetting them for the next tick.
+
+use std::{cell::Cell, rc::Rc};
+
+use emscripten_functions_sys::html5::{DOM_DELTA_LINE, DOM_DELTA_PAGE};
+
+use crate::html5::{
+    events::{
+        on_mousedown, on_mousemove, on_mouseup, on_wheel, EmscriptenMouseEvent, EventListener,
+        EventTarget,
+    },
+    get_mouse_status, Html5Error,
+};
+
+/// The height of a line, in CSS pixels, used to convert the wheel scrolls given in lines.
+pub const LINE_HEIGHT: f64 = 16.0;
+/// The height of a page, in CSS pixels, used to convert the wheel scrolls given in pages.
+pub const PAGE_HEIGHT: f64 = 800.0;
+
+/// A mouse button, as numbered by the DOM `button` property.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum MouseButton {
+    Left,
+    Middle,
+    Right,
+    /// The "browser back" button.
+    Back,
+    /// The "browser forward" button.
+    Forward,
+}
+
+impl MouseButton {
+    fn mask(self) -> u16 {
+        1 << self as u16
+    }
+}
+
+/// The state of the mouse at a tick, returned by [`MouseTracker::poll`]. The positions are in CSS pixels, relative to the target.
+#[derive(Debug, Clone, Copy, Default, PartialEq)]
+pub struct MouseState {
+    /// The position of the mouse at its last event.
+    pub x: i32,
+    /// The position of the mouse at its last event.
+    pub y: i32,
+    /// The sum of the movements since the previous poll, as reported by the browser (it's also given while the pointer is locked).
+    pub dx: i32,
+    /// The sum of the movements since the previous poll.
+    pub dy: i32,
+    /// The sum of the horizontal wheel scrolls since the previous poll, in CSS pixels.
+    pub wheel_x: f64,
+    /// The sum of the vertical wheel scrolls since the previous poll, in CSS pixels; positive when scrolling down.
+    pub wheel_y: f64,
+    // The buttons held down, and the ones pressed and released since the previous poll, as masks of the `MouseButton` bits.
+    down: u16,
+    pressed: u16,
+    released: u16,
+}
+
+impl MouseState {
+    /// Returns `true` if the button is held down.
+    pub fn is_down(&self, button: MouseButton) -> bool {
+        self.down & button.mask() != 0
+    }
+
+    /// Returns `true` if the button was pressed since the previous poll, even if it's already released.
+    pub fn was_pressed(&self, button: MouseButton) -> bool {
+        self.pressed & button.mask() != 0
+    }
+
+    /// Returns `true` if the button was released since the previous poll.
+    pub fn was_released(&self, button: MouseButton) -> bool {
+        self.released & button.mask() != 0
+    }
+}
+
+// What the listeners gather between two polls.
+#[derive(Clone, Copy, Default)]
+struct Accumulated {
+    dx: i32,
+    dy: i32,
+    wheel_x: f64,
+    wheel_y: f64,
+    down: u16,
+    pressed: u16,
+    released: u16,
+}
+
+/// The event listeners gathering the mouse input of a target between two polls. Dropping it removes them.
+///
+/// # Examples
+/// ```rust
+/// let mouse = MouseTracker::new(EventTarget::Selector("#canvas")).unwrap();
+/// set_main_loop(move || {
+///     let state = mouse.poll();
+///     camera.turn(state.dx, state.dy);
+///     camera.zoom(state.wheel_y);
+///     if state.was_pressed(MouseButton::Left) {
+///         fire(state.x, state.y);
+///     }
+/// }, 0, true);
+/// ```
+#[must_use = "the listeners are removed when dropped"]
+pub struct MouseTracker {
+    accumulated: Rc<Cell<Accumulated>>,
+    _listeners: [EventListener; 4],
+}
+
+impl MouseTracker {
+    /// Starts gathering the mouse input of the target, usually the canvas.
+    pub fn new(target: EventTarget) -> Result<Self, Html5Error> {
+        let accumulated = Rc::new(Cell::new(Accumulated::default()));
+
+        let update = |func: fn(&mut Accumulated, u16)| {
+            let accumulated = accumulated.clone();
+            move |event: &EmscriptenMouseEvent| {
+                let mut state = accumulated.get();
+                func(&mut state, 1 << event.button.min(15));
+                state.dx += event.movementX as i32;
+                state.dy += event.movementY as i32;
+                accumulated.set(state);
+                false
+            }
+        };
+        let wheel_accumulated = accumulated.clone();
+        let listeners = [
+            on_mousemove(target, false, update(|_, _| {}))?,
+            on_mousedown(
+                target,
+                false,
+                update(|state, mask| {
+                    state.down |= mask;
+                    state.pressed |= mask;
+                }),
+            )?,
+            on_mouseup(
+                target,
+                false,
+                update(|state, mask| {
+                    state.down &= !mask;
+                    state.released |= mask;
+                }),
+            )?,
+            on_wheel(target, false, move |event| {
+                let scale = match event.deltaMode as u32 {
+                    DOM_DELTA_LINE => LINE_HEIGHT,
+                    DOM_DELTA_PAGE => PAGE_HEIGHT,
+                    _ => 1.0,
+                };
+                let mut state = wheel_accumulated.get();
+                state.wheel_x += event.deltaX * scale;
+                state.wheel_y += event.deltaY * scale;
+                wheel_accumulated.set(state);
+                // Keeps the page from scrolling.
+                true
+            })?,
+        ];
+
+        Ok(Self {
+            accumulated,
+            _listeners: listeners,
+        })
+    }
+
+    /// Returns the state of the mouse, with the movements, scrolls and clicks since the previous call, and resets them.
+    /// It's meant to be called once per tick, at its start.
+    pub fn poll(&self) -> MouseState {
+        let accumulated = self.accumulated.get();
+        self.accumulated.set(Accumulated {
+            down: accumulated.down,
+            ..Default::default()
+        });
+
+        let (x, y) = get_mouse_status().map_or((0, 0), |status| {
+            (status.targetX as i32, status.targetY as i32)
+        });
+        MouseState {
+            x,
+            y,
+            dx: accumulated.dx,
+            dy: accumulated.dy,
+            wheel_x: accumulated.wheel_x,
+            wheel_y: accumulated.wheel_y,
+            down: accumulated.down,
+            pressed: accumulated.pressed,
+            released: accumulated.released,
+        }
+    }
+}
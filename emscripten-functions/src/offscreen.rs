@@ -0,0 +1,228 @@
+//! Rendering from a pthread, to a canvas transferred to it as an [`OffscreenCanvas`].
+//!
+//! The [`OffscreenRenderer`] moves a canvas to a new thread, creates a WebGL context for it there with explicit swap control,
+//! and runs a render loop that presents each frame with [`commit_frame`], so that rendering never waits on the main thread.
+//!
+//! The program must be built with `-pthread -sOFFSCREENCANVAS_SUPPORT`.
+//!
+//! [`OffscreenCanvas`]: https://developer.mozilla.org/en-US/docs/Web/API/OffscreenCanvas
+
+use std::{
+    ffi::CString,
+    fmt::Display,
+    os::raw::{c_char, c_int, c_void},
+    sync::{
+        atomic::{AtomicBool, Ordering},
+        Arc, Mutex,
+    },
+};
+
+use emscripten_functions_sys::html5;
+
+use crate::{
+    emscripten::{cancel_main_loop, set_main_loop_with_arg_direct},
+    html5::Html5Error,
+    webgl::{commit_frame, Context, ContextBuilder},
+};
+
+extern "C" {
+    fn offscreen_thread_create(
+        canvases: *const c_char,
+        func: unsafe extern "C" fn(*mut c_void) -> *mut c_void,
+        arg: *mut c_void,
+    ) -> c_int;
+    fn pthread_exit(value: *mut c_void) -> !;
+}
+
+/// Returns `true` if the browser supports `OffscreenCanvas`, using the emscripten-defined [`emscripten_supports_offscreencanvas`].
+///
+/// [`emscripten_supports_offscreencanvas`]: https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_supports_offscreencanvas
+pub fn supports_offscreen_canvas() -> bool {
+    unsafe { html5::emscripten_supports_offscreencanvas() != 0 }
+}
+
+/// The error of an [`OffscreenRenderer`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum OffscreenError {
+    /// The browser doesn't support `OffscreenCanvas`.
+    NotSupported,
+    /// The render thread couldn't be created, with the given `pthread_create` error code.
+    ThreadCreation(c_int),
+    /// The WebGL context couldn't be created or made current on the render thread.
+    Context(Html5Error),
+}
+
+impl Display for OffscreenError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        match self {
+            OffscreenError::NotSupported => write!(f, "OffscreenCanvas not supported"),
+            OffscreenError::ThreadCreation(code) => {
+                write!(f, "Failed to create the render thread (error {})", code)
+            }
+            OffscreenError::Context(err) => write!(f, "WebGL context error: {}", err),
+        }
+    }
+}
+
+// The state shared by the renderer handle and its thread.
+struct Shared {
+    stop: AtomicBool,
+    running: AtomicBool,
+    error: Mutex<Option<OffscreenError>>,
+}
+
+// What the render thread starts with.
+struct Start<F> {
+    canvas: String,
+    builder: ContextBuilder,
+    render: F,
+    shared: Arc<Shared>,
+}
+
+/// A render loop running on its own thread, drawing to a transferred canvas.
+///
+/// Once transferred, the canvas can't be drawn to from the main thread anymore, even after the renderer stops.
+/// Dropping the renderer stops its loop at the next frame, and the thread exits then.
+///
+/// # Examples
+/// ```rust
+/// if supports_offscreen_canvas() {
+///     let mut builder = Context::builder();
+///     builder.version(2, 0).antialias(false);
+///
+///     let renderer = OffscreenRenderer::spawn("#canvas", &builder, move |context| {
+///         draw_scene();
+///         true
+///     })
+///     .unwrap();
+///     renderer.forget();
+/// }
+/// ```
+pub struct OffscreenRenderer {
+    shared: Arc<Shared>,
+    stop_on_drop: bool,
+}
+
+impl OffscreenRenderer {
+    /// Transfers the canvas matching the given CSS selector to a new thread, and starts rendering to it there.
+    ///
+    /// # Arguments
+    /// * `canvas` - The CSS selector of the canvas, e.g. `#canvas`.
+    /// * `builder` - The attributes of the WebGL context; explicit swap control is turned on for it.
+    /// * `render` - The function called on the render thread once per animation frame, before the frame is committed.
+    ///   It returns `false` to stop the loop, which destroys the context.
+    pub fn spawn<F>(
+        canvas: &str,
+        builder: &ContextBuilder,
+        render: F,
+    ) -> Result<Self, OffscreenError>
+    where
+        F: 'static + Send + FnMut(&Context) -> bool,
+    {
+        if !supports_offscreen_canvas() {
+            return Err(OffscreenError::NotSupported);
+        }
+
+        let shared = Arc::new(Shared {
+            stop: AtomicBool::new(false),
+            running: AtomicBool::new(true),
+            error: Mutex::new(None),
+        });
+        let mut builder = builder.clone();
+        builder.explicit_swap_control(true);
+
+        let canvases = CString::new(canvas).expect("the selector mustn't contain nul bytes");
+        let start = Box::into_raw(Box::new(Start {
+            canvas: canvas.to_string(),
+            builder,
+            render,
+            shared: shared.clone(),
+        })) as *mut c_void;
+
+        let result = unsafe { offscreen_thread_create(canvases.as_ptr(), thread_main::<F>, start) };
+        if result != 0 {
+            drop(unsafe { Box::from_raw(start as *mut Start<F>) });
+            return Err(OffscreenError::ThreadCreation(result));
+        }
+
+        Ok(Self {
+            shared,
+            stop_on_drop: true,
+        })
+    }
+
+    /// Asks the render loop to stop, at its next frame.
+    pub fn stop(&self) {
+        self.shared.stop.store(true, Ordering::Relaxed);
+    }
+
+    /// Returns `false` once the render loop stopped, or failed to start.
+    pub fn is_running(&self) -> bool {
+        self.shared.running.load(Ordering::Acquire)
+    }
+
+    /// Returns the error the render thread failed with, if any.
+    pub fn error(&self) -> Option<OffscreenError> {
+        *self.shared.error.lock().unwrap()
+    }
+
+    /// Keeps the render loop running after the renderer is dropped, until its function returns `false`.
+    pub fn forget(mut self) {
+        self.stop_on_drop = false;
+    }
+}
+
+impl Drop for OffscreenRenderer {
+    fn drop(&mut self) {
+        if self.stop_on_drop {
+            self.stop();
+        }
+    }
+}
+
+unsafe extern "C" fn thread_main<F>(start: *mut c_void) -> *mut c_void
+where
+    F: 'static + FnMut(&Context) -> bool,
+{
+    let Start {
+        canvas,
+        builder,
+        render,
+        shared,
+    } = *Box::from_raw(start as *mut Start<F>);
+
+    let context = match builder
+        .create(&canvas)
+        .and_then(|context| context.make_current().map(|_| context))
+    {
+        Ok(context) => context,
+        Err(err) => {
+            *shared.error.lock().unwrap() = Some(OffscreenError::Context(err));
+            shared.running.store(false, Ordering::Release);
+            return std::ptr::null_mut();
+        }
+    };
+
+    // The loop's state is dropped when it's cancelled, destroying the context on this thread.
+    // The runtime would then keep the thread alive with nothing to run, so it exits from the next turn of its event loop,
+    // once the state is dropped.
+    set_main_loop_with_arg_direct(
+        move |(context, render, shared): &mut (Context, F, Arc<Shared>)| {
+            if shared.stop.load(Ordering::Relaxed) || !render(context) {
+                shared.running.store(false, Ordering::Release);
+                cancel_main_loop();
+                html5::emscripten_set_timeout(Some(exit_thread), 0.0, std::ptr::null_mut());
+                return;
+            }
+            let _ = commit_frame();
+        },
+        (context, render, shared),
+        0,
+        true,
+    );
+    std::ptr::null_mut()
+}
+
+unsafe extern "C" fn exit_thread(_arg: *mut c_void) {
+    pthread_exit(std::ptr::null_mut());
+}
@@ -0,0 +1,242 @@
+//! Suspending and resuming the program with the page lifecycle, so that the page stays eligible for the back/forward cache.
+//!
+//! A page restored from the back/forward cache comes back instantly, with its wasm instance and state, instead of being
+//! reloaded and compiled again. The browsers only keep the pages that don't hold some resources meanwhile though, e.g. open
+//! WebSockets, and evict those with work still running. A [`PageLifecycle`] listens to the `pagehide`, `pageshow`, `freeze`
+//! and `resume` events: when the page is hidden into the cache, frozen or unloaded it pauses the main loop and the
+//! [`timers`](crate::timers), and calls the [`PageLifecycle::on_suspend`] callbacks, which should close the sockets and release
+//! the GPU contexts; when it comes back, the [`PageLifecycle::on_resume`] callbacks, which reopen them, and resumes the rest.
+//!
+//! It never registers `unload` or `beforeunload` listeners, which make the page ineligible for the cache.
+
+use std::{
+    cell::RefCell,
+    fmt::Display,
+    marker::PhantomData,
+    os::raw::{c_int, c_void},
+};
+
+use crate::{
+    emscripten::{pause_main_loop, resume_main_loop},
+    timers::{pause_timers, resume_timers},
+};
+
+extern "C" {
+    fn page_lifecycle_listen(
+        callback: unsafe extern "C" fn(arg: *mut c_void, event: c_int, persisted: c_int),
+        arg: *mut c_void,
+    ) -> c_int;
+    fn page_lifecycle_unlisten(id: c_int);
+}
+
+// The events of `page_lifecycle.c`.
+const PAGEHIDE: c_int = 0;
+const PAGESHOW: c_int = 1;
+const FREEZE: c_int = 2;
+const RESUME: c_int = 3;
+
+/// Why a page was suspended, given to the [`PageLifecycle`] callbacks.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Suspension {
+    /// The page was hidden into the back/forward cache (a `pagehide` event with `persisted` set). It's resumed if the user navigates back.
+    BackForwardCache,
+    /// The page was frozen by the browser, e.g. a background tab to save resources (a `freeze` event).
+    Frozen,
+    /// The page is being unloaded, and won't be resumed (a `pagehide` event without `persisted`).
+    Unload,
+}
+
+/// The error returned by [`PageLifecycle::new`] where there's no page, e.g. in node or a worker.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct PageLifecycleError;
+
+impl Display for PageLifecycleError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        write!(f, "There's no page to follow the lifecycle of")
+    }
+}
+
+type Callback = Box<dyn FnMut(Suspension)>;
+
+struct LifecycleState {
+    suspension: Option<Suspension>,
+    pause_main_loop: bool,
+    pause_timers: bool,
+    // Whether the main loop and timers were paused by the current suspension.
+    paused_main_loop: bool,
+    paused_timers: bool,
+    onsuspend: Vec<Callback>,
+    onresume: Vec<Callback>,
+}
+
+impl LifecycleState {
+    fn callbacks(&mut self, resume: bool) -> &mut Vec<Callback> {
+        if resume {
+            &mut self.onresume
+        } else {
+            &mut self.onsuspend
+        }
+    }
+}
+
+// Calls the callbacks with the state unborrowed, so that they can add callbacks, which go after them.
+fn call(state: &RefCell<LifecycleState>, resume: bool, suspension: Suspension) {
+    let mut callbacks = std::mem::take(state.borrow_mut().callbacks(resume));
+    for callback in &mut callbacks {
+        callback(suspension);
+    }
+    let mut state = state.borrow_mut();
+    let added = std::mem::replace(state.callbacks(resume), callbacks);
+    state.callbacks(resume).extend(added);
+}
+
+fn suspend(state: &RefCell<LifecycleState>, suspension: Suspension) {
+    {
+        let mut state = state.borrow_mut();
+        if state.suspension.is_some() {
+            return;
+        }
+        state.suspension = Some(suspension);
+        if state.pause_main_loop {
+            pause_main_loop();
+            state.paused_main_loop = true;
+        }
+        if state.pause_timers {
+            pause_timers();
+            state.paused_timers = true;
+        }
+    }
+    call(state, false, suspension);
+}
+
+fn resume(state: &RefCell<LifecycleState>) {
+    let Some(suspension) = state.borrow_mut().suspension.take() else {
+        return;
+    };
+    // The callbacks reopen the resources first, so that the main loop and timers find them open.
+    call(state, true, suspension);
+    let mut state = state.borrow_mut();
+    if std::mem::take(&mut state.paused_timers) {
+        resume_timers();
+    }
+    if std::mem::take(&mut state.paused_main_loop) {
+        resume_main_loop();
+    }
+}
+
+unsafe extern "C" fn event_trampoline(arg: *mut c_void, event: c_int, persisted: c_int) {
+    let state = &*(arg as *const RefCell<LifecycleState>);
+    match (event, persisted != 0) {
+        (PAGEHIDE, true) => suspend(state, Suspension::BackForwardCache),
+        (PAGEHIDE, false) => suspend(state, Suspension::Unload),
+        (FREEZE, _) => suspend(state, Suspension::Frozen),
+        // A `pageshow` without `persisted` is the first load of the page.
+        (PAGESHOW, true) | (RESUME, _) => resume(state),
+        _ => {}
+    }
+}
+
+/// Follows the page lifecycle, suspending the program while the page is in the back/forward cache or frozen.
+/// See the [module documentation](self).
+///
+/// A page going into the cache is usually frozen right after, and resumed before being shown again: the program is suspended
+/// once, by the first of the events, and resumed by the first of the events bringing it back.
+///
+/// Dropping it stops listening; a program suspended at that time stays so.
+///
+/// # Examples
+/// ```rust
+/// let lifecycle = PageLifecycle::new().unwrap();
+/// let socket = Rc::new(RefCell::new(Some(connect())));
+///
+/// let suspended_socket = socket.clone();
+/// lifecycle.on_suspend(move |_| {
+///     // An open WebSocket keeps the page out of the back/forward cache.
+///     if let Some(socket) = suspended_socket.borrow_mut().take() {
+///         let _ = socket.close(1000, "suspended");
+///     }
+/// });
+/// lifecycle.on_resume(move |_| {
+///     *socket.borrow_mut() = Some(connect());
+/// });
+/// ```
+pub struct PageLifecycle {
+    id: c_int,
+    state: *mut RefCell<LifecycleState>,
+    _not_send: PhantomData<*const ()>,
+}
+
+impl PageLifecycle {
+    /// Starts following the page lifecycle, pausing the main loop and timers while suspended.
+    pub fn new() -> Result<Self, PageLifecycleError> {
+        let state = Box::into_raw(Box::new(RefCell::new(LifecycleState {
+            suspension: None,
+            pause_main_loop: true,
+            pause_timers: true,
+            paused_main_loop: false,
+            paused_timers: false,
+            onsuspend: Vec::new(),
+            onresume: Vec::new(),
+        })));
+        let id = unsafe { page_lifecycle_listen(event_trampoline, state as *mut c_void) };
+        if id == 0 {
+            drop(unsafe { Box::from_raw(state) });
+            return Err(PageLifecycleError);
+        }
+        Ok(Self {
+            id,
+            state,
+            _not_send: PhantomData,
+        })
+    }
+
+    fn state(&self) -> &RefCell<LifecycleState> {
+        unsafe { &*self.state }
+    }
+
+    /// Sets whether the calling thread's main loop is paused while the page is suspended, which it is by default.
+    /// It applies from the next suspension.
+    pub fn set_pause_main_loop(&self, pause: bool) {
+        self.state().borrow_mut().pause_main_loop = pause;
+    }
+
+    /// Sets whether the [`timers`](crate::timers) of the calling thread are paused while the page is suspended,
+    /// which they are by default. It applies from the next suspension.
+    pub fn set_pause_timers(&self, pause: bool) {
+        self.state().borrow_mut().pause_timers = pause;
+    }
+
+    /// Adds a callback called when the page is suspended, once the main loop and timers are paused,
+    /// to release the resources that keep the page out of the back/forward cache: WebSockets, GPU contexts, pending requests.
+    pub fn on_suspend<F>(&self, onsuspend: F)
+    where
+        F: 'static + FnMut(Suspension),
+    {
+        self.state()
+            .borrow_mut()
+            .onsuspend
+            .push(Box::new(onsuspend));
+    }
+
+    /// Adds a callback called when the page is resumed, with the reason it was suspended for, before the main loop and timers resume.
+    pub fn on_resume<F>(&self, onresume: F)
+    where
+        F: 'static + FnMut(Suspension),
+    {
+        self.state().borrow_mut().onresume.push(Box::new(onresume));
+    }
+
+    /// Returns why the page is currently suspended, or `None` if it isn't.
+    pub fn suspension(&self) -> Option<Suspension> {
+        self.state().borrow().suspension
+    }
+}
+
+impl Drop for PageLifecycle {
+    fn drop(&mut self) {
+        unsafe {
+            page_lifecycle_unlisten(self.id);
+            drop(Box::from_raw(self.state));
+        }
+    }
+}
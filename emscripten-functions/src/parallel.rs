@@ -0,0 +1,400 @@
+//! A persistent pool of [Wasm Workers](crate::wasm_worker) with work-stealing deques in shared memory,
+//! for data-parallel loops and fork-join recursion.
+//!
+//! Each worker, and the thread calling into the pool, has its own deque of tasks.
+//! Ranges are split in halves as they run: the owner keeps working on the newest half, from the back of its deque,
+//! while idle workers steal the oldest, and thus biggest, ones from the front, so that the load balances itself
+//! without knowing the cost of the items upfront.
+//!
+//! The calling thread works on the tasks too, until all of them are done. On the main browser thread that's a busy wait,
+//! like the emscripten locks it uses, so the calls should be kept shorter than a frame there.
+//!
+//! The program must be built with `-sWASM_WORKERS`.
+
+use std::{
+    cell::{Cell, UnsafeCell},
+    collections::VecDeque,
+    ops::Range,
+    os::raw::c_int,
+    sync::{
+        atomic::{fence, AtomicBool, AtomicU32, AtomicUsize, Ordering},
+        Arc,
+    },
+};
+
+use emscripten_functions_sys::wasm_worker;
+
+use crate::wasm_worker::{
+    self as worker, hardware_concurrency, post_to_parent, WasmWorker, WasmWorkerSpawnError,
+};
+
+/// The stack size of the pool's workers used by [`ParallelPool::with_hardware_concurrency`], in bytes.
+pub const DEFAULT_STACK_SIZE: usize = 256 * 1024;
+
+// An `emscripten_lock_t`, held only for a few instructions at a time, so it's always acquired by spinning,
+// which also works on the main browser thread. 0 is its static initializer.
+struct Lock(UnsafeCell<u32>);
+
+impl Lock {
+    fn new() -> Self {
+        Self(UnsafeCell::new(0))
+    }
+
+    fn acquire(&self) {
+        unsafe { wasm_worker::emscripten_lock_busyspin_waitinf_acquire(self.0.get()) };
+    }
+
+    fn release(&self) {
+        unsafe { wasm_worker::emscripten_lock_release(self.0.get()) };
+    }
+}
+
+// A job of a `parallel_for` or `join` call, living on the stack of its caller until `remaining` gets to 0.
+struct Job {
+    // Runs the items of the given range on the type-erased `data`.
+    run: unsafe fn(*const (), usize, usize),
+    data: *const (),
+    chunk: usize,
+    // The number of items not run yet. The job mustn't be touched after taking the last ones out.
+    remaining: AtomicUsize,
+}
+
+// A range of the items of a job, still to be run.
+#[derive(Clone, Copy)]
+struct Task {
+    job: *const Job,
+    start: usize,
+    end: usize,
+}
+
+#[repr(align(64))]
+struct Deque {
+    lock: Lock,
+    tasks: UnsafeCell<VecDeque<Task>>,
+}
+
+impl Deque {
+    fn with<R>(&self, func: impl FnOnce(&mut VecDeque<Task>) -> R) -> R {
+        self.lock.acquire();
+        let result = func(unsafe { &mut *self.tasks.get() });
+        self.lock.release();
+        result
+    }
+}
+
+struct Shared {
+    // One deque per worker, and a last one for the thread calling into the pool, which holds `caller` meanwhile.
+    deques: Box<[Deque]>,
+    caller: Lock,
+    // An `emscripten_semaphore_t` the idle workers wait on, released when tasks get pushed while some of them are `sleeping`.
+    wakeups: UnsafeCell<u32>,
+    sleeping: AtomicU32,
+    shutdown: AtomicBool,
+}
+
+unsafe impl Sync for Shared {}
+unsafe impl Send for Shared {}
+
+thread_local! {
+    // The pool the current thread works for, and its deque there.
+    static CURRENT: Cell<Option<(*const Shared, usize)>> = const { Cell::new(None) };
+}
+
+impl Shared {
+    fn push(&self, slot: usize, task: Task) {
+        self.deques[slot].with(|tasks| tasks.push_back(task));
+        // Pairs with a worker raising `sleeping` before looking for tasks a last time.
+        fence(Ordering::SeqCst);
+        if self.sleeping.load(Ordering::SeqCst) > 0 {
+            self.wake(1);
+        }
+    }
+
+    fn wake(&self, count: usize) {
+        unsafe { wasm_worker::emscripten_semaphore_release(self.wakeups.get(), count as c_int) };
+    }
+
+    // Takes the newest task of the own deque, or else steals the oldest one of another deque.
+    fn find_task(&self, slot: usize) -> Option<Task> {
+        if let Some(task) = self.deques[slot].with(|tasks| tasks.pop_back()) {
+            return Some(task);
+        }
+        let count = self.deques.len();
+        (1..count)
+            .find_map(|offset| self.deques[(slot + offset) % count].with(|tasks| tasks.pop_front()))
+    }
+
+    // Runs the task, pushing its back halves for others to steal until it's at most a chunk long.
+    unsafe fn execute(&self, slot: usize, task: Task) {
+        let job = &*task.job;
+        let (run, data, chunk) = (job.run, job.data, job.chunk);
+        let (start, mut end) = (task.start, task.end);
+        while end - start > chunk {
+            let middle = start + (end - start) / 2;
+            self.push(
+                slot,
+                Task {
+                    job: task.job,
+                    start: middle,
+                    end,
+                },
+            );
+            end = middle;
+        }
+
+        run(data, start, end);
+        job.remaining.fetch_sub(end - start, Ordering::AcqRel);
+    }
+
+    // Runs tasks, of any job, until the given one is done.
+    fn help_until_done(&self, slot: usize, job: &Job) {
+        while job.remaining.load(Ordering::Acquire) != 0 {
+            match self.find_task(slot) {
+                Some(task) => unsafe { self.execute(slot, task) },
+                None => std::hint::spin_loop(),
+            }
+        }
+    }
+}
+
+// The deque of the current thread in a pool, for the duration of a call into it.
+struct Entered<'a> {
+    shared: &'a Shared,
+    slot: usize,
+    previous: Option<(*const Shared, usize)>,
+    holds_caller: bool,
+}
+
+impl<'a> Entered<'a> {
+    fn new(shared: &'a Shared) -> Self {
+        let previous = CURRENT.with(|current| current.get());
+        // The pool's workers, and a caller nesting calls, keep their deque.
+        if let Some((pool, slot)) = previous {
+            if std::ptr::eq(pool, shared) {
+                return Self {
+                    shared,
+                    slot,
+                    previous,
+                    holds_caller: false,
+                };
+            }
+        }
+
+        shared.caller.acquire();
+        let slot = shared.deques.len() - 1;
+        CURRENT.with(|current| current.set(Some((shared, slot))));
+        Self {
+            shared,
+            slot,
+            previous,
+            holds_caller: true,
+        }
+    }
+}
+
+impl Drop for Entered<'_> {
+    fn drop(&mut self) {
+        if self.holds_caller {
+            CURRENT.with(|current| current.set(self.previous));
+            self.shared.caller.release();
+        }
+    }
+}
+
+/// A pool of Wasm Workers running [`parallel_for`](ParallelPool::parallel_for) and [`join`](ParallelPool::join) calls.
+///
+/// The calls can be nested, e.g. a `join` inside the function of a `parallel_for`, and run on the same deques.
+/// Calls from several threads that aren't the pool's workers are serialized.
+/// Dropping the pool stops its workers, that get terminated by the thread that created them once it returns to its event loop.
+///
+/// # Examples
+/// ```rust
+/// let pool = ParallelPool::with_hardware_concurrency().unwrap();
+///
+/// let pixels: Vec<AtomicU32> = (0..width * height).map(|_| AtomicU32::new(0)).collect();
+/// pool.parallel_for(0..height, 4, |y| {
+///     for x in 0..width {
+///         pixels[y * width + x].store(trace_ray(x, y), Ordering::Relaxed);
+///     }
+/// });
+///
+/// fn sum(pool: &ParallelPool, values: &[u64]) -> u64 {
+///     if values.len() < 4096 {
+///         return values.iter().sum();
+///     }
+///     let (left, right) = values.split_at(values.len() / 2);
+///     let (left, right) = pool.join(|| sum(pool, left), || sum(pool, right));
+///     left + right
+/// }
+/// ```
+pub struct ParallelPool {
+    shared: Arc<Shared>,
+    workers: usize,
+}
+
+impl ParallelPool {
+    /// Creates a pool of `workers` Wasm Workers, each with a stack of `stack_size` bytes.
+    pub fn new(workers: usize, stack_size: usize) -> Result<Self, WasmWorkerSpawnError> {
+        let shared = Arc::new(Shared {
+            deques: (0..=workers)
+                .map(|_| Deque {
+                    lock: Lock::new(),
+                    tasks: UnsafeCell::new(VecDeque::new()),
+                })
+                .collect(),
+            caller: Lock::new(),
+            wakeups: UnsafeCell::new(0),
+            sleeping: AtomicU32::new(0),
+            shutdown: AtomicBool::new(false),
+        });
+
+        for slot in 0..workers {
+            let worker_shared = shared.clone();
+            if let Err(err) = worker::spawn(stack_size, move || worker_main(worker_shared, slot)) {
+                // Stops the workers spawned so far.
+                drop(Self {
+                    shared,
+                    workers: slot,
+                });
+                return Err(err);
+            }
+        }
+        Ok(Self { shared, workers })
+    }
+
+    /// Creates a pool with a worker per logical core but one, that's left for the calling thread,
+    /// according to `navigator.hardwareConcurrency`.
+    pub fn with_hardware_concurrency() -> Result<Self, WasmWorkerSpawnError> {
+        let workers = (hardware_concurrency() - 1).max(1) as usize;
+        Self::new(workers, DEFAULT_STACK_SIZE)
+    }
+
+    /// Returns the number of workers of the pool, without the calling thread.
+    pub fn workers(&self) -> usize {
+        self.workers
+    }
+
+    /// Calls `func` on each index of `range`, on the pool's workers and the calling thread, and returns once all the calls returned.
+    ///
+    /// # Arguments
+    /// * `range` - The indexes to call `func` on.
+    /// * `chunk` - The number of consecutive indexes run as a single task, at least 1.
+    ///   Bigger chunks cost less scheduling, smaller ones balance the load better.
+    /// * `func` - The function called on each index.
+    pub fn parallel_for<F>(&self, range: Range<usize>, chunk: usize, func: F)
+    where
+        F: Fn(usize) + Sync,
+    {
+        if range.is_empty() {
+            return;
+        }
+
+        unsafe fn run<F: Fn(usize)>(data: *const (), start: usize, end: usize) {
+            let func = &*(data as *const F);
+            (start..end).for_each(func);
+        }
+
+        let job = Job {
+            run: run::<F>,
+            data: &func as *const F as *const (),
+            chunk: chunk.max(1),
+            remaining: AtomicUsize::new(range.len()),
+        };
+        let entered = Entered::new(&self.shared);
+        unsafe {
+            self.shared.execute(
+                entered.slot,
+                Task {
+                    job: &job,
+                    start: range.start,
+                    end: range.end,
+                },
+            )
+        };
+        self.shared.help_until_done(entered.slot, &job);
+    }
+
+    /// Runs `a` on the calling thread and `b` potentially on a worker, and returns both their results once both returned.
+    pub fn join<A, B, RA, RB>(&self, a: A, b: B) -> (RA, RB)
+    where
+        A: FnOnce() -> RA,
+        B: FnOnce() -> RB + Send,
+        RB: Send,
+    {
+        struct JoinB<B, RB> {
+            func: UnsafeCell<Option<B>>,
+            result: UnsafeCell<Option<RB>>,
+        }
+
+        // The job has a single item, so this is run exactly once.
+        unsafe fn run<B: FnOnce() -> RB, RB>(data: *const (), _: usize, _: usize) {
+            let join = &*(data as *const JoinB<B, RB>);
+            let func = (*join.func.get()).take().unwrap();
+            *join.result.get() = Some(func());
+        }
+
+        let join = JoinB {
+            func: UnsafeCell::new(Some(b)),
+            result: UnsafeCell::new(None),
+        };
+        let job = Job {
+            run: run::<B, RB>,
+            data: &join as *const JoinB<B, RB> as *const (),
+            chunk: 1,
+            remaining: AtomicUsize::new(1),
+        };
+        let entered = Entered::new(&self.shared);
+        self.shared.push(
+            entered.slot,
+            Task {
+                job: &job,
+                start: 0,
+                end: 1,
+            },
+        );
+
+        let result_a = a();
+        self.shared.help_until_done(entered.slot, &job);
+        (result_a, join.result.into_inner().unwrap())
+    }
+}
+
+impl Drop for ParallelPool {
+    fn drop(&mut self) {
+        self.shared.shutdown.store(true, Ordering::SeqCst);
+        self.shared.wake(self.workers);
+    }
+}
+
+fn worker_main(shared: Arc<Shared>, slot: usize) {
+    CURRENT.with(|current| current.set(Some((&*shared, slot))));
+    while !shared.shutdown.load(Ordering::SeqCst) {
+        if let Some(task) = shared.find_task(slot) {
+            unsafe { shared.execute(slot, task) };
+            continue;
+        }
+
+        shared.sleeping.fetch_add(1, Ordering::SeqCst);
+        // Looked for again after raising `sleeping`: a task pushed before that didn't wake anyone up.
+        match shared.find_task(slot) {
+            Some(task) => {
+                shared.sleeping.fetch_sub(1, Ordering::SeqCst);
+                unsafe { shared.execute(slot, task) };
+            }
+            None => {
+                if !shared.shutdown.load(Ordering::SeqCst) {
+                    unsafe {
+                        wasm_worker::emscripten_semaphore_waitinf_acquire(shared.wakeups.get(), 1)
+                    };
+                }
+                shared.sleeping.fetch_sub(1, Ordering::SeqCst);
+            }
+        }
+    }
+
+    CURRENT.with(|current| current.set(None));
+    drop(shared);
+    // A worker can't terminate itself, so it asks its parent to.
+    let id = worker::self_id() as c_int;
+    post_to_parent(move || WasmWorker::from_id(id).terminate());
+}
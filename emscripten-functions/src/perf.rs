@@ -0,0 +1,122 @@
+//! [User Timing] marks and measures, that show up in the browser devtools' performance panel next to its own work (GC, layout, painting).
+//!
+//! The names are registered once with [`PerfName::new`], and the entries then refer to them by id, without passing strings to JS.
+//!
+//! The entries are only emitted when this crate's `perf` feature is enabled. Without it, the functions do nothing and get optimized out,
+//! so they can stay in release builds.
+//!
+//! [User Timing]: https://developer.mozilla.org/en-US/docs/Web/API/Performance_API/User_timing
+
+#[cfg(feature = "perf")]
+use std::os::raw::{c_char, c_int};
+
+#[cfg(feature = "perf")]
+use crate::c_str::with_c_str;
+
+#[cfg(feature = "perf")]
+extern "C" {
+    fn perf_register_name(name: *const c_char) -> c_int;
+    fn perf_mark(id: c_int);
+    fn perf_measure(id: c_int, start: f64);
+    fn perf_measure_marks(id: c_int, start_mark: c_int, end_mark: c_int);
+    fn perf_now() -> f64;
+}
+
+/// The name of User Timing entries, registered in the calling thread's JS side.
+/// It can only be used on the thread that created it.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct PerfName {
+    #[cfg(feature = "perf")]
+    id: c_int,
+    _not_send: std::marker::PhantomData<*const ()>,
+}
+
+impl PerfName {
+    /// Registers the given name. It's meant to be done once per name, e.g. when creating a subsystem, and not for each entry.
+    ///
+    /// # Examples
+    /// ```rust
+    /// thread_local! {
+    ///     static PHYSICS: PerfName = PerfName::new("physics");
+    /// }
+    /// ```
+    #[allow(unused_variables)]
+    pub fn new(name: &str) -> Self {
+        Self {
+            #[cfg(feature = "perf")]
+            id: with_c_str(name, |name| unsafe { perf_register_name(name) }),
+            _not_send: std::marker::PhantomData,
+        }
+    }
+
+    /// Adds a mark with this name at the current time, using `performance.mark`.
+    #[inline]
+    pub fn mark(&self) {
+        #[cfg(feature = "perf")]
+        unsafe {
+            perf_mark(self.id)
+        };
+    }
+
+    /// Adds a measure with this name between the last marks named `start` and `end`, using `performance.measure`.
+    #[inline]
+    #[allow(unused_variables)]
+    pub fn measure_between(&self, start: &PerfName, end: &PerfName) {
+        #[cfg(feature = "perf")]
+        unsafe {
+            perf_measure_marks(self.id, start.id, end.id)
+        };
+    }
+
+    /// Starts a measure with this name, that lasts until the returned [`PerfSpan`] is dropped.
+    ///
+    /// # Examples
+    /// ```rust
+    /// let physics = PerfName::new("physics");
+    /// let render = PerfName::new("render");
+    ///
+    /// set_main_loop(move || {
+    ///     {
+    ///         let _span = physics.span();
+    ///         step_physics();
+    ///     }
+    ///     let _span = render.span();
+    ///     render_frame();
+    /// }, 0, true);
+    /// ```
+    #[inline]
+    pub fn span(&self) -> PerfSpan {
+        PerfSpan {
+            #[cfg(feature = "perf")]
+            name: *self,
+            #[cfg(feature = "perf")]
+            start: unsafe { perf_now() },
+            _not_send: std::marker::PhantomData,
+        }
+    }
+}
+
+/// A User Timing measure in progress, added when dropped. It's created with [`PerfName::span`].
+#[must_use = "the measure is added when the span is dropped"]
+pub struct PerfSpan {
+    #[cfg(feature = "perf")]
+    name: PerfName,
+    #[cfg(feature = "perf")]
+    start: f64,
+    _not_send: std::marker::PhantomData<*const ()>,
+}
+
+impl Drop for PerfSpan {
+    #[inline]
+    fn drop(&mut self) {
+        #[cfg(feature = "perf")]
+        unsafe {
+            perf_measure(self.name.id, self.start)
+        };
+    }
+}
+
+/// Returns `true` if the entries are emitted, i.e. if the `perf` feature is enabled.
+pub const fn is_enabled() -> bool {
+    cfg!(feature = "perf")
+}
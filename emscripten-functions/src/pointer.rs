@@ -0,0 +1,231 @@
+//! Full-rate pointer input: the samples the browser coalesced into each pointer event, and its predicted ones, in one batch per event.
+//!
+//! Browsers fire at most one `pointermove` event per frame, and the html5 mouse and touch events only carry its latest position,
+//! so a fast stroke of a pen sampled at 240Hz loses three samples out of four. A [`PointerListener`] reads them back with
+//! [`getCoalescedEvents()`], and gives them to rust in one [`PointerBatch`] per event, rather than a wasm call per sample.
+//! The batch also has the positions the browser predicts for the next few milliseconds, from [`getPredictedEvents()`],
+//! to draw ahead of the pointer and hide the input latency.
+//!
+//! The target should have the `touch-action: none` CSS style, so that the browser doesn't pan or zoom on pen and touch strokes instead of sending the events.
+//!
+//! [`getCoalescedEvents()`]: https://developer.mozilla.org/en-US/docs/Web/API/PointerEvent/getCoalescedEvents
+//! [`getPredictedEvents()`]: https://developer.mozilla.org/en-US/docs/Web/API/PointerEvent/getPredictedEvents
+
+use std::{
+    marker::PhantomData,
+    os::raw::{c_char, c_int, c_void},
+};
+
+use crate::c_str::with_c_str;
+
+extern "C" {
+    fn pointer_listen(
+        selector: *const c_char,
+        records: *mut f64,
+        capacity: c_int,
+        callback: unsafe extern "C" fn(arg: *mut c_void, count: c_int, predicted: c_int),
+        arg: *mut c_void,
+    ) -> c_int;
+    fn pointer_unlisten(records: *mut f64);
+}
+
+/// The most samples given in a batch, coalesced and predicted ones together. The oldest coalesced samples of an event are dropped past it.
+pub const MAX_SAMPLES: usize = 128;
+
+// The number of doubles of a record written by the JS code.
+const RECORD_LEN: usize = 12;
+
+/// The type of the pointer event a sample comes from.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum PointerEventKind {
+    /// A `pointerdown` event: a button was pressed, or the pen or finger touched the surface.
+    Down,
+    /// A `pointermove` event.
+    Move,
+    /// A `pointerup` event.
+    Up,
+    /// A `pointercancel` event: the browser stopped sending the events of the pointer, e.g. to scroll instead.
+    Cancel,
+}
+
+/// The device of a pointer.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum PointerType {
+    /// A mouse, or a device the browser couldn't tell.
+    Mouse,
+    /// A pen or stylus.
+    Pen,
+    /// A finger on a touch screen.
+    Touch,
+}
+
+/// A sample of a pointer's state.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct PointerSample {
+    /// The type of the event the sample comes from.
+    pub kind: PointerEventKind,
+    /// The identifier of the pointer, the same for all the events of a pen or finger while it touches the surface.
+    pub pointer_id: i32,
+    /// The device of the pointer.
+    pub pointer_type: PointerType,
+    /// Whether the pointer is the primary one of its type, e.g. the first finger touching the screen.
+    pub is_primary: bool,
+    /// The time of the sample, in milliseconds, on the [`get_now`](crate::emscripten::get_now) clock.
+    pub timestamp: f64,
+    /// The position of the pointer, in CSS pixels, relative to the top-left corner of the target.
+    pub x: f64,
+    /// The position of the pointer, in CSS pixels, relative to the top-left corner of the target.
+    pub y: f64,
+    /// The pressure of the pointer, from 0 to 1; 0.5 while a button is pressed, for devices without pressure.
+    pub pressure: f64,
+    /// The angle between the pen and the surface's normal along the X axis, from -90 to 90 degrees.
+    pub tilt_x: f64,
+    /// The angle between the pen and the surface's normal along the Y axis, from -90 to 90 degrees.
+    pub tilt_y: f64,
+    /// The rotation of the pen around its axis, from 0 to 359 degrees.
+    pub twist: f64,
+    /// The pressed buttons, as a bitmask: 1 for the primary one (or the pen touching), 2 and 4 for the secondary and middle ones.
+    pub buttons: u32,
+}
+
+impl PointerSample {
+    fn from_record(record: &[f64]) -> Self {
+        Self {
+            kind: match record[0] as u32 {
+                0 => PointerEventKind::Down,
+                1 => PointerEventKind::Move,
+                2 => PointerEventKind::Up,
+                _ => PointerEventKind::Cancel,
+            },
+            pointer_id: record[1] as i32,
+            pointer_type: match record[2] as u32 {
+                1 => PointerType::Pen,
+                2 => PointerType::Touch,
+                _ => PointerType::Mouse,
+            },
+            is_primary: record[3] != 0.0,
+            timestamp: record[4],
+            x: record[5],
+            y: record[6],
+            pressure: record[7],
+            tilt_x: record[8],
+            tilt_y: record[9],
+            twist: record[10],
+            buttons: record[11] as u32,
+        }
+    }
+}
+
+/// The samples of a pointer event, given to the function of [`listen_pointer`].
+#[derive(Debug, Clone, Copy)]
+pub struct PointerBatch<'a> {
+    samples: &'a [PointerSample],
+    predicted: &'a [PointerSample],
+}
+
+impl<'a> PointerBatch<'a> {
+    /// Returns the samples coalesced into the event, from the oldest to the newest; the last one is the event's own state.
+    /// Events other than `pointermove` usually have a single sample.
+    pub fn samples(&self) -> &'a [PointerSample] {
+        self.samples
+    }
+
+    /// Returns the positions the browser predicts the pointer will be at next, from the nearest to the furthest.
+    /// It's empty where `getPredictedEvents()` is missing.
+    pub fn predicted(&self) -> &'a [PointerSample] {
+        self.predicted
+    }
+
+    /// Returns the newest sample of the event.
+    pub fn latest(&self) -> &'a PointerSample {
+        // The JS code always writes at least the event itself.
+        self.samples.last().unwrap()
+    }
+}
+
+// The records the JS code writes the samples into, then the function reading them.
+struct ListenerState {
+    records: Box<[f64]>,
+    samples: Vec<PointerSample>,
+    callback: Box<dyn FnMut(&PointerBatch)>,
+}
+
+unsafe extern "C" fn dispatch_trampoline(arg: *mut c_void, count: c_int, predicted: c_int) {
+    let state = &mut *(arg as *mut ListenerState);
+    let count = count as usize;
+    let total = count + predicted as usize;
+
+    state.samples.clear();
+    state.samples.extend(
+        state.records[..total * RECORD_LEN]
+            .chunks_exact(RECORD_LEN)
+            .map(PointerSample::from_record),
+    );
+    let (samples, predicted) = state.samples.split_at(count);
+    (state.callback)(&PointerBatch { samples, predicted });
+}
+
+/// A subscription to the pointer events of a target, created with [`listen_pointer`]. Dropping it removes the event listeners.
+#[must_use = "the listeners are removed when dropped"]
+pub struct PointerListener {
+    state: *mut ListenerState,
+    _not_send: PhantomData<*const ()>,
+}
+
+impl Drop for PointerListener {
+    fn drop(&mut self) {
+        unsafe {
+            pointer_unlisten((*self.state).records.as_mut_ptr());
+            drop(Box::from_raw(self.state));
+        }
+    }
+}
+
+/// Calls the given function with the samples of each `pointerdown`, `pointermove`, `pointerup` and `pointercancel` event of the target.
+/// It must be called from the main browser thread.
+///
+/// Returns `None` if there's no such target.
+///
+/// # Arguments
+/// * `target` - The CSS selector of the target element, or `"window"` or `"document"`.
+/// * `func` - The function called with the batch of samples of each event.
+///
+/// # Examples
+/// ```rust
+/// let listener = listen_pointer("#canvas", move |batch| {
+///     for sample in batch.samples().iter().filter(|sample| sample.pressure > 0.0) {
+///         stroke.push(sample.x, sample.y, sample.pressure);
+///     }
+///     // Drawn ahead of the stroke until the next event, then replaced by the real samples.
+///     preview.set(batch.predicted());
+/// })
+/// .expect("no canvas");
+/// ```
+pub fn listen_pointer<F>(target: &str, func: F) -> Option<PointerListener>
+where
+    F: 'static + FnMut(&PointerBatch),
+{
+    let state = Box::into_raw(Box::new(ListenerState {
+        records: vec![0.0; MAX_SAMPLES * RECORD_LEN].into_boxed_slice(),
+        samples: Vec::with_capacity(MAX_SAMPLES),
+        callback: Box::new(func),
+    }));
+    let listening = with_c_str(target, |target| unsafe {
+        pointer_listen(
+            target,
+            (*state).records.as_mut_ptr(),
+            MAX_SAMPLES as c_int,
+            dispatch_trampoline,
+            state as *mut c_void,
+        )
+    });
+    if listening == 0 {
+        drop(unsafe { Box::from_raw(state) });
+        return None;
+    }
+
+    Some(PointerListener {
+        state,
+        _not_send: PhantomData,
+    })
+}
@@ -0,0 +1,102 @@
+//! Pointer lock with raw mouse input, for first-person camera controls.
+//!
+//! While the pointer is locked, the mouse events carry the movement of the mouse rather than a position. Browsers apply the OS pointer
+//! acceleration to it by default, which makes the camera's turn depend on the speed of the mouse, and not only on its distance.
+//! [`request_pointer_lock`] asks for [`unadjustedMovement`] where the browser supports it, to get the raw movements, and falls back to the adjusted ones elsewhere.
+//!
+//! The movements are best read once per frame, summed, from an [`InputCollector`](crate::input_queue::InputCollector)'s
+//! [`take_mouse_delta`](crate::input_queue::InputCollector::take_mouse_delta).
+//!
+//! [`unadjustedMovement`]: https://developer.mozilla.org/en-US/docs/Web/API/Element/requestPointerLock#unadjustedmovement
+
+use std::{
+    fmt::Display,
+    mem::MaybeUninit,
+    os::raw::{c_char, c_int, c_void},
+};
+
+use emscripten_functions_sys::html5;
+
+use crate::{c_str::with_c_str, html5::Html5Error};
+
+extern "C" {
+    fn pointer_lock_request(
+        selector: *const c_char,
+        unadjusted: c_int,
+        callback: unsafe extern "C" fn(arg: *mut c_void, result: c_int),
+        arg: *mut c_void,
+    );
+}
+
+/// The movements the mouse events report while the pointer is locked.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum PointerLockMode {
+    /// The raw movements of the mouse, without the OS acceleration.
+    Unadjusted,
+    /// The movements with the OS acceleration, where unadjusted ones weren't asked for or aren't supported.
+    Adjusted,
+}
+
+/// The error of a pointer lock request that failed, e.g. because it wasn't made from a user gesture's event handler,
+/// or because the user exited the lock less than a second before.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct PointerLockError;
+
+impl Display for PointerLockError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        write!(f, "The pointer lock was refused")
+    }
+}
+
+type OnLock = Box<dyn FnOnce(Result<PointerLockMode, PointerLockError>)>;
+
+unsafe extern "C" fn locked(arg: *mut c_void, result: c_int) {
+    let callback = Box::from_raw(arg as *mut OnLock);
+    callback(match result {
+        2 => Ok(PointerLockMode::Unadjusted),
+        1 => Ok(PointerLockMode::Adjusted),
+        _ => Err(PointerLockError),
+    });
+}
+
+/// Requests the pointer lock of the target element, and calls `callback` once it's locked, with the mode of its movements, or refused.
+///
+/// Browsers only lock the pointer from the handler of a user gesture, like a click or a key press: it should be called from such an event listener.
+///
+/// # Arguments
+/// * `target` - The CSS selector of the element, or `"#canvas"` for the program's canvas.
+/// * `unadjusted` - Whether to ask for the raw movements of the mouse. Browsers not supporting it lock the pointer with adjusted movements.
+/// * `callback` - The function called with the result of the request.
+///
+/// # Examples
+/// ```rust
+/// let _click = on_click(EventTarget::Selector("#canvas"), false, |_| {
+///     request_pointer_lock("#canvas", true, |result| match result {
+///         Ok(mode) => println!("Locked, with {mode:?} movements"),
+///         Err(err) => println!("{err}"),
+///     });
+///     true
+/// });
+/// ```
+pub fn request_pointer_lock<F>(target: &str, unadjusted: bool, callback: F)
+where
+    F: 'static + FnOnce(Result<PointerLockMode, PointerLockError>),
+{
+    let callback: OnLock = Box::new(callback);
+    let arg = Box::into_raw(Box::new(callback)) as *mut c_void;
+    with_c_str(target, |target| unsafe {
+        pointer_lock_request(target, unadjusted as c_int, locked, arg);
+    });
+}
+
+/// Exits the pointer lock, using the emscripten-defined `emscripten_exit_pointerlock`.
+pub fn exit_pointer_lock() -> Result<(), Html5Error> {
+    Html5Error::check(unsafe { html5::emscripten_exit_pointerlock() })
+}
+
+/// Returns `true` if the pointer is locked, using the emscripten-defined `emscripten_get_pointerlock_status`.
+pub fn is_pointer_locked() -> bool {
+    let mut status = MaybeUninit::uninit();
+    let result = unsafe { html5::emscripten_get_pointerlock_status(status.as_mut_ptr()) };
+    Html5Error::check(result).is_ok() && unsafe { status.assume_init() }.isActive != 0
+}
@@ -0,0 +1,32 @@
+//! Running POSIX socket code unchanged in the browser, by proxying it through a WebSocket bridge server,
+//! over the emscripten `posix_socket.h` header file.
+//!
+//! Once [`connect_bridge`] was called, the `socket`, `connect`, `send`, `recv` etc. calls of the program,
+//! and thus `std::net`, are forwarded to the bridge, which runs the real ones on its host.
+//! emscripten ships such a bridge in its `tools/websocket_to_posix_proxy` folder.
+//!
+//! The program must be built with `-pthread -sPROXY_POSIX_SOCKETS -lwebsocket.js`. The socket calls block waiting for the bridge,
+//! so they must be done from a pthread, e.g. by building with `-sPROXY_TO_PTHREAD` too.
+
+use emscripten_functions_sys::posix_socket;
+
+use crate::{c_str::with_c_str, html5::Html5Error};
+
+/// Connects to the WebSocket-to-POSIX-socket bridge at the given URL, using the emscripten-defined `emscripten_init_websocket_to_posix_socket_bridge`.
+/// It must be called before any socket call.
+///
+/// # Examples
+/// ```rust
+/// connect_bridge("ws://localhost:8080").unwrap();
+///
+/// // Runs through the bridge.
+/// let mut stream = std::net::TcpStream::connect("game.example.com:7777").unwrap();
+/// stream.write_all(b"hello").unwrap();
+/// ```
+pub fn connect_bridge(url: &str) -> Result<(), Html5Error> {
+    with_c_str(url, |url| {
+        Html5Error::check(unsafe {
+            posix_socket::emscripten_init_websocket_to_posix_socket_bridge(url)
+        })
+    })
+}
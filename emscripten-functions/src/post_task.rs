@@ -0,0 +1,146 @@
+//! Prioritized tasks with the browser's [`scheduler.postTask()`], and yielding with [`scheduler.yield()`], integrated with the [`executor`](crate::executor).
+//!
+//! Splitting a long computation into `setTimeout` chunks gives the browser a chance to handle input between them, but gives them no priority:
+//! a chunk can run before a pending click handler. Tasks posted with [`post_task`] run by their [`TaskPriority`], so that `Background`
+//! work yields to input and rendering, and the [`yield_now`] future continues a spawned future after the browser handled its pending work.
+//!
+//! Where the scheduler API is missing (Safari, node), the tasks are posted with `setTimeout()`, ignoring their priority.
+//!
+//! [`scheduler.postTask()`]: https://developer.mozilla.org/en-US/docs/Web/API/Scheduler/postTask
+//! [`scheduler.yield()`]: https://developer.mozilla.org/en-US/docs/Web/API/Scheduler/yield
+
+use std::os::raw::{c_int, c_void};
+
+use crate::executor::{callback_future, CallbackFuture};
+
+extern "C" {
+    fn post_task_post(
+        priority: c_int,
+        delay: f64,
+        callback: unsafe extern "C" fn(arg: *mut c_void, ran: c_int),
+        arg: *mut c_void,
+    ) -> c_int;
+    fn post_task_cancel(id: c_int);
+    fn post_task_set_priority(id: c_int, priority: c_int) -> c_int;
+    fn post_task_yield(
+        callback: unsafe extern "C" fn(arg: *mut c_void, ran: c_int),
+        arg: *mut c_void,
+    );
+    fn post_task_supported() -> c_int;
+}
+
+/// The priority of a posted task: the browser runs the pending tasks of higher priorities first.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq, PartialOrd, Ord, Hash)]
+pub enum TaskPriority {
+    /// Work the user is waiting on, like responding to an input; it can delay rendering.
+    UserBlocking,
+    /// Work the user sees but isn't blocked on, like updating part of the page. It's the browser's default.
+    #[default]
+    UserVisible,
+    /// Work the user doesn't see, like logging or prefetching.
+    Background,
+}
+
+/// Returns `true` if the browser has `scheduler.postTask()`; otherwise, the tasks are posted with `setTimeout()`, without priorities.
+pub fn is_supported() -> bool {
+    unsafe { post_task_supported() != 0 }
+}
+
+type TaskFunc = Box<dyn FnOnce()>;
+
+unsafe extern "C" fn task_trampoline(arg: *mut c_void, ran: c_int) {
+    let func = Box::from_raw(arg as *mut TaskFunc);
+    if ran != 0 {
+        func();
+    }
+}
+
+/// The handle of a task posted with [`post_task`] or [`post_task_delayed`]. Dropping it doesn't cancel the task.
+#[derive(Debug)]
+pub struct PostedTask {
+    id: c_int,
+}
+
+impl PostedTask {
+    /// Cancels the task, if it didn't run yet: its function is dropped without being called.
+    pub fn cancel(self) {
+        unsafe { post_task_cancel(self.id) };
+    }
+
+    /// Changes the priority of the task, if it didn't run yet. Returns `false` if it ran, was cancelled,
+    /// or if the browser can't change it (without `TaskController`).
+    pub fn set_priority(&self, priority: TaskPriority) -> bool {
+        unsafe { post_task_set_priority(self.id, priority as c_int) != 0 }
+    }
+}
+
+/// Runs the given function in a task of the given priority, posted with `scheduler.postTask()`.
+///
+/// # Examples
+/// ```rust
+/// canvas.on_click(|event| {
+///     highlight(event);
+///     // Sending the analytics event doesn't delay the next input.
+///     post_task(TaskPriority::Background, move || send_click_event(event));
+/// });
+/// ```
+pub fn post_task<F>(priority: TaskPriority, func: F) -> PostedTask
+where
+    F: 'static + FnOnce(),
+{
+    post_task_delayed(priority, 0.0, func)
+}
+
+/// Runs the given function in a task of the given priority, posted after the given delay in milliseconds.
+pub fn post_task_delayed<F>(priority: TaskPriority, delay: f64, func: F) -> PostedTask
+where
+    F: 'static + FnOnce(),
+{
+    let func: TaskFunc = Box::new(func);
+    let arg = Box::into_raw(Box::new(func)) as *mut c_void;
+    let id = unsafe { post_task_post(priority as c_int, delay, task_trampoline, arg) };
+    PostedTask { id }
+}
+
+/// Returns a future completing in a task of the given priority: awaiting it continues the future there,
+/// e.g. to do the rest of its work in the background.
+///
+/// # Examples
+/// ```rust
+/// spawn_local(async {
+///     let data = wget("level.bin").await.unwrap();
+///     post_task_future(TaskPriority::Background).await;
+///     build_navigation_mesh(&data);
+/// });
+/// ```
+pub fn post_task_future(priority: TaskPriority) -> CallbackFuture<()> {
+    callback_future(|callback| {
+        post_task(priority, move || callback(()));
+    })
+}
+
+unsafe extern "C" fn yield_trampoline(arg: *mut c_void, _ran: c_int) {
+    let callback = Box::from_raw(arg as *mut Box<dyn FnOnce(())>);
+    callback(());
+}
+
+/// Returns a future completing once the browser handled its pending work, with `scheduler.yield()`,
+/// which then continues at the priority of the task it was awaited in, ahead of the other tasks of that priority.
+/// Without it, it continues in a `"user-visible"` task, or after a `setTimeout()`.
+///
+/// # Examples
+/// ```rust
+/// spawn_local(async move {
+///     for chunk in rows.chunks(256) {
+///         index(chunk);
+///         // Lets the browser handle the input received meanwhile.
+///         yield_now().await;
+///     }
+/// });
+/// ```
+pub fn yield_now() -> CallbackFuture<()> {
+    callback_future(|callback| {
+        let arg = Box::into_raw(Box::new(callback)) as *mut c_void;
+        unsafe { post_task_yield(yield_trampoline, arg) };
+    })
+}
@@ -0,0 +1,220 @@
+//! A power-saving policy, that slows the program down while the device runs on a low battery.
+//!
+//! A [`PowerPolicy`] listens to the battery's state, and once the device is discharging below a threshold level, it switches to
+//! saving power: it lowers the main loop's rate with [`set_main_loop_timing`], lowers the largest scale of a
+//! [`ResolutionScaler`], and pauses the [idle tasks](crate::idle), like prefetching. It switches back once the device charges,
+//! or the level gets above the threshold.
+//!
+//! The battery's state comes from the Battery Status API's `navigator.getBattery()`, missing in Firefox and Safari:
+//! there, the policy never saves power. Emscripten's `emscripten_get_battery_status` draws on a former version of the API,
+//! which the browsers dropped.
+//!
+//! [`set_main_loop_timing`]: crate::emscripten::set_main_loop_timing
+
+use std::{
+    cell::RefCell,
+    marker::PhantomData,
+    os::raw::{c_int, c_void},
+    rc::Rc,
+};
+
+use crate::{
+    emscripten::{set_main_loop_timing, MainLoopTiming},
+    idle::set_idle_paused,
+    resolution_scaler::ResolutionScaler,
+};
+
+extern "C" {
+    fn battery_listen(
+        callback: unsafe extern "C" fn(arg: *mut c_void, charging: c_int, level: f64),
+        arg: *mut c_void,
+    ) -> c_int;
+    fn battery_unlisten(id: c_int);
+}
+
+/// The state of the battery.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct BatteryStatus {
+    /// Whether the battery is charging.
+    pub charging: bool,
+    /// The level of the battery, from 0 to 1.
+    pub level: f64,
+}
+
+/// The parameters of a [`PowerPolicy`].
+#[derive(Debug, Clone, PartialEq)]
+pub struct PowerPolicyConfig {
+    /// The battery level, from 0 to 1, below which the policy saves power while the device is discharging.
+    pub level_threshold: f64,
+    /// The main loop timing while saving power, or `None` to keep it.
+    pub saving_timing: Option<MainLoopTiming>,
+    /// The main loop timing restored when the policy stops saving power.
+    pub normal_timing: MainLoopTiming,
+    /// The largest scale of the resolution scaler while saving power.
+    pub saving_max_scale: f64,
+    /// Whether to pause the idle tasks while saving power.
+    pub pause_idle: bool,
+}
+
+impl Default for PowerPolicyConfig {
+    fn default() -> Self {
+        Self {
+            level_threshold: 0.2,
+            saving_timing: Some(MainLoopTiming::RequestAnimationFrame(2)),
+            normal_timing: MainLoopTiming::RequestAnimationFrame(1),
+            saving_max_scale: 0.75,
+            pause_idle: true,
+        }
+    }
+}
+
+struct PolicyState {
+    config: PowerPolicyConfig,
+    battery: Option<BatteryStatus>,
+    saving: bool,
+    // The scaler, and its largest scale out of the saving mode.
+    scaler: Option<(Rc<RefCell<ResolutionScaler>>, f64)>,
+    onchange: Option<Box<dyn FnMut(bool)>>,
+}
+
+impl PolicyState {
+    fn apply(&mut self) {
+        let config = &self.config;
+        if let Some(timing) = &config.saving_timing {
+            set_main_loop_timing(if self.saving {
+                timing
+            } else {
+                &config.normal_timing
+            });
+        }
+        if config.pause_idle {
+            set_idle_paused(self.saving);
+        }
+        if let Some((scaler, max_scale)) = &self.scaler {
+            let mut scaler = scaler.borrow_mut();
+            let max_scale = if self.saving {
+                config.saving_max_scale.min(*max_scale)
+            } else {
+                *max_scale
+            };
+            let min_scale = scaler.scale_bounds().0.min(max_scale);
+            let _ = scaler.set_scale_bounds(min_scale, max_scale);
+        }
+    }
+}
+
+unsafe extern "C" fn battery_changed(arg: *mut c_void, charging: c_int, level: f64) {
+    let state = &*(arg as *const RefCell<PolicyState>);
+    let onchange = {
+        let mut state = state.borrow_mut();
+        let status = BatteryStatus {
+            charging: charging != 0,
+            level,
+        };
+        state.battery = Some(status);
+        let saving = !status.charging && status.level < state.config.level_threshold;
+        if saving == state.saving {
+            return;
+        }
+        state.saving = saving;
+        state.apply();
+        state.onchange.take()
+    };
+
+    // The callback is called outside of the borrow, so that it can use the policy.
+    if let Some(mut onchange) = onchange {
+        let saving = state.borrow().saving;
+        onchange(saving);
+        state.borrow_mut().onchange.get_or_insert(onchange);
+    }
+}
+
+/// Saves power while the device runs on a low battery. See the [module documentation](self).
+///
+/// Dropping it stops listening to the battery, and leaves the settings as they are.
+///
+/// # Examples
+/// ```rust
+/// let scaler = Rc::new(RefCell::new(
+///     ResolutionScaler::new("#canvas", ResolutionScaleConfig::default()).unwrap(),
+/// ));
+/// let mut policy = PowerPolicy::new(PowerPolicyConfig::default());
+/// policy.manage_scaler(scaler.clone());
+/// policy.on_change(|saving| println!("Saving power: {saving}"));
+/// ```
+#[must_use = "the policy stops listening to the battery when dropped"]
+pub struct PowerPolicy {
+    state: *mut RefCell<PolicyState>,
+    // The battery listener, or 0 where the API is missing.
+    listener: c_int,
+    _not_send: PhantomData<*const ()>,
+}
+
+impl PowerPolicy {
+    /// Starts listening to the battery. The first state comes asynchronously, and the policy doesn't save power until then.
+    pub fn new(config: PowerPolicyConfig) -> Self {
+        let state = Box::into_raw(Box::new(RefCell::new(PolicyState {
+            config,
+            battery: None,
+            saving: false,
+            scaler: None,
+            onchange: None,
+        })));
+        let listener = unsafe { battery_listen(battery_changed, state as *mut c_void) };
+        Self {
+            state,
+            listener,
+            _not_send: PhantomData,
+        }
+    }
+
+    fn state(&self) -> &RefCell<PolicyState> {
+        unsafe { &*self.state }
+    }
+
+    /// Returns `true` where the browser supports the Battery Status API, so that the policy can save power.
+    pub fn is_supported(&self) -> bool {
+        self.listener != 0
+    }
+
+    /// Returns the last state of the battery, or `None` before the first one, or where the API is missing.
+    pub fn battery(&self) -> Option<BatteryStatus> {
+        self.state().borrow().battery
+    }
+
+    /// Returns `true` if the policy is saving power.
+    pub fn is_saving(&self) -> bool {
+        self.state().borrow().saving
+    }
+
+    /// Makes the policy lower the largest scale of the scaler while saving power, to the `saving_max_scale` of its config.
+    /// The scaler's current largest scale is restored when it stops saving power.
+    pub fn manage_scaler(&mut self, scaler: Rc<RefCell<ResolutionScaler>>) {
+        let max_scale = scaler.borrow().scale_bounds().1;
+        let mut state = self.state().borrow_mut();
+        state.scaler = Some((scaler, max_scale));
+        if state.saving {
+            state.apply();
+        }
+    }
+
+    /// Sets the function called with `true` when the policy starts saving power, and with `false` when it stops,
+    /// e.g. to lower the quality settings of the renderer.
+    pub fn on_change<F>(&mut self, onchange: F)
+    where
+        F: 'static + FnMut(bool),
+    {
+        self.state().borrow_mut().onchange = Some(Box::new(onchange));
+    }
+}
+
+impl Drop for PowerPolicy {
+    fn drop(&mut self) {
+        unsafe {
+            if self.listener != 0 {
+                battery_unlisten(self.listener);
+            }
+            drop(Box::from_raw(self.state));
+        }
+    }
+}
@@ -0,0 +1,427 @@
+//! Predictive prefetching of assets, learned from the order in which the program requests them.
+//!
+//! A game loads the assets of each level in about the same order on every run. A [`Prefetcher`] records which asset
+//! is requested after which, in a model stored in IndexedDB across sessions, and when an asset is requested, prefetches
+//! the ones that most often came next, with [`AssetLoader::prefetch`], from the browser's idle periods.
+//! The prefetched data is kept in memory until [`Prefetcher::get`] requests it.
+//!
+//! The model counts the successors of each asset: those requested after it in at least [`DEFAULT_MIN_PROBABILITY`]
+//! of the cases are predicted. The counts are halved as they grow, so that the model follows changes of the access order.
+
+use std::{
+    cell::RefCell,
+    collections::{HashMap, HashSet, VecDeque},
+    rc::Rc,
+};
+
+use crate::{
+    asset_loader::AssetLoader, idb::Store, idle::schedule_idle, malloc_buffer::MallocBuffer,
+    scheduler::Step, wget::WgetError,
+};
+
+// The key of the model in the store.
+const MODEL_KEY: &str = "prefetch-model";
+
+/// The default fraction of the requests of an asset after which another one must have been requested to be prefetched.
+pub const DEFAULT_MIN_PROBABILITY: f64 = 0.25;
+
+/// The default number of assets prefetched after each request.
+pub const DEFAULT_MAX_PREFETCHES: usize = 2;
+
+/// The default number of bytes of prefetched data kept in memory.
+pub const DEFAULT_PREFETCH_BUDGET: usize = 64 << 20;
+
+// The number of successors kept per asset; the least frequent one is forgotten beyond it.
+const MAX_SUCCESSORS: usize = 8;
+
+// The count of a successor at which the counts of all the successors of an asset are halved.
+const MAX_COUNT: u32 = 256;
+
+// The time left in an idle period below which no more prefetches are started, in milliseconds.
+const IDLE_MARGIN: f64 = 1.0;
+
+type OnLoad = Box<dyn FnOnce(MallocBuffer)>;
+type OnError = Box<dyn FnOnce(WgetError)>;
+
+// A request waiting for the prefetch of its asset.
+struct Waiter {
+    priority: i32,
+    onload: OnLoad,
+    onerror: OnError,
+}
+
+#[derive(Default)]
+struct Model {
+    // The number of times each asset was requested right after another, by URL.
+    successors: HashMap<String, HashMap<String, u32>>,
+}
+
+impl Model {
+    fn record(&mut self, from: &str, to: &str) {
+        let successors = self.successors.entry(from.to_string()).or_default();
+        let count = successors.entry(to.to_string()).or_insert(0);
+        *count += 1;
+
+        if *count >= MAX_COUNT {
+            successors.retain(|_, count| {
+                *count /= 2;
+                *count > 0
+            });
+        }
+        if successors.len() > MAX_SUCCESSORS {
+            let rarest = successors
+                .iter()
+                .filter(|(url, _)| *url != to)
+                .min_by_key(|(_, count)| **count)
+                .map(|(url, _)| url.clone());
+            if let Some(rarest) = rarest {
+                successors.remove(&rarest);
+            }
+        }
+    }
+
+    // Returns the most frequent successors of the asset, that followed it at least `min_probability` of the time.
+    fn predict(&self, url: &str, min_probability: f64, max: usize) -> Vec<String> {
+        let Some(successors) = self.successors.get(url) else {
+            return Vec::new();
+        };
+        let total: u32 = successors.values().sum();
+        let mut likely: Vec<_> = successors
+            .iter()
+            .filter(|(_, count)| **count as f64 >= total as f64 * min_probability)
+            .collect();
+        likely.sort_by(|a, b| b.1.cmp(a.1).then_with(|| a.0.cmp(b.0)));
+        likely
+            .into_iter()
+            .take(max)
+            .map(|(url, _)| url.clone())
+            .collect()
+    }
+
+    // One line per successor: `url \t successor \t count`.
+    fn serialize(&self) -> String {
+        let mut out = String::new();
+        for (url, successors) in &self.successors {
+            for (successor, count) in successors {
+                out.push_str(&format!("{}\t{}\t{}\n", url, successor, count));
+            }
+        }
+        out
+    }
+
+    fn deserialize(data: &[u8]) -> Self {
+        let mut model = Self::default();
+        for line in String::from_utf8_lossy(data).lines() {
+            let mut fields = line.split('\t');
+            let (Some(url), Some(successor), Some(Ok(count))) =
+                (fields.next(), fields.next(), fields.next().map(str::parse))
+            else {
+                continue;
+            };
+            model
+                .successors
+                .entry(url.to_string())
+                .or_default()
+                .insert(successor.to_string(), count);
+        }
+        model
+    }
+}
+
+struct PrefetcherState {
+    store: Store,
+    loader: AssetLoader,
+    // `None` until the model is loaded from the store.
+    model: Option<Model>,
+    // The requests made while the model was loading, replayed once it's loaded.
+    early: Vec<String>,
+    last: Option<String>,
+    min_probability: f64,
+    max_prefetches: usize,
+    budget: usize,
+    predicted: VecDeque<String>,
+    in_flight: HashSet<String>,
+    prefetched: HashMap<String, MallocBuffer>,
+    prefetched_bytes: usize,
+    waiting: HashMap<String, Waiter>,
+    idle_scheduled: bool,
+    // Whether the model changed since it was last stored.
+    dirty: bool,
+}
+
+/// Requests assets through an [`AssetLoader`], and prefetches those likely to be requested next. See the [module documentation](self).
+///
+/// Cloning a `Prefetcher` gives another handle to the same prefetcher.
+///
+/// # Examples
+/// ```rust
+/// let loader = AssetLoader::new(4);
+/// let prefetcher = Prefetcher::new("prefetch", loader);
+///
+/// // After a few runs, requesting the first asset of a level prefetches the next ones while the menu is shown.
+/// prefetcher.get("levels/2/terrain.bin", 10, load_terrain, |err| println!("{}", err));
+///
+/// // The player took another exit: the prefetched assets of the planned level are of no use anymore.
+/// prefetcher.cancel();
+/// prefetcher.clear_prefetched();
+/// ```
+#[derive(Clone)]
+pub struct Prefetcher {
+    state: Rc<RefCell<PrefetcherState>>,
+}
+
+impl Prefetcher {
+    /// Creates a prefetcher downloading through the given loader, with its model stored in the IndexedDB database of the given name.
+    pub fn new<T>(db_name: T, loader: AssetLoader) -> Self
+    where
+        T: Into<String>,
+    {
+        let prefetcher = Self {
+            state: Rc::new(RefCell::new(PrefetcherState {
+                store: Store::new(db_name),
+                loader,
+                model: None,
+                early: Vec::new(),
+                last: None,
+                min_probability: DEFAULT_MIN_PROBABILITY,
+                max_prefetches: DEFAULT_MAX_PREFETCHES,
+                budget: DEFAULT_PREFETCH_BUDGET,
+                predicted: VecDeque::new(),
+                in_flight: HashSet::new(),
+                prefetched: HashMap::new(),
+                prefetched_bytes: 0,
+                waiting: HashMap::new(),
+                idle_scheduled: false,
+                dirty: false,
+            })),
+        };
+
+        let loading = prefetcher.clone();
+        let store = prefetcher.state.borrow().store.clone();
+        store.load(MODEL_KEY, move |result| {
+            let model = result
+                .map(|data| Model::deserialize(&data))
+                .unwrap_or_default();
+            let early = {
+                let mut state = loading.state.borrow_mut();
+                state.model = Some(model);
+                std::mem::take(&mut state.early)
+            };
+            for url in early {
+                loading.record(url);
+            }
+        });
+
+        prefetcher
+    }
+
+    /// Sets the fraction of the requests of an asset after which another one must have been requested to be prefetched,
+    /// [`DEFAULT_MIN_PROBABILITY`] by default.
+    pub fn set_min_probability(&self, min_probability: f64) {
+        self.state.borrow_mut().min_probability = min_probability;
+    }
+
+    /// Sets the number of assets prefetched after each request, [`DEFAULT_MAX_PREFETCHES`] by default.
+    pub fn set_max_prefetches(&self, max_prefetches: usize) {
+        self.state.borrow_mut().max_prefetches = max_prefetches;
+    }
+
+    /// Sets the number of bytes of prefetched data kept in memory, [`DEFAULT_PREFETCH_BUDGET`] by default.
+    /// No more prefetches are started beyond it.
+    pub fn set_budget(&self, budget: usize) {
+        self.state.borrow_mut().budget = budget;
+    }
+
+    /// Requests an asset: it's given from the prefetched data if it was prefetched, and downloaded by the loader otherwise.
+    /// The request is recorded, and the assets likely to come next are prefetched.
+    ///
+    /// # Arguments
+    /// * `url` - The URL of the asset.
+    /// * `priority` - The priority of its download, as with [`AssetLoader::add`].
+    /// * `onload` - The function called with the asset's data.
+    /// * `onerror` - The function called if its download fails.
+    pub fn get<T, L, E>(&self, url: T, priority: i32, onload: L, onerror: E)
+    where
+        T: Into<String>,
+        L: 'static + FnOnce(MallocBuffer),
+        E: 'static + FnOnce(WgetError),
+    {
+        let url = url.into();
+        self.record(url.clone());
+
+        let (prefetched, loader) = {
+            let mut state = self.state.borrow_mut();
+            let prefetched = state.prefetched.remove(&url);
+            if let Some(data) = &prefetched {
+                state.prefetched_bytes -= data.len();
+            } else if state.in_flight.contains(&url) && !state.waiting.contains_key(&url) {
+                state.waiting.insert(
+                    url,
+                    Waiter {
+                        priority,
+                        onload: Box::new(onload),
+                        onerror: Box::new(onerror),
+                    },
+                );
+                return;
+            }
+            (prefetched, state.loader.clone())
+        };
+
+        match prefetched {
+            Some(data) => onload(data),
+            None => loader.add(url, priority, onload, onerror),
+        }
+    }
+
+    /// Records a request of an asset loaded by other means, and prefetches the assets likely to come next.
+    pub fn record<T>(&self, url: T)
+    where
+        T: Into<String>,
+    {
+        let url = url.into();
+        {
+            let mut state = self.state.borrow_mut();
+            let state = &mut *state;
+            let Some(model) = &mut state.model else {
+                state.early.push(url);
+                return;
+            };
+
+            if let Some(last) = &state.last {
+                if *last != url {
+                    model.record(last, &url);
+                    state.dirty = true;
+                }
+            }
+            let predicted = model.predict(&url, state.min_probability, state.max_prefetches);
+            state.last = Some(url);
+
+            for url in predicted {
+                if !state.prefetched.contains_key(&url)
+                    && !state.in_flight.contains(&url)
+                    && !state.predicted.contains(&url)
+                {
+                    state.predicted.push_back(url);
+                }
+            }
+        }
+        self.schedule();
+    }
+
+    /// Ends the current sequence of requests, e.g. when going back to the main menu: the next request isn't recorded as following the last one.
+    pub fn reset_sequence(&self) {
+        self.state.borrow_mut().last = None;
+    }
+
+    /// Cancels the predicted prefetches, and aborts those in flight, with [`AssetLoader::cancel_prefetches`].
+    /// The requests waiting for an aborted prefetch are downloaded by the loader instead.
+    pub fn cancel(&self) {
+        let (loader, waiting) = {
+            let mut state = self.state.borrow_mut();
+            state.predicted.clear();
+            state.in_flight.clear();
+            (state.loader.clone(), std::mem::take(&mut state.waiting))
+        };
+        loader.cancel_prefetches();
+        for (url, waiter) in waiting {
+            loader.add(url, waiter.priority, waiter.onload, waiter.onerror);
+        }
+    }
+
+    /// Drops the prefetched data that wasn't requested, e.g. after the player changed their plans.
+    pub fn clear_prefetched(&self) {
+        let mut state = self.state.borrow_mut();
+        state.prefetched.clear();
+        state.prefetched_bytes = 0;
+    }
+
+    /// Returns the number of bytes of prefetched data kept in memory.
+    pub fn prefetched_bytes(&self) -> usize {
+        self.state.borrow().prefetched_bytes
+    }
+
+    // Starts the predicted prefetches, and stores the model if it changed, in the browser's idle periods.
+    fn schedule(&self) {
+        if std::mem::replace(&mut self.state.borrow_mut().idle_scheduled, true) {
+            return;
+        }
+        let prefetcher = self.clone();
+        schedule_idle(move |deadline| {
+            while deadline.did_timeout() || deadline.time_remaining() > IDLE_MARGIN {
+                let next = {
+                    let mut state = prefetcher.state.borrow_mut();
+                    if state.prefetched_bytes >= state.budget {
+                        state.predicted.clear();
+                    }
+                    state.predicted.pop_front()
+                };
+                match next {
+                    Some(url) => prefetcher.start(url),
+                    None => break,
+                }
+                if deadline.did_timeout() {
+                    return Step::Continue;
+                }
+            }
+
+            let mut state = prefetcher.state.borrow_mut();
+            if !state.predicted.is_empty() {
+                return Step::Continue;
+            }
+            if std::mem::take(&mut state.dirty) {
+                let model = state.model.as_ref().unwrap().serialize();
+                state.store.store(MODEL_KEY, model, |_| {});
+            }
+            state.idle_scheduled = false;
+            Step::Done
+        });
+    }
+
+    fn start(&self, url: String) {
+        let loader = {
+            let mut state = self.state.borrow_mut();
+            state.in_flight.insert(url.clone());
+            state.loader.clone()
+        };
+
+        let load_prefetcher = self.clone();
+        let error_prefetcher = self.clone();
+        let load_url = url.clone();
+        let error_url = url.clone();
+        loader.prefetch(
+            url,
+            move |data| load_prefetcher.prefetched(load_url, data),
+            move |_| error_prefetcher.failed(error_url),
+        );
+    }
+
+    fn prefetched(&self, url: String, data: MallocBuffer) {
+        let waiter = {
+            let mut state = self.state.borrow_mut();
+            state.in_flight.remove(&url);
+            let waiter = state.waiting.remove(&url);
+            if waiter.is_none() && state.prefetched_bytes + data.len() <= state.budget {
+                state.prefetched_bytes += data.len();
+                state.prefetched.insert(url, data);
+                return;
+            }
+            waiter
+        };
+        if let Some(waiter) = waiter {
+            (waiter.onload)(data);
+        }
+    }
+
+    // A request waiting for a failed prefetch is downloaded again, and gets the error of that download if it fails too.
+    fn failed(&self, url: String) {
+        let (waiter, loader) = {
+            let mut state = self.state.borrow_mut();
+            state.in_flight.remove(&url);
+            (state.waiting.remove(&url), state.loader.clone())
+        };
+        if let Some(waiter) = waiter {
+            loader.add(url, waiter.priority, waiter.onload, waiter.onerror);
+        }
+    }
+}
@@ -0,0 +1,120 @@
+//! Preload hints for the assets a program is going to download, to be given first thing in `main`.
+//!
+//! Between the start of the wasm instantiation and the first downloads of a program, the runtime initializes, the preload
+//! plugins run and the first fetches are issued one after another, while the network sits idle. [`preload_manifest`] instead
+//! tells the browser about all the needed assets at once, with `<link rel=preload>` and `<link rel=modulepreload>` hints,
+//! or low priority `fetch()`es warming the HTTP cache: the later requests for them are then served from the preloads.
+//!
+//! The hints only help the requests made in a matching mode: the `fetch` ones match the CORS requests of `fetch()` and of
+//! the [`wget`](crate::wget) and [`fetch`](crate::fetch) modules, e.g. the browser wouldn't reuse an `image` preload for them.
+
+use std::os::raw::{c_char, c_int};
+
+use crate::{c_str::with_c_str, wget::FetchPriority};
+
+extern "C" {
+    fn preload_hint(url: *const c_char, kind: c_int, priority: c_int) -> c_int;
+}
+
+/// How an asset is preloaded, by [`preload`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum PreloadKind {
+    /// A `<link rel=preload as=fetch>`, for the data downloaded with `fetch()` or `XMLHttpRequest`.
+    Fetch,
+    /// A `<link rel=preload as=image>`.
+    Image,
+    /// A `<link rel=preload as=font>`.
+    Font,
+    /// A `<link rel=preload as=style>`, for a stylesheet.
+    Style,
+    /// A `<link rel=preload as=script>`, for a classic script, e.g. one loaded with `load_scripts`.
+    Script,
+    /// A `<link rel=modulepreload>`, for a JS module, which is also parsed ahead of time.
+    Module,
+    /// A `fetch()` read into the HTTP cache, e.g. for an asset only needed later, or from a worker, where there's no document for the links.
+    Warm,
+}
+
+impl PreloadKind {
+    /// Returns the kind of the given manifest name: `fetch`, `image`, `font`, `style`, `script`, `module` or `warm`.
+    pub fn from_name(name: &str) -> Option<Self> {
+        Some(match name {
+            "fetch" => PreloadKind::Fetch,
+            "image" => PreloadKind::Image,
+            "font" => PreloadKind::Font,
+            "style" => PreloadKind::Style,
+            "script" => PreloadKind::Script,
+            "module" => PreloadKind::Module,
+            "warm" => PreloadKind::Warm,
+            _ => return None,
+        })
+    }
+}
+
+/// Hints the browser to download the given URL now. Returns `false` if it was already hinted, or if the hint needs a document
+/// and there's none, e.g. on a worker.
+///
+/// # Arguments
+/// * `url` - The URL of the asset.
+/// * `kind` - How the asset is preloaded. It must match how it's going to be requested.
+/// * `priority` - The `fetchpriority` hint of the download.
+///
+/// # Examples
+/// ```rust
+/// preload("assets/ui.woff2", PreloadKind::Font, FetchPriority::High);
+/// ```
+pub fn preload(url: &str, kind: PreloadKind, priority: FetchPriority) -> bool {
+    with_c_str(url, |url| unsafe {
+        preload_hint(url, kind as c_int, priority as c_int) != 0
+    })
+}
+
+/// Hints the browser to download all the assets of a manifest now, and returns the number of hints given.
+///
+/// The manifest has one asset per line: the name of its [`PreloadKind`], its path, and optionally its priority, `high` or `low`,
+/// separated by whitespace. The empty lines, those starting with `#`, and those with an unknown kind are skipped.
+///
+/// It should be the first thing done in `main`, before the other initialization: the hints only start downloads that don't
+/// wait for the runtime. The manifest can be embedded with `include_str!`, as reading it from a file would wait for the file.
+///
+/// # Arguments
+/// * `base_url` - The URL the paths are relative to, e.g. `assets/`; they're appended to it.
+/// * `manifest` - The manifest text.
+///
+/// # Examples
+/// ```rust
+/// // First thing in `main`.
+/// preload_manifest(
+///     "assets/",
+///     "# The assets of the first level.\n\
+///      fetch levels/1.bin high\n\
+///      image textures/atlas.webp\n\
+///      font ui.woff2 high\n\
+///      warm music/theme.ogg low\n",
+/// );
+/// init_renderer();
+/// ```
+pub fn preload_manifest(base_url: &str, manifest: &str) -> usize {
+    let mut url = String::from(base_url);
+    let mut hinted = 0;
+    for line in manifest.lines() {
+        let mut parts = line.split_whitespace();
+        let (Some(kind), Some(path)) = (parts.next(), parts.next()) else {
+            continue;
+        };
+        let Some(kind) = PreloadKind::from_name(kind) else {
+            continue;
+        };
+        let priority = match parts.next() {
+            Some("high") => FetchPriority::High,
+            Some("low") => FetchPriority::Low,
+            _ => FetchPriority::Auto,
+        };
+        url.truncate(base_url.len());
+        url.push_str(path);
+        if preload(&url, kind, priority) {
+            hinted += 1;
+        }
+    }
+    hinted
+}
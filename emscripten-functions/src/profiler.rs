@@ -0,0 +1,176 @@
+//! A sampling profiler over the emscripten-defined [`emscripten_get_callstack`], that aggregates the sampled call stacks
+//! in the folded format that flamegraph tools read, e.g. to collect profiles from players' browsers.
+//!
+//! JS can't interrupt running code, nor read the stack of another thread: a timer only fires once the thread is idle,
+//! and would only see itself. The samples are therefore taken at sample points instead, calls to [`sample_point`] placed in the hot code,
+//! e.g. in the per-entity update of a game. Each one checks the time, and captures the call stack once per sampling interval.
+//! With points in all the code that takes time, the samples are spread like a timer's would be.
+//!
+//! The call stacks have function names when the program is built with `--profiling-funcs` (or `-g`).
+//!
+//! [`emscripten_get_callstack`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_get_callstack
+
+use std::{
+    cell::{Cell, RefCell},
+    collections::HashMap,
+    fmt::Write,
+    os::raw::{c_char, c_int},
+};
+
+use emscripten_functions_sys::emscripten;
+
+use crate::emscripten::get_now;
+
+/// Returns the JS call stack of the calling thread, wasm functions included, using the emscripten-defined [`emscripten_get_callstack`].
+///
+/// [`emscripten_get_callstack`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_get_callstack
+pub fn callstack() -> String {
+    let flags = (emscripten::EM_LOG_JS_STACK | emscripten::EM_LOG_NO_PATHS) as c_int;
+    let size = unsafe { emscripten::emscripten_get_callstack(flags, std::ptr::null_mut(), 0) };
+    if size <= 0 {
+        return String::new();
+    }
+
+    let mut buffer = vec![0u8; size as usize];
+    let written = unsafe {
+        emscripten::emscripten_get_callstack(flags, buffer.as_mut_ptr() as *mut c_char, size)
+    };
+    buffer.truncate(written.max(0) as usize);
+    String::from_utf8_lossy(&buffer).into_owned()
+}
+
+// Extracts the function name of a stack trace line, in Chrome's `at name (location)` or Firefox's `name@location` format.
+fn frame_name(line: &str) -> Option<&str> {
+    let line = line.trim();
+    if line.is_empty() || line.starts_with("Error") {
+        return None;
+    }
+
+    let name = match line.strip_prefix("at ") {
+        Some(frame) => frame
+            .rsplit_once(" (")
+            .map_or("(anonymous)", |(name, _)| name),
+        None => line.split('@').next().unwrap_or(line),
+    };
+    Some(if name.is_empty() { "(anonymous)" } else { name })
+}
+
+// Converts a call stack, innermost frame first, to a line of the folded format without its count: the frames from the outermost one, separated by `;`.
+// The frames of the sampler itself, up to the last one containing `sampler` (e.g. `sample`, which isn't inlined, unlike `sample_point`),
+// are left out when they have names.
+pub(crate) fn fold(callstack: &str, sampler: &str) -> String {
+    let frames: Vec<&str> = callstack.lines().filter_map(frame_name).collect();
+    let skipped = frames
+        .iter()
+        .rposition(|frame| frame.contains(sampler))
+        .map_or(0, |index| index + 1);
+
+    let mut folded = String::new();
+    for frame in frames[skipped..].iter().rev() {
+        if !folded.is_empty() {
+            folded.push(';');
+        }
+        folded.extend(frame.chars().map(|c| if c == ';' { ':' } else { c }));
+    }
+    folded
+}
+
+struct Profiler {
+    interval: f64,
+    stacks: HashMap<String, u64>,
+    samples: u64,
+}
+
+thread_local! {
+    static PROFILER: RefCell<Option<Profiler>> = const { RefCell::new(None) };
+    // The time of the next sample; infinite when the profiler isn't running, so that sample points only compare it.
+    static NEXT_SAMPLE: Cell<f64> = const { Cell::new(f64::INFINITY) };
+}
+
+/// Starts sampling the calling thread's call stack at its sample points, at most once every `interval_ms` milliseconds.
+/// The samples taken since the previous start are kept.
+///
+/// # Examples
+/// ```rust
+/// start(10.0);
+///
+/// set_main_loop(|| {
+///     for entity in &mut entities {
+///         sample_point();
+///         entity.update();
+///     }
+/// }, 0, true);
+///
+/// // Later, e.g. when the session ends.
+/// upload("/profiles", &take_folded());
+/// ```
+pub fn start(interval_ms: f64) {
+    PROFILER.with(|profiler| {
+        let mut profiler = profiler.borrow_mut();
+        let profiler = profiler.get_or_insert_with(|| Profiler {
+            interval: interval_ms,
+            stacks: HashMap::new(),
+            samples: 0,
+        });
+        profiler.interval = interval_ms;
+    });
+    NEXT_SAMPLE.with(|next| next.set(get_now() + interval_ms));
+}
+
+/// Stops sampling. The samples are kept until taken with [`take_folded`].
+pub fn stop() {
+    NEXT_SAMPLE.with(|next| next.set(f64::INFINITY));
+}
+
+/// Captures the call stack if the profiler is running and the sampling interval passed since the last sample.
+/// Otherwise it only compares the time, so it can be called often.
+#[inline]
+pub fn sample_point() {
+    let now = get_now();
+    if now >= NEXT_SAMPLE.with(Cell::get) {
+        sample(now);
+    }
+}
+
+#[inline(never)]
+fn sample(now: f64) {
+    let folded = fold(&callstack(), "profiler::sample");
+    PROFILER.with(|profiler| {
+        if let Some(profiler) = &mut *profiler.borrow_mut() {
+            *profiler.stacks.entry(folded).or_insert(0) += 1;
+            profiler.samples += 1;
+            NEXT_SAMPLE.with(|next| next.set(now + profiler.interval));
+        }
+    });
+}
+
+/// Returns the number of samples taken, and not taken yet with [`take_folded`].
+pub fn sample_count() -> u64 {
+    PROFILER.with(|profiler| {
+        profiler
+            .borrow()
+            .as_ref()
+            .map_or(0, |profiler| profiler.samples)
+    })
+}
+
+/// Returns the samples taken in the folded stack format, one line per distinct call stack with its number of samples,
+/// like `main;update;physics_step 42`, and clears them.
+/// It can be read by e.g. `flamegraph.pl`, `inferno-flamegraph` or speedscope.
+pub fn take_folded() -> String {
+    let stacks = PROFILER.with(|profiler| match &mut *profiler.borrow_mut() {
+        Some(profiler) => {
+            profiler.samples = 0;
+            std::mem::take(&mut profiler.stacks)
+        }
+        None => HashMap::new(),
+    });
+
+    let mut stacks: Vec<_> = stacks.into_iter().collect();
+    stacks.sort_unstable();
+    let mut folded = String::new();
+    for (stack, count) in stacks {
+        let _ = writeln!(folded, "{} {}", stack, count);
+    }
+    folded
+}
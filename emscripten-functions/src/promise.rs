@@ -0,0 +1,277 @@
+//! Rust-owned handles to emscripten [promises], awaitable as futures, with their combinators.
+//!
+//! The combinators (`all`, `any`, `race`) combine the promises in JS, so only the combined promise's result
+//! crosses into wasm, instead of each intermediate result waking the rust side.
+//!
+//! [promises]: https://emscripten.org/docs/api_reference/promise.h.html
+
+use std::{
+    cell::RefCell,
+    future::Future,
+    os::raw::c_void,
+    pin::Pin,
+    rc::Rc,
+    task::{Context, Poll, Waker},
+};
+
+use emscripten_functions_sys::emscripten;
+
+/// What a promise settled with: `Ok` with its fulfillment value, or `Err` with its rejection reason.
+pub type PromiseResult = Result<*mut c_void, *mut c_void>;
+
+struct Settle {
+    result: Option<PromiseResult>,
+    waker: Option<Waker>,
+    // The array the values of `all` or the errors of `any` are written to by JS.
+    results: Vec<*mut c_void>,
+}
+
+type SharedSettle = Rc<RefCell<Settle>>;
+
+/// An owned emscripten promise. It's destroyed on drop; the JS promise still settles, but its result is discarded.
+///
+/// Awaiting it gives its [`PromiseResult`].
+///
+/// # Examples
+/// ```rust
+/// let loads: Vec<EmPromise> = urls.iter().map(|url| start_load(url)).collect();
+/// let all = EmPromise::all(&loads);
+/// drop(loads);
+///
+/// spawn_local(async move {
+///     if (&mut all).await.is_ok() {
+///         println!("Loaded {} files", all.results().len());
+///     }
+/// });
+/// ```
+pub struct EmPromise {
+    handle: emscripten::em_promise_t,
+    settle: SharedSettle,
+}
+
+unsafe extern "C" fn on_fulfilled(
+    result: *mut *mut c_void,
+    data: *mut c_void,
+    value: *mut c_void,
+) -> emscripten::em_promise_result_t {
+    settle(data, Ok(value));
+    *result = std::ptr::null_mut();
+    emscripten::em_promise_result_t_EM_PROMISE_FULFILL
+}
+
+unsafe extern "C" fn on_rejected(
+    result: *mut *mut c_void,
+    data: *mut c_void,
+    value: *mut c_void,
+) -> emscripten::em_promise_result_t {
+    settle(data, Err(value));
+    *result = std::ptr::null_mut();
+    emscripten::em_promise_result_t_EM_PROMISE_FULFILL
+}
+
+// Exactly one of the callbacks is called, so it frees the shared state's box.
+unsafe fn settle(data: *mut c_void, result: PromiseResult) {
+    let settle = Box::from_raw(data as *mut SharedSettle);
+    let waker = {
+        let mut settle = settle.borrow_mut();
+        settle.result = Some(result);
+        settle.waker.take()
+    };
+    if let Some(waker) = waker {
+        waker.wake();
+    }
+}
+
+impl EmPromise {
+    /// Creates a new pending promise, to settle with [`EmPromise::resolve`] or [`EmPromise::reject`],
+    /// using the emscripten-defined [`emscripten_promise_create`].
+    ///
+    /// [`emscripten_promise_create`]: https://emscripten.org/docs/api_reference/promise.h.html#c.emscripten_promise_create
+    pub fn new() -> Self {
+        unsafe { Self::from_raw(emscripten::emscripten_promise_create()) }
+    }
+
+    /// Takes ownership of the given promise handle, as returned by emscripten's promise functions.
+    ///
+    /// # Safety
+    /// The handle must be valid, and not be destroyed by anything else.
+    pub unsafe fn from_raw(handle: emscripten::em_promise_t) -> Self {
+        Self::with_results(handle, Vec::new())
+    }
+
+    // The settlement is observed right away, so that the `results` array outlives the JS writes to it even if the promise is dropped.
+    unsafe fn with_results(handle: emscripten::em_promise_t, results: Vec<*mut c_void>) -> Self {
+        let settle = Rc::new(RefCell::new(Settle {
+            result: None,
+            waker: None,
+            results,
+        }));
+
+        let data = Box::into_raw(Box::new(settle.clone()));
+        let chained = emscripten::emscripten_promise_then(
+            handle,
+            Some(on_fulfilled),
+            Some(on_rejected),
+            data as *mut c_void,
+        );
+        emscripten::emscripten_promise_destroy(chained);
+
+        Self { handle, settle }
+    }
+
+    /// Returns the raw promise handle, still owned by this `EmPromise`.
+    pub fn as_raw(&self) -> emscripten::em_promise_t {
+        self.handle
+    }
+
+    /// Fulfills the promise with the given value. It does nothing if the promise already settled.
+    ///
+    /// # Safety
+    /// The value is given as is to the code awaiting the promise, which may dereference it: it must be valid for that code.
+    pub unsafe fn resolve(&self, value: *mut c_void) {
+        emscripten::emscripten_promise_resolve(
+            self.handle,
+            emscripten::em_promise_result_t_EM_PROMISE_FULFILL,
+            value,
+        );
+    }
+
+    /// Rejects the promise with the given reason. It does nothing if the promise already settled.
+    ///
+    /// # Safety
+    /// The reason is given as is to the code awaiting the promise, which may dereference it: it must be valid for that code.
+    pub unsafe fn reject(&self, reason: *mut c_void) {
+        emscripten::emscripten_promise_resolve(
+            self.handle,
+            emscripten::em_promise_result_t_EM_PROMISE_REJECT,
+            reason,
+        );
+    }
+
+    /// Makes the promise settle the same way as `other`. `other` can be dropped afterwards.
+    pub fn resolve_with(&self, other: &EmPromise) {
+        unsafe {
+            emscripten::emscripten_promise_resolve(
+                self.handle,
+                emscripten::em_promise_result_t_EM_PROMISE_MATCH,
+                other.handle as *mut c_void,
+            );
+        }
+    }
+
+    /// Returns what the promise settled with, or `None` if it's still pending.
+    pub fn result(&self) -> Option<PromiseResult> {
+        self.settle.borrow().result
+    }
+
+    /// Returns the fulfillment values of the promises combined with [`EmPromise::all`],
+    /// or the rejection reasons of the promises combined with [`EmPromise::any`], once the combined promise settled that way.
+    ///
+    /// It's empty for other promises.
+    pub fn results(&self) -> Vec<*mut c_void> {
+        self.settle.borrow().results.clone()
+    }
+
+    /// Blocks until the promise settles, using the emscripten-defined [`emscripten_promise_await`].
+    ///
+    /// It needs the program to be built with `-sASYNCIFY`.
+    ///
+    /// [`emscripten_promise_await`]: https://emscripten.org/docs/api_reference/promise.h.html#c.emscripten_promise_await
+    pub fn wait(&self) -> PromiseResult {
+        let settled = unsafe { emscripten::emscripten_promise_await(self.handle) };
+        match settled.result {
+            emscripten::em_promise_result_t_EM_PROMISE_FULFILL => Ok(settled.value),
+            _ => Err(settled.value),
+        }
+    }
+
+    fn handles(promises: &[EmPromise]) -> Vec<emscripten::em_promise_t> {
+        promises.iter().map(|promise| promise.handle).collect()
+    }
+
+    /// Returns a promise fulfilled once all the given promises are fulfilled, or rejected as soon as one of them is rejected,
+    /// using the emscripten-defined [`emscripten_promise_all`].
+    ///
+    /// The fulfillment values are then given by [`EmPromise::results`], in the order of `promises`.
+    /// The given promises can be dropped afterwards.
+    ///
+    /// [`emscripten_promise_all`]: https://emscripten.org/docs/api_reference/promise.h.html#c.emscripten_promise_all
+    pub fn all(promises: &[EmPromise]) -> Self {
+        let mut handles = Self::handles(promises);
+        let mut results = vec![std::ptr::null_mut(); promises.len()];
+        unsafe {
+            let handle = emscripten::emscripten_promise_all(
+                handles.as_mut_ptr(),
+                results.as_mut_ptr(),
+                handles.len(),
+            );
+            // Moving the vector keeps its heap buffer, which JS writes to.
+            Self::with_results(handle, results)
+        }
+    }
+
+    /// Returns a promise fulfilled as soon as one of the given promises is fulfilled, or rejected once all of them are rejected,
+    /// using the emscripten-defined [`emscripten_promise_any`].
+    ///
+    /// The rejection reasons are then given by [`EmPromise::results`], in the order of `promises`.
+    /// The given promises can be dropped afterwards.
+    ///
+    /// [`emscripten_promise_any`]: https://emscripten.org/docs/api_reference/promise.h.html#c.emscripten_promise_any
+    pub fn any(promises: &[EmPromise]) -> Self {
+        let mut handles = Self::handles(promises);
+        let mut errors = vec![std::ptr::null_mut(); promises.len()];
+        unsafe {
+            let handle = emscripten::emscripten_promise_any(
+                handles.as_mut_ptr(),
+                errors.as_mut_ptr(),
+                handles.len(),
+            );
+            Self::with_results(handle, errors)
+        }
+    }
+
+    /// Returns a promise that settles the same way as the first of the given promises to settle,
+    /// using the emscripten-defined [`emscripten_promise_race`].
+    ///
+    /// The given promises can be dropped afterwards.
+    ///
+    /// [`emscripten_promise_race`]: https://emscripten.org/docs/api_reference/promise.h.html#c.emscripten_promise_race
+    pub fn race(promises: &[EmPromise]) -> Self {
+        let mut handles = Self::handles(promises);
+        unsafe {
+            Self::from_raw(emscripten::emscripten_promise_race(
+                handles.as_mut_ptr(),
+                handles.len(),
+            ))
+        }
+    }
+}
+
+impl Default for EmPromise {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl Future for EmPromise {
+    type Output = PromiseResult;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<PromiseResult> {
+        let mut settle = self.settle.borrow_mut();
+        match settle.result {
+            Some(result) => Poll::Ready(result),
+            None => {
+                settle.waker = Some(cx.waker().clone());
+                Poll::Pending
+            }
+        }
+    }
+}
+
+impl Drop for EmPromise {
+    fn drop(&mut self) {
+        unsafe {
+            emscripten::emscripten_promise_destroy(self.handle);
+        }
+    }
+}
@@ -0,0 +1,337 @@
+//! Running rust closures on other threads, over the emscripten [`proxying.h`] header file.
+//!
+//! The work is queued for the target thread, which runs it once it returns to its event loop, or when it executes the queue.
+//! Unlike the `MAIN_THREAD_EM_ASM`-based [`run_script_main_thread`](crate::emscripten::run_script_main_thread), no JS gets evaluated:
+//! only a pointer to the boxed closure is passed to the other thread.
+//!
+//! The program must be built with `-pthread`.
+//!
+//! [`proxying.h`]: https://emscripten.org/docs/api_reference/proxying.h.html
+
+use std::{fmt::Display, os::raw::c_void, sync::OnceLock};
+
+use emscripten_functions_sys::{proxying, threading};
+
+extern "C" {
+    fn pthread_self() -> proxying::pthread_t;
+}
+
+/// A thread work can be proxied to, wrapping its `pthread_t`.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct Thread(proxying::pthread_t);
+
+// A `pthread_t` is only an identifier, that any thread can use.
+unsafe impl Send for Thread {}
+unsafe impl Sync for Thread {}
+
+impl Thread {
+    /// Wraps the given `pthread_t`.
+    pub fn from_raw(thread: proxying::pthread_t) -> Self {
+        Self(thread)
+    }
+
+    /// Returns the underlying `pthread_t`.
+    pub fn as_raw(&self) -> proxying::pthread_t {
+        self.0
+    }
+}
+
+/// Returns the main runtime thread, the one that ran `main`, using the emscripten-defined `emscripten_main_runtime_thread_id`.
+pub fn main_runtime_thread() -> Thread {
+    Thread(unsafe { threading::emscripten_main_runtime_thread_id() })
+}
+
+/// Returns the calling thread.
+pub fn current_thread() -> Thread {
+    Thread(unsafe { pthread_self() })
+}
+
+/// The error returned when work couldn't be queued for a thread, e.g. because it exited.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct ProxyError;
+
+impl Display for ProxyError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        write!(f, "Failed to proxy the work to the thread")
+    }
+}
+
+type AsyncCall = Box<dyn FnOnce() + Send>;
+
+unsafe extern "C" fn async_trampoline(arg: *mut c_void) {
+    let func = Box::from_raw(arg as *mut AsyncCall);
+    func();
+}
+
+// A closure run by `proxy_sync`, and its result, living on the stack of the waiting thread.
+struct SyncCall<F, R> {
+    func: Option<F>,
+    result: Option<R>,
+}
+
+unsafe extern "C" fn sync_trampoline<F, R>(arg: *mut c_void)
+where
+    F: FnOnce() -> R,
+{
+    let call = &mut *(arg as *mut SyncCall<F, R>);
+    if let Some(func) = call.func.take() {
+        call.result = Some(func());
+    }
+}
+
+// A closure run by `proxy_callback`, its result, and the closure it's handed to back on the calling thread.
+struct CallbackCall<F, R, C> {
+    func: Option<F>,
+    result: Option<R>,
+    callback: Option<C>,
+}
+
+unsafe extern "C" fn callback_func_trampoline<F, R, C>(arg: *mut c_void)
+where
+    F: FnOnce() -> R,
+{
+    let call = &mut *(arg as *mut CallbackCall<F, R, C>);
+    if let Some(func) = call.func.take() {
+        call.result = Some(func());
+    }
+}
+
+unsafe extern "C" fn callback_trampoline<F, R, C>(arg: *mut c_void)
+where
+    C: FnOnce(R),
+{
+    let mut call = Box::from_raw(arg as *mut CallbackCall<F, R, C>);
+    if let (Some(callback), Some(result)) = (call.callback.take(), call.result.take()) {
+        callback(result);
+    }
+}
+
+unsafe extern "C" fn cancel_trampoline<F, R, C>(arg: *mut c_void) {
+    drop(Box::from_raw(arg as *mut CallbackCall<F, R, C>));
+}
+
+/// A queue of work proxied to other threads, over an emscripten `em_proxying_queue`.
+///
+/// The free functions of this module use a queue shared by the whole program, which is enough unless the work needs to be
+/// run at specific points, with [`execute`](ProxyQueue::execute).
+///
+/// # Examples
+/// ```rust
+/// let queue = ProxyQueue::new();
+/// let title = queue
+///     .proxy_sync(main_runtime_thread(), get_window_title)
+///     .unwrap();
+/// ```
+pub struct ProxyQueue {
+    queue: *mut proxying::em_proxying_queue,
+    owned: bool,
+}
+
+// The emscripten queues are thread-safe.
+unsafe impl Send for ProxyQueue {}
+unsafe impl Sync for ProxyQueue {}
+
+impl ProxyQueue {
+    /// Creates a queue, using the emscripten-defined `em_proxying_queue_create`.
+    pub fn new() -> Self {
+        Self {
+            queue: unsafe { proxying::em_proxying_queue_create() },
+            owned: true,
+        }
+    }
+
+    /// Returns the queue used for the runtime's own work, using the emscripten-defined `emscripten_proxy_get_system_queue`.
+    ///
+    /// Its work may run inside any system function, so the closures queued on it must not block, like signal handlers.
+    pub fn system() -> Self {
+        Self {
+            queue: unsafe { proxying::emscripten_proxy_get_system_queue() },
+            owned: false,
+        }
+    }
+
+    /// Returns the underlying emscripten queue.
+    pub fn as_raw(&self) -> *mut proxying::em_proxying_queue {
+        self.queue
+    }
+
+    /// Runs all the work queued for the calling thread, using the emscripten-defined `emscripten_proxy_execute_queue`.
+    pub fn execute(&self) {
+        unsafe { proxying::emscripten_proxy_execute_queue(self.queue) };
+    }
+
+    /// Queues `func` to run on the given thread, and returns immediately, using the emscripten-defined `emscripten_proxy_async`.
+    ///
+    /// If the thread exits before running it, the closure is leaked.
+    pub fn proxy_async<F>(&self, thread: Thread, func: F) -> Result<(), ProxyError>
+    where
+        F: 'static + Send + FnOnce(),
+    {
+        let func: AsyncCall = Box::new(func);
+        let arg = Box::into_raw(Box::new(func)) as *mut c_void;
+        let result = unsafe {
+            proxying::emscripten_proxy_async(self.queue, thread.0, Some(async_trampoline), arg)
+        };
+        if result == 0 {
+            drop(unsafe { Box::from_raw(arg as *mut AsyncCall) });
+            return Err(ProxyError);
+        }
+        Ok(())
+    }
+
+    /// Runs `func` on the given thread, waits for it to return and gives its result back,
+    /// using the emscripten-defined `emscripten_proxy_sync`.
+    ///
+    /// `func` is called right away when the given thread is the calling one.
+    /// The wait blocks the calling thread, so the target thread mustn't be waiting on it meanwhile.
+    pub fn proxy_sync<F, R>(&self, thread: Thread, func: F) -> Result<R, ProxyError>
+    where
+        F: Send + FnOnce() -> R,
+        R: Send,
+    {
+        if thread == current_thread() {
+            return Ok(func());
+        }
+
+        let mut call = SyncCall {
+            func: Some(func),
+            result: None,
+        };
+        let result = unsafe {
+            proxying::emscripten_proxy_sync(
+                self.queue,
+                thread.0,
+                Some(sync_trampoline::<F, R>),
+                &mut call as *mut SyncCall<F, R> as *mut c_void,
+            )
+        };
+        match call.result {
+            Some(value) if result != 0 => Ok(value),
+            _ => Err(ProxyError),
+        }
+    }
+
+    /// Runs `func` on the given thread, and then `callback` with its result back on the calling thread, once it returns to its event loop,
+    /// using the emscripten-defined `emscripten_proxy_callback`.
+    ///
+    /// If the given thread exits before running `func`, both closures are dropped.
+    pub fn proxy_callback<F, R, C>(
+        &self,
+        thread: Thread,
+        func: F,
+        callback: C,
+    ) -> Result<(), ProxyError>
+    where
+        F: 'static + Send + FnOnce() -> R,
+        R: 'static + Send,
+        C: 'static + Send + FnOnce(R),
+    {
+        let arg = Box::into_raw(Box::new(CallbackCall::<F, R, C> {
+            func: Some(func),
+            result: None,
+            callback: Some(callback),
+        })) as *mut c_void;
+        let result = unsafe {
+            proxying::emscripten_proxy_callback(
+                self.queue,
+                thread.0,
+                Some(callback_func_trampoline::<F, R, C>),
+                Some(callback_trampoline::<F, R, C>),
+                Some(cancel_trampoline::<F, R, C>),
+                arg,
+            )
+        };
+        if result == 0 {
+            unsafe { cancel_trampoline::<F, R, C>(arg) };
+            return Err(ProxyError);
+        }
+        Ok(())
+    }
+}
+
+impl Default for ProxyQueue {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl Drop for ProxyQueue {
+    fn drop(&mut self) {
+        if self.owned {
+            unsafe { proxying::em_proxying_queue_destroy(self.queue) };
+        }
+    }
+}
+
+// The queue of the free functions, created on first use.
+fn shared_queue() -> &'static ProxyQueue {
+    static QUEUE: OnceLock<ProxyQueue> = OnceLock::new();
+    QUEUE.get_or_init(ProxyQueue::new)
+}
+
+/// Queues `func` to run on the given thread, and returns immediately. See [`ProxyQueue::proxy_async`].
+///
+/// # Examples
+/// ```rust
+/// let score = game.score();
+/// proxy_async(main_runtime_thread(), move || {
+///     run_script(format!("document.title = 'Score: {}'", score));
+/// })
+/// .unwrap();
+/// ```
+pub fn proxy_async<F>(thread: Thread, func: F) -> Result<(), ProxyError>
+where
+    F: 'static + Send + FnOnce(),
+{
+    shared_queue().proxy_async(thread, func)
+}
+
+/// Runs `func` on the given thread, waits for it to return and gives its result back. See [`ProxyQueue::proxy_sync`].
+pub fn proxy_sync<F, R>(thread: Thread, func: F) -> Result<R, ProxyError>
+where
+    F: Send + FnOnce() -> R,
+    R: Send,
+{
+    shared_queue().proxy_sync(thread, func)
+}
+
+/// Runs `func` on the given thread, and then `callback` with its result on the calling thread. See [`ProxyQueue::proxy_callback`].
+pub fn proxy_callback<F, R, C>(thread: Thread, func: F, callback: C) -> Result<(), ProxyError>
+where
+    F: 'static + Send + FnOnce() -> R,
+    R: 'static + Send,
+    C: 'static + Send + FnOnce(R),
+{
+    shared_queue().proxy_callback(thread, func, callback)
+}
+
+/// Runs `func` on the main runtime thread, e.g. to use the DOM or the [`html5`](crate::html5) functions from a pthread,
+/// and returns its result once it returned. It's called right away on the main runtime thread.
+///
+/// The calling thread blocks meanwhile, so this mustn't be called while the main thread waits on it, e.g. joining it.
+///
+/// # Examples
+/// ```rust
+/// std::thread::spawn(|| {
+///     let (width, height) = run_on_main_thread(|| {
+///         let size = get_screen_size();
+///         (size.width, size.height)
+///     });
+///     render_at(width, height);
+/// });
+/// ```
+pub fn run_on_main_thread<F, R>(func: F) -> R
+where
+    F: Send + FnOnce() -> R,
+    R: Send,
+{
+    proxy_sync(main_runtime_thread(), func).expect("Failed to proxy to the main runtime thread")
+}
+
+/// Queues `func` to run on the main runtime thread once it returns to its event loop, and returns immediately.
+pub fn run_on_main_thread_async<F>(func: F)
+where
+    F: 'static + Send + FnOnce(),
+{
+    proxy_async(main_runtime_thread(), func).expect("Failed to proxy to the main runtime thread");
+}
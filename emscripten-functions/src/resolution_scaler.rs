@@ -0,0 +1,210 @@
+//! A dynamic resolution controller, that shrinks a canvas' drawing buffer when the frames take too long, and grows it back when they're fast again.
+//!
+//! On high-DPR screens, rendering at the full device-pixel size of the canvas makes a fill-rate bound renderer drop frames.
+//! The [`ResolutionScaler`] pins the canvas' CSS size, so that it keeps its layout, and scales its drawing buffer between configurable
+//! fractions of the device-pixel size, watching the frame times like the
+//! [`AdaptiveTimingController`](crate::adaptive_timing::AdaptiveTimingController) does: it only steps after several consecutive frames
+//! over or well under the target frame time, to keep from oscillating.
+
+use crate::{
+    display::device_pixel_ratio,
+    html5::{
+        get_element_css_size, set_canvas_element_size, set_element_css_size, Html5Error, Target,
+    },
+    main_loop_stats::MainLoopStats,
+};
+
+/// The parameters of a [`ResolutionScaler`].
+#[derive(Debug, Clone, PartialEq)]
+pub struct ResolutionScaleConfig {
+    /// The frame time to hold, in milliseconds; `1000.0 / 60.0` for 60fps.
+    pub target_frame_time: f64,
+    /// The smallest scale of the drawing buffer, as a fraction of the canvas' device-pixel size.
+    pub min_scale: f64,
+    /// The largest scale, and the one the scaler starts at; 1 for the full device-pixel size.
+    pub max_scale: f64,
+    /// The factor the scale is multiplied by when stepping down, and divided by when stepping up.
+    pub step: f64,
+    /// A frame is too slow when its time is above this fraction of the target frame time.
+    pub overrun_ratio: f64,
+    /// There is headroom when a frame's time, with the scale stepped up, is estimated below this fraction of the target frame time.
+    pub headroom_ratio: f64,
+    /// The number of consecutive slow frames after which the scaler steps down.
+    pub step_down_after: u32,
+    /// The number of consecutive frames with headroom after which the scaler steps up.
+    /// Keep it larger than `step_down_after` so that the scaler doesn't oscillate.
+    pub step_up_after: u32,
+}
+
+impl Default for ResolutionScaleConfig {
+    fn default() -> Self {
+        Self {
+            target_frame_time: 1000.0 / 60.0,
+            min_scale: 0.5,
+            max_scale: 1.0,
+            step: 0.85,
+            overrun_ratio: 1.0,
+            headroom_ratio: 0.8,
+            step_down_after: 10,
+            step_up_after: 120,
+        }
+    }
+}
+
+/// Scales the drawing buffer of a canvas to hold a target frame time. See the [module documentation](self).
+///
+/// Its sizes replace a [`CanvasResizer`](crate::canvas_resizer::CanvasResizer)'s: both shouldn't manage the same canvas.
+///
+/// # Examples
+/// ```rust
+/// let mut scaler = ResolutionScaler::new("#canvas", ResolutionScaleConfig::default()).unwrap();
+/// let mut last = get_now();
+///
+/// set_main_loop(move || {
+///     let now = get_now();
+///     if let Some((width, height)) = scaler.observe(now - last) {
+///         renderer.resize(width, height);
+///     }
+///     last = now;
+///     renderer.draw();
+/// }, 0, true);
+/// ```
+#[derive(Debug, Clone)]
+pub struct ResolutionScaler {
+    config: ResolutionScaleConfig,
+    canvas: Target,
+    // The pinned CSS size of the canvas.
+    css_size: (f64, f64),
+    scale: f64,
+    size: (i32, i32),
+    overruns: u32,
+    headroom: u32,
+}
+
+impl ResolutionScaler {
+    /// Pins the CSS size of the canvas matching the given CSS selector to its current one, and sets its drawing buffer to the `max_scale` size.
+    pub fn new(canvas: &str, config: ResolutionScaleConfig) -> Result<Self, Html5Error> {
+        assert!(
+            0.0 < config.min_scale && config.min_scale <= config.max_scale,
+            "the scales must be positive, and the minimum not above the maximum"
+        );
+        assert!(
+            0.0 < config.step && config.step < 1.0,
+            "the step must be between 0 and 1"
+        );
+
+        let canvas = Target::selector(canvas);
+        let (width, height) = get_element_css_size(canvas)?;
+        let mut scaler = Self {
+            canvas,
+            css_size: (0.0, 0.0),
+            scale: config.max_scale,
+            size: (0, 0),
+            overruns: 0,
+            headroom: 0,
+            config,
+        };
+        scaler.set_css_size(width, height)?;
+        Ok(scaler)
+    }
+
+    /// Returns the current scale, as a fraction of the canvas' device-pixel size.
+    pub fn scale(&self) -> f64 {
+        self.scale
+    }
+
+    /// Returns the current drawing buffer size, in pixels.
+    pub fn size(&self) -> (i32, i32) {
+        self.size
+    }
+
+    /// Sets the pinned CSS size of the canvas, e.g. after the window is resized, and resizes the drawing buffer for it at the current scale.
+    pub fn set_css_size(&mut self, width: f64, height: f64) -> Result<(), Html5Error> {
+        set_element_css_size(self.canvas, width, height)?;
+        self.css_size = (width, height);
+        self.apply()
+    }
+
+    /// Sets the scale, clamped to the configured bounds, and resizes the drawing buffer for it.
+    pub fn set_scale(&mut self, scale: f64) -> Result<(), Html5Error> {
+        self.scale = scale.clamp(self.config.min_scale, self.config.max_scale);
+        self.overruns = 0;
+        self.headroom = 0;
+        self.apply()
+    }
+
+    /// Returns the smallest and largest scales the scaler steps between.
+    pub fn scale_bounds(&self) -> (f64, f64) {
+        (self.config.min_scale, self.config.max_scale)
+    }
+
+    /// Sets the smallest and largest scales the scaler steps between, e.g. to lower the largest one while the device saves power,
+    /// and clamps the current scale to them.
+    pub fn set_scale_bounds(&mut self, min_scale: f64, max_scale: f64) -> Result<(), Html5Error> {
+        assert!(
+            0.0 < min_scale && min_scale <= max_scale,
+            "the scales must be positive, and the minimum not above the maximum"
+        );
+        self.config.min_scale = min_scale;
+        self.config.max_scale = max_scale;
+        self.set_scale(self.scale)
+    }
+
+    /// Records the time of a frame, and resizes the drawing buffer if the scaler decides to step.
+    ///
+    /// It returns the new drawing buffer size, if it changed.
+    ///
+    /// # Arguments
+    /// * `frame_time` - The time of the frame, in milliseconds. The time between the starts of consecutive frames includes the GPU's
+    ///   work, which the cost of a tick measured on the CPU misses when the GPU is the bottleneck.
+    pub fn observe(&mut self, frame_time: f64) -> Option<(i32, i32)> {
+        let config = &self.config;
+        // The pixel count, and so the fill cost, grow with the square of the scale.
+        let stepped_up = frame_time / (config.step * config.step);
+        if frame_time > config.target_frame_time * config.overrun_ratio {
+            self.overruns += 1;
+            self.headroom = 0;
+        } else if self.scale < config.max_scale
+            && stepped_up < config.target_frame_time * config.headroom_ratio
+        {
+            self.headroom += 1;
+            self.overruns = 0;
+        } else {
+            self.overruns = 0;
+            self.headroom = 0;
+        }
+
+        let scale = if self.overruns >= config.step_down_after && self.scale > config.min_scale {
+            self.scale * config.step
+        } else if self.headroom >= config.step_up_after {
+            self.scale / config.step
+        } else {
+            return None;
+        };
+
+        let size = self.size;
+        self.set_scale(scale).ok()?;
+        (self.size != size).then_some(self.size)
+    }
+
+    /// Records the stats of the main loop, using their 95th percentile tick duration as the frame time, like [`observe`](Self::observe).
+    ///
+    /// The stats are computed over many ticks: it should be called every [`window`](MainLoopStats::window) ticks, not every tick,
+    /// and the `step_down_after` and `step_up_after` counts then count these calls.
+    pub fn observe_stats(&mut self, stats: &MainLoopStats) -> Option<(i32, i32)> {
+        self.observe(stats.p95)
+    }
+
+    fn apply(&mut self) -> Result<(), Html5Error> {
+        let ratio = device_pixel_ratio() * self.scale;
+        let size = (
+            ((self.css_size.0 * ratio).round() as i32).max(1),
+            ((self.css_size.1 * ratio).round() as i32).max(1),
+        );
+        if size != self.size {
+            set_canvas_element_size(self.canvas, size.0, size.1)?;
+            self.size = size;
+        }
+        Ok(())
+    }
+}
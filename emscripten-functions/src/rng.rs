@@ -0,0 +1,202 @@
+//! A fast pseudorandom number generator running in wasm, seeded once from `crypto.getRandomValues`.
+//!
+//! [`random`](crate::emscripten::random) calls `Math.random()` in JS for every number. [`Rng`] generates them in wasm instead,
+//! with four interleaved [xoshiro128++] streams, advanced together: built with `-C target-feature=+simd128`, the compiler turns each step
+//! into a few SIMD instructions, giving four numbers at once. [`Rng::fill_f32`] and [`random_fill`] fill whole buffers that way.
+//!
+//! It isn't cryptographically secure.
+//!
+//! [xoshiro128++]: https://prng.di.unimi.it/
+
+use std::{
+    cell::RefCell,
+    os::raw::{c_int, c_void},
+};
+
+use crate::emscripten::get_now;
+
+extern "C" {
+    fn getentropy(buffer: *mut c_void, length: usize) -> c_int;
+}
+
+// The number of interleaved streams, the number of 32-bit lanes of a SIMD register.
+const LANES: usize = 4;
+
+// Converts the top 24 bits of a random number to a float in [0, 1), which they fill without rounding.
+#[inline(always)]
+fn to_f32(x: u32) -> f32 {
+    (x >> 8) as f32 * (1.0 / (1u32 << 24) as f32)
+}
+
+// The SplitMix64 generator, which expands a seed into the generator state.
+fn splitmix64(state: &mut u64) -> u64 {
+    *state = state.wrapping_add(0x9e3779b97f4a7c15);
+    let mut z = *state;
+    z = (z ^ (z >> 30)).wrapping_mul(0xbf58476d1ce4e5b9);
+    z = (z ^ (z >> 27)).wrapping_mul(0x94d049bb133111eb);
+    z ^ (z >> 31)
+}
+
+// Returns a seed from the browser's secure random source, or from the clock if it's unavailable.
+fn entropy_seed() -> u64 {
+    let mut seed = 0u64;
+    if unsafe { getentropy(&mut seed as *mut u64 as *mut c_void, 8) } != 0 {
+        seed = get_now().to_bits();
+    }
+    seed
+}
+
+/// A xoshiro128++ pseudorandom number generator, with four streams advanced at once.
+///
+/// # Examples
+/// ```rust
+/// let mut rng = Rng::new();
+/// let mut offsets = vec![0.0; particles.len() * 2];
+/// rng.fill_f32(&mut offsets);
+/// for (particle, offset) in particles.iter_mut().zip(offsets.chunks(2)) {
+///     particle.velocity += Vec2::new(offset[0] - 0.5, offset[1] - 0.5);
+/// }
+/// ```
+#[derive(Debug, Clone)]
+pub struct Rng {
+    // The state words of the streams, by word and then by stream, so that each word of all the streams fits a SIMD register.
+    state: [[u32; LANES]; 4],
+    // The numbers of the last step, whose ones from index `next` weren't returned by `next_u32` yet.
+    buffer: [u32; LANES],
+    next: usize,
+}
+
+impl Rng {
+    /// Creates a generator seeded from `crypto.getRandomValues`, through `getentropy`.
+    pub fn new() -> Self {
+        Self::from_seed(entropy_seed())
+    }
+
+    /// Creates a generator from the given seed, giving the same numbers for the same seed, e.g. for replays.
+    pub fn from_seed(seed: u64) -> Self {
+        let mut splitmix = seed;
+        let mut state = [[0; LANES]; 4];
+        for lane in 0..LANES {
+            for word in &mut state {
+                word[lane] = splitmix64(&mut splitmix) as u32;
+            }
+            // An all-zero state would only give zeros.
+            if state.iter().all(|word| word[lane] == 0) {
+                state[0][lane] = 1;
+            }
+        }
+
+        Self {
+            state,
+            buffer: [0; LANES],
+            next: LANES,
+        }
+    }
+
+    // Advances all the streams, returning one number of each.
+    #[inline(always)]
+    fn step(&mut self) -> [u32; LANES] {
+        let [s0, s1, s2, s3] = &mut self.state;
+        let mut result = [0; LANES];
+        // Each iteration is the same operation on one lane, which the compiler vectorizes.
+        for lane in 0..LANES {
+            result[lane] = s0[lane]
+                .wrapping_add(s3[lane])
+                .rotate_left(7)
+                .wrapping_add(s0[lane]);
+            let t = s1[lane] << 9;
+            s2[lane] ^= s0[lane];
+            s3[lane] ^= s1[lane];
+            s1[lane] ^= s2[lane];
+            s0[lane] ^= s3[lane];
+            s2[lane] ^= t;
+            s3[lane] = s3[lane].rotate_left(11);
+        }
+        result
+    }
+
+    /// Returns a random 32-bit number.
+    #[inline]
+    pub fn next_u32(&mut self) -> u32 {
+        if self.next == LANES {
+            self.buffer = self.step();
+            self.next = 0;
+        }
+        let value = self.buffer[self.next];
+        self.next += 1;
+        value
+    }
+
+    /// Returns a random number in range [0,1).
+    #[inline]
+    pub fn next_f32(&mut self) -> f32 {
+        to_f32(self.next_u32())
+    }
+
+    /// Returns a random number in range [`low`, `high`).
+    #[inline]
+    pub fn range_f32(&mut self, low: f32, high: f32) -> f32 {
+        low + (high - low) * self.next_f32()
+    }
+
+    /// Fills the buffer with random 32-bit numbers, four at a time.
+    pub fn fill_u32(&mut self, buffer: &mut [u32]) {
+        let mut chunks = buffer.chunks_exact_mut(LANES);
+        for chunk in &mut chunks {
+            chunk.copy_from_slice(&self.step());
+        }
+        for value in chunks.into_remainder() {
+            *value = self.next_u32();
+        }
+    }
+
+    /// Fills the buffer with random numbers in range [0,1), four at a time.
+    pub fn fill_f32(&mut self, buffer: &mut [f32]) {
+        let mut chunks = buffer.chunks_exact_mut(LANES);
+        for chunk in &mut chunks {
+            let values = self.step();
+            for lane in 0..LANES {
+                chunk[lane] = to_f32(values[lane]);
+            }
+        }
+        for value in chunks.into_remainder() {
+            *value = self.next_f32();
+        }
+    }
+}
+
+impl Default for Rng {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+// The generator of the free functions, seeded on its thread's first use.
+thread_local! {
+    static THREAD_RNG: RefCell<Option<Rng>> = const { RefCell::new(None) };
+}
+
+fn with_thread_rng<R>(f: impl FnOnce(&mut Rng) -> R) -> R {
+    THREAD_RNG.with(|rng| f(rng.borrow_mut().get_or_insert_with(Rng::new)))
+}
+
+/// Returns a random number in range [0,1), from the calling thread's generator, without calling into JS.
+///
+/// # Examples
+/// ```rust
+/// let angle = random_f32() * std::f32::consts::TAU;
+/// ```
+pub fn random_f32() -> f32 {
+    with_thread_rng(Rng::next_f32)
+}
+
+/// Fills the buffer with random numbers in range [0,1), from the calling thread's generator, four at a time.
+///
+/// # Examples
+/// ```rust
+/// let mut jitter = [0.0f32; 4096];
+/// random_fill(&mut jitter);
+/// ```
+pub fn random_fill(buffer: &mut [f32]) {
+    with_thread_rng(|rng| rng.fill_f32(buffer))
+}
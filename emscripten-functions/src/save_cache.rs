@@ -0,0 +1,245 @@
+//! A write-behind cache in front of an IndexedDB [`Store`], for saves that are written often but only need to be durable within a second or so.
+//!
+//! Storing an autosave from the main loop copies it and starts its transaction during the frame. A [`SaveCache`] instead
+//! keeps the written entries in memory, and only stores the latest data of each key: the dirty entries are written
+//! some time after the first write, in batches taken in the browser's idle periods with [`schedule_idle`].
+//! The remaining entries are flushed when the page gets hidden, and from its `beforeunload` event, set with the
+//! emscripten-defined [`emscripten_set_beforeunload_callback_on_thread`].
+//!
+//! The browser may not finish the transactions started while the page unloads; the `visibilitychange` flush,
+//! which comes first when the user switches tabs or closes a mobile browser, is the one to rely on.
+//!
+//! [`emscripten_set_beforeunload_callback_on_thread`]: https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_set_beforeunload_callback_on_thread
+
+use std::{
+    cell::{Cell, RefCell},
+    collections::HashMap,
+    os::raw::{c_char, c_int, c_void},
+    rc::Rc,
+};
+
+use emscripten_functions_sys::html5;
+
+use crate::{
+    html5::{
+        events::{on_visibilitychange, EventListener},
+        Html5Error,
+    },
+    idb::{IdbError, Store},
+    idle::schedule_idle,
+    scheduler::Step,
+    timers::set_timeout,
+};
+
+// `EM_CALLBACK_THREAD_CONTEXT_CALLING_THREAD`, a pointer-valued macro bindgen doesn't generate.
+const CALLING_THREAD: html5::pthread_t = 0x2 as html5::pthread_t;
+
+/// The default time between the first write of dirty entries and their flush, in milliseconds.
+pub const DEFAULT_FLUSH_DELAY: f64 = 1000.0;
+
+// The number of bytes an idle period writes at most; the copy of the data into the transaction happens during the period.
+const IDLE_BATCH_BYTES: usize = 1 << 20;
+
+// The time left in an idle period below which no more entries are taken, in milliseconds.
+const IDLE_MARGIN: f64 = 1.0;
+
+type OnError = Box<dyn FnMut(&str, IdbError)>;
+
+struct CacheState {
+    store: Store,
+    dirty: RefCell<HashMap<String, Vec<u8>>>,
+    delay: Cell<f64>,
+    scheduled: Cell<bool>,
+    onerror: RefCell<Option<OnError>>,
+}
+
+impl CacheState {
+    // Schedules the idle flush of the dirty entries, after the delay.
+    fn schedule(self: &Rc<Self>) {
+        if self.scheduled.replace(true) {
+            return;
+        }
+        let state = self.clone();
+        set_timeout(
+            move || {
+                schedule_idle(move |deadline| {
+                    let mut bytes = 0;
+                    while bytes < IDLE_BATCH_BYTES && deadline.time_remaining() > IDLE_MARGIN {
+                        let Some(written) = state.write_one() else {
+                            break;
+                        };
+                        bytes += written;
+                    }
+                    state.store.flush();
+
+                    if state.dirty.borrow().is_empty() {
+                        state.scheduled.set(false);
+                        Step::Done
+                    } else {
+                        Step::Continue
+                    }
+                });
+            },
+            self.delay.get(),
+        );
+    }
+
+    // Queues the store of one dirty entry, returning its size, or `None` if there's none.
+    fn write_one(self: &Rc<Self>) -> Option<usize> {
+        let key = self.dirty.borrow().keys().next().cloned()?;
+        let data = self.dirty.borrow_mut().remove(&key)?;
+        let size = data.len();
+        self.write(key, data);
+        Some(size)
+    }
+
+    fn write(self: &Rc<Self>, key: String, data: Vec<u8>) {
+        let state = self.clone();
+        let error_key = key.clone();
+        self.store.store(key, data, move |result| {
+            let Err(err) = result else {
+                return;
+            };
+            let onerror = state.onerror.borrow_mut().take();
+            if let Some(mut onerror) = onerror {
+                onerror(&error_key, err);
+                state.onerror.borrow_mut().get_or_insert(onerror);
+            }
+        });
+    }
+
+    fn flush(self: &Rc<Self>) {
+        while self.write_one().is_some() {}
+        self.store.flush();
+    }
+}
+
+unsafe extern "C" fn beforeunload_trampoline(
+    _event_type: c_int,
+    _reserved: *const c_void,
+    user_data: *mut c_void,
+) -> *const c_char {
+    // The state is kept alive by the cache, which unsets the callback when dropped.
+    let state = Rc::from_raw(user_data as *const CacheState);
+    state.flush();
+    std::mem::forget(state);
+    // No confirmation dialog is asked for.
+    std::ptr::null()
+}
+
+/// A write-behind cache in front of an IndexedDB [`Store`]. See the [module documentation](self).
+///
+/// There can be only one cache at a time setting the `beforeunload` callback, which is the page's only one,
+/// also used by [`metrics::Exporter`](crate::metrics::Exporter). Dropping the cache flushes it.
+///
+/// # Examples
+/// ```rust
+/// let saves = SaveCache::new(Store::new("saves")).unwrap();
+///
+/// set_main_loop(move || {
+///     world.step();
+///     // Only the latest state is written, about once a second, while the browser is idle.
+///     saves.write("autosave", world.serialize());
+/// }, 0, true);
+/// ```
+#[must_use = "the entries are flushed when the cache is dropped"]
+pub struct SaveCache {
+    state: Rc<CacheState>,
+    _visibility: EventListener,
+}
+
+impl SaveCache {
+    /// Creates a cache in front of the store, flushing it when the page gets hidden or unloads.
+    /// It must be called from the main browser thread.
+    pub fn new(store: Store) -> Result<Self, Html5Error> {
+        let state = Rc::new(CacheState {
+            store,
+            dirty: RefCell::new(HashMap::new()),
+            delay: Cell::new(DEFAULT_FLUSH_DELAY),
+            scheduled: Cell::new(false),
+            onerror: RefCell::new(None),
+        });
+
+        let visibility_state = state.clone();
+        let visibility = on_visibilitychange(false, move |event| {
+            if event.hidden != 0 {
+                visibility_state.flush();
+            }
+            false
+        })?;
+        unsafe {
+            html5::emscripten_set_beforeunload_callback_on_thread(
+                Rc::as_ptr(&state) as *mut c_void,
+                Some(beforeunload_trampoline),
+                CALLING_THREAD,
+            );
+        }
+
+        Ok(Self {
+            state,
+            _visibility: visibility,
+        })
+    }
+
+    /// Sets the time between the first write of dirty entries and their flush, in milliseconds: [`DEFAULT_FLUSH_DELAY`] by default.
+    /// The writes made meanwhile replace each other, and only the latest data of each key is stored.
+    pub fn set_flush_delay(&self, delay: f64) {
+        self.state.delay.set(delay);
+    }
+
+    /// Sets the function called with the key and the error of each failed store, e.g. to write the entry again.
+    pub fn on_error<F>(&self, onerror: F)
+    where
+        F: 'static + FnMut(&str, IdbError),
+    {
+        *self.state.onerror.borrow_mut() = Some(Box::new(onerror));
+    }
+
+    /// Writes the data under the given key, in memory; it's stored in IndexedDB with the next flush.
+    pub fn write<T, D>(&self, key: T, data: D)
+    where
+        T: Into<String>,
+        D: Into<Vec<u8>>,
+    {
+        self.state
+            .dirty
+            .borrow_mut()
+            .insert(key.into(), data.into());
+        self.state.schedule();
+    }
+
+    /// Reads the data of the given key, from memory if it's dirty, or from the store.
+    pub fn read<F>(&self, key: &str, callback: F)
+    where
+        F: 'static + FnOnce(Result<Vec<u8>, IdbError>),
+    {
+        let dirty = self.state.dirty.borrow().get(key).cloned();
+        match dirty {
+            Some(data) => callback(Ok(data)),
+            None => self.state.store.load(key, callback),
+        }
+    }
+
+    /// Returns the number of entries not written to the store yet.
+    pub fn dirty_len(&self) -> usize {
+        self.state.dirty.borrow().len()
+    }
+
+    /// Writes all the dirty entries to the store right away, in a single transaction, e.g. on a checkpoint.
+    pub fn flush(&self) {
+        self.state.flush();
+    }
+}
+
+impl Drop for SaveCache {
+    fn drop(&mut self) {
+        unsafe {
+            html5::emscripten_set_beforeunload_callback_on_thread(
+                std::ptr::null_mut(),
+                None,
+                CALLING_THREAD,
+            );
+        }
+        self.state.flush();
+    }
+}
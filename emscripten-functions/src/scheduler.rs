@@ -0,0 +1,116 @@
+//! A cooperative scheduler of background tasks, run in time-sliced batches with the emscripten-defined [`emscripten_set_immediate_loop`].
+//!
+//! Chaining `setTimeout(0)` calls is clamped by browsers to 4ms per call after a few nested calls, so background work split that way crawls.
+//! Here, the queued tasks of the calling thread run round-robin for up to a time budget per slice (4ms by default),
+//! then the scheduler yields back to the browser with `setImmediate` semantics, without the clamping, and runs the next slice.
+//!
+//! [`emscripten_set_immediate_loop`]: https://emscripten.org/docs/api_reference/eventloop.h.html#c.emscripten_set_immediate_loop
+
+use std::{
+    cell::{Cell, RefCell},
+    collections::VecDeque,
+    os::raw::{c_int, c_void},
+};
+
+use emscripten_functions_sys::html5;
+
+use crate::emscripten::get_now;
+
+/// The default time budget of a slice, in milliseconds.
+pub const DEFAULT_SLICE_BUDGET: f64 = 4.0;
+
+/// What a task returns after doing a step of its work.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Step {
+    /// The task has more work to do; it's queued again.
+    Continue,
+    /// The task is done; it's dropped.
+    Done,
+}
+
+type Task = Box<dyn FnMut() -> Step>;
+
+thread_local! {
+    static RUN_QUEUE: RefCell<VecDeque<Task>> = RefCell::new(VecDeque::new());
+    static SLICE_BUDGET: Cell<f64> = Cell::new(DEFAULT_SLICE_BUDGET);
+    static LOOP_RUNNING: Cell<bool> = Cell::new(false);
+}
+
+/// Queues a task that runs a step of its work on each call, until it returns [`Step::Done`].
+///
+/// Keep the steps short (well under the slice budget): a step is never interrupted, so a long one delays the browser's rendering and input handling.
+///
+/// # Examples
+/// ```rust
+/// let mut open_nodes = vec![start];
+/// spawn_task(move || {
+///     // Expand a few nodes per step.
+///     for _ in 0..64 {
+///         match open_nodes.pop() {
+///             Some(node) => open_nodes.extend(expand(node)),
+///             None => return Step::Done,
+///         }
+///     }
+///     Step::Continue
+/// });
+/// ```
+pub fn spawn_task<F>(task: F)
+where
+    F: 'static + FnMut() -> Step,
+{
+    RUN_QUEUE.with(|queue| queue.borrow_mut().push_back(Box::new(task)));
+
+    if !LOOP_RUNNING.with(|running| running.replace(true)) {
+        unsafe {
+            html5::emscripten_set_immediate_loop(Some(run_slice), std::ptr::null_mut());
+        }
+    }
+}
+
+/// Queues a function that runs once, in the next slice with time left.
+pub fn spawn_once<F>(func: F)
+where
+    F: 'static + FnOnce(),
+{
+    let mut func = Some(func);
+    spawn_task(move || {
+        if let Some(func) = func.take() {
+            func();
+        }
+        Step::Done
+    });
+}
+
+/// Sets the time budget of a slice: the time after which the scheduler stops starting task steps and yields to the browser.
+///
+/// # Arguments
+/// * `budget` - The budget in milliseconds. The default is [`DEFAULT_SLICE_BUDGET`].
+pub fn set_slice_budget(budget: f64) {
+    SLICE_BUDGET.with(|slice_budget| slice_budget.set(budget));
+}
+
+/// Returns the number of queued tasks.
+pub fn pending_tasks() -> usize {
+    RUN_QUEUE.with(|queue| queue.borrow().len())
+}
+
+unsafe extern "C" fn run_slice(_user_data: *mut c_void) -> c_int {
+    let deadline = get_now() + SLICE_BUDGET.with(|budget| budget.get());
+
+    loop {
+        // The queue isn't borrowed while the task runs, so that it can spawn other tasks.
+        let task = RUN_QUEUE.with(|queue| queue.borrow_mut().pop_front());
+        let Some(mut task) = task else {
+            LOOP_RUNNING.with(|running| running.set(false));
+            return html5::EM_FALSE as c_int;
+        };
+
+        if task() == Step::Continue {
+            RUN_QUEUE.with(|queue| queue.borrow_mut().push_back(task));
+        }
+
+        if get_now() >= deadline {
+            return html5::EM_TRUE as c_int;
+        }
+    }
+}
@@ -0,0 +1,661 @@
+//! Compiled JavaScript scripts, that are parsed once and then called with typed arguments.
+//!
+//! The `run_script*` functions from the [`emscripten`](crate::emscripten) module pass their script to [`eval()`], so the JS engine parses it again on every call,
+//! and the data has to be spliced into the script's source.
+//! A [`Script`] is instead compiled once into a JS [`Function`], stored in a JS-side table, and called by its id with numeric arguments.
+//!
+//! JS objects, like DOM elements, can be held from rust as [`JsHandle`]s and passed to scripts, instead of being looked up again by each script.
+//! With [`Script::call_with`], rust slices are passed to scripts as typed arrays viewing the wasm memory, without copying them.
+//! The other way around, [`Script::call_array_into`] and [`run_script_bytes`] copy a typed array or `ArrayBuffer` returned by a script
+//! straight into a rust buffer, instead of encoding it into a string to be parsed again.
+//!
+//! JS files can also be loaded in parallel with [`load_scripts`], rather than one after another.
+//!
+//! [`eval()`]: https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/eval
+//! [`Function`]: https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Function/Function
+
+use std::{
+    cell::RefCell,
+    fmt::Display,
+    marker::PhantomData,
+    os::raw::{c_char, c_double, c_int, c_void},
+    rc::Rc,
+};
+
+use crate::{
+    c_str::with_c_str,
+    executor::{callback_future, CallbackFuture},
+    memory::install_heap_views,
+};
+
+// The functions defined in `script.c`.
+extern "C" {
+    fn script_compile(source: *const c_char) -> c_int;
+    fn script_release(id: c_int);
+    fn script_call(id: c_int, args: *const c_double, count: c_int);
+    fn script_call_int(id: c_int, args: *const c_double, count: c_int) -> c_int;
+    fn script_call_double(id: c_int, args: *const c_double, count: c_int) -> c_double;
+    fn script_call_typed(id: c_int, args: *const c_double, count: c_int);
+    fn script_call_typed_int(id: c_int, args: *const c_double, count: c_int) -> c_int;
+    fn script_call_typed_double(id: c_int, args: *const c_double, count: c_int) -> c_double;
+    fn script_call_handle(id: c_int, args: *const c_double, count: c_int) -> c_int;
+    fn script_call_bytes(
+        id: c_int,
+        source: *const c_char,
+        args: *const c_double,
+        count: c_int,
+        buffer: *mut c_void,
+        capacity: c_int,
+    ) -> c_int;
+    fn script_take_result(buffer: *mut c_void);
+    fn script_handle_query_selector(selector: *const c_char) -> c_int;
+    fn script_handle_property(object: c_int, name: *const c_char) -> c_int;
+    fn script_handle_clone(object: c_int) -> c_int;
+    fn script_handle_release(handle: c_int);
+    fn script_load(
+        url: *const c_char,
+        in_order: c_int,
+        callback: unsafe extern "C" fn(*mut c_void, c_int),
+        arg: *mut c_void,
+    );
+}
+
+/// The maximum number of arguments a [`Script`] can be called with.
+pub const MAX_SCRIPT_ARGS: usize = 16;
+
+/// The error returned by [`Script::compile`] when the JS engine can't parse the given source.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct ScriptCompileError;
+impl Display for ScriptCompileError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        write!(f, "The script's source code couldn't be compiled")
+    }
+}
+
+/// A JavaScript function body compiled once, that can be called many times with numeric arguments.
+///
+/// The source is the body of a function whose parameters are named `$0`, `$1`, ... `$15`, like in emscripten's `EM_ASM` blocks.
+/// Use `return` to give a result, unlike with the `run_script*` functions where the last expression's value is the result.
+/// A [`JsHandle`] passed as an argument gives its object with `$h(handle)`,
+/// and the views of the wasm memory are `$heap.HEAPU8`, `$heap.HEAPF32`... as installed by [`install_heap_views`].
+///
+/// The compiled function lives in the JS context of the thread that compiled it,
+/// so a `Script` can only be used in that thread. It is released when dropped.
+///
+/// # Examples
+/// ```rust
+/// let set_progress = Script::compile(r#"
+///     document.querySelector("progress").value = $0;
+/// "#).unwrap();
+/// let add = Script::compile("return $0 + $1;").unwrap();
+///
+/// set_progress.call(&[0.5]);
+/// assert_eq!(add.call_int(&[1.0, 2.0]), 3);
+/// assert_eq!(add.call_double(&[0.5, 0.25]), 0.75);
+/// ```
+#[derive(Debug)]
+pub struct Script {
+    id: c_int,
+    // The JS function table is per-thread, so `Script` mustn't be `Send` or `Sync`.
+    _not_send: PhantomData<*const ()>,
+}
+
+impl Script {
+    /// Compiles the given JavaScript function body using the [`Function()`] JS constructor.
+    ///
+    /// [`Function()`]: https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/Function/Function
+    ///
+    /// # Arguments
+    /// * `source` - The body of the function, with the arguments named `$0`, `$1`, ... `$15`.
+    pub fn compile<T>(source: T) -> Result<Script, ScriptCompileError>
+    where
+        T: AsRef<str>,
+    {
+        install_heap_views();
+        let id = with_c_str(source.as_ref(), |source| unsafe { script_compile(source) });
+
+        if id < 0 {
+            return Err(ScriptCompileError);
+        }
+        Ok(Script {
+            id,
+            _not_send: PhantomData,
+        })
+    }
+
+    /// Returns the id of the script in the JS-side table of the calling thread.
+    pub fn id(&self) -> c_int {
+        self.id
+    }
+
+    /// Calls the script with the given arguments, ignoring its return value.
+    ///
+    /// Integers and pointers can be passed as arguments by casting them to `f64`, which represents them exactly.
+    ///
+    /// # Arguments
+    /// * `args` - The arguments, available in the script as `$0`, `$1`, ... It can have at most [`MAX_SCRIPT_ARGS`] elements.
+    pub fn call(&self, args: &[f64]) {
+        check_args(args);
+        unsafe { script_call(self.id, args.as_ptr(), args.len() as c_int) }
+    }
+
+    /// Calls the script with the given arguments, returning its return value converted to a C int, with NaN and `undefined` represented as 0.
+    ///
+    /// # Arguments
+    /// * `args` - The arguments, available in the script as `$0`, `$1`, ... It can have at most [`MAX_SCRIPT_ARGS`] elements.
+    pub fn call_int(&self, args: &[f64]) -> c_int {
+        check_args(args);
+        unsafe { script_call_int(self.id, args.as_ptr(), args.len() as c_int) }
+    }
+
+    /// Calls the script with the given arguments, returning its return value converted to a C double.
+    ///
+    /// # Arguments
+    /// * `args` - The arguments, available in the script as `$0`, `$1`, ... It can have at most [`MAX_SCRIPT_ARGS`] elements.
+    pub fn call_double(&self, args: &[f64]) -> c_double {
+        check_args(args);
+        unsafe { script_call_double(self.id, args.as_ptr(), args.len() as c_int) }
+    }
+
+    /// Calls the script with the given typed arguments, ignoring its return value.
+    ///
+    /// Unlike with [`Script::call`], slices are passed to the script as typed arrays viewing their memory, without a copy,
+    /// and handles as the objects they hold. The views are only valid during the call: the script must copy the data it keeps,
+    /// e.g. with `slice()`.
+    ///
+    /// # Arguments
+    /// * `args` - The arguments, available in the script as `$0`, `$1`, ... It can have at most [`MAX_SCRIPT_ARGS`] elements.
+    ///
+    /// # Examples
+    /// ```rust
+    /// let play = Script::compile(r#"
+    ///     var buffer = audioContext.createBuffer(1, $0.length, 48000);
+    ///     buffer.copyToChannel($0, 0);
+    ///     playBuffer(buffer, $1);
+    /// "#).unwrap();
+    /// let samples: Vec<f32> = synthesize();
+    /// play.call_with(&[samples.as_slice().into(), 0.8.into()]);
+    /// ```
+    pub fn call_with(&self, args: &[ScriptArg<'_>]) {
+        let encoded = ScriptArg::encode_all(args);
+        unsafe { script_call_typed(self.id, encoded.as_ptr(), args.len() as c_int) }
+    }
+
+    /// Calls the script with the given typed arguments like [`Script::call_with`], returning its return value converted to a C int,
+    /// with NaN and `undefined` represented as 0.
+    pub fn call_with_int(&self, args: &[ScriptArg<'_>]) -> c_int {
+        let encoded = ScriptArg::encode_all(args);
+        unsafe { script_call_typed_int(self.id, encoded.as_ptr(), args.len() as c_int) }
+    }
+
+    /// Calls the script with the given typed arguments like [`Script::call_with`], returning its return value converted to a C double.
+    pub fn call_with_double(&self, args: &[ScriptArg<'_>]) -> c_double {
+        let encoded = ScriptArg::encode_all(args);
+        unsafe { script_call_typed_double(self.id, encoded.as_ptr(), args.len() as c_int) }
+    }
+
+    /// Calls the script with the given arguments, returning a handle to the object it returns, or `None` if it returns `null` or `undefined`.
+    ///
+    /// # Arguments
+    /// * `args` - The arguments, available in the script as `$0`, `$1`, ... It can have at most [`MAX_SCRIPT_ARGS`] elements.
+    ///
+    /// # Examples
+    /// ```rust
+    /// let get_context = Script::compile(r#"return $h($0).getContext("2d");"#).unwrap();
+    /// let context = get_context.call_handle(&[canvas.as_arg()]).unwrap();
+    /// ```
+    pub fn call_handle(&self, args: &[f64]) -> Option<JsHandle> {
+        check_args(args);
+        JsHandle::from_id(unsafe {
+            script_call_handle(self.id, args.as_ptr(), args.len() as c_int)
+        })
+    }
+}
+
+impl Script {
+    /// Calls the script with the given typed arguments like [`Script::call_with`], returning the bytes of the `ArrayBuffer`,
+    /// or of the view of one like a typed array, it returns, or `None` if it returns anything else.
+    pub fn call_bytes(&self, args: &[ScriptArg<'_>]) -> Option<Vec<u8>> {
+        let mut buffer = Vec::new();
+        self.call_array_into(args, &mut buffer).then_some(buffer)
+    }
+
+    /// Calls the script with the given typed arguments like [`Script::call_with`], and copies the `ArrayBuffer`, or the view of one
+    /// like a typed array, it returns into `buffer`, as elements of `T` in the platform's (little-endian) byte order.
+    /// The buffer's capacity is reused, and only grown if the result doesn't fit in it.
+    ///
+    /// It returns `false`, leaving `buffer` empty, if the script returns anything else, or bytes that aren't a whole number of elements.
+    ///
+    /// # Examples
+    /// ```rust
+    /// let frame_times = Script::compile("return analytics.frameTimes;").unwrap();
+    /// let mut times: Vec<f64> = Vec::new();
+    /// set_main_loop(move || {
+    ///     if frame_times.call_array_into(&[], &mut times) {
+    ///         report_percentiles(&times);
+    ///     }
+    /// }, 0, true);
+    /// ```
+    pub fn call_array_into<T: ScriptElement>(
+        &self,
+        args: &[ScriptArg<'_>],
+        buffer: &mut Vec<T>,
+    ) -> bool {
+        let encoded = ScriptArg::encode_all(args);
+        take_result(buffer, |data, capacity| unsafe {
+            script_call_bytes(
+                self.id,
+                std::ptr::null(),
+                encoded.as_ptr(),
+                args.len() as c_int,
+                data,
+                capacity,
+            )
+        })
+    }
+}
+
+/// A type of element a script's binary result can be copied into, by [`Script::call_array_into`] or [`run_script_array_into`].
+///
+/// # Safety
+/// Every bit pattern must be a valid value of the type.
+pub unsafe trait ScriptElement: Copy {}
+
+// Runs a script through `call`, which copies its binary result into the given buffer if it fits in the given capacity, in bytes,
+// and returns the result's length as `script_call_bytes` does.
+fn take_result<T, F>(buffer: &mut Vec<T>, call: F) -> bool
+where
+    T: ScriptElement,
+    F: FnOnce(*mut c_void, c_int) -> c_int,
+{
+    let size = std::mem::size_of::<T>();
+    buffer.clear();
+    let capacity = (buffer.capacity() * size).min(c_int::MAX as usize);
+    let bytes = match call(buffer.as_mut_ptr() as *mut c_void, capacity as c_int) {
+        -1 => return false,
+        len if len >= 0 => len as usize,
+        needed => {
+            // The result is kept on the JS side until it's taken.
+            let len = (-2 - needed) as usize;
+            buffer.reserve(len.div_ceil(size));
+            unsafe { script_take_result(buffer.as_mut_ptr() as *mut c_void) };
+            len
+        }
+    };
+    if bytes % size != 0 {
+        return false;
+    }
+    // The first `bytes` bytes were written, and any bit pattern is a valid `T`.
+    unsafe { buffer.set_len(bytes / size) };
+    true
+}
+
+/// Runs the given JavaScript script string with [`eval()`], like [`run_script_string`](crate::emscripten::run_script_string),
+/// and returns the bytes of the `ArrayBuffer`, or of the view of one like a typed array, it evaluates to, or `None` if it evaluates to anything else.
+///
+/// [`eval()`]: https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/eval
+///
+/// # Examples
+/// ```rust
+/// let pixels = run_script_bytes(
+///     "document.getElementById('thumbnail').getContext('2d').getImageData(0, 0, 64, 64).data",
+/// )
+/// .unwrap();
+/// assert_eq!(pixels.len(), 64 * 64 * 4);
+/// ```
+pub fn run_script_bytes<T>(script: T) -> Option<Vec<u8>>
+where
+    T: AsRef<str>,
+{
+    let mut buffer = Vec::new();
+    run_script_array_into(script, &mut buffer).then_some(buffer)
+}
+
+/// Runs the given JavaScript script string like [`run_script_bytes`], and copies its result into `buffer` like [`Script::call_array_into`].
+pub fn run_script_array_into<T, E>(script: T, buffer: &mut Vec<E>) -> bool
+where
+    T: AsRef<str>,
+    E: ScriptElement,
+{
+    with_c_str(script.as_ref(), |script| {
+        take_result(buffer, |data, capacity| unsafe {
+            script_call_bytes(-1, script, std::ptr::null(), 0, data, capacity)
+        })
+    })
+}
+
+impl Drop for Script {
+    fn drop(&mut self) {
+        unsafe { script_release(self.id) }
+    }
+}
+
+/// A reference to a JS object, like a DOM element, held in a JS-side table of the calling thread, and released when dropped.
+///
+/// Holding the objects that scripts use again and again saves looking them up each time, e.g. with `document.querySelector`.
+/// A handle is passed to a [`Script`] as an argument with [`JsHandle::as_arg`], and the script gets its object with `$h(handle)`.
+///
+/// Unlike the [`webgpu::JsHandle`](crate::webgpu::JsHandle) of emscripten's WebGPU object table, it can hold any JS value but `null` and `undefined`.
+///
+/// # Examples
+/// ```rust
+/// let score = JsHandle::query_selector("#score").unwrap();
+/// let set_text = Script::compile("$h($0).textContent = $1;").unwrap();
+///
+/// set_main_loop(move || {
+///     set_text.call(&[score.as_arg(), points() as f64]);
+/// }, 0, true);
+/// ```
+#[derive(Debug)]
+pub struct JsHandle {
+    handle: c_int,
+    // The handle table is per-thread, like the scripts one.
+    _not_send: PhantomData<*const ()>,
+}
+
+impl JsHandle {
+    fn from_id(handle: c_int) -> Option<Self> {
+        (handle >= 0).then_some(Self {
+            handle,
+            _not_send: PhantomData,
+        })
+    }
+
+    /// Returns a handle to the first element of the document matching the given CSS selector, using [`document.querySelector()`],
+    /// or `None` if there is none. It must be called from the main browser thread.
+    ///
+    /// [`document.querySelector()`]: https://developer.mozilla.org/en-US/docs/Web/API/Document/querySelector
+    pub fn query_selector(selector: &str) -> Option<Self> {
+        Self::from_id(with_c_str(selector, |selector| unsafe {
+            script_handle_query_selector(selector)
+        }))
+    }
+
+    /// Returns a handle to the value of the given property of the object, or `None` if it's `null` or `undefined`.
+    ///
+    /// # Examples
+    /// ```rust
+    /// let canvas = JsHandle::query_selector("#canvas").unwrap();
+    /// let style = canvas.property("style").unwrap();
+    /// ```
+    pub fn property(&self, name: &str) -> Option<Self> {
+        Self::from_id(with_c_str(name, |name| unsafe {
+            script_handle_property(self.handle, name)
+        }))
+    }
+
+    /// Returns the handle as a script argument, for a [`Script`] to get its object with `$h(handle)`.
+    pub fn as_arg(&self) -> f64 {
+        self.handle as f64
+    }
+
+    /// Returns the index of the handle in the JS-side table, which JS code gets the object from with
+    /// `Module["emscriptenFunctionsHandles"].table[handle]`.
+    pub fn as_raw(&self) -> c_int {
+        self.handle
+    }
+}
+
+impl Clone for JsHandle {
+    /// Returns another handle to the same object, released independently.
+    fn clone(&self) -> Self {
+        Self {
+            handle: unsafe { script_handle_clone(self.handle) },
+            _not_send: PhantomData,
+        }
+    }
+}
+
+impl Drop for JsHandle {
+    fn drop(&mut self) {
+        unsafe { script_handle_release(self.handle) }
+    }
+}
+
+/// A typed argument of [`Script::call_with`].
+///
+/// It's usually created with `into()`, from a number, a `bool`, a [`JsHandle`] reference or a slice of numbers.
+#[derive(Debug, Clone, Copy)]
+pub enum ScriptArg<'a> {
+    /// A number.
+    Number(f64),
+    /// The object held by the handle.
+    Handle(&'a JsHandle),
+    /// An `Int8Array` viewing the slice.
+    I8(&'a [i8]),
+    /// A `Uint8Array` viewing the slice.
+    U8(&'a [u8]),
+    /// An `Int16Array` viewing the slice.
+    I16(&'a [i16]),
+    /// A `Uint16Array` viewing the slice.
+    U16(&'a [u16]),
+    /// An `Int32Array` viewing the slice.
+    I32(&'a [i32]),
+    /// A `Uint32Array` viewing the slice.
+    U32(&'a [u32]),
+    /// A `Float32Array` viewing the slice.
+    F32(&'a [f32]),
+    /// A `Float64Array` viewing the slice.
+    F64(&'a [f64]),
+}
+
+impl ScriptArg<'_> {
+    // Encodes the argument as its kind, its value or pointer, and its length, as decoded in `script.c`.
+    fn encode(&self) -> [f64; 3] {
+        fn slice<T>(kind: f64, slice: &[T]) -> [f64; 3] {
+            [kind, slice.as_ptr() as usize as f64, slice.len() as f64]
+        }
+
+        match *self {
+            ScriptArg::Number(value) => [0.0, value, 0.0],
+            ScriptArg::Handle(handle) => [1.0, handle.as_arg(), 0.0],
+            ScriptArg::I8(data) => slice(2.0, data),
+            ScriptArg::U8(data) => slice(3.0, data),
+            ScriptArg::I16(data) => slice(4.0, data),
+            ScriptArg::U16(data) => slice(5.0, data),
+            ScriptArg::I32(data) => slice(6.0, data),
+            ScriptArg::U32(data) => slice(7.0, data),
+            ScriptArg::F32(data) => slice(8.0, data),
+            ScriptArg::F64(data) => slice(9.0, data),
+        }
+    }
+
+    fn encode_all(args: &[ScriptArg<'_>]) -> [f64; MAX_SCRIPT_ARGS * 3] {
+        assert!(
+            args.len() <= MAX_SCRIPT_ARGS,
+            "a script can be called with at most {} arguments",
+            MAX_SCRIPT_ARGS
+        );
+
+        let mut encoded = [0.0; MAX_SCRIPT_ARGS * 3];
+        for (arg, slot) in args.iter().zip(encoded.chunks_exact_mut(3)) {
+            slot.copy_from_slice(&arg.encode());
+        }
+        encoded
+    }
+}
+
+macro_rules! impl_script_arg_from {
+    ($($ty:ty => $variant:ident;)*) => {
+        $(
+            impl<'a> From<&'a [$ty]> for ScriptArg<'a> {
+                fn from(data: &'a [$ty]) -> Self {
+                    ScriptArg::$variant(data)
+                }
+            }
+
+            unsafe impl ScriptElement for $ty {}
+        )*
+    };
+}
+
+impl_script_arg_from! {
+    i8 => I8;
+    u8 => U8;
+    i16 => I16;
+    u16 => U16;
+    i32 => I32;
+    u32 => U32;
+    f32 => F32;
+    f64 => F64;
+}
+
+impl From<f64> for ScriptArg<'_> {
+    fn from(value: f64) -> Self {
+        ScriptArg::Number(value)
+    }
+}
+
+impl From<f32> for ScriptArg<'_> {
+    fn from(value: f32) -> Self {
+        ScriptArg::Number(value as f64)
+    }
+}
+
+impl From<i32> for ScriptArg<'_> {
+    fn from(value: i32) -> Self {
+        ScriptArg::Number(value as f64)
+    }
+}
+
+impl From<u32> for ScriptArg<'_> {
+    fn from(value: u32) -> Self {
+        ScriptArg::Number(value as f64)
+    }
+}
+
+impl From<bool> for ScriptArg<'_> {
+    fn from(value: bool) -> Self {
+        ScriptArg::Number(value as u8 as f64)
+    }
+}
+
+impl<'a> From<&'a JsHandle> for ScriptArg<'a> {
+    fn from(handle: &'a JsHandle) -> Self {
+        ScriptArg::Handle(handle)
+    }
+}
+
+pub(crate) fn check_args(args: &[f64]) {
+    assert!(
+        args.len() <= MAX_SCRIPT_ARGS,
+        "a script can be called with at most {} arguments",
+        MAX_SCRIPT_ARGS
+    );
+}
+
+/// The error of a script file that couldn't be loaded, with its URL.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct ScriptLoadError {
+    /// The URL of the script.
+    pub url: String,
+}
+impl Display for ScriptLoadError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        write!(f, "The script {} couldn't be loaded", self.url)
+    }
+}
+
+type OnScriptLoad = Box<dyn FnOnce(Result<(), ScriptLoadError>)>;
+
+struct ScriptLoad {
+    url: String,
+    callback: OnScriptLoad,
+}
+
+unsafe extern "C" fn script_loaded(arg: *mut c_void, ok: c_int) {
+    let ScriptLoad { url, callback } = *Box::from_raw(arg as *mut ScriptLoad);
+    callback(if ok != 0 {
+        Ok(())
+    } else {
+        Err(ScriptLoadError { url })
+    });
+}
+
+/// Starts loading and running the JS file at the given URL, and calls `callback` once it ran, or failed to load.
+/// It must be called from the main browser thread.
+///
+/// Unlike the emscripten-defined [`emscripten_async_load_script`], the callback is a closure, so that several loads can be told apart.
+///
+/// [`emscripten_async_load_script`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_async_load_script
+///
+/// # Arguments
+/// * `url` - The URL of the script.
+/// * `in_order` - If `true`, the script runs after the other scripts loaded in order are, even if it's loaded before them.
+///   Otherwise it runs as soon as it's loaded.
+/// * `callback` - The function called after the script ran, or with the error if it couldn't be loaded.
+pub fn load_script<F>(url: &str, in_order: bool, callback: F)
+where
+    F: 'static + FnOnce(Result<(), ScriptLoadError>),
+{
+    let arg = Box::into_raw(Box::new(ScriptLoad {
+        url: url.to_string(),
+        callback: Box::new(callback),
+    })) as *mut c_void;
+    with_c_str(url, |url| unsafe {
+        script_load(url, in_order as c_int, script_loaded, arg)
+    });
+}
+
+/// Starts loading all the given JS files in parallel, and calls `callback` once they all ran, with the first error if some failed to load.
+/// The scripts run in the given order if `in_order` is `true`, otherwise each one as soon as it's loaded. See [`load_script`].
+///
+/// # Examples
+/// ```rust
+/// load_scripts(&["analytics.js", "ads.js", "chat.js"], false, |result| {
+///     if let Err(err) = result {
+///         console::warn(&err.to_string());
+///     }
+///     start_integrations();
+/// });
+/// ```
+pub fn load_scripts<S, F>(urls: &[S], in_order: bool, callback: F)
+where
+    S: AsRef<str>,
+    F: 'static + FnOnce(Result<(), ScriptLoadError>),
+{
+    if urls.is_empty() {
+        callback(Ok(()));
+        return;
+    }
+
+    // The number of scripts left, the first error, and the callback.
+    let state = Rc::new(RefCell::new((urls.len(), Ok(()), Some(callback))));
+    for url in urls {
+        let state = state.clone();
+        load_script(url.as_ref(), in_order, move |result| {
+            let mut state = state.borrow_mut();
+            state.0 -= 1;
+            if let (Err(err), Ok(())) = (result, &state.1) {
+                state.1 = Err(err);
+            }
+            if state.0 == 0 {
+                let result = std::mem::replace(&mut state.1, Ok(()));
+                let callback = state.2.take();
+                drop(state);
+                if let Some(callback) = callback {
+                    callback(result);
+                }
+            }
+        });
+    }
+}
+
+/// Returns a future completing once all the given JS files ran, loading them in parallel. See [`load_scripts`].
+///
+/// # Examples
+/// ```rust
+/// spawn_local(async {
+///     load_scripts_async(&["physics-engine.js", "physics-debug.js"], true).await.unwrap();
+///     start_physics();
+/// });
+/// ```
+pub fn load_scripts_async<S>(
+    urls: &[S],
+    in_order: bool,
+) -> CallbackFuture<Result<(), ScriptLoadError>>
+where
+    S: AsRef<str>,
+{
+    callback_future(|callback| load_scripts(urls, in_order, callback))
+}
@@ -0,0 +1,224 @@
+//! Device motion and orientation sensors, sampled at the program's rate rather than the events'.
+//!
+//! The `devicemotion` and `deviceorientation` events fire 60 to 200 times per second, and the html5 callbacks call into wasm for each one.
+//! A [`Sensor`] instead has a small JS handler store the latest sample in a slot of the heap, without calling into wasm:
+//! the program reads it with [`Sensor::latest`] or [`Sensor::poll`] when it needs it, e.g. once per frame of its main loop,
+//! or has it given to a function at most at a configured rate, with [`Sensor::with_rate`].
+//!
+//! Browsers only fire these events on secure origins, and Safari on iOS only after the page called
+//! `DeviceMotionEvent.requestPermission()` from a user gesture's handler.
+
+use std::{
+    cell::Cell,
+    marker::PhantomData,
+    os::raw::{c_int, c_void},
+};
+
+extern "C" {
+    fn sensors_listen(
+        kind: c_int,
+        slot: *mut f64,
+        min_interval: f64,
+        callback: Option<unsafe extern "C" fn(arg: *mut c_void, sequence: f64)>,
+        arg: *mut c_void,
+    );
+    fn sensors_unlisten(slot: *mut f64);
+    fn sensors_is_supported(kind: c_int) -> c_int;
+}
+
+mod private {
+    pub trait Sealed {}
+}
+
+/// The sample of a sensor: a [`MotionSample`] or an [`OrientationSample`].
+pub trait SensorSample: private::Sealed + Copy + 'static {
+    #[doc(hidden)]
+    const KIND: c_int;
+    #[doc(hidden)]
+    const LEN: usize;
+    #[doc(hidden)]
+    fn from_slot(slot: &[f64]) -> Self;
+}
+
+/// A sample of the `devicemotion` event. The values the device doesn't measure are NaN.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct MotionSample {
+    /// The time of the event, in milliseconds, on the [`get_now`](crate::emscripten::get_now) clock.
+    pub timestamp: f64,
+    /// The acceleration of the device along the X, Y and Z axes, in m/s², without the gravity.
+    pub acceleration: [f64; 3],
+    /// The acceleration of the device along the X, Y and Z axes, in m/s², with the gravity.
+    pub acceleration_including_gravity: [f64; 3],
+    /// The rotation rate of the device around the Z, X and Y axes (alpha, beta and gamma), in degrees per second.
+    pub rotation_rate: [f64; 3],
+    /// The interval between the device's samples, in milliseconds.
+    pub interval: f64,
+}
+
+impl private::Sealed for MotionSample {}
+impl SensorSample for MotionSample {
+    const KIND: c_int = 0;
+    const LEN: usize = 11;
+
+    fn from_slot(slot: &[f64]) -> Self {
+        Self {
+            timestamp: slot[0],
+            acceleration: [slot[1], slot[2], slot[3]],
+            acceleration_including_gravity: [slot[4], slot[5], slot[6]],
+            rotation_rate: [slot[7], slot[8], slot[9]],
+            interval: slot[10],
+        }
+    }
+}
+
+/// A sample of the `deviceorientation` event. The angles the device doesn't measure are NaN.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct OrientationSample {
+    /// The time of the event, in milliseconds, on the [`get_now`](crate::emscripten::get_now) clock.
+    pub timestamp: f64,
+    /// The rotation of the device around its Z axis, from 0 to 360 degrees.
+    pub alpha: f64,
+    /// The rotation of the device around its X axis, from -180 to 180 degrees.
+    pub beta: f64,
+    /// The rotation of the device around its Y axis, from -90 to 90 degrees.
+    pub gamma: f64,
+    /// Whether the angles are relative to the Earth's frame, rather than to an arbitrary one.
+    pub absolute: bool,
+}
+
+impl private::Sealed for OrientationSample {}
+impl SensorSample for OrientationSample {
+    const KIND: c_int = 1;
+    const LEN: usize = 5;
+
+    fn from_slot(slot: &[f64]) -> Self {
+        Self {
+            timestamp: slot[0],
+            alpha: slot[1],
+            beta: slot[2],
+            gamma: slot[3],
+            absolute: slot[4] != 0.0,
+        }
+    }
+}
+
+type OnSample<T> = Box<dyn FnMut(T)>;
+
+// The slot written by the JS code: the sequence number of the latest sample, then the sample.
+struct SensorState<T> {
+    slot: Box<[f64]>,
+    callback: Option<OnSample<T>>,
+}
+
+unsafe extern "C" fn dispatch_trampoline<T: SensorSample>(arg: *mut c_void, _sequence: f64) {
+    let state = &mut *(arg as *mut SensorState<T>);
+    let sample = T::from_slot(&state.slot[1..]);
+    if let Some(callback) = &mut state.callback {
+        callback(sample);
+    }
+}
+
+/// A listener of the device's motion or orientation events, keeping their latest sample. Dropping it removes the listener.
+///
+/// # Examples
+/// ```rust
+/// let orientation = Sensor::<OrientationSample>::new();
+/// set_main_loop(move || {
+///     if let Some(sample) = orientation.poll() {
+///         overlay.rotate(sample.alpha, sample.beta, sample.gamma);
+///     }
+///     overlay.draw();
+/// }, 0, true);
+/// ```
+#[must_use = "the listener is removed when dropped"]
+pub struct Sensor<T: SensorSample> {
+    state: *mut SensorState<T>,
+    // The sequence number of the last sample read by `poll`.
+    polled: Cell<f64>,
+    _not_send: PhantomData<*const ()>,
+}
+
+impl<T: SensorSample> Sensor<T> {
+    /// Starts listening to the events of the sensor. It must be called from the main browser thread.
+    pub fn new() -> Self {
+        Self::listen(0.0, None)
+    }
+
+    /// Starts listening to the events of the sensor, and calls `func` with their latest sample at most `rate` times per second.
+    /// It must be called from the main browser thread.
+    ///
+    /// # Examples
+    /// ```rust
+    /// let _motion = Sensor::<MotionSample>::with_rate(20.0, |sample| {
+    ///     shake_detector.push(sample.acceleration);
+    /// });
+    /// ```
+    pub fn with_rate<F>(rate: f64, func: F) -> Self
+    where
+        F: 'static + FnMut(T),
+    {
+        assert!(rate > 0.0, "the rate must be positive");
+        Self::listen(1000.0 / rate, Some(Box::new(func)))
+    }
+
+    fn listen(min_interval: f64, callback: Option<OnSample<T>>) -> Self {
+        let has_callback = callback.is_some();
+        let state = Box::into_raw(Box::new(SensorState {
+            slot: vec![0.0; 1 + T::LEN].into_boxed_slice(),
+            callback,
+        }));
+        unsafe {
+            sensors_listen(
+                T::KIND,
+                (*state).slot.as_mut_ptr(),
+                min_interval,
+                has_callback.then_some(dispatch_trampoline::<T> as _),
+                state as *mut c_void,
+            );
+        }
+        Self {
+            state,
+            polled: Cell::new(0.0),
+            _not_send: PhantomData,
+        }
+    }
+
+    /// Returns `true` if the browser has the sensor's events. Devices without the sensor may still never fire them.
+    pub fn is_supported() -> bool {
+        unsafe { sensors_is_supported(T::KIND) != 0 }
+    }
+
+    fn slot(&self) -> &[f64] {
+        unsafe { &(*self.state).slot }
+    }
+
+    /// Returns the latest sample, or `None` before the first event.
+    pub fn latest(&self) -> Option<T> {
+        let slot = self.slot();
+        (slot[0] != 0.0).then(|| T::from_slot(&slot[1..]))
+    }
+
+    /// Returns the latest sample if there was an event since the previous call, or `None` otherwise.
+    pub fn poll(&self) -> Option<T> {
+        let sequence = self.slot()[0];
+        if sequence == self.polled.replace(sequence) {
+            return None;
+        }
+        self.latest()
+    }
+}
+
+impl<T: SensorSample> Default for Sensor<T> {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl<T: SensorSample> Drop for Sensor<T> {
+    fn drop(&mut self) {
+        unsafe {
+            sensors_unlisten((*self.state).slot.as_mut_ptr());
+            drop(Box::from_raw(self.state));
+        }
+    }
+}
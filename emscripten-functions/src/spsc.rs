@@ -0,0 +1,372 @@
+//! A lock-free single-producer single-consumer ring buffer in shared memory, for handing data between threads,
+//! e.g. from the game loop to an audio worklet or from a worker to the main thread.
+//!
+//! Both sides have non-blocking operations, that never wait nor allocate, for real-time threads like the audio one.
+//! The blocking ones wait with [`futex_wait`], which busy-waits on the main browser thread
+//! (where `Atomics.wait` isn't allowed), and the other side only wakes a waiter up when there's one.
+
+use std::{
+    cell::UnsafeCell,
+    mem::MaybeUninit,
+    sync::{
+        atomic::{fence, AtomicU32, Ordering},
+        Arc,
+    },
+};
+
+use crate::{
+    emscripten::get_now,
+    threading::{futex_wait, futex_wake},
+};
+
+// Keeps each index on its own cache line, so that the producer and the consumer don't invalidate each other's cache.
+#[repr(align(64))]
+struct CachePadded<T>(T);
+
+// `read` and `write` only grow (wrapping): the slots between them hold values, owned by the consumer, and the others are the producer's.
+// The capacity is a power of two, so that the indexes wrap around it consistently.
+struct Shared<T> {
+    write: CachePadded<AtomicU32>,
+    read: CachePadded<AtomicU32>,
+    // Set while the consumer waits for a value, or the producer for a free slot, so that the other side knows to wake it up.
+    consumer_waiting: CachePadded<AtomicU32>,
+    producer_waiting: CachePadded<AtomicU32>,
+    slots: Box<[UnsafeCell<MaybeUninit<T>>]>,
+}
+
+unsafe impl<T: Send> Sync for Shared<T> {}
+unsafe impl<T: Send> Send for Shared<T> {}
+
+impl<T> Shared<T> {
+    fn mask(&self) -> u32 {
+        self.slots.len() as u32 - 1
+    }
+
+    fn slot(&self, index: u32) -> *mut MaybeUninit<T> {
+        self.slots[(index & self.mask()) as usize].get()
+    }
+}
+
+impl<T> Drop for Shared<T> {
+    fn drop(&mut self) {
+        let write = *self.write.0.get_mut();
+        let mut read = *self.read.0.get_mut();
+        while read != write {
+            unsafe { (*self.slot(read)).assume_init_drop() };
+            read = read.wrapping_add(1);
+        }
+    }
+}
+
+// Waits until `index` isn't `value` anymore, or `timeout_ms` passed. `waiting` is set during the wait.
+fn wait(index: &AtomicU32, waiting: &AtomicU32, value: u32, timeout_ms: f64) {
+    waiting.store(1, Ordering::SeqCst);
+    // Checked again after setting the flag: the other side may have moved the index before seeing it.
+    if index.load(Ordering::SeqCst) == value {
+        let _ = futex_wait(index, value, timeout_ms);
+    }
+    waiting.store(0, Ordering::SeqCst);
+}
+
+fn wake(index: &AtomicU32, waiting: &AtomicU32) {
+    // Orders the index update before reading the flag, pairing with the flag store and index load in `wait`.
+    fence(Ordering::SeqCst);
+    if waiting.load(Ordering::SeqCst) != 0 {
+        futex_wake(index, 1);
+    }
+}
+
+/// The sending side of a [`channel`].
+pub struct Producer<T> {
+    shared: Arc<Shared<T>>,
+}
+
+/// The receiving side of a [`channel`].
+pub struct Consumer<T> {
+    shared: Arc<Shared<T>>,
+}
+
+/// Creates a ring buffer holding at least `capacity` values, rounded up to a power of two.
+///
+/// # Examples
+/// ```rust
+/// let (mut producer, mut consumer) = channel::<Job>(64);
+///
+/// std::thread::spawn(move || {
+///     // Blocks until a job comes, or 100 milliseconds passed.
+///     while let Some(job) = consumer.pop_blocking(100.0) {
+///         job.run();
+///     }
+/// });
+///
+/// producer.try_push(Job::new()).ok();
+/// ```
+pub fn channel<T: Send>(capacity: usize) -> (Producer<T>, Consumer<T>) {
+    assert!(
+        capacity > 0 && capacity <= 1 << 31,
+        "the capacity must be between 1 and 2^31"
+    );
+
+    let shared = Arc::new(Shared {
+        write: CachePadded(AtomicU32::new(0)),
+        read: CachePadded(AtomicU32::new(0)),
+        consumer_waiting: CachePadded(AtomicU32::new(0)),
+        producer_waiting: CachePadded(AtomicU32::new(0)),
+        slots: (0..capacity.next_power_of_two())
+            .map(|_| UnsafeCell::new(MaybeUninit::uninit()))
+            .collect(),
+    });
+    (
+        Producer {
+            shared: shared.clone(),
+        },
+        Consumer { shared },
+    )
+}
+
+impl<T: Send> Producer<T> {
+    /// Queues the value if there's room for it, or gives it back. It never blocks.
+    pub fn try_push(&mut self, value: T) -> Result<(), T> {
+        let shared = &*self.shared;
+        let write = shared.write.0.load(Ordering::Relaxed);
+        let read = shared.read.0.load(Ordering::Acquire);
+        if write.wrapping_sub(read) as usize == shared.slots.len() {
+            return Err(value);
+        }
+
+        unsafe { (*shared.slot(write)).write(value) };
+        shared
+            .write
+            .0
+            .store(write.wrapping_add(1), Ordering::Release);
+        wake(&shared.write.0, &shared.consumer_waiting.0);
+        Ok(())
+    }
+
+    /// Queues the value, waiting up to `timeout_ms` milliseconds for room if the buffer is full.
+    /// Gives the value back if there's still no room after that.
+    pub fn push_blocking(&mut self, mut value: T, timeout_ms: f64) -> Result<(), T> {
+        let deadline = get_now() + timeout_ms;
+        loop {
+            // Read before trying, so that a value taken in between ends the wait right away.
+            let read = self.shared.read.0.load(Ordering::Acquire);
+            match self.try_push(value) {
+                Err(rejected) => value = rejected,
+                ok => return ok,
+            }
+
+            // The wait can also end early, e.g. on a wake of another futex user of the address.
+            let left = deadline - get_now();
+            if left <= 0.0 {
+                return Err(value);
+            }
+            wait(
+                &self.shared.read.0,
+                &self.shared.producer_waiting.0,
+                read,
+                left,
+            );
+        }
+    }
+
+    /// Returns the number of values that can be queued right now.
+    pub fn free_len(&self) -> usize {
+        let shared = &*self.shared;
+        let used = shared
+            .write
+            .0
+            .load(Ordering::Relaxed)
+            .wrapping_sub(shared.read.0.load(Ordering::Acquire));
+        shared.slots.len() - used as usize
+    }
+
+    /// Returns the number of values the buffer holds.
+    pub fn capacity(&self) -> usize {
+        self.shared.slots.len()
+    }
+}
+
+impl<T: Send + Copy> Producer<T> {
+    /// Queues as many of the given values as fit, and returns how many were queued. It never blocks.
+    ///
+    /// The values are published all at once, which is cheaper than pushing them one by one, e.g. for audio samples.
+    pub fn push_slice(&mut self, values: &[T]) -> usize {
+        let shared = &*self.shared;
+        let write = shared.write.0.load(Ordering::Relaxed);
+        let count = values.len().min(self.free_len());
+
+        for (i, value) in values[..count].iter().enumerate() {
+            unsafe { (*shared.slot(write.wrapping_add(i as u32))).write(*value) };
+        }
+        shared
+            .write
+            .0
+            .store(write.wrapping_add(count as u32), Ordering::Release);
+        if count > 0 {
+            wake(&shared.write.0, &shared.consumer_waiting.0);
+        }
+        count
+    }
+}
+
+impl<T: Send> Consumer<T> {
+    /// Takes the oldest queued value, if any. It never blocks.
+    pub fn try_pop(&mut self) -> Option<T> {
+        let shared = &*self.shared;
+        let read = shared.read.0.load(Ordering::Relaxed);
+        let write = shared.write.0.load(Ordering::Acquire);
+        if read == write {
+            return None;
+        }
+
+        let value = unsafe { (*shared.slot(read)).assume_init_read() };
+        shared.read.0.store(read.wrapping_add(1), Ordering::Release);
+        wake(&shared.read.0, &shared.producer_waiting.0);
+        Some(value)
+    }
+
+    /// Takes the oldest queued value, waiting up to `timeout_ms` milliseconds for one if the buffer is empty.
+    pub fn pop_blocking(&mut self, timeout_ms: f64) -> Option<T> {
+        let deadline = get_now() + timeout_ms;
+        loop {
+            // Read before trying, so that a value queued in between ends the wait right away.
+            let write = self.shared.write.0.load(Ordering::Acquire);
+            if let Some(value) = self.try_pop() {
+                return Some(value);
+            }
+
+            let left = deadline - get_now();
+            if left <= 0.0 {
+                return None;
+            }
+            wait(
+                &self.shared.write.0,
+                &self.shared.consumer_waiting.0,
+                write,
+                left,
+            );
+        }
+    }
+
+    /// Returns the number of queued values.
+    pub fn len(&self) -> usize {
+        let shared = &*self.shared;
+        shared
+            .write
+            .0
+            .load(Ordering::Acquire)
+            .wrapping_sub(shared.read.0.load(Ordering::Relaxed)) as usize
+    }
+
+    /// Returns `true` if no values are queued.
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// Returns `true` if the [`Producer`] was dropped, e.g. with its thread. The values it queued can still be taken.
+    pub fn is_abandoned(&self) -> bool {
+        Arc::strong_count(&self.shared) == 1
+    }
+}
+
+impl<T: Send + Copy> Consumer<T> {
+    /// Takes as many queued values as fit in `values`, and returns how many were taken. It never blocks.
+    pub fn pop_slice(&mut self, values: &mut [T]) -> usize {
+        let shared = &*self.shared;
+        let read = shared.read.0.load(Ordering::Relaxed);
+        let count = values.len().min(self.len());
+
+        for (i, value) in values[..count].iter_mut().enumerate() {
+            *value = unsafe { (*shared.slot(read.wrapping_add(i as u32))).assume_init_read() };
+        }
+        shared
+            .read
+            .0
+            .store(read.wrapping_add(count as u32), Ordering::Release);
+        if count > 0 {
+            wake(&shared.read.0, &shared.producer_waiting.0);
+        }
+        count
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn indexes_wrap_around_the_capacity() {
+        let (mut producer, mut consumer) = channel::<u32>(4);
+
+        for round in 0..10 {
+            for i in 0..3 {
+                producer.try_push(round * 3 + i).unwrap();
+            }
+            for i in 0..3 {
+                assert_eq!(consumer.try_pop(), Some(round * 3 + i));
+            }
+        }
+
+        // The slices are split across the end of the slots.
+        let mut values = [0; 4];
+        assert_eq!(producer.push_slice(&[1, 2, 3, 4]), 4);
+        assert_eq!(consumer.pop_slice(&mut values), 4);
+        assert_eq!(values, [1, 2, 3, 4]);
+    }
+
+    #[test]
+    fn full_and_empty_buffers_give_values_back() {
+        // Rounded up to 4.
+        let (mut producer, mut consumer) = channel::<u32>(3);
+        assert_eq!(producer.capacity(), 4);
+        assert_eq!(consumer.try_pop(), None);
+        assert!(consumer.is_empty());
+
+        for i in 0..4 {
+            producer.try_push(i).unwrap();
+        }
+        assert_eq!(producer.try_push(4), Err(4));
+        assert_eq!(producer.free_len(), 0);
+        assert_eq!(consumer.len(), 4);
+        assert_eq!(producer.push_slice(&[5, 6]), 0);
+
+        for i in 0..4 {
+            assert_eq!(consumer.try_pop(), Some(i));
+        }
+        assert_eq!(consumer.try_pop(), None);
+        assert_eq!(producer.free_len(), 4);
+    }
+
+    #[test]
+    fn unconsumed_values_are_dropped_with_the_buffer() {
+        let value = Arc::new(());
+        let (mut producer, mut consumer) = channel(4);
+        for _ in 0..3 {
+            producer.try_push(value.clone()).unwrap();
+        }
+        drop(consumer.try_pop());
+
+        drop(producer);
+        assert!(consumer.is_abandoned());
+        assert_eq!(Arc::strong_count(&value), 3);
+        drop(consumer);
+        assert_eq!(Arc::strong_count(&value), 1);
+    }
+
+    #[test]
+    fn blocking_operations_time_out() {
+        let (mut producer, mut consumer) = channel::<u32>(1);
+
+        let start = get_now();
+        assert_eq!(consumer.pop_blocking(20.0), None);
+        assert!(get_now() - start >= 20.0);
+
+        producer.try_push(1).unwrap();
+        let start = get_now();
+        assert_eq!(producer.push_blocking(2, 20.0), Err(2));
+        assert!(get_now() - start >= 20.0);
+
+        assert_eq!(consumer.pop_blocking(20.0), Some(1));
+        assert_eq!(producer.push_blocking(2, 20.0), Ok(()));
+    }
+}
@@ -0,0 +1,122 @@
+//! Usage of the calling thread's wasm data stack, over the emscripten `stack.h` header file.
+//!
+//! The stack of each pthread and Wasm Worker is allocated upfront with the size it was created with, so oversized stacks
+//! multiply the memory of a thread pool. [`paint`] and [`high_water_mark`] measure how much of it a thread actually uses,
+//! to size the stacks from data.
+//!
+//! The data stack only holds what doesn't fit wasm locals, such as arrays and the values whose address is taken;
+//! the wasm call stack itself is managed by the engine.
+
+use std::cell::Cell;
+
+use emscripten_functions_sys::stack;
+
+// The bytes the unused part of the stack is filled with by `paint`.
+const PAINT: u32 = 0xdead_beef;
+// The bytes below the stack pointer left unpainted, for the stack frames of `paint` itself.
+const PAINT_MARGIN: usize = 1024;
+// The bytes past the end of the stack where emscripten writes its stack overflow cookie, left unpainted.
+const STACK_COOKIE_BYTES: usize = 16;
+
+// The lowest address painted, past the stack cookie, keeping the 16-byte alignment of the stack's end.
+fn painted_end() -> usize {
+    end().next_multiple_of(16) + STACK_COOKIE_BYTES
+}
+
+thread_local! {
+    // Whether the stack of the thread was painted.
+    static PAINTED: Cell<bool> = const { Cell::new(false) };
+}
+
+/// The usage of a thread's stack, returned by [`usage`], in bytes.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct StackUsage {
+    /// The size of the stack.
+    pub size: usize,
+    /// The part of the stack in use.
+    pub used: usize,
+    /// The most of the stack used since it was painted, if it was, as returned by [`high_water_mark`].
+    pub peak: Option<usize>,
+}
+
+/// Returns the address the stack starts at, the highest one as the stack grows down, using the emscripten-defined `emscripten_stack_get_base`.
+pub fn base() -> usize {
+    unsafe { stack::emscripten_stack_get_base() }
+}
+
+/// Returns the address the stack ends at, the lowest one, using the emscripten-defined `emscripten_stack_get_end`.
+pub fn end() -> usize {
+    unsafe { stack::emscripten_stack_get_end() }
+}
+
+/// Returns the stack pointer, using the emscripten-defined `emscripten_stack_get_current`.
+pub fn current() -> usize {
+    unsafe { stack::emscripten_stack_get_current() }
+}
+
+/// Returns the number of bytes left on the stack, using the emscripten-defined `emscripten_stack_get_free`.
+/// It's fast enough to be checked before deep recursions.
+pub fn free() -> usize {
+    unsafe { stack::emscripten_stack_get_free() }
+}
+
+/// Returns the size of the stack in bytes.
+pub fn size() -> usize {
+    base() - end()
+}
+
+/// Fills the unused part of the calling thread's stack with a pattern, so that [`high_water_mark`] can later find how far it was used.
+///
+/// It's meant to be called once at the start of a thread, as it writes the whole free stack.
+/// The first 16 bytes past the end of the stack are left alone: emscripten keeps its stack overflow cookie there,
+/// which `-sSTACK_OVERFLOW_CHECK` builds check.
+///
+/// # Examples
+/// ```rust
+/// std::thread::Builder::new()
+///     .stack_size(5 * 1024 * 1024)
+///     .spawn(|| {
+///         stack::paint();
+///         run_jobs();
+///         console::log(&format!("Stack peak: {:?}", stack::high_water_mark()));
+///     })
+///     .unwrap();
+/// ```
+#[inline(never)]
+pub fn paint() {
+    let top = current().saturating_sub(PAINT_MARGIN) & !3;
+    let mut address = painted_end();
+    while address < top {
+        unsafe { (address as *mut u32).write_volatile(PAINT) };
+        address += 4;
+    }
+    PAINTED.with(|painted| painted.set(true));
+}
+
+/// Returns the most of the calling thread's stack used since [`paint`] was called on it, in bytes, or `None` if it wasn't.
+///
+/// It scans the stack from its end, until reaching bytes that aren't the painted pattern.
+/// The result is rounded to 4 bytes, and can be a bit low if the deepest frames happened to leave the pattern unchanged.
+pub fn high_water_mark() -> Option<usize> {
+    if !PAINTED.with(Cell::get) {
+        return None;
+    }
+
+    let base = base();
+    let top = current() & !3;
+    let mut address = painted_end();
+    while address < top && unsafe { (address as *const u32).read_volatile() } == PAINT {
+        address += 4;
+    }
+    Some(base - address)
+}
+
+/// Returns the usage of the calling thread's stack.
+pub fn usage() -> StackUsage {
+    let base = base();
+    StackUsage {
+        size: base - end(),
+        used: base - current(),
+        peak: high_water_mark(),
+    }
+}
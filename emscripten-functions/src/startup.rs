@@ -0,0 +1,175 @@
+//! The timeline of the program's startup, from the download of the wasm file to the first presented frame,
+//! read with the emscripten-defined [`emscripten_performance_now`] and mirrored as User Timing marks.
+//!
+//! The phases are recorded:
+//! - [`Phase::RuntimeInit`], automatically, when the wasm module's constructors run, right after it was compiled and instantiated;
+//! - [`Phase::MainEntry`] and [`Phase::PreloadComplete`], by the program, with [`mark`];
+//! - [`Phase::FirstTick`], automatically, at the start of the first tick of the main loop set with [`set_main_loop_with_arg`] or [`set_main_loop`];
+//! - [`Phase::FirstFrame`], automatically, at the animation frame following the first tick, once the browser presented its rendering.
+//!
+//! Each mark is also added with `performance.mark()`, named like `startup:first-tick`, so the browser's performance panel shows it.
+//! [`timeline`] returns them with the download of the wasm file, from the resource timing entries,
+//! which tells how the time to interactive splits between the download, the compilation, the initialization and the asset loading.
+//!
+//! The times are in milliseconds since the page navigation started. The phases are recorded on the main browser thread.
+//!
+//! [`emscripten_performance_now`]: https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_performance_now
+//! [`set_main_loop_with_arg`]: crate::emscripten::set_main_loop_with_arg
+//! [`set_main_loop`]: crate::emscripten::set_main_loop
+
+use std::{
+    os::raw::{c_char, c_int, c_void},
+    sync::atomic::{AtomicU64, Ordering},
+};
+
+use emscripten_functions_sys::html5;
+
+extern "C" {
+    fn startup_mark(name: *const c_char, time: f64);
+    fn startup_wasm_download(times: *mut f64);
+}
+
+/// A phase of the startup, recorded once.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Phase {
+    /// The wasm module was compiled and instantiated, and its constructors run.
+    RuntimeInit,
+    /// The program's `main` function started.
+    MainEntry,
+    /// The program's assets needed to start were loaded.
+    PreloadComplete,
+    /// The first main loop tick started.
+    FirstTick,
+    /// The frame rendered by the first main loop tick was presented.
+    FirstFrame,
+}
+
+impl Phase {
+    // The User Timing mark name of the phase, NUL-terminated.
+    fn mark_name(self) -> &'static [u8] {
+        match self {
+            Phase::RuntimeInit => b"startup:runtime-init\0",
+            Phase::MainEntry => b"startup:main-entry\0",
+            Phase::PreloadComplete => b"startup:preload-complete\0",
+            Phase::FirstTick => b"startup:first-tick\0",
+            Phase::FirstFrame => b"startup:first-frame\0",
+        }
+    }
+}
+
+// The recorded times, as `f64` bits; NaN until recorded, with the bits of `f64::NAN`.
+const UNSET: u64 = 0x7ff8_0000_0000_0000;
+static TIMES: [AtomicU64; 5] = [const { AtomicU64::new(UNSET) }; 5];
+
+fn now() -> f64 {
+    unsafe { html5::emscripten_performance_now() }
+}
+
+fn get(phase: Phase) -> Option<f64> {
+    let time = f64::from_bits(TIMES[phase as usize].load(Ordering::Relaxed));
+    (!time.is_nan()).then_some(time)
+}
+
+// Records the phase at the given time if it wasn't yet, and returns `true` if it did.
+fn record(phase: Phase, time: f64) -> bool {
+    let recorded = TIMES[phase as usize]
+        .compare_exchange(UNSET, time.to_bits(), Ordering::Relaxed, Ordering::Relaxed)
+        .is_ok();
+    if recorded {
+        unsafe { startup_mark(phase.mark_name().as_ptr() as *const c_char, time) };
+    }
+    recorded
+}
+
+/// Records the given phase now, if it wasn't recorded yet, and returns `true` if it was.
+///
+/// # Examples
+/// ```rust
+/// // At the start of `main`.
+/// startup::mark(Phase::MainEntry);
+/// load_assets(|| {
+///     startup::mark(Phase::PreloadComplete);
+///     set_main_loop(frame, 0, true);
+/// });
+/// ```
+pub fn mark(phase: Phase) -> bool {
+    record(phase, now())
+}
+
+// Runs with the wasm module's constructors, as part of `__wasm_call_ctors`, when the runtime initializes.
+extern "C" fn record_runtime_init() {
+    record(Phase::RuntimeInit, now());
+}
+
+#[used]
+#[link_section = ".init_array"]
+static RUNTIME_INIT: extern "C" fn() = record_runtime_init;
+
+unsafe extern "C" fn first_frame_callback(time: f64, _user_data: *mut c_void) -> c_int {
+    record(Phase::FirstFrame, time);
+    0
+}
+
+// Records the first tick, and requests the animation frame after it; only compares a time after that.
+pub(crate) fn tick_started() {
+    if get(Phase::FirstTick).is_some() {
+        return;
+    }
+    if record(Phase::FirstTick, now()) {
+        unsafe {
+            html5::emscripten_request_animation_frame(
+                Some(first_frame_callback),
+                std::ptr::null_mut(),
+            );
+        }
+    }
+}
+
+/// The times of the startup phases, returned by [`timeline`], in milliseconds since the navigation started.
+/// The ones that weren't reached or recorded are `None`.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct StartupTimeline {
+    /// The start of the download of the wasm file.
+    pub wasm_download_start: Option<f64>,
+    /// The end of the download of the wasm file. With streaming compilation, the compilation overlaps with the download.
+    pub wasm_download_end: Option<f64>,
+    /// See [`Phase::RuntimeInit`].
+    pub runtime_init: Option<f64>,
+    /// See [`Phase::MainEntry`].
+    pub main_entry: Option<f64>,
+    /// See [`Phase::PreloadComplete`].
+    pub preload_complete: Option<f64>,
+    /// See [`Phase::FirstTick`].
+    pub first_tick: Option<f64>,
+    /// See [`Phase::FirstFrame`].
+    pub first_frame: Option<f64>,
+}
+
+impl StartupTimeline {
+    /// Returns the time from the end of the wasm download to the runtime initialization, mostly compilation and instantiation.
+    pub fn compile_duration(&self) -> Option<f64> {
+        Some(self.runtime_init? - self.wasm_download_end?)
+    }
+
+    /// Returns the time from the `main` entry to the completion of the preload.
+    pub fn preload_duration(&self) -> Option<f64> {
+        Some(self.preload_complete? - self.main_entry?)
+    }
+}
+
+/// Returns the times of the startup phases recorded so far, with the download of the wasm file.
+pub fn timeline() -> StartupTimeline {
+    let mut download = [0.0; 2];
+    unsafe { startup_wasm_download(download.as_mut_ptr()) };
+    let download = download.map(|time| (time >= 0.0).then_some(time));
+
+    StartupTimeline {
+        wasm_download_start: download[0],
+        wasm_download_end: download[1],
+        runtime_init: get(Phase::RuntimeInit),
+        main_entry: get(Phase::MainEntry),
+        preload_complete: get(Phase::PreloadComplete),
+        first_tick: get(Phase::FirstTick),
+        first_frame: get(Phase::FirstFrame),
+    }
+}
@@ -0,0 +1,145 @@
+//! The origin's storage quota and persistence, from the browser's [Storage API].
+//!
+//! IndexedDB and the Origin Private File System share a quota per origin, and their data is "best-effort" by default:
+//! the browser may evict all of it at once under storage pressure. [`estimate`] tells how much is used and available,
+//! to size the caches, e.g. with [`AssetCache::with_quota`], and [`persist`] asks the browser to keep the data.
+//!
+//! [Storage API]: https://developer.mozilla.org/en-US/docs/Web/API/Storage_API
+//! [`AssetCache::with_quota`]: crate::asset_cache::AssetCache::with_quota
+
+use std::{
+    fmt::Display,
+    os::raw::{c_int, c_void},
+};
+
+use crate::executor::{callback_future, CallbackFuture};
+
+extern "C" {
+    fn storage_estimate(
+        callback: unsafe extern "C" fn(*mut c_void, c_int, f64, f64),
+        arg: *mut c_void,
+    );
+    fn storage_persist(
+        request: c_int,
+        callback: unsafe extern "C" fn(*mut c_void, c_int),
+        arg: *mut c_void,
+    );
+}
+
+/// The error of an [`estimate`] that the browser couldn't give, e.g. because it lacks the Storage API.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct StorageError;
+impl Display for StorageError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        write!(f, "The storage estimate is unavailable")
+    }
+}
+
+/// The storage used by the origin, and its quota, as estimated by the browser.
+///
+/// Browsers round the values, and pad the usage of opaque responses, so they're only estimates.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct StorageEstimate {
+    /// The bytes used by the origin.
+    pub usage: u64,
+    /// The bytes the origin may use.
+    pub quota: u64,
+}
+
+impl StorageEstimate {
+    /// Returns the bytes the origin may still use.
+    pub fn available(&self) -> u64 {
+        self.quota.saturating_sub(self.usage)
+    }
+
+    /// Returns the given fraction of the quota, e.g. as the byte budget of a cache.
+    pub fn fraction_of_quota(&self, fraction: f64) -> u64 {
+        (self.quota as f64 * fraction.clamp(0.0, 1.0)) as u64
+    }
+}
+
+type OnEstimate = Box<dyn FnOnce(Result<StorageEstimate, StorageError>)>;
+type OnPersist = Box<dyn FnOnce(bool)>;
+
+unsafe extern "C" fn estimated(arg: *mut c_void, ok: c_int, usage: f64, quota: f64) {
+    let callback = Box::from_raw(arg as *mut OnEstimate);
+    callback(if ok != 0 {
+        Ok(StorageEstimate {
+            usage: usage as u64,
+            quota: quota as u64,
+        })
+    } else {
+        Err(StorageError)
+    });
+}
+
+unsafe extern "C" fn persisted_trampoline(arg: *mut c_void, persisted: c_int) {
+    let callback = Box::from_raw(arg as *mut OnPersist);
+    callback(persisted != 0);
+}
+
+/// Calls `callback` with the origin's storage usage and quota, from [`navigator.storage.estimate()`].
+///
+/// [`navigator.storage.estimate()`]: https://developer.mozilla.org/en-US/docs/Web/API/StorageManager/estimate
+///
+/// # Examples
+/// ```rust
+/// estimate(|estimate| {
+///     if let Ok(estimate) = estimate {
+///         println!("{} of {} bytes used", estimate.usage, estimate.quota);
+///     }
+/// });
+/// ```
+pub fn estimate<F>(callback: F)
+where
+    F: 'static + FnOnce(Result<StorageEstimate, StorageError>),
+{
+    let callback: OnEstimate = Box::new(callback);
+    unsafe { storage_estimate(estimated, Box::into_raw(Box::new(callback)) as *mut c_void) };
+}
+
+/// Returns a future completing with the origin's storage usage and quota. See [`estimate`].
+pub fn estimate_async() -> CallbackFuture<Result<StorageEstimate, StorageError>> {
+    callback_future(estimate)
+}
+
+/// Asks the browser to make the origin's storage persistent, with [`navigator.storage.persist()`], so that it isn't evicted under storage pressure,
+/// and calls `callback` with `true` if it is.
+///
+/// Browsers grant it depending on how the page is used (e.g. installed or bookmarked), and some may prompt the user:
+/// call it after a user gesture, e.g. when enabling offline play.
+///
+/// [`navigator.storage.persist()`]: https://developer.mozilla.org/en-US/docs/Web/API/StorageManager/persist
+pub fn persist<F>(callback: F)
+where
+    F: 'static + FnOnce(bool),
+{
+    let callback: OnPersist = Box::new(callback);
+    unsafe {
+        storage_persist(
+            1,
+            persisted_trampoline,
+            Box::into_raw(Box::new(callback)) as *mut c_void,
+        )
+    };
+}
+
+/// Returns a future completing with `true` if the origin's storage was made persistent. See [`persist`].
+pub fn persist_async() -> CallbackFuture<bool> {
+    callback_future(persist)
+}
+
+/// Calls `callback` with `true` if the origin's storage is already persistent, without asking for it.
+pub fn is_persisted<F>(callback: F)
+where
+    F: 'static + FnOnce(bool),
+{
+    let callback: OnPersist = Box::new(callback);
+    unsafe {
+        storage_persist(
+            0,
+            persisted_trampoline,
+            Box::into_raw(Box::new(callback)) as *mut c_void,
+        )
+    };
+}
@@ -0,0 +1,224 @@
+//! Structured logging over the emscripten-defined [`emscripten_log`], with per-call-site rate limiting and sampled call stacks.
+//!
+//! `emscripten_log` can append the call stack to a message, but walking it is far more costly than printing the message.
+//! Each [`em_log!`](crate::em_log) call site has its own [`CallSite`] state instead, following a [`LogPolicy`]:
+//! it prints at most [`LogPolicy::max_per_second`] messages per second, and captures the stack for one printed message in [`LogPolicy::stack_every`].
+//! The messages dropped by the rate limit are counted, and the count is printed with the next message of the site.
+//!
+//! The messages are followed by their `key=value` fields, formatted with [`Debug`](std::fmt::Debug).
+//!
+//! [`emscripten_log`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_log
+
+use std::{
+    cell::RefCell,
+    fmt::{self, Debug, Write},
+    os::raw::{c_char, c_int},
+    sync::atomic::{AtomicU32, Ordering},
+};
+
+use emscripten_functions_sys::emscripten;
+
+use crate::{clock::frame_time, console::Level};
+
+/// The rate limit and stack sampling of a call site.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct LogPolicy {
+    /// The most messages printed per second, or 0 for no limit.
+    pub max_per_second: u32,
+    /// Captures the stack for one printed message in this many, or never if 0. 1 captures it for all of them.
+    pub stack_every: u32,
+    /// The `EM_LOG_*` flags the sampled stacks are captured with.
+    pub stack_flags: u32,
+}
+
+impl LogPolicy {
+    /// The policy of [`em_log!`](crate::em_log): 10 messages per second, with the wasm call stack of one in 100.
+    pub const DEFAULT: LogPolicy = LogPolicy {
+        max_per_second: 10,
+        stack_every: 100,
+        stack_flags: emscripten::EM_LOG_C_STACK | emscripten::EM_LOG_NO_PATHS,
+    };
+
+    /// A policy printing every message, without stacks.
+    pub const UNLIMITED: LogPolicy = LogPolicy {
+        max_per_second: 0,
+        stack_every: 0,
+        stack_flags: 0,
+    };
+}
+
+impl Default for LogPolicy {
+    fn default() -> Self {
+        Self::DEFAULT
+    }
+}
+
+/// The state of an [`em_log!`](crate::em_log) call site, shared by all the threads.
+#[derive(Debug)]
+pub struct CallSite {
+    policy: LogPolicy,
+    // The second of the current rate limit window, and the messages printed and dropped during it.
+    window: AtomicU32,
+    printed_in_window: AtomicU32,
+    suppressed: AtomicU32,
+    // The messages printed since the start, which picks the ones whose stack is captured.
+    printed: AtomicU32,
+}
+
+impl CallSite {
+    /// Creates the state of a call site following the given policy.
+    pub const fn new(policy: LogPolicy) -> Self {
+        Self {
+            policy,
+            window: AtomicU32::new(0),
+            printed_in_window: AtomicU32::new(0),
+            suppressed: AtomicU32::new(0),
+            printed: AtomicU32::new(0),
+        }
+    }
+
+    /// Returns the policy of the call site.
+    pub fn policy(&self) -> LogPolicy {
+        self.policy
+    }
+
+    /// Returns the number of messages dropped by the rate limit and not reported yet.
+    pub fn suppressed(&self) -> u32 {
+        self.suppressed.load(Ordering::Relaxed)
+    }
+
+    // Applies the rate limit, and returns whether the stack of the message gets captured, if it's printed.
+    // The time is the one of the main loop tick, so a message costs no clock reading in a frame.
+    fn admit(&self) -> Option<bool> {
+        if self.policy.max_per_second != 0 {
+            let second = (frame_time().as_millis() / 1000.0) as u32;
+            let window = self.window.load(Ordering::Relaxed);
+            if window != second
+                && self
+                    .window
+                    .compare_exchange(window, second, Ordering::Relaxed, Ordering::Relaxed)
+                    .is_ok()
+            {
+                self.printed_in_window.store(0, Ordering::Relaxed);
+            }
+            if self.printed_in_window.fetch_add(1, Ordering::Relaxed) >= self.policy.max_per_second
+            {
+                self.suppressed.fetch_add(1, Ordering::Relaxed);
+                return None;
+            }
+        }
+
+        let printed = self.printed.fetch_add(1, Ordering::Relaxed);
+        Some(self.policy.stack_every != 0 && printed % self.policy.stack_every == 0)
+    }
+
+    #[doc(hidden)]
+    pub fn __log(&self, level: Level, args: fmt::Arguments, fields: &[(&str, &dyn Debug)]) {
+        let Some(stack) = self.admit() else {
+            return;
+        };
+
+        let mut flags = emscripten::EM_LOG_CONSOLE
+            | match level {
+                Level::Error => emscripten::EM_LOG_ERROR,
+                Level::Warn => emscripten::EM_LOG_WARN,
+                Level::Info => emscripten::EM_LOG_INFO,
+                Level::Debug => emscripten::EM_LOG_DEBUG,
+            };
+        if stack {
+            flags |= self.policy.stack_flags;
+        }
+
+        let suppressed = self.suppressed.swap(0, Ordering::Relaxed);
+        let _ = MESSAGE_BUFFER.try_with(|buffer| match buffer.try_borrow_mut() {
+            Ok(mut buffer) => print(&mut buffer, flags, suppressed, args, fields),
+            // A `Debug` implementation logging while it's formatted gets its own buffer.
+            Err(_) => print(&mut String::new(), flags, suppressed, args, fields),
+        });
+    }
+}
+
+// The buffer the messages are formatted into, which keeps its capacity between messages.
+thread_local! {
+    static MESSAGE_BUFFER: RefCell<String> = const { RefCell::new(String::new()) };
+}
+
+fn print(
+    buffer: &mut String,
+    flags: u32,
+    suppressed: u32,
+    args: fmt::Arguments,
+    fields: &[(&str, &dyn Debug)],
+) {
+    buffer.clear();
+    // Writing into a `String` never fails.
+    let _ = buffer.write_fmt(args);
+    for (key, value) in fields {
+        let _ = write!(buffer, " {}={:?}", key, value);
+    }
+    if suppressed != 0 {
+        let _ = write!(buffer, " ({} more suppressed)", suppressed);
+    }
+    // The message is passed as a `%s` argument, so that its `%` characters aren't read as a format. A NUL character ends it.
+    buffer.push('\0');
+    unsafe {
+        emscripten::emscripten_log(
+            flags as c_int,
+            c"%s".as_ptr(),
+            buffer.as_ptr() as *const c_char,
+        );
+    }
+}
+
+/// Prints a message formatted like with [`format!`] at the given [`Level`](crate::console::Level), with the emscripten-defined [`emscripten_log`],
+/// following the [`LogPolicy::DEFAULT`] rate limit and stack sampling of its call site.
+///
+/// The `key: value` fields between braces, which are optional, are appended to the message as `key=value`.
+/// Like the [`log!`](crate::log) macros, the call is compiled out if the level is above [`MAX_LEVEL`](crate::console::MAX_LEVEL).
+///
+/// [`emscripten_log`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_log
+///
+/// # Examples
+/// ```rust
+/// // At most 10 per second, with the call stack of one in 100.
+/// em_log!(Level::Warn, { texture: id, frame: frame_index }, "texture upload took {:.1} ms", millis);
+/// em_log!(Level::Info, "level {} loaded", level);
+/// ```
+#[macro_export]
+macro_rules! em_log {
+    ($level:expr, { $($key:ident: $value:expr),* $(,)? }, $($arg:tt)+) => {
+        $crate::em_log_with!($crate::structured_log::LogPolicy::DEFAULT, $level, { $($key: $value),* }, $($arg)+)
+    };
+    ($level:expr, $($arg:tt)+) => {
+        $crate::em_log_with!($crate::structured_log::LogPolicy::DEFAULT, $level, {}, $($arg)+)
+    };
+}
+
+/// Prints a message like [`em_log!`](crate::em_log), following the given constant [`LogPolicy`](crate::structured_log::LogPolicy).
+///
+/// # Examples
+/// ```rust
+/// const NETWORK: LogPolicy = LogPolicy {
+///     max_per_second: 2,
+///     stack_every: 1,
+///     ..LogPolicy::DEFAULT
+/// };
+///
+/// em_log_with!(NETWORK, Level::Error, { code: status }, "request to {} failed", url);
+/// ```
+#[macro_export]
+macro_rules! em_log_with {
+    ($policy:expr, $level:expr, { $($key:ident: $value:expr),* $(,)? }, $($arg:tt)+) => {
+        if const { $crate::console::__enabled($level) } {
+            static SITE: $crate::structured_log::CallSite = $crate::structured_log::CallSite::new($policy);
+            SITE.__log(
+                $level,
+                format_args!($($arg)+),
+                &[$((stringify!($key), &$value as &dyn ::std::fmt::Debug)),*],
+            );
+        }
+    };
+    ($policy:expr, $level:expr, $($arg:tt)+) => {
+        $crate::em_log_with!($policy, $level, {}, $($arg)+)
+    };
+}
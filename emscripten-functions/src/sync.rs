@@ -0,0 +1,492 @@
+//! A [`Mutex`], a [`Condvar`] and an [`Event`] built on emscripten futexes, that are safe to wait on from the main browser thread.
+//!
+//! On workers, the blocking waits sleep in `Atomics.wait`. On the main browser thread, where it isn't allowed,
+//! they busy-wait in the emscripten-defined `emscripten_futex_wait`, which keeps running the calls proxied to the main thread:
+//! a worker waiting on a proxied call while holding the lock can't deadlock it.
+//! Busy-waiting still burns a core however, so the main thread should rather use the `_async` variants,
+//! which register an `Atomics.waitAsync` with the emscripten-defined [`emscripten_atomic_wait_async`], and return right away.
+//! [`wait_change`] does the same for any atomic, e.g. a job completion flag set by a worker, as a future.
+//!
+//! [`emscripten_atomic_wait_async`]: https://emscripten.org/docs/api_reference/wasm_workers.html
+
+use std::{
+    cell::{Cell, UnsafeCell},
+    future::Future,
+    marker::PhantomData,
+    ops::{Deref, DerefMut},
+    os::raw::{c_int, c_void},
+    pin::Pin,
+    rc::Rc,
+    sync::{
+        atomic::{AtomicU32, Ordering},
+        Arc,
+    },
+    task::{Context, Poll, Waker},
+};
+
+use emscripten_functions_sys::wasm_worker;
+
+use crate::{
+    emscripten::get_now,
+    threading::{futex_wait, futex_wake, FutexWaitError},
+};
+
+// The number of times a contended lock gets checked before waiting on it.
+const SPIN_LIMIT: u32 = 100;
+
+type AsyncWait = Box<dyn FnOnce(bool)>;
+
+unsafe extern "C" fn async_wait_trampoline(
+    _address: *mut i32,
+    _value: u32,
+    wait_result: c_int,
+    user_data: *mut c_void,
+) {
+    let callback = Box::from_raw(user_data as *mut AsyncWait);
+    callback(wait_result as u32 == wasm_worker::ATOMICS_WAIT_TIMED_OUT);
+}
+
+// Calls `callback` once `atomic` is notified or `timeout_ms` passed, with `true` in the latter case;
+// right away if it doesn't hold `value`. The callback must keep the atomic alive.
+fn wait_async<F>(atomic: &AtomicU32, value: u32, timeout_ms: f64, callback: F)
+where
+    F: 'static + FnOnce(bool),
+{
+    let callback: AsyncWait = Box::new(callback);
+    let user_data = Box::into_raw(Box::new(callback)) as *mut c_void;
+    let token = unsafe {
+        wasm_worker::emscripten_atomic_wait_async(
+            atomic.as_ptr() as *mut i32,
+            value,
+            Some(async_wait_trampoline),
+            user_data,
+            timeout_ms,
+        )
+    };
+    // Valid wait tokens are non-positive: otherwise no wait was registered.
+    if token > 0 {
+        let callback = unsafe { Box::from_raw(user_data as *mut AsyncWait) };
+        callback(token as u32 == wasm_worker::ATOMICS_WAIT_TIMED_OUT);
+    }
+}
+
+// The state of a `Mutex`.
+const UNLOCKED: u32 = 0;
+const LOCKED: u32 = 1;
+// Locked, with threads possibly waiting for it.
+const CONTENDED: u32 = 2;
+
+/// A mutual exclusion lock over a futex, that can also be acquired asynchronously on the main browser thread.
+///
+/// # Examples
+/// ```rust
+/// let results = Arc::new(Mutex::new(Vec::new()));
+///
+/// let worker_results = results.clone();
+/// std::thread::spawn(move || worker_results.lock().push(compute()));
+///
+/// // On the main thread, without blocking it.
+/// results.lock_async(|results| println!("{} results so far", results.len()));
+/// ```
+pub struct Mutex<T> {
+    state: AtomicU32,
+    value: UnsafeCell<T>,
+}
+
+unsafe impl<T: Send> Send for Mutex<T> {}
+unsafe impl<T: Send> Sync for Mutex<T> {}
+
+/// The lock of a [`Mutex`], released when dropped.
+pub struct MutexGuard<'a, T> {
+    mutex: &'a Mutex<T>,
+    // Like std's guard, it's neither `Send` nor automatically `Sync`: sharing it shares `&T`, so it's `Sync` only for a `Sync` `T`.
+    _not_send: PhantomData<*const ()>,
+}
+
+unsafe impl<T: Sync> Sync for MutexGuard<'_, T> {}
+
+impl<T> Mutex<T> {
+    /// Creates an unlocked mutex holding the given value.
+    pub const fn new(value: T) -> Self {
+        Self {
+            state: AtomicU32::new(UNLOCKED),
+            value: UnsafeCell::new(value),
+        }
+    }
+
+    /// Acquires the lock if it's free, without waiting.
+    pub fn try_lock(&self) -> Option<MutexGuard<'_, T>> {
+        self.state
+            .compare_exchange(UNLOCKED, LOCKED, Ordering::Acquire, Ordering::Relaxed)
+            .ok()
+            .map(|_| MutexGuard {
+                mutex: self,
+                _not_send: PhantomData,
+            })
+    }
+
+    // Marks the lock as contended, and returns `true` if that acquired it.
+    fn lock_contended(&self) -> bool {
+        self.state.swap(CONTENDED, Ordering::Acquire) == UNLOCKED
+    }
+
+    /// Acquires the lock, spinning for a while and then waiting on the futex if it's held.
+    pub fn lock(&self) -> MutexGuard<'_, T> {
+        if let Some(guard) = self.try_lock() {
+            return guard;
+        }
+
+        for _ in 0..SPIN_LIMIT {
+            std::hint::spin_loop();
+            if self.state.load(Ordering::Relaxed) == UNLOCKED {
+                if let Some(guard) = self.try_lock() {
+                    return guard;
+                }
+            }
+        }
+
+        while !self.lock_contended() {
+            let _ = futex_wait(&self.state, CONTENDED, f64::INFINITY);
+        }
+        MutexGuard {
+            mutex: self,
+            _not_send: PhantomData,
+        }
+    }
+
+    /// Returns the value, for the only owner of the mutex.
+    pub fn get_mut(&mut self) -> &mut T {
+        self.value.get_mut()
+    }
+
+    /// Consumes the mutex, and returns its value.
+    pub fn into_inner(self) -> T {
+        self.value.into_inner()
+    }
+}
+
+impl<T: 'static + Send> Mutex<T> {
+    /// Calls `callback` with the lock once it's acquired, without blocking the calling thread:
+    /// right away if the lock is free, and otherwise once it's released, from the event loop.
+    pub fn lock_async<F>(self: &Arc<Self>, callback: F)
+    where
+        F: 'static + FnOnce(MutexGuard<'_, T>),
+    {
+        if let Some(guard) = self.try_lock() {
+            callback(guard);
+            return;
+        }
+        if self.lock_contended() {
+            callback(MutexGuard {
+                mutex: self,
+                _not_send: PhantomData,
+            });
+            return;
+        }
+
+        let mutex = self.clone();
+        wait_async(&self.state, CONTENDED, f64::INFINITY, move |_| {
+            mutex.lock_async(callback)
+        });
+    }
+}
+
+impl<T: Default> Default for Mutex<T> {
+    fn default() -> Self {
+        Self::new(T::default())
+    }
+}
+
+impl<T> Deref for MutexGuard<'_, T> {
+    type Target = T;
+
+    fn deref(&self) -> &T {
+        unsafe { &*self.mutex.value.get() }
+    }
+}
+
+impl<T> DerefMut for MutexGuard<'_, T> {
+    fn deref_mut(&mut self) -> &mut T {
+        unsafe { &mut *self.mutex.value.get() }
+    }
+}
+
+impl<T> Drop for MutexGuard<'_, T> {
+    fn drop(&mut self) {
+        if self.mutex.state.swap(UNLOCKED, Ordering::Release) == CONTENDED {
+            futex_wake(&self.mutex.state, 1);
+        }
+    }
+}
+
+/// A condition variable over a futex, used with a [`Mutex`].
+///
+/// Wakeups can be spurious, so the waited condition must be checked again in a loop.
+///
+/// # Examples
+/// ```rust
+/// let queue = Mutex::new(VecDeque::new());
+/// let not_empty = Condvar::new();
+///
+/// // Consumer.
+/// let mut jobs = queue.lock();
+/// while jobs.is_empty() {
+///     jobs = not_empty.wait(jobs);
+/// }
+/// let job = jobs.pop_front();
+///
+/// // Producer.
+/// queue.lock().push_back(job);
+/// not_empty.notify_one();
+/// ```
+#[derive(Default)]
+pub struct Condvar {
+    sequence: AtomicU32,
+}
+
+impl Condvar {
+    /// Creates a condition variable.
+    pub const fn new() -> Self {
+        Self {
+            sequence: AtomicU32::new(0),
+        }
+    }
+
+    /// Releases the lock, waits for a notification, and acquires the lock again.
+    pub fn wait<'a, T>(&self, guard: MutexGuard<'a, T>) -> MutexGuard<'a, T> {
+        self.wait_timeout(guard, f64::INFINITY).0
+    }
+
+    /// Releases the lock, waits for a notification or for `timeout_ms` milliseconds, and acquires the lock again.
+    /// Also returns `true` if the timeout passed.
+    pub fn wait_timeout<'a, T>(
+        &self,
+        guard: MutexGuard<'a, T>,
+        timeout_ms: f64,
+    ) -> (MutexGuard<'a, T>, bool) {
+        // Read while holding the lock: a notification sent after unlocking changes it, so the wait doesn't miss it.
+        let sequence = self.sequence.load(Ordering::Relaxed);
+        let mutex = guard.mutex;
+        drop(guard);
+
+        let timed_out =
+            futex_wait(&self.sequence, sequence, timeout_ms) == Err(FutexWaitError::TimedOut);
+        (mutex.lock(), timed_out)
+    }
+
+    /// Wakes up one of the waiting threads.
+    pub fn notify_one(&self) {
+        self.sequence.fetch_add(1, Ordering::Relaxed);
+        futex_wake(&self.sequence, 1);
+    }
+
+    /// Wakes up all the waiting threads.
+    pub fn notify_all(&self) {
+        self.sequence.fetch_add(1, Ordering::Relaxed);
+        futex_wake(&self.sequence, c_int::MAX);
+    }
+}
+
+/// A manual-reset event: once set, all its waits return until it's reset.
+///
+/// # Examples
+/// ```rust
+/// let done = Arc::new(Event::new());
+///
+/// let worker_done = done.clone();
+/// std::thread::spawn(move || {
+///     bake_lightmaps();
+///     worker_done.set();
+/// });
+///
+/// // The main thread keeps rendering the loading screen meanwhile.
+/// done.wait_async(f64::INFINITY, |timed_out| start_level());
+/// ```
+#[derive(Default)]
+pub struct Event {
+    state: AtomicU32,
+}
+
+impl Event {
+    /// Creates an event that isn't set.
+    pub const fn new() -> Self {
+        Self {
+            state: AtomicU32::new(0),
+        }
+    }
+
+    /// Sets the event, waking all its waiters up.
+    pub fn set(&self) {
+        if self.state.swap(1, Ordering::Release) == 0 {
+            futex_wake(&self.state, c_int::MAX);
+        }
+    }
+
+    /// Resets the event, so that the next waits block until it's set again.
+    pub fn reset(&self) {
+        self.state.store(0, Ordering::Relaxed);
+    }
+
+    /// Returns `true` if the event is set.
+    pub fn is_set(&self) -> bool {
+        self.state.load(Ordering::Acquire) != 0
+    }
+
+    /// Blocks until the event is set.
+    pub fn wait(&self) {
+        while !self.is_set() {
+            let _ = futex_wait(&self.state, 0, f64::INFINITY);
+        }
+    }
+
+    /// Blocks until the event is set, or `timeout_ms` milliseconds passed. Returns `true` if the event is set.
+    pub fn wait_timeout(&self, timeout_ms: f64) -> bool {
+        let deadline = get_now() + timeout_ms;
+        while !self.is_set() {
+            let left = deadline - get_now();
+            if left <= 0.0 {
+                return false;
+            }
+            let _ = futex_wait(&self.state, 0, left);
+        }
+        true
+    }
+
+    /// Calls `callback` once the event is set, or after `timeout_ms` milliseconds, without blocking the calling thread.
+    /// It's called right away if the event is already set, and otherwise from the event loop, with `true` if the timeout passed.
+    pub fn wait_async<F>(self: &Arc<Self>, timeout_ms: f64, callback: F)
+    where
+        F: 'static + FnOnce(bool),
+    {
+        if self.is_set() {
+            callback(false);
+            return;
+        }
+
+        let deadline = get_now() + timeout_ms;
+        let event = self.clone();
+        wait_async(&self.state, 0, timeout_ms, move |timed_out| {
+            // Notifications can also come from other futex users of the address, or from a reset right after the set.
+            let left = deadline - get_now();
+            if event.is_set() || timed_out || left <= 0.0 {
+                callback(!event.is_set());
+            } else {
+                event.wait_async(left, callback);
+            }
+        });
+    }
+}
+
+// The state of a wait registered by an `AtomicWait`, shared with its callback.
+#[derive(Default)]
+struct AtomicWaitState {
+    notified: Cell<bool>,
+    waker: Cell<Option<Waker>>,
+}
+
+unsafe extern "C" fn atomic_wait_trampoline(
+    _address: *mut i32,
+    _value: u32,
+    _wait_result: c_int,
+    user_data: *mut c_void,
+) {
+    let state = Rc::from_raw(user_data as *const AtomicWaitState);
+    state.notified.set(true);
+    if let Some(waker) = state.waker.take() {
+        waker.wake();
+    }
+}
+
+/// A future that completes with the value of an atomic once it changed, created with [`wait_change`].
+/// Dropping it cancels its wait.
+pub struct AtomicWait<'a> {
+    atomic: &'a AtomicU32,
+    value: u32,
+    state: Rc<AtomicWaitState>,
+    // The token of the registered wait, until its callback is called.
+    token: Option<i32>,
+}
+
+impl Future for AtomicWait<'_> {
+    type Output = u32;
+
+    fn poll(mut self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<u32> {
+        loop {
+            if self.state.notified.take() {
+                self.token = None;
+            }
+            let current = self.atomic.load(Ordering::Acquire);
+            if current != self.value {
+                return Poll::Ready(current);
+            }
+            self.state.waker.set(Some(cx.waker().clone()));
+            if self.token.is_some() {
+                return Poll::Pending;
+            }
+
+            // Wakeups can be spurious, so the value is checked again once woken.
+            let user_data = Rc::into_raw(self.state.clone()) as *mut c_void;
+            let token = unsafe {
+                wasm_worker::emscripten_atomic_wait_async(
+                    self.atomic.as_ptr() as *mut i32,
+                    self.value,
+                    Some(atomic_wait_trampoline),
+                    user_data,
+                    f64::INFINITY,
+                )
+            };
+            // Valid wait tokens are non-positive: otherwise the value already changed, and no wait was registered.
+            if token > 0 {
+                drop(unsafe { Rc::from_raw(user_data as *const AtomicWaitState) });
+                continue;
+            }
+            self.token = Some(token);
+            return Poll::Pending;
+        }
+    }
+}
+
+impl Drop for AtomicWait<'_> {
+    fn drop(&mut self) {
+        if let Some(token) = self.token {
+            if self.state.notified.get() {
+                return;
+            }
+            // A cancelled wait doesn't call its callback, so the state it holds is released here.
+            if unsafe { wasm_worker::emscripten_atomic_cancel_wait_async(token) } == 0 {
+                unsafe { Rc::decrement_strong_count(Rc::as_ptr(&self.state)) };
+            }
+        }
+    }
+}
+
+/// Returns a future completing with the value of `atomic` once it's different from `value`, without blocking the calling thread
+/// or polling the atomic: it waits with `Atomics.waitAsync`, using the emscripten-defined [`emscripten_atomic_wait_async`].
+/// It completes right away if the atomic already changed.
+///
+/// The thread changing the atomic must wake its waiters up, with [`futex_wake`]. A timeout is added with [`timeout`](crate::executor::timeout).
+///
+/// [`emscripten_atomic_wait_async`]: https://emscripten.org/docs/api_reference/wasm_workers.html
+///
+/// # Examples
+/// ```rust
+/// static DONE: AtomicU32 = AtomicU32::new(0);
+///
+/// // On a worker.
+/// DONE.store(1, Ordering::Release);
+/// futex_wake(&DONE, c_int::MAX);
+///
+/// // On the main thread, which keeps running its main loop meanwhile.
+/// spawn_local(async {
+///     wait_change(&DONE, 0).await;
+///     show_results();
+/// });
+/// ```
+pub fn wait_change(atomic: &AtomicU32, value: u32) -> AtomicWait<'_> {
+    AtomicWait {
+        atomic,
+        value,
+        state: Rc::new(AtomicWaitState::default()),
+        token: None,
+    }
+}
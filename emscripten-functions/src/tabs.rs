@@ -0,0 +1,161 @@
+//! Coordination between the tabs of the same origin, with the browser's [Web Locks] and [`BroadcastChannel`].
+//!
+//! A lock requested with [`request_lock`] is held by a single tab (or worker) of the origin at a time: the others wait
+//! for it, e.g. so that a single tab downloads an asset that all of them need. A [`BroadcastChannel`] sends messages
+//! to the other tabs listening on the channel of the same name, e.g. to tell them the asset was stored.
+//!
+//! [Web Locks]: https://developer.mozilla.org/en-US/docs/Web/API/Web_Locks_API
+//! [`BroadcastChannel`]: https://developer.mozilla.org/en-US/docs/Web/API/BroadcastChannel
+
+use std::{
+    marker::PhantomData,
+    os::raw::{c_char, c_int, c_void},
+};
+
+use crate::{
+    c_str::with_c_str,
+    executor::{callback_future, CallbackFuture},
+};
+
+extern "C" {
+    fn tabs_request_lock(
+        name: *const c_char,
+        callback: unsafe extern "C" fn(*mut c_void, c_int),
+        arg: *mut c_void,
+    );
+    fn tabs_release_lock(id: c_int);
+    fn tabs_channel_open(
+        name: *const c_char,
+        callback: unsafe extern "C" fn(*mut c_void, *const c_void, c_int),
+        arg: *mut c_void,
+    ) -> c_int;
+    fn tabs_channel_post(id: c_int, data: *const c_void, size: c_int);
+    fn tabs_channel_close(id: c_int);
+}
+
+type OnLock = Box<dyn FnOnce(TabLock)>;
+type OnMessage = Box<dyn FnMut(&[u8])>;
+
+unsafe extern "C" fn lock_granted(arg: *mut c_void, id: c_int) {
+    let callback = Box::from_raw(arg as *mut OnLock);
+    callback(TabLock {
+        id,
+        _not_send: PhantomData,
+    });
+}
+
+unsafe extern "C" fn message_trampoline(arg: *mut c_void, data: *const c_void, size: c_int) {
+    let onmessage = &mut *(arg as *mut OnMessage);
+    onmessage(std::slice::from_raw_parts(data as *const u8, size as usize));
+}
+
+/// A Web Lock held by this tab, released when dropped. See [`request_lock`].
+#[must_use = "the lock is released when dropped"]
+pub struct TabLock {
+    // 0 if the browser lacks Web Locks, and nothing is held.
+    id: c_int,
+    _not_send: PhantomData<*const ()>,
+}
+
+impl TabLock {
+    /// Returns `false` if the browser lacks Web Locks, and the lock doesn't exclude the other tabs.
+    pub fn is_exclusive(&self) -> bool {
+        self.id != 0
+    }
+}
+
+impl Drop for TabLock {
+    fn drop(&mut self) {
+        if self.id != 0 {
+            unsafe { tabs_release_lock(self.id) };
+        }
+    }
+}
+
+/// Requests the exclusive Web Lock of the given name, and calls `callback` with it once no other tab of the origin holds it.
+/// Where Web Locks are missing, `callback` is called right away, with a lock that excludes nothing.
+///
+/// # Examples
+/// ```rust
+/// request_lock("migrate-saves", |lock| {
+///     // A single tab migrates the saves; the others run this once it's done, and find nothing to migrate.
+///     migrate_saves(move || drop(lock));
+/// });
+/// ```
+pub fn request_lock<F>(name: &str, callback: F)
+where
+    F: 'static + FnOnce(TabLock),
+{
+    let callback: OnLock = Box::new(callback);
+    let arg = Box::into_raw(Box::new(callback)) as *mut c_void;
+    with_c_str(name, |name| unsafe {
+        tabs_request_lock(name, lock_granted, arg)
+    });
+}
+
+/// Returns a future completing with the Web Lock of the given name. See [`request_lock`].
+pub fn request_lock_async(name: &str) -> CallbackFuture<TabLock> {
+    callback_future(|callback| request_lock(name, callback))
+}
+
+/// A channel to the other tabs of the origin, closed when dropped.
+///
+/// The messages posted on it are received by the channels of the same name of the other tabs, not by itself.
+///
+/// # Examples
+/// ```rust
+/// let channel = BroadcastChannel::open("scores", |message| {
+///     println!("Another tab scored {}", String::from_utf8_lossy(message));
+/// })
+/// .unwrap();
+/// channel.post(b"42");
+/// ```
+pub struct BroadcastChannel {
+    id: c_int,
+    onmessage: *mut OnMessage,
+    _not_send: PhantomData<*const ()>,
+}
+
+impl BroadcastChannel {
+    /// Opens the channel of the given name, calling `onmessage` with each message of the other tabs,
+    /// or returns `None` if the browser lacks `BroadcastChannel`.
+    pub fn open<F>(name: &str, onmessage: F) -> Option<Self>
+    where
+        F: 'static + FnMut(&[u8]),
+    {
+        let onmessage: *mut OnMessage = Box::into_raw(Box::new(Box::new(onmessage)));
+        let id = with_c_str(name, |name| unsafe {
+            tabs_channel_open(name, message_trampoline, onmessage as *mut c_void)
+        });
+        if id == 0 {
+            drop(unsafe { Box::from_raw(onmessage) });
+            return None;
+        }
+        Some(Self {
+            id,
+            onmessage,
+            _not_send: PhantomData,
+        })
+    }
+
+    /// Posts a message to the other tabs. It's copied when called.
+    pub fn post(&self, message: &[u8]) {
+        unsafe {
+            tabs_channel_post(
+                self.id,
+                message.as_ptr() as *const c_void,
+                message.len() as c_int,
+            )
+        };
+    }
+}
+
+impl Drop for BroadcastChannel {
+    fn drop(&mut self) {
+        unsafe {
+            // No message is delivered once the channel is closed.
+            tabs_channel_close(self.id);
+            drop(Box::from_raw(self.onmessage));
+        }
+    }
+}
@@ -0,0 +1,246 @@
+//! Thread information, naming and futex waits, over the emscripten [`threading.h`] header file,
+//! and the prewarming of the pthread pool.
+//!
+//! [`threading.h`]: https://github.com/emscripten-core/emscripten/blob/main/system/include/emscripten/threading.h
+
+use std::{
+    cell::Cell,
+    fmt::Display,
+    os::raw::{c_int, c_void},
+    rc::Rc,
+    sync::atomic::AtomicU32,
+};
+
+use emscripten_functions_sys::threading;
+
+use crate::{
+    c_str::with_c_str,
+    executor::{callback_future, CallbackFuture},
+    proxying::Thread,
+};
+
+extern "C" {
+    fn threading_prewarm(
+        count: c_int,
+        callback: unsafe extern "C" fn(arg: *mut c_void, workers: c_int),
+        arg: *mut c_void,
+    ) -> c_int;
+}
+
+// The WASI errno values emscripten uses.
+const EAGAIN: c_int = 6;
+const ETIMEDOUT: c_int = 73;
+
+/// Returns `true` if the program was built with pthreads support and the browser runs it with `SharedArrayBuffer`.
+pub fn has_threading_support() -> bool {
+    unsafe { threading::emscripten_has_threading_support() != 0 }
+}
+
+/// Returns the number of logical cores of the machine, as reported by `navigator.hardwareConcurrency`,
+/// or the value set with [`force_num_logical_cores`].
+///
+/// # Examples
+/// ```rust
+/// // Leaves a core for the main thread.
+/// let workers = (num_logical_cores() - 1).max(1);
+/// ```
+pub fn num_logical_cores() -> c_int {
+    unsafe { threading::emscripten_num_logical_cores() }
+}
+
+/// Overrides the number returned by [`num_logical_cores`], e.g. to test how a program scales.
+pub fn force_num_logical_cores(cores: c_int) {
+    unsafe { threading::emscripten_force_num_logical_cores(cores) };
+}
+
+/// Returns `true` if the calling thread is the main runtime thread, the one that ran `main`.
+/// It's the main browser thread too, unless the program was built with `-sPROXY_TO_PTHREAD`.
+pub fn is_main_runtime_thread() -> bool {
+    unsafe { threading::emscripten_is_main_runtime_thread() != 0 }
+}
+
+/// Returns `true` if the calling thread is the main browser thread, where blocking waits busy-wait instead of sleeping.
+pub fn is_main_browser_thread() -> bool {
+    unsafe { threading::emscripten_is_main_browser_thread() != 0 }
+}
+
+/// Runs the calls proxied to the main thread. It must be called from the main thread.
+pub fn main_thread_process_queued_calls() {
+    unsafe { threading::emscripten_main_thread_process_queued_calls() };
+}
+
+/// Runs the calls proxied to the calling thread.
+pub fn current_thread_process_queued_calls() {
+    unsafe { threading::emscripten_current_thread_process_queued_calls() };
+}
+
+/// Blocks the calling thread for the given number of milliseconds, running the calls proxied to it meanwhile.
+///
+/// It doesn't need Asyncify, unlike `emscripten_sleep`: on the main browser thread it busy-waits instead.
+pub fn thread_sleep(milliseconds: f64) {
+    unsafe { threading::emscripten_thread_sleep(milliseconds) };
+}
+
+/// Sets the name the given thread shows up with in the emscripten thread profiler, using the emscripten-defined `emscripten_set_thread_name`.
+/// The name is truncated to 32 bytes. It does nothing unless the program was built with `--threadprofiler`.
+pub fn set_thread_name(thread: Thread, name: &str) {
+    with_c_str(name, |name| unsafe {
+        threading::emscripten_set_thread_name(thread.as_raw(), name)
+    })
+}
+
+/// Sets the name the calling thread shows up with in the emscripten thread profiler. See [`set_thread_name`].
+pub fn set_current_thread_name(name: &str) {
+    set_thread_name(crate::proxying::current_thread(), name);
+}
+
+/// Aborts if blocking isn't allowed on the calling thread, i.e. on the main browser thread
+/// when the program wasn't built with `-sALLOW_BLOCKING_ON_MAIN_THREAD`.
+pub fn check_blocking_allowed() {
+    unsafe { threading::emscripten_check_blocking_allowed() };
+}
+
+/// The reason [`futex_wait`] returned without being woken up.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum FutexWaitError {
+    /// The atomic didn't hold the expected value, so there was no wait.
+    ValueMismatch,
+    /// The timeout passed.
+    TimedOut,
+    /// Another error, with its errno value.
+    Other(c_int),
+}
+
+impl Display for FutexWaitError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        match self {
+            FutexWaitError::ValueMismatch => write!(f, "The value didn't match"),
+            FutexWaitError::TimedOut => write!(f, "The wait timed out"),
+            FutexWaitError::Other(errno) => write!(f, "Futex wait error {}", errno),
+        }
+    }
+}
+
+/// Blocks the calling thread while `atomic` holds `expected`, until woken up with [`futex_wake`] or after `timeout_ms` milliseconds,
+/// using the emscripten-defined `emscripten_futex_wait`.
+///
+/// On the main browser thread, where `Atomics.wait` isn't allowed, it busy-waits, running the calls proxied to it meanwhile.
+/// Wakeups can be spurious, so the condition waited for must be checked again after it returns.
+///
+/// # Examples
+/// ```rust
+/// static READY: AtomicU32 = AtomicU32::new(0);
+///
+/// while READY.load(Ordering::Acquire) == 0 {
+///     let _ = futex_wait(&READY, 0, f64::INFINITY);
+/// }
+///
+/// // On another thread.
+/// READY.store(1, Ordering::Release);
+/// futex_wake(&READY, c_int::MAX);
+/// ```
+pub fn futex_wait(
+    atomic: &AtomicU32,
+    expected: u32,
+    timeout_ms: f64,
+) -> Result<(), FutexWaitError> {
+    match unsafe {
+        threading::emscripten_futex_wait(atomic.as_ptr() as *mut c_void, expected, timeout_ms)
+    } {
+        0 => Ok(()),
+        errno if errno == -EAGAIN => Err(FutexWaitError::ValueMismatch),
+        errno if errno == -ETIMEDOUT => Err(FutexWaitError::TimedOut),
+        errno => Err(FutexWaitError::Other(-errno)),
+    }
+}
+
+/// Wakes up to `count` threads waiting on `atomic` with [`futex_wait`], and returns how many were woken up,
+/// using the emscripten-defined `emscripten_futex_wake`.
+pub fn futex_wake(atomic: &AtomicU32, count: c_int) -> c_int {
+    unsafe { threading::emscripten_futex_wake(atomic.as_ptr() as *mut c_void, count) }
+}
+
+/// The reason [`prewarm`] couldn't load workers.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum PrewarmError {
+    /// The program wasn't built with `-pthread`, or the browser doesn't support `SharedArrayBuffer`.
+    NoThreadingSupport,
+    /// It wasn't called from the main runtime thread, the only one that creates workers.
+    NotMainRuntimeThread,
+}
+
+impl Display for PrewarmError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        match self {
+            PrewarmError::NoThreadingSupport => write!(f, "Threads aren't supported"),
+            PrewarmError::NotMainRuntimeThread => {
+                write!(f, "Workers can only be loaded from the main runtime thread")
+            }
+        }
+    }
+}
+
+unsafe extern "C" fn prewarm_done(arg: *mut c_void, workers: c_int) {
+    let callback = Box::from_raw(arg as *mut Box<dyn FnOnce(usize)>);
+    callback(workers.max(0) as usize);
+}
+
+/// Makes sure the pthread pool has at least `workers` unused workers, [`num_logical_cores`] if `None`, with the wasm module loaded,
+/// and calls `on_ready` with the number of unused workers once the missing ones are loaded.
+///
+/// Past the `-sPTHREAD_POOL_SIZE` workers created at startup, a thread starts only once a new worker has loaded the wasm module,
+/// which takes a trip through the event loop and often over 100 ms. The workers loaded here are used by the next threads created instead,
+/// so this should be called from `main`, starting the main loop and the parallel work from `on_ready`.
+/// It must be called from the main runtime thread.
+///
+/// # Examples
+/// ```rust
+/// // In `main`.
+/// let started = prewarm(None, |workers| {
+///     println!("{workers} workers ready");
+///     start_main_loop();
+/// });
+/// if started.is_err() {
+///     start_main_loop();
+/// }
+/// ```
+pub fn prewarm<F>(workers: Option<usize>, on_ready: F) -> Result<(), PrewarmError>
+where
+    F: 'static + FnOnce(usize),
+{
+    if !has_threading_support() {
+        return Err(PrewarmError::NoThreadingSupport);
+    }
+    if !is_main_runtime_thread() {
+        return Err(PrewarmError::NotMainRuntimeThread);
+    }
+    let count = match workers {
+        Some(workers) => workers.min(c_int::MAX as usize) as c_int,
+        None => num_logical_cores(),
+    };
+    let callback: Box<dyn FnOnce(usize)> = Box::new(on_ready);
+    let arg = Box::into_raw(Box::new(callback));
+    if unsafe { threading_prewarm(count, prewarm_done, arg as *mut c_void) } == 0 {
+        drop(unsafe { Box::from_raw(arg) });
+        return Err(PrewarmError::NoThreadingSupport);
+    }
+    Ok(())
+}
+
+/// Returns a future completing with the number of unused workers once they're loaded. See [`prewarm`].
+pub fn prewarm_async(workers: Option<usize>) -> CallbackFuture<Result<usize, PrewarmError>> {
+    callback_future(|callback| {
+        // The closure is dropped without being called on an error, leaving the callback for the error.
+        let callback = Rc::new(Cell::new(Some(callback)));
+        let on_ready = callback.clone();
+        if let Err(err) = prewarm(workers, move |workers| {
+            if let Some(callback) = on_ready.take() {
+                callback(Ok(workers));
+            }
+        }) {
+            if let Some(callback) = callback.take() {
+                callback(Err(err));
+            }
+        }
+    })
+}
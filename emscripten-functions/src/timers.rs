@@ -0,0 +1,392 @@
+//! Timeouts and intervals, kept in a rust-side hierarchical timer wheel that arms only one JS timer, using the emscripten-defined [`emscripten_set_timeout`].
+//!
+//! Each JS `setTimeout` has a cost, which adds up when thousands of short-lived timeouts are scheduled (e.g. retries, debouncing).
+//! Here, the timers of the calling thread are kept in a wheel with a 1ms resolution,
+//! and a single JS timer is armed for the earliest tick at which the wheel has work to do.
+//! [`pause_timers`] stops the wheel's clock, e.g. while the page is in the back/forward cache, so that the timers keep their remaining delays.
+//!
+//! [`emscripten_set_timeout`]: https://emscripten.org/docs/api_reference/eventloop.h.html#c.emscripten_set_timeout
+
+use std::{cell::RefCell, collections::HashMap, os::raw::c_void};
+
+use emscripten_functions_sys::html5;
+
+use crate::emscripten::{get_now, KeepAlive};
+
+// The wheel has `LEVELS` levels of `SLOTS` slots; a slot of level `l` spans `SLOTS^l` ticks of 1ms.
+// Timers further than `SLOTS^LEVELS` ticks away (about 4.6 hours) wait in an overflow list.
+const SLOT_BITS: u32 = 6;
+const SLOTS: usize = 1 << SLOT_BITS;
+const LEVELS: usize = 4;
+
+struct Timer {
+    deadline: u64,
+    interval: Option<u64>,
+    // `None` while the callback runs.
+    callback: Option<Box<dyn FnMut()>>,
+}
+
+struct TimerWheel {
+    // The last processed tick, in milliseconds since `origin`.
+    current: u64,
+    origin: f64,
+    // The ids of the timers in each slot. Cancelled timers are removed from `timers` only, and skipped when their slot is processed.
+    slots: [[Vec<u64>; SLOTS]; LEVELS],
+    overflow: Vec<u64>,
+    timers: HashMap<u64, Timer>,
+    next_id: u64,
+    // The JS timer id and the tick it was armed for.
+    armed: Option<(i32, u64)>,
+    // Held while timers are scheduled.
+    keepalive: Option<KeepAlive>,
+    // The time the wheel was paused at, if it's paused.
+    paused_at: Option<f64>,
+}
+
+impl TimerWheel {
+    fn new() -> Self {
+        Self {
+            current: 0,
+            origin: get_now(),
+            slots: std::array::from_fn(|_| std::array::from_fn(|_| Vec::new())),
+            overflow: Vec::new(),
+            timers: HashMap::new(),
+            next_id: 0,
+            armed: None,
+            keepalive: None,
+            paused_at: None,
+        }
+    }
+
+    fn update_keepalive(&mut self) {
+        if self.timers.is_empty() {
+            self.keepalive = None;
+        } else if self.keepalive.is_none() {
+            self.keepalive = Some(KeepAlive::new());
+        }
+    }
+
+    fn now_tick(&self) -> u64 {
+        (self.paused_at.unwrap_or_else(get_now) - self.origin).max(0.0) as u64
+    }
+
+    // Puts the timer in the level where its deadline first differs from the current tick.
+    fn place(&mut self, id: u64, deadline: u64) {
+        let differing = deadline ^ self.current;
+        let level = (0..LEVELS).find(|&level| differing >> (SLOT_BITS * (level as u32 + 1)) == 0);
+
+        match level {
+            Some(level) => {
+                let slot = (deadline >> (SLOT_BITS * level as u32)) as usize & (SLOTS - 1);
+                self.slots[level][slot].push(id);
+            }
+            None => self.overflow.push(id),
+        }
+    }
+
+    fn insert(&mut self, deadline: u64, interval: Option<u64>, callback: Box<dyn FnMut()>) -> u64 {
+        let id = self.next_id;
+        self.next_id += 1;
+
+        // A deadline that's already due fires at the next tick.
+        let deadline = deadline.max(self.current + 1);
+        self.timers.insert(
+            id,
+            Timer {
+                deadline,
+                interval,
+                callback: Some(callback),
+            },
+        );
+        self.place(id, deadline);
+        id
+    }
+
+    // The next tick after the current one at which a slot has to be expired or cascaded, if any.
+    fn next_event(&self) -> Option<u64> {
+        for level in 0..LEVELS {
+            let shift = SLOT_BITS * level as u32;
+            let index = (self.current >> shift) as usize & (SLOTS - 1);
+            let block_start = (self.current >> (shift + SLOT_BITS)) << (shift + SLOT_BITS);
+
+            let slot = (index + 1..SLOTS).find(|&slot| {
+                self.slots[level][slot]
+                    .iter()
+                    .any(|id| self.timers.contains_key(id))
+            });
+            if let Some(slot) = slot {
+                return Some(block_start | ((slot as u64) << shift));
+            }
+        }
+
+        if self.overflow.iter().any(|id| self.timers.contains_key(id)) {
+            let span = SLOT_BITS * LEVELS as u32;
+            return Some(((self.current >> span) + 1) << span);
+        }
+        None
+    }
+
+    // Moves the current tick to `tick`, cascading the higher level slots it reaches, and returns the ids of the timers due at it.
+    fn advance_to(&mut self, tick: u64) -> Vec<u64> {
+        self.current = tick;
+
+        let span = SLOT_BITS * LEVELS as u32;
+        if tick & ((1 << span) - 1) == 0 {
+            for id in std::mem::take(&mut self.overflow) {
+                if let Some(timer) = self.timers.get(&id) {
+                    let deadline = timer.deadline;
+                    self.place(id, deadline);
+                }
+            }
+        }
+        // Higher levels first, as their timers may land in the lower level slots cascaded at the same tick.
+        for level in (1..LEVELS).rev() {
+            let shift = SLOT_BITS * level as u32;
+            if tick & ((1 << shift) - 1) != 0 {
+                continue;
+            }
+            let slot = (tick >> shift) as usize & (SLOTS - 1);
+            for id in std::mem::take(&mut self.slots[level][slot]) {
+                if let Some(timer) = self.timers.get(&id) {
+                    let deadline = timer.deadline;
+                    self.place(id, deadline);
+                }
+            }
+        }
+
+        let slot = tick as usize & (SLOTS - 1);
+        std::mem::take(&mut self.slots[0][slot])
+            .into_iter()
+            .filter(|id| self.timers.contains_key(id))
+            .collect()
+    }
+}
+
+thread_local! {
+    static TIMER_WHEEL: RefCell<Option<TimerWheel>> = RefCell::new(None);
+}
+
+fn with_wheel<F, R>(f: F) -> R
+where
+    F: FnOnce(&mut TimerWheel) -> R,
+{
+    TIMER_WHEEL.with(|wheel| f(wheel.borrow_mut().get_or_insert_with(TimerWheel::new)))
+}
+
+// Arms the JS timer for the wheel's next event, if it isn't armed early enough already.
+fn rearm() {
+    with_wheel(|wheel| {
+        wheel.update_keepalive();
+        if wheel.paused_at.is_some() {
+            return;
+        }
+        let Some(next) = wheel.next_event() else {
+            return;
+        };
+        if let Some((js_id, armed_tick)) = wheel.armed {
+            if armed_tick <= next {
+                return;
+            }
+            unsafe { html5::emscripten_clear_timeout(js_id) };
+        }
+
+        let delay = (wheel.origin + next as f64 - get_now()).max(0.0);
+        let js_id = unsafe {
+            html5::emscripten_set_timeout(Some(on_js_timeout), delay, std::ptr::null_mut())
+        };
+        wheel.armed = Some((js_id, next));
+    });
+}
+
+unsafe extern "C" fn on_js_timeout(_user_data: *mut c_void) {
+    with_wheel(|wheel| wheel.armed = None);
+
+    loop {
+        // The due timers are collected one tick at a time, jumping over the ticks without work.
+        let due = with_wheel(|wheel| {
+            let now = wheel.now_tick();
+            match wheel.next_event() {
+                Some(next) if next <= now => Some(wheel.advance_to(next)),
+                _ => {
+                    wheel.current = wheel.current.max(now);
+                    None
+                }
+            }
+        });
+        let Some(due) = due else {
+            break;
+        };
+
+        for id in due {
+            run_timer(id);
+        }
+    }
+
+    rearm();
+}
+
+fn run_timer(id: u64) {
+    let callback = with_wheel(|wheel| {
+        wheel
+            .timers
+            .get_mut(&id)
+            .and_then(|timer| timer.callback.take())
+    });
+    let Some(mut callback) = callback else {
+        return;
+    };
+
+    // The wheel isn't borrowed during the call, so that the callback can add or cancel timers.
+    callback();
+
+    with_wheel(|wheel| {
+        let Some(timer) = wheel.timers.get_mut(&id) else {
+            // Cancelled by its own callback.
+            return;
+        };
+        match timer.interval {
+            Some(interval) => {
+                // An interval that fell behind (e.g. in a background tab) skips the missed runs.
+                let deadline = (timer.deadline + interval).max(wheel.current + 1);
+                timer.deadline = deadline;
+                timer.callback = Some(callback);
+                wheel.place(id, deadline);
+            }
+            None => {
+                wheel.timers.remove(&id);
+            }
+        }
+    });
+}
+
+fn schedule(delay: f64, interval: Option<u64>, callback: Box<dyn FnMut()>) -> TimerHandle {
+    let id = with_wheel(|wheel| {
+        let deadline = wheel.now_tick() + delay.max(0.0).ceil() as u64;
+        wheel.insert(deadline, interval, callback)
+    });
+    rearm();
+    TimerHandle { id }
+}
+
+/// The handle of a timer set with [`set_timeout`] or [`set_interval`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct TimerHandle {
+    id: u64,
+}
+
+impl TimerHandle {
+    /// Cancels the timer. It does nothing if the timer already fired (for a timeout) or was cancelled.
+    pub fn cancel(&self) {
+        with_wheel(|wheel| {
+            wheel.timers.remove(&self.id);
+            wheel.update_keepalive();
+        });
+    }
+
+    /// Returns `true` if the timer is still scheduled.
+    pub fn is_active(&self) -> bool {
+        with_wheel(|wheel| wheel.timers.contains_key(&self.id))
+    }
+}
+
+/// Calls the given function once, after the given delay.
+///
+/// # Arguments
+/// * `func` - The function to call.
+/// * `delay` - The delay in milliseconds. It's rounded up to a whole millisecond.
+///
+/// # Examples
+/// ```rust
+/// let retry = set_timeout(|| {
+///     println!("Retrying");
+/// }, 500.0);
+///
+/// // The connection came back.
+/// retry.cancel();
+/// ```
+pub fn set_timeout<F>(func: F, delay: f64) -> TimerHandle
+where
+    F: 'static + FnOnce(),
+{
+    let mut func = Some(func);
+    schedule(
+        delay,
+        None,
+        Box::new(move || {
+            if let Some(func) = func.take() {
+                func();
+            }
+        }),
+    )
+}
+
+/// Calls the given function repeatedly, every `interval` milliseconds, until the timer is cancelled.
+///
+/// # Arguments
+/// * `func` - The function to call.
+/// * `interval` - The interval in milliseconds, at least 1. It's rounded up to a whole millisecond.
+///
+/// # Examples
+/// ```rust
+/// set_interval(|| {
+///     println!("Autosaving");
+/// }, 30_000.0);
+/// ```
+pub fn set_interval<F>(func: F, interval: f64) -> TimerHandle
+where
+    F: 'static + FnMut(),
+{
+    let interval = (interval.ceil() as u64).max(1);
+    schedule(interval as f64, Some(interval), Box::new(func))
+}
+
+/// Calls the given function once, as soon as possible after the current event loop turn, using the emscripten-defined [`emscripten_set_immediate`].
+///
+/// Unlike a timeout of 0, it isn't clamped to a minimum delay by the browser.
+///
+/// [`emscripten_set_immediate`]: https://emscripten.org/docs/api_reference/eventloop.h.html#c.emscripten_set_immediate
+pub fn set_immediate<F>(func: F)
+where
+    F: 'static + FnOnce(),
+{
+    unsafe extern "C" fn wrapper<F>(user_data: *mut c_void)
+    where
+        F: 'static + FnOnce(),
+    {
+        let func = Box::from_raw(user_data as *mut F);
+        func();
+    }
+
+    let func = Box::into_raw(Box::new(func));
+    unsafe {
+        html5::emscripten_set_immediate(Some(wrapper::<F>), func as *mut c_void);
+    }
+}
+
+/// Pauses the timers of the calling thread: none fires until [`resume_timers`] is called, and the time spent paused
+/// doesn't count towards their delays. The timers set meanwhile start counting once resumed.
+pub fn pause_timers() {
+    with_wheel(|wheel| {
+        if wheel.paused_at.is_some() {
+            return;
+        }
+        wheel.paused_at = Some(get_now());
+        if let Some((js_id, _)) = wheel.armed.take() {
+            unsafe { html5::emscripten_clear_timeout(js_id) };
+        }
+    });
+}
+
+/// Resumes the timers paused with [`pause_timers`], with the delays they had left.
+pub fn resume_timers() {
+    let resumed = with_wheel(|wheel| match wheel.paused_at.take() {
+        Some(paused_at) => {
+            wheel.origin += get_now() - paused_at;
+            true
+        }
+        None => false,
+    });
+    if resumed {
+        rearm();
+    }
+}
@@ -0,0 +1,210 @@
+//! Spans, marks and allocation tracking for the [emscripten tracer], over the emscripten `trace.h` header file.
+//!
+//! The tracer sends the recorded events to a collector server, where the time spent in each [`span`] and the memory allocated in it
+//! can be browsed per subsystem, for real sessions rather than only for devtools profiles.
+//!
+//! The calls are only made when this crate's `tracing` feature is enabled, and the program must then be built with `--tracing`.
+//! Without the feature they do nothing, like the C functions without `__EMSCRIPTEN_TRACING__`, so they can stay in the code.
+//! Either way, the spans, marks and frames are also recorded by the [`trace_recorder`](crate::trace_recorder) once it's enabled.
+//!
+//! [emscripten tracer]: https://emscripten.org/docs/optimizing/Profiling-Toolchain.html
+
+use std::{
+    alloc::{GlobalAlloc, Layout},
+    marker::PhantomData,
+    os::raw::{c_char, c_void},
+};
+
+use crate::c_str::with_c_str;
+
+#[cfg(feature = "tracing")]
+use emscripten_functions_sys::trace as sys;
+
+// Without the `tracing` feature the tracer isn't linked, so its functions are replaced by ones doing nothing.
+#[cfg(not(feature = "tracing"))]
+#[allow(clippy::missing_safety_doc)]
+mod sys {
+    use std::os::raw::{c_char, c_void};
+
+    pub unsafe fn emscripten_trace_configure(_: *const c_char, _: *const c_char) {}
+    pub unsafe fn emscripten_trace_set_enabled(_: bool) {}
+    pub unsafe fn emscripten_trace_record_frame_start() {}
+    pub unsafe fn emscripten_trace_record_frame_end() {}
+    pub unsafe fn emscripten_trace_mark(_: *const c_char) {}
+    pub unsafe fn emscripten_trace_log_message(_: *const c_char, _: *const c_char) {}
+    pub unsafe fn emscripten_trace_report_error(_: *const c_char) {}
+    pub unsafe fn emscripten_trace_record_allocation(_: *const c_void, _: i32) {}
+    pub unsafe fn emscripten_trace_record_reallocation(_: *const c_void, _: *const c_void, _: i32) {
+    }
+    pub unsafe fn emscripten_trace_record_free(_: *const c_void) {}
+    pub unsafe fn emscripten_trace_annotate_address_type(_: *const c_void, _: *const c_char) {}
+    pub unsafe fn emscripten_trace_enter_context(_: *const c_char) {}
+    pub unsafe fn emscripten_trace_exit_context() {}
+    pub unsafe fn emscripten_trace_close() {}
+}
+
+/// Starts sending the events to the collector server at `collector_url`, under the given application name,
+/// using the emscripten-defined `emscripten_trace_configure`.
+///
+/// # Examples
+/// ```rust
+/// configure("https://tracing.example.com/", "my-game");
+/// ```
+pub fn configure(collector_url: &str, application: &str) {
+    with_c_str(collector_url, |collector_url| {
+        with_c_str(application, |application| unsafe {
+            sys::emscripten_trace_configure(collector_url, application)
+        })
+    })
+}
+
+/// Enables or disables the recording of events, e.g. to only trace some of the sessions.
+pub fn set_enabled(enabled: bool) {
+    unsafe { sys::emscripten_trace_set_enabled(enabled) };
+}
+
+/// Sends the events left and stops tracing, using the emscripten-defined `emscripten_trace_close`.
+pub fn close() {
+    unsafe { sys::emscripten_trace_close() };
+}
+
+/// Records the start of a frame, whose duration shows up in the collector.
+pub fn record_frame_start() {
+    crate::trace_recorder::frame_start();
+    unsafe { sys::emscripten_trace_record_frame_start() };
+}
+
+/// Records the end of the frame started with [`record_frame_start`].
+pub fn record_frame_end() {
+    unsafe { sys::emscripten_trace_record_frame_end() };
+    crate::trace_recorder::frame_end();
+}
+
+/// Records a mark at the current time on the timeline, e.g. for a level load.
+pub fn mark(message: &str) {
+    crate::trace_recorder::instant(message);
+    with_c_str(message, |message| unsafe {
+        sys::emscripten_trace_mark(message)
+    });
+}
+
+/// Records a message in the given channel.
+pub fn log_message(channel: &str, message: &str) {
+    with_c_str(channel, |channel| {
+        with_c_str(message, |message| unsafe {
+            sys::emscripten_trace_log_message(channel, message)
+        })
+    })
+}
+
+/// Records an error, along with the current JS stack trace.
+pub fn report_error(error: &str) {
+    with_c_str(error, |error| unsafe {
+        sys::emscripten_trace_report_error(error)
+    });
+}
+
+/// Records the type of the given allocated value, so that the collector groups the memory by type.
+pub fn annotate_type<T: ?Sized>(value: &T, type_name: &str) {
+    with_c_str(type_name, |type_name| unsafe {
+        sys::emscripten_trace_annotate_address_type(
+            value as *const T as *const c_void,
+            type_name as *const c_char,
+        )
+    });
+}
+
+/// A context of the tracer, exited when dropped. It's created with [`span`].
+///
+/// The contexts are a stack per thread, so a span must be dropped on the thread it was created on, before the spans created after it.
+#[must_use = "the span is exited when dropped"]
+pub struct Span {
+    _not_send: PhantomData<*const ()>,
+}
+
+/// Enters a context of the tracer with the given name, using the emscripten-defined `emscripten_trace_enter_context`,
+/// until the returned [`Span`] is dropped.
+/// The time spent in the context, and the memory allocated in it when the global allocator is a [`TracingAllocator`], are attributed to it.
+///
+/// # Examples
+/// ```rust
+/// set_main_loop(|| {
+///     {
+///         let _span = span("physics");
+///         step_physics();
+///     }
+///     let _span = span("render");
+///     render();
+/// }, 0, true);
+/// ```
+pub fn span(name: &str) -> Span {
+    crate::trace_recorder::begin(name);
+    with_c_str(name, |name| unsafe {
+        sys::emscripten_trace_enter_context(name)
+    });
+    Span {
+        _not_send: PhantomData,
+    }
+}
+
+impl Drop for Span {
+    fn drop(&mut self) {
+        unsafe { sys::emscripten_trace_exit_context() };
+        crate::trace_recorder::end();
+    }
+}
+
+// The sizes the tracer records are 32-bit.
+fn trace_size(size: usize) -> i32 {
+    size.min(i32::MAX as usize) as i32
+}
+
+/// A global allocator that records its allocations, reallocations and frees in the tracer, forwarding them to the given allocator.
+///
+/// # Examples
+/// ```rust
+/// #[global_allocator]
+/// static ALLOCATOR: TracingAllocator<std::alloc::System> = TracingAllocator(std::alloc::System);
+/// ```
+pub struct TracingAllocator<A>(pub A);
+
+unsafe impl<A: GlobalAlloc> GlobalAlloc for TracingAllocator<A> {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        let ptr = self.0.alloc(layout);
+        if !ptr.is_null() {
+            sys::emscripten_trace_record_allocation(
+                ptr as *const c_void,
+                trace_size(layout.size()),
+            );
+        }
+        ptr
+    }
+
+    unsafe fn alloc_zeroed(&self, layout: Layout) -> *mut u8 {
+        let ptr = self.0.alloc_zeroed(layout);
+        if !ptr.is_null() {
+            sys::emscripten_trace_record_allocation(
+                ptr as *const c_void,
+                trace_size(layout.size()),
+            );
+        }
+        ptr
+    }
+
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        sys::emscripten_trace_record_free(ptr as *const c_void);
+        self.0.dealloc(ptr, layout);
+    }
+
+    unsafe fn realloc(&self, ptr: *mut u8, layout: Layout, new_size: usize) -> *mut u8 {
+        let new_ptr = self.0.realloc(ptr, layout, new_size);
+        if !new_ptr.is_null() {
+            sys::emscripten_trace_record_reallocation(
+                ptr as *const c_void,
+                new_ptr as *const c_void,
+                trace_size(new_size),
+            );
+        }
+        new_ptr
+    }
+}
@@ -0,0 +1,345 @@
+//! An in-memory recorder of the [`trace`](crate::trace) spans, marks and frames, serialized on demand as a [Chrome trace],
+//! e.g. to upload a short trace of the frames around a jank from a real session.
+//!
+//! Once [`enable`] is called, the trace functions also record their events in a ring buffer of the calling thread, allocated once,
+//! which keeps the last events: recording one doesn't allocate, nor call into JS. It works without the `tracing` feature,
+//! and so without a collector server. [`to_chrome_json`] serializes the events of all the threads, which can be opened in
+//! the Perfetto UI or in the devtools performance panel. [`set_jank_trigger`] does it when a frame takes too long.
+//!
+//! The names are truncated to [`MAX_NAME_LEN`] bytes.
+//!
+//! [Chrome trace]: https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+
+use std::{
+    cell::RefCell,
+    fmt::Write,
+    sync::{
+        atomic::{AtomicU32, AtomicUsize, Ordering},
+        Arc,
+    },
+};
+
+use crate::{emscripten::get_now, sync::Mutex};
+
+/// The default number of events kept per thread: 64 bytes each.
+pub const DEFAULT_TRACE_CAPACITY: usize = 16 * 1024;
+
+/// The length the event names are truncated to, in bytes.
+pub const MAX_NAME_LEN: usize = 32;
+
+#[derive(Clone, Copy)]
+enum Phase {
+    Begin,
+    End,
+    Instant,
+    Counter(f64),
+}
+
+#[derive(Clone, Copy)]
+struct Event {
+    phase: Phase,
+    // The time, in milliseconds.
+    time: f64,
+    name: [u8; MAX_NAME_LEN],
+    name_len: u8,
+}
+
+struct Ring {
+    events: Vec<Event>,
+    // The number of events kept, which the vector is allocated for.
+    capacity: usize,
+    // The index the next event is written at, once the ring is full.
+    next: usize,
+    tid: u32,
+    thread_name: Option<String>,
+}
+
+impl Ring {
+    fn push(&mut self, event: Event) {
+        if self.events.len() < self.capacity {
+            self.events.push(event);
+        } else {
+            self.events[self.next] = event;
+            self.next = (self.next + 1) % self.events.len();
+        }
+    }
+
+    // The events, oldest first.
+    fn ordered(&self) -> impl Iterator<Item = &Event> {
+        self.events[self.next..]
+            .iter()
+            .chain(&self.events[..self.next])
+    }
+}
+
+// The number of events kept per thread, or 0 while the recorder is disabled.
+static CAPACITY: AtomicUsize = AtomicUsize::new(0);
+static NEXT_TID: AtomicU32 = AtomicU32::new(1);
+// The rings of the threads, registered on their first event.
+static RINGS: Mutex<Vec<Arc<Mutex<Ring>>>> = Mutex::new(Vec::new());
+
+thread_local! {
+    static RING: RefCell<Option<Arc<Mutex<Ring>>>> = const { RefCell::new(None) };
+}
+
+/// Starts recording the trace events, keeping the last `capacity` ones of each thread.
+/// The rings of the threads that already recorded are allocated again, empty, if their capacity changed.
+///
+/// # Examples
+/// ```rust
+/// trace_recorder::enable(trace_recorder::DEFAULT_TRACE_CAPACITY);
+/// ```
+pub fn enable(capacity: usize) {
+    CAPACITY.store(capacity.max(1), Ordering::Relaxed);
+}
+
+/// Stops recording the trace events. The recorded ones can still be serialized.
+pub fn disable() {
+    CAPACITY.store(0, Ordering::Relaxed);
+}
+
+/// Returns `true` if the trace events are recorded.
+pub fn is_enabled() -> bool {
+    CAPACITY.load(Ordering::Relaxed) != 0
+}
+
+fn record(phase: Phase, name: &str) {
+    let capacity = CAPACITY.load(Ordering::Relaxed);
+    if capacity == 0 {
+        return;
+    }
+
+    // Truncated on a character boundary.
+    let mut len = name.len().min(MAX_NAME_LEN);
+    while !name.is_char_boundary(len) {
+        len -= 1;
+    }
+    let mut event = Event {
+        phase,
+        time: get_now(),
+        name: [0; MAX_NAME_LEN],
+        name_len: len as u8,
+    };
+    event.name[..len].copy_from_slice(&name.as_bytes()[..len]);
+
+    RING.with(|ring| {
+        let mut ring = ring.borrow_mut();
+        let ring = ring.get_or_insert_with(|| {
+            let ring = Arc::new(Mutex::new(Ring {
+                events: Vec::new(),
+                capacity: 0,
+                next: 0,
+                tid: NEXT_TID.fetch_add(1, Ordering::Relaxed),
+                thread_name: std::thread::current().name().map(String::from),
+            }));
+            RINGS.lock().push(ring.clone());
+            ring
+        });
+        let mut ring = ring.lock();
+        if ring.capacity != capacity {
+            ring.events = Vec::with_capacity(capacity);
+            ring.capacity = capacity;
+            ring.next = 0;
+        }
+        ring.push(event);
+    });
+}
+
+/// Records the start of a span on the calling thread. [`trace::span`](crate::trace::span) calls it.
+pub fn begin(name: &str) {
+    record(Phase::Begin, name);
+}
+
+/// Records the end of the last span started on the calling thread.
+pub fn end() {
+    record(Phase::End, "");
+}
+
+/// Records an instant event, e.g. a level load. [`trace::mark`](crate::trace::mark) calls it.
+pub fn instant(name: &str) {
+    record(Phase::Instant, name);
+}
+
+/// Records the value of a counter, e.g. the number of live entities, drawn as a graph.
+pub fn counter(name: &str, value: f64) {
+    record(Phase::Counter(value), name);
+}
+
+/// Removes all the recorded events, and the rings of the threads that exited.
+pub fn clear() {
+    let mut rings = RINGS.lock();
+    rings.retain(|ring| Arc::strong_count(ring) > 1);
+    for ring in rings.iter() {
+        let mut ring = ring.lock();
+        ring.events.clear();
+        ring.next = 0;
+    }
+}
+
+fn write_json_str(json: &mut String, value: &str) {
+    json.push('"');
+    for c in value.chars() {
+        match c {
+            '"' => json.push_str("\\\""),
+            '\\' => json.push_str("\\\\"),
+            c if (c as u32) < 0x20 => {
+                let _ = write!(json, "\\u{:04x}", c as u32);
+            }
+            c => json.push(c),
+        }
+    }
+    json.push('"');
+}
+
+/// Serializes the recorded events of all the threads as a Chrome trace, in the JSON object format.
+///
+/// The oldest events of a thread whose ring wrapped around are lost, so the trace can start with the ends of spans whose starts were overwritten.
+///
+/// # Examples
+/// ```rust
+/// // When the user reports a problem.
+/// let trace = trace_recorder::to_chrome_json();
+/// upload("https://telemetry.example.com/traces", trace.as_bytes());
+/// ```
+pub fn to_chrome_json() -> String {
+    let mut json = String::from("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    let mut first = true;
+    for ring in RINGS.lock().iter() {
+        let ring = ring.lock();
+        let mut separator = |json: &mut String| {
+            if !std::mem::take(&mut first) {
+                json.push(',');
+            }
+        };
+        if let Some(thread_name) = &ring.thread_name {
+            separator(&mut json);
+            let _ = write!(
+                json,
+                "{{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":",
+                ring.tid
+            );
+            write_json_str(&mut json, thread_name);
+            json.push_str("}}");
+        }
+        for event in ring.ordered() {
+            separator(&mut json);
+            let phase = match event.phase {
+                Phase::Begin => "B",
+                Phase::End => "E",
+                Phase::Instant => "i",
+                Phase::Counter(_) => "C",
+            };
+            // The timestamps are in microseconds.
+            let _ = write!(
+                json,
+                "{{\"ph\":\"{}\",\"ts\":{:.3},\"pid\":1,\"tid\":{},\"name\":",
+                phase,
+                event.time * 1000.0,
+                ring.tid
+            );
+            let name = &event.name[..event.name_len as usize];
+            write_json_str(&mut json, std::str::from_utf8(name).unwrap_or(""));
+            match event.phase {
+                Phase::Instant => json.push_str(",\"s\":\"t\""),
+                Phase::Counter(value) if value.is_finite() => {
+                    let _ = write!(json, ",\"args\":{{\"value\":{}}}", value);
+                }
+                _ => {}
+            }
+            json.push('}');
+        }
+    }
+    json.push_str("]}");
+    json
+}
+
+struct JankTrigger {
+    threshold_ms: f64,
+    cooldown_ms: f64,
+    callback: Box<dyn FnMut(String)>,
+    frame_start: Option<f64>,
+    // The time before which no trace is serialized again.
+    quiet_until: f64,
+}
+
+thread_local! {
+    static JANK_TRIGGER: RefCell<Option<JankTrigger>> = const { RefCell::new(None) };
+}
+
+/// Calls `callback` with the serialized trace when a frame of the calling thread, between [`trace::record_frame_start`] and
+/// [`trace::record_frame_end`], takes longer than `threshold_ms` milliseconds, at most once every `cooldown_ms` milliseconds.
+///
+/// The frame that tripped the trigger is the last one of the trace; the events are cleared afterwards,
+/// so that the next trace doesn't repeat them.
+///
+/// [`trace::record_frame_start`]: crate::trace::record_frame_start
+/// [`trace::record_frame_end`]: crate::trace::record_frame_end
+///
+/// # Examples
+/// ```rust
+/// trace_recorder::enable(trace_recorder::DEFAULT_TRACE_CAPACITY);
+/// // Uploads the last events when a frame takes over 100 milliseconds, at most once a minute.
+/// trace_recorder::set_jank_trigger(100.0, 60_000.0, |trace| {
+///     metrics::send_beacon("https://telemetry.example.com/traces", &trace);
+/// });
+///
+/// set_main_loop(|| {
+///     trace::record_frame_start();
+///     update_and_render();
+///     trace::record_frame_end();
+/// }, 0, true);
+/// ```
+pub fn set_jank_trigger<F>(threshold_ms: f64, cooldown_ms: f64, callback: F)
+where
+    F: 'static + FnMut(String),
+{
+    JANK_TRIGGER.with(|trigger| {
+        *trigger.borrow_mut() = Some(JankTrigger {
+            threshold_ms,
+            cooldown_ms,
+            callback: Box::new(callback),
+            frame_start: None,
+            quiet_until: 0.0,
+        });
+    });
+}
+
+/// Removes the trigger set with [`set_jank_trigger`] on the calling thread.
+pub fn clear_jank_trigger() {
+    JANK_TRIGGER.with(|trigger| *trigger.borrow_mut() = None);
+}
+
+pub(crate) fn frame_start() {
+    begin("frame");
+    JANK_TRIGGER.with(|trigger| {
+        if let Some(trigger) = trigger.borrow_mut().as_mut() {
+            trigger.frame_start = Some(get_now());
+        }
+    });
+}
+
+pub(crate) fn frame_end() {
+    end();
+    let tripped = JANK_TRIGGER.with(|trigger| {
+        let mut trigger = trigger.borrow_mut();
+        let trigger = trigger.as_mut()?;
+        let now = get_now();
+        let start = trigger.frame_start.take()?;
+        if now - start < trigger.threshold_ms || now < trigger.quiet_until || !is_enabled() {
+            return None;
+        }
+        trigger.quiet_until = now + trigger.cooldown_ms;
+        // Taken out during the call, so that it can clear the trigger.
+        Some(std::mem::replace(&mut trigger.callback, Box::new(|_| {})))
+    });
+    if let Some(mut callback) = tripped {
+        let trace = to_chrome_json();
+        clear();
+        callback(trace);
+        JANK_TRIGGER.with(|trigger| {
+            if let Some(trigger) = trigger.borrow_mut().as_mut() {
+                trigger.callback = callback;
+            }
+        });
+    }
+}
@@ -0,0 +1,342 @@
+//! An opt-in global allocator wrapper that counts the allocations by size class, by tag and by thread, and samples the call stacks of some of them.
+//!
+//! It's installed in place of the program's allocator, wrapping it:
+//! ```rust
+//! #[global_allocator]
+//! static ALLOCATOR: TrackingAllocator = TrackingAllocator::new(std::alloc::System);
+//! ```
+//! The counts are atomic, so any thread can allocate. The allocations made while an [`AllocTag`] is entered with [`tag_scope`] are also counted in the tag,
+//! e.g. to tell how much a subsystem allocates per frame. With [`TrackingAllocator::set_stack_sampling`], the call stack of one allocation in N
+//! is captured with the emscripten-defined [`emscripten_get_callstack`], and [`TrackingAllocator::top_allocators`] ranks the stacks by allocated bytes.
+//!
+//! The allocator implements [`Metric`], so its counts can be [`register`](crate::metrics::register)ed for export.
+//!
+//! [`emscripten_get_callstack`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_get_callstack
+
+use std::{
+    alloc::{GlobalAlloc, Layout, System},
+    cell::Cell,
+    collections::HashMap,
+    fmt::Write,
+    sync::atomic::{AtomicU32, AtomicU64, AtomicUsize, Ordering},
+};
+
+use crate::{
+    metrics::Metric,
+    profiler::{callstack, fold},
+    sync::Mutex,
+};
+
+/// The number of size classes: class 0 holds the allocations of 0 and 1 bytes, and class `n` the ones of `2^(n-1) + 1` to `2^n` bytes.
+pub const SIZE_CLASSES: usize = usize::BITS as usize + 1;
+
+// Returns the size class of an allocation size.
+fn size_class(size: usize) -> usize {
+    if size <= 1 {
+        0
+    } else {
+        (usize::BITS - (size - 1).leading_zeros()) as usize
+    }
+}
+
+/// A tag the allocations of a code section are counted in, to be stored in a `static` and entered with [`tag_scope`].
+///
+/// # Examples
+/// ```rust
+/// static PATHFINDING: AllocTag = AllocTag::new("pathfinding");
+///
+/// {
+///     let _tag = tag_scope(&PATHFINDING);
+///     find_paths(&mut agents);
+/// }
+/// println!("{} allocations, {} bytes", PATHFINDING.allocations(), PATHFINDING.bytes());
+/// ```
+#[derive(Debug)]
+pub struct AllocTag {
+    name: &'static str,
+    allocations: AtomicU64,
+    bytes: AtomicU64,
+}
+
+impl AllocTag {
+    /// Creates a tag without allocations.
+    pub const fn new(name: &'static str) -> Self {
+        Self {
+            name,
+            allocations: AtomicU64::new(0),
+            bytes: AtomicU64::new(0),
+        }
+    }
+
+    /// Returns the name of the tag.
+    pub fn name(&self) -> &'static str {
+        self.name
+    }
+
+    /// Returns the number of allocations made under the tag.
+    pub fn allocations(&self) -> u64 {
+        self.allocations.load(Ordering::Relaxed)
+    }
+
+    /// Returns the number of bytes allocated under the tag, the freed ones included.
+    pub fn bytes(&self) -> u64 {
+        self.bytes.load(Ordering::Relaxed)
+    }
+
+    /// Sets the counts of the tag back to zero, e.g. at the start of a frame.
+    pub fn reset(&self) {
+        self.allocations.store(0, Ordering::Relaxed);
+        self.bytes.store(0, Ordering::Relaxed);
+    }
+}
+
+thread_local! {
+    // The tag the calling thread's allocations are counted in.
+    static CURRENT_TAG: Cell<Option<&'static AllocTag>> = const { Cell::new(None) };
+    static THREAD_ALLOCATIONS: Cell<u64> = const { Cell::new(0) };
+    static THREAD_BYTES: Cell<u64> = const { Cell::new(0) };
+    // Set while a call stack is being sampled, whose own allocations aren't sampled.
+    static SAMPLING: Cell<bool> = const { Cell::new(false) };
+}
+
+/// The tag entered by [`tag_scope`], left when dropped.
+#[must_use = "the tag is left when the guard is dropped"]
+pub struct TagScope {
+    previous: Option<&'static AllocTag>,
+}
+
+impl Drop for TagScope {
+    fn drop(&mut self) {
+        CURRENT_TAG.with(|tag| tag.set(self.previous));
+    }
+}
+
+/// Counts the calling thread's allocations in the given tag, until the returned guard is dropped.
+/// The scopes nest: the tag that was entered before is entered again afterwards.
+pub fn tag_scope(tag: &'static AllocTag) -> TagScope {
+    TagScope {
+        previous: CURRENT_TAG.with(|current| current.replace(Some(tag))),
+    }
+}
+
+/// The allocations of the calling thread, returned by [`thread_stats`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct ThreadAllocStats {
+    /// The number of allocations the thread made.
+    pub allocations: u64,
+    /// The number of bytes the thread allocated, the freed ones included.
+    pub bytes: u64,
+}
+
+/// Returns the counts of the calling thread's allocations, made through a [`TrackingAllocator`].
+pub fn thread_stats() -> ThreadAllocStats {
+    ThreadAllocStats {
+        allocations: THREAD_ALLOCATIONS.with(Cell::get),
+        bytes: THREAD_BYTES.with(Cell::get),
+    }
+}
+
+/// The counts of a [`TrackingAllocator`], returned by [`TrackingAllocator::stats`].
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct AllocStats {
+    /// The number of allocations, reallocations included.
+    pub allocations: u64,
+    /// The number of deallocations, reallocations included.
+    pub deallocations: u64,
+    /// The number of bytes allocated and not freed yet.
+    pub live_bytes: usize,
+    /// The highest number of live bytes reached.
+    pub peak_bytes: usize,
+    /// The number of allocations by size class, see [`SIZE_CLASSES`].
+    pub size_classes: [u64; SIZE_CLASSES],
+}
+
+/// An allocation call stack found by the sampling, returned by [`TrackingAllocator::top_allocators`].
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct AllocSite {
+    /// The call stack in the folded format of the [`profiler`](crate::profiler): the frames from the outermost one, separated by `;`.
+    pub stack: String,
+    /// The number of sampled allocations made from the stack.
+    pub samples: u64,
+    /// The number of bytes of the sampled allocations.
+    pub bytes: u64,
+}
+
+// The sampled call stacks, with their numbers of samples and bytes.
+static SAMPLES: Mutex<Option<HashMap<String, (u64, u64)>>> = Mutex::new(None);
+
+// Runs the function with the sampled call stacks, without sampling the allocations it makes: that would lock them again.
+fn with_samples<R>(f: impl FnOnce(&mut Option<HashMap<String, (u64, u64)>>) -> R) -> R {
+    let was_sampling = SAMPLING.with(|sampling| sampling.replace(true));
+    let result = f(&mut SAMPLES.lock());
+    SAMPLING.with(|sampling| sampling.set(was_sampling));
+    result
+}
+
+/// A [`GlobalAlloc`] wrapper counting the allocations of the wrapped allocator.
+pub struct TrackingAllocator<A = System> {
+    inner: A,
+    allocations: AtomicU64,
+    deallocations: AtomicU64,
+    live_bytes: AtomicUsize,
+    peak_bytes: AtomicUsize,
+    size_classes: [AtomicU64; SIZE_CLASSES],
+    // One allocation in `stack_every` has its call stack sampled, none if 0.
+    stack_every: AtomicU32,
+}
+
+impl<A> TrackingAllocator<A> {
+    /// Wraps the given allocator, without stack sampling.
+    pub const fn new(inner: A) -> Self {
+        Self {
+            inner,
+            allocations: AtomicU64::new(0),
+            deallocations: AtomicU64::new(0),
+            live_bytes: AtomicUsize::new(0),
+            peak_bytes: AtomicUsize::new(0),
+            size_classes: [const { AtomicU64::new(0) }; SIZE_CLASSES],
+            stack_every: AtomicU32::new(0),
+        }
+    }
+
+    /// Captures the call stack of one allocation in `every`, or stops the sampling if it's 0.
+    /// Capturing a call stack takes a JS stack walk, so the interval should be large, e.g. 1000.
+    pub fn set_stack_sampling(&self, every: u32) {
+        self.stack_every.store(every, Ordering::Relaxed);
+    }
+
+    /// Returns the counts of the allocator.
+    pub fn stats(&self) -> AllocStats {
+        AllocStats {
+            allocations: self.allocations.load(Ordering::Relaxed),
+            deallocations: self.deallocations.load(Ordering::Relaxed),
+            live_bytes: self.live_bytes.load(Ordering::Relaxed),
+            peak_bytes: self.peak_bytes.load(Ordering::Relaxed),
+            size_classes: std::array::from_fn(|class| {
+                self.size_classes[class].load(Ordering::Relaxed)
+            }),
+        }
+    }
+
+    /// Returns the `count` sampled call stacks that allocated the most bytes, the most first.
+    pub fn top_allocators(&self, count: usize) -> Vec<AllocSite> {
+        let mut sites: Vec<AllocSite> = with_samples(|samples| {
+            samples.as_ref().map_or(Vec::new(), |samples| {
+                samples
+                    .iter()
+                    .map(|(stack, &(samples, bytes))| AllocSite {
+                        stack: stack.clone(),
+                        samples,
+                        bytes,
+                    })
+                    .collect()
+            })
+        });
+        sites.sort_unstable_by(|a, b| b.bytes.cmp(&a.bytes));
+        sites.truncate(count);
+        sites
+    }
+
+    /// Discards the sampled call stacks.
+    pub fn clear_samples(&self) {
+        with_samples(|samples| *samples = None);
+    }
+
+    fn record_alloc(&self, size: usize) {
+        let allocation = self.allocations.fetch_add(1, Ordering::Relaxed);
+        self.size_classes[size_class(size)].fetch_add(1, Ordering::Relaxed);
+        let live = self.live_bytes.fetch_add(size, Ordering::Relaxed) + size;
+        self.peak_bytes.fetch_max(live, Ordering::Relaxed);
+
+        // The thread-locals are `const`-initialized without destructors, so they're available during the whole thread's life.
+        let _ = THREAD_ALLOCATIONS.try_with(|count| count.set(count.get() + 1));
+        let _ = THREAD_BYTES.try_with(|bytes| bytes.set(bytes.get() + size as u64));
+        if let Ok(Some(tag)) = CURRENT_TAG.try_with(Cell::get) {
+            tag.allocations.fetch_add(1, Ordering::Relaxed);
+            tag.bytes.fetch_add(size as u64, Ordering::Relaxed);
+        }
+
+        let every = self.stack_every.load(Ordering::Relaxed);
+        if every != 0 && allocation % every as u64 == 0 {
+            sample(size);
+        }
+    }
+
+    fn record_dealloc(&self, size: usize) {
+        self.deallocations.fetch_add(1, Ordering::Relaxed);
+        self.live_bytes.fetch_sub(size, Ordering::Relaxed);
+    }
+}
+
+// Captures the call stack of an allocation. The allocations it makes itself are counted, but not sampled.
+#[inline(never)]
+fn sample(size: usize) {
+    if SAMPLING.try_with(|sampling| sampling.replace(true)) != Ok(false) {
+        return;
+    }
+    let stack = fold(&callstack(), "tracking_alloc::");
+    with_samples(|samples| {
+        let entry = samples
+            .get_or_insert_with(HashMap::new)
+            .entry(stack)
+            .or_insert((0, 0));
+        entry.0 += 1;
+        entry.1 += size as u64;
+    });
+    SAMPLING.with(|sampling| sampling.set(false));
+}
+
+unsafe impl<A: GlobalAlloc> GlobalAlloc for TrackingAllocator<A> {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        let allocation = self.inner.alloc(layout);
+        if !allocation.is_null() {
+            self.record_alloc(layout.size());
+        }
+        allocation
+    }
+
+    unsafe fn alloc_zeroed(&self, layout: Layout) -> *mut u8 {
+        let allocation = self.inner.alloc_zeroed(layout);
+        if !allocation.is_null() {
+            self.record_alloc(layout.size());
+        }
+        allocation
+    }
+
+    unsafe fn dealloc(&self, allocation: *mut u8, layout: Layout) {
+        self.inner.dealloc(allocation, layout);
+        self.record_dealloc(layout.size());
+    }
+
+    unsafe fn realloc(&self, allocation: *mut u8, layout: Layout, new_size: usize) -> *mut u8 {
+        let reallocation = self.inner.realloc(allocation, layout, new_size);
+        if !reallocation.is_null() {
+            self.record_dealloc(layout.size());
+            self.record_alloc(new_size);
+        }
+        reallocation
+    }
+}
+
+impl<A: Sync> Metric for TrackingAllocator<A> {
+    fn name(&self) -> &'static str {
+        "allocator"
+    }
+
+    /// Writes the counts of the allocator. Unlike the other metrics, they are totals since the start, which the export doesn't reset.
+    fn export(&self, out: &mut String) {
+        let stats = self.stats();
+        let _ = write!(
+            out,
+            "{{\"allocations\":{},\"deallocations\":{},\"live_bytes\":{},\"peak_bytes\":{},\"size_classes\":[",
+            stats.allocations, stats.deallocations, stats.live_bytes, stats.peak_bytes
+        );
+        for (i, count) in stats.size_classes.iter().enumerate() {
+            if i > 0 {
+                out.push(',');
+            }
+            let _ = write!(out, "{}", count);
+        }
+        out.push_str("]}");
+    }
+}
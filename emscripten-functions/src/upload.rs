@@ -0,0 +1,427 @@
+//! Uploads of large buffers and files in fixed-size chunks, built on the [`fetch`](crate::fetch) module.
+//!
+//! A single fetch with the whole body needs a copy of it at once, and starts over from the first byte when it fails.
+//! A [`ChunkedUpload`] instead reads the data from its [`UploadSource`] one chunk at a time, so that only one chunk is in memory,
+//! and sends each chunk in its own request to the same URL, with a `Content-Range: bytes <first>-<last>/<total>` header.
+//! A failed chunk is sent again a few times, after a growing delay; an upload that failed anyway can be resumed from
+//! the offset in its error, with [`ChunkedUpload::resume_from`].
+//!
+//! The server must accept the chunks in order, as with the resumable uploads of many storage services.
+
+use std::{
+    cell::{Cell, RefCell},
+    fmt::Display,
+    fs::File,
+    io::{self, Read, Seek, SeekFrom},
+    rc::Rc,
+};
+
+use crate::{
+    fetch::{FetchHandle, FetchRequest, FetchResponse},
+    timers::{set_timeout, TimerHandle},
+};
+
+/// The default size of the chunks of an upload, in bytes.
+pub const DEFAULT_CHUNK_SIZE: usize = 8 << 20;
+
+/// The default number of times a failed chunk is sent again before the upload fails.
+pub const DEFAULT_MAX_RETRIES: u32 = 3;
+
+/// The default delay before the first retry of a chunk, in milliseconds; it doubles with each retry.
+pub const DEFAULT_RETRY_DELAY: f64 = 500.0;
+
+/// The data of a [`ChunkedUpload`], read one chunk at a time.
+///
+/// It's implemented for byte vectors and shared slices, and for files, e.g. crash dumps written with `std::fs`.
+pub trait UploadSource {
+    /// Returns the number of bytes to upload.
+    fn size(&mut self) -> io::Result<u64>;
+
+    /// Fills `buf` with the bytes starting at `offset`.
+    fn read_at(&mut self, offset: u64, buf: &mut [u8]) -> io::Result<()>;
+}
+
+fn read_slice(data: &[u8], offset: u64, buf: &mut [u8]) -> io::Result<()> {
+    let chunk = usize::try_from(offset)
+        .ok()
+        .and_then(|start| data.get(start..start.checked_add(buf.len())?))
+        .ok_or(io::ErrorKind::UnexpectedEof)?;
+    buf.copy_from_slice(chunk);
+    Ok(())
+}
+
+impl UploadSource for Vec<u8> {
+    fn size(&mut self) -> io::Result<u64> {
+        Ok(self.len() as u64)
+    }
+
+    fn read_at(&mut self, offset: u64, buf: &mut [u8]) -> io::Result<()> {
+        read_slice(self, offset, buf)
+    }
+}
+
+impl UploadSource for Rc<[u8]> {
+    fn size(&mut self) -> io::Result<u64> {
+        Ok(self.len() as u64)
+    }
+
+    fn read_at(&mut self, offset: u64, buf: &mut [u8]) -> io::Result<()> {
+        read_slice(self, offset, buf)
+    }
+}
+
+impl UploadSource for File {
+    fn size(&mut self) -> io::Result<u64> {
+        Ok(self.metadata()?.len())
+    }
+
+    fn read_at(&mut self, offset: u64, buf: &mut [u8]) -> io::Result<()> {
+        self.seek(SeekFrom::Start(offset))?;
+        self.read_exact(buf)
+    }
+}
+
+/// The error of a [`ChunkedUpload`]. The bytes before its [`offset`](Self::offset) were uploaded.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum UploadError {
+    /// The source couldn't be read at the given offset.
+    Source(u64),
+    /// The chunk at the given offset failed with the given HTTP status, 0 if the server was unreachable, after all its retries.
+    Status {
+        /// The offset of the chunk.
+        offset: u64,
+        /// The HTTP status of its last attempt.
+        status: u16,
+    },
+}
+
+impl UploadError {
+    /// Returns the number of bytes uploaded before the error, to give to [`ChunkedUpload::resume_from`].
+    pub fn offset(&self) -> u64 {
+        match self {
+            Self::Source(offset) => *offset,
+            Self::Status { offset, .. } => *offset,
+        }
+    }
+}
+
+impl Display for UploadError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        match self {
+            Self::Source(offset) => {
+                write!(f, "The upload source couldn't be read at byte {}", offset)
+            }
+            Self::Status { offset, status } => write!(
+                f,
+                "The upload chunk at byte {} failed with status {}",
+                offset, status
+            ),
+        }
+    }
+}
+
+// Whether a chunk failing with the given status may succeed when sent again.
+fn is_retryable(status: u16) -> bool {
+    matches!(status, 0 | 408 | 429) || status >= 500
+}
+
+type OnProgress = Box<dyn FnMut(u64, u64)>;
+type OnDone = Box<dyn FnOnce(Result<FetchResponse, UploadError>)>;
+
+struct UploadState {
+    url: String,
+    method: String,
+    headers: Vec<(String, String)>,
+    chunk_size: usize,
+    max_retries: u32,
+    retry_delay: f64,
+    source: RefCell<Box<dyn UploadSource>>,
+    total: u64,
+    // The number of bytes acknowledged by the server.
+    offset: Cell<u64>,
+    // The number of retries of the current chunk.
+    retries: Cell<u32>,
+    fetch: RefCell<Option<FetchHandle>>,
+    timer: Cell<Option<TimerHandle>>,
+    pending: Cell<bool>,
+    onprogress: RefCell<Option<OnProgress>>,
+    ondone: RefCell<Option<OnDone>>,
+}
+
+impl UploadState {
+    // Reads the chunk at the current offset and sends it.
+    fn send_chunk(self: &Rc<Self>) {
+        let offset = self.offset.get();
+        let len = (self.total - offset).min(self.chunk_size as u64) as usize;
+        let mut chunk = vec![0; len];
+        if self
+            .source
+            .borrow_mut()
+            .read_at(offset, &mut chunk)
+            .is_err()
+        {
+            self.finish(Err(UploadError::Source(offset)));
+            return;
+        }
+
+        // An empty source, or one already uploaded when resuming, is finished with an empty request.
+        let range = if len == 0 {
+            format!("bytes */{}", self.total)
+        } else {
+            format!(
+                "bytes {}-{}/{}",
+                offset,
+                offset + len as u64 - 1,
+                self.total
+            )
+        };
+        let mut request = FetchRequest::new(self.url.clone()).method(self.method.clone());
+        for (name, value) in &self.headers {
+            request = request.header(name.clone(), value.clone());
+        }
+
+        let success_state = self.clone();
+        let error_state = self.clone();
+        let handle = request
+            .header("Content-Range", range)
+            .body(chunk)
+            .on_success(move |response| success_state.chunk_sent(len, response))
+            .on_error(move |response| error_state.chunk_failed(response.status()))
+            .send();
+        match handle {
+            Some(handle) => *self.fetch.borrow_mut() = Some(handle),
+            None => self.chunk_failed(0),
+        }
+    }
+
+    fn chunk_sent(self: &Rc<Self>, len: usize, response: FetchResponse) {
+        self.fetch.borrow_mut().take();
+        self.retries.set(0);
+        let offset = self.offset.get() + len as u64;
+        self.offset.set(offset);
+
+        let onprogress = self.onprogress.borrow_mut().take();
+        if let Some(mut onprogress) = onprogress {
+            onprogress(offset, self.total);
+            if self.pending.get() {
+                self.onprogress.borrow_mut().get_or_insert(onprogress);
+            }
+        }
+        if !self.pending.get() {
+            // Aborted by the progress handler.
+            return;
+        }
+
+        if offset < self.total {
+            self.send_chunk();
+        } else {
+            self.finish(Ok(response));
+        }
+    }
+
+    fn chunk_failed(self: &Rc<Self>, status: u16) {
+        self.fetch.borrow_mut().take();
+        let retries = self.retries.get();
+        if retries >= self.max_retries || !is_retryable(status) {
+            self.finish(Err(UploadError::Status {
+                offset: self.offset.get(),
+                status,
+            }));
+            return;
+        }
+
+        self.retries.set(retries + 1);
+        let state = self.clone();
+        let delay = self.retry_delay * 2f64.powi(retries as i32);
+        self.timer.set(Some(set_timeout(
+            move || {
+                state.timer.set(None);
+                state.send_chunk();
+            },
+            delay,
+        )));
+    }
+
+    fn finish(&self, result: Result<FetchResponse, UploadError>) {
+        self.pending.set(false);
+        self.onprogress.borrow_mut().take();
+        let ondone = self.ondone.borrow_mut().take();
+        if let Some(ondone) = ondone {
+            ondone(result);
+        }
+    }
+}
+
+/// A description of a chunked upload, built with chained method calls and started with [`ChunkedUpload::send`].
+/// See the [module documentation](self).
+///
+/// # Examples
+/// ```rust
+/// let dump = std::fs::File::open("/tmp/crash.dmp").unwrap();
+///
+/// ChunkedUpload::new("https://example.com/api/crashes/1234")
+///     .header("Authorization", token)
+///     .on_progress(|sent, total| println!("{} of {} bytes", sent, total))
+///     .send(dump, |result| match result {
+///         Ok(response) => println!("Uploaded: {}", response.status()),
+///         // Kept to resume the upload on the next run.
+///         Err(err) => save_resume_offset(err.offset()),
+///     });
+/// ```
+pub struct ChunkedUpload {
+    url: String,
+    method: String,
+    headers: Vec<(String, String)>,
+    chunk_size: usize,
+    max_retries: u32,
+    retry_delay: f64,
+    start: u64,
+    onprogress: Option<OnProgress>,
+}
+
+impl ChunkedUpload {
+    /// Creates a `PUT` upload to the given URL, in chunks of [`DEFAULT_CHUNK_SIZE`] bytes.
+    pub fn new<T>(url: T) -> Self
+    where
+        T: Into<String>,
+    {
+        Self {
+            url: url.into(),
+            method: "PUT".to_string(),
+            headers: Vec::new(),
+            chunk_size: DEFAULT_CHUNK_SIZE,
+            max_retries: DEFAULT_MAX_RETRIES,
+            retry_delay: DEFAULT_RETRY_DELAY,
+            start: 0,
+            onprogress: None,
+        }
+    }
+
+    /// Sets the HTTP method of the chunk requests, e.g. `"POST"`. It must be shorter than 32 bytes.
+    pub fn method<T>(mut self, method: T) -> Self
+    where
+        T: Into<String>,
+    {
+        self.method = method.into();
+        self
+    }
+
+    /// Adds a header to all the chunk requests.
+    pub fn header<T, U>(mut self, name: T, value: U) -> Self
+    where
+        T: Into<String>,
+        U: Into<String>,
+    {
+        self.headers.push((name.into(), value.into()));
+        self
+    }
+
+    /// Sets the size of the chunks, in bytes, which is also about the memory the upload takes. It must not be 0.
+    pub fn chunk_size(mut self, chunk_size: usize) -> Self {
+        assert!(chunk_size > 0, "the chunk size must not be 0");
+        self.chunk_size = chunk_size;
+        self
+    }
+
+    /// Sets the number of times a chunk that failed is sent again, [`DEFAULT_MAX_RETRIES`] by default.
+    ///
+    /// Only the chunks that failed because the server was unreachable, timed out, was overloaded or failed (a 5xx status) are retried.
+    pub fn max_retries(mut self, max_retries: u32) -> Self {
+        self.max_retries = max_retries;
+        self
+    }
+
+    /// Sets the delay before the first retry of a chunk, in milliseconds, [`DEFAULT_RETRY_DELAY`] by default. It doubles with each retry.
+    pub fn retry_delay(mut self, retry_delay: f64) -> Self {
+        self.retry_delay = retry_delay;
+        self
+    }
+
+    /// Starts the upload at the given offset of the source, e.g. from the [`UploadError::offset`] of a previous attempt.
+    pub fn resume_from(mut self, offset: u64) -> Self {
+        self.start = offset;
+        self
+    }
+
+    /// Sets the function called with the number of bytes uploaded and the total number of bytes, after each chunk.
+    pub fn on_progress<F>(mut self, onprogress: F) -> Self
+    where
+        F: 'static + FnMut(u64, u64),
+    {
+        self.onprogress = Some(Box::new(onprogress));
+        self
+    }
+
+    /// Starts uploading the source, returning a handle that can abort the upload.
+    ///
+    /// # Arguments
+    /// * `source` - The data to upload.
+    /// * `ondone` - The function called with the response to the last chunk, or the error.
+    pub fn send<S, F>(self, mut source: S, ondone: F) -> UploadHandle
+    where
+        S: 'static + UploadSource,
+        F: 'static + FnOnce(Result<FetchResponse, UploadError>),
+    {
+        let total = source.size();
+        let state = Rc::new(UploadState {
+            url: self.url,
+            method: self.method,
+            headers: self.headers,
+            chunk_size: self.chunk_size,
+            max_retries: self.max_retries,
+            retry_delay: self.retry_delay,
+            source: RefCell::new(Box::new(source)),
+            total: total.as_ref().copied().unwrap_or(0),
+            offset: Cell::new(0),
+            retries: Cell::new(0),
+            fetch: RefCell::new(None),
+            timer: Cell::new(None),
+            pending: Cell::new(true),
+            onprogress: RefCell::new(self.onprogress),
+            ondone: RefCell::new(Some(Box::new(ondone))),
+        });
+
+        match total {
+            Ok(total) => {
+                state.offset.set(self.start.min(total));
+                state.send_chunk();
+            }
+            Err(_) => state.finish(Err(UploadError::Source(0))),
+        }
+        UploadHandle { state }
+    }
+}
+
+/// The handle of a started [`ChunkedUpload`]. Dropping it doesn't abort the upload.
+pub struct UploadHandle {
+    state: Rc<UploadState>,
+}
+
+impl UploadHandle {
+    /// Returns `true` if the upload hasn't finished nor been aborted yet.
+    pub fn is_pending(&self) -> bool {
+        self.state.pending.get()
+    }
+
+    /// Returns the number of bytes uploaded so far.
+    pub fn offset(&self) -> u64 {
+        self.state.offset.get()
+    }
+
+    /// Aborts the upload, and its running chunk request. Its functions won't be called anymore.
+    ///
+    /// It does nothing if the upload already finished.
+    pub fn abort(&self) {
+        if !self.state.pending.replace(false) {
+            return;
+        }
+        if let Some(fetch) = self.state.fetch.borrow_mut().take() {
+            fetch.abort();
+        }
+        if let Some(timer) = self.state.timer.take() {
+            timer.cancel();
+        }
+        self.state.onprogress.borrow_mut().take();
+        self.state.ondone.borrow_mut().take();
+    }
+}
@@ -0,0 +1,127 @@
+//! An opt-in policy that slows down or pauses the main loop while the page is hidden, built on the `visibilitychange` event.
+//!
+//! A background tab running the simulation at full rate wastes CPU and battery, while the browser throttles its timers anyway:
+//! the main loop then runs irregularly, and catch-up logic spikes when the tab comes back.
+//! The [`VisibilityThrottle`] instead pauses the main loop (or switches it to a slow timing) when the page gets hidden,
+//! and restores it when the page is visible again.
+
+use std::{cell::RefCell, rc::Rc};
+
+use crate::{
+    emscripten::{
+        get_main_loop_timing, pause_main_loop, resume_main_loop, set_main_loop_timing,
+        MainLoopTiming,
+    },
+    html5::{
+        events::{on_visibilitychange, EventListener},
+        get_visibility_status, Html5Error,
+    },
+};
+
+/// What a [`VisibilityThrottle`] does to the main loop while the page is hidden.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub enum HiddenPolicy {
+    /// Pauses the main loop, with [`pause_main_loop`].
+    Pause,
+    /// Runs the main loop with the given timing, e.g. `MainLoopTiming::SetTimeout(1000)` for one tick per second.
+    Timing(MainLoopTiming),
+}
+
+type OnChange = Box<dyn FnMut(bool)>;
+
+struct ThrottleState {
+    policy: HiddenPolicy,
+    // The timing to restore when the page is visible again, if the policy changed it.
+    saved_timing: Option<MainLoopTiming>,
+    paused: bool,
+    onchange: Option<OnChange>,
+}
+
+impl ThrottleState {
+    fn apply(&mut self, hidden: bool) {
+        match (&self.policy, hidden) {
+            (HiddenPolicy::Pause, true) if !self.paused => {
+                pause_main_loop();
+                self.paused = true;
+            }
+            (HiddenPolicy::Pause, false) if self.paused => {
+                resume_main_loop();
+                self.paused = false;
+            }
+            (HiddenPolicy::Timing(timing), true) if self.saved_timing.is_none() => {
+                self.saved_timing = get_main_loop_timing().ok();
+                set_main_loop_timing(timing);
+            }
+            (HiddenPolicy::Timing(_), false) => {
+                if let Some(timing) = self.saved_timing.take() {
+                    set_main_loop_timing(&timing);
+                }
+            }
+            _ => {}
+        }
+    }
+}
+
+/// Applies a [`HiddenPolicy`] to the calling thread's main loop while the page is hidden.
+///
+/// Dropping the throttle stops listening; a main loop that's paused or slowed down at that time stays so.
+///
+/// # Examples
+/// ```rust
+/// set_main_loop(simulate_and_draw, 0, false);
+///
+/// let throttle = VisibilityThrottle::new(HiddenPolicy::Pause).unwrap();
+/// throttle.on_change(|hidden| {
+///     if !hidden {
+///         // Don't try to catch up on the time spent in the background.
+///         reset_frame_clock();
+///     }
+/// });
+/// ```
+pub struct VisibilityThrottle {
+    state: Rc<RefCell<ThrottleState>>,
+    _listener: EventListener,
+}
+
+impl VisibilityThrottle {
+    /// Starts applying the policy. If the page is already hidden, it's applied right away.
+    pub fn new(policy: HiddenPolicy) -> Result<Self, Html5Error> {
+        let state = Rc::new(RefCell::new(ThrottleState {
+            policy,
+            saved_timing: None,
+            paused: false,
+            onchange: None,
+        }));
+
+        let listener_state = state.clone();
+        let listener = on_visibilitychange(false, move |event| {
+            let hidden = event.hidden != 0;
+            listener_state.borrow_mut().apply(hidden);
+
+            // The handler is taken out during the call, so that it can use the throttle.
+            let onchange = listener_state.borrow_mut().onchange.take();
+            if let Some(mut onchange) = onchange {
+                onchange(hidden);
+                listener_state.borrow_mut().onchange.get_or_insert(onchange);
+            }
+            false
+        })?;
+
+        if get_visibility_status()?.hidden != 0 {
+            state.borrow_mut().apply(true);
+        }
+
+        Ok(Self {
+            state,
+            _listener: listener,
+        })
+    }
+
+    /// Sets the function called with `true` when the page gets hidden, and `false` when it's visible again, after the policy was applied.
+    pub fn on_change<F>(&self, onchange: F)
+    where
+        F: 'static + FnMut(bool),
+    {
+        self.state.borrow_mut().onchange = Some(Box::new(onchange));
+    }
+}
@@ -0,0 +1,141 @@
+//! Safe spawning of and messaging with [Wasm Workers], over the emscripten `wasm_worker.h` header file.
+//!
+//! Wasm Workers are web workers sharing the program's memory, like pthreads, but without the pthread runtime:
+//! they start faster and cost less memory, at the price of having no `pthread_*` functions.
+//! They fit short-lived compute jobs, that only touch their arguments and shared atomics.
+//!
+//! The program must be built with `-sWASM_WORKERS`.
+//!
+//! [Wasm Workers]: https://emscripten.org/docs/api_reference/wasm_workers.html
+
+use std::{fmt::Display, os::raw::c_int};
+
+use emscripten_functions_sys::wasm_worker;
+
+type Job = Box<dyn FnOnce() + Send>;
+
+// Runs a job posted with `post_job`, on the receiving worker.
+unsafe extern "C" fn job_trampoline(job: c_int) {
+    let job = Box::from_raw(job as u32 as usize as *mut Job);
+    job();
+}
+
+fn post_job(id: c_int, job: Job) {
+    // Wasm pointers are 32 bits wide, so the box fits in the function's int argument: it goes through `u32` both ways,
+    // which keeps all its bits. A wider pointer, like on wasm64, would need a pointer-sized variant instead.
+    let job = u32::try_from(Box::into_raw(Box::new(job)) as usize)
+        .expect("the job pointer doesn't fit in 32 bits") as c_int;
+    unsafe {
+        wasm_worker::emscripten_wasm_worker_post_function_vi(id, Some(job_trampoline), job);
+    }
+}
+
+/// The error returned when a Wasm Worker couldn't be created.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct WasmWorkerSpawnError;
+
+impl Display for WasmWorkerSpawnError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        write!(f, "Failed to create the Wasm Worker")
+    }
+}
+
+/// A handle to a Wasm Worker, created with [`spawn`].
+///
+/// Dropping the handle doesn't stop the worker: it keeps running the functions posted to it, until it's terminated.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct WasmWorker {
+    id: c_int,
+}
+
+impl WasmWorker {
+    // The handle of an already created worker, e.g. the calling one from its `self_id`.
+    pub(crate) fn from_id(id: c_int) -> Self {
+        Self { id }
+    }
+
+    /// Returns the emscripten id of the worker.
+    pub fn id(&self) -> c_int {
+        self.id
+    }
+
+    /// Runs `func` on the worker, after the functions posted to it before, using the emscripten-defined `emscripten_wasm_worker_post_function_vi`.
+    ///
+    /// The function is boxed once, and only its pointer is passed in the message.
+    pub fn post<F>(&self, func: F)
+    where
+        F: 'static + Send + FnOnce(),
+    {
+        post_job(self.id, Box::new(func));
+    }
+
+    /// Terminates the worker, using the emscripten-defined `emscripten_terminate_wasm_worker`.
+    /// The functions posted to it that didn't run yet are leaked.
+    pub fn terminate(self) {
+        unsafe { wasm_worker::emscripten_terminate_wasm_worker(self.id) };
+    }
+}
+
+/// Creates a Wasm Worker with a stack of `stack_size` bytes allocated on the heap, and runs `func` on it,
+/// using the emscripten-defined `emscripten_malloc_wasm_worker`.
+///
+/// # Examples
+/// ```rust
+/// let (mut producer, mut consumer) = spsc::channel(1);
+/// let worker = spawn(64 * 1024, move || {
+///     let sum: u64 = (0..1_000_000u64).sum();
+///     producer.try_push(sum).unwrap();
+/// })
+/// .unwrap();
+/// ```
+pub fn spawn<F>(stack_size: usize, func: F) -> Result<WasmWorker, WasmWorkerSpawnError>
+where
+    F: 'static + Send + FnOnce(),
+{
+    let id = unsafe { wasm_worker::emscripten_malloc_wasm_worker(stack_size) };
+    if id == 0 {
+        return Err(WasmWorkerSpawnError);
+    }
+
+    let worker = WasmWorker { id };
+    worker.post(func);
+    Ok(worker)
+}
+
+/// Runs `func` on the thread that created the calling Wasm Worker.
+///
+/// Like all the messages from a worker, it's only run once that thread returns to its event loop.
+pub fn post_to_parent<F>(func: F)
+where
+    F: 'static + Send + FnOnce(),
+{
+    post_job(
+        wasm_worker::EMSCRIPTEN_WASM_WORKER_ID_PARENT as c_int,
+        Box::new(func),
+    );
+}
+
+/// Returns `true` if the calling thread is a Wasm Worker.
+pub fn current_thread_is_wasm_worker() -> bool {
+    unsafe { wasm_worker::emscripten_current_thread_is_wasm_worker() != 0 }
+}
+
+/// Returns the id of the calling Wasm Worker, or 0 if it's not a Wasm Worker.
+pub fn self_id() -> u32 {
+    unsafe { wasm_worker::emscripten_wasm_worker_self_id() }
+}
+
+/// Returns `navigator.hardwareConcurrency`, the number of logical cores the browser reports.
+pub fn hardware_concurrency() -> i32 {
+    unsafe { wasm_worker::emscripten_navigator_hardware_concurrency() }
+}
+
+/// Blocks the calling Wasm Worker for the given number of nanoseconds. It can't be called on the main browser thread.
+pub fn sleep(nanoseconds: i64) {
+    unsafe { wasm_worker::emscripten_wasm_worker_sleep(nanoseconds) };
+}
+
+/// Terminates all the Wasm Workers created by the calling thread.
+pub fn terminate_all() {
+    unsafe { wasm_worker::emscripten_terminate_all_wasm_workers() };
+}
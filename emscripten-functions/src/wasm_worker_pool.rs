@@ -0,0 +1,115 @@
+//! A pool of [Wasm Workers](crate::wasm_worker) running jobs on buffers moved to them, without copying the buffers.
+//!
+//! The [`WorkerPool`](crate::worker::WorkerPool) workers are separate programs, with their own memory: each call copies its data
+//! out of the heap into the message, and then into the worker's heap, and its response back the same way.
+//! For jobs on large buffers, like the decompression of tens of megabytes, these copies take a big part of the job's time.
+//!
+//! Wasm Workers share the program's memory, so a [`WasmWorkerPool`] job only moves the ownership of its input, e.g. a `Vec<u8>`,
+//! to the worker, and of its output back: the messages only carry pointers. The results are handed to a callback on the thread that created the pool.
+//!
+//! The program must be built with `-sWASM_WORKERS`, which needs `SharedArrayBuffer`, so the COOP/COEP headers.
+
+use std::{cell::Cell, rc::Rc};
+
+use crate::wasm_worker::{self, post_to_parent, WasmWorker, WasmWorkerSpawnError};
+
+/// The stack size of the pool's workers used by [`WasmWorkerPool::new`], in bytes.
+pub const DEFAULT_STACK_SIZE: usize = 256 * 1024;
+
+struct Reply<R> {
+    outstanding: Rc<Vec<Cell<usize>>>,
+    worker: usize,
+    onresult: Box<dyn FnOnce(R)>,
+}
+
+/// A pool of Wasm Workers, that dispatches each job to the worker with the fewest unfinished jobs.
+///
+/// Dropping the pool doesn't stop the workers: the jobs dispatched to them still run, and their callbacks are called.
+///
+/// # Examples
+/// ```rust
+/// let pool = WasmWorkerPool::new(4).unwrap();
+/// pool.call(compressed, |compressed: Vec<u8>| inflate(&compressed), |pixels: Vec<u8>| {
+///     upload_texture(&pixels);
+/// });
+/// ```
+pub struct WasmWorkerPool {
+    workers: Vec<WasmWorker>,
+    // The number of jobs dispatched to each worker that didn't call back yet.
+    outstanding: Rc<Vec<Cell<usize>>>,
+}
+
+impl WasmWorkerPool {
+    /// Creates `count` workers, with stacks of [`DEFAULT_STACK_SIZE`] bytes.
+    pub fn new(count: usize) -> Result<Self, WasmWorkerSpawnError> {
+        Self::with_stack_size(count, DEFAULT_STACK_SIZE)
+    }
+
+    /// Creates `count` workers, with stacks of `stack_size` bytes allocated on the heap.
+    pub fn with_stack_size(count: usize, stack_size: usize) -> Result<Self, WasmWorkerSpawnError> {
+        assert!(count > 0, "the pool must have at least 1 worker");
+
+        let workers = (0..count)
+            .map(|_| wasm_worker::spawn(stack_size, || {}))
+            .collect::<Result<Vec<_>, _>>()?;
+        Ok(Self {
+            workers,
+            outstanding: Rc::new((0..count).map(|_| Cell::new(0)).collect()),
+        })
+    }
+
+    /// Returns the number of workers in the pool.
+    pub fn worker_count(&self) -> usize {
+        self.workers.len()
+    }
+
+    /// Returns the number of the pool's jobs that didn't call back yet.
+    pub fn pending_jobs(&self) -> usize {
+        self.outstanding.iter().map(Cell::get).sum()
+    }
+
+    /// Runs `func` with `input` on the least loaded worker, then `onresult` with its output on the calling thread,
+    /// once it returns to its event loop.
+    ///
+    /// The input and output are moved between the threads, not copied: for a `Vec<u8>`, only its pointer is passed.
+    ///
+    /// # Arguments
+    /// * `input` - The input of the job, moved to the worker.
+    /// * `func` - The job, run on the worker.
+    /// * `onresult` - The function called with the output of the job, on the calling thread.
+    pub fn call<T, R, F, C>(&self, input: T, func: F, onresult: C)
+    where
+        T: 'static + Send,
+        R: 'static + Send,
+        F: 'static + Send + FnOnce(T) -> R,
+        C: 'static + FnOnce(R),
+    {
+        let worker = (0..self.workers.len())
+            .min_by_key(|&index| self.outstanding[index].get())
+            .unwrap();
+        self.outstanding[worker].set(self.outstanding[worker].get() + 1);
+
+        let reply = Box::new(Reply {
+            outstanding: self.outstanding.clone(),
+            worker,
+            onresult: Box::new(onresult),
+        });
+        // The reply goes to the worker and back as an address: it's only dereferenced on the pool's thread.
+        let reply = Box::into_raw(reply) as usize;
+
+        self.workers[worker].post(move || {
+            let output = func(input);
+            post_to_parent(move || {
+                let reply = unsafe { Box::from_raw(reply as *mut Reply<R>) };
+                let outstanding = &reply.outstanding[reply.worker];
+                outstanding.set(outstanding.get() - 1);
+                (reply.onresult)(output);
+            });
+        });
+    }
+
+    /// Returns the workers of the pool.
+    pub fn workers(&self) -> &[WasmWorker] {
+        &self.workers
+    }
+}
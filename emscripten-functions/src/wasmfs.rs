@@ -0,0 +1,168 @@
+//! Mounting [WasmFS] storage backends at paths, over the emscripten `wasmfs.h` header file, so that `std::fs` works against them.
+//!
+//! The [`Backend::opfs`] one stores files in the Origin Private File System, persistent per origin,
+//! with synchronous high-throughput access: much faster than IndexedDB for large sequential reads.
+//! Its file operations are proxied to a worker it starts, so they can also be done from the main thread, at the cost of the round trip.
+//!
+//! The program must be built with `-sWASMFS`, and with `-pthread` for the OPFS backend.
+//!
+//! [WasmFS]: https://emscripten.org/docs/api_reference/Filesystem-API.html#new-file-system-wasmfs
+
+use std::{
+    fs::File,
+    io,
+    os::{fd::FromRawFd, raw::c_int},
+    path::Path,
+};
+
+use emscripten_functions_sys::wasmfs;
+
+use crate::c_str::with_c_str;
+
+// Converts the result of a WasmFS function, a negative errno on failure.
+fn check(result: c_int) -> io::Result<c_int> {
+    if result < 0 {
+        Err(io::Error::from_raw_os_error(-result))
+    } else {
+        Ok(result)
+    }
+}
+
+/// A WasmFS storage backend. Backends live as long as the program, so the handle can be copied freely.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Backend(wasmfs::backend_t);
+
+// Backends are only referenced by WasmFS, whose calls are thread-safe.
+unsafe impl Send for Backend {}
+unsafe impl Sync for Backend {}
+
+impl Backend {
+    /// Creates a backend keeping the files in the wasm memory, lost on reload.
+    pub fn memory() -> Self {
+        Self(unsafe { wasmfs::wasmfs_create_memory_backend() })
+    }
+
+    /// Creates a backend storing the files in the Origin Private File System.
+    pub fn opfs() -> Self {
+        Self(unsafe { wasmfs::wasmfs_create_opfs_backend() })
+    }
+
+    /// Creates a read-only backend whose files are downloaded on first access, from the given base URL followed by their path in the mount.
+    pub fn fetch(base_url: &str) -> Self {
+        with_c_str(base_url, |base_url| {
+            Self(unsafe { wasmfs::wasmfs_create_fetch_backend(base_url) })
+        })
+    }
+
+    /// Creates a backend keeping the files in JS typed arrays, outside the wasm memory.
+    pub fn js_file() -> Self {
+        Self(unsafe { wasmfs::wasmfs_create_js_file_backend() })
+    }
+
+    /// Creates a backend forwarding to the host file system under `root`, when running in Node.js.
+    pub fn node(root: &str) -> Self {
+        with_c_str(root, |root| {
+            Self(unsafe { wasmfs::wasmfs_create_node_backend(root) })
+        })
+    }
+
+    /// Creates a backend over the given one with case-insensitive paths, e.g. for assets of games made on Windows.
+    pub fn case_insensitive(backend: Backend) -> Self {
+        Self(unsafe { wasmfs::wasmfs_create_icase_backend(backend.0) })
+    }
+
+    /// Returns the backend of the given path.
+    pub fn of_path(path: &str) -> Option<Self> {
+        let backend = with_c_str(path, |path| unsafe {
+            wasmfs::wasmfs_get_backend_by_path(path as *mut _)
+        });
+        (!backend.is_null()).then_some(Self(backend))
+    }
+
+    /// Returns the underlying WasmFS backend.
+    pub fn as_raw(&self) -> wasmfs::backend_t {
+        self.0
+    }
+}
+
+/// Creates a directory at `path` whose contents are stored in `backend`, using the emscripten-defined `wasmfs_create_directory`.
+/// The parent directory must exist, and `path` mustn't.
+///
+/// # Examples
+/// ```rust
+/// mount("/saves", Backend::opfs()).unwrap();
+/// std::fs::write("/saves/slot1.bin", &save_data).unwrap();
+///
+/// mount("/assets", Backend::fetch("https://cdn.example.com/assets")).unwrap();
+/// let level = std::fs::read("/assets/level1.bin").unwrap();
+/// ```
+pub fn mount(path: &str, backend: Backend) -> io::Result<()> {
+    with_c_str(path, |path| {
+        check(unsafe { wasmfs::wasmfs_create_directory(path, 0o777, backend.0) })
+    })
+    .map(|_| ())
+}
+
+/// Removes a directory created with [`mount`], using the emscripten-defined `wasmfs_unmount`.
+pub fn unmount(path: &str) -> io::Result<()> {
+    with_c_str(path, |path| {
+        check(unsafe { wasmfs::wasmfs_unmount(path as isize) })
+    })
+    .map(|_| ())
+}
+
+/// Creates a file at `path` stored in `backend`, whatever the backend of its directory, using the emscripten-defined `wasmfs_create_file`.
+/// Returns its file descriptor, open for reading and writing.
+pub fn create_file(path: &str, mode: u32, backend: Backend) -> io::Result<c_int> {
+    with_c_str(path, |path| {
+        check(unsafe { wasmfs::wasmfs_create_file(path, mode, backend.0) })
+    })
+}
+
+/// Mounts a fetch backend at `path`, with empty placeholders for the files listed in `manifest`:
+/// each file is only downloaded the first time it's read, e.g. through `std::fs::File`, and then kept in memory.
+///
+/// This way, only the files a program actually uses get downloaded, unlike with a preloaded `.data` package.
+///
+/// # Arguments
+/// * `path` - The directory to mount the files at; it mustn't exist.
+/// * `base_url` - The URL the files are downloaded from, followed by their path in the manifest.
+/// * `manifest` - The paths of the files, relative to `path`, e.g. `levels/1/geometry.bin`. Their directories are created as needed.
+///
+/// # Examples
+/// ```rust
+/// let manifest = std::fs::read_to_string("/manifest.txt").unwrap();
+/// mount_lazy("/assets", "https://cdn.example.com/assets", manifest.lines()).unwrap();
+///
+/// // Only downloads this file.
+/// let level = std::fs::read("/assets/levels/1/geometry.bin").unwrap();
+/// ```
+pub fn mount_lazy<I, P>(path: &str, base_url: &str, manifest: I) -> io::Result<()>
+where
+    I: IntoIterator<Item = P>,
+    P: AsRef<str>,
+{
+    let backend = Backend::fetch(base_url);
+    mount(path, backend)?;
+
+    let root = Path::new(path);
+    for file in manifest {
+        let file = file.as_ref().trim_start_matches('/');
+        if file.is_empty() {
+            continue;
+        }
+        let file = root.join(file);
+        // New directories get the backend of their parent, here the fetch one.
+        if let Some(parent) = file.parent() {
+            std::fs::create_dir_all(parent)?;
+        }
+        let fd = create_file(&file.to_string_lossy(), 0o444, backend)?;
+        drop(unsafe { File::from_raw_fd(fd) });
+    }
+    Ok(())
+}
+
+/// Writes the standard output and error streams' buffered data out, using the emscripten-defined `wasmfs_flush`.
+pub fn flush() {
+    unsafe { wasmfs::wasmfs_flush() };
+}
@@ -0,0 +1,579 @@
+//! Safe Web Audio output through a wasm [audio worklet], over the emscripten [`webaudio.h`] header file.
+//!
+//! A `ScriptProcessorNode` runs its callback on the main thread, so audio glitches whenever a frame runs long.
+//! An audio worklet instead runs the rust `process` function on the browser's audio rendering thread.
+//! The usual setup is [`AudioContext::play_ring`]: the game fills a lock-free [`sample_ring`] from another thread,
+//! and the worklet pulls from it without ever blocking.
+//!
+//! The program must be built with `-sAUDIO_WORKLET -sWASM_WORKERS`.
+//!
+//! [audio worklet]: https://emscripten.org/docs/api_reference/wasm_audio_worklets.html
+//! [`webaudio.h`]: https://github.com/emscripten-core/emscripten/blob/main/system/include/emscripten/webaudio.h
+
+use std::{
+    fmt::Display,
+    os::raw::{c_int, c_void},
+};
+
+use emscripten_functions_sys::webaudio;
+
+pub use emscripten_functions_sys::webaudio::{AudioParamFrame, AudioSampleFrame};
+
+use crate::{
+    c_str::with_c_str,
+    executor::{callback_future, CallbackFuture},
+    spsc,
+};
+
+extern "C" {
+    fn webaudio_connect_to_destination(node: c_int, context: c_int);
+    fn webaudio_decode_audio(
+        context: c_int,
+        data: *const c_void,
+        size: c_int,
+        callback: unsafe extern "C" fn(*mut c_void, c_int, c_int, c_int, f32),
+        arg: *mut c_void,
+    );
+    fn webaudio_copy_channel(buffer: c_int, channel: c_int, dst: *mut f32, frames: c_int);
+    fn webaudio_play_buffer(buffer: c_int, context: c_int);
+    fn webaudio_release(handle: c_int);
+}
+
+/// The number of sample frames per channel that a `process` call handles.
+pub const QUANTUM_SIZE: usize = 128;
+
+/// The stack size of the audio worklet thread started by [`AudioContext::play_ring`].
+pub const DEFAULT_WORKLET_STACK_SIZE: u32 = 16 * 1024;
+
+// The name of the processor registered by `AudioContext::play_ring`.
+const RING_PROCESSOR: &str = "emscripten-functions-ring";
+
+/// The writing side of a [`sample_ring`].
+pub type SampleProducer = spsc::Producer<f32>;
+/// The reading side of a [`sample_ring`].
+pub type SampleConsumer = spsc::Consumer<f32>;
+
+/// Creates a lock-free single-producer single-consumer ring buffer of at least `capacity` samples, rounded up to a power of two.
+///
+/// Its non-blocking operations (`push_slice` and `pop_slice`) never wait nor allocate, so the consumer can be used on the audio rendering thread.
+pub fn sample_ring(capacity: usize) -> (SampleProducer, SampleConsumer) {
+    spsc::channel(capacity)
+}
+
+/// Returns the samples of an input frame: [`QUANTUM_SIZE`] samples per channel, one channel after the other.
+///
+/// # Safety
+/// The frame must be one given to a `process` function, during its call.
+pub unsafe fn frame_samples(frame: &AudioSampleFrame) -> &[f32] {
+    let len = frame.numberOfChannels.max(0) as usize * QUANTUM_SIZE;
+    std::slice::from_raw_parts(frame.data, len)
+}
+
+/// Returns the samples of an output frame to fill in, laid out like [`frame_samples`].
+///
+/// # Safety
+/// The frame must be one given to a `process` function, during its call.
+pub unsafe fn frame_samples_mut(frame: &mut AudioSampleFrame) -> &mut [f32] {
+    let len = frame.numberOfChannels.max(0) as usize * QUANTUM_SIZE;
+    std::slice::from_raw_parts_mut(frame.data, len)
+}
+
+/// The state of an [`AudioContext`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum AudioContextState {
+    /// Not playing yet (browsers only start playing after a user gesture), or suspended.
+    Suspended,
+    Running,
+    Closed,
+    /// Interrupted by the system, e.g. by a phone call.
+    Interrupted,
+}
+
+/// The error of a failed Web Audio setup step.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum WebAudioError {
+    /// The audio worklet thread couldn't be started.
+    WorkletStart,
+    /// The audio worklet processor couldn't be created.
+    ProcessorCreation,
+}
+
+impl Display for WebAudioError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        match self {
+            WebAudioError::WorkletStart => write!(f, "Failed to start the audio worklet thread"),
+            WebAudioError::ProcessorCreation => {
+                write!(f, "Failed to create the audio worklet processor")
+            }
+        }
+    }
+}
+
+type OnDone = Box<dyn FnOnce(bool)>;
+
+unsafe extern "C" fn done_trampoline(
+    _context: webaudio::EMSCRIPTEN_WEBAUDIO_T,
+    success: c_int,
+    user_data: *mut c_void,
+) {
+    let ondone = Box::from_raw(user_data as *mut OnDone);
+    ondone(success != 0);
+}
+
+/// A Web Audio `AudioContext`, closed when dropped.
+///
+/// # Examples
+/// ```rust
+/// let (mut producer, consumer) = sample_ring(48000);
+/// let mut context = AudioContext::new(Some("interactive"), None);
+/// context.play_ring(2, consumer, |node| {
+///     node.expect("couldn't start the audio output").forget();
+/// });
+///
+/// set_main_loop(move || {
+///     let samples = mixer.mix(producer.free_len());
+///     producer.push_slice(&samples);
+/// }, 0, true);
+/// ```
+pub struct AudioContext {
+    handle: webaudio::EMSCRIPTEN_WEBAUDIO_T,
+}
+
+impl AudioContext {
+    /// Creates a context, using the emscripten-defined `emscripten_create_audio_context`.
+    ///
+    /// # Arguments
+    /// * `latency_hint` - One of `"balanced"`, `"interactive"` or `"playback"`, or `None` for the browser's default.
+    /// * `sample_rate` - The sample rate, e.g. 48000, or `None` for the output device's.
+    pub fn new(latency_hint: Option<&str>, sample_rate: Option<u32>) -> Self {
+        let create = |latency_hint| {
+            let attributes = webaudio::EmscriptenWebAudioCreateAttributes {
+                latencyHint: latency_hint,
+                sampleRate: sample_rate.unwrap_or(0),
+            };
+            unsafe { webaudio::emscripten_create_audio_context(&attributes) }
+        };
+        let handle = match latency_hint {
+            Some(latency_hint) => with_c_str(latency_hint, create),
+            None => create(std::ptr::null()),
+        };
+
+        Self { handle }
+    }
+
+    /// Returns the emscripten handle of the context.
+    pub fn as_raw(&self) -> webaudio::EMSCRIPTEN_WEBAUDIO_T {
+        self.handle
+    }
+
+    /// Returns the state of the context.
+    pub fn state(&self) -> AudioContextState {
+        match unsafe { webaudio::emscripten_audio_context_state(self.handle) } as u32 {
+            webaudio::AUDIO_CONTEXT_STATE_RUNNING => AudioContextState::Running,
+            webaudio::AUDIO_CONTEXT_STATE_CLOSED => AudioContextState::Closed,
+            webaudio::AUDIO_CONTEXT_STATE_INTERRUPTED => AudioContextState::Interrupted,
+            _ => AudioContextState::Suspended,
+        }
+    }
+
+    /// Resumes the context. Browsers only let it run after a user gesture, so call it from e.g. a click handler.
+    pub fn resume(&self) {
+        unsafe { webaudio::emscripten_resume_audio_context_sync(self.handle) };
+    }
+
+    /// Starts the context's audio worklet thread, then calls `onstarted` on the calling thread with whether it succeeded.
+    ///
+    /// It's only needed once per context; the thread gets a stack of `stack_size` bytes, e.g. [`DEFAULT_WORKLET_STACK_SIZE`].
+    /// The stack is leaked: destroying the context doesn't wait for the thread to stop using it.
+    pub fn start_worklet<F>(&mut self, stack_size: u32, onstarted: F)
+    where
+        F: 'static + FnOnce(bool),
+    {
+        // `u128`s, for the 16-byte alignment of the stack.
+        let stack = Box::leak(vec![0u128; (stack_size as usize).div_ceil(16)].into_boxed_slice());
+        let stack_ptr = stack.as_mut_ptr() as *mut c_void;
+
+        let ondone: OnDone = Box::new(onstarted);
+        unsafe {
+            webaudio::emscripten_start_wasm_audio_worklet_thread_async(
+                self.handle,
+                stack_ptr,
+                stack_size,
+                Some(done_trampoline),
+                Box::into_raw(Box::new(ondone)) as *mut c_void,
+            );
+        }
+    }
+
+    /// Registers an audio worklet processor with the given name and no parameters, once the worklet thread started,
+    /// then calls `oncreated` with whether it succeeded.
+    pub fn create_processor<F>(&self, name: &str, oncreated: F)
+    where
+        F: 'static + FnOnce(bool),
+    {
+        create_processor(self.handle, name, Box::new(oncreated));
+    }
+
+    /// Creates a node running `process` on the audio rendering thread, for a processor created with [`AudioContext::create_processor`].
+    ///
+    /// # Arguments
+    /// * `name` - The name of the processor.
+    /// * `num_inputs` - The number of inputs of the node.
+    /// * `output_channels` - The number of channels of each of the node's outputs.
+    /// * `process` - The function called with the inputs, the outputs to fill in and the parameters, for each [`QUANTUM_SIZE`] sample frames.
+    ///   It returns `false` to stop processing. It's never dropped, as the audio thread may call it until the context is closed.
+    pub fn create_node<F>(
+        &self,
+        name: &str,
+        num_inputs: i32,
+        output_channels: &[i32],
+        process: F,
+    ) -> AudioNode
+    where
+        F: 'static
+            + Send
+            + FnMut(&[AudioSampleFrame], &mut [AudioSampleFrame], &[AudioParamFrame]) -> bool,
+    {
+        create_node(self.handle, name, num_inputs, output_channels, process)
+    }
+
+    /// Plays the interleaved samples of `consumer` with `channels` channels, through a node connected to the context's destination.
+    ///
+    /// It starts the worklet thread, creates the processor and the node, then calls `onready` with the node.
+    /// When the ring runs out of samples, silence is played.
+    pub fn play_ring<F>(&mut self, channels: i32, mut consumer: SampleConsumer, onready: F)
+    where
+        F: 'static + FnOnce(Result<AudioNode, WebAudioError>),
+    {
+        let handle = self.handle;
+        self.start_worklet(DEFAULT_WORKLET_STACK_SIZE, move |started| {
+            if !started {
+                onready(Err(WebAudioError::WorkletStart));
+                return;
+            }
+
+            create_processor(
+                handle,
+                RING_PROCESSOR,
+                Box::new(move |created| {
+                    if !created {
+                        onready(Err(WebAudioError::ProcessorCreation));
+                        return;
+                    }
+
+                    let channel_count = channels.max(1) as usize;
+                    let mut interleaved = vec![0.0; channel_count * QUANTUM_SIZE];
+                    let node = create_node(
+                        handle,
+                        RING_PROCESSOR,
+                        0,
+                        &[channels],
+                        move |_, outputs, _| {
+                            let count = consumer.pop_slice(&mut interleaved);
+                            interleaved[count..].fill(0.0);
+
+                            if let Some(output) = outputs.first_mut() {
+                                let planar = unsafe { frame_samples_mut(output) };
+                                for (i, sample) in interleaved.iter().enumerate() {
+                                    let (frame, channel) = (i / channel_count, i % channel_count);
+                                    if let Some(out) =
+                                        planar.get_mut(channel * QUANTUM_SIZE + frame)
+                                    {
+                                        *out = *sample;
+                                    }
+                                }
+                            }
+                            true
+                        },
+                    );
+                    unsafe { webaudio_connect_to_destination(node.handle, handle) };
+                    onready(Ok(node));
+                }),
+            );
+        });
+    }
+
+    /// Decodes a compressed audio file (e.g. OGG or MP3) with the browser's `decodeAudioData`, resampled to the context's sample rate,
+    /// and calls `callback` with the decoded audio.
+    ///
+    /// The browser's decoders run off the program's threads. Each channel is copied straight into its vector, in one pass;
+    /// with [`AudioDecodeOptions::keep_buffer`], the browser's `AudioBuffer` is also kept, to be played by [`AudioBuffer::play`] without any copy.
+    ///
+    /// # Arguments
+    /// * `data` - The encoded audio. It's copied when called.
+    /// * `channels` - The vectors to reuse for the channels, e.g. those of a previous clip; their previous samples are discarded.
+    /// * `options` - What to keep of the decoded audio.
+    /// * `callback` - The function called with the decoded audio, or the error.
+    ///
+    /// # Examples
+    /// ```rust
+    /// let data = wget("sounds/explosion.ogg").await.unwrap();
+    /// context.decode_audio(&data, Vec::new(), AudioDecodeOptions::default(), |audio| match audio {
+    ///     Ok(audio) => mixer.add_clip("explosion", audio.channels),
+    ///     Err(err) => println!("{}", err),
+    /// });
+    /// ```
+    pub fn decode_audio<F>(
+        &self,
+        data: &[u8],
+        channels: Vec<Vec<f32>>,
+        options: AudioDecodeOptions,
+        callback: F,
+    ) where
+        F: 'static + FnOnce(Result<DecodedAudio, AudioDecodeError>),
+    {
+        let arg = Box::into_raw(Box::new(PendingDecode {
+            channels,
+            options,
+            callback: Box::new(callback),
+        })) as *mut c_void;
+        unsafe {
+            webaudio_decode_audio(
+                self.handle,
+                data.as_ptr() as *const c_void,
+                data.len() as c_int,
+                decoded,
+                arg,
+            )
+        };
+    }
+
+    /// Returns a future completing with the decoded audio. See [`decode_audio`](Self::decode_audio).
+    pub fn decode_audio_async(
+        &self,
+        data: &[u8],
+        channels: Vec<Vec<f32>>,
+        options: AudioDecodeOptions,
+    ) -> CallbackFuture<Result<DecodedAudio, AudioDecodeError>> {
+        callback_future(|callback| self.decode_audio(data, channels, options, callback))
+    }
+}
+
+impl Drop for AudioContext {
+    fn drop(&mut self) {
+        unsafe { webaudio::emscripten_destroy_audio_context(self.handle) };
+    }
+}
+
+fn create_processor(context: webaudio::EMSCRIPTEN_WEBAUDIO_T, name: &str, oncreated: OnDone) {
+    let user_data = Box::into_raw(Box::new(oncreated)) as *mut c_void;
+    // The name is copied by the JS code before the call returns.
+    with_c_str(name, |name| {
+        let options = webaudio::WebAudioWorkletProcessorCreateOptions {
+            name,
+            numAudioParams: 0,
+            audioParamDescriptors: std::ptr::null(),
+        };
+        unsafe {
+            webaudio::emscripten_create_wasm_audio_worklet_processor_async(
+                context,
+                &options,
+                Some(done_trampoline),
+                user_data,
+            );
+        }
+    });
+}
+
+unsafe extern "C" fn process_trampoline<F>(
+    num_inputs: c_int,
+    inputs: *const AudioSampleFrame,
+    num_outputs: c_int,
+    outputs: *mut AudioSampleFrame,
+    num_params: c_int,
+    params: *const AudioParamFrame,
+    user_data: *mut c_void,
+) -> c_int
+where
+    F: FnMut(&[AudioSampleFrame], &mut [AudioSampleFrame], &[AudioParamFrame]) -> bool,
+{
+    unsafe fn slice<'a, T>(data: *const T, len: c_int) -> &'a [T] {
+        if len <= 0 || data.is_null() {
+            &[]
+        } else {
+            std::slice::from_raw_parts(data, len as usize)
+        }
+    }
+
+    let outputs = if num_outputs <= 0 || outputs.is_null() {
+        &mut []
+    } else {
+        std::slice::from_raw_parts_mut(outputs, num_outputs as usize)
+    };
+    let process = &mut *(user_data as *mut F);
+    process(
+        slice(inputs, num_inputs),
+        outputs,
+        slice(params, num_params),
+    ) as c_int
+}
+
+fn create_node<F>(
+    context: webaudio::EMSCRIPTEN_WEBAUDIO_T,
+    name: &str,
+    num_inputs: i32,
+    output_channels: &[i32],
+    process: F,
+) -> AudioNode
+where
+    F: 'static
+        + Send
+        + FnMut(&[AudioSampleFrame], &mut [AudioSampleFrame], &[AudioParamFrame]) -> bool,
+{
+    let mut output_channels = output_channels.to_vec();
+    let options = webaudio::EmscriptenAudioWorkletNodeCreateOptions {
+        numberOfInputs: num_inputs,
+        numberOfOutputs: output_channels.len() as c_int,
+        outputChannelCounts: output_channels.as_mut_ptr(),
+    };
+    let user_data = Box::into_raw(Box::new(process)) as *mut c_void;
+
+    let handle = with_c_str(name, |name| unsafe {
+        webaudio::emscripten_create_wasm_audio_worklet_node(
+            context,
+            name,
+            &options,
+            Some(process_trampoline::<F>),
+            user_data,
+        )
+    });
+    AudioNode { handle }
+}
+
+/// An audio worklet node, disconnected and destroyed when dropped.
+///
+/// Its `process` closure is leaked then, as the audio thread may still be running it: nodes are meant to be created
+/// once per output, not per sound.
+pub struct AudioNode {
+    handle: webaudio::EMSCRIPTEN_AUDIO_WORKLET_NODE_T,
+}
+
+impl AudioNode {
+    /// Returns the emscripten handle of the node.
+    pub fn as_raw(&self) -> webaudio::EMSCRIPTEN_AUDIO_WORKLET_NODE_T {
+        self.handle
+    }
+
+    /// Connects the node to the destination (the speakers) of the given context.
+    pub fn connect_to_destination(&self, context: &AudioContext) {
+        unsafe { webaudio_connect_to_destination(self.handle, context.handle) };
+    }
+
+    /// Keeps the node playing for the rest of the program, or until its context is closed.
+    pub fn forget(self) {
+        std::mem::forget(self);
+    }
+}
+
+impl Drop for AudioNode {
+    fn drop(&mut self) {
+        unsafe { webaudio::emscripten_destroy_web_audio_node(self.handle) };
+    }
+}
+
+/// The error of an audio file that the browser couldn't decode.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct AudioDecodeError;
+impl Display for AudioDecodeError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        write!(f, "The audio couldn't be decoded")
+    }
+}
+
+/// What [`AudioContext::decode_audio`] keeps of the decoded audio.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct AudioDecodeOptions {
+    /// Keeps the browser's `AudioBuffer`, in [`DecodedAudio::buffer`].
+    pub keep_buffer: bool,
+    /// Doesn't copy the samples into [`DecodedAudio::channels`], e.g. for clips only played with [`AudioBuffer::play`].
+    pub skip_samples: bool,
+}
+
+/// The audio decoded by [`AudioContext::decode_audio`].
+#[derive(Debug)]
+pub struct DecodedAudio {
+    /// The sample rate, which is the context's.
+    pub sample_rate: f32,
+    /// The number of sample frames per channel.
+    pub frames: usize,
+    /// The samples of each channel, or no channels with [`AudioDecodeOptions::skip_samples`].
+    pub channels: Vec<Vec<f32>>,
+    /// The browser's `AudioBuffer`, with [`AudioDecodeOptions::keep_buffer`].
+    pub buffer: Option<AudioBuffer>,
+}
+
+/// A decoded `AudioBuffer`, kept in the browser's memory, and released when dropped.
+#[derive(Debug)]
+pub struct AudioBuffer {
+    handle: c_int,
+}
+
+impl AudioBuffer {
+    /// Returns the emscripten handle of the buffer, in the same table as the contexts and nodes.
+    pub fn as_raw(&self) -> c_int {
+        self.handle
+    }
+
+    /// Plays the buffer once, through a new `AudioBufferSourceNode` connected to the destination of the given context.
+    pub fn play(&self, context: &AudioContext) {
+        unsafe { webaudio_play_buffer(self.handle, context.handle) };
+    }
+}
+
+impl Drop for AudioBuffer {
+    fn drop(&mut self) {
+        unsafe { webaudio_release(self.handle) };
+    }
+}
+
+struct PendingDecode {
+    channels: Vec<Vec<f32>>,
+    options: AudioDecodeOptions,
+    callback: Box<dyn FnOnce(Result<DecodedAudio, AudioDecodeError>)>,
+}
+
+unsafe extern "C" fn decoded(
+    arg: *mut c_void,
+    buffer: c_int,
+    channel_count: c_int,
+    frames: c_int,
+    sample_rate: f32,
+) {
+    let PendingDecode {
+        mut channels,
+        options,
+        callback,
+    } = *Box::from_raw(arg as *mut PendingDecode);
+    if buffer == 0 {
+        callback(Err(AudioDecodeError));
+        return;
+    }
+    let buffer = AudioBuffer { handle: buffer };
+
+    let frames = frames as usize;
+    let channel_count = if options.skip_samples {
+        0
+    } else {
+        channel_count as usize
+    };
+    channels.resize_with(channel_count, Vec::new);
+    for (index, channel) in channels.iter_mut().enumerate() {
+        channel.clear();
+        channel.reserve(frames);
+        webaudio_copy_channel(
+            buffer.handle,
+            index as c_int,
+            channel.as_mut_ptr(),
+            frames as c_int,
+        );
+        // The JS code filled the first `frames` samples of the reserved capacity.
+        channel.set_len(frames);
+    }
+
+    callback(Ok(DecodedAudio {
+        sample_rate,
+        frames,
+        channels,
+        buffer: options.keep_buffer.then_some(buffer),
+    }));
+}
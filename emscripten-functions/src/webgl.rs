@@ -0,0 +1,690 @@
+//! Safe WebGL context management, over the emscripten [WebGL context functions] of the [`html5.h`] header file.
+//!
+//! The [`ContextBuilder`] starts from emscripten's default attributes, and exposes the ones that matter for performance:
+//! e.g. `preserveDrawingBuffer` stays off unless asked for, as keeping the drawing buffer forces the browser to copy it every frame.
+//!
+//! [`upload_image`] decodes images with the browser's `createImageBitmap` straight into textures, without their pixels entering the wasm heap.
+//!
+//! [WebGL context functions]: https://emscripten.org/docs/api_reference/html5.h.html#webgl-context
+//! [`html5.h`]: https://emscripten.org/docs/api_reference/html5.h.html
+
+use std::{
+    cell::{Cell, RefCell},
+    collections::HashMap,
+    ffi::CStr,
+    fmt::Display,
+    marker::PhantomData,
+    os::raw::{c_char, c_int, c_void},
+    rc::Rc,
+    sync::atomic::{AtomicUsize, Ordering},
+};
+
+use emscripten_functions_sys::html5;
+
+use crate::{
+    c_str::with_c_str,
+    executor::{callback_future, CallbackFuture},
+    html5::{
+        canvas_size_generation,
+        events::{on_webglcontextlost, on_webglcontextrestored, EventListener, EventTarget},
+        Html5Error,
+    },
+    webgl_extensions::{enable_with_helper, ExtensionSet},
+};
+
+/// The GPU the browser should pick for a context, on systems with several ones.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum PowerPreference {
+    /// Lets the browser choose.
+    Default,
+    /// Prefers the power-saving GPU, e.g. the integrated one.
+    LowPower,
+    /// Prefers the fastest GPU, e.g. the discrete one.
+    HighPerformance,
+}
+
+/// Sets up and creates a WebGL [`Context`].
+///
+/// # Examples
+/// ```rust
+/// let context = Context::builder()
+///     .version(2, 0)
+///     .antialias(false)
+///     .power_preference(PowerPreference::HighPerformance)
+///     .create("#canvas")
+///     .unwrap();
+/// context.make_current().unwrap();
+/// ```
+#[derive(Debug, Clone)]
+pub struct ContextBuilder {
+    attributes: html5::EmscriptenWebGLContextAttributes,
+    // Not one of emscripten's attributes: it's passed to `getContext` by the JS shim.
+    desynchronized: bool,
+}
+
+impl ContextBuilder {
+    /// Starts from emscripten's defaults: a WebGL 1 context with alpha, depth, antialiasing and premultiplied alpha,
+    /// without stencil, and without preserving the drawing buffer.
+    pub fn new() -> Self {
+        let mut attributes = std::mem::MaybeUninit::uninit();
+        let mut attributes = unsafe {
+            html5::emscripten_webgl_init_context_attributes(attributes.as_mut_ptr());
+            attributes.assume_init()
+        };
+        attributes.preserveDrawingBuffer = 0;
+
+        Self {
+            attributes,
+            desynchronized: false,
+        }
+    }
+
+    /// Sets the WebGL version: 1.0 for WebGL 1, 2.0 for WebGL 2.
+    pub fn version(&mut self, major: i32, minor: i32) -> &mut Self {
+        self.attributes.majorVersion = major;
+        self.attributes.minorVersion = minor;
+        self
+    }
+
+    /// Sets whether the drawing buffer has an alpha channel.
+    pub fn alpha(&mut self, alpha: bool) -> &mut Self {
+        self.attributes.alpha = alpha as c_int;
+        self
+    }
+
+    /// Sets whether the drawing buffer has a depth buffer.
+    pub fn depth(&mut self, depth: bool) -> &mut Self {
+        self.attributes.depth = depth as c_int;
+        self
+    }
+
+    /// Sets whether the drawing buffer has a stencil buffer.
+    pub fn stencil(&mut self, stencil: bool) -> &mut Self {
+        self.attributes.stencil = stencil as c_int;
+        self
+    }
+
+    /// Sets whether the drawing buffer is antialiased. Turning it off saves a multisampled resolve per frame,
+    /// e.g. when rendering to framebuffers of your own.
+    pub fn antialias(&mut self, antialias: bool) -> &mut Self {
+        self.attributes.antialias = antialias as c_int;
+        self
+    }
+
+    /// Sets whether the page compositor takes the drawing buffer's colors as premultiplied by their alpha.
+    pub fn premultiplied_alpha(&mut self, premultiplied_alpha: bool) -> &mut Self {
+        self.attributes.premultipliedAlpha = premultiplied_alpha as c_int;
+        self
+    }
+
+    /// Sets whether the drawing buffer is kept after being presented, so that e.g. `toDataURL` can read it.
+    ///
+    /// It's off by default, and should stay so unless needed: keeping the buffer costs a copy per frame.
+    pub fn preserve_drawing_buffer(&mut self, preserve_drawing_buffer: bool) -> &mut Self {
+        self.attributes.preserveDrawingBuffer = preserve_drawing_buffer as c_int;
+        self
+    }
+
+    /// Sets the GPU the browser should pick.
+    pub fn power_preference(&mut self, power_preference: PowerPreference) -> &mut Self {
+        self.attributes.powerPreference = match power_preference {
+            PowerPreference::Default => html5::EM_WEBGL_POWER_PREFERENCE_DEFAULT,
+            PowerPreference::LowPower => html5::EM_WEBGL_POWER_PREFERENCE_LOW_POWER,
+            PowerPreference::HighPerformance => html5::EM_WEBGL_POWER_PREFERENCE_HIGH_PERFORMANCE,
+        } as c_int;
+        self
+    }
+
+    /// Sets whether creating the context fails if the system's GPU is blocklisted, instead of falling back to software rendering.
+    pub fn fail_if_major_performance_caveat(&mut self, fail: bool) -> &mut Self {
+        self.attributes.failIfMajorPerformanceCaveat = fail as c_int;
+        self
+    }
+
+    /// Sets whether all the extensions that don't affect the default behavior get enabled when the context is created.
+    ///
+    /// Turning it off makes creating the context faster; the needed extensions can then be enabled with [`Context::enable_extension`].
+    pub fn enable_extensions_by_default(&mut self, enable: bool) -> &mut Self {
+        self.attributes.enableExtensionsByDefault = enable as c_int;
+        self
+    }
+
+    /// Sets whether frames are presented only when [`commit_frame`] is called, instead of when returning to the browser.
+    ///
+    /// It needs an offscreen canvas or back buffer, see [`render_via_offscreen_back_buffer`](ContextBuilder::render_via_offscreen_back_buffer).
+    pub fn explicit_swap_control(&mut self, explicit_swap_control: bool) -> &mut Self {
+        self.attributes.explicitSwapControl = explicit_swap_control as c_int;
+        self
+    }
+
+    /// Sets whether rendering goes to an offscreen back buffer, copied to the canvas when the frame is presented.
+    pub fn render_via_offscreen_back_buffer(&mut self, offscreen: bool) -> &mut Self {
+        self.attributes.renderViaOffscreenBackBuffer = offscreen as c_int;
+        self
+    }
+
+    /// Sets whether the canvas is desynchronized from the page compositor, with the `desynchronized` context hint:
+    /// the frames are presented straight to the screen, a frame or two sooner, at the risk of tearing.
+    /// It suits inking and streamed video, where latency matters more than smoothness.
+    ///
+    /// Emscripten's attributes don't have it, so the hint is added to the canvas' `getContext` call during [`create`](ContextBuilder::create).
+    /// Browsers not supporting it ignore it; [`Context::is_desynchronized`] tells whether it was honored, and [`supports_desynchronized`] whether it would be.
+    /// It's only passed to canvases of the main browser thread's document.
+    pub fn desynchronized(&mut self, desynchronized: bool) -> &mut Self {
+        self.desynchronized = desynchronized;
+        self
+    }
+
+    /// Returns the raw attributes, for the ones without a setter.
+    pub fn attributes_mut(&mut self) -> &mut html5::EmscriptenWebGLContextAttributes {
+        &mut self.attributes
+    }
+
+    /// Creates the context on the canvas matching the given CSS selector, using the emscripten-defined [`emscripten_webgl_create_context`].
+    ///
+    /// [`emscripten_webgl_create_context`]: https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_webgl_create_context
+    pub fn create(&self, canvas: &str) -> Result<Context, Html5Error> {
+        let handle = with_c_str(canvas, |canvas| unsafe {
+            if self.desynchronized {
+                webgl_create_desynchronized(canvas, &self.attributes)
+            } else {
+                html5::emscripten_webgl_create_context(canvas, &self.attributes)
+            }
+        });
+        if handle <= 0 {
+            // A failed creation returns 0, or a negative `EMSCRIPTEN_RESULT`.
+            Html5Error::check(handle)?;
+            return Err(Html5Error::Failed);
+        }
+
+        Ok(Context {
+            handle,
+            canvas: canvas.to_string(),
+            lost_listener: None,
+            restored_listener: None,
+            extensions: Rc::new(Cell::new(None)),
+            extensions_listener: RefCell::new(None),
+            drawing_buffer_size: Cell::new(None),
+            canvas_size: Cell::new(None),
+            _not_send: PhantomData,
+        })
+    }
+}
+
+impl Default for ContextBuilder {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+/// A WebGL context, destroyed when dropped.
+///
+/// A context can only be used on the thread that created it.
+pub struct Context {
+    handle: html5::EMSCRIPTEN_WEBGL_CONTEXT_HANDLE,
+    canvas: String,
+    lost_listener: Option<EventListener>,
+    restored_listener: Option<EventListener>,
+    // The parsed supported extensions, cleared by the listener when the context gets restored.
+    extensions: Rc<Cell<Option<ExtensionSet>>>,
+    extensions_listener: RefCell<Option<EventListener>>,
+    // The drawing buffer's and the canvas' sizes, with the canvas size generation they were read at.
+    drawing_buffer_size: Cell<Option<(u32, (i32, i32))>>,
+    canvas_size: Cell<Option<(u32, (i32, i32))>>,
+    _not_send: PhantomData<*const ()>,
+}
+
+impl Context {
+    /// Returns a builder with emscripten's default attributes.
+    pub fn builder() -> ContextBuilder {
+        ContextBuilder::new()
+    }
+
+    /// Returns the emscripten handle of the context.
+    pub fn as_raw(&self) -> html5::EMSCRIPTEN_WEBGL_CONTEXT_HANDLE {
+        self.handle
+    }
+
+    /// Makes the context the calling thread's current one, which the GL functions act on.
+    pub fn make_current(&self) -> Result<(), Html5Error> {
+        Html5Error::check(unsafe { html5::emscripten_webgl_make_context_current(self.handle) })
+    }
+
+    /// Returns `true` if the context is the calling thread's current one.
+    pub fn is_current(&self) -> bool {
+        unsafe { html5::emscripten_webgl_get_current_context() == self.handle }
+    }
+
+    /// Returns `true` if the context is lost, e.g. after a GPU reset.
+    pub fn is_lost(&self) -> bool {
+        unsafe { html5::emscripten_is_webgl_context_lost(self.handle) != 0 }
+    }
+
+    /// Returns the width and height of the context's drawing buffer, using the emscripten-defined `emscripten_webgl_get_drawing_buffer_size`.
+    ///
+    /// The size is cached until a canvas gets resized by this crate, e.g. by a [`CanvasResizer`](crate::canvas_resizer::CanvasResizer)
+    /// or [`set_canvas_element_size`], or by a fullscreen strategy. Resizes made by JS code must be reported with [`invalidate_canvas_sizes`].
+    ///
+    /// [`set_canvas_element_size`]: crate::html5::set_canvas_element_size
+    /// [`invalidate_canvas_sizes`]: crate::html5::invalidate_canvas_sizes
+    pub fn drawing_buffer_size(&self) -> Result<(i32, i32), Html5Error> {
+        cached_size(&self.drawing_buffer_size, || {
+            let mut width = 0;
+            let mut height = 0;
+            Html5Error::check(unsafe {
+                html5::emscripten_webgl_get_drawing_buffer_size(
+                    self.handle,
+                    &mut width,
+                    &mut height,
+                )
+            })?;
+            Ok((width, height))
+        })
+    }
+
+    /// Returns the width and height of the context's canvas, using the emscripten-defined `emscripten_get_canvas_element_size`.
+    /// It's cached like the [`drawing_buffer_size`](Self::drawing_buffer_size).
+    pub fn canvas_size(&self) -> Result<(i32, i32), Html5Error> {
+        cached_size(&self.canvas_size, || {
+            with_c_str(&self.canvas, |canvas| {
+                let mut width = 0;
+                let mut height = 0;
+                Html5Error::check(unsafe {
+                    html5::emscripten_get_canvas_element_size(canvas, &mut width, &mut height)
+                })?;
+                Ok((width, height))
+            })
+        })
+    }
+
+    /// Returns the attributes the context got created with, which may differ from the requested ones.
+    pub fn attributes(&self) -> Result<html5::EmscriptenWebGLContextAttributes, Html5Error> {
+        let mut attributes = std::mem::MaybeUninit::uninit();
+        Html5Error::check(unsafe {
+            html5::emscripten_webgl_get_context_attributes(self.handle, attributes.as_mut_ptr())
+        })?;
+        Ok(unsafe { attributes.assume_init() })
+    }
+
+    /// Returns `true` if the context is desynchronized from the page compositor, as asked with [`ContextBuilder::desynchronized`]
+    /// and if the browser honored it.
+    pub fn is_desynchronized(&self) -> bool {
+        unsafe { webgl_is_desynchronized(self.handle) != 0 }
+    }
+
+    /// Enables the given WebGL extension, e.g. `OES_texture_float`, returning `true` if it's supported.
+    pub fn enable_extension(&self, extension: &str) -> bool {
+        with_c_str(extension, |extension| unsafe {
+            html5::emscripten_webgl_enable_extension(self.handle, extension) != 0
+        })
+    }
+
+    /// Returns the extensions the context supports, parsed from the emscripten-defined `emscripten_webgl_get_supported_extensions`
+    /// on the first call, and again after the context got restored.
+    ///
+    /// # Examples
+    /// ```rust
+    /// let extensions = context.supported_extensions();
+    /// if extensions.has(Extension::EXT_texture_filter_anisotropic) {
+    ///     renderer.enable_anisotropy();
+    /// }
+    /// ```
+    pub fn supported_extensions(&self) -> ExtensionSet {
+        if let Some(extensions) = self.extensions.get() {
+            return extensions;
+        }
+
+        // The extensions are the current context's ones.
+        let previous = unsafe { html5::emscripten_webgl_get_current_context() };
+        if previous != self.handle {
+            unsafe { html5::emscripten_webgl_make_context_current(self.handle) };
+        }
+        let extensions = ExtensionSet::current_supported();
+        if previous != self.handle {
+            unsafe { html5::emscripten_webgl_make_context_current(previous) };
+        }
+
+        self.extensions.set(Some(extensions));
+        let mut listener = self.extensions_listener.borrow_mut();
+        if listener.is_none() {
+            let cache = self.extensions.clone();
+            *listener =
+                on_webglcontextrestored(EventTarget::Selector(&self.canvas), false, move || {
+                    cache.set(None);
+                    false
+                })
+                .ok();
+        }
+        extensions
+    }
+
+    /// Enables the given extensions, the ones with a dedicated emscripten helper like `emscripten_webgl_enable_WEBGL_multi_draw` through it,
+    /// and returns the ones that got enabled.
+    ///
+    /// # Examples
+    /// ```rust
+    /// let wanted: ExtensionSet = [Extension::OES_vertex_array_object, Extension::ANGLE_instanced_arrays, Extension::OES_element_index_uint]
+    ///     .as_slice()
+    ///     .into();
+    /// let enabled = context.enable_extensions(wanted.intersection(context.supported_extensions()));
+    /// ```
+    pub fn enable_extensions(&self, extensions: ExtensionSet) -> ExtensionSet {
+        extensions
+            .iter()
+            .filter(|extension| {
+                enable_with_helper(self.handle, *extension)
+                    .unwrap_or_else(|| self.enable_extension(extension.name()))
+            })
+            .collect()
+    }
+
+    /// Sets the function called when the context gets lost, replacing the previous one.
+    /// Returning `true` from it lets the browser restore the context later.
+    pub fn on_lost<F>(&mut self, callback: F) -> Result<(), Html5Error>
+    where
+        F: 'static + FnMut() -> bool,
+    {
+        // The previous listener is unregistered first, as unregistering it after would also remove the new one.
+        self.lost_listener = None;
+        self.lost_listener = Some(on_webglcontextlost(
+            EventTarget::Selector(&self.canvas),
+            false,
+            callback,
+        )?);
+        Ok(())
+    }
+
+    /// Sets the function called when the context gets restored, replacing the previous one.
+    /// All the GL resources were lost with the context, and have to be recreated.
+    pub fn on_restored<F>(&mut self, callback: F) -> Result<(), Html5Error>
+    where
+        F: 'static + FnMut() -> bool,
+    {
+        self.restored_listener = None;
+        self.restored_listener = Some(on_webglcontextrestored(
+            EventTarget::Selector(&self.canvas),
+            false,
+            callback,
+        )?);
+        Ok(())
+    }
+
+    /// Destroys the context, like dropping it.
+    pub fn destroy(self) {}
+}
+
+// Returns the cached size if no canvas got resized since it was read, and reads it otherwise.
+fn cached_size<F>(
+    cache: &Cell<Option<(u32, (i32, i32))>>,
+    read: F,
+) -> Result<(i32, i32), Html5Error>
+where
+    F: FnOnce() -> Result<(i32, i32), Html5Error>,
+{
+    let generation = canvas_size_generation();
+    if let Some((cached_generation, size)) = cache.get() {
+        if cached_generation == generation {
+            return Ok(size);
+        }
+    }
+    let size = read()?;
+    cache.set(Some((generation, size)));
+    Ok(size)
+}
+
+impl Drop for Context {
+    fn drop(&mut self) {
+        self.lost_listener = None;
+        self.restored_listener = None;
+        *self.extensions_listener.get_mut() = None;
+        unsafe {
+            html5::emscripten_webgl_destroy_context(self.handle);
+        }
+    }
+}
+
+/// Returns `true` if the browser honors the `desynchronized` hint of [`ContextBuilder::desynchronized`], e.g. to choose a low-latency rendering path.
+/// It must be called from the main browser thread; the result is cached after the first call.
+pub fn supports_desynchronized() -> bool {
+    thread_local! {
+        static SUPPORTED: Cell<Option<bool>> = const { Cell::new(None) };
+    }
+    SUPPORTED.with(|supported| {
+        supported.get().unwrap_or_else(|| {
+            // Detecting it creates a throwaway context.
+            let detected = unsafe { webgl_supports_desynchronized() != 0 };
+            supported.set(Some(detected));
+            detected
+        })
+    })
+}
+
+/// Presents the current context's frame, for a context created with [`explicit_swap_control`](ContextBuilder::explicit_swap_control).
+pub fn commit_frame() -> Result<(), Html5Error> {
+    Html5Error::check(unsafe { html5::emscripten_webgl_commit_frame() })
+}
+
+// The addresses resolved by `get_proc_address`, by name. A null address is cached too, for the unsupported functions.
+// GL function pointers are indexes in the wasm function table, so they stay valid across contexts.
+thread_local! {
+    static PROC_ADDRESSES: RefCell<HashMap<String, usize>> = RefCell::new(HashMap::new());
+}
+
+/// Returns the address of the given GL function, e.g. `glDrawArrays`, or null if it's not available,
+/// using the emscripten-defined [`emscripten_webgl_get_proc_address`].
+///
+/// Each name is resolved only once per thread: a GL loader reloading its function table for a recreated context
+/// (e.g. `gl::load_with(get_proc_address)`) then only does hash lookups.
+///
+/// [`emscripten_webgl_get_proc_address`]: https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_webgl_get_proc_address
+pub fn get_proc_address(name: &str) -> *const c_void {
+    if let Some(address) = PROC_ADDRESSES.with(|addresses| addresses.borrow().get(name).copied()) {
+        return address as *const c_void;
+    }
+
+    let address = with_c_str(name, |name| unsafe {
+        html5::emscripten_webgl_get_proc_address(name)
+    }) as usize;
+    PROC_ADDRESSES.with(|addresses| {
+        addresses.borrow_mut().insert(name.to_string(), address);
+    });
+    address as *const c_void
+}
+
+/// The WebGL version a [`GlProc`] is looked up for.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum GlVersion {
+    /// Any WebGL version, with [`emscripten_webgl_get_proc_address`](https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_webgl_get_proc_address).
+    Any,
+    /// WebGL 1 only, with `emscripten_webgl1_get_proc_address`.
+    WebGL1,
+    /// WebGL 2 only, with `emscripten_webgl2_get_proc_address`.
+    WebGL2,
+}
+
+// The `address` of a `GlProc` that's not resolved yet, which no function table index can be.
+const UNRESOLVED: usize = usize::MAX;
+
+/// A typed GL function pointer, resolved the first time it's used and cached for the rest of the program.
+///
+/// Declare one `static` per GL entry point: unlike a table filled in when each context is created,
+/// nothing is looked up by name again when a lost context gets restored.
+///
+/// # Examples
+/// ```rust
+/// static GL_CLEAR: GlProc<unsafe extern "C" fn(u32)> =
+///     unsafe { GlProc::new(c"glClear", GlVersion::Any) };
+///
+/// if let Some(gl_clear) = GL_CLEAR.get() {
+///     unsafe { gl_clear(0x4000) };
+/// }
+/// ```
+pub struct GlProc<F> {
+    name: &'static CStr,
+    version: GlVersion,
+    address: AtomicUsize,
+    _func: PhantomData<F>,
+}
+
+impl<F: Copy> GlProc<F> {
+    /// Declares the GL function with the given name.
+    ///
+    /// # Safety
+    /// `F` must be an `unsafe extern "C" fn` pointer type matching the signature of the named GL function.
+    pub const unsafe fn new(name: &'static CStr, version: GlVersion) -> Self {
+        Self {
+            name,
+            version,
+            address: AtomicUsize::new(UNRESOLVED),
+            _func: PhantomData,
+        }
+    }
+
+    /// Returns the function pointer, or `None` if the function isn't available.
+    pub fn get(&self) -> Option<F> {
+        let mut address = self.address.load(Ordering::Relaxed);
+        if address == UNRESOLVED {
+            let name = self.name.as_ptr();
+            address = unsafe {
+                match self.version {
+                    GlVersion::Any => html5::emscripten_webgl_get_proc_address(name),
+                    GlVersion::WebGL1 => html5::emscripten_webgl1_get_proc_address(name),
+                    GlVersion::WebGL2 => html5::emscripten_webgl2_get_proc_address(name),
+                }
+            } as usize;
+            // Concurrent first calls resolve the same address, so the race is harmless.
+            self.address.store(address, Ordering::Relaxed);
+        }
+
+        if address == 0 {
+            return None;
+        }
+        let address = address as *const c_void;
+        // `F` is a function pointer type, as `new`'s safety contract requires, so it has the size of a pointer.
+        Some(unsafe { std::mem::transmute_copy::<*const c_void, F>(&address) })
+    }
+
+    /// Returns the name of the function.
+    pub fn name(&self) -> &'static CStr {
+        self.name
+    }
+}
+
+extern "C" {
+    fn webgl_upload_image(
+        data: *const c_char,
+        size: c_int,
+        texture: u32,
+        flip_y: c_int,
+        premultiply_alpha: c_int,
+        generate_mipmaps: c_int,
+        callback: unsafe extern "C" fn(*mut c_void, c_int, c_int, c_int),
+        arg: *mut c_void,
+    );
+    fn webgl_create_desynchronized(
+        target: *const c_char,
+        attributes: *const html5::EmscriptenWebGLContextAttributes,
+    ) -> html5::EMSCRIPTEN_WEBGL_CONTEXT_HANDLE;
+    fn webgl_is_desynchronized(handle: html5::EMSCRIPTEN_WEBGL_CONTEXT_HANDLE) -> c_int;
+    fn webgl_supports_desynchronized() -> c_int;
+}
+
+/// The error of an image that couldn't be uploaded into a texture by [`upload_image`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum TextureImageError {
+    /// The calling thread had no current context, or the browser doesn't support `createImageBitmap`.
+    NoContext,
+    /// The browser couldn't decode the image.
+    DecodeFailed,
+    /// The context was lost while the image was being decoded.
+    ContextLost,
+}
+impl Display for TextureImageError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        match self {
+            Self::NoContext => write!(
+                f,
+                "There is no current WebGL context to upload the image to"
+            ),
+            Self::DecodeFailed => write!(f, "The image couldn't be decoded"),
+            Self::ContextLost => write!(
+                f,
+                "The WebGL context was lost before the image was uploaded"
+            ),
+        }
+    }
+}
+
+/// How [`upload_image`] decodes and uploads an image.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct TextureImageOptions {
+    /// Flips the image vertically, so that its first row is at the texture coordinate 0, as OpenGL expects.
+    pub flip_y: bool,
+    /// Multiplies the colors by the alpha channel.
+    pub premultiply_alpha: bool,
+    /// Generates the mipmaps of the texture after uploading it. The image must have power-of-two dimensions on WebGL 1.
+    pub generate_mipmaps: bool,
+}
+
+type OnUpload = Box<dyn FnOnce(Result<(u32, u32), TextureImageError>)>;
+
+unsafe extern "C" fn uploaded(arg: *mut c_void, result: c_int, width: c_int, height: c_int) {
+    let callback = Box::from_raw(arg as *mut OnUpload);
+    callback(match result {
+        3 => Ok((width as u32, height as u32)),
+        2 => Err(TextureImageError::ContextLost),
+        1 => Err(TextureImageError::DecodeFailed),
+        _ => Err(TextureImageError::NoContext),
+    });
+}
+
+/// Decodes the given encoded image (e.g. PNG or JPEG) with the browser's `createImageBitmap`, off the main thread,
+/// and uploads it as the level 0 RGBA image of the given texture of the calling thread's current context.
+///
+/// The decoded pixels never enter the wasm heap, saving the decoding in wasm and the copy of the RGBA pixels of e.g. [`crate::image::decode_image`].
+/// The data is copied when called, so the buffer can be reused right away. The texture's binding isn't changed.
+///
+/// # Arguments
+/// * `data` - The encoded image.
+/// * `texture` - The GL name of the texture, as returned by `glGenTextures`.
+/// * `options` - How to decode and upload the image.
+/// * `callback` - The function called with the width and height of the image once it's uploaded, or with the error.
+///
+/// # Examples
+/// ```rust
+/// let data = wget("tiles.png").await.unwrap();
+/// upload_image(&data, tiles_texture, TextureImageOptions { flip_y: true, ..Default::default() }, |result| {
+///     match result {
+///         Ok((width, height)) => set_tile_count(width / 16, height / 16),
+///         Err(err) => console::error(&err.to_string()),
+///     }
+/// });
+/// ```
+pub fn upload_image<F>(data: &[u8], texture: u32, options: TextureImageOptions, callback: F)
+where
+    F: 'static + FnOnce(Result<(u32, u32), TextureImageError>),
+{
+    let callback: OnUpload = Box::new(callback);
+    let arg = Box::into_raw(Box::new(callback)) as *mut c_void;
+    unsafe {
+        webgl_upload_image(
+            data.as_ptr() as *const c_char,
+            data.len() as c_int,
+            texture,
+            options.flip_y as c_int,
+            options.premultiply_alpha as c_int,
+            options.generate_mipmaps as c_int,
+            uploaded,
+            arg,
+        );
+    }
+}
+
+/// Returns a future completing with the width and height of the given encoded image, once it's uploaded into the texture. See [`upload_image`].
+pub fn upload_image_async(
+    data: &[u8],
+    texture: u32,
+    options: TextureImageOptions,
+) -> CallbackFuture<Result<(u32, u32), TextureImageError>> {
+    callback_future(|callback| upload_image(data, texture, options, callback))
+}
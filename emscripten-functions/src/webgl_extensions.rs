@@ -0,0 +1,261 @@
+//! The WebGL extensions as an enum, and sets of them parsed once from the context's extension string.
+//!
+//! `emscripten_webgl_get_supported_extensions` returns all of a context's extensions as one space-separated string,
+//! which feature detection would scan again for each extension it checks. [`Context::supported_extensions`] parses it
+//! into an [`ExtensionSet`] the first time, whose [`has`](ExtensionSet::has) checks are a bit test, and
+//! [`Context::enable_extensions`] enables a whole set.
+//!
+//! [`Context::supported_extensions`]: crate::webgl::Context::supported_extensions
+//! [`Context::enable_extensions`]: crate::webgl::Context::enable_extensions
+
+use std::{
+    ffi::CStr,
+    fmt::Debug,
+    os::raw::{c_char, c_void},
+};
+
+use emscripten_functions_sys::html5;
+
+macro_rules! extensions {
+    ($($name:ident),* $(,)?) => {
+        /// A WebGL extension, of the [Khronos registry](https://registry.khronos.org/webgl/extensions/).
+        #[allow(non_camel_case_types)]
+        #[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, PartialOrd, Ord)]
+        pub enum Extension {
+            $(
+                #[doc = concat!("`", stringify!($name), "`.")]
+                $name,
+            )*
+        }
+
+        impl Extension {
+            /// All the extensions, in the order of their bits in an [`ExtensionSet`].
+            pub const ALL: &'static [Extension] = &[$(Extension::$name),*];
+
+            /// Returns the name of the extension, as given to `getExtension`.
+            pub fn name(self) -> &'static str {
+                match self {
+                    $(Extension::$name => stringify!($name),)*
+                }
+            }
+
+            /// Returns the extension with the given name, or `None` if it's unknown.
+            pub fn from_name(name: &str) -> Option<Self> {
+                match name {
+                    $(stringify!($name) => Some(Extension::$name),)*
+                    _ => None,
+                }
+            }
+        }
+    };
+}
+
+extensions! {
+    ANGLE_instanced_arrays,
+    EXT_blend_minmax,
+    EXT_clip_control,
+    EXT_color_buffer_float,
+    EXT_color_buffer_half_float,
+    EXT_conservative_depth,
+    EXT_depth_clamp,
+    EXT_disjoint_timer_query,
+    EXT_disjoint_timer_query_webgl2,
+    EXT_float_blend,
+    EXT_frag_depth,
+    EXT_polygon_offset_clamp,
+    EXT_render_snorm,
+    EXT_shader_texture_lod,
+    EXT_sRGB,
+    EXT_texture_compression_bptc,
+    EXT_texture_compression_rgtc,
+    EXT_texture_filter_anisotropic,
+    EXT_texture_mirror_clamp_to_edge,
+    EXT_texture_norm16,
+    KHR_parallel_shader_compile,
+    NV_shader_noperspective_interpolation,
+    OES_draw_buffers_indexed,
+    OES_element_index_uint,
+    OES_fbo_render_mipmap,
+    OES_sample_variables,
+    OES_shader_multisample_interpolation,
+    OES_standard_derivatives,
+    OES_texture_float,
+    OES_texture_float_linear,
+    OES_texture_half_float,
+    OES_texture_half_float_linear,
+    OES_vertex_array_object,
+    OVR_multiview2,
+    WEBGL_blend_func_extended,
+    WEBGL_clip_cull_distance,
+    WEBGL_color_buffer_float,
+    WEBGL_compressed_texture_astc,
+    WEBGL_compressed_texture_etc,
+    WEBGL_compressed_texture_etc1,
+    WEBGL_compressed_texture_pvrtc,
+    WEBGL_compressed_texture_s3tc,
+    WEBGL_compressed_texture_s3tc_srgb,
+    WEBGL_debug_renderer_info,
+    WEBGL_debug_shaders,
+    WEBGL_depth_texture,
+    WEBGL_draw_buffers,
+    WEBGL_draw_instanced_base_vertex_base_instance,
+    WEBGL_lose_context,
+    WEBGL_multi_draw,
+    WEBGL_multi_draw_instanced_base_vertex_base_instance,
+    WEBGL_polygon_mode,
+    WEBGL_provoking_vertex,
+    WEBGL_render_shared_exponent,
+    WEBGL_stencil_texturing,
+}
+
+/// A set of [`Extension`]s, as a bitset.
+///
+/// # Examples
+/// ```rust
+/// let extensions = context.supported_extensions();
+/// let compressed = if extensions.has(Extension::WEBGL_compressed_texture_astc) {
+///     TextureFormat::Astc
+/// } else if extensions.has(Extension::WEBGL_compressed_texture_s3tc) {
+///     TextureFormat::S3tc
+/// } else {
+///     TextureFormat::Rgba8
+/// };
+/// ```
+#[derive(Clone, Copy, Default, PartialEq, Eq, Hash)]
+pub struct ExtensionSet(u64);
+
+impl ExtensionSet {
+    /// Returns an empty set.
+    pub const fn new() -> Self {
+        Self(0)
+    }
+
+    /// Returns `true` if the set has the extension.
+    pub const fn has(&self, extension: Extension) -> bool {
+        self.0 & (1 << extension as u32) != 0
+    }
+
+    /// Adds an extension to the set.
+    pub fn insert(&mut self, extension: Extension) {
+        self.0 |= 1 << extension as u32;
+    }
+
+    /// Removes an extension from the set.
+    pub fn remove(&mut self, extension: Extension) {
+        self.0 &= !(1 << extension as u32);
+    }
+
+    /// Returns the extensions of the set also in `other`.
+    pub const fn intersection(&self, other: ExtensionSet) -> Self {
+        Self(self.0 & other.0)
+    }
+
+    /// Returns the extensions of the set not in `other`.
+    pub const fn difference(&self, other: ExtensionSet) -> Self {
+        Self(self.0 & !other.0)
+    }
+
+    /// Returns `true` if the set has all the extensions of `other`.
+    pub const fn contains_all(&self, other: ExtensionSet) -> bool {
+        self.0 & other.0 == other.0
+    }
+
+    /// Returns `true` if the set is empty.
+    pub const fn is_empty(&self) -> bool {
+        self.0 == 0
+    }
+
+    /// Returns the number of extensions in the set.
+    pub const fn len(&self) -> usize {
+        self.0.count_ones() as usize
+    }
+
+    /// Returns an iterator over the extensions of the set, in the order of [`Extension::ALL`].
+    pub fn iter(&self) -> impl Iterator<Item = Extension> + '_ {
+        Extension::ALL
+            .iter()
+            .copied()
+            .filter(|extension| self.has(*extension))
+    }
+
+    /// Parses a space-separated list of extension names, skipping the unknown ones.
+    pub fn parse(extensions: &str) -> Self {
+        extensions
+            .split_ascii_whitespace()
+            .filter_map(Extension::from_name)
+            .collect()
+    }
+
+    /// Parses the extensions supported by the calling thread's current context,
+    /// using the emscripten-defined `emscripten_webgl_get_supported_extensions`.
+    pub(crate) fn current_supported() -> Self {
+        extern "C" {
+            fn free(ptr: *mut c_void);
+        }
+
+        let extensions = unsafe { html5::emscripten_webgl_get_supported_extensions() };
+        if extensions.is_null() {
+            return Self::new();
+        }
+        let set =
+            Self::parse(&unsafe { CStr::from_ptr(extensions as *const c_char) }.to_string_lossy());
+        unsafe { free(extensions as *mut c_void) };
+        set
+    }
+}
+
+impl FromIterator<Extension> for ExtensionSet {
+    fn from_iter<I: IntoIterator<Item = Extension>>(iter: I) -> Self {
+        let mut set = Self::new();
+        for extension in iter {
+            set.insert(extension);
+        }
+        set
+    }
+}
+
+impl From<&[Extension]> for ExtensionSet {
+    fn from(extensions: &[Extension]) -> Self {
+        extensions.iter().copied().collect()
+    }
+}
+
+impl Debug for ExtensionSet {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_set().entries(self.iter()).finish()
+    }
+}
+
+// Enables an extension with its dedicated emscripten helper, which also sets up emscripten's GL entry points for it,
+// or returns `None` if it has none.
+pub(crate) fn enable_with_helper(
+    context: html5::EMSCRIPTEN_WEBGL_CONTEXT_HANDLE,
+    extension: Extension,
+) -> Option<bool> {
+    let enabled = unsafe {
+        match extension {
+            Extension::ANGLE_instanced_arrays => {
+                html5::emscripten_webgl_enable_ANGLE_instanced_arrays(context)
+            }
+            Extension::OES_vertex_array_object => {
+                html5::emscripten_webgl_enable_OES_vertex_array_object(context)
+            }
+            Extension::WEBGL_draw_buffers => {
+                html5::emscripten_webgl_enable_WEBGL_draw_buffers(context)
+            }
+            Extension::WEBGL_draw_instanced_base_vertex_base_instance => {
+                html5::emscripten_webgl_enable_WEBGL_draw_instanced_base_vertex_base_instance(
+                    context,
+                )
+            }
+            Extension::WEBGL_multi_draw => html5::emscripten_webgl_enable_WEBGL_multi_draw(context),
+            Extension::WEBGL_multi_draw_instanced_base_vertex_base_instance => {
+                html5::emscripten_webgl_enable_WEBGL_multi_draw_instanced_base_vertex_base_instance(
+                    context,
+                )
+            }
+            _ => return None,
+        }
+    };
+    Some(enabled != 0)
+}
@@ -0,0 +1,318 @@
+//! Asynchronous building of many WebGL programs, with the `KHR_parallel_shader_compile` extension.
+//!
+//! Compiling and linking a program, then checking its status right away, blocks until the driver is done with it,
+//! one program at a time. A [`ProgramCompiler`] instead submits all the programs first, and then polls their
+//! `COMPLETION_STATUS_KHR` from the main loop, so that the driver compiles them in parallel while the page keeps running.
+//! The info logs, whose queries are expensive, are only read for the programs that failed.
+//!
+//! Where the extension is missing, [`ProgramCompiler::poll`] checks the programs' status directly, blocking until each one is linked:
+//! submitting them all before still lets the driver start on the next ones.
+
+use std::{
+    collections::VecDeque,
+    ffi::CStr,
+    fmt::Display,
+    marker::PhantomData,
+    os::raw::{c_char, c_int, c_void},
+};
+
+use emscripten_functions_sys::html5;
+
+use crate::{
+    c_str::with_c_str,
+    webgl::{Context, GlProc, GlVersion},
+    webgl_extensions::Extension,
+};
+
+const FRAGMENT_SHADER: u32 = 0x8B30;
+const VERTEX_SHADER: u32 = 0x8B31;
+const COMPILE_STATUS: c_int = 0x8B81;
+const LINK_STATUS: c_int = 0x8B82;
+const COMPLETION_STATUS_KHR: c_int = 0x91B1;
+
+static GL_CREATE_SHADER: GlProc<unsafe extern "C" fn(u32) -> u32> =
+    unsafe { GlProc::new(c"glCreateShader", GlVersion::Any) };
+static GL_SHADER_SOURCE: GlProc<unsafe extern "C" fn(u32, i32, *const *const c_char, *const i32)> =
+    unsafe { GlProc::new(c"glShaderSource", GlVersion::Any) };
+static GL_COMPILE_SHADER: GlProc<unsafe extern "C" fn(u32)> =
+    unsafe { GlProc::new(c"glCompileShader", GlVersion::Any) };
+static GL_DELETE_SHADER: GlProc<unsafe extern "C" fn(u32)> =
+    unsafe { GlProc::new(c"glDeleteShader", GlVersion::Any) };
+static GL_CREATE_PROGRAM: GlProc<unsafe extern "C" fn() -> u32> =
+    unsafe { GlProc::new(c"glCreateProgram", GlVersion::Any) };
+static GL_ATTACH_SHADER: GlProc<unsafe extern "C" fn(u32, u32)> =
+    unsafe { GlProc::new(c"glAttachShader", GlVersion::Any) };
+static GL_BIND_ATTRIB_LOCATION: GlProc<unsafe extern "C" fn(u32, u32, *const c_char)> =
+    unsafe { GlProc::new(c"glBindAttribLocation", GlVersion::Any) };
+static GL_LINK_PROGRAM: GlProc<unsafe extern "C" fn(u32)> =
+    unsafe { GlProc::new(c"glLinkProgram", GlVersion::Any) };
+static GL_DELETE_PROGRAM: GlProc<unsafe extern "C" fn(u32)> =
+    unsafe { GlProc::new(c"glDeleteProgram", GlVersion::Any) };
+
+/// The step of a program's building that failed.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum ShaderStage {
+    /// The compilation of the vertex shader.
+    Vertex,
+    /// The compilation of the fragment shader.
+    Fragment,
+    /// The linking of the program.
+    Link,
+}
+
+/// The error of a program that couldn't be built by a [`ProgramCompiler`].
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct ShaderError {
+    /// The step that failed.
+    pub stage: ShaderStage,
+    /// The info log of the failed shader or program.
+    pub log: String,
+}
+
+impl Display for ShaderError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        match self.stage {
+            ShaderStage::Vertex => write!(f, "The vertex shader failed to compile: {}", self.log),
+            ShaderStage::Fragment => {
+                write!(f, "The fragment shader failed to compile: {}", self.log)
+            }
+            ShaderStage::Link => write!(f, "The program failed to link: {}", self.log),
+        }
+    }
+}
+
+// Copies and frees an info log returned by emscripten.
+fn take_log(log: *mut c_char) -> String {
+    extern "C" {
+        fn free(ptr: *mut c_void);
+    }
+
+    if log.is_null() {
+        return String::new();
+    }
+    let copy = unsafe { CStr::from_ptr(log) }
+        .to_string_lossy()
+        .into_owned();
+    unsafe { free(log as *mut c_void) };
+    copy
+}
+
+struct PendingProgram {
+    program: u32,
+    vertex: u32,
+    fragment: u32,
+}
+
+impl PendingProgram {
+    // Reads the status of the program, and the info log of the failed step, if one failed.
+    fn result(&self) -> Result<(), ShaderError> {
+        let linked = unsafe {
+            html5::emscripten_webgl_get_program_parameter_d(self.program as c_int, LINK_STATUS)
+        };
+        if linked != 0.0 {
+            return Ok(());
+        }
+
+        for (shader, stage) in [
+            (self.vertex, ShaderStage::Vertex),
+            (self.fragment, ShaderStage::Fragment),
+        ] {
+            let compiled = unsafe {
+                html5::emscripten_webgl_get_shader_parameter_d(shader as c_int, COMPILE_STATUS)
+            };
+            if compiled == 0.0 {
+                return Err(ShaderError {
+                    stage,
+                    log: take_log(unsafe {
+                        html5::emscripten_webgl_get_shader_info_log_utf8(shader as c_int)
+                    }),
+                });
+            }
+        }
+        Err(ShaderError {
+            stage: ShaderStage::Link,
+            log: take_log(unsafe {
+                html5::emscripten_webgl_get_program_info_log_utf8(self.program as c_int)
+            }),
+        })
+    }
+}
+
+fn create_shader(kind: u32, source: &str) -> u32 {
+    let (Some(gl_create_shader), Some(gl_shader_source), Some(gl_compile_shader)) = (
+        GL_CREATE_SHADER.get(),
+        GL_SHADER_SOURCE.get(),
+        GL_COMPILE_SHADER.get(),
+    ) else {
+        return 0;
+    };
+
+    unsafe {
+        let shader = gl_create_shader(kind);
+        let string = source.as_ptr() as *const c_char;
+        let length = source.len() as i32;
+        gl_shader_source(shader, 1, &string, &length);
+        gl_compile_shader(shader);
+        shader
+    }
+}
+
+/// Builds WebGL programs asynchronously, with the `KHR_parallel_shader_compile` extension where it's supported.
+/// See the [module documentation](self).
+///
+/// It acts on the calling thread's current context, which must be the one it was created for.
+///
+/// # Examples
+/// ```rust
+/// let mut compiler = ProgramCompiler::new(&context);
+/// let programs: Vec<u32> = variants
+///     .iter()
+///     .map(|variant| compiler.submit(&variant.vertex, &variant.fragment))
+///     .collect();
+///
+/// set_main_loop(move || {
+///     compiler.poll(|program, result| match result {
+///         Ok(()) => materials.program_ready(program),
+///         Err(error) => eprintln!("Shader variant {program} failed: {error}"),
+///     });
+///     if compiler.pending() == 0 {
+///         // All the variants are built.
+///     }
+/// }, 0, true);
+/// ```
+pub struct ProgramCompiler {
+    parallel: bool,
+    pending: VecDeque<PendingProgram>,
+    _not_send: PhantomData<*const ()>,
+}
+
+impl ProgramCompiler {
+    /// Creates a compiler for the context, enabling its `KHR_parallel_shader_compile` extension if it's supported.
+    pub fn new(context: &Context) -> Self {
+        let parallel = context.enable_extension(Extension::KHR_parallel_shader_compile.name());
+        Self {
+            parallel,
+            pending: VecDeque::new(),
+            _not_send: PhantomData,
+        }
+    }
+
+    /// Returns `true` if the programs get built in parallel, with the `KHR_parallel_shader_compile` extension.
+    pub fn is_parallel(&self) -> bool {
+        self.parallel
+    }
+
+    /// Compiles the shaders and links the program, without waiting for them, and returns the GL name of the program.
+    /// The program can't be used before [`poll`](Self::poll) reports it's built.
+    ///
+    /// # Arguments
+    /// * `vertex` - The source of the vertex shader.
+    /// * `fragment` - The source of the fragment shader.
+    pub fn submit(&mut self, vertex: &str, fragment: &str) -> u32 {
+        self.submit_with_attributes(vertex, fragment, &[])
+    }
+
+    /// Like [`submit`](Self::submit), binding the given attributes to their locations before linking the program.
+    ///
+    /// # Arguments
+    /// * `vertex` - The source of the vertex shader.
+    /// * `fragment` - The source of the fragment shader.
+    /// * `attributes` - The names of the attributes, with their locations.
+    pub fn submit_with_attributes(
+        &mut self,
+        vertex: &str,
+        fragment: &str,
+        attributes: &[(&str, u32)],
+    ) -> u32 {
+        let (Some(gl_create_program), Some(gl_attach_shader), Some(gl_link_program)) = (
+            GL_CREATE_PROGRAM.get(),
+            GL_ATTACH_SHADER.get(),
+            GL_LINK_PROGRAM.get(),
+        ) else {
+            return 0;
+        };
+
+        let vertex = create_shader(VERTEX_SHADER, vertex);
+        let fragment = create_shader(FRAGMENT_SHADER, fragment);
+        let program = unsafe { gl_create_program() };
+        unsafe {
+            gl_attach_shader(program, vertex);
+            gl_attach_shader(program, fragment);
+        }
+        if let Some(gl_bind_attrib_location) = GL_BIND_ATTRIB_LOCATION.get() {
+            for (name, location) in attributes {
+                with_c_str(name, |name| unsafe {
+                    gl_bind_attrib_location(program, *location, name)
+                });
+            }
+        }
+        unsafe { gl_link_program(program) };
+
+        self.pending.push_back(PendingProgram {
+            program,
+            vertex,
+            fragment,
+        });
+        program
+    }
+
+    /// Returns the number of programs submitted and not reported by [`poll`](Self::poll) yet.
+    pub fn pending(&self) -> usize {
+        self.pending.len()
+    }
+
+    /// Calls `on_done` for each program that finished building since the previous call, with its GL name, and its result.
+    /// The programs that failed are deleted after `on_done` returns. Returns the number of programs still pending.
+    pub fn poll<F>(&mut self, mut on_done: F) -> usize
+    where
+        F: FnMut(u32, Result<(), ShaderError>),
+    {
+        let parallel = self.parallel;
+        let mut index = 0;
+        while index < self.pending.len() {
+            let pending = &self.pending[index];
+            let done = !parallel
+                || unsafe {
+                    html5::emscripten_webgl_get_program_parameter_d(
+                        pending.program as c_int,
+                        COMPLETION_STATUS_KHR,
+                    ) != 0.0
+                };
+            if !done {
+                index += 1;
+                continue;
+            }
+
+            let pending = self.pending.remove(index).unwrap();
+            let result = pending.result();
+            let failed = result.is_err();
+            on_done(pending.program, result);
+            Self::delete(&pending, failed);
+        }
+        self.pending.len()
+    }
+
+    // Deletes the shaders, which a linked program doesn't need anymore, and the program if it failed.
+    fn delete(pending: &PendingProgram, program: bool) {
+        if let Some(gl_delete_shader) = GL_DELETE_SHADER.get() {
+            unsafe {
+                gl_delete_shader(pending.vertex);
+                gl_delete_shader(pending.fragment);
+            }
+        }
+        if program {
+            if let Some(gl_delete_program) = GL_DELETE_PROGRAM.get() {
+                unsafe { gl_delete_program(pending.program) };
+            }
+        }
+    }
+}
+
+impl Drop for ProgramCompiler {
+    // The programs still pending are deleted.
+    fn drop(&mut self) {
+        for pending in &self.pending {
+            Self::delete(pending, true);
+        }
+    }
+}
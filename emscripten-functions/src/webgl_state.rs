@@ -0,0 +1,704 @@
+//! A shadow of a WebGL context's state, answering the `glGet*` queries from the wasm memory.
+//!
+//! The emscripten [`emscripten_webgl_get_parameter_*`], `emscripten_webgl_get_uniform_*` and `emscripten_webgl_get_vertex_attrib_*`
+//! functions are synchronous queries, which some browsers answer with a round-trip to the GPU process.
+//! A [`StateShadow`] caches their answers for its context:
+//! - the limits, like `MAX_TEXTURE_SIZE`, which don't change for the context's life, are queried once;
+//! - the tracked state, like the bound buffers or the viewport, is queried once, and then kept up to date by the shadow's
+//!   wrappers of the GL functions changing it, like [`StateShadow::bind_buffer`] or [`StateShadow::viewport`];
+//! - the uniforms and the vertex attributes are queried once, until their changes are reported
+//!   with [`StateShadow::uniform_changed`] or [`StateShadow::vertex_attrib_changed`].
+//!
+//! The other parameters are queried every time. The state changed by other means than the wrappers, e.g. by a library calling GL
+//! itself, must be reported with [`StateShadow::invalidate`], or the shadow answers with stale values.
+//! All of a context's state is lost with it: call [`StateShadow::invalidate_all`] once it's restored.
+//!
+//! [`emscripten_webgl_get_parameter_*`]: https://emscripten.org/docs/api_reference/html5.h.html#c.emscripten_webgl_get_parameter_d
+
+use std::{
+    cell::RefCell,
+    collections::HashMap,
+    hash::Hash,
+    marker::PhantomData,
+    os::raw::{c_int, c_longlong},
+};
+
+use emscripten_functions_sys::html5;
+
+use crate::webgl::{Context, GlProc, GlVersion};
+
+// The GL enums the shadow knows about.
+mod gl {
+    pub const ARRAY_BUFFER: u32 = 0x8892;
+    pub const ELEMENT_ARRAY_BUFFER: u32 = 0x8893;
+    pub const COPY_READ_BUFFER: u32 = 0x8F36;
+    pub const COPY_WRITE_BUFFER: u32 = 0x8F37;
+    pub const PIXEL_PACK_BUFFER: u32 = 0x88EB;
+    pub const PIXEL_UNPACK_BUFFER: u32 = 0x88EC;
+    pub const TRANSFORM_FEEDBACK_BUFFER: u32 = 0x8C8E;
+    pub const UNIFORM_BUFFER: u32 = 0x8A11;
+    pub const ARRAY_BUFFER_BINDING: u32 = 0x8894;
+    pub const ELEMENT_ARRAY_BUFFER_BINDING: u32 = 0x8895;
+    pub const PIXEL_PACK_BUFFER_BINDING: u32 = 0x88ED;
+    pub const PIXEL_UNPACK_BUFFER_BINDING: u32 = 0x88EF;
+    pub const TRANSFORM_FEEDBACK_BUFFER_BINDING: u32 = 0x8C8F;
+    pub const UNIFORM_BUFFER_BINDING: u32 = 0x8A28;
+
+    pub const FRAMEBUFFER: u32 = 0x8D40;
+    pub const READ_FRAMEBUFFER: u32 = 0x8CA8;
+    pub const DRAW_FRAMEBUFFER: u32 = 0x8CA9;
+    pub const FRAMEBUFFER_BINDING: u32 = 0x8CA6;
+    pub const READ_FRAMEBUFFER_BINDING: u32 = 0x8CAA;
+    pub const RENDERBUFFER: u32 = 0x8D41;
+    pub const RENDERBUFFER_BINDING: u32 = 0x8CA7;
+
+    pub const TEXTURE_2D: u32 = 0x0DE1;
+    pub const TEXTURE_CUBE_MAP: u32 = 0x8513;
+    pub const TEXTURE_3D: u32 = 0x806F;
+    pub const TEXTURE_2D_ARRAY: u32 = 0x8C1A;
+    pub const TEXTURE_BINDING_2D: u32 = 0x8069;
+    pub const TEXTURE_BINDING_CUBE_MAP: u32 = 0x8514;
+    pub const TEXTURE_BINDING_3D: u32 = 0x806A;
+    pub const TEXTURE_BINDING_2D_ARRAY: u32 = 0x8C1D;
+    pub const ACTIVE_TEXTURE: u32 = 0x84E0;
+
+    pub const CURRENT_PROGRAM: u32 = 0x8B8D;
+    pub const VERTEX_ARRAY_BINDING: u32 = 0x85B5;
+    pub const VIEWPORT: u32 = 0x0BA2;
+    pub const SCISSOR_BOX: u32 = 0x0C10;
+
+    // The limits, which don't change for the context's life.
+    pub const LIMITS: &[u32] = &[
+        0x0D33, // MAX_TEXTURE_SIZE
+        0x851C, // MAX_CUBE_MAP_TEXTURE_SIZE
+        0x84E8, // MAX_RENDERBUFFER_SIZE
+        0x0D3A, // MAX_VIEWPORT_DIMS
+        0x846D, // ALIASED_POINT_SIZE_RANGE
+        0x846E, // ALIASED_LINE_WIDTH_RANGE
+        0x8869, // MAX_VERTEX_ATTRIBS
+        0x8DFB, // MAX_VERTEX_UNIFORM_VECTORS
+        0x8DFC, // MAX_VARYING_VECTORS
+        0x8DFD, // MAX_FRAGMENT_UNIFORM_VECTORS
+        0x8872, // MAX_TEXTURE_IMAGE_UNITS
+        0x8B4C, // MAX_VERTEX_TEXTURE_IMAGE_UNITS
+        0x8B4D, // MAX_COMBINED_TEXTURE_IMAGE_UNITS
+        0x0D50, // SUBPIXEL_BITS
+        0x8073, // MAX_3D_TEXTURE_SIZE
+        0x88FF, // MAX_ARRAY_TEXTURE_LAYERS
+        0x84FD, // MAX_TEXTURE_LOD_BIAS
+        0x8824, // MAX_DRAW_BUFFERS
+        0x8CDF, // MAX_COLOR_ATTACHMENTS
+        0x8D57, // MAX_SAMPLES
+        0x80E8, // MAX_ELEMENTS_VERTICES
+        0x80E9, // MAX_ELEMENTS_INDICES
+        0x8D6B, // MAX_ELEMENT_INDEX
+        0x8A2F, // MAX_UNIFORM_BUFFER_BINDINGS
+        0x8A30, // MAX_UNIFORM_BLOCK_SIZE
+        0x8A2B, // MAX_VERTEX_UNIFORM_BLOCKS
+        0x8A2D, // MAX_FRAGMENT_UNIFORM_BLOCKS
+        0x8A2E, // MAX_COMBINED_UNIFORM_BLOCKS
+        0x8A34, // UNIFORM_BUFFER_OFFSET_ALIGNMENT
+        0x8B49, // MAX_FRAGMENT_UNIFORM_COMPONENTS
+        0x8B4A, // MAX_VERTEX_UNIFORM_COMPONENTS
+        0x9122, // MAX_VERTEX_OUTPUT_COMPONENTS
+        0x9125, // MAX_FRAGMENT_INPUT_COMPONENTS
+        0x8C8A, // MAX_TRANSFORM_FEEDBACK_INTERLEAVED_COMPONENTS
+        0x8C8B, // MAX_TRANSFORM_FEEDBACK_SEPARATE_ATTRIBS
+        0x8C80, // MAX_TRANSFORM_FEEDBACK_SEPARATE_COMPONENTS
+        0x9111, // MAX_SERVER_WAIT_TIMEOUT
+        0x8904, // MIN_PROGRAM_TEXEL_OFFSET
+        0x8905, // MAX_PROGRAM_TEXEL_OFFSET
+    ];
+
+    // The state kept up to date by the shadow's wrappers.
+    pub const TRACKED: &[u32] = &[
+        ARRAY_BUFFER_BINDING,
+        ELEMENT_ARRAY_BUFFER_BINDING,
+        COPY_READ_BUFFER,
+        COPY_WRITE_BUFFER,
+        PIXEL_PACK_BUFFER_BINDING,
+        PIXEL_UNPACK_BUFFER_BINDING,
+        TRANSFORM_FEEDBACK_BUFFER_BINDING,
+        UNIFORM_BUFFER_BINDING,
+        FRAMEBUFFER_BINDING,
+        READ_FRAMEBUFFER_BINDING,
+        RENDERBUFFER_BINDING,
+        TEXTURE_BINDING_2D,
+        TEXTURE_BINDING_CUBE_MAP,
+        TEXTURE_BINDING_3D,
+        TEXTURE_BINDING_2D_ARRAY,
+        ACTIVE_TEXTURE,
+        CURRENT_PROGRAM,
+        VERTEX_ARRAY_BINDING,
+        VIEWPORT,
+        SCISSOR_BOX,
+    ];
+}
+
+static GL_BIND_BUFFER: GlProc<unsafe extern "C" fn(u32, u32)> =
+    unsafe { GlProc::new(c"glBindBuffer", GlVersion::Any) };
+static GL_BIND_FRAMEBUFFER: GlProc<unsafe extern "C" fn(u32, u32)> =
+    unsafe { GlProc::new(c"glBindFramebuffer", GlVersion::Any) };
+static GL_BIND_RENDERBUFFER: GlProc<unsafe extern "C" fn(u32, u32)> =
+    unsafe { GlProc::new(c"glBindRenderbuffer", GlVersion::Any) };
+static GL_BIND_TEXTURE: GlProc<unsafe extern "C" fn(u32, u32)> =
+    unsafe { GlProc::new(c"glBindTexture", GlVersion::Any) };
+static GL_ACTIVE_TEXTURE: GlProc<unsafe extern "C" fn(u32)> =
+    unsafe { GlProc::new(c"glActiveTexture", GlVersion::Any) };
+static GL_USE_PROGRAM: GlProc<unsafe extern "C" fn(u32)> =
+    unsafe { GlProc::new(c"glUseProgram", GlVersion::Any) };
+static GL_BIND_VERTEX_ARRAY: GlProc<unsafe extern "C" fn(u32)> =
+    unsafe { GlProc::new(c"glBindVertexArray", GlVersion::Any) };
+static GL_VIEWPORT: GlProc<unsafe extern "C" fn(i32, i32, i32, i32)> =
+    unsafe { GlProc::new(c"glViewport", GlVersion::Any) };
+static GL_SCISSOR: GlProc<unsafe extern "C" fn(i32, i32, i32, i32)> =
+    unsafe { GlProc::new(c"glScissor", GlVersion::Any) };
+
+// The longest vector of a cached parameter, uniform or vertex attribute: a `mat4` uniform.
+const MAX_LEN: usize = 16;
+
+// How a value was queried: the same parameter reads differently with each function.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+enum Kind {
+    Double,
+    Object,
+    Ints,
+    Floats,
+    Int64,
+}
+
+const KINDS: [Kind; 5] = [
+    Kind::Double,
+    Kind::Object,
+    Kind::Ints,
+    Kind::Floats,
+    Kind::Int64,
+];
+
+#[derive(Debug, Clone)]
+enum Value {
+    Double(f64),
+    Object(u32),
+    Ints(Box<[i32]>),
+    Floats(Box<[f32]>),
+    Int64(i64),
+}
+
+// The values cached under keys of type `K`, by the function that queried them.
+struct Cache<K> {
+    values: HashMap<(K, Kind), Value>,
+}
+
+impl<K: Copy + Eq + Hash> Cache<K> {
+    fn new() -> Self {
+        Self {
+            values: HashMap::new(),
+        }
+    }
+
+    fn get_or_insert_with(&mut self, key: K, kind: Kind, query: impl FnOnce() -> Value) -> &Value {
+        self.values.entry((key, kind)).or_insert_with(query)
+    }
+
+    // Sets the value of a key, forgetting the ones read by other functions.
+    fn set(&mut self, key: K, value: Value) {
+        self.remove(key);
+        let kind = match value {
+            Value::Double(_) => Kind::Double,
+            Value::Object(_) => Kind::Object,
+            Value::Ints(_) => Kind::Ints,
+            Value::Floats(_) => Kind::Floats,
+            Value::Int64(_) => Kind::Int64,
+        };
+        self.values.insert((key, kind), value);
+    }
+
+    fn remove(&mut self, key: K) {
+        for kind in KINDS {
+            self.values.remove(&(key, kind));
+        }
+    }
+
+    fn retain(&mut self, mut keep: impl FnMut(K) -> bool) {
+        self.values.retain(|(key, _), _| keep(*key));
+    }
+
+    fn clear(&mut self) {
+        self.values.clear();
+    }
+}
+
+// Queries a vector with one of emscripten's `_v` functions, into a buffer long enough for any cached value.
+fn query_vector(
+    kind: Kind,
+    query: impl FnOnce(*mut std::ffi::c_void, c_int, c_int) -> c_int,
+) -> Value {
+    match kind {
+        Kind::Ints => {
+            let mut values = [0i32; MAX_LEN];
+            let count = query(
+                values.as_mut_ptr() as _,
+                MAX_LEN as c_int,
+                html5::EMSCRIPTEN_WEBGL_PARAM_TYPE_INT as c_int,
+            );
+            Value::Ints(values[..count.clamp(0, MAX_LEN as c_int) as usize].into())
+        }
+        _ => {
+            let mut values = [0f32; MAX_LEN];
+            let count = query(
+                values.as_mut_ptr() as _,
+                MAX_LEN as c_int,
+                html5::EMSCRIPTEN_WEBGL_PARAM_TYPE_FLOAT as c_int,
+            );
+            Value::Floats(values[..count.clamp(0, MAX_LEN as c_int) as usize].into())
+        }
+    }
+}
+
+// Copies a cached vector into `dst`, returning the number of values copied.
+fn copy_vector<T: Copy>(values: &[T], dst: &mut [T]) -> usize {
+    let count = values.len().min(dst.len());
+    dst[..count].copy_from_slice(&values[..count]);
+    count
+}
+
+struct ShadowState {
+    parameters: Cache<u32>,
+    // By program and location.
+    uniforms: Cache<(u32, i32)>,
+    // By index and parameter.
+    vertex_attribs: Cache<(u32, u32)>,
+}
+
+/// The shadow of a WebGL context's state. See the [module documentation](self).
+///
+/// The queries and the wrappers act on the calling thread's current context, which must be the shadow's one.
+///
+/// # Examples
+/// ```rust
+/// let context = Context::builder().version(2, 0).create("#canvas").unwrap();
+/// context.make_current().unwrap();
+/// let shadow = StateShadow::new(&context);
+///
+/// let max_texture_size = shadow.get_parameter_d(0x0D33); // MAX_TEXTURE_SIZE, queried once.
+/// shadow.bind_buffer(0x8892, vertex_buffer); // ARRAY_BUFFER
+/// assert_eq!(shadow.get_parameter_o(0x8894), vertex_buffer); // ARRAY_BUFFER_BINDING, from the shadow.
+/// ```
+pub struct StateShadow {
+    context: html5::EMSCRIPTEN_WEBGL_CONTEXT_HANDLE,
+    state: RefCell<ShadowState>,
+    _not_send: PhantomData<*const ()>,
+}
+
+impl StateShadow {
+    /// Creates an empty shadow of the context's state, filled in by the first queries.
+    pub fn new(context: &Context) -> Self {
+        Self {
+            context: context.as_raw(),
+            state: RefCell::new(ShadowState {
+                parameters: Cache::new(),
+                uniforms: Cache::new(),
+                vertex_attribs: Cache::new(),
+            }),
+            _not_send: PhantomData,
+        }
+    }
+
+    /// Returns `true` if the shadow caches the answers to the queries of the given parameter.
+    pub fn is_cached(pname: u32) -> bool {
+        gl::LIMITS.contains(&pname) || gl::TRACKED.contains(&pname)
+    }
+
+    fn debug_assert_current(&self) {
+        debug_assert!(
+            unsafe { html5::emscripten_webgl_get_current_context() } == self.context,
+            "the shadow's context must be the current one"
+        );
+    }
+
+    // Answers a parameter query from the cache, if the parameter is cached.
+    fn parameter<R>(
+        &self,
+        pname: u32,
+        kind: Kind,
+        query: impl FnOnce() -> Value,
+        read: impl FnOnce(&Value) -> R,
+    ) -> R {
+        self.debug_assert_current();
+        if !Self::is_cached(pname) {
+            return read(&query());
+        }
+        read(
+            self.state
+                .borrow_mut()
+                .parameters
+                .get_or_insert_with(pname, kind, query),
+        )
+    }
+
+    /// Returns a numeric parameter of the context, like the emscripten-defined `emscripten_webgl_get_parameter_d`.
+    pub fn get_parameter_d(&self, pname: u32) -> f64 {
+        self.parameter(
+            pname,
+            Kind::Double,
+            || Value::Double(unsafe { html5::emscripten_webgl_get_parameter_d(pname as c_int) }),
+            |value| match value {
+                Value::Double(value) => *value,
+                _ => unreachable!(),
+            },
+        )
+    }
+
+    /// Returns the GL name of an object parameter of the context, like a bound buffer,
+    /// like the emscripten-defined `emscripten_webgl_get_parameter_o`.
+    pub fn get_parameter_o(&self, pname: u32) -> u32 {
+        self.parameter(
+            pname,
+            Kind::Object,
+            || {
+                Value::Object(
+                    unsafe { html5::emscripten_webgl_get_parameter_o(pname as c_int) } as u32,
+                )
+            },
+            |value| match value {
+                Value::Object(value) => *value,
+                _ => unreachable!(),
+            },
+        )
+    }
+
+    /// Writes an integer vector parameter of the context into `dst`, like the viewport,
+    /// like the emscripten-defined `emscripten_webgl_get_parameter_v`. Returns the number of values written.
+    pub fn get_parameter_iv(&self, pname: u32, dst: &mut [i32]) -> usize {
+        self.parameter(
+            pname,
+            Kind::Ints,
+            || {
+                query_vector(Kind::Ints, |ptr, len, ty| unsafe {
+                    html5::emscripten_webgl_get_parameter_v(pname as c_int, ptr, len, ty)
+                })
+            },
+            |value| match value {
+                Value::Ints(values) => copy_vector(values, dst),
+                _ => unreachable!(),
+            },
+        )
+    }
+
+    /// Writes a float vector parameter of the context into `dst`, like the range of the line widths,
+    /// like the emscripten-defined `emscripten_webgl_get_parameter_v`. Returns the number of values written.
+    pub fn get_parameter_fv(&self, pname: u32, dst: &mut [f32]) -> usize {
+        self.parameter(
+            pname,
+            Kind::Floats,
+            || {
+                query_vector(Kind::Floats, |ptr, len, ty| unsafe {
+                    html5::emscripten_webgl_get_parameter_v(pname as c_int, ptr, len, ty)
+                })
+            },
+            |value| match value {
+                Value::Floats(values) => copy_vector(values, dst),
+                _ => unreachable!(),
+            },
+        )
+    }
+
+    /// Returns a 64-bit parameter of the context, like `MAX_ELEMENT_INDEX`, like the emscripten-defined `emscripten_webgl_get_parameter_i64v`.
+    pub fn get_parameter_i64(&self, pname: u32) -> i64 {
+        self.parameter(
+            pname,
+            Kind::Int64,
+            || {
+                let mut value: c_longlong = 0;
+                unsafe { html5::emscripten_webgl_get_parameter_i64v(pname as c_int, &mut value) };
+                Value::Int64(value)
+            },
+            |value| match value {
+                Value::Int64(value) => *value,
+                _ => unreachable!(),
+            },
+        )
+    }
+
+    /// Returns the value of a scalar uniform of a program, like the emscripten-defined `emscripten_webgl_get_uniform_d`.
+    /// It's cached until [`uniform_changed`](Self::uniform_changed) is called for it.
+    pub fn get_uniform_d(&self, program: u32, location: i32) -> f64 {
+        self.debug_assert_current();
+        let mut state = self.state.borrow_mut();
+        match state
+            .uniforms
+            .get_or_insert_with((program, location), Kind::Double, || {
+                Value::Double(unsafe {
+                    html5::emscripten_webgl_get_uniform_d(program as c_int, location)
+                })
+            }) {
+            Value::Double(value) => *value,
+            _ => unreachable!(),
+        }
+    }
+
+    /// Writes the value of a vector or matrix uniform of a program into `dst`, like the emscripten-defined `emscripten_webgl_get_uniform_v`,
+    /// returning the number of values written. It's cached until [`uniform_changed`](Self::uniform_changed) is called for it.
+    pub fn get_uniform_fv(&self, program: u32, location: i32, dst: &mut [f32]) -> usize {
+        self.debug_assert_current();
+        let mut state = self.state.borrow_mut();
+        match state
+            .uniforms
+            .get_or_insert_with((program, location), Kind::Floats, || {
+                query_vector(Kind::Floats, |ptr, len, ty| unsafe {
+                    html5::emscripten_webgl_get_uniform_v(program as c_int, location, ptr, len, ty)
+                })
+            }) {
+            Value::Floats(values) => copy_vector(values, dst),
+            _ => unreachable!(),
+        }
+    }
+
+    /// Writes the value of an integer vector uniform of a program into `dst`, like the emscripten-defined `emscripten_webgl_get_uniform_v`,
+    /// returning the number of values written. It's cached until [`uniform_changed`](Self::uniform_changed) is called for it.
+    pub fn get_uniform_iv(&self, program: u32, location: i32, dst: &mut [i32]) -> usize {
+        self.debug_assert_current();
+        let mut state = self.state.borrow_mut();
+        match state
+            .uniforms
+            .get_or_insert_with((program, location), Kind::Ints, || {
+                query_vector(Kind::Ints, |ptr, len, ty| unsafe {
+                    html5::emscripten_webgl_get_uniform_v(program as c_int, location, ptr, len, ty)
+                })
+            }) {
+            Value::Ints(values) => copy_vector(values, dst),
+            _ => unreachable!(),
+        }
+    }
+
+    /// Returns a scalar parameter of a vertex attribute, like the emscripten-defined `emscripten_webgl_get_vertex_attrib_d`.
+    /// It's cached until [`vertex_attrib_changed`](Self::vertex_attrib_changed) is called for the attribute, or another vertex array gets bound.
+    pub fn get_vertex_attrib_d(&self, index: u32, pname: u32) -> f64 {
+        self.debug_assert_current();
+        let mut state = self.state.borrow_mut();
+        match state
+            .vertex_attribs
+            .get_or_insert_with((index, pname), Kind::Double, || {
+                Value::Double(unsafe {
+                    html5::emscripten_webgl_get_vertex_attrib_d(index as c_int, pname as c_int)
+                })
+            }) {
+            Value::Double(value) => *value,
+            _ => unreachable!(),
+        }
+    }
+
+    /// Returns the GL name of the buffer bound to a vertex attribute, like the emscripten-defined `emscripten_webgl_get_vertex_attrib_o`.
+    /// It's cached until [`vertex_attrib_changed`](Self::vertex_attrib_changed) is called for the attribute, or another vertex array gets bound.
+    pub fn get_vertex_attrib_o(&self, index: u32, pname: u32) -> u32 {
+        self.debug_assert_current();
+        let mut state = self.state.borrow_mut();
+        match state
+            .vertex_attribs
+            .get_or_insert_with((index, pname), Kind::Object, || {
+                Value::Object(unsafe {
+                    html5::emscripten_webgl_get_vertex_attrib_o(index as c_int, pname as c_int)
+                } as u32)
+            }) {
+            Value::Object(value) => *value,
+            _ => unreachable!(),
+        }
+    }
+
+    /// Writes a vector parameter of a vertex attribute into `dst`, like its current value,
+    /// like the emscripten-defined `emscripten_webgl_get_vertex_attrib_v`, returning the number of values written.
+    /// It's cached until [`vertex_attrib_changed`](Self::vertex_attrib_changed) is called for the attribute, or another vertex array gets bound.
+    pub fn get_vertex_attrib_fv(&self, index: u32, pname: u32, dst: &mut [f32]) -> usize {
+        self.debug_assert_current();
+        let mut state = self.state.borrow_mut();
+        match state
+            .vertex_attribs
+            .get_or_insert_with((index, pname), Kind::Floats, || {
+                query_vector(Kind::Floats, |ptr, len, ty| unsafe {
+                    html5::emscripten_webgl_get_vertex_attrib_v(
+                        index as c_int,
+                        pname as c_int,
+                        ptr,
+                        len,
+                        ty,
+                    )
+                })
+            }) {
+            Value::Floats(values) => copy_vector(values, dst),
+            _ => unreachable!(),
+        }
+    }
+
+    /// Reports that a uniform of a program was set, e.g. with `glUniform4f`, so that it's queried again.
+    pub fn uniform_changed(&self, program: u32, location: i32) {
+        self.state.borrow_mut().uniforms.remove((program, location));
+    }
+
+    /// Reports that a program was linked again, or deleted, so that all its uniforms are queried again.
+    pub fn program_changed(&self, program: u32) {
+        self.state
+            .borrow_mut()
+            .uniforms
+            .retain(|(uniform_program, _)| uniform_program != program);
+    }
+
+    /// Reports that a vertex attribute was changed, e.g. with `glVertexAttribPointer` or `glEnableVertexAttribArray`,
+    /// so that its parameters are queried again.
+    pub fn vertex_attrib_changed(&self, index: u32) {
+        self.state
+            .borrow_mut()
+            .vertex_attribs
+            .retain(|(attrib_index, _)| attrib_index != index);
+    }
+
+    /// Reports that a parameter was changed by other means than the shadow's wrappers, so that it's queried again.
+    pub fn invalidate(&self, pname: u32) {
+        self.state.borrow_mut().parameters.remove(pname);
+    }
+
+    /// Forgets all the cached state, e.g. once the context got restored after a loss.
+    pub fn invalidate_all(&self) {
+        let mut state = self.state.borrow_mut();
+        state.parameters.clear();
+        state.uniforms.clear();
+        state.vertex_attribs.clear();
+    }
+
+    fn set_object(&self, pname: u32, object: u32) {
+        self.state
+            .borrow_mut()
+            .parameters
+            .set(pname, Value::Object(object));
+    }
+
+    /// Binds a buffer with `glBindBuffer`, and records the binding.
+    pub fn bind_buffer(&self, target: u32, buffer: u32) {
+        self.debug_assert_current();
+        if let Some(gl_bind_buffer) = GL_BIND_BUFFER.get() {
+            unsafe { gl_bind_buffer(target, buffer) };
+        }
+        let pname = match target {
+            gl::ARRAY_BUFFER => gl::ARRAY_BUFFER_BINDING,
+            gl::ELEMENT_ARRAY_BUFFER => gl::ELEMENT_ARRAY_BUFFER_BINDING,
+            gl::PIXEL_PACK_BUFFER => gl::PIXEL_PACK_BUFFER_BINDING,
+            gl::PIXEL_UNPACK_BUFFER => gl::PIXEL_UNPACK_BUFFER_BINDING,
+            gl::TRANSFORM_FEEDBACK_BUFFER => gl::TRANSFORM_FEEDBACK_BUFFER_BINDING,
+            gl::UNIFORM_BUFFER => gl::UNIFORM_BUFFER_BINDING,
+            // The copy targets are their own binding parameters.
+            gl::COPY_READ_BUFFER | gl::COPY_WRITE_BUFFER => target,
+            _ => return,
+        };
+        self.set_object(pname, buffer);
+    }
+
+    /// Binds a framebuffer with `glBindFramebuffer`, and records the binding.
+    pub fn bind_framebuffer(&self, target: u32, framebuffer: u32) {
+        self.debug_assert_current();
+        if let Some(gl_bind_framebuffer) = GL_BIND_FRAMEBUFFER.get() {
+            unsafe { gl_bind_framebuffer(target, framebuffer) };
+        }
+        // `FRAMEBUFFER_BINDING` is also the draw framebuffer's binding.
+        if target == gl::FRAMEBUFFER || target == gl::DRAW_FRAMEBUFFER {
+            self.set_object(gl::FRAMEBUFFER_BINDING, framebuffer);
+        }
+        if target == gl::FRAMEBUFFER || target == gl::READ_FRAMEBUFFER {
+            self.set_object(gl::READ_FRAMEBUFFER_BINDING, framebuffer);
+        }
+    }
+
+    /// Binds a renderbuffer with `glBindRenderbuffer`, and records the binding.
+    pub fn bind_renderbuffer(&self, target: u32, renderbuffer: u32) {
+        self.debug_assert_current();
+        if let Some(gl_bind_renderbuffer) = GL_BIND_RENDERBUFFER.get() {
+            unsafe { gl_bind_renderbuffer(target, renderbuffer) };
+        }
+        if target == gl::RENDERBUFFER {
+            self.set_object(gl::RENDERBUFFER_BINDING, renderbuffer);
+        }
+    }
+
+    /// Binds a texture to the active texture unit with `glBindTexture`, and records the binding.
+    pub fn bind_texture(&self, target: u32, texture: u32) {
+        self.debug_assert_current();
+        if let Some(gl_bind_texture) = GL_BIND_TEXTURE.get() {
+            unsafe { gl_bind_texture(target, texture) };
+        }
+        let pname = match target {
+            gl::TEXTURE_2D => gl::TEXTURE_BINDING_2D,
+            gl::TEXTURE_CUBE_MAP => gl::TEXTURE_BINDING_CUBE_MAP,
+            gl::TEXTURE_3D => gl::TEXTURE_BINDING_3D,
+            gl::TEXTURE_2D_ARRAY => gl::TEXTURE_BINDING_2D_ARRAY,
+            _ => return,
+        };
+        self.set_object(pname, texture);
+    }
+
+    /// Selects the active texture unit with `glActiveTexture`, and records it.
+    /// The texture bindings, which are the unit's ones, are queried again.
+    pub fn active_texture(&self, texture: u32) {
+        self.debug_assert_current();
+        if let Some(gl_active_texture) = GL_ACTIVE_TEXTURE.get() {
+            unsafe { gl_active_texture(texture) };
+        }
+        let mut state = self.state.borrow_mut();
+        for pname in [
+            gl::TEXTURE_BINDING_2D,
+            gl::TEXTURE_BINDING_CUBE_MAP,
+            gl::TEXTURE_BINDING_3D,
+            gl::TEXTURE_BINDING_2D_ARRAY,
+        ] {
+            state.parameters.remove(pname);
+        }
+        state
+            .parameters
+            .set(gl::ACTIVE_TEXTURE, Value::Double(texture as f64));
+    }
+
+    /// Makes a program the current one with `glUseProgram`, and records it.
+    pub fn use_program(&self, program: u32) {
+        self.debug_assert_current();
+        if let Some(gl_use_program) = GL_USE_PROGRAM.get() {
+            unsafe { gl_use_program(program) };
+        }
+        self.set_object(gl::CURRENT_PROGRAM, program);
+    }
+
+    /// Binds a vertex array object with `glBindVertexArray`, and records the binding.
+    /// The element array buffer binding and the vertex attributes, which are the vertex array's state, are queried again.
+    pub fn bind_vertex_array(&self, vertex_array: u32) {
+        self.debug_assert_current();
+        if let Some(gl_bind_vertex_array) = GL_BIND_VERTEX_ARRAY.get() {
+            unsafe { gl_bind_vertex_array(vertex_array) };
+        }
+        let mut state = self.state.borrow_mut();
+        state.parameters.remove(gl::ELEMENT_ARRAY_BUFFER_BINDING);
+        state.vertex_attribs.clear();
+        state
+            .parameters
+            .set(gl::VERTEX_ARRAY_BINDING, Value::Object(vertex_array));
+    }
+
+    /// Sets the viewport with `glViewport`, and records it.
+    pub fn viewport(&self, x: i32, y: i32, width: i32, height: i32) {
+        self.debug_assert_current();
+        if let Some(gl_viewport) = GL_VIEWPORT.get() {
+            unsafe { gl_viewport(x, y, width, height) };
+        }
+        self.state
+            .borrow_mut()
+            .parameters
+            .set(gl::VIEWPORT, Value::Ints([x, y, width, height].into()));
+    }
+
+    /// Sets the scissor box with `glScissor`, and records it.
+    pub fn scissor(&self, x: i32, y: i32, width: i32, height: i32) {
+        self.debug_assert_current();
+        if let Some(gl_scissor) = GL_SCISSOR.get() {
+            unsafe { gl_scissor(x, y, width, height) };
+        }
+        self.state
+            .borrow_mut()
+            .parameters
+            .set(gl::SCISSOR_BOX, Value::Ints([x, y, width, height].into()));
+    }
+}
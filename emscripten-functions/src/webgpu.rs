@@ -0,0 +1,132 @@
+//! Access to the WebGPU objects of emscripten's [`html5_webgpu.h`] header file: the preinitialized device,
+//! and the conversion of WebGPU objects from and to JS handles, e.g. to pass a canvas' context from JS to rust.
+//!
+//! The objects are the raw `WGPU*` handles of `webgpu.h`, to be used with a `webgpu.h` binding of your own.
+//! The program must be linked with `-sUSE_WEBGPU`.
+//!
+//! [`html5_webgpu.h`]: https://github.com/emscripten-core/emscripten/blob/main/system/include/emscripten/html5_webgpu.h
+
+use std::os::raw::c_int;
+
+use emscripten_functions_sys::html5_webgpu::{
+    self, WGPUBuffer, WGPUDevice, WGPUQueue, WGPUSurface, WGPUSwapChain,
+};
+
+/// Returns the device set in `Module.preinitializedWebGPUDevice` by the JS code before starting the program,
+/// using the emscripten-defined `emscripten_webgpu_get_device`, or `None` if there's none.
+///
+/// # Examples
+/// On the JS side:
+/// ```js
+/// const adapter = await navigator.gpu.requestAdapter();
+/// Module.preinitializedWebGPUDevice = await adapter.requestDevice();
+/// ```
+/// Then in rust:
+/// ```rust
+/// let device = get_device().expect("the device wasn't preinitialized");
+/// ```
+pub fn get_device() -> Option<WGPUDevice> {
+    let device = unsafe { html5_webgpu::emscripten_webgpu_get_device() };
+    (!device.is_null()).then_some(device)
+}
+
+/// A handle to a WebGPU object in emscripten's JS-side table, released when dropped.
+///
+/// It's how WebGPU objects are passed between JS and rust: the JS code gets one for an object with `JsValStore.add(object)`,
+/// and rust imports the object with [`import`].
+#[derive(Debug)]
+pub struct JsHandle(c_int);
+
+impl JsHandle {
+    /// Takes ownership of the given handle, e.g. one the JS code got with `JsValStore.add(object)`.
+    ///
+    /// # Safety
+    /// The handle must be valid, and not be released by anything else: it's released when the returned value is dropped.
+    pub unsafe fn from_raw(handle: c_int) -> Self {
+        Self(handle)
+    }
+
+    /// Returns the raw handle, e.g. to pass it to JS code.
+    pub fn as_raw(&self) -> c_int {
+        self.0
+    }
+
+    /// Returns the raw handle, without releasing it; it's then up to the JS code to release it.
+    pub fn into_raw(self) -> c_int {
+        let handle = self.0;
+        std::mem::forget(self);
+        handle
+    }
+}
+
+impl Drop for JsHandle {
+    fn drop(&mut self) {
+        unsafe {
+            html5_webgpu::emscripten_webgpu_release_js_handle(self.0);
+        }
+    }
+}
+
+/// A WebGPU object type that can be imported from and exported to a [`JsHandle`].
+pub trait JsObject: Sized {
+    /// Returns a new reference to the object behind the handle.
+    fn import(handle: &JsHandle) -> Self;
+    /// Returns a new handle to the object.
+    fn export(&self) -> JsHandle;
+}
+
+impl JsObject for WGPUDevice {
+    fn import(handle: &JsHandle) -> Self {
+        unsafe { html5_webgpu::emscripten_webgpu_import_device(handle.0) }
+    }
+    fn export(&self) -> JsHandle {
+        JsHandle(unsafe { html5_webgpu::emscripten_webgpu_export_device(*self) })
+    }
+}
+
+impl JsObject for WGPUQueue {
+    fn import(handle: &JsHandle) -> Self {
+        unsafe { html5_webgpu::emscripten_webgpu_import_queue(handle.0) }
+    }
+    fn export(&self) -> JsHandle {
+        JsHandle(unsafe { html5_webgpu::emscripten_webgpu_export_queue(*self) })
+    }
+}
+
+impl JsObject for WGPUBuffer {
+    fn import(handle: &JsHandle) -> Self {
+        unsafe { html5_webgpu::emscripten_webgpu_import_buffer(handle.0) }
+    }
+    fn export(&self) -> JsHandle {
+        JsHandle(unsafe { html5_webgpu::emscripten_webgpu_export_buffer(*self) })
+    }
+}
+
+/// A surface is a canvas' `GPUCanvasContext`.
+impl JsObject for WGPUSurface {
+    fn import(handle: &JsHandle) -> Self {
+        unsafe { html5_webgpu::emscripten_webgpu_import_surface(handle.0) }
+    }
+    fn export(&self) -> JsHandle {
+        JsHandle(unsafe { html5_webgpu::emscripten_webgpu_export_surface(*self) })
+    }
+}
+
+impl JsObject for WGPUSwapChain {
+    fn import(handle: &JsHandle) -> Self {
+        unsafe { html5_webgpu::emscripten_webgpu_import_swap_chain(handle.0) }
+    }
+    fn export(&self) -> JsHandle {
+        JsHandle(unsafe { html5_webgpu::emscripten_webgpu_export_swap_chain(*self) })
+    }
+}
+
+/// Imports the WebGPU object behind the handle, e.g. `import::<WGPUSurface>(&handle)` for a canvas context.
+pub fn import<T: JsObject>(handle: &JsHandle) -> T {
+    T::import(handle)
+}
+
+/// Exports the WebGPU object to a new handle, for JS code to use.
+pub fn export<T: JsObject>(object: &T) -> JsHandle {
+    object.export()
+}
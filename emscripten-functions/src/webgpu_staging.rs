@@ -0,0 +1,208 @@
+//! Transfers between the wasm heap and WebGPU buffers, without the intermediate copies of a `webgpu.h` binding.
+//!
+//! Going through `wgpuQueueWriteBuffer` and `wgpuBufferGetConstMappedRange` copies the data into temporary JS and wasm buffers on
+//! each transfer. A [`StagingPool`] instead uploads with `writeBuffer` straight from the given slice of the heap, and reads back
+//! into the caller's `Vec`, with a single copy from the mapped range, into staging buffers pooled by power-of-two size classes.
+//!
+//! The program must be linked with `-sUSE_WEBGPU`. The offsets and sizes must be multiples of 4, as WebGPU requires.
+
+use std::{
+    fmt::Display,
+    marker::PhantomData,
+    os::raw::{c_int, c_void},
+};
+
+use emscripten_functions_sys::html5_webgpu::{WGPUBuffer, WGPUDevice};
+
+use crate::{
+    executor::{callback_future, CallbackFuture},
+    webgpu::{JsHandle, JsObject},
+};
+
+extern "C" {
+    fn webgpu_staging_write(
+        device: c_int,
+        buffer: c_int,
+        offset: f64,
+        data: *const c_void,
+        size: f64,
+    );
+    fn webgpu_staging_read(
+        device: c_int,
+        buffer: c_int,
+        offset: f64,
+        dst: *mut c_void,
+        size: f64,
+        callback: unsafe extern "C" fn(*mut c_void, c_int),
+        arg: *mut c_void,
+    );
+    fn webgpu_staging_trim(device: c_int);
+}
+
+/// The error of a transfer of a [`StagingPool`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum StagingError {
+    /// The offset or the size isn't a multiple of 4.
+    Unaligned,
+    /// The staging buffer couldn't be mapped, e.g. because the device was lost.
+    MapFailed,
+}
+
+impl Display for StagingError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        match self {
+            Self::Unaligned => write!(
+                f,
+                "The offset and size of a buffer transfer must be multiples of 4"
+            ),
+            Self::MapFailed => write!(f, "The staging buffer couldn't be mapped"),
+        }
+    }
+}
+
+fn check_alignment(offset: u64, size: usize) -> Result<(), StagingError> {
+    if offset % 4 != 0 || size % 4 != 0 {
+        return Err(StagingError::Unaligned);
+    }
+    Ok(())
+}
+
+struct PendingRead {
+    data: Vec<u8>,
+    size: usize,
+    callback: Box<dyn FnOnce(Result<Vec<u8>, StagingError>)>,
+}
+
+unsafe extern "C" fn read_done(arg: *mut c_void, result: c_int) {
+    let PendingRead {
+        mut data,
+        size,
+        callback,
+    } = *Box::from_raw(arg as *mut PendingRead);
+    if result == 0 {
+        callback(Err(StagingError::MapFailed));
+        return;
+    }
+    // The JS code filled the first `size` bytes of the reserved capacity.
+    data.set_len(size);
+    callback(Ok(data));
+}
+
+/// Uploads to and reads back from the buffers of a WebGPU device. See the [module documentation](self).
+///
+/// The staging buffers are pooled on the device, and shared by all the pools of the same device.
+///
+/// # Examples
+/// ```rust
+/// let staging = StagingPool::new(get_device().unwrap());
+/// staging.write(vertex_buffer, 0, bytemuck::cast_slice(&vertices)).unwrap();
+///
+/// let mut readback = Vec::new();
+/// set_main_loop(move || {
+///     // The buffer must have the `COPY_SRC` usage.
+///     let pixels = staging.read_async(picking_buffer, 0, 256, std::mem::take(&mut readback));
+///     spawn_local(async move {
+///         if let Ok(pixels) = pixels.await {
+///             pick_object(&pixels);
+///         }
+///     });
+/// }, 0, true);
+/// ```
+pub struct StagingPool {
+    device: JsHandle,
+    _not_send: PhantomData<*const ()>,
+}
+
+impl StagingPool {
+    /// Creates a pool for the buffers of the given device.
+    pub fn new(device: WGPUDevice) -> Self {
+        Self {
+            device: device.export(),
+            _not_send: PhantomData,
+        }
+    }
+
+    /// Writes the data into the buffer at the given offset, by the device's queue, straight from the wasm heap.
+    /// The data is copied when called, so the slice can be reused right away.
+    ///
+    /// # Arguments
+    /// * `buffer` - The buffer to write to, with the `COPY_DST` usage.
+    /// * `offset` - The offset in the buffer, a multiple of 4.
+    /// * `data` - The bytes to write, whose length must be a multiple of 4.
+    pub fn write(&self, buffer: WGPUBuffer, offset: u64, data: &[u8]) -> Result<(), StagingError> {
+        check_alignment(offset, data.len())?;
+        let buffer = buffer.export();
+        unsafe {
+            webgpu_staging_write(
+                self.device.as_raw(),
+                buffer.as_raw(),
+                offset as f64,
+                data.as_ptr() as *const c_void,
+                data.len() as f64,
+            );
+        }
+        Ok(())
+    }
+
+    /// Copies a range of the buffer into a staging buffer of the pool, maps it, and calls `callback` with its bytes,
+    /// in `into`, whose previous content is discarded. Passing the `Vec` of the previous readback reuses its allocation.
+    ///
+    /// # Arguments
+    /// * `buffer` - The buffer to read from, with the `COPY_SRC` usage.
+    /// * `offset` - The offset in the buffer, a multiple of 4.
+    /// * `size` - The number of bytes to read, a multiple of 4.
+    /// * `into` - The vector receiving the bytes.
+    /// * `callback` - The function called with the filled vector, or with the error.
+    pub fn read<F>(
+        &self,
+        buffer: WGPUBuffer,
+        offset: u64,
+        size: usize,
+        mut into: Vec<u8>,
+        callback: F,
+    ) where
+        F: 'static + FnOnce(Result<Vec<u8>, StagingError>),
+    {
+        if let Err(error) = check_alignment(offset, size) {
+            callback(Err(error));
+            return;
+        }
+
+        into.clear();
+        into.reserve(size);
+        let dst = into.as_mut_ptr() as *mut c_void;
+        let arg = Box::into_raw(Box::new(PendingRead {
+            data: into,
+            size,
+            callback: Box::new(callback),
+        })) as *mut c_void;
+        let buffer = buffer.export();
+        unsafe {
+            webgpu_staging_read(
+                self.device.as_raw(),
+                buffer.as_raw(),
+                offset as f64,
+                dst,
+                size as f64,
+                read_done,
+                arg,
+            );
+        }
+    }
+
+    /// Returns a future completing with the bytes read back from the buffer. See [`read`](Self::read).
+    pub fn read_async(
+        &self,
+        buffer: WGPUBuffer,
+        offset: u64,
+        size: usize,
+        into: Vec<u8>,
+    ) -> CallbackFuture<Result<Vec<u8>, StagingError>> {
+        callback_future(|callback| self.read(buffer, offset, size, into, callback))
+    }
+
+    /// Destroys the idle staging buffers of the device, e.g. after a burst of large readbacks.
+    pub fn trim(&self) {
+        unsafe { webgpu_staging_trim(self.device.as_raw()) };
+    }
+}
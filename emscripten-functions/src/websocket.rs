@@ -0,0 +1,544 @@
+//! WebSockets with closure callbacks, over the emscripten `websocket.h` header file.
+//!
+//! Received binary messages are handed to the message callback as a borrowed `&[u8]` view of the buffer emscripten copied them into,
+//! and sent ones are read straight from the given slice, so no copies are made on the rust side.
+//! To keep them past the callback, [`WebSocket::on_message_pooled`] copies them into buffers of a [`BufferPool`] instead,
+//! reused from one message to the next.
+//! Messages declared with [`flat_message!`](crate::flat_message) are read in place from the borrowed bytes, without being deserialized.
+//!
+//! The program must be linked with `-lwebsocket.js`.
+
+use std::{
+    ffi::CStr,
+    fmt::Display,
+    marker::PhantomData,
+    os::raw::{c_int, c_ushort, c_void},
+};
+
+use emscripten_functions_sys::websocket;
+
+use crate::{
+    buffer_pool::{BufferPool, PooledBuf},
+    c_str::with_c_str,
+    html5::Html5Error,
+};
+
+/// The default number of bytes a [`WebSocket`] can have queued, by the browser and in its batch, before [`queue_binary`](WebSocket::queue_binary) refuses messages.
+pub const DEFAULT_HIGH_WATER_MARK: usize = 1024 * 1024;
+
+/// The size over which a batch gets sent before more messages are queued in it.
+pub const MAX_BATCH_SIZE: usize = 64 * 1024;
+
+// `EM_CALLBACK_THREAD_CONTEXT_CALLING_THREAD`, a pointer-valued macro bindgen doesn't generate.
+const CALLING_THREAD: websocket::pthread_t = 0x2 as websocket::pthread_t;
+
+/// Returns `true` if the browser supports WebSockets.
+pub fn is_supported() -> bool {
+    unsafe { websocket::emscripten_websocket_is_supported() != 0 }
+}
+
+/// The state of the connection of a [`WebSocket`], i.e. its `readyState`.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum ReadyState {
+    /// The connection isn't open yet.
+    Connecting,
+    /// The connection is open, and messages can be sent.
+    Open,
+    /// The closing handshake started.
+    Closing,
+    /// The connection is closed, or couldn't be opened.
+    Closed,
+}
+
+/// A message received by a [`WebSocket`], only valid during the call of its message callback.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Message<'a> {
+    /// A text message.
+    Text(&'a str),
+    /// A binary message.
+    Binary(&'a [u8]),
+}
+
+/// A message received by a [`WebSocket`] in the mode of [`WebSocket::on_message_pooled`]: the binary ones are owned.
+#[derive(Debug)]
+pub enum PooledMessage<'a> {
+    /// A text message, only valid during the call of the message callback.
+    Text(&'a str),
+    /// A binary message, copied into a buffer of the pool, which goes back to it when dropped.
+    Binary(PooledBuf),
+}
+
+/// The error of [`WebSocket::queue_binary`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum QueueError {
+    /// The bytes queued by the browser and in the batch reached the high water mark: the producer should wait for them to drain.
+    Backpressure,
+    /// Sending the full batch failed.
+    Send(Html5Error),
+}
+
+impl Display for QueueError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        match self {
+            QueueError::Backpressure => write!(f, "Too many bytes queued on the socket"),
+            QueueError::Send(err) => write!(f, "Failed to send the batch: {}", err),
+        }
+    }
+}
+
+/// The reason a [`WebSocket`] got closed.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct CloseEvent {
+    /// `true` if the connection was closed cleanly, with a closing handshake.
+    pub was_clean: bool,
+    /// The close code sent by the server.
+    pub code: u16,
+    /// The close reason sent by the server.
+    pub reason: String,
+}
+
+type OnOpen = Box<dyn FnMut()>;
+type OnMessage = Box<dyn FnMut(Message<'_>)>;
+type OnError = Box<dyn FnMut()>;
+type OnClose = Box<dyn FnMut(&CloseEvent)>;
+
+#[derive(Default)]
+struct Handlers {
+    onopen: Option<OnOpen>,
+    onmessage: Option<OnMessage>,
+    onerror: Option<OnError>,
+    onclose: Option<OnClose>,
+}
+
+// Takes the handler out during its call, so that it can't be reached twice if the call runs the event loop.
+unsafe fn call_handler<H, C>(
+    user_data: *mut c_void,
+    handler: fn(&mut Handlers) -> &mut Option<H>,
+    call: C,
+) where
+    C: FnOnce(&mut H),
+{
+    let handlers = &mut *(user_data as *mut Handlers);
+    if let Some(mut func) = handler(handlers).take() {
+        call(&mut func);
+        handler(&mut *(user_data as *mut Handlers)).get_or_insert(func);
+    }
+}
+
+unsafe extern "C" fn open_trampoline(
+    _event_type: c_int,
+    _event: *const websocket::EmscriptenWebSocketOpenEvent,
+    user_data: *mut c_void,
+) -> c_int {
+    call_handler(user_data, |handlers| &mut handlers.onopen, |func| func());
+    1
+}
+
+unsafe extern "C" fn message_trampoline(
+    _event_type: c_int,
+    event: *const websocket::EmscriptenWebSocketMessageEvent,
+    user_data: *mut c_void,
+) -> c_int {
+    let event = &*event;
+    let data: &[u8] = if event.data.is_null() {
+        &[]
+    } else {
+        std::slice::from_raw_parts(event.data, event.numBytes as usize)
+    };
+    let message = if event.isText != 0 {
+        // Text messages come with their nul terminator counted in.
+        let text = data.strip_suffix(&[0]).unwrap_or(data);
+        Message::Text(std::str::from_utf8_unchecked(text))
+    } else {
+        Message::Binary(data)
+    };
+
+    call_handler(
+        user_data,
+        |handlers| &mut handlers.onmessage,
+        |func| func(message),
+    );
+    1
+}
+
+unsafe extern "C" fn error_trampoline(
+    _event_type: c_int,
+    _event: *const websocket::EmscriptenWebSocketErrorEvent,
+    user_data: *mut c_void,
+) -> c_int {
+    call_handler(user_data, |handlers| &mut handlers.onerror, |func| func());
+    1
+}
+
+unsafe extern "C" fn close_trampoline(
+    _event_type: c_int,
+    event: *const websocket::EmscriptenWebSocketCloseEvent,
+    user_data: *mut c_void,
+) -> c_int {
+    let event = &*event;
+    let close = CloseEvent {
+        was_clean: event.wasClean != 0,
+        code: event.code,
+        reason: CStr::from_ptr(event.reason.as_ptr())
+            .to_string_lossy()
+            .into_owned(),
+    };
+
+    call_handler(
+        user_data,
+        |handlers| &mut handlers.onclose,
+        |func| func(&close),
+    );
+    1
+}
+
+/// A WebSocket connection, whose callbacks are called on the thread that created it.
+///
+/// Dropping it starts a normal closing handshake, with the code 1000, and unregisters its callbacks:
+/// its `onclose` handler isn't called for it. Use [`close`](Self::close) first to send another code or a reason.
+///
+/// # Examples
+/// ```rust
+/// let mut socket = WebSocket::new("wss://example.com/game", &["game-v2"]).unwrap();
+/// socket.on_message(|message| match message {
+///     Message::Binary(packet) => world.apply_snapshot(packet),
+///     Message::Text(text) => println!("Server says: {}", text),
+/// });
+/// socket.on_close(|event| println!("Disconnected: {} {}", event.code, event.reason));
+///
+/// set_main_loop(move || {
+///     if socket.ready_state() == Ok(ReadyState::Open) {
+///         socket.send_binary(&world.input_packet()).unwrap();
+///     }
+/// }, 0, true);
+/// ```
+pub struct WebSocket {
+    handle: websocket::EMSCRIPTEN_WEBSOCKET_T,
+    // Boxed, so that its address, given to emscripten as the callbacks' `userData`, stays the same.
+    handlers: Box<Handlers>,
+    // The messages queued with `queue_binary`, each prefixed with its length, until the next `flush`.
+    outbound: Vec<u8>,
+    high_water_mark: usize,
+    _not_send: PhantomData<*const ()>,
+}
+
+impl WebSocket {
+    /// Opens a WebSocket connection to the given URL, using the emscripten-defined `emscripten_websocket_new`.
+    ///
+    /// # Arguments
+    /// * `url` - The URL to connect to, e.g. `wss://example.com/socket`.
+    /// * `protocols` - The sub-protocols to request, in order of preference; it can be empty.
+    pub fn new(url: &str, protocols: &[&str]) -> Result<Self, Html5Error> {
+        let handle = with_c_str(url, |url| {
+            with_c_str(&protocols.join(","), |joined| {
+                let mut attributes = websocket::EmscriptenWebSocketCreateAttributes {
+                    url,
+                    protocols: if protocols.is_empty() {
+                        std::ptr::null()
+                    } else {
+                        joined
+                    },
+                    createOnMainThread: 0,
+                };
+                unsafe { websocket::emscripten_websocket_new(&mut attributes) }
+            })
+        });
+        if handle <= 0 {
+            // Failures are returned as negative `EMSCRIPTEN_RESULT`s.
+            return Err(Html5Error::check(handle)
+                .err()
+                .unwrap_or(Html5Error::Failed));
+        }
+
+        let mut socket = Self {
+            handle,
+            handlers: Box::default(),
+            outbound: Vec::new(),
+            high_water_mark: DEFAULT_HIGH_WATER_MARK,
+            _not_send: PhantomData,
+        };
+        let user_data = &mut *socket.handlers as *mut Handlers as *mut c_void;
+        unsafe {
+            Html5Error::check(
+                websocket::emscripten_websocket_set_onopen_callback_on_thread(
+                    handle,
+                    user_data,
+                    Some(open_trampoline),
+                    CALLING_THREAD,
+                ),
+            )?;
+            Html5Error::check(
+                websocket::emscripten_websocket_set_onmessage_callback_on_thread(
+                    handle,
+                    user_data,
+                    Some(message_trampoline),
+                    CALLING_THREAD,
+                ),
+            )?;
+            Html5Error::check(
+                websocket::emscripten_websocket_set_onerror_callback_on_thread(
+                    handle,
+                    user_data,
+                    Some(error_trampoline),
+                    CALLING_THREAD,
+                ),
+            )?;
+            Html5Error::check(
+                websocket::emscripten_websocket_set_onclose_callback_on_thread(
+                    handle,
+                    user_data,
+                    Some(close_trampoline),
+                    CALLING_THREAD,
+                ),
+            )?;
+        }
+        Ok(socket)
+    }
+
+    /// Returns the emscripten handle of the socket.
+    pub fn as_raw(&self) -> websocket::EMSCRIPTEN_WEBSOCKET_T {
+        self.handle
+    }
+
+    /// Sets the function called once the connection is open.
+    pub fn on_open<F>(&mut self, onopen: F)
+    where
+        F: 'static + FnMut(),
+    {
+        self.handlers.onopen = Some(Box::new(onopen));
+    }
+
+    /// Sets the function called with each received message.
+    pub fn on_message<F>(&mut self, onmessage: F)
+    where
+        F: 'static + FnMut(Message<'_>),
+    {
+        self.handlers.onmessage = Some(Box::new(onmessage));
+    }
+
+    /// Sets the function called with each received message, with the binary ones copied into buffers of `pool`,
+    /// e.g. to be parsed later, or on another thread. It replaces the function set by [`on_message`](Self::on_message).
+    ///
+    /// # Examples
+    /// ```rust
+    /// let pool = BufferPool::new();
+    /// let (sender, receiver) = std::sync::mpsc::channel();
+    /// socket.on_message_pooled(&pool, move |message| {
+    ///     if let PooledMessage::Binary(packet) = message {
+    ///         // The buffer goes back to the pool once the simulation thread dropped it.
+    ///         sender.send(packet).unwrap();
+    ///     }
+    /// });
+    /// ```
+    pub fn on_message_pooled<F>(&mut self, pool: &BufferPool, mut onmessage: F)
+    where
+        F: 'static + FnMut(PooledMessage<'_>),
+    {
+        let pool = pool.clone();
+        self.on_message(move |message| match message {
+            Message::Text(text) => onmessage(PooledMessage::Text(text)),
+            Message::Binary(data) => onmessage(PooledMessage::Binary(pool.copy_from(data))),
+        });
+    }
+
+    /// Sets the function called when the connection fails.
+    pub fn on_error<F>(&mut self, onerror: F)
+    where
+        F: 'static + FnMut(),
+    {
+        self.handlers.onerror = Some(Box::new(onerror));
+    }
+
+    /// Sets the function called once the connection is closed.
+    pub fn on_close<F>(&mut self, onclose: F)
+    where
+        F: 'static + FnMut(&CloseEvent),
+    {
+        self.handlers.onclose = Some(Box::new(onclose));
+    }
+
+    /// Sends a binary message, read from the given slice, using the emscripten-defined `emscripten_websocket_send_binary`.
+    pub fn send_binary(&self, data: &[u8]) -> Result<(), Html5Error> {
+        Html5Error::check(unsafe {
+            websocket::emscripten_websocket_send_binary(
+                self.handle,
+                data.as_ptr() as *mut c_void,
+                data.len() as u32,
+            )
+        })
+    }
+
+    /// Sends a text message, using the emscripten-defined `emscripten_websocket_send_utf8_text`.
+    pub fn send_text(&self, text: &str) -> Result<(), Html5Error> {
+        with_c_str(text, |text| {
+            Html5Error::check(unsafe {
+                websocket::emscripten_websocket_send_utf8_text(self.handle, text)
+            })
+        })
+    }
+
+    /// Returns the state of the connection.
+    pub fn ready_state(&self) -> Result<ReadyState, Html5Error> {
+        let mut state: c_ushort = 0;
+        Html5Error::check(unsafe {
+            websocket::emscripten_websocket_get_ready_state(self.handle, &mut state)
+        })?;
+        Ok(match state {
+            0 => ReadyState::Connecting,
+            1 => ReadyState::Open,
+            2 => ReadyState::Closing,
+            _ => ReadyState::Closed,
+        })
+    }
+
+    /// Returns the number of bytes queued by the sends, that weren't transmitted to the network yet.
+    pub fn buffered_amount(&self) -> Result<usize, Html5Error> {
+        let mut amount = 0;
+        Html5Error::check(unsafe {
+            websocket::emscripten_websocket_get_buffered_amount(self.handle, &mut amount)
+        })?;
+        Ok(amount)
+    }
+
+    /// Returns the URL the socket is connected to.
+    pub fn url(&self) -> Result<String, Html5Error> {
+        self.get_string(
+            websocket::emscripten_websocket_get_url_length,
+            websocket::emscripten_websocket_get_url,
+        )
+    }
+
+    /// Returns the sub-protocol the server chose, or an empty string.
+    pub fn protocol(&self) -> Result<String, Html5Error> {
+        self.get_string(
+            websocket::emscripten_websocket_get_protocol_length,
+            websocket::emscripten_websocket_get_protocol,
+        )
+    }
+
+    fn get_string(
+        &self,
+        get_length: unsafe extern "C" fn(c_int, *mut c_int) -> c_int,
+        get: unsafe extern "C" fn(c_int, *mut std::os::raw::c_char, c_int) -> c_int,
+    ) -> Result<String, Html5Error> {
+        let mut length = 0;
+        Html5Error::check(unsafe { get_length(self.handle, &mut length) })?;
+        let mut buffer = vec![0u8; length.max(1) as usize];
+        Html5Error::check(unsafe { get(self.handle, buffer.as_mut_ptr() as *mut _, length) })?;
+        Ok(CStr::from_bytes_until_nul(&buffer)
+            .map(|string| string.to_string_lossy().into_owned())
+            .unwrap_or_default())
+    }
+
+    /// Queues a binary message in the socket's batch, sent as a single WebSocket message by the next [`flush`](WebSocket::flush).
+    ///
+    /// Each message is prefixed in the batch with its length, as a little-endian `u32`; the receiving side splits them back with [`split_batch`].
+    /// A full batch, bigger than [`MAX_BATCH_SIZE`], is flushed before queuing more.
+    ///
+    /// The message is refused with [`QueueError::Backpressure`] if the bytes the browser didn't transmit yet
+    /// and the batch, with the message, would go over the high water mark.
+    ///
+    /// # Examples
+    /// ```rust
+    /// set_main_loop(move || {
+    ///     for entity in world.changed_entities() {
+    ///         if socket.queue_binary(&entity.state_packet()).is_err() {
+    ///             // The connection is too slow: the next frames send the newest state.
+    ///             break;
+    ///         }
+    ///     }
+    ///     socket.flush().unwrap();
+    /// }, 0, true);
+    /// ```
+    pub fn queue_binary(&mut self, data: &[u8]) -> Result<(), QueueError> {
+        let size = 4 + data.len();
+        let buffered = self.buffered_amount().map_err(QueueError::Send)?;
+        if buffered + self.outbound.len() + size > self.high_water_mark {
+            return Err(QueueError::Backpressure);
+        }
+        if !self.outbound.is_empty() && self.outbound.len() + size > MAX_BATCH_SIZE {
+            self.flush().map_err(QueueError::Send)?;
+        }
+
+        self.outbound
+            .extend_from_slice(&(data.len() as u32).to_le_bytes());
+        self.outbound.extend_from_slice(data);
+        Ok(())
+    }
+
+    /// Sends the messages queued with [`queue_binary`](WebSocket::queue_binary) as a single binary message, if there are any.
+    /// It's meant to be called once per frame.
+    pub fn flush(&mut self) -> Result<(), Html5Error> {
+        if self.outbound.is_empty() {
+            return Ok(());
+        }
+        let result = self.send_binary(&self.outbound);
+        // The batch's memory is kept for the next frames.
+        self.outbound.clear();
+        result
+    }
+
+    /// Returns the number of bytes queued in the batch.
+    pub fn queued_len(&self) -> usize {
+        self.outbound.len()
+    }
+
+    /// Sets the number of bytes the browser and the batch can hold before [`queue_binary`](WebSocket::queue_binary) refuses messages.
+    pub fn set_high_water_mark(&mut self, bytes: usize) {
+        self.high_water_mark = bytes;
+    }
+
+    /// Returns `true` if the bytes the browser didn't transmit yet and the batch reached the high water mark.
+    pub fn is_backpressured(&self) -> bool {
+        self.buffered_amount().unwrap_or(0) + self.outbound.len() >= self.high_water_mark
+    }
+
+    /// Starts the closing handshake, using the emscripten-defined `emscripten_websocket_close`.
+    ///
+    /// # Arguments
+    /// * `code` - The close code, 1000 for a normal closure, or between 3000 and 4999.
+    /// * `reason` - The close reason, at most 123 bytes long.
+    pub fn close(&self, code: u16, reason: &str) -> Result<(), Html5Error> {
+        with_c_str(reason, |reason| {
+            Html5Error::check(unsafe {
+                websocket::emscripten_websocket_close(self.handle, code, reason)
+            })
+        })
+    }
+}
+
+impl Drop for WebSocket {
+    fn drop(&mut self) {
+        unsafe {
+            // Deleting the socket alone would leave the browser's connection open.
+            websocket::emscripten_websocket_close(self.handle, 1000, c"".as_ptr());
+            websocket::emscripten_websocket_delete(self.handle);
+        }
+    }
+}
+
+/// Splits a batch sent with [`WebSocket::queue_binary`] back into its messages.
+/// The iteration stops at the first truncated message.
+///
+/// # Examples
+/// ```rust
+/// socket.on_message(|message| {
+///     if let Message::Binary(batch) = message {
+///         for packet in split_batch(batch) {
+///             world.apply(packet);
+///         }
+///     }
+/// });
+/// ```
+pub fn split_batch(mut batch: &[u8]) -> impl Iterator<Item = &[u8]> {
+    std::iter::from_fn(move || {
+        let (length, rest) = batch.split_first_chunk::<4>()?;
+        let length = u32::from_le_bytes(*length) as usize;
+        if rest.len() < length {
+            return None;
+        }
+        let (message, rest) = rest.split_at(length);
+        batch = rest;
+        Some(message)
+    })
+}
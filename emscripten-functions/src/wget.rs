@@ -0,0 +1,577 @@
+//! Asynchronous HTTP downloads into memory, with closure-based handlers, using the emscripten-defined [`emscripten_async_wget2_data`].
+//!
+//! Concurrent [`get_shared`] calls for the same URL share a single download, whose data every caller gets through an [`Rc`].
+//!
+//! A download given a [`FetchPriority`] other than `Auto` goes through the browser's `fetch()` instead, with its `priority` hint,
+//! so that e.g. speculative prefetches don't take the bandwidth of the assets needed right away.
+//!
+//! [`emscripten_async_wget2_data`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_async_wget2_data
+
+use std::{
+    cell::{Cell, RefCell},
+    collections::HashMap,
+    ffi::CStr,
+    fmt::Display,
+    os::raw::{c_char, c_int, c_uint, c_void},
+    rc::Rc,
+};
+
+use emscripten_functions_sys::emscripten::{
+    self, em_async_wget2_data_onerror_func, em_async_wget2_data_onload_func,
+    em_async_wget2_data_onprogress_func,
+};
+
+use crate::{
+    c_str::with_c_str,
+    emscripten::{has_asyncify, AsyncifyUnavailable},
+    malloc_buffer::MallocBuffer,
+};
+
+extern "C" {
+    fn wget_priority_send(
+        url: *const c_char,
+        method: *const c_char,
+        param: *const c_char,
+        priority: c_int,
+        onload: em_async_wget2_data_onload_func,
+        onerror: em_async_wget2_data_onerror_func,
+        onprogress: em_async_wget2_data_onprogress_func,
+    ) -> c_int;
+    fn wget_priority_abort(handle: c_int);
+}
+
+/// The priority hint of a download, relative to the page's other downloads, as with the [`priority`] option of `fetch()`.
+///
+/// Browsers without priority hints ignore them.
+///
+/// [`priority`]: https://developer.mozilla.org/en-US/docs/Web/API/RequestInit#priority
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq, Hash)]
+pub enum FetchPriority {
+    /// The browser's default priority. The download goes through `emscripten_async_wget2_data`.
+    #[default]
+    Auto,
+    /// A download needed right away, e.g. for the next frame.
+    High,
+    /// A speculative download, e.g. a prefetch.
+    Low,
+}
+
+/// The error given to the error handler of a download.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct WgetError {
+    /// The HTTP status code of the response.
+    pub status: c_int,
+    /// The HTTP status text of the response.
+    pub status_text: String,
+}
+impl Display for WgetError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        write!(f, "Download failed: {} {}", self.status, self.status_text)
+    }
+}
+
+type OnLoad = Box<dyn FnOnce(MallocBuffer)>;
+type OnError = Box<dyn FnOnce(WgetError)>;
+type OnProgress = Box<dyn FnMut(c_int, c_int)>;
+
+struct Handlers {
+    onload: Option<OnLoad>,
+    onerror: Option<OnError>,
+    onprogress: Option<OnProgress>,
+}
+
+// The handlers of the calling thread's pending downloads, keyed by their emscripten request handle.
+// Emscripten gives back the handle to the callbacks, so no pointer needs to be passed around.
+thread_local! {
+    static PENDING_REQUESTS: RefCell<HashMap<c_int, Handlers>> = RefCell::new(HashMap::new());
+}
+
+/// A description of an asynchronous download, built with chained method calls and started with [`WgetRequest::send`].
+///
+/// # Examples
+/// ```rust
+/// let handle = WgetRequest::new("assets/level1.bin")
+///     .on_progress(|loaded, total| {
+///         println!("{}/{} bytes", loaded, total);
+///     })
+///     .on_load(|data| {
+///         println!("Got {} bytes", data.len());
+///     })
+///     .on_error(|err| {
+///         println!("{}", err);
+///     })
+///     .send();
+///
+/// // Changed our mind.
+/// handle.abort();
+/// ```
+pub struct WgetRequest {
+    url: String,
+    method: String,
+    param: String,
+    priority: FetchPriority,
+    handlers: Handlers,
+}
+
+impl WgetRequest {
+    /// Creates a `GET` request for the given URL, with no handlers.
+    pub fn new<T>(url: T) -> Self
+    where
+        T: Into<String>,
+    {
+        Self {
+            url: url.into(),
+            method: "GET".to_string(),
+            param: String::new(),
+            priority: FetchPriority::Auto,
+            handlers: Handlers {
+                onload: None,
+                onerror: None,
+                onprogress: None,
+            },
+        }
+    }
+
+    /// Sets the HTTP method, e.g. `"POST"`.
+    pub fn method<T>(mut self, method: T) -> Self
+    where
+        T: Into<String>,
+    {
+        self.method = method.into();
+        self
+    }
+
+    /// Sets the request parameters, sent as the request body for `POST` requests.
+    pub fn param<T>(mut self, param: T) -> Self
+    where
+        T: Into<String>,
+    {
+        self.param = param.into();
+        self
+    }
+
+    /// Sets the priority hint of the download, [`FetchPriority::Auto`] by default.
+    pub fn priority(mut self, priority: FetchPriority) -> Self {
+        self.priority = priority;
+        self
+    }
+
+    /// Sets the function called with the downloaded data, when the download succeeds.
+    ///
+    /// The data is given in the buffer emscripten allocated for it, without a copy.
+    pub fn on_load<F>(mut self, onload: F) -> Self
+    where
+        F: 'static + FnOnce(MallocBuffer),
+    {
+        self.handlers.onload = Some(Box::new(onload));
+        self
+    }
+
+    /// Sets the function called when the download fails.
+    pub fn on_error<F>(mut self, onerror: F) -> Self
+    where
+        F: 'static + FnOnce(WgetError),
+    {
+        self.handlers.onerror = Some(Box::new(onerror));
+        self
+    }
+
+    /// Sets the function called during the download with the number of bytes loaded so far and the total number of bytes (0 if unknown).
+    pub fn on_progress<F>(mut self, onprogress: F) -> Self
+    where
+        F: 'static + FnMut(c_int, c_int),
+    {
+        self.handlers.onprogress = Some(Box::new(onprogress));
+        self
+    }
+
+    /// Starts the download, returning a handle that can abort it.
+    pub fn send(self) -> WgetHandle {
+        let handle = with_c_str(&self.url, |url| {
+            with_c_str(&self.method, |method| {
+                with_c_str(&self.param, |param| unsafe {
+                    match self.priority {
+                        FetchPriority::Auto => emscripten::emscripten_async_wget2_data(
+                            url,
+                            method,
+                            param,
+                            std::ptr::null_mut(),
+                            // We take the ownership of the downloaded data.
+                            0,
+                            Some(onload),
+                            Some(onerror),
+                            Some(onprogress),
+                        ),
+                        priority => wget_priority_send(
+                            url,
+                            method,
+                            param,
+                            priority as c_int,
+                            Some(onload),
+                            Some(onerror),
+                            Some(onprogress),
+                        ),
+                    }
+                })
+            })
+        });
+
+        // The callbacks are called at the earliest after we yield to the JS event loop, so it's fine to register the handlers now.
+        PENDING_REQUESTS.with(|requests| requests.borrow_mut().insert(handle, self.handlers));
+
+        WgetHandle { handle }
+    }
+}
+
+/// Starts downloading the given URL with a `GET` request.
+///
+/// For more options (HTTP method, progress handler), check out [`WgetRequest`].
+///
+/// # Arguments
+/// * `url` - The URL to download.
+/// * `onload` - The function called with the downloaded data.
+/// * `onerror` - The function called if the download fails.
+///
+/// # Examples
+/// ```rust
+/// get(
+///     "config.json",
+///     |data| println!("{}", String::from_utf8_lossy(&data)),
+///     |err| println!("{}", err),
+/// );
+/// ```
+pub fn get<T, L, E>(url: T, onload: L, onerror: E) -> WgetHandle
+where
+    T: Into<String>,
+    L: 'static + FnOnce(MallocBuffer),
+    E: 'static + FnOnce(WgetError),
+{
+    WgetRequest::new(url)
+        .on_load(onload)
+        .on_error(onerror)
+        .send()
+}
+
+type OnSharedLoad = Box<dyn FnOnce(Rc<MallocBuffer>)>;
+
+struct SharedWaiter {
+    id: u64,
+    onload: OnSharedLoad,
+    onerror: OnError,
+}
+
+struct SharedDownload {
+    handle: WgetHandle,
+    waiters: Vec<SharedWaiter>,
+}
+
+// The calling thread's downloads started by `get_shared`, keyed by their URL, with the callers waiting for them.
+thread_local! {
+    static SHARED_DOWNLOADS: RefCell<HashMap<String, SharedDownload>> = RefCell::new(HashMap::new());
+    static NEXT_WAITER_ID: Cell<u64> = const { Cell::new(0) };
+}
+
+/// Like [`get`], but joins the download of the URL already in flight, if another `get_shared` call started one:
+/// the data is downloaded once, and every caller gets it in a shared, reference-counted buffer.
+///
+/// The URL is only deduplicated while its download is in flight: nothing is cached, and a call after the download finished starts a new one,
+/// e.g. from the handlers themselves.
+///
+/// # Arguments
+/// * `url` - The URL to download.
+/// * `onload` - The function called with the downloaded data.
+/// * `onerror` - The function called if the download fails.
+///
+/// # Examples
+/// ```rust
+/// // The atlas is downloaded once, for both the renderer and the UI.
+/// get_shared("atlas.png", |data| renderer.load_atlas(&data), |err| println!("{}", err));
+/// get_shared("atlas.png", |data| ui.load_atlas(&data), |err| println!("{}", err));
+/// ```
+pub fn get_shared<T, L, E>(url: T, onload: L, onerror: E) -> SharedWgetHandle
+where
+    T: Into<String>,
+    L: 'static + FnOnce(Rc<MallocBuffer>),
+    E: 'static + FnOnce(WgetError),
+{
+    let url = url.into();
+    let id = NEXT_WAITER_ID.with(|next| {
+        let id = next.get();
+        next.set(id + 1);
+        id
+    });
+    let waiter = SharedWaiter {
+        id,
+        onload: Box::new(onload),
+        onerror: Box::new(onerror),
+    };
+
+    let waiter = SHARED_DOWNLOADS.with(|downloads| match downloads.borrow_mut().get_mut(&url) {
+        Some(download) => {
+            download.waiters.push(waiter);
+            None
+        }
+        None => Some(waiter),
+    });
+    if let Some(waiter) = waiter {
+        let load_url = url.clone();
+        let error_url = url.clone();
+        let handle = get(
+            url.clone(),
+            move |data| finish_shared(&load_url, Ok(Rc::new(data))),
+            move |err| finish_shared(&error_url, Err(err)),
+        );
+        SHARED_DOWNLOADS.with(|downloads| {
+            downloads.borrow_mut().insert(
+                url.clone(),
+                SharedDownload {
+                    handle,
+                    waiters: vec![waiter],
+                },
+            )
+        });
+    }
+
+    SharedWgetHandle { url, id }
+}
+
+fn finish_shared(url: &str, result: Result<Rc<MallocBuffer>, WgetError>) {
+    // The download is removed before calling the handlers, so that they can start a new one for the same URL.
+    let Some(download) = SHARED_DOWNLOADS.with(|downloads| downloads.borrow_mut().remove(url))
+    else {
+        return;
+    };
+    for waiter in download.waiters {
+        match &result {
+            Ok(data) => (waiter.onload)(data.clone()),
+            Err(err) => (waiter.onerror)(err.clone()),
+        }
+    }
+}
+
+/// The handle of a caller waiting for a download started by [`get_shared`].
+#[derive(Debug, Clone, PartialEq, Eq, Hash)]
+pub struct SharedWgetHandle {
+    url: String,
+    id: u64,
+}
+
+impl SharedWgetHandle {
+    /// Returns `true` if the caller's handlers haven't been called nor cancelled yet.
+    pub fn is_pending(&self) -> bool {
+        SHARED_DOWNLOADS.with(|downloads| {
+            downloads
+                .borrow()
+                .get(&self.url)
+                .is_some_and(|download| download.waiters.iter().any(|waiter| waiter.id == self.id))
+        })
+    }
+
+    /// Removes the caller's handlers, which won't be called anymore.
+    /// The download is aborted if no other caller waits for it.
+    pub fn cancel(&self) {
+        let aborted = SHARED_DOWNLOADS.with(|downloads| {
+            let mut downloads = downloads.borrow_mut();
+            let download = downloads.get_mut(&self.url)?;
+            download.waiters.retain(|waiter| waiter.id != self.id);
+            if !download.waiters.is_empty() {
+                return None;
+            }
+            downloads.remove(&self.url).map(|download| download.handle)
+        });
+
+        if let Some(handle) = aborted {
+            handle.abort();
+        }
+    }
+}
+
+/// The error returned by the blocking downloads.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum BlockingWgetError {
+    /// The program wasn't built with Asyncify, which the blocking downloads need.
+    AsyncifyUnavailable,
+    /// The download failed.
+    Failed,
+}
+impl Display for BlockingWgetError {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        match self {
+            BlockingWgetError::AsyncifyUnavailable => AsyncifyUnavailable.fmt(f),
+            BlockingWgetError::Failed => write!(f, "Download failed"),
+        }
+    }
+}
+
+/// Downloads the given URL into memory, blocking until it's done, using the emscripten-defined [`emscripten_wget_data`].
+/// The browser keeps running its event loop meanwhile, as the stack is unwound with Asyncify.
+///
+/// Without Asyncify it returns an error right away; [`get_blocking_or_async`] falls back to a download with callbacks instead.
+///
+/// [`emscripten_wget_data`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_wget_data
+///
+/// # Examples
+/// ```rust
+/// let config = get_blocking("config.json").unwrap();
+/// let config = String::from_utf8_lossy(&config);
+/// ```
+pub fn get_blocking(url: &str) -> Result<MallocBuffer, BlockingWgetError> {
+    if !has_asyncify() {
+        return Err(BlockingWgetError::AsyncifyUnavailable);
+    }
+
+    let mut buffer: *mut c_void = std::ptr::null_mut();
+    let mut size: c_int = 0;
+    let mut error: c_int = 0;
+    with_c_str(url, |url| unsafe {
+        emscripten::emscripten_wget_data(url, &mut buffer, &mut size, &mut error)
+    });
+
+    if error != 0 {
+        return Err(BlockingWgetError::Failed);
+    }
+    Ok(unsafe { MallocBuffer::from_raw(buffer as *mut u8, size as usize) })
+}
+
+/// Downloads the given URL into the file at `path` of the emscripten file system, blocking until it's done, using the emscripten-defined [`emscripten_wget`].
+///
+/// Without Asyncify it returns an error right away.
+///
+/// [`emscripten_wget`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_wget
+pub fn download_blocking(url: &str, path: &str) -> Result<(), BlockingWgetError> {
+    if !has_asyncify() {
+        return Err(BlockingWgetError::AsyncifyUnavailable);
+    }
+
+    let result = with_c_str(url, |url| {
+        with_c_str(path, |path| unsafe {
+            emscripten::emscripten_wget(url, path)
+        })
+    });
+    if result != 0 {
+        return Err(BlockingWgetError::Failed);
+    }
+    Ok(())
+}
+
+/// Downloads the given URL into memory with [`get_blocking`] when the program was built with Asyncify, calling the handlers before returning;
+/// otherwise starts downloading it with [`get`], and returns its handle.
+///
+/// This way loading code written in a blocking style works in both kinds of builds, without paying for Asyncify in the ones that don't need it.
+/// A failed blocking download gives the error handler a status of 0, as its HTTP status isn't known.
+///
+/// # Examples
+/// ```rust
+/// get_blocking_or_async(
+///     "level1.bin",
+///     |data| load_level(&data),
+///     |err| println!("{}", err),
+/// );
+/// ```
+pub fn get_blocking_or_async<L, E>(url: &str, onload: L, onerror: E) -> Option<WgetHandle>
+where
+    L: 'static + FnOnce(MallocBuffer),
+    E: 'static + FnOnce(WgetError),
+{
+    match get_blocking(url) {
+        Ok(data) => {
+            onload(data);
+            None
+        }
+        Err(BlockingWgetError::Failed) => {
+            onerror(WgetError {
+                status: 0,
+                status_text: String::new(),
+            });
+            None
+        }
+        Err(BlockingWgetError::AsyncifyUnavailable) => Some(get(url, onload, onerror)),
+    }
+}
+
+/// The handle of a started download.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct WgetHandle {
+    handle: c_int,
+}
+
+impl WgetHandle {
+    /// Returns the emscripten request handle, or a negative one for a download with a priority hint, which emscripten doesn't know.
+    pub fn raw(&self) -> c_int {
+        self.handle
+    }
+
+    /// Returns `true` if the download hasn't finished nor been aborted yet.
+    pub fn is_pending(&self) -> bool {
+        PENDING_REQUESTS.with(|requests| requests.borrow().contains_key(&self.handle))
+    }
+
+    /// Aborts the download, using the emscripten-defined [`emscripten_async_wget2_abort`], or the `AbortController` of a download
+    /// with a priority hint. None of its handlers will be called anymore.
+    ///
+    /// It does nothing if the download already finished.
+    ///
+    /// [`emscripten_async_wget2_abort`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_async_wget2_abort
+    pub fn abort(&self) {
+        let handlers = PENDING_REQUESTS.with(|requests| requests.borrow_mut().remove(&self.handle));
+
+        if handlers.is_some() {
+            if self.handle < 0 {
+                unsafe { wget_priority_abort(self.handle) }
+            } else {
+                unsafe { emscripten::emscripten_async_wget2_abort(self.handle) }
+            }
+        }
+    }
+}
+
+fn take_handlers(handle: c_uint) -> Option<Handlers> {
+    PENDING_REQUESTS.with(|requests| requests.borrow_mut().remove(&(handle as c_int)))
+}
+
+unsafe extern "C" fn onload(handle: c_uint, _arg: *mut c_void, data: *mut c_void, size: c_uint) {
+    let data = MallocBuffer::from_raw(data as *mut u8, size as usize);
+
+    if let Some(onload) = take_handlers(handle).and_then(|handlers| handlers.onload) {
+        onload(data);
+    }
+}
+
+unsafe extern "C" fn onerror(
+    handle: c_uint,
+    _arg: *mut c_void,
+    status: c_int,
+    status_text: *const c_char,
+) {
+    if let Some(onerror) = take_handlers(handle).and_then(|handlers| handlers.onerror) {
+        let status_text = if status_text.is_null() {
+            String::new()
+        } else {
+            CStr::from_ptr(status_text).to_string_lossy().into_owned()
+        };
+        onerror(WgetError {
+            status,
+            status_text,
+        });
+    }
+}
+
+unsafe extern "C" fn onprogress(handle: c_uint, _arg: *mut c_void, loaded: c_int, total: c_int) {
+    // The handler is taken out during the call, so that it can start other downloads.
+    let onprogress = PENDING_REQUESTS.with(|requests| {
+        requests
+            .borrow_mut()
+            .get_mut(&(handle as c_int))
+            .and_then(|handlers| handlers.onprogress.take())
+    });
+
+    if let Some(mut onprogress) = onprogress {
+        onprogress(loaded, total);
+
+        PENDING_REQUESTS.with(|requests| {
+            if let Some(handlers) = requests.borrow_mut().get_mut(&(handle as c_int)) {
+                handlers.onprogress = Some(onprogress);
+            }
+        });
+    }
+}
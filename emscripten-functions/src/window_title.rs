@@ -0,0 +1,117 @@
+//! A window title manager, that caches the title on the rust side and coalesces its updates.
+//!
+//! Programs showing live progress or a frame rate in the title set it every frame, and each write to `document.title`
+//! makes the browser update its UI. [`set_title`] instead skips the writes that don't change the title, and writes
+//! at most once per [`set_title_interval`] milliseconds: the last title set in an interval is written at its end.
+//! [`title`] reads the cached title, without copying it from JS.
+
+use std::cell::{Cell, RefCell};
+
+use emscripten_functions_sys::emscripten;
+
+use crate::{c_str::with_c_str, emscripten::get_now, timers::set_timeout};
+
+/// The default shortest time between two title writes, in milliseconds.
+pub const DEFAULT_TITLE_INTERVAL: f64 = 250.0;
+
+#[derive(Default)]
+struct TitleState {
+    // The title last set, and whether it differs from the one last written.
+    title: String,
+    dirty: bool,
+    // The time of the last write, and whether the write at the end of the interval is scheduled.
+    last_write: Option<f64>,
+    scheduled: bool,
+    // The manager starts from the document's title on the first use.
+    loaded: bool,
+}
+
+thread_local! {
+    static TITLE: RefCell<TitleState> = RefCell::new(TitleState::default());
+    static INTERVAL: Cell<f64> = const { Cell::new(DEFAULT_TITLE_INTERVAL) };
+}
+
+fn with_state<F, R>(func: F) -> R
+where
+    F: FnOnce(&mut TitleState) -> R,
+{
+    TITLE.with(|state| {
+        let mut state = state.borrow_mut();
+        if !state.loaded {
+            state.loaded = true;
+            state.title = crate::emscripten::get_window_title();
+        }
+        func(&mut state)
+    })
+}
+
+// Writes the title if it changed since the last write.
+fn write(state: &mut TitleState) {
+    if state.dirty {
+        state.dirty = false;
+        state.last_write = Some(get_now());
+        with_c_str(&state.title, |title| unsafe {
+            emscripten::emscripten_set_window_title(title)
+        });
+    }
+}
+
+/// Sets the window title: at once if no title was written in the last [`set_title_interval`] milliseconds,
+/// or at the end of the interval otherwise. A title equal to the current one isn't written, and the cached string is reused.
+///
+/// # Examples
+/// ```rust
+/// set_main_loop(|| {
+///     // ...
+///     set_title(format!("My Game - {:.0} fps", fps_counter.fps()));
+/// }, 0, true);
+/// ```
+pub fn set_title<T>(title: T)
+where
+    T: AsRef<str>,
+{
+    let title = title.as_ref();
+    with_state(|state| {
+        if state.title == title {
+            return;
+        }
+        state.title.clear();
+        state.title.push_str(title);
+        state.dirty = true;
+
+        let interval = INTERVAL.with(Cell::get);
+        let wait = state
+            .last_write
+            .map_or(0.0, |last_write| last_write + interval - get_now());
+        if wait <= 0.0 {
+            write(state);
+        } else if !state.scheduled {
+            state.scheduled = true;
+            set_timeout(
+                || {
+                    with_state(|state| {
+                        state.scheduled = false;
+                        write(state);
+                    })
+                },
+                wait,
+            );
+        }
+    });
+}
+
+/// Returns the window title last set with [`set_title`], or the document's title before that.
+/// It may not be written to the document yet.
+pub fn title() -> String {
+    with_state(|state| state.title.clone())
+}
+
+/// Sets the shortest time between two title writes, in milliseconds; 0 writes each change at once.
+pub fn set_title_interval(interval: f64) {
+    INTERVAL.with(|value| value.set(interval.max(0.0)));
+}
+
+/// Writes the title last set now, if it isn't written yet, without waiting for the end of the interval.
+pub fn flush_title() {
+    with_state(write);
+}
@@ -0,0 +1,258 @@
+//! A pool of emscripten [worker API] workers, and the functions the workers use to respond.
+//!
+//! These workers are separate programs built with `-sBUILD_AS_WORKER`, that exchange byte buffers with the main program by message passing.
+//! Unlike pthreads, they don't need `SharedArrayBuffer`, so they work on hosts that don't send the COOP/COEP headers.
+//! Each message copies its buffer out of the sender's memory and into the receiver's: where `SharedArrayBuffer` is available,
+//! the [`WasmWorkerPool`](crate::wasm_worker_pool::WasmWorkerPool) runs jobs on large buffers without copying them.
+//! Messages declared with [`flat_message!`](crate::flat_message) make cheap payloads: they're read in place from the received buffer.
+//!
+//! [worker API]: https://emscripten.org/docs/api_reference/emscripten.h.html#worker-api
+
+use std::{
+    cell::Cell,
+    os::raw::{c_char, c_int, c_void},
+    rc::Rc,
+    slice,
+};
+
+use emscripten_functions_sys::emscripten;
+
+use crate::{c_str::with_c_str, emscripten::KeepAlive};
+
+struct PoolState {
+    workers: Vec<emscripten::worker_handle>,
+    // The number of our jobs awaiting their final response, per worker.
+    outstanding: Vec<Cell<c_int>>,
+}
+
+impl Drop for PoolState {
+    fn drop(&mut self) {
+        for worker in &self.workers {
+            unsafe {
+                emscripten::emscripten_destroy_worker(*worker);
+            }
+        }
+    }
+}
+
+type OnResult = Box<dyn FnOnce(&[u8])>;
+type OnPartial = Box<dyn FnMut(&[u8])>;
+
+struct Job {
+    pool: Rc<PoolState>,
+    worker: usize,
+    onpartial: Option<OnPartial>,
+    onresult: OnResult,
+    _keepalive: KeepAlive,
+}
+
+/// A pool of workers running the same worker program, that dispatches each job to the least loaded worker.
+///
+/// The pool's workers are destroyed once the pool is dropped and all its jobs are done.
+///
+/// # Examples
+/// The worker program, built with `-sBUILD_AS_WORKER -sEXPORTED_FUNCTIONS=_decode`:
+/// ```rust
+/// #[no_mangle]
+/// pub extern "C" fn decode(data: *mut c_char, size: c_int) {
+///     let input = unsafe { std::slice::from_raw_parts(data as *const u8, size as usize) };
+///     let output = decode_image(input);
+///     respond(&output);
+/// }
+/// ```
+///
+/// The main program:
+/// ```rust
+/// let pool = WorkerPool::new("decoder.js", 4);
+/// pool.call("decode", &png_bytes, |pixels| {
+///     println!("Decoded {} bytes of pixels", pixels.len());
+/// });
+/// ```
+pub struct WorkerPool {
+    state: Rc<PoolState>,
+}
+
+impl WorkerPool {
+    /// Starts `count` workers running the worker program at the given URL.
+    pub fn new(url: &str, count: usize) -> Self {
+        assert!(count > 0, "the pool must have at least 1 worker");
+
+        let workers = with_c_str(url, |url| {
+            (0..count)
+                .map(|_| unsafe { emscripten::emscripten_create_worker(url) })
+                .collect()
+        });
+
+        Self {
+            state: Rc::new(PoolState {
+                workers,
+                outstanding: (0..count).map(|_| Cell::new(0)).collect(),
+            }),
+        }
+    }
+
+    /// Returns the number of workers in the pool.
+    pub fn worker_count(&self) -> usize {
+        self.state.workers.len()
+    }
+
+    /// Returns the number of the pool's jobs that haven't finished yet.
+    pub fn pending_jobs(&self) -> usize {
+        self.state
+            .outstanding
+            .iter()
+            .map(|count| count.get() as usize)
+            .sum()
+    }
+
+    /// Calls the given function of the least loaded worker with a copy of `data`, using the emscripten-defined [`emscripten_call_worker`].
+    ///
+    /// The least loaded worker is the one with the fewest calls waiting for a response, as given by [`emscripten_get_worker_queue_size`].
+    ///
+    /// [`emscripten_call_worker`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_call_worker
+    /// [`emscripten_get_worker_queue_size`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_get_worker_queue_size
+    ///
+    /// # Arguments
+    /// * `funcname` - The name of the worker's function, exported by the worker program.
+    /// * `data` - The data the function is called with.
+    /// * `onresult` - The function called with the worker's final response, sent with [`respond`].
+    pub fn call<F>(&self, funcname: &str, data: &[u8], onresult: F)
+    where
+        F: 'static + FnOnce(&[u8]),
+    {
+        self.dispatch(funcname, data, None, Box::new(onresult));
+    }
+
+    /// Calls the given function of the least loaded worker like [`WorkerPool::call`],
+    /// also receiving the partial results the worker sends with [`respond_provisionally`] before its final response.
+    ///
+    /// # Arguments
+    /// * `funcname` - The name of the worker's function, exported by the worker program.
+    /// * `data` - The data the function is called with.
+    /// * `onpartial` - The function called with each partial result, in the order they were sent.
+    /// * `onresult` - The function called with the worker's final response, sent with [`respond`].
+    ///
+    /// # Examples
+    /// ```rust
+    /// pool.call_streaming(
+    ///     "decode_mesh",
+    ///     &mesh_bytes,
+    ///     |lod| upload_lod(lod),
+    ///     |_| println!("All LODs decoded"),
+    /// );
+    /// ```
+    pub fn call_streaming<P, F>(&self, funcname: &str, data: &[u8], onpartial: P, onresult: F)
+    where
+        P: 'static + FnMut(&[u8]),
+        F: 'static + FnOnce(&[u8]),
+    {
+        self.dispatch(
+            funcname,
+            data,
+            Some(Box::new(onpartial)),
+            Box::new(onresult),
+        );
+    }
+
+    fn dispatch(
+        &self,
+        funcname: &str,
+        data: &[u8],
+        onpartial: Option<OnPartial>,
+        onresult: OnResult,
+    ) {
+        let worker = (0..self.state.workers.len())
+            .min_by_key(|&index| unsafe {
+                emscripten::emscripten_get_worker_queue_size(self.state.workers[index])
+            })
+            .unwrap();
+
+        let job = Box::new(Job {
+            pool: self.state.clone(),
+            worker,
+            onpartial,
+            onresult,
+            _keepalive: KeepAlive::new(),
+        });
+        self.state.outstanding[worker].set(self.state.outstanding[worker].get() + 1);
+
+        with_c_str(funcname, |funcname| unsafe {
+            // The data is copied into the message sent to the worker.
+            emscripten::emscripten_call_worker(
+                self.state.workers[worker],
+                funcname,
+                data.as_ptr() as *mut c_char,
+                data.len() as c_int,
+                Some(onresponse),
+                Box::into_raw(job) as *mut c_void,
+            );
+        });
+    }
+}
+
+unsafe extern "C" fn onresponse(data: *mut c_char, size: c_int, arg: *mut c_void) {
+    let job = arg as *mut Job;
+    let pool = &(*job).pool;
+    let worker = (*job).worker;
+
+    // Emscripten counts a call out of the worker's queue right before its final response's callback,
+    // so a final response is the one after which emscripten's count is below ours.
+    let queue_size = emscripten::emscripten_get_worker_queue_size(pool.workers[worker]);
+    let is_final = queue_size < pool.outstanding[worker].get();
+
+    // Emscripten frees the data once this function returns.
+    let data = if data.is_null() {
+        &[]
+    } else {
+        slice::from_raw_parts(data as *const u8, size as usize)
+    };
+
+    if !is_final {
+        if let Some(onpartial) = &mut (*job).onpartial {
+            onpartial(data);
+        }
+        return;
+    }
+    pool.outstanding[worker].set(pool.outstanding[worker].get() - 1);
+
+    let job = Box::from_raw(job);
+    (job.onresult)(data);
+}
+
+/// Sends the final response of the current call to the main program, using the emscripten-defined [`emscripten_worker_respond`].
+///
+/// It must be called from a worker function, at most once per call.
+///
+/// [`emscripten_worker_respond`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_worker_respond
+pub fn respond(data: &[u8]) {
+    unsafe {
+        emscripten::emscripten_worker_respond(data.as_ptr() as *mut c_char, data.len() as c_int);
+    }
+}
+
+/// Sends a partial result of the current call to the main program, using the emscripten-defined [`emscripten_worker_respond_provisionally`].
+///
+/// It can be called any number of times from a worker function, before [`respond`].
+/// The partial results are given to the `onpartial` function of [`WorkerPool::call_streaming`].
+///
+/// [`emscripten_worker_respond_provisionally`]: https://emscripten.org/docs/api_reference/emscripten.h.html#c.emscripten_worker_respond_provisionally
+///
+/// # Examples
+/// ```rust
+/// #[no_mangle]
+/// pub extern "C" fn decode_mesh(data: *mut c_char, size: c_int) {
+///     let input = unsafe { std::slice::from_raw_parts(data as *const u8, size as usize) };
+///     for lod in decode_lods(input) {
+///         respond_provisionally(&lod);
+///     }
+///     respond(&[]);
+/// }
+/// ```
+pub fn respond_provisionally(data: &[u8]) {
+    unsafe {
+        emscripten::emscripten_worker_respond_provisionally(
+            data.as_ptr() as *mut c_char,
+            data.len() as c_int,
+        );
+    }
+}
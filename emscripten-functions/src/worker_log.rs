@@ -0,0 +1,173 @@
+//! A log sink for pthreads that doesn't block them: the messages are queued in shared memory, and printed by the main browser thread.
+//!
+//! Printing from a pthread proxies the call to the main browser thread synchronously, and the worker waits for the round-trip.
+//! Once [`enable`] is called, the logging macros ([`log!`](crate::log), [`warn!`](crate::warn), [`error!`](crate::error), [`dbg!`](crate::dbg))
+//! called outside of the main browser thread push their message into a lock-free [`spsc`](crate::spsc) ring buffer of their thread instead.
+//! The main browser thread takes the messages of all the threads with [`drain`], which the main loop set with
+//! [`set_main_loop_with_arg`] or [`set_main_loop`] calls at the end of each tick, and prints them in a batch.
+//!
+//! A message that doesn't fit in its thread's buffer is dropped rather than waited for, and counted in [`dropped`].
+//! The messages are only ordered within the same thread.
+//!
+//! [`set_main_loop_with_arg`]: crate::emscripten::set_main_loop_with_arg
+//! [`set_main_loop`]: crate::emscripten::set_main_loop
+
+use std::{
+    cell::RefCell,
+    sync::atomic::{AtomicU32, AtomicUsize, Ordering},
+};
+
+use crate::{
+    console::{dbg_str, with_buffered_logger, Level},
+    spsc::{channel, Consumer, Producer},
+    sync::Mutex,
+    threading::is_main_browser_thread,
+};
+
+/// The default size, in bytes, of the buffer of each thread.
+pub const DEFAULT_WORKER_LOG_CAPACITY: usize = 64 * 1024;
+
+// Each record is the level, the length of the message as 4 little-endian bytes, then the message.
+const HEADER_LEN: usize = 5;
+
+// The buffer size of the threads, or 0 while the sink is disabled.
+static CAPACITY: AtomicUsize = AtomicUsize::new(0);
+static DROPPED: AtomicU32 = AtomicU32::new(0);
+// The consuming sides of the threads' buffers, registered on their first message.
+// A thread only locks it once, to register its buffer, and the main thread never waits for it.
+static QUEUES: Mutex<Vec<Consumer<u8>>> = Mutex::new(Vec::new());
+
+thread_local! {
+    // The producing side of the thread's buffer, and the record being built, so that it's published at once.
+    static QUEUE: RefCell<Option<(Producer<u8>, Vec<u8>)>> = const { RefCell::new(None) };
+}
+
+/// Routes the logging macros of the threads other than the main browser one to the sink, with buffers of `capacity` bytes per thread.
+/// The buffers of the threads that already logged keep their size.
+///
+/// # Examples
+/// ```rust
+/// worker_log::enable(worker_log::DEFAULT_WORKER_LOG_CAPACITY);
+///
+/// std::thread::spawn(|| {
+///     // Returns right away; printed by the main thread at the end of its next main loop tick.
+///     log!("Chunk {} generated", index);
+/// });
+/// ```
+pub fn enable(capacity: usize) {
+    CAPACITY.store(capacity.max(HEADER_LEN + 1), Ordering::Relaxed);
+}
+
+/// Makes the logging macros print directly from every thread again. The queued messages can still be drained.
+pub fn disable() {
+    CAPACITY.store(0, Ordering::Relaxed);
+}
+
+// Returns `true` if the calling thread's messages go to the sink.
+pub(crate) fn routes_here() -> bool {
+    CAPACITY.load(Ordering::Relaxed) != 0 && !is_main_browser_thread()
+}
+
+/// Queues the message of the calling thread, without blocking nor calling into JS.
+/// A message longer than the thread's buffer is truncated to it.
+///
+/// Returns `false` if the message was dropped, because the buffer was full or the sink isn't enabled.
+pub fn push(level: Level, message: &str) -> bool {
+    let capacity = CAPACITY.load(Ordering::Relaxed);
+    if capacity == 0 {
+        return false;
+    }
+
+    let pushed = QUEUE
+        .try_with(|queue| {
+            let mut queue = queue.borrow_mut();
+            let (producer, record) = queue.get_or_insert_with(|| {
+                let (producer, consumer) = channel(capacity);
+                QUEUES.lock().push(consumer);
+                (producer, Vec::new())
+            });
+
+            let mut len = message.len().min(producer.capacity() - HEADER_LEN);
+            while !message.is_char_boundary(len) {
+                len -= 1;
+            }
+            if producer.free_len() < HEADER_LEN + len {
+                return false;
+            }
+
+            record.clear();
+            record.push(level as u8);
+            record.extend_from_slice(&(len as u32).to_le_bytes());
+            record.extend_from_slice(&message.as_bytes()[..len]);
+            producer.push_slice(record);
+            true
+        })
+        .unwrap_or(false);
+
+    if !pushed {
+        DROPPED.fetch_add(1, Ordering::Relaxed);
+    }
+    pushed
+}
+
+/// Returns the number of messages dropped because their thread's buffer was full.
+pub fn dropped() -> u32 {
+    DROPPED.load(Ordering::Relaxed)
+}
+
+/// Prints the queued messages of all the threads in a batch, through the calling thread's [`BufferedLogger`](crate::console::BufferedLogger),
+/// and returns how many were printed. It must be called from the main browser thread.
+/// It doesn't wait for a thread registering its buffer: their messages are printed by the next call instead.
+///
+/// It is called automatically at the end of each main loop tick of the main browser thread.
+pub fn drain() -> usize {
+    let Some(mut queues) = QUEUES.try_lock() else {
+        return 0;
+    };
+    if queues.is_empty() {
+        return 0;
+    }
+
+    let mut count = 0;
+    let mut message = Vec::new();
+    let mut debug = String::new();
+    with_buffered_logger(|logger| {
+        for queue in queues.iter_mut() {
+            let mut header = [0; HEADER_LEN];
+            // A record is published at once, so a queued header is followed by its message.
+            while queue.pop_slice(&mut header) == HEADER_LEN {
+                let len = u32::from_le_bytes([header[1], header[2], header[3], header[4]]) as usize;
+                message.resize(len, 0);
+                queue.pop_slice(&mut message);
+                // The messages were cut on a character boundary.
+                let message = String::from_utf8_lossy(&message);
+                match header[0] {
+                    level if level == Level::Error as u8 => logger.error(&*message),
+                    level if level == Level::Warn as u8 => logger.warn(&*message),
+                    level if level == Level::Info as u8 => logger.log(&*message),
+                    _ => {
+                        debug.push_str(&message);
+                        debug.push('\n');
+                    }
+                }
+                count += 1;
+            }
+        }
+        logger.flush();
+    });
+    if !debug.is_empty() {
+        debug.pop();
+        dbg_str(&debug);
+    }
+
+    // The buffers of the threads that exited are freed once they're empty.
+    queues.retain(|queue| !(queue.is_abandoned() && queue.is_empty()));
+    count
+}
+
+// Drains the messages at the end of a main loop tick, if it runs on the main browser thread.
+pub(crate) fn drain_on_tick() {
+    if CAPACITY.load(Ordering::Relaxed) != 0 && is_main_browser_thread() {
+        drain();
+    }
+}
@@ -0,0 +1,39 @@
+#include <emscripten.h>
+
+// Adds a User Timing mark with the given name, at the given `performance.now()` time, so that it shows in the browser's performance tools.
+EM_JS(void, startup_mark_js, (const char *name, double time), {
+    if (typeof performance == "undefined" || !performance.mark) {
+        return;
+    }
+    try {
+        performance.mark(UTF8ToString(name), { startTime: time });
+    } catch (e) {
+        // Browsers without the `startTime` option (User Timing Level 2) mark the current time.
+        performance.mark(UTF8ToString(name));
+    }
+});
+
+// Writes the startTime and responseEnd of the download of the program's wasm file, from the resource timing entries, or -1 if it isn't found.
+EM_JS(void, startup_wasm_download_js, (double *times), {
+    HEAPF64[times >>> 3] = -1;
+    HEAPF64[(times >>> 3) + 1] = -1;
+    if (typeof performance == "undefined" || !performance.getEntriesByType) {
+        return;
+    }
+    var entries = performance.getEntriesByType("resource");
+    for (var i = 0; i < entries.length; i++) {
+        if (/\.wasm(\?|#|$)/.test(entries[i].name)) {
+            HEAPF64[times >>> 3] = entries[i].startTime;
+            HEAPF64[(times >>> 3) + 1] = entries[i].responseEnd;
+            return;
+        }
+    }
+});
+
+void startup_mark(const char *name, double time) {
+    startup_mark_js(name, time);
+}
+
+void startup_wasm_download(double *times) {
+    startup_wasm_download_js(times);
+}
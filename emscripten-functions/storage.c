@@ -0,0 +1,51 @@
+#include <emscripten.h>
+
+// The Storage API, `navigator.storage`, which emscripten has no bindings for.
+// The estimate callback gets 0 where the API is missing or failed, and 1 with the usage and quota in bytes.
+// The persistence callbacks get 1 if the origin's storage is persistent, and 0 otherwise.
+
+typedef void (*storage_estimate_callback)(void *arg, int ok, double usage, double quota);
+typedef void (*storage_persist_callback)(void *arg, int persisted);
+
+EM_JS(void, storage_estimate_js, (storage_estimate_callback callback, void *arg), {
+    if (typeof navigator == "undefined" || !navigator.storage || !navigator.storage.estimate) {
+        _storage_estimate_done(callback, arg, 0, 0, 0);
+        return;
+    }
+    navigator.storage.estimate().then(function (estimate) {
+        _storage_estimate_done(callback, arg, 1, estimate.usage || 0, estimate.quota || 0);
+    }, function () {
+        _storage_estimate_done(callback, arg, 0, 0, 0);
+    });
+});
+
+// Calls `navigator.storage.persist()` if `request`, or `navigator.storage.persisted()` otherwise.
+EM_JS(void, storage_persist_js, (int request, storage_persist_callback callback, void *arg), {
+    var storage = typeof navigator != "undefined" && navigator.storage;
+    var method = storage && (request ? storage.persist : storage.persisted);
+    if (!method) {
+        _storage_persist_done(callback, arg, 0);
+        return;
+    }
+    method.call(storage).then(function (persisted) {
+        _storage_persist_done(callback, arg, persisted ? 1 : 0);
+    }, function () {
+        _storage_persist_done(callback, arg, 0);
+    });
+});
+
+EMSCRIPTEN_KEEPALIVE void storage_estimate_done(storage_estimate_callback callback, void *arg, int ok, double usage, double quota) {
+    callback(arg, ok, usage, quota);
+}
+
+EMSCRIPTEN_KEEPALIVE void storage_persist_done(storage_persist_callback callback, void *arg, int persisted) {
+    callback(arg, persisted);
+}
+
+void storage_estimate(storage_estimate_callback callback, void *arg) {
+    storage_estimate_js(callback, arg);
+}
+
+void storage_persist(int request, storage_persist_callback callback, void *arg) {
+    storage_persist_js(request, callback, arg);
+}
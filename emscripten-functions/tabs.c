@@ -0,0 +1,99 @@
+#include <stdlib.h>
+#include <emscripten.h>
+
+// Coordinates the tabs of the origin with Web Locks and `BroadcastChannel`s, kept in a JS table.
+// A lock is held until `tabs_release_lock_js` resolves the promise given to `navigator.locks.request`; without Web Locks,
+// the callback is called right away with the id 0, which holds nothing. The channels carry `ArrayBuffer` messages, copied
+// into buffers of the wasm heap that are freed after the callback.
+
+typedef void (*tabs_lock_callback)(void *arg, int id);
+typedef void (*tabs_message_callback)(void *arg, const void *data, int size);
+
+EM_JS(void, tabs_request_lock_js, (const char *name, tabs_lock_callback callback, void *arg), {
+    var tabs = Module["emscriptenFunctionsTabs"] || (Module["emscriptenFunctionsTabs"] = { next: 1, locks: {}, channels: {} });
+    if (typeof navigator == "undefined" || !navigator.locks) {
+        _tabs_lock_granted(callback, arg, 0);
+        return;
+    }
+    navigator.locks.request(UTF8ToString(name), function () {
+        return new Promise(function (resolve) {
+            var id = tabs.next++;
+            tabs.locks[id] = resolve;
+            _tabs_lock_granted(callback, arg, id);
+        });
+    });
+});
+
+EM_JS(void, tabs_release_lock_js, (int id), {
+    var tabs = Module["emscriptenFunctionsTabs"];
+    var resolve = tabs && tabs.locks[id];
+    if (resolve) {
+        delete tabs.locks[id];
+        resolve();
+    }
+});
+
+EM_JS(int, tabs_channel_open_js, (const char *name, tabs_message_callback callback, void *arg), {
+    if (typeof BroadcastChannel == "undefined") {
+        return 0;
+    }
+    var tabs = Module["emscriptenFunctionsTabs"] || (Module["emscriptenFunctionsTabs"] = { next: 1, locks: {}, channels: {} });
+    var id = tabs.next++;
+    var channel = new BroadcastChannel(UTF8ToString(name));
+    channel.onmessage = function (event) {
+        if (!(event.data instanceof ArrayBuffer)) {
+            return;
+        }
+        var data = new Uint8Array(event.data);
+        var ptr = _tabs_alloc(data.length) >>> 0;
+        HEAPU8.set(data, ptr);
+        _tabs_message(callback, arg, ptr, data.length);
+    };
+    tabs.channels[id] = channel;
+    return id;
+});
+
+// The message is copied out of the heap, which may be shared with other threads.
+EM_JS(void, tabs_channel_post_js, (int id, const void *data, int size), {
+    var channel = Module["emscriptenFunctionsTabs"].channels[id];
+    channel.postMessage(HEAPU8.slice(data >>> 0, (data >>> 0) + size).buffer);
+});
+
+EM_JS(void, tabs_channel_close_js, (int id), {
+    var tabs = Module["emscriptenFunctionsTabs"];
+    tabs.channels[id].close();
+    delete tabs.channels[id];
+});
+
+EMSCRIPTEN_KEEPALIVE void *tabs_alloc(int size) {
+    return malloc(size);
+}
+
+EMSCRIPTEN_KEEPALIVE void tabs_lock_granted(tabs_lock_callback callback, void *arg, int id) {
+    callback(arg, id);
+}
+
+EMSCRIPTEN_KEEPALIVE void tabs_message(tabs_message_callback callback, void *arg, void *data, int size) {
+    callback(arg, data, size);
+    free(data);
+}
+
+void tabs_request_lock(const char *name, tabs_lock_callback callback, void *arg) {
+    tabs_request_lock_js(name, callback, arg);
+}
+
+void tabs_release_lock(int id) {
+    tabs_release_lock_js(id);
+}
+
+int tabs_channel_open(const char *name, tabs_message_callback callback, void *arg) {
+    return tabs_channel_open_js(name, callback, arg);
+}
+
+void tabs_channel_post(int id, const void *data, int size) {
+    tabs_channel_post_js(id, data, size);
+}
+
+void tabs_channel_close(int id) {
+    tabs_channel_close_js(id);
+}
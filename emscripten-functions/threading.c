@@ -0,0 +1,39 @@
+#include <emscripten.h>
+
+// Makes sure the pthread pool has at least `count` unused workers with the wasm module loaded, so that the next `pthread_create`
+// calls start right away, instead of creating and loading a worker in the background. The missing workers are created and loaded
+// at once, and `callback` is called with the number of unused workers once they're all loaded.
+// Returns 0 if the program wasn't built with pthreads, in which case `callback` isn't called.
+
+typedef void (*threading_prewarm_callback)(void *arg, int workers);
+
+EM_JS(int, threading_prewarm_js, (int count, threading_prewarm_callback callback, void *arg), {
+    if (typeof PThread == "undefined") {
+        return 0;
+    }
+    var workers = PThread.unusedWorkers;
+    var loads = [];
+    while (workers.length < count) {
+        PThread.allocateUnusedWorker();
+        var worker = workers[workers.length - 1];
+        loads.push(new Promise(function (resolve) {
+            // The older emscripten versions take a callback, the newer ones return a promise.
+            var loaded = PThread.loadWasmModuleToWorker(worker, resolve);
+            if (loaded && loaded.then) {
+                loaded.then(resolve);
+            }
+        }));
+    }
+    Promise.all(loads).then(function () {
+        _threading_prewarm_done(callback, arg, workers.length);
+    });
+    return 1;
+});
+
+EMSCRIPTEN_KEEPALIVE void threading_prewarm_done(threading_prewarm_callback callback, void *arg, int workers) {
+    callback(arg, workers);
+}
+
+int threading_prewarm(int count, threading_prewarm_callback callback, void *arg) {
+    return threading_prewarm_js(count, callback, arg);
+}
@@ -0,0 +1,65 @@
+#include <emscripten.h>
+
+// Web Audio has no C function to connect nodes, so the node is connected in JS, through `EmAudio`,
+// emscripten's table of the Web Audio objects handed out to wasm, that the webaudio functions pull in.
+
+EM_JS(void, webaudio_connect_to_destination_js, (int node, int context), {
+    EmAudio[node].connect(EmAudio[context].destination);
+});
+
+void webaudio_connect_to_destination(int node, int context) {
+    webaudio_connect_to_destination_js(node, context);
+}
+
+// Decodes a compressed audio file with the context's `decodeAudioData`, which runs the browser's decoders off the program's threads.
+// The decoded `AudioBuffer` is added to `EmAudio`, and its handle given to `webaudio_decoded`, so that the rust code can copy its channels
+// and keep or release it; the handle is 0 if the data couldn't be decoded.
+
+typedef void (*webaudio_decode_callback)(void *arg, int buffer, int channels, int frames, float sample_rate);
+
+EM_JS(void, webaudio_decode_audio_js, (int context, const void *data, int size, webaudio_decode_callback callback, void *arg), {
+    // `decodeAudioData` detaches the array buffer it's given, so the bytes are copied out of the heap.
+    EmAudio[context].decodeAudioData(HEAPU8.slice(data >>> 0, (data >>> 0) + size).buffer).then(function (buffer) {
+        var handle = ++EmAudioCounter;
+        EmAudio[handle] = buffer;
+        _webaudio_decoded(callback, arg, handle, buffer.numberOfChannels, buffer.length, buffer.sampleRate);
+    }, function () {
+        _webaudio_decoded(callback, arg, 0, 0, 0, 0);
+    });
+});
+
+// Copies a channel straight into the wasm heap, in a single pass.
+EM_JS(void, webaudio_copy_channel_js, (int buffer, int channel, float *dst, int frames), {
+    EmAudio[buffer].copyFromChannel(HEAPF32.subarray(dst >>> 2, (dst >>> 2) + frames), channel);
+});
+
+EM_JS(void, webaudio_play_buffer_js, (int buffer, int context), {
+    var source = EmAudio[context].createBufferSource();
+    source.buffer = EmAudio[buffer];
+    source.connect(EmAudio[context].destination);
+    source.start();
+});
+
+EM_JS(void, webaudio_release_js, (int handle), {
+    delete EmAudio[handle];
+});
+
+EMSCRIPTEN_KEEPALIVE void webaudio_decoded(webaudio_decode_callback callback, void *arg, int buffer, int channels, int frames, float sample_rate) {
+    callback(arg, buffer, channels, frames, sample_rate);
+}
+
+void webaudio_decode_audio(int context, const void *data, int size, webaudio_decode_callback callback, void *arg) {
+    webaudio_decode_audio_js(context, data, size, callback, arg);
+}
+
+void webaudio_copy_channel(int buffer, int channel, float *dst, int frames) {
+    webaudio_copy_channel_js(buffer, channel, dst, frames);
+}
+
+void webaudio_play_buffer(int buffer, int context) {
+    webaudio_play_buffer_js(buffer, context);
+}
+
+void webaudio_release(int handle) {
+    webaudio_release_js(handle);
+}
@@ -0,0 +1,131 @@
+#include <emscripten.h>
+#include <emscripten/html5.h>
+
+// Decodes the encoded image with `createImageBitmap`, which browsers run off the main thread,
+// and uploads the bitmap into the given texture of the calling thread's current WebGL context.
+// The pixels only exist in the browser: they are never copied into the wasm heap.
+// The callback gets 0 without a current context, 1 when the image couldn't be decoded, 2 when the context was lost meanwhile,
+// and 3 on success, along with the size of the image.
+
+typedef void (*webgl_texture_callback)(void *arg, int result, int width, int height);
+
+EM_JS(void, webgl_upload_image_js, (const char *data, int size, unsigned int texture, int flip_y, int premultiply_alpha, int generate_mipmaps, webgl_texture_callback callback, void *arg), {
+    var done = function (result, width, height) {
+        _webgl_upload_image_done(callback, arg, result, width, height);
+    };
+    var context = typeof GL != "undefined" && GL.currentContext;
+    if (!context || typeof createImageBitmap == "undefined") {
+        done(0, 0, 0);
+        return;
+    }
+
+    // The bytes are copied out, so the caller may reuse its buffer right away.
+    var blob = new Blob([HEAPU8.slice(data >>> 0, (data >>> 0) + size)]);
+    createImageBitmap(blob, {
+        imageOrientation: flip_y ? "flipY" : "from-image",
+        premultiplyAlpha: premultiply_alpha ? "premultiply" : "none",
+        colorSpaceConversion: "none"
+    }).then(function (bitmap) {
+        var gl = context.GLctx;
+        if (gl.isContextLost()) {
+            bitmap.close();
+            done(2, 0, 0);
+            return;
+        }
+
+        // The texture binding of the active unit is restored, so the upload doesn't disturb the program's GL state.
+        var previous = gl.getParameter(gl.TEXTURE_BINDING_2D);
+        gl.bindTexture(gl.TEXTURE_2D, GL.textures[texture]);
+        gl.texImage2D(gl.TEXTURE_2D, 0, gl.RGBA, gl.RGBA, gl.UNSIGNED_BYTE, bitmap);
+        if (generate_mipmaps) {
+            gl.generateMipmap(gl.TEXTURE_2D);
+        }
+        gl.bindTexture(gl.TEXTURE_2D, previous);
+
+        var width = bitmap.width;
+        var height = bitmap.height;
+        bitmap.close();
+        done(3, width, height);
+    }, function () {
+        done(1, 0, 0);
+    });
+});
+
+EMSCRIPTEN_KEEPALIVE void webgl_upload_image_done(webgl_texture_callback callback, void *arg, int result, int width, int height) {
+    callback(arg, result, width, height);
+}
+
+void webgl_upload_image(const char *data, int size, unsigned int texture, int flip_y, int premultiply_alpha, int generate_mipmaps, webgl_texture_callback callback, void *arg) {
+    webgl_upload_image_js(data, size, texture, flip_y, premultiply_alpha, generate_mipmaps, callback, arg);
+}
+
+// Passes the `desynchronized` hint, which emscripten's context attributes don't have, to the `getContext` call of the next context created
+// on the target canvas, by wrapping its `getContext` until `webgl_hint_end_js`. The hint is also passed under its former name, `lowLatency`.
+EM_JS(void, webgl_hint_begin_js, (const char *target), {
+    var name = UTF8ToString(target);
+    var canvas = (typeof specialHTMLTargets != "undefined" && specialHTMLTargets[name]) ||
+        (name == "#canvas" && Module["canvas"]) ||
+        (typeof document != "undefined" && document.querySelector(name));
+    if (!canvas || !canvas.getContext) {
+        return;
+    }
+
+    var hadOwn = Object.prototype.hasOwnProperty.call(canvas, "getContext");
+    var original = canvas.getContext;
+    canvas.getContext = function (type, attributes) {
+        return original.call(this, type, Object.assign({}, attributes, { desynchronized: true, lowLatency: true }));
+    };
+    Module["emscriptenFunctionsContextHint"] = { canvas: canvas, original: original, hadOwn: hadOwn };
+});
+
+EM_JS(void, webgl_hint_end_js, (void), {
+    var hint = Module["emscriptenFunctionsContextHint"];
+    if (!hint) {
+        return;
+    }
+    if (hint.hadOwn) {
+        hint.canvas.getContext = hint.original;
+    } else {
+        delete hint.canvas.getContext;
+    }
+    Module["emscriptenFunctionsContextHint"] = null;
+});
+
+// Returns 1 if the context got created desynchronized from the compositor, as reported by its `getContextAttributes()`.
+EM_JS(int, webgl_is_desynchronized_js, (EMSCRIPTEN_WEBGL_CONTEXT_HANDLE handle), {
+    var context = typeof GL != "undefined" && GL.getContext(handle);
+    var attributes = context && context.GLctx.getContextAttributes();
+    return attributes && attributes.desynchronized ? 1 : 0;
+});
+
+// Returns 1 if the browser honors the `desynchronized` hint, by creating a throwaway context with it.
+EM_JS(int, webgl_supports_desynchronized_js, (void), {
+    if (typeof document == "undefined") {
+        return 0;
+    }
+    var gl = document.createElement("canvas").getContext("webgl", { desynchronized: true });
+    if (!gl) {
+        return 0;
+    }
+    var supported = !!gl.getContextAttributes().desynchronized;
+    var lose = gl.getExtension("WEBGL_lose_context");
+    if (lose) {
+        lose.loseContext();
+    }
+    return supported ? 1 : 0;
+});
+
+EMSCRIPTEN_WEBGL_CONTEXT_HANDLE webgl_create_desynchronized(const char *target, const EmscriptenWebGLContextAttributes *attributes) {
+    webgl_hint_begin_js(target);
+    EMSCRIPTEN_WEBGL_CONTEXT_HANDLE handle = emscripten_webgl_create_context(target, attributes);
+    webgl_hint_end_js();
+    return handle;
+}
+
+int webgl_is_desynchronized(EMSCRIPTEN_WEBGL_CONTEXT_HANDLE handle) {
+    return webgl_is_desynchronized_js(handle);
+}
+
+int webgl_supports_desynchronized(void) {
+    return webgl_supports_desynchronized_js();
+}
@@ -0,0 +1,71 @@
+#include <emscripten.h>
+
+// The WebGPU objects are passed as handles of `JsValStore`, emscripten's table of the JS objects exported to wasm,
+// that the `emscripten_webgpu_export_*` functions pull in.
+//
+// The staging buffers of a readback are pooled on the device, in power-of-two size classes of at least 256 bytes,
+// so that reading back every frame doesn't create and destroy GPU buffers. Each class keeps at most a few idle buffers.
+
+typedef void (*webgpu_read_callback)(void *arg, int result);
+
+// Writes the bytes straight from the wasm heap: `writeBuffer` takes a typed array with an offset and a size, so there's no intermediate copy in JS.
+EM_JS(void, webgpu_staging_write_js, (int device, int buffer, double offset, const void *data, double size), {
+    JsValStore.get(device).queue.writeBuffer(JsValStore.get(buffer), offset, HEAPU8, data >>> 0, size);
+});
+
+EM_JS(void, webgpu_staging_read_js, (int device, int buffer, double offset, void *dst, double size, webgpu_read_callback callback, void *arg), {
+    var gpuDevice = JsValStore.get(device);
+    var pools = gpuDevice.emscriptenFunctionsStaging || (gpuDevice.emscriptenFunctionsStaging = {});
+    var capacity = 256;
+    while (capacity < size) {
+        capacity *= 2;
+    }
+    var pool = pools[capacity] || (pools[capacity] = []);
+    var staging = pool.pop() || gpuDevice.createBuffer({ size: capacity, usage: GPUBufferUsage.MAP_READ | GPUBufferUsage.COPY_DST });
+
+    var encoder = gpuDevice.createCommandEncoder();
+    encoder.copyBufferToBuffer(JsValStore.get(buffer), offset, staging, 0, size);
+    gpuDevice.queue.submit([encoder.finish()]);
+
+    staging.mapAsync(GPUMapMode.READ, 0, size).then(function () {
+        // The only copy of the readback: from the mapped range into the caller's buffer.
+        // `HEAPU8` is read here, after the wait, as the heap may have grown meanwhile.
+        HEAPU8.set(new Uint8Array(staging.getMappedRange(0, size)), dst >>> 0);
+        staging.unmap();
+        if (pool.length < 4) {
+            pool.push(staging);
+        } else {
+            staging.destroy();
+        }
+        _webgpu_staging_read_done(callback, arg, 1);
+    }, function () {
+        staging.destroy();
+        _webgpu_staging_read_done(callback, arg, 0);
+    });
+});
+
+EM_JS(void, webgpu_staging_trim_js, (int device), {
+    var pools = JsValStore.get(device).emscriptenFunctionsStaging || {};
+    for (var capacity in pools) {
+        pools[capacity].forEach(function (staging) {
+            staging.destroy();
+        });
+        pools[capacity] = [];
+    }
+});
+
+EMSCRIPTEN_KEEPALIVE void webgpu_staging_read_done(webgpu_read_callback callback, void *arg, int result) {
+    callback(arg, result);
+}
+
+void webgpu_staging_write(int device, int buffer, double offset, const void *data, double size) {
+    webgpu_staging_write_js(device, buffer, offset, data, size);
+}
+
+void webgpu_staging_read(int device, int buffer, double offset, void *dst, double size, webgpu_read_callback callback, void *arg) {
+    webgpu_staging_read_js(device, buffer, offset, dst, size, callback, arg);
+}
+
+void webgpu_staging_trim(int device) {
+    webgpu_staging_trim_js(device);
+}
@@ -0,0 +1,106 @@
+#include <stdlib.h>
+#include <emscripten.h>
+
+// Downloads with the browser's `fetch()`, which, unlike the `XMLHttpRequest` of `emscripten_async_wget2_data`,
+// takes a `priority` hint: 0 for `auto`, 1 for `high` and 2 for `low`. Each download is aborted with its `AbortController`,
+// kept in a JS table. Their handles count down from -1, so that they never collide with the positive ones of emscripten.
+// The callbacks get the same arguments as those of `emscripten_async_wget2_data`; none is called once a download is aborted.
+
+EM_JS(int, wget_priority_send_js, (const char *url, const char *method, const char *param, int priority, em_async_wget2_data_onload_func onload, em_async_wget2_data_onerror_func onerror, em_async_wget2_data_onprogress_func onprogress), {
+    var downloads = Module["emscriptenFunctionsWgetPriority"] || (Module["emscriptenFunctionsWgetPriority"] = { next: -1, controllers: {} });
+    var handle = downloads.next--;
+    var controller = new AbortController();
+    downloads.controllers[handle] = controller;
+
+    var init = { method: UTF8ToString(method), priority: ["auto", "high", "low"][priority], signal: controller.signal };
+    // As with `emscripten_async_wget2_data`, the parameters are the form-encoded body of a `POST`.
+    if (init.method == "POST") {
+        init.headers = { "Content-Type": "application/x-www-form-urlencoded" };
+        init.body = UTF8ToString(param);
+    }
+
+    var fail = function (status, statusText) {
+        if (controller.signal.aborted) {
+            return;
+        }
+        delete downloads.controllers[handle];
+        var size = lengthBytesUTF8(statusText) + 1;
+        var text = _wget_priority_alloc(size);
+        stringToUTF8(statusText, text, size);
+        _wget_priority_error(onerror, handle, status, text);
+    };
+
+    fetch(UTF8ToString(url), init).then(function (response) {
+        if (!response.ok) {
+            fail(response.status, response.statusText);
+            return;
+        }
+        var total = +response.headers.get("Content-Length") || 0;
+        var reader = response.body.getReader();
+        var chunks = [];
+        var loaded = 0;
+        var pump = function () {
+            return reader.read().then(function (chunk) {
+                if (controller.signal.aborted) {
+                    return;
+                }
+                if (!chunk.done) {
+                    chunks.push(chunk.value);
+                    loaded += chunk.value.length;
+                    _wget_priority_progress(onprogress, handle, loaded, total);
+                    return pump();
+                }
+
+                delete downloads.controllers[handle];
+                var data = _wget_priority_alloc(loaded);
+                var offset = data >>> 0;
+                for (var i = 0; i < chunks.length; i++) {
+                    HEAPU8.set(chunks[i], offset);
+                    offset += chunks[i].length;
+                }
+                _wget_priority_load(onload, handle, data, loaded);
+            });
+        };
+        return pump().catch(function () {
+            fail(response.status, response.statusText);
+        });
+    }, function () {
+        fail(0, "");
+    });
+    return handle;
+});
+
+EM_JS(void, wget_priority_abort_js, (int handle), {
+    var downloads = Module["emscriptenFunctionsWgetPriority"];
+    var controller = downloads && downloads.controllers[handle];
+    if (controller) {
+        delete downloads.controllers[handle];
+        controller.abort();
+    }
+});
+
+EMSCRIPTEN_KEEPALIVE void *wget_priority_alloc(int size) {
+    return malloc(size);
+}
+
+// The data is given to `onload`, which takes its ownership.
+EMSCRIPTEN_KEEPALIVE void wget_priority_load(em_async_wget2_data_onload_func onload, int handle, void *data, int size) {
+    onload(handle, NULL, data, size);
+}
+
+EMSCRIPTEN_KEEPALIVE void wget_priority_error(em_async_wget2_data_onerror_func onerror, int handle, int status, char *status_text) {
+    onerror(handle, NULL, status, status_text);
+    free(status_text);
+}
+
+EMSCRIPTEN_KEEPALIVE void wget_priority_progress(em_async_wget2_data_onprogress_func onprogress, int handle, int loaded, int total) {
+    onprogress(handle, NULL, loaded, total);
+}
+
+int wget_priority_send(const char *url, const char *method, const char *param, int priority, em_async_wget2_data_onload_func onload, em_async_wget2_data_onerror_func onerror, em_async_wget2_data_onprogress_func onprogress) {
+    return wget_priority_send_js(url, method, param, priority, onload, onerror, onprogress);
+}
+
+void wget_priority_abort(int handle) {
+    wget_priority_abort_js(handle);
+}